@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------
+// <copyright file="WowFlutterAnalyzerTests.cs" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+namespace CrazyGiraffe.AudioFrameProcessor.UnitTests
+{
+    using System;
+    using System.Collections.Generic;
+    using CrazyGiraffe.AudioFrameProcessor;
+    using Microsoft.VisualStudio.TestTools.UnitTesting;
+    using Windows.Media.MediaProperties;
+
+    /// <summary>
+    /// Tests for <see cref="WowFlutterAnalyzer"/>.
+    /// </summary>
+    [TestClass]
+    public class WowFlutterAnalyzerTests
+    {
+        /// <summary>
+        /// Test the ability to create a WowFlutterAnalyzer.
+        /// </summary>
+        [TestMethod]
+        public void WowFlutterAnalyzerCreateTest()
+        {
+            AudioEncodingProperties properties = new AudioEncodingProperties()
+            {
+                SampleRate = 44100,
+                BitsPerSample = 16,
+                ChannelCount = 2,
+            };
+
+            WowFlutterAnalyzer analyzer = new WowFlutterAnalyzer(properties, 3150);
+            Assert.IsNotNull(analyzer);
+            Assert.AreEqual(3150, analyzer.ReferenceFrequency);
+        }
+
+        /// <summary>
+        /// Test the ability to create a WowFlutterAnalyzer with null properties or a bad reference.
+        /// </summary>
+        [TestMethod]
+        public void WowFlutterAnalyzerCreateInvalid()
+        {
+            AudioEncodingProperties properties = new AudioEncodingProperties()
+            {
+                SampleRate = 44100,
+                BitsPerSample = 16,
+                ChannelCount = 2,
+            };
+
+            Assert.ThrowsException<ArgumentException>(() => new WowFlutterAnalyzer(null, 3150));
+            Assert.ThrowsException<ArgumentException>(() => new WowFlutterAnalyzer(properties, 20000));
+        }
+
+        /// <summary>
+        /// Test the speed is reported every 10ms, unlocked without a tone.
+        /// </summary>
+        [TestMethod]
+        public void WowFlutterAnalyzerEventTest()
+        {
+            AudioEncodingProperties properties = new AudioEncodingProperties()
+            {
+                SampleRate = 44100,
+                BitsPerSample = 16,
+                ChannelCount = 2,
+            };
+
+            // The frame is 2048 byes, 512 (float) samples, 256 stereo (float) samples, approx 5.8ms at the rate specified.
+            // Two frames should give one report.
+            WrappedAudioFrame frame = WrappedAudioFrame.CreateFixed(0.2f);
+            WowFlutterAnalyzer analyzer = new WowFlutterAnalyzer(properties, 3150);
+            List<WowFlutterMeasuredEventArgs> reports = new List<WowFlutterMeasuredEventArgs>();
+            analyzer.Measured += (sender, args) => reports.Add(args);
+
+            analyzer.ProcessFrame(frame.CurrentFrame);
+            Assert.AreEqual(0, reports.Count);
+            analyzer.ProcessFrame(frame.CurrentFrame);
+            Assert.AreEqual(1, reports.Count);
+            Assert.IsFalse(reports[0].IsLocked);
+            Assert.AreEqual(1.0, reports[0].Correction);
+        }
+    }
+}
@@ -7,6 +7,7 @@
 #include "pch.h"
 #include "AudioFrameConverter.h"
 #include <Memorybuffer.h>
+#include <stdexcept>
 
 using namespace std;
 using namespace Platform;
@@ -18,60 +19,37 @@ using namespace Windows::Foundation;
 
 AudioFrameConverter::AudioFrameConverter(AudioEncodingProperties^ encodingProperties)
     : m_encodingProperties(encodingProperties)
-    , m_bytesPerFloat(0)
-    , m_maxValue(0)
-    , m_conversionFunction(nullptr)
+    , m_converter()
 {
     if (encodingProperties == nullptr)
     {
         throw ref new InvalidArgumentException("encodingProperties");
     }
 
-    // Pick the conversion function and parameters.
+    // Pick the sample type; the core picks the size.
+    CrazyGiraffe::Core::SampleType sampleType = CrazyGiraffe::Core::SampleType::Pcm;
     wstring subType = encodingProperties->Subtype->Data();
     if (0 == subType.compare(L"PCM"))
     {
-        uint32 bytesPerFloat = 0;
-        uint32 maxValue = 0;
-        switch (encodingProperties->BitsPerSample)
-        {
-        case 8:
-            bytesPerFloat = 1;
-            maxValue = 0xff;
-            break;
-
-        case 16:
-            bytesPerFloat = 2;
-            maxValue = 0xffff;
-            break;
-
-        case 24:
-            bytesPerFloat = 3;
-            maxValue = 0xffffff;
-            break;
-
-        case 32:
-            bytesPerFloat = 4;
-            maxValue = 0xffffffff;
-            break;
-
-        default:
-            throw ref new InvalidArgumentException("encodingProperties->BitsPerSample");
-        }
-
-        m_bytesPerFloat = bytesPerFloat;
-        m_maxValue = maxValue;
-        m_conversionFunction = &AudioFrameConverter::ToPCMByteArray;
+        sampleType = CrazyGiraffe::Core::SampleType::Pcm;
     }
     else if (0 == subType.compare(L"Float"))
     {
-        m_bytesPerFloat = 0;
-        m_conversionFunction = &AudioFrameConverter::ToFloatByteArray;
+        sampleType = CrazyGiraffe::Core::SampleType::Float;
     }
     else
     {
         throw ref new InvalidArgumentException("encodingProperties->Subtype");
     }
+
+    try
+    {
+        m_converter = std::make_unique<CrazyGiraffe::Core::AudioFrameConverter>(sampleType, encodingProperties->BitsPerSample);
+    }
+    catch (const std::invalid_argument&)
+    {
+        throw ref new InvalidArgumentException("encodingProperties->BitsPerSample");
+    }
 }
 
 AudioEncodingProperties^ AudioFrameConverter::EncodingProperties::get()
@@ -108,65 +86,8 @@ Array<byte>^ AudioFrameConverter::ToByteArray(AudioFrame^ frame)
         uint32 floatBufferCapacity = byteBufferCapacity / sizeof(float);
 
         // Now convert to desired size.
-        audioData = (this->*(this->m_conversionFunction))(floatBuffer, floatBufferCapacity, m_bytesPerFloat, m_maxValue);
-    }
-
-    return audioData;
-}
-
-Array<byte>^ AudioFrameConverter::ToPCMByteArray(
-    float* floatBuffer,
-    uint32 floatBufferCapacity,
-    uint32 bytesPerFloat,
-    uint32 maxValue)
-{
-    Array<byte>^ audioData = ref new Array<byte>(floatBufferCapacity * bytesPerFloat);
-
-    union convert_data
-    {
-        uint32 value;
-        unsigned char bytes[sizeof(uint32)];
-    } convertData;
-
-    for (uint32 i = 0, j = 0; i < audioData->Length && j < floatBufferCapacity; i += bytesPerFloat, j++)
-    {
-        convertData.value = static_cast<uint32>(floatBuffer[j] * maxValue);
-
-        // convertData is little-endian: copy from end to start to convertData.bytes.
-        for (uint32 k = 0; k < bytesPerFloat; k++)
-        {
-            audioData[i + k] = convertData.bytes[k];
-        }
-    }
-
-    return audioData;
-}
-
-Array<byte>^ AudioFrameConverter::ToFloatByteArray(
-    float* floatBuffer,
-    uint32 floatBufferCapacity,
-    uint32 dummy1,
-    uint32 dummy2)
-{
-    UNREFERENCED_PARAMETER(dummy1);
-    UNREFERENCED_PARAMETER(dummy2);
-
-    uint32 bytesPerValue = sizeof(float);
-    Array<byte>^ audioData = ref new Array<byte>(floatBufferCapacity * bytesPerValue);
-
-    union convert_data
-    {
-        float value;
-        unsigned char bytes[4];
-    } convertData;
-
-    for (uint32 i = 0, j = 0; i < audioData->Length && j < floatBufferCapacity; i += bytesPerValue, j++)
-    {
-        convertData.value = floatBuffer[j];
-        for (uint32 k = 0; k < bytesPerValue; k++)
-        {
-            audioData[i + k] = convertData.bytes[k];
-        }
+        audioData = ref new Array<byte>(static_cast<uint32>(m_converter->OutputSize(floatBufferCapacity)));
+        m_converter->Convert(floatBuffer, floatBufferCapacity, audioData->Data);
     }
 
     return audioData;
@@ -6,6 +6,9 @@
 //-----------------------------------------------------------------------
 #pragma once
 
+#include "Core/AudioFrameConverter.h"
+#include <memory>
+
 namespace CrazyGiraffe { namespace AudioFrameProcessor
 {
     /// <summary>
@@ -53,25 +56,6 @@ namespace CrazyGiraffe { namespace AudioFrameProcessor
         /// </summary>
         virtual Platform::Array<byte>^ ToByteArray(Windows::Media::AudioFrame^ frame);
 
-    private:
-        /// <summary>
-        /// Convert a float array to an PCM byte array.
-        /// </summary>
-        Platform::Array<byte>^ ToPCMByteArray(
-            float* floatBuffer,
-            uint32 floatBufferCapacity,
-            uint32 bytesPerFloat,
-            uint32 max_Value);
-
-        /// <summary>
-        /// Convert a float array to an 32-bit float byte array.
-        /// </summary>
-        Platform::Array<byte>^ ToFloatByteArray(
-            float* floatBuffer,
-            uint32 floatBufferCapacity,
-            uint32 dummy1,
-            uint32 dummy2);
-
     private:
         /// <summary>
         /// The audio encoding properties.
@@ -79,18 +63,8 @@ namespace CrazyGiraffe { namespace AudioFrameProcessor
         Windows::Media::MediaProperties::AudioEncodingProperties^ m_encodingProperties;
 
         ///
-        /// Paramater to pass to conversionFunction's bytesPerFloat parameter;
-        ///
-        uint32 m_bytesPerFloat;
-
-        ///
-        /// Paramater to pass to conversionFunction's maxValue parameter;
-        ///
-        uint32 m_maxValue;
-
-        ///
-        /// Function pointer to conversion function
+        /// The portable converter for the sample type and size.
         ///
-        Platform::Array<byte>^ (AudioFrameConverter::* m_conversionFunction)(float*, uint32, uint32, uint32);
+        std::unique_ptr<CrazyGiraffe::Core::AudioFrameConverter> m_converter;
     };
 } }
@@ -19,27 +19,20 @@ AudioLevelDetector::AudioLevelDetector(
     AudioEncodingProperties^ encodingProperties,
     double thresholdValue,
     TimeSpan thresholdTimeSpan)
-    : m_status(ThresholdStatus::Unknown)
-    , m_encodingProperties(encodingProperties)
-    , m_thresholdValue(thresholdValue)
-    , m_thresholdDuration(thresholdTimeSpan.Duration)
-    , m_thresholdBelowCount(0)
-    , m_thresholdAboveCount(0)
+    : m_encodingProperties(encodingProperties)
+    , m_detector()
 {
     if (encodingProperties == nullptr)
     {
         throw ref new InvalidArgumentException("encodingProperties");
     }
 
-    // The bit count per second is (sample rate (bits/sec) * channel count).
-    long long bitCountPerSecond = this->m_encodingProperties->SampleRate * this->m_encodingProperties->ChannelCount;
-
-    // m_thresholdDuration is a time period expressed in 100-nanosecond units
-    // 10x9 nanoseconds in a second, 10x7 100-nanoseconds in a second.
-    long long secondsPer100NanoSeconds = 10000000;
-
-    // The max count is bit count per second / duration (seconds).
-    m_thresholdMaxCount = (bitCountPerSecond * m_thresholdDuration) / secondsPer100NanoSeconds;
+    // TimeSpan is expressed in 100-nanosecond units, as Core::Ticks.
+    m_detector = std::make_unique<CrazyGiraffe::Core::AudioLevelDetector>(
+        m_encodingProperties->SampleRate,
+        m_encodingProperties->ChannelCount,
+        thresholdValue,
+        CrazyGiraffe::Core::Ticks(thresholdTimeSpan.Duration));
 }
 
 AudioEncodingProperties^ AudioLevelDetector::EncodingProperties::get()
@@ -49,19 +42,20 @@ AudioEncodingProperties^ AudioLevelDetector::EncodingProperties::get()
 
 double AudioLevelDetector::ThresholdValue::get()
 {
-    return m_thresholdValue;
+    return m_detector->ThresholdValue();
 }
 
 TimeSpan AudioLevelDetector::ThresholdTimeSpan::get()
 {
     TimeSpan timeSpan = { 0 };
-    timeSpan.Duration = m_thresholdDuration;
+    timeSpan.Duration = m_detector->ThresholdDuration().count();
     return timeSpan;
 }
 
 ThresholdStatus AudioLevelDetector::Status::get()
 {
-    return m_status;
+    // The values of the two enumerations match.
+    return static_cast<ThresholdStatus>(m_detector->Status());
 }
 
 void AudioLevelDetector::ProcessFrame(AudioFrame^ frame)
@@ -91,44 +85,18 @@ void AudioLevelDetector::ProcessFrame(AudioFrame^ frame)
         // While the sample may be mono or stereo, we don't really care. We need each signal to compare to the
         // threshold the same way but it may impact the time of the frame: a store frame is twice the size for the
         // same time period.
-        uint32 bytesPerFloat = sizeof(float);
-        for (unsigned int i = 0; i < byteBufferCapacity; i += bytesPerFloat)
-        {
-            if (i + bytesPerFloat <= byteBufferCapacity)
+        m_detector->ProcessSamples(
+            reinterpret_cast<float*>(byteBuffer),
+            byteBufferCapacity / sizeof(float),
+            [this](CrazyGiraffe::Core::ThresholdStatus newStatus)
             {
-                float* floatValue = reinterpret_cast<float*>(byteBuffer + i);
-                if (m_status != ThresholdStatus::BelowThrehold && std::abs(*floatValue) <= m_thresholdValue)
-                {
-                    ++m_thresholdBelowCount;
-                    if (m_thresholdBelowCount >= m_thresholdMaxCount)
-                    {
-                        UpdateStatus(ThresholdStatus::BelowThrehold);
-                        m_thresholdBelowCount = 0;
-                    }
-                }
-                else if (m_status != ThresholdStatus::AboveThreshold && std::abs(*floatValue) > m_thresholdValue)
-                {
-                    ++m_thresholdAboveCount;
-                    if (m_thresholdAboveCount >= m_thresholdMaxCount)
-                    {
-                        UpdateStatus(ThresholdStatus::AboveThreshold);
-                        m_thresholdAboveCount = 0;
-                    }
-                }
-            }
-        }
+                UpdateStatus(static_cast<ThresholdStatus>(newStatus));
+            });
     }
 }
 
 void AudioLevelDetector::UpdateStatus(ThresholdStatus newStatus)
 {
-    // Update.
-    bool changed = (m_status != newStatus);
-    m_status = newStatus;
-
-    if (changed)
-    {
-        AudioThreholdDetectedEventArgs^ eventArgs = ref new AudioThreholdDetectedEventArgs(newStatus);
-        ThreholdDetected(this, eventArgs);
-    }
+    AudioThreholdDetectedEventArgs^ eventArgs = ref new AudioThreholdDetectedEventArgs(newStatus);
+    ThreholdDetected(this, eventArgs);
 }
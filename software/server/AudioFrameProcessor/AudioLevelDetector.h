@@ -6,8 +6,9 @@
 //-----------------------------------------------------------------------
 #pragma once
 
-#include "AudioLevelDetector.h"
 #include "AudioThreholdDetectedEventArgs.h"
+#include "Core/AudioLevelDetector.h"
+#include <memory>
 
 namespace CrazyGiraffe { namespace AudioFrameProcessor
 {
@@ -124,7 +125,7 @@ namespace CrazyGiraffe { namespace AudioFrameProcessor
 
     internal:
         /// <summary>
-        /// Update the status and send notifications.
+        /// Send notifications of a new status.
         /// </summary>
         /// <param name="newStatus">the new status.</param>
         void UpdateStatus(ThresholdStatus newStatus);
@@ -136,33 +137,8 @@ namespace CrazyGiraffe { namespace AudioFrameProcessor
         Windows::Media::MediaProperties::AudioEncodingProperties^ m_encodingProperties;
 
         /// <summary>
-        /// The audio threshold value.
+        /// The portable detector, which keeps the threshold, the counts and the status.
         /// </summary>
-        double m_thresholdValue;
-
-        /// <summary>
-        /// The audio threshold duration.
-        /// </summary>
-        long long m_thresholdDuration;
-
-        /// <summary>
-        /// The status of the sample.
-        /// </summary>
-        ThresholdStatus m_status;
-
-        /// <summary>
-        /// The max count needed to meet the threshold.
-        /// </summary>
-        long long m_thresholdMaxCount;
-
-        /// <summary>
-        /// The count of samples below the threshold.
-        /// </summary>
-        long long m_thresholdBelowCount;
-
-        /// <summary>
-        /// The count of samples above the threshold.
-        /// </summary>
-        long long m_thresholdAboveCount;
+        std::unique_ptr<CrazyGiraffe::Core::AudioLevelDetector> m_detector;
     };
 } }
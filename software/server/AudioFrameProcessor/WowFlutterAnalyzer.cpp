@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------
+// <copyright file="WowFlutterAnalyzer.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "WowFlutterAnalyzer.h"
+#include <Memorybuffer.h>
+#include <stdexcept>
+
+using namespace Platform;
+using namespace CrazyGiraffe::AudioFrameProcessor;
+using namespace Microsoft::WRL;
+using namespace Windows::Media;
+using namespace Windows::Media::MediaProperties;
+using namespace Windows::Foundation;
+
+WowFlutterAnalyzer::WowFlutterAnalyzer(AudioEncodingProperties^ encodingProperties, double referenceFrequency)
+    : m_encodingProperties(encodingProperties)
+    , m_analyzer()
+{
+    if (encodingProperties == nullptr)
+    {
+        throw ref new InvalidArgumentException("encodingProperties");
+    }
+
+    try
+    {
+        m_analyzer = std::make_unique<CrazyGiraffe::Core::WowFlutterAnalyzer>(
+            m_encodingProperties->SampleRate,
+            static_cast<uint16_t>(m_encodingProperties->ChannelCount),
+            referenceFrequency);
+    }
+    catch (const std::invalid_argument&)
+    {
+        throw ref new InvalidArgumentException("referenceFrequency");
+    }
+}
+
+AudioEncodingProperties^ WowFlutterAnalyzer::EncodingProperties::get()
+{
+    return m_encodingProperties;
+}
+
+double WowFlutterAnalyzer::ReferenceFrequency::get()
+{
+    return m_analyzer->ReferenceFrequency();
+}
+
+void WowFlutterAnalyzer::ProcessFrame(AudioFrame^ frame)
+{
+    if (frame != nullptr)
+    {
+        // Extract data for audio frame.
+        AudioBuffer^ audioBuffer = frame->LockBuffer(AudioBufferAccessMode::Read);
+        IMemoryBufferReference^ bufferReference = audioBuffer->CreateReference();
+
+        ComPtr<IMemoryBufferByteAccess> bufferAccess;
+        HRESULT hr = reinterpret_cast<IInspectable*>(bufferReference)->QueryInterface(IID_PPV_ARGS(&bufferAccess));
+        if (FAILED(hr))
+        {
+            throw Exception::CreateException(hr);
+        }
+
+        // Get a pointer to the audio buffer
+        byte* byteBuffer;
+        uint32 byteBufferCapacity;
+        hr = bufferAccess->GetBuffer(&byteBuffer, &byteBufferCapacity);
+        if (FAILED(hr))
+        {
+            throw Exception::CreateException(hr);
+        }
+
+        // A frame may hold several reports, or none; the analyzer keeps its place between frames.
+        m_analyzer->ProcessSamples(
+            reinterpret_cast<float*>(byteBuffer),
+            byteBufferCapacity / sizeof(float),
+            [this](const CrazyGiraffe::Core::WowFlutter& measured)
+            {
+                Measured(this, ref new WowFlutterMeasuredEventArgs(measured));
+            });
+    }
+}
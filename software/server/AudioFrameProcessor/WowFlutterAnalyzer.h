@@ -0,0 +1,68 @@
+//-----------------------------------------------------------------------
+// <copyright file="WowFlutterAnalyzer.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "WowFlutterMeasuredEventArgs.h"
+#include "Core/WowFlutterAnalyzer.h"
+#include <memory>
+
+namespace CrazyGiraffe { namespace AudioFrameProcessor
+{
+    /// <summary>
+    /// Class to measure the wow, flutter and drift of the tape from a steady tone, such as a 3150Hz
+    /// test tape, and the correction for the motor speed controller.
+    /// </summary>
+    public ref class WowFlutterAnalyzer sealed
+    {
+    public:
+        /// <summary>
+        /// Create an instance of the <see cref="WowFlutterAnalyzer" /> class.
+        /// </summary>
+        /// <param name="encodingProperties">The format of the float audio frames.</param>
+        /// <param name="referenceFrequency">The frequency of the tone at speed, or 0 to take the first second of tone.</param>
+        WowFlutterAnalyzer(
+            Windows::Media::MediaProperties::AudioEncodingProperties^ encodingProperties,
+            double referenceFrequency);
+
+        /// <summary>
+        /// Gets the audio encoding properties.
+        /// </summary>
+        property Windows::Media::MediaProperties::AudioEncodingProperties^ EncodingProperties
+        {
+            Windows::Media::MediaProperties::AudioEncodingProperties^ get();
+        }
+
+        /// <summary>
+        /// Gets the frequency of the tone at speed; 0 until it has been learned.
+        /// </summary>
+        property double ReferenceFrequency
+        {
+            double get();
+        }
+
+        /// <summary>
+        /// Event handler for the speed measured, 100 times a second of audio.
+        /// </summary>
+        event Windows::Foundation::TypedEventHandler<WowFlutterAnalyzer^, WowFlutterMeasuredEventArgs^>^ Measured;
+
+        /// <summary>
+        /// process an <see cref="Windows::Media::AudioFrame" />.
+        /// </summary>
+        void ProcessFrame(Windows::Media::AudioFrame^ frame);
+
+    private:
+        /// <summary>
+        /// The audio encoding properties.
+        /// </summary>
+        Windows::Media::MediaProperties::AudioEncodingProperties^ m_encodingProperties;
+
+        /// <summary>
+        /// The portable analyzer.
+        /// </summary>
+        std::unique_ptr<CrazyGiraffe::Core::WowFlutterAnalyzer> m_analyzer;
+    };
+} }
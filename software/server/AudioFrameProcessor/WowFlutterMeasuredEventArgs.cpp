@@ -0,0 +1,45 @@
+//-----------------------------------------------------------------------
+// <copyright file="WowFlutterMeasuredEventArgs.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "WowFlutterMeasuredEventArgs.h"
+
+using namespace CrazyGiraffe::AudioFrameProcessor;
+
+WowFlutterMeasuredEventArgs::WowFlutterMeasuredEventArgs(const CrazyGiraffe::Core::WowFlutter& measured)
+    : m_measured(measured)
+{
+}
+
+bool WowFlutterMeasuredEventArgs::IsLocked::get()
+{
+    return m_measured.locked;
+}
+
+double WowFlutterMeasuredEventArgs::Frequency::get()
+{
+    return m_measured.frequency;
+}
+
+double WowFlutterMeasuredEventArgs::Drift::get()
+{
+    return m_measured.drift;
+}
+
+double WowFlutterMeasuredEventArgs::Wow::get()
+{
+    return m_measured.wow;
+}
+
+double WowFlutterMeasuredEventArgs::Flutter::get()
+{
+    return m_measured.flutter;
+}
+
+double WowFlutterMeasuredEventArgs::Correction::get()
+{
+    return m_measured.correction;
+}
@@ -0,0 +1,82 @@
+//-----------------------------------------------------------------------
+// <copyright file="WowFlutterMeasuredEventArgs.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "Core/WowFlutterAnalyzer.h"
+
+namespace CrazyGiraffe { namespace AudioFrameProcessor
+{
+    /// <summary>
+    ///  The speed of the tape, measured from a steady tone. Deviations are relative to the reference
+    ///  frequency: 0.01 is 1% fast.
+    /// </summary>
+    public ref class WowFlutterMeasuredEventArgs sealed
+    {
+    public:
+        /// <summary>
+        /// Gets a value indicating whether a tone is being tracked. The measurements hold their last
+        /// values while it isn't.
+        /// </summary>
+        property bool IsLocked
+        {
+            bool get();
+        }
+
+        /// <summary>
+        /// Gets the frequency of the tone in Hz, without the wow and flutter.
+        /// </summary>
+        property double Frequency
+        {
+            double get();
+        }
+
+        /// <summary>
+        /// Gets the steady speed error, below 0.5Hz.
+        /// </summary>
+        property double Drift
+        {
+            double get();
+        }
+
+        /// <summary>
+        /// Gets the RMS of the speed variation from 0.5Hz to 6Hz.
+        /// </summary>
+        property double Wow
+        {
+            double get();
+        }
+
+        /// <summary>
+        /// Gets the RMS of the speed variation from 6Hz to 200Hz.
+        /// </summary>
+        property double Flutter
+        {
+            double get();
+        }
+
+        /// <summary>
+        /// Gets what to scale the motor speed by to play at speed.
+        /// </summary>
+        property double Correction
+        {
+            double get();
+        }
+
+    internal:
+        /// <summary>
+        /// Initializes a new instance of the <see cref="WowFlutterMeasuredEventArgs" /> class.
+        /// </summary>
+        /// <param name="measured">The speed measured.</param>
+        WowFlutterMeasuredEventArgs(const CrazyGiraffe::Core::WowFlutter& measured);
+
+    private:
+        /// <summary>
+        /// The speed measured.
+        /// </summary>
+        CrazyGiraffe::Core::WowFlutter m_measured;
+    };
+} }
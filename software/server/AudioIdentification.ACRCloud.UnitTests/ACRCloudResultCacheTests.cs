@@ -0,0 +1,203 @@
+﻿//-----------------------------------------------------------------------
+// <copyright file="ACRCloudResultCacheTests.cs" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+namespace CrazyGiraffe.AudioIdentification.ACRCloud.UnitTests
+{
+    using System;
+    using System.Collections.Generic;
+    using System.Threading;
+    using CrazyGiraffe.AudioIdentification;
+    using CrazyGiraffe.AudioIdentification.ACRCloud;
+    using Microsoft.VisualStudio.TestTools.UnitTesting;
+    using Windows.Security.Cryptography;
+    using Windows.Storage.Streams;
+
+    /// <summary>
+    /// A class to test <see cref="ACRCloudResultCache"/>.
+    /// </summary>
+    [TestClass]
+    public class ACRCloudResultCacheTests
+    {
+        /// <summary>
+        /// Test the default values of an <see cref="ACRCloudResultCache"/>.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudResultCacheDefaults()
+        {
+            ACRCloudResultCache cache = new ACRCloudResultCache();
+            Assert.IsTrue(cache.Capacity > 0, "Capacity");
+            Assert.IsTrue(cache.TimeToLive > TimeSpan.Zero, "TimeToLive");
+            Assert.AreEqual(0u, cache.Count, "Count");
+            Assert.AreEqual(0ul, cache.HitCount, "HitCount");
+            Assert.AreEqual(0ul, cache.MissCount, "MissCount");
+            Assert.AreEqual(0.0, cache.HitRate, "HitRate");
+        }
+
+        /// <summary>
+        /// Test invalid arguments to an <see cref="ACRCloudResultCache"/>.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudResultCacheInvalidArguments()
+        {
+            Assert.ThrowsException<ArgumentException>(() => new ACRCloudResultCache(0, TimeSpan.FromMinutes(1), 0));
+            Assert.ThrowsException<ArgumentException>(() => new ACRCloudResultCache(1, TimeSpan.FromMinutes(1), 64));
+
+            ACRCloudResultCache cache = new ACRCloudResultCache();
+            Assert.ThrowsException<ArgumentException>(() => cache.Lookup(null));
+            Assert.ThrowsException<ArgumentException>(() => cache.Add(null, CreateResponse()));
+            Assert.ThrowsException<ArgumentException>(() => cache.Add(CreateFingerprint(1, 0), null));
+        }
+
+        /// <summary>
+        /// Test a cache hit for the same fingerprint.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudResultCacheExactHit()
+        {
+            ACRCloudResultCache cache = new ACRCloudResultCache();
+            ACRCloudTrackResponse response = CreateResponse();
+
+            Assert.IsNull(cache.Lookup(CreateFingerprint(1, 0)), "Lookup");
+            cache.Add(CreateFingerprint(1, 0), response);
+            Assert.AreEqual(1u, cache.Count, "Count");
+
+            Assert.AreSame(response, cache.Lookup(CreateFingerprint(1, 0)), "Lookup");
+            Assert.AreEqual(1ul, cache.HitCount, "HitCount");
+            Assert.AreEqual(1ul, cache.MissCount, "MissCount");
+            Assert.AreEqual(0.5, cache.HitRate, "HitRate");
+        }
+
+        /// <summary>
+        /// Test a cache hit for a fingerprint that differs slightly.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudResultCacheNearHit()
+        {
+            ACRCloudResultCache cache = new ACRCloudResultCache();
+            ACRCloudTrackResponse response = CreateResponse();
+
+            cache.Add(CreateFingerprint(1, 0), response);
+            Assert.AreSame(response, cache.Lookup(CreateFingerprint(1, 1)), "Lookup");
+        }
+
+        /// <summary>
+        /// Test a cache miss for a different fingerprint.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudResultCacheMiss()
+        {
+            ACRCloudResultCache cache = new ACRCloudResultCache();
+            cache.Add(CreateFingerprint(1, 0), CreateResponse());
+
+            Assert.IsNull(cache.Lookup(CreateFingerprint(2, 0)), "Lookup");
+            Assert.AreEqual(0ul, cache.HitCount, "HitCount");
+            Assert.AreEqual(1ul, cache.MissCount, "MissCount");
+        }
+
+        /// <summary>
+        /// Test the least recently used response is evicted.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudResultCacheEviction()
+        {
+            ACRCloudResultCache cache = new ACRCloudResultCache(2, TimeSpan.FromMinutes(1), 0);
+            ACRCloudTrackResponse response = CreateResponse();
+
+            cache.Add(CreateFingerprint(1, 0), response);
+            cache.Add(CreateFingerprint(2, 0), response);
+            Assert.IsNotNull(cache.Lookup(CreateFingerprint(1, 0)), "Lookup");
+
+            cache.Add(CreateFingerprint(3, 0), response);
+            Assert.AreEqual(2u, cache.Count, "Count");
+            Assert.IsNotNull(cache.Lookup(CreateFingerprint(1, 0)), "Lookup 1");
+            Assert.IsNull(cache.Lookup(CreateFingerprint(2, 0)), "Lookup 2");
+            Assert.IsNotNull(cache.Lookup(CreateFingerprint(3, 0)), "Lookup 3");
+        }
+
+        /// <summary>
+        /// Test expired responses are not returned.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudResultCacheExpiry()
+        {
+            ACRCloudResultCache cache = new ACRCloudResultCache(2, TimeSpan.Zero, 0);
+            cache.Add(CreateFingerprint(1, 0), CreateResponse());
+
+            Assert.IsNull(cache.Lookup(CreateFingerprint(1, 0)), "Lookup");
+            Assert.AreEqual(0u, cache.Count, "Count");
+        }
+
+        /// <summary>
+        /// Test an expired response doesn't hide a live one which is near.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudResultCacheExpiredSkipped()
+        {
+            ACRCloudResultCache cache = new ACRCloudResultCache(2, TimeSpan.FromMilliseconds(500), 3);
+            ACRCloudTrackResponse response = CreateResponse();
+
+            cache.Add(CreateFingerprint(1, 0), CreateResponse());
+            Thread.Sleep(300);
+            cache.Add(CreateFingerprint(1, 1), response);
+            Thread.Sleep(300);
+
+            Assert.AreSame(response, cache.Lookup(CreateFingerprint(1, 0)), "Lookup");
+            Assert.AreEqual(1u, cache.Count, "Count");
+        }
+
+        /// <summary>
+        /// Test clearing the cache.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudResultCacheClear()
+        {
+            ACRCloudResultCache cache = new ACRCloudResultCache();
+            cache.Add(CreateFingerprint(1, 0), CreateResponse());
+            cache.Clear();
+
+            Assert.AreEqual(0u, cache.Count, "Count");
+            Assert.IsNull(cache.Lookup(CreateFingerprint(1, 0)), "Lookup");
+        }
+
+        /// <summary>
+        /// Create a fingerprint.
+        /// </summary>
+        /// <param name="seed">The seed for the fingerprint content.</param>
+        /// <param name="changes">The number of bytes to change.</param>
+        /// <returns>The fingerprint.</returns>
+        private static IBuffer CreateFingerprint(int seed, int changes)
+        {
+            Random random = new Random(seed);
+            byte[] fingerprint = new byte[4096];
+            random.NextBytes(fingerprint);
+
+            for (int i = 0; i < changes; i++)
+            {
+                fingerprint[fingerprint.Length / 2 + i] ^= 0xFF;
+            }
+
+            return CryptographicBuffer.CreateFromByteArray(fingerprint);
+        }
+
+        /// <summary>
+        /// Create a response.
+        /// </summary>
+        /// <returns>The response.</returns>
+        private static ACRCloudTrackResponse CreateResponse()
+        {
+            List<IReadOnlyTrack> tracks = new List<IReadOnlyTrack>()
+            {
+                new Track()
+                {
+                    Title = "Title",
+                    Artist = "Artist",
+                },
+            };
+
+            return new ACRCloudTrackResponse("Success", "1.0", 0, tracks.AsReadOnly());
+        }
+    }
+}
@@ -0,0 +1,84 @@
+﻿//-----------------------------------------------------------------------
+// <copyright file="ACRCloudRetryPolicyTests.cs" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+namespace CrazyGiraffe.AudioIdentification.ACRCloud.UnitTests
+{
+    using System;
+    using CrazyGiraffe.AudioIdentification.ACRCloud;
+    using Microsoft.VisualStudio.TestTools.UnitTesting;
+
+    /// <summary>
+    /// A class to test <see cref="ACRCloudRetryPolicy"/>.
+    /// </summary>
+    [TestClass]
+    public class ACRCloudRetryPolicyTests
+    {
+        /// <summary>
+        /// Test the default values of an <see cref="ACRCloudRetryPolicy"/>.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudRetryPolicyDefaults()
+        {
+            ACRCloudRetryPolicy policy = new ACRCloudRetryPolicy();
+            Assert.IsTrue(policy.MaxAttempts > 1, "MaxAttempts");
+            Assert.IsTrue(policy.Deadline > TimeSpan.Zero, "Deadline");
+            Assert.IsTrue(policy.InitialBackoff <= policy.MaximumBackoff, "InitialBackoff");
+            Assert.IsTrue(policy.BackoffMultiplier >= 1.0, "BackoffMultiplier");
+            Assert.IsTrue(policy.Jitter >= 0.0 && policy.Jitter <= 1.0, "Jitter");
+            Assert.IsTrue(policy.HedgingEnabled, "HedgingEnabled");
+            Assert.IsTrue(policy.MaximumHedgeRatio > 0.0 && policy.MaximumHedgeRatio < 1.0, "MaximumHedgeRatio");
+            Assert.AreEqual(0ul, policy.RequestCount, "RequestCount");
+            Assert.AreEqual(0ul, policy.RetryCount, "RetryCount");
+            Assert.AreEqual(0ul, policy.HedgeCount, "HedgeCount");
+            Assert.AreEqual(TimeSpan.Zero, policy.LatencyP95, "LatencyP95");
+        }
+
+        /// <summary>
+        /// Test setting the values of an <see cref="ACRCloudRetryPolicy"/>.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudRetryPolicySetValues()
+        {
+            ACRCloudRetryPolicy policy = new ACRCloudRetryPolicy()
+            {
+                MaxAttempts = 5,
+                Deadline = TimeSpan.FromSeconds(30),
+                InitialBackoff = TimeSpan.FromMilliseconds(100),
+                MaximumBackoff = TimeSpan.FromSeconds(2),
+                BackoffMultiplier = 3.0,
+                Jitter = 0.25,
+                HedgingEnabled = false,
+                InitialHedgeDelay = TimeSpan.FromSeconds(1),
+                MaximumHedgeRatio = 0.05,
+            };
+
+            Assert.AreEqual(5u, policy.MaxAttempts, "MaxAttempts");
+            Assert.AreEqual(TimeSpan.FromSeconds(30), policy.Deadline, "Deadline");
+            Assert.AreEqual(TimeSpan.FromMilliseconds(100), policy.InitialBackoff, "InitialBackoff");
+            Assert.AreEqual(TimeSpan.FromSeconds(2), policy.MaximumBackoff, "MaximumBackoff");
+            Assert.AreEqual(3.0, policy.BackoffMultiplier, "BackoffMultiplier");
+            Assert.AreEqual(0.25, policy.Jitter, "Jitter");
+            Assert.IsFalse(policy.HedgingEnabled, "HedgingEnabled");
+            Assert.AreEqual(TimeSpan.FromSeconds(1), policy.InitialHedgeDelay, "InitialHedgeDelay");
+            Assert.AreEqual(0.05, policy.MaximumHedgeRatio, "MaximumHedgeRatio");
+        }
+
+        /// <summary>
+        /// Test invalid values for an <see cref="ACRCloudRetryPolicy"/>.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudRetryPolicyInvalidValues()
+        {
+            ACRCloudRetryPolicy policy = new ACRCloudRetryPolicy();
+            Assert.ThrowsException<ArgumentException>(() => policy.MaxAttempts = 0);
+            Assert.ThrowsException<ArgumentException>(() => policy.Deadline = TimeSpan.Zero);
+            Assert.ThrowsException<ArgumentException>(() => policy.InitialBackoff = TimeSpan.FromSeconds(-1));
+            Assert.ThrowsException<ArgumentException>(() => policy.BackoffMultiplier = 0.5);
+            Assert.ThrowsException<ArgumentException>(() => policy.Jitter = 1.5);
+            Assert.ThrowsException<ArgumentException>(() => policy.MaximumHedgeRatio = -0.1);
+        }
+    }
+}
@@ -44,5 +44,43 @@ namespace CrazyGiraffe.AudioIdentification.ACRCloud.UnitTests
             ISession session = await factory.CreateSessionAsync(options);
             Assert.IsNotNull(session, "session");
         }
+
+        /// <summary>
+        /// Test the audio is fingerprinted as it is unless asked otherwise.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudSessionFactoryDefaults()
+        {
+            ACRCloudSessionFactory factory = new ACRCloudSessionFactory(new ACRCloudClientIdData());
+            Assert.IsFalse(factory.IsSpeedCorrectionEnabled, "IsSpeedCorrectionEnabled");
+            Assert.IsFalse(factory.IsNoiseReductionEnabled, "IsNoiseReductionEnabled");
+        }
+
+        /// <summary>
+        /// Test the on-disk cache is off by default, and is shared read-only while another process writes it.
+        /// </summary>
+        [TestMethod]
+        public void ACRCloudSessionFactoryPersistentCache()
+        {
+            ACRCloudClientIdData cientIdData = new ACRCloudClientIdData()
+            {
+                Host = "Host",
+                AccessKey = "AccessKey",
+                AccessSecret = "AccessSecret",
+            };
+
+            ACRCloudSessionFactory writer = new ACRCloudSessionFactory(cientIdData);
+            ACRCloudSessionFactory reader = new ACRCloudSessionFactory(cientIdData);
+            Assert.IsNull(writer.PersistentCache, "Default PersistentCache");
+
+            writer.PersistentCache = ACRCloudSessionFactory.OpenPersistentCache();
+            reader.PersistentCache = ACRCloudSessionFactory.OpenPersistentCache();
+            Assert.IsNotNull(writer.PersistentCache, "writer.PersistentCache");
+            Assert.IsNotNull(reader.PersistentCache, "reader.PersistentCache");
+            Assert.IsTrue(reader.PersistentCache.IsReadOnly, "reader.IsReadOnly");
+
+            writer.PersistentCache.Dispose();
+            reader.PersistentCache.Dispose();
+        }
     }
 }
@@ -99,6 +99,107 @@ namespace CrazyGiraffe.AudioIdentification.ACRCloud.UnitTests
             }
         }
 
+        /// <summary>
+        /// Test a failed query is retried by the factory's <see cref="ACRCloudRetryPolicy"/>.
+        /// </summary>
+        /// <returns>A task that can be awaited.</returns>
+        [TestMethod]
+        public async Task AddAudioSampleRetry()
+        {
+            using (TestHttpFilter filter = new TestHttpFilter())
+            using (HttpResponseMessage unavailableResponse = new HttpResponseMessage(HttpStatusCode.ServiceUnavailable))
+            using (HttpResponseMessage okResponse = new HttpResponseMessage(HttpStatusCode.Ok))
+            using (HttpStringContent trackContent = new HttpStringContent(ACRCloudClientTests.GetCanonicalTrackResponse()))
+            {
+                okResponse.Content = trackContent;
+                filter.Responses.Add(unavailableResponse);
+                filter.Responses.Add(okResponse);
+
+                ACRCloudClientIdData clientdata = new ACRCloudClientIdData()
+                {
+                    Host = "host",
+                    AccessKey = "access_key",
+                    AccessSecret = "access_secret",
+                };
+
+                ACRCloudSessionFactory factory = new ACRCloudSessionFactory(clientdata, filter);
+                factory.ResultCache = null;
+                factory.PersistentCache = null;
+                factory.RetryPolicy.InitialBackoff = TimeSpan.FromMilliseconds(10);
+
+                SessionOptions options = GetSessionOptions(audioSampleSize: 32);
+                ISession session = await factory.CreateSessionAsync(options);
+                Assert.IsNotNull(session, "session");
+
+                var completeStatusTaskCompletionSource = new TaskCompletionSource<bool>();
+                session.StatusChanged += (sender, e) =>
+                {
+                    if (e.Status == IdentifyStatus.Complete)
+                    {
+                        completeStatusTaskCompletionSource.TrySetResult(true);
+                    }
+                };
+
+                uint blockSize = 1764; // 176400 bytes per second @ 44.1k, 2 channels, 16 bits per sample, or 1764 bytes per 10 ms.
+                uint blocksCount = 12 * 100; // 12 seconds @ 10ms each.
+                WrappedAudioFrame frame = WrappedAudioFrame.CreateRandom(blockSize * blocksCount);
+
+                AudioEncodingProperties encodingProperties = AudioEncodingProperties.CreatePcm(options.SampleRate, options.ChannelCount, options.SampleSize);
+                AudioFrameConverter converter = new AudioFrameConverter(encodingProperties);
+                session.AddAudioSample(converter.ToByteArray(frame.CurrentFrame));
+
+                Assert.IsTrue(completeStatusTaskCompletionSource.Task.Wait(5000), "Task.Wait");
+                Assert.AreEqual(2, filter.Requests.Count, "filter.Requests.Count");
+                Assert.AreEqual(1ul, factory.RetryPolicy.RetryCount, "RetryCount");
+            }
+        }
+
+        /// <summary>
+        /// Test that disposing a session aborts the query in flight.
+        /// </summary>
+        /// <returns>A task that can be awaited.</returns>
+        [TestMethod]
+        public async Task AddAudioSampleDisposeCancelsQuery()
+        {
+            using (TestHttpFilter filter = new TestHttpFilter() { Delay = TimeSpan.FromMinutes(1) })
+            using (HttpResponseMessage okResponse = new HttpResponseMessage(HttpStatusCode.Ok))
+            using (HttpStringContent trackContent = new HttpStringContent(ACRCloudClientTests.GetCanonicalTrackResponse()))
+            {
+                okResponse.Content = trackContent;
+                filter.Responses.Add(okResponse);
+
+                var requestReceivedTaskCompletionSource = new TaskCompletionSource<bool>();
+                filter.RequestReceived += (sender, e) =>
+                {
+                    requestReceivedTaskCompletionSource.TrySetResult(true);
+                };
+
+                var requestCanceledTaskCompletionSource = new TaskCompletionSource<bool>();
+                filter.RequestCanceled += (sender, e) =>
+                {
+                    requestCanceledTaskCompletionSource.TrySetResult(true);
+                };
+
+                ISession session = await CreateSessionAsync(httpFilter: filter).ConfigureAwait(false);
+                Assert.IsNotNull(session, "session");
+
+                uint blockSize = 1764; // 176400 bytes per second @ 44.1k, 2 channels, 16 bits per sample, or 1764 bytes per 10 ms.
+                uint blocksCount = 12 * 100; // 12 seconds @ 10ms each.
+                WrappedAudioFrame frame = WrappedAudioFrame.CreateRandom(blockSize * blocksCount);
+
+                SessionOptions options = GetSessionOptions(audioSampleSize: 32);
+                AudioEncodingProperties encodingProperties = AudioEncodingProperties.CreatePcm(options.SampleRate, options.ChannelCount, options.SampleSize);
+                AudioFrameConverter converter = new AudioFrameConverter(encodingProperties);
+                session.AddAudioSample(converter.ToByteArray(frame.CurrentFrame));
+
+                Assert.IsTrue(requestReceivedTaskCompletionSource.Task.Wait(5000), "RequestReceived");
+
+                ((IDisposable)session).Dispose();
+                Assert.IsTrue(requestCanceledTaskCompletionSource.Task.Wait(5000), "RequestCanceled");
+                Assert.AreNotEqual(IdentifyStatus.Complete, session.IdentificationStatus, "session.IdentificationStatus");
+            }
+        }
+
         /// <summary>
         /// Test the ability to call AddAudioSample and ensure it buffers correctly..
         /// </summary>
@@ -160,6 +261,131 @@ namespace CrazyGiraffe.AudioIdentification.ACRCloud.UnitTests
             session.AddAudioSample(null);
         }
 
+        /// <summary>
+        /// Test the stages of an identification are recorded by the session and added up by the factory.
+        /// </summary>
+        /// <returns>A task that can be awaited.</returns>
+        [TestMethod]
+        public async Task AddAudioSampleMetrics()
+        {
+            using (TestHttpFilter filter = new TestHttpFilter())
+            using (HttpResponseMessage okResponse = new HttpResponseMessage(HttpStatusCode.Ok))
+            using (HttpStringContent trackContent = new HttpStringContent(ACRCloudClientTests.GetCanonicalTrackResponse()))
+            {
+                okResponse.Content = trackContent;
+                filter.Responses.Add(okResponse);
+
+                ACRCloudClientIdData clientdata = new ACRCloudClientIdData()
+                {
+                    Host = "host",
+                    AccessKey = "access_key",
+                    AccessSecret = "access_secret",
+                };
+
+                // No caches, so the query goes out.
+                ACRCloudSessionFactory factory = new ACRCloudSessionFactory(clientdata, filter)
+                {
+                    ResultCache = null,
+                    PersistentCache = null,
+                };
+
+                SessionOptions options = GetSessionOptions();
+                ACRCloudSession session = (ACRCloudSession)await factory.CreateSessionAsync(options);
+                Assert.IsNotNull(session, "session");
+
+                var completeStatusTaskCompletionSource = new TaskCompletionSource<bool>();
+                session.StatusChanged += (sender, e) =>
+                {
+                    if (e.Status == IdentifyStatus.Complete)
+                    {
+                        completeStatusTaskCompletionSource.TrySetResult(true);
+                    }
+                };
+
+                uint blockSize = 1764; // 176400 bytes per second @ 44.1k, 2 channels, 16 bits per sample, or 1764 bytes per 10 ms.
+                uint blocksCount = 12 * 100; // 12 seconds @ 10ms each.
+                WrappedAudioFrame frame = WrappedAudioFrame.CreateRandom(blockSize * blocksCount);
+                AudioEncodingProperties encodingProperties = AudioEncodingProperties.CreatePcm(options.SampleRate, options.ChannelCount, options.SampleSize);
+                AudioFrameConverter converter = new AudioFrameConverter(encodingProperties);
+                byte[] audioData = converter.ToByteArray(frame.CurrentFrame);
+
+                session.AddAudioSample(audioData);
+                Assert.IsTrue(completeStatusTaskCompletionSource.Task.Wait(5000), "Task.Wait");
+
+                PipelineMetrics sessionMetrics = session.Metrics;
+                Assert.AreEqual((ulong)audioData.Length, sessionMetrics.Counters["audio_bytes"], "audio_bytes");
+                Assert.AreEqual(1UL, sessionMetrics.Counters["queries"], "queries");
+                Assert.AreEqual(1UL, sessionMetrics.Counters["identified"], "identified");
+                Assert.AreEqual(0UL, sessionMetrics.Counters["cache_hits"], "cache_hits");
+
+                foreach (string stage in new[] { "queue", "fingerprint", "query", "parse" })
+                {
+                    LatencySummary latency = sessionMetrics.Latencies[stage];
+                    Assert.AreNotEqual(0UL, latency.Count, stage);
+                    Assert.IsTrue(latency.Median <= latency.Percentile99, stage + " Median");
+                    Assert.IsTrue(latency.Percentile99 <= latency.Maximum, stage + " Percentile99");
+                }
+
+                PipelineMetrics factoryMetrics = factory.Metrics;
+                Assert.AreEqual(sessionMetrics.Counters["audio_bytes"], factoryMetrics.Counters["audio_bytes"], "factory audio_bytes");
+                Assert.AreEqual(sessionMetrics.Latencies["query"].Count, factoryMetrics.Latencies["query"].Count, "factory query");
+            }
+        }
+
+        /// <summary>
+        /// Test the stages of an identification are traced, and exported as Chrome trace-event JSON.
+        /// </summary>
+        /// <returns>A task that can be awaited.</returns>
+        [TestMethod]
+        public async Task AddAudioSampleTrace()
+        {
+            ACRCloudSessionFactory.IsTracingEnabled = true;
+            try
+            {
+                using (TestHttpFilter filter = new TestHttpFilter())
+                using (HttpResponseMessage okResponse = new HttpResponseMessage(HttpStatusCode.Ok))
+                using (HttpStringContent trackContent = new HttpStringContent(ACRCloudClientTests.GetCanonicalTrackResponse()))
+                {
+                    okResponse.Content = trackContent;
+                    filter.Responses.Add(okResponse);
+
+                    ISession session = await CreateSessionAsync(httpFilter: filter).ConfigureAwait(false);
+                    Assert.IsNotNull(session, "session");
+
+                    var completeStatusTaskCompletionSource = new TaskCompletionSource<bool>();
+                    session.StatusChanged += (sender, e) =>
+                    {
+                        if (e.Status == IdentifyStatus.Complete)
+                        {
+                            completeStatusTaskCompletionSource.TrySetResult(true);
+                        }
+                    };
+
+                    uint blockSize = 1764; // 176400 bytes per second @ 44.1k, 2 channels, 16 bits per sample, or 1764 bytes per 10 ms.
+                    uint blocksCount = 12 * 100; // 12 seconds @ 10ms each.
+                    WrappedAudioFrame frame = WrappedAudioFrame.CreateRandom(blockSize * blocksCount);
+                    SessionOptions options = GetSessionOptions();
+                    AudioEncodingProperties encodingProperties = AudioEncodingProperties.CreatePcm(options.SampleRate, options.ChannelCount, options.SampleSize);
+                    AudioFrameConverter converter = new AudioFrameConverter(encodingProperties);
+
+                    session.AddAudioSample(converter.ToByteArray(frame.CurrentFrame));
+                    Assert.IsTrue(completeStatusTaskCompletionSource.Task.Wait(5000), "Task.Wait");
+
+                    string trace = ACRCloudSessionFactory.ExportTrace();
+                    Assert.IsTrue(trace.StartsWith("{\"displayTimeUnit\"", StringComparison.Ordinal), "trace");
+                    Assert.IsTrue(trace.Contains(session.SessionIdentifier), "SessionIdentifier");
+                    foreach (string stage in new[] { "dequeue", "fingerprint", "complete" })
+                    {
+                        Assert.IsTrue(trace.Contains("\"name\":\"" + stage + "\""), stage);
+                    }
+                }
+            }
+            finally
+            {
+                ACRCloudSessionFactory.IsTracingEnabled = false;
+            }
+        }
+
         /// <summary>
         /// Create a new session using the default options.
         /// </summary>
@@ -317,6 +543,16 @@ namespace CrazyGiraffe.AudioIdentification.ACRCloud.UnitTests
             /// </summary>
             public event EventHandler<EventArgs> RequestReceived;
 
+            /// <summary>
+            /// An event raised when a delayed request is cancelled.
+            /// </summary>
+            public event EventHandler<EventArgs> RequestCanceled;
+
+            /// <summary>
+            /// Gets or sets the time to wait before responding.
+            /// </summary>
+            public TimeSpan Delay { get; set; } = TimeSpan.Zero;
+
             /// <summary>
             /// Gets the most recent request received.
             /// </summary>
@@ -337,12 +573,25 @@ namespace CrazyGiraffe.AudioIdentification.ACRCloud.UnitTests
             {
                 this.Requests.Add(request);
                 this.RequestReceived?.Invoke(this, new EventArgs());
-                return AsyncInfo.Run((CancellationToken cancellationToken, IProgress<HttpProgress> progress) =>
+                return AsyncInfo.Run(async (CancellationToken cancellationToken, IProgress<HttpProgress> progress) =>
                 {
                     progress.Report(default);
 
                     try
                     {
+                        if (this.Delay > TimeSpan.Zero)
+                        {
+                            try
+                            {
+                                await Task.Delay(this.Delay, cancellationToken).ConfigureAwait(false);
+                            }
+                            catch (OperationCanceledException)
+                            {
+                                this.RequestCanceled?.Invoke(this, new EventArgs());
+                                throw;
+                            }
+                        }
+
                         HttpResponseMessage response = this.Responses.Count > 0 ? this.Responses[this.ResponsesIndex] : null;
                         if (response != null)
                         {
@@ -354,7 +603,7 @@ namespace CrazyGiraffe.AudioIdentification.ACRCloud.UnitTests
                             this.ResponsesIndex++;
                         }
 
-                        return Task.FromResult(response);
+                        return response;
                     }
                     finally
                     {
@@ -7,18 +7,19 @@
 #include "pch.h"
 #include "ACRCloudClient.h"
 #include "ACRCloudHelpers.h"
+#include "Core/ACRCloudCodec.h"
+#include "Core/Json.h"
 #include <sstream>
+#include <atomic>
 #include <chrono>
+#include <memory>
 
 using namespace std;
 using namespace Concurrency;
 using namespace Platform;
 using namespace Platform::Collections;
-using namespace Windows::Data::Json;
 using namespace Windows::Foundation;
 using namespace Windows::Foundation::Collections;
-using namespace Windows::Security::Cryptography;
-using namespace Windows::Security::Cryptography::Core;
 using namespace Windows::Storage::Streams;
 using namespace Windows::Web;
 using namespace Windows::Web::Http;
@@ -26,6 +27,7 @@ using namespace Windows::Web::Http::Filters;
 using namespace Windows::Web::Http::Headers;
 using namespace CrazyGiraffe::AudioIdentification;
 using namespace CrazyGiraffe::AudioIdentification::ACRCloud;
+using namespace CrazyGiraffe::Core;
 
 ACRCloudClient::ACRCloudClient(ACRCloudClientIdData^ clientdata)
     : m_clientdata(clientdata)
@@ -41,26 +43,7 @@ ACRCloudClient::ACRCloudClient(ACRCloudClientIdData^ clientdata, IHttpFilter^ ht
 
 String^ ACRCloudClient::CreateSignature(String^ input, String^ key)
 {
-    String^ hashValue = nullptr;
-    try
-    {
-        MacAlgorithmProvider^ provider = MacAlgorithmProvider::OpenAlgorithm(MacAlgorithmNames::HmacSha1);
-
-        IBuffer^ keyBuffer = CryptographicBuffer::ConvertStringToBinary(key, BinaryStringEncoding::Utf8);
-        CryptographicHash^ hash = provider->CreateHash(keyBuffer);
-
-        IBuffer^ inputBuffer = CryptographicBuffer::ConvertStringToBinary(input, BinaryStringEncoding::Utf8);
-        hash->Append(inputBuffer);
-        IBuffer^ hashBuffer = hash->GetValueAndReset();
-
-        hashValue = CryptographicBuffer::EncodeToBase64String(hashBuffer);
-    }
-    catch (Exception ^ ex)
-    {
-        LogMessage("CreateSignature exception: %s", ex->Message);
-    }
-
-    return hashValue;
+    return FromUtf8(ACRCloudCodec::CreateSignature(ToUtf8(input), ToUtf8(key)));
 }
 
 IAsyncOperation<HttpRequestResult^>^ ACRCloudClient::QueryTrackInfoAsync(IBuffer^ fingerprintBuffer)
@@ -68,9 +51,8 @@ IAsyncOperation<HttpRequestResult^>^ ACRCloudClient::QueryTrackInfoAsync(IBuffer
     // E1740 error - [this] seems to be an error but it's a bug in VS2019.
     // It will show as an error in the editor and during a failed compilation
     // but will compile cleanly. Move along, nothing to see here.
-    return create_async([this, &fingerprintBuffer]() -> task<HttpRequestResult^>
+    return create_async([this, fingerprintBuffer](cancellation_token cancellationToken) -> task<HttpRequestResult^>
         {
-            int rc = 0;
             try
             {
                 if (fingerprintBuffer == nullptr)
@@ -78,284 +60,325 @@ IAsyncOperation<HttpRequestResult^>^ ACRCloudClient::QueryTrackInfoAsync(IBuffer
                     return task_from_result(static_cast<HttpRequestResult^>(nullptr));
                 };
 
-                wstring method = L"POST";
-                wstring path = L"/v1/identify";
-                wstring dataType = L"fingerprint";
-                wstring signatureVersion = L"1";
-                wstring boundryHeader = L"acrcloud___copyright___2015___";
-
-                // Create request URL.
-                wstringstream requestUrlStream;
-                requestUrlStream << L"http://" << this->m_clientdata->Host->Data() << path;
-                const wstring requestUrlWstr = requestUrlStream.str();
-                Uri^ resourceUrl = ref new Uri(ref new String(requestUrlWstr.c_str()));
-
-                // Create timestamp.
-                time_t ltime;
-                wstringstream timestamp;
+                // Send request.
+                HttpClient^ httpClient = GetHttpClient();
+                return create_task(httpClient->TryPostAsync(CreateRequestUri(), CreateRequestContent(fingerprintBuffer)), cancellationToken);
+            }
+            catch (Exception ^ ex)
+            {
+                LOG_ERROR("QueryTrackInfoAsync exception: %s", ex->Message);
+                throw;
+            }
+        });
+}
 
-                time(&ltime);
-                timestamp << ltime;
+task<String^> ACRCloudClient::QueryTrackResponseAsync(IBuffer^ fingerprintBuffer, ACRCloudRetryPolicy^ policy, cancellation_token cancellationToken)
+{
+    if (fingerprintBuffer == nullptr || cancellationToken.is_canceled())
+    {
+        return task_from_result<String^>(nullptr);
+    }
 
-                // Create signature.
-                wstringstream signatureInput;
-                signatureInput << method << L"\n" << path << L"\n" << this->m_clientdata->AccessKey->Data() << L"\n";
-                signatureInput << dataType << L"\n" << signatureVersion << L"\n" << ltime;
+    // No policy, no retries.
+    if (policy == nullptr)
+    {
+        policy = ref new ACRCloudRetryPolicy();
+        policy->MaxAttempts = 1;
+        policy->HedgingEnabled = false;
+    }
 
-                String^ signatureInputString = ref new String(signatureInput.str().c_str());
-                String^ signature = CreateSignature(signatureInputString, this->m_clientdata->AccessSecret);
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + policy->GetDeadline();
+    return QueryAttemptAsync(fingerprintBuffer, policy, 1, deadline, cancellationToken);
+}
 
-                // Create mime boundry.
-                FILETIME filetime;
-                ::GetSystemTimeAsFileTime(&filetime);
-                unsigned __int64 ticks = (__int64(filetime.dwHighDateTime) << 32LL) + __int64(filetime.dwLowDateTime);
+IAsyncOperation<ACRCloudTrackResponse^>^ ACRCloudClient::ParseTrackResponseAync(Platform::String^ responseBody)
+{
+    return create_async([responseBody]() -> task<ACRCloudTrackResponse^>
+        {
+            ACRCloudTrackResult result;
+            try
+            {
+                result = ACRCloudCodec::ParseTrackResponse(ToUtf8(responseBody));
+            }
+            catch (const JsonError& ex)
+            {
+                LOG_WARNING("ParseTrackResponseAync exception: %s", ex.what());
+                throw ref new InvalidArgumentException(L"responseBody");
+            }
 
-                const unsigned __int64 TicksPerDay = 864000000000;
-                unsigned __int64 ticksPerYear = TicksPerDay * 365;
-                unsigned __int64 ticksSince1601 = (ticksPerYear * 1601) + (TicksPerDay * 23);
-                ticksSince1601 += (TicksPerDay * 23); // the is calculated emperically.
+            Vector<IReadOnlyTrack^>^ tracks = ref new Vector<IReadOnlyTrack^>();
+            for (const TrackInfo& trackInfo : result.tracks)
+            {
+                // Optional fields stay unset, as a new track has them.
+                Track^ track = ref new Track();
+                track->Identifier = FromUtf8(trackInfo.identifier);
+                track->Title = FromUtf8(trackInfo.title);
+                track->Artist = FromUtf8(trackInfo.artist);
+                track->Album = FromUtf8(trackInfo.album);
+                track->MatchConfidence = FromUtf8(trackInfo.matchConfidence);
+                track->Duration = trackInfo.duration;
+                track->MatchPosition = trackInfo.matchPosition;
+                track->CurrentPosition = trackInfo.currentPosition;
+
+                if (!trackInfo.genre.empty())
+                {
+                    track->Genre = FromUtf8(trackInfo.genre);
+                }
 
-                wstringstream boundry;
-                boundry << boundryHeader << hex << ticks + ticksSince1601;
+                if (!trackInfo.coverArtUrl.empty())
+                {
+                    track->CovertArtImage = ref new Uri(FromUtf8(trackInfo.coverArtUrl));
+                }
 
-                // Setup multi-part form data.
-                const wstring boundryWstr = boundry.str();
-                String^ boundryStr = ref new String(boundryWstr.c_str());
-                HttpMultipartFormDataContent^ formContent = ref new HttpMultipartFormDataContent(boundryStr);
+                tracks->Append(track);
+            }
 
-                HttpStringContent^ accessKeyContent = ref new HttpStringContent(this->m_clientdata->AccessKey);
-                formContent->Add(accessKeyContent, L"access_key");
+            return task_from_result(ref new ACRCloudTrackResponse(
+                FromUtf8(result.message),
+                FromUtf8(result.version),
+                result.code,
+                tracks->GetView()));
+        });
+}
 
-                HttpStringContent^ timestampContent = ref new HttpStringContent(ref new String(timestamp.str().c_str()));
-                formContent->Add(timestampContent, L"timestamp");
+HttpClient^ ACRCloudClient::GetHttpClient()
+{
+    if (m_httpFilter != nullptr)
+    {
+        return ref new HttpClient(m_httpFilter);
+    }
 
-                HttpStringContent^ signatureContent = ref new HttpStringContent(signature);
-                formContent->Add(signatureContent, L"signature");
+    return ref new HttpClient();
+}
 
-                HttpStringContent^ dataTypeContent = ref new HttpStringContent(ref new String(dataType.c_str()));
-                formContent->Add(dataTypeContent, L"data_type");
+Uri^ ACRCloudClient::CreateRequestUri()
+{
+    wstringstream requestUrlStream;
+    requestUrlStream << L"http://" << this->m_clientdata->Host->Data() << ACRCloudCodec::RequestPath;
+    const wstring requestUrlWstr = requestUrlStream.str();
+    return ref new Uri(ref new String(requestUrlWstr.c_str()));
+}
 
-                HttpStringContent^ signatureVersionContent = ref new HttpStringContent(ref new String(signatureVersion.c_str()));
-                formContent->Add(signatureVersionContent, L"signature_version");
+HttpMultipartFormDataContent^ ACRCloudClient::CreateRequestContent(IBuffer^ fingerprintBuffer)
+{
+    // Create the signed fields.
+    time_t ltime;
+    time(&ltime);
+    ACRCloudRequestFields fields = ACRCloudCodec::CreateRequestFields(
+        ToUtf8(this->m_clientdata->AccessKey),
+        ToUtf8(this->m_clientdata->AccessSecret),
+        static_cast<int64_t>(ltime),
+        fingerprintBuffer->Length);
+
+    // Create mime boundry.
+    FILETIME filetime;
+    ::GetSystemTimeAsFileTime(&filetime);
+    unsigned __int64 ticks = (__int64(filetime.dwHighDateTime) << 32LL) + __int64(filetime.dwLowDateTime);
+
+    const unsigned __int64 TicksPerDay = 864000000000;
+    unsigned __int64 ticksPerYear = TicksPerDay * 365;
+    unsigned __int64 ticksSince1601 = (ticksPerYear * 1601) + (TicksPerDay * 23);
+    ticksSince1601 += (TicksPerDay * 23); // the is calculated emperically.
+
+    // Setup multi-part form data.
+    String^ boundryStr = FromUtf8(ACRCloudCodec::CreateBoundary(ticks + ticksSince1601));
+    HttpMultipartFormDataContent^ formContent = ref new HttpMultipartFormDataContent(boundryStr);
+
+    formContent->Add(ref new HttpStringContent(FromUtf8(fields.accessKey)), L"access_key");
+    formContent->Add(ref new HttpStringContent(FromUtf8(fields.timestamp)), L"timestamp");
+    formContent->Add(ref new HttpStringContent(FromUtf8(fields.signature)), L"signature");
+    formContent->Add(ref new HttpStringContent(FromUtf8(fields.dataType)), L"data_type");
+    formContent->Add(ref new HttpStringContent(FromUtf8(fields.signatureVersion)), L"signature_version");
+    formContent->Add(ref new HttpStringContent(FromUtf8(fields.sampleBytes)), L"sample_bytes");
+
+    HttpBufferContent^ sampleContent = ref new HttpBufferContent(fingerprintBuffer);
+    sampleContent->Headers->ContentDisposition = ref new HttpContentDispositionHeaderValue(L"form-data");
+    sampleContent->Headers->ContentDisposition->Name = ref new String(L"sample");
+    sampleContent->Headers->ContentDisposition->FileName = ref new String(L"sample");
+    sampleContent->Headers->Append(L"Content-Type", L"application/octet-stream");
+    formContent->Add(sampleContent);
+
+    return formContent;
+}
 
-                wstringstream sampleLength;
-                sampleLength << fingerprintBuffer->Length;
-                HttpStringContent^ sampleLengthContent = ref new HttpStringContent(ref new String(sampleLength.str().c_str()));
-                formContent->Add(sampleLengthContent, L"sample_bytes");
+task<ACRCloudClient::QueryResult> ACRCloudClient::SendQueryAsync(IBuffer^ fingerprintBuffer, cancellation_token cancellationToken)
+{
+    HttpClient^ httpClient = GetHttpClient();
+    return create_task(httpClient->TryPostAsync(CreateRequestUri(), CreateRequestContent(fingerprintBuffer)), cancellationToken)
+    .then([cancellationToken](HttpRequestResult^ result) -> task<QueryResult>
+        {
+            // Transport errors are worth retrying.
+            if (result == nullptr ||
+                !result->Succeeded ||
+                result->ResponseMessage == nullptr)
+            {
+                QueryResult failure = { nullptr, true };
+                return task_from_result(failure);
+            }
 
-                HttpBufferContent^ sampleContent = ref new HttpBufferContent(fingerprintBuffer);
-                sampleContent->Headers->ContentDisposition = ref new HttpContentDispositionHeaderValue(L"form-data");
-                sampleContent->Headers->ContentDisposition->Name = ref new String(L"sample");
-                sampleContent->Headers->ContentDisposition->FileName = ref new String(L"sample");
-                sampleContent->Headers->Append(L"Content-Type", L"application/octet-stream");
-                formContent->Add(sampleContent);
+            // So are server errors and throttling; a bad key or request would only fail again.
+            if (!result->ResponseMessage->IsSuccessStatusCode)
+            {
+                int statusCode = static_cast<int>(result->ResponseMessage->StatusCode);
+                QueryResult failure = { nullptr, statusCode >= 500 || statusCode == 429 };
+                if (!failure.retryable)
+                {
+                    LOG_WARNING("SendQueryAsync: status %d, not retried", statusCode);
+                }
 
-                // Send request.
-                ACRCloudClient^ _this = this;
-                HttpClient^ httpClient = GetHttpClient();
-                cancellation_token_source cancellationTokenSource = cancellation_token_source();
+                return task_from_result(failure);
+            }
 
-                return create_task(httpClient->TryPostAsync(resourceUrl, formContent), cancellationTokenSource.get_token());
+            return create_task(result->ResponseMessage->Content->ReadAsStringAsync(), cancellationToken)
+            .then([](String^ responseBody)
+                {
+                    QueryResult response = { responseBody, true };
+                    return response;
+                }, task_continuation_context::use_arbitrary());
+        }, task_continuation_context::use_arbitrary())
+    .then([](task<QueryResult> previousTask) -> QueryResult
+        {
+            try
+            {
+                QueryResult result = previousTask.get();
+                if (result.responseBody == nullptr || !result.responseBody->IsEmpty())
+                {
+                    return result;
+                }
             }
-            catch (Exception ^ ex)
+            catch (const task_canceled&)
             {
-                LogMessage("QueryTrackInfoAsync exception: %s", ex->Message);
-                throw;
             }
-        });
+            catch (Exception^ ex)
+            {
+                LOG_WARNING("SendQueryAsync exception: %s", ex->Message);
+            }
+
+            QueryResult failure = { nullptr, true };
+            return failure;
+        }, task_continuation_context::use_arbitrary());
 }
 
-IAsyncOperation<ACRCloudTrackResponse^>^ ACRCloudClient::ParseTrackResponseAync(Platform::String^ responseBody)
+task<ACRCloudClient::QueryResult> ACRCloudClient::SendHedgedQueryAsync(
+    IBuffer^ fingerprintBuffer,
+    ACRCloudRetryPolicy^ policy,
+    chrono::steady_clock::time_point deadline,
+    cancellation_token cancellationToken)
 {
-    return create_async([&responseBody]() -> task<ACRCloudTrackResponse^>
+    struct HedgeState
+    {
+        // Linked so the caller cancelling also aborts the requests.
+        explicit HedgeState(cancellation_token cancellationToken)
+            : cancellationTokenSource(cancellation_token_source::create_linked_source(cancellationToken))
         {
-            String^ message = L"";
-            String^ version = L"";
-            double code = -1;
-            Vector<IReadOnlyTrack^>^ tracks = ref new Vector<IReadOnlyTrack^>();
+        }
+
+        task_completion_event<QueryResult> completed;
+        cancellation_token_source cancellationTokenSource;
+        atomic<bool> done;
+        atomic<int> outstanding;
+    };
+
+    shared_ptr<HedgeState> state = make_shared<HedgeState>(cancellationToken);
+    state->done = false;
+    state->outstanding = 1;
+
+    // The first response wins and cancels the other request, as does a failure the other would share.
+    // A failure when all requests failed or the deadline passed.
+    auto complete = [state](const QueryResult& result)
+    {
+        if (!state->done.exchange(true))
+        {
+            state->completed.set(result);
+            state->cancellationTokenSource.cancel();
+        }
+    };
+
+    auto finish = [state, complete](const QueryResult& result)
+    {
+        if (result.responseBody != nullptr || !result.retryable || --state->outstanding == 0)
+        {
+            complete(result);
+        }
+    };
 
-            do
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    SendQueryAsync(fingerprintBuffer, state->cancellationTokenSource.get_token())
+    .then([policy, start, finish](QueryResult result)
+        {
+            if (result.responseBody != nullptr)
             {
-                JsonObject^ root = JsonObject::Parse(responseBody);
-
-                //"status":{
-                //    "msg":"Success",
-                //        "version" : "1.0",
-                //        "code" : 0
-                //},
-                if (!root->HasKey("status"))
-                {
-                    LogMessage("ParseTrackResponseAync: status missing");
-                    continue;
-                }
+                policy->RecordLatency(chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start));
+            }
 
-                JsonObject^ status = root->GetNamedObject(L"status");
-                message = status->GetNamedString(L"msg");
-                version = status->GetNamedString(L"version");
-                code = status->GetNamedNumber(L"code");
-                if (code != 0)
-                {
-                    LogMessage("ParseTrackResponseAync: code = %d", (int)code);
-                    continue;
-                }
+            finish(result);
+        }, task_continuation_context::use_arbitrary());
 
-                //"metadata":{
-                //    "timestamp_utc":"2020-01-19 02:58:28",
-                //     "music" : [
-                //          ...
-                //     ]
-                if (!root->HasKey("metadata"))
+    // Hedge once the request is slower than usual, if the budget allows.
+    chrono::milliseconds remaining = chrono::duration_cast<chrono::milliseconds>(deadline - start);
+    chrono::milliseconds hedgeDelay = policy->GetHedgeDelay();
+    if (policy->HedgingEnabled && hedgeDelay < remaining)
+    {
+        ACRCloudClient^ _this = this;
+        ACRCloudRetryPolicy::Delay(hedgeDelay, state->cancellationTokenSource.get_token()).then([_this, fingerprintBuffer, policy, state, finish]()
+            {
+                if (state->done || state->cancellationTokenSource.get_token().is_canceled() || !policy->TryAcquireHedge())
                 {
-                    LogMessage("ParseTrackResponseAync: metadata missing");
-                    continue;
+                    return;
                 }
 
-                JsonObject^ metadata = root->GetNamedObject(L"metadata");
-                if (!metadata->HasKey("music"))
-                {
-                    LogMessage("ParseTrackResponseAync: music missing");
-                    continue;
-                }
+                state->outstanding++;
+                _this->SendQueryAsync(fingerprintBuffer, state->cancellationTokenSource.get_token())
+                .then(finish, task_continuation_context::use_arbitrary());
+            }, task_continuation_context::use_arbitrary());
+    }
 
-                JsonArray^ musicArray = metadata->GetNamedArray(L"music");
-                for (unsigned int i = 0; i < musicArray->Size; i++)
-                {
-                    try
-                    {
-                        Track^ track = ref new Track();
-                        JsonObject^ music = musicArray->GetObjectAt(i);
-
-                        // Get basic metadata. Per the docs, this stuff is required.
-                        // Please note: Only ACRID, Track Title, Artists Name and Album Name fields are required, other fields are optional.
-
-                        // "acrid":"6049f11da7095e8bb8266871d4a70873",
-                        track->Identifier = music->GetNamedString(L"acrid");
-
-                        // "title":"Hello",
-                        track->Title = music->GetNamedString(L"title");
-
-                        // Get album.
-                        //"album":{
-                        //    "name":"Hello"
-                        //},
-                        JsonObject^ album = music->GetNamedObject(L"album");
-                        track->Album = album->GetNamedString(L"name");
-
-                        // Get artist (first one)
-                        //"artists":[
-                        //    {
-                        //        "name":"Adele"
-                        //    },
-                        //    ...
-                        // ],
-                        JsonArray^ artists = music->GetNamedArray(L"artists");
-                        if (artists->Size > 0)
-                        {
-                            JsonObject^ artist = artists->GetObjectAt(0);
-                            track->Artist = artist->GetNamedString(L"name");
-                        }
-
-                        // Get extended metadata. Per the docs, this stuff is optional.
-                        // "genres": [
-                        //    {
-                        //        "name": "Alternative"
-                        //    },
-                        //    ...
-                        // ],
-                        // "duration_ms":295000,
-                        if (music->HasKey("genres"))
-                        {
-                            JsonArray^ genres = music->GetNamedArray(L"genres");
-                            if (genres->Size > 0)
-                            {
-                                JsonObject^ genre = genres->GetObjectAt(0);
-                                track->Genre = genre->GetNamedString(L"name");
-                            }
-                        }
-
-                        // "duration_ms":295000,
-                        if (music->HasKey("duration_ms"))
-                        {
-                            track->Duration = static_cast<int>(music->GetNamedNumber(L"duration_ms"));
-                        }
-
-                        // "play_offset_ms":9040,
-                        if (music->HasKey("play_offset_ms"))
-                        {
-                            track->CurrentPosition = static_cast<int>(music->GetNamedNumber(L"play_offset_ms"));
-                            track->MatchPosition = track->CurrentPosition;
-                        }
-
-                        // Get score.
-                        // "score":100,
-                        if (music->HasKey("score"))
-                        {
-                            double score = music->GetNamedNumber(L"score");
-                            wstringstream scoreStream;
-                            scoreStream << score;
-                            track->MatchConfidence = ref new String(scoreStream.str().c_str());
-                        }
-
-                        // Get external info to retrieve cover art.
-                        //"external_metadata":{
-                        //    "musicbrainz": [
-                        //    {
-                        //        "track":{
-                        //            "id":"0a8e8d55-4b83-4f8a-9732-fbb5ded9f344"
-                        //        }
-                        //    }
-                        //] ,
-                        if (music->HasKey("external_metadata"))
-                        {
-                            JsonObject^ externalLinks = music->GetNamedObject(L"external_metadata");
-                            if (externalLinks->HasKey("musicbrainz"))
-                            {
-                                JsonArray^ musicbrainz = externalLinks->GetNamedArray(L"musicbrainz");
-                                if (musicbrainz->Size > 0)
-                                {
-                                    // Just grab the first one.
-                                    JsonObject^ musicbrainzTrack = musicbrainz->GetObjectAt(0);
-                                    if (musicbrainzTrack != nullptr)
-                                    {
-                                        if (musicbrainzTrack->HasKey("track"))
-                                        {
-                                            JsonObject^ musicbrainzTrack0 = musicbrainzTrack->GetNamedObject(L"track");
-                                            String^ musicbrainzTrackId = musicbrainzTrack0->GetNamedString(L"id");
-
-                                            wstringstream imageUrl;
-                                            imageUrl << L"http://coverartarchive.org/release/" << musicbrainzTrackId->Data() << L"/front";
-                                            const wstring wstr = imageUrl.str();
-                                            track->CovertArtImage = ref new Uri(ref new String(wstr.c_str()));
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        // Save track to list.
-                        tracks->Append(track);
-                    }
-                    catch (Exception ^ ex)
-                    {
-                        LogMessage("ParseTrackResponseAync track exception: %s", ex->Message);
-                    }
-                }
-            } while (false);
+    // The winning response cancels the source, which stops the deadline timer too.
+    ACRCloudRetryPolicy::Delay(remaining, state->cancellationTokenSource.get_token()).then([complete]()
+        {
+            QueryResult timeout = { nullptr, true };
+            complete(timeout);
+        }, task_continuation_context::use_arbitrary());
 
-            return task_from_result(ref new ACRCloudTrackResponse(
-                message,
-                version,
-                static_cast<int16>(code),
-                tracks->GetView()));
-        });
+    return create_task(state->completed);
 }
 
-HttpClient^ ACRCloudClient::GetHttpClient()
+task<String^> ACRCloudClient::QueryAttemptAsync(
+    IBuffer^ fingerprintBuffer,
+    ACRCloudRetryPolicy^ policy,
+    uint32 attempt,
+    chrono::steady_clock::time_point deadline,
+    cancellation_token cancellationToken)
 {
-    if (m_httpFilter != nullptr)
-    {
-        return ref new HttpClient(m_httpFilter);
-    }
+    policy->OnRequest(attempt > 1);
 
-    return ref new HttpClient();
+    ACRCloudClient^ _this = this;
+    return SendHedgedQueryAsync(fingerprintBuffer, policy, deadline, cancellationToken)
+    .then([_this, fingerprintBuffer, policy, attempt, deadline, cancellationToken](QueryResult result) -> task<String^>
+        {
+            String^ responseBody = result.responseBody;
+            if (responseBody != nullptr || !result.retryable || attempt >= policy->MaxAttempts || cancellationToken.is_canceled())
+            {
+                return task_from_result(responseBody);
+            }
+
+            // Back off, unless that runs past the deadline.
+            chrono::milliseconds backoff = policy->GetBackoff(attempt);
+            if (chrono::steady_clock::now() + backoff >= deadline)
+            {
+                LOG_WARNING("QueryAttemptAsync: deadline reached after %u attempts", attempt);
+                return task_from_result(responseBody);
+            }
+
+            // A cancellation ends the backoff at once.
+            return ACRCloudRetryPolicy::Delay(backoff, cancellationToken).then([_this, fingerprintBuffer, policy, attempt, deadline, cancellationToken]()
+                {
+                    if (cancellationToken.is_canceled())
+                    {
+                        return task_from_result<String^>(nullptr);
+                    }
+
+                    return _this->QueryAttemptAsync(fingerprintBuffer, policy, attempt + 1, deadline, cancellationToken);
+                }, task_continuation_context::use_arbitrary());
+        }, task_continuation_context::use_arbitrary());
 }
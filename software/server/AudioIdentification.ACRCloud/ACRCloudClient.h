@@ -6,7 +6,9 @@
 //-----------------------------------------------------------------------
 #pragma once
 #include "ACRCloudClientIdData.h"
+#include "ACRCloudRetryPolicy.h"
 #include "ACRCloudTrackResponse.h"
+#include <chrono>
 
 namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
 {
@@ -47,12 +49,70 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
         Windows::Foundation::IAsyncOperation<CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudTrackResponse^>^
             ParseTrackResponseAync(Platform::String^ responseBody);
 
+    internal:
+        ///
+        /// Get the track info from ACRCloud, retrying and hedging per the policy.
+        /// Returns the response body, or null if every attempt failed or the token was cancelled.
+        /// Cancelling the token aborts the requests in flight.
+        ///
+        Concurrency::task<Platform::String^> QueryTrackResponseAsync(
+            Windows::Storage::Streams::IBuffer^ fingerprintBuffer,
+            CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudRetryPolicy^ policy,
+            Concurrency::cancellation_token cancellationToken);
+
     private:
+        ///
+        /// The outcome of a request: the response body, or null if it failed, and whether a failure is
+        /// worth retrying.
+        ///
+        struct QueryResult
+        {
+            Platform::String^ responseBody;
+            bool retryable;
+        };
+
         ///
         /// Get the Http client;
         ///
         Windows::Web::Http::HttpClient^ GetHttpClient();
 
+        ///
+        /// Create the URI for a query.
+        ///
+        Windows::Foundation::Uri^ CreateRequestUri();
+
+        ///
+        /// Create the signed multi-part form for a query.
+        ///
+        Windows::Web::Http::HttpMultipartFormDataContent^ CreateRequestContent(Windows::Storage::Streams::IBuffer^ fingerprintBuffer);
+
+        ///
+        /// Send a query. Only network failures, server errors and throttling are worth retrying.
+        ///
+        Concurrency::task<QueryResult> SendQueryAsync(
+            Windows::Storage::Streams::IBuffer^ fingerprintBuffer,
+            Concurrency::cancellation_token cancellationToken);
+
+        ///
+        /// Send a query plus a hedge if it's slow. Returns the first response, or the first failure which
+        /// isn't worth retrying, or a failure if both failed.
+        ///
+        Concurrency::task<QueryResult> SendHedgedQueryAsync(
+            Windows::Storage::Streams::IBuffer^ fingerprintBuffer,
+            CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudRetryPolicy^ policy,
+            std::chrono::steady_clock::time_point deadline,
+            Concurrency::cancellation_token cancellationToken);
+
+        ///
+        /// Send a query and retry it after a backoff if it failed in a way worth retrying.
+        ///
+        Concurrency::task<Platform::String^> QueryAttemptAsync(
+            Windows::Storage::Streams::IBuffer^ fingerprintBuffer,
+            CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudRetryPolicy^ policy,
+            uint32 attempt,
+            std::chrono::steady_clock::time_point deadline,
+            Concurrency::cancellation_token cancellationToken);
+
     private:
         /// <summary>
         /// Client data for the session.
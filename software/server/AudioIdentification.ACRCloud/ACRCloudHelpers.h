@@ -6,16 +6,36 @@
 //-----------------------------------------------------------------------
 #pragma once
 
-// Log a message.
-inline void LogMessage(char* format, ...)
+#include "Logger.h"
+#include <string>
+#include <vector>
+
+// Convert to UTF-8, as the core codecs take it.
+inline std::string ToUtf8(Platform::String^ value)
+{
+    if (value == nullptr || value->IsEmpty())
+    {
+        return std::string();
+    }
+
+    int length = WideCharToMultiByte(CP_UTF8, 0, value->Data(), static_cast<int>(value->Length()), nullptr, 0, nullptr, nullptr);
+    std::string buffer(length, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, value->Data(), static_cast<int>(value->Length()), &buffer[0], length, nullptr, nullptr);
+    return buffer;
+}
+
+// Convert from UTF-8, as the core codecs return it.
+inline Platform::String^ FromUtf8(const std::string& value)
 {
-    static char s_acBuf[2048];
+    if (value.empty())
+    {
+        return L"";
+    }
 
-    va_list args;
-    va_start(args, format);
-    vsprintf_s(s_acBuf, format, args);
-    OutputDebugStringA(s_acBuf);
-    va_end(args);
+    int length = MultiByteToWideChar(CP_UTF8, 0, value.data(), static_cast<int>(value.size()), nullptr, 0);
+    std::vector<wchar_t> buffer(length);
+    MultiByteToWideChar(CP_UTF8, 0, value.data(), static_cast<int>(value.size()), buffer.data(), length);
+    return ref new Platform::String(buffer.data(), static_cast<unsigned int>(length));
 }
 
 // Error tracing.
@@ -0,0 +1,272 @@
+//-----------------------------------------------------------------------
+// <copyright file="ACRCloudResultCache.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "ACRCloudResultCache.h"
+#include "FingerprintDigest.h"
+#include <algorithm>
+#include <vector>
+
+using namespace Platform;
+using namespace Windows::Foundation;
+using namespace Windows::Security::Cryptography;
+using namespace Windows::Storage::Streams;
+using namespace CrazyGiraffe::AudioIdentification::ACRCloud;
+
+// TimeSpan is expressed in 100-nanosecond units.
+using ticks = std::chrono::duration<long long, std::ratio<1, 10000000>>;
+
+ACRCloudResultCache::ACRCloudResultCache()
+    : m_capacity(1024)
+    , m_timeToLive(std::chrono::hours(24))
+    , m_maximumDistance(3)
+    , m_entries()
+    , m_digests()
+    , m_bands()
+    , m_hitCount(0)
+    , m_missCount(0)
+{
+}
+
+ACRCloudResultCache::ACRCloudResultCache(uint32 capacity, TimeSpan timeToLive, uint32 maximumDistance)
+    : m_capacity(capacity)
+    , m_timeToLive(std::chrono::duration_cast<std::chrono::steady_clock::duration>(ticks(timeToLive.Duration)))
+    , m_maximumDistance(maximumDistance)
+    , m_entries()
+    , m_digests()
+    , m_bands()
+    , m_hitCount(0)
+    , m_missCount(0)
+{
+    if (capacity == 0)
+    {
+        throw ref new InvalidArgumentException("capacity");
+    }
+
+    // Near matches are found through the bands: only digests within
+    // (BandCount - 1) bits are guaranteed to share a band.
+    if (maximumDistance >= FingerprintDigest::BandCount)
+    {
+        throw ref new InvalidArgumentException("maximumDistance");
+    }
+}
+
+uint32 ACRCloudResultCache::Capacity::get()
+{
+    return m_capacity;
+}
+
+TimeSpan ACRCloudResultCache::TimeToLive::get()
+{
+    TimeSpan timeSpan = { 0 };
+    timeSpan.Duration = std::chrono::duration_cast<ticks>(m_timeToLive).count();
+    return timeSpan;
+}
+
+uint32 ACRCloudResultCache::MaximumDistance::get()
+{
+    return m_maximumDistance;
+}
+
+uint32 ACRCloudResultCache::Count::get()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return static_cast<uint32>(m_entries.size());
+}
+
+uint64 ACRCloudResultCache::HitCount::get()
+{
+    return m_hitCount;
+}
+
+uint64 ACRCloudResultCache::MissCount::get()
+{
+    return m_missCount;
+}
+
+double ACRCloudResultCache::HitRate::get()
+{
+    uint64 hits = m_hitCount;
+    uint64 lookups = hits + m_missCount;
+    return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+}
+
+ACRCloudTrackResponse^ ACRCloudResultCache::Lookup(IBuffer^ fingerprint)
+{
+    if (fingerprint == nullptr)
+    {
+        throw ref new InvalidArgumentException("fingerprint");
+    }
+
+    return LookupDigest(ComputeDigest(fingerprint));
+}
+
+void ACRCloudResultCache::Add(IBuffer^ fingerprint, ACRCloudTrackResponse^ response)
+{
+    if (fingerprint == nullptr)
+    {
+        throw ref new InvalidArgumentException("fingerprint");
+    }
+
+    if (response == nullptr)
+    {
+        throw ref new InvalidArgumentException("response");
+    }
+
+    AddDigest(ComputeDigest(fingerprint), response);
+}
+
+void ACRCloudResultCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_entries.clear();
+    m_digests.clear();
+    m_bands.clear();
+}
+
+/* static */
+uint64 ACRCloudResultCache::ComputeDigest(IBuffer^ fingerprint)
+{
+    Array<byte>^ fingerprintBytes = nullptr;
+    CryptographicBuffer::CopyToByteArray(fingerprint, &fingerprintBytes);
+    if (fingerprintBytes == nullptr)
+    {
+        return 0;
+    }
+
+    return FingerprintDigest::Compute(fingerprintBytes->Data, fingerprintBytes->Length);
+}
+
+ACRCloudTrackResponse^ ACRCloudResultCache::LookupDigest(uint64 digest)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    CacheEntryList::iterator entry = FindEntry(digest, std::chrono::steady_clock::now());
+    if (entry == m_entries.end())
+    {
+        ++m_missCount;
+        return nullptr;
+    }
+
+    // Move to the front: most recently used.
+    m_entries.splice(m_entries.begin(), m_entries, entry);
+
+    ++m_hitCount;
+    return entry->response;
+}
+
+void ACRCloudResultCache::AddDigest(uint64 digest, ACRCloudTrackResponse^ response)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    // Replace any existing entry for the same digest.
+    auto existing = m_digests.find(digest);
+    if (existing != m_digests.end())
+    {
+        RemoveEntry(existing->second);
+    }
+
+    // Evict the least recently used entries.
+    while (m_entries.size() >= m_capacity)
+    {
+        RemoveEntry(std::prev(m_entries.end()));
+    }
+
+    CacheEntry cacheEntry = { digest, response, std::chrono::steady_clock::now() + m_timeToLive };
+    m_entries.push_front(cacheEntry);
+    m_digests[digest] = m_entries.begin();
+
+    for (unsigned int band = 0; band < FingerprintDigest::BandCount; band++)
+    {
+        m_bands.emplace(FingerprintDigest::BandKey(digest, band), digest);
+    }
+}
+
+ACRCloudResultCache::CacheEntryList::iterator ACRCloudResultCache::FindEntry(
+    uint64 digest,
+    std::chrono::steady_clock::time_point now)
+{
+    CacheEntryList::iterator bestEntry = m_entries.end();
+    unsigned int bestDistance = m_maximumDistance + 1;
+
+    // Expired entries are passed over, so a live one further away still matches, and removed afterwards.
+    std::vector<CacheEntryList::iterator> expiredEntries;
+
+    // Exact match.
+    auto exact = m_digests.find(digest);
+    if (exact != m_digests.end())
+    {
+        if (exact->second->expiresAt > now)
+        {
+            bestEntry = exact->second;
+            bestDistance = 0;
+        }
+        else
+        {
+            expiredEntries.push_back(exact->second);
+        }
+    }
+
+    // Near match: check the digests that share a band.
+    for (unsigned int band = 0; band < FingerprintDigest::BandCount && bestDistance > 0; band++)
+    {
+        auto range = m_bands.equal_range(FingerprintDigest::BandKey(digest, band));
+        for (auto candidate = range.first; candidate != range.second; ++candidate)
+        {
+            unsigned int distance = FingerprintDigest::Distance(digest, candidate->second);
+            if (distance == 0 || distance >= bestDistance)
+            {
+                continue;
+            }
+
+            auto candidateEntry = m_digests.find(candidate->second);
+            if (candidateEntry == m_digests.end())
+            {
+                continue;
+            }
+
+            if (candidateEntry->second->expiresAt <= now)
+            {
+                if (std::find(expiredEntries.begin(), expiredEntries.end(), candidateEntry->second) == expiredEntries.end())
+                {
+                    expiredEntries.push_back(candidateEntry->second);
+                }
+
+                continue;
+            }
+
+            bestEntry = candidateEntry->second;
+            bestDistance = distance;
+        }
+    }
+
+    for (CacheEntryList::iterator expiredEntry : expiredEntries)
+    {
+        RemoveEntry(expiredEntry);
+    }
+
+    return bestEntry;
+}
+
+void ACRCloudResultCache::RemoveEntry(CacheEntryList::iterator entry)
+{
+    uint64 digest = entry->digest;
+    for (unsigned int band = 0; band < FingerprintDigest::BandCount; band++)
+    {
+        auto range = m_bands.equal_range(FingerprintDigest::BandKey(digest, band));
+        for (auto bandEntry = range.first; bandEntry != range.second; ++bandEntry)
+        {
+            if (bandEntry->second == digest)
+            {
+                m_bands.erase(bandEntry);
+                break;
+            }
+        }
+    }
+
+    m_digests.erase(digest);
+    m_entries.erase(entry);
+}
@@ -0,0 +1,198 @@
+//-----------------------------------------------------------------------
+// <copyright file="ACRCloudResultCache.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+#include "ACRCloudTrackResponse.h"
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
+{
+    /// <summary>
+    /// Cache of track responses keyed on a locality-sensitive digest of the fingerprint.
+    /// </summary>
+    public ref class ACRCloudResultCache sealed
+    {
+    public:
+        /// <summary>
+        /// Create an instance of the <see cref="ACRCloudResultCache" /> class.
+        /// </summary>
+        ACRCloudResultCache();
+
+        /// <summary>
+        /// Create an instance of the <see cref="ACRCloudResultCache" /> class.
+        /// </summary>
+        /// <param name="capacity">The maximum number of cached responses.</param>
+        /// <param name="timeToLive">How long a response stays in the cache.</param>
+        /// <param name="maximumDistance">The maximum number of differing digest bits for a match.</param>
+        ACRCloudResultCache(uint32 capacity, Windows::Foundation::TimeSpan timeToLive, uint32 maximumDistance);
+
+        /// <summary>
+        /// Gets the maximum number of cached responses.
+        /// </summary>
+        property uint32 Capacity
+        {
+            uint32 get();
+        }
+
+        /// <summary>
+        /// Gets how long a response stays in the cache.
+        /// </summary>
+        property Windows::Foundation::TimeSpan TimeToLive
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets the maximum number of differing digest bits for a match.
+        /// </summary>
+        property uint32 MaximumDistance
+        {
+            uint32 get();
+        }
+
+        /// <summary>
+        /// Gets the number of cached responses.
+        /// </summary>
+        property uint32 Count
+        {
+            uint32 get();
+        }
+
+        /// <summary>
+        /// Gets the number of lookups answered from the cache.
+        /// </summary>
+        property uint64 HitCount
+        {
+            uint64 get();
+        }
+
+        /// <summary>
+        /// Gets the number of lookups not answered from the cache.
+        /// </summary>
+        property uint64 MissCount
+        {
+            uint64 get();
+        }
+
+        /// <summary>
+        /// Gets the fraction of lookups answered from the cache.
+        /// </summary>
+        property double HitRate
+        {
+            double get();
+        }
+
+        /// <summary>
+        /// Find a cached response for a fingerprint.
+        /// </summary>
+        /// <param name="fingerprint">The fingerprint.</param>
+        /// <returns>The cached response or null.</returns>
+        CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudTrackResponse^ Lookup(Windows::Storage::Streams::IBuffer^ fingerprint);
+
+        /// <summary>
+        /// Cache a response for a fingerprint.
+        /// </summary>
+        /// <param name="fingerprint">The fingerprint.</param>
+        /// <param name="response">The parsed response.</param>
+        void Add(
+            Windows::Storage::Streams::IBuffer^ fingerprint,
+            CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudTrackResponse^ response);
+
+        /// <summary>
+        /// Remove all cached responses. The counters are not reset.
+        /// </summary>
+        void Clear();
+
+    internal:
+        ///
+        /// Compute the digest of a fingerprint.
+        ///
+        static uint64 ComputeDigest(Windows::Storage::Streams::IBuffer^ fingerprint);
+
+        ///
+        /// Find a cached response for a digest.
+        ///
+        ACRCloudTrackResponse^ LookupDigest(uint64 digest);
+
+        ///
+        /// Cache a response for a digest.
+        ///
+        void AddDigest(uint64 digest, ACRCloudTrackResponse^ response);
+
+    private:
+        ///
+        /// A cached response. The tracks of the response carry the play offset of the match.
+        ///
+        struct CacheEntry
+        {
+            uint64 digest;
+            ACRCloudTrackResponse^ response;
+            std::chrono::steady_clock::time_point expiresAt;
+        };
+
+        using CacheEntryList = std::list<CacheEntry>;
+
+        ///
+        /// Find the closest live entry for a digest. m_lock must be held.
+        ///
+        CacheEntryList::iterator FindEntry(uint64 digest, std::chrono::steady_clock::time_point now);
+
+        ///
+        /// Remove an entry and its index entries. m_lock must be held.
+        ///
+        void RemoveEntry(CacheEntryList::iterator entry);
+
+    private:
+        /// <summary>
+        /// The maximum number of cached responses.
+        /// </summary>
+        uint32 m_capacity;
+
+        /// <summary>
+        /// How long a response stays in the cache.
+        /// </summary>
+        std::chrono::steady_clock::duration m_timeToLive;
+
+        /// <summary>
+        /// The maximum number of differing digest bits for a match.
+        /// </summary>
+        uint32 m_maximumDistance;
+
+        ///
+        /// The cached responses, most recently used first.
+        ///
+        CacheEntryList m_entries;
+
+        ///
+        /// The cached responses by digest.
+        ///
+        std::unordered_map<uint64, CacheEntryList::iterator> m_digests;
+
+        ///
+        /// The cached digests by band key, used to find near matches.
+        ///
+        std::unordered_multimap<uint32, uint64> m_bands;
+
+        ///
+        /// Lock for the cached responses.
+        ///
+        std::mutex m_lock;
+
+        ///
+        /// The number of lookups answered from the cache.
+        ///
+        std::atomic<uint64> m_hitCount;
+
+        ///
+        /// The number of lookups not answered from the cache.
+        ///
+        std::atomic<uint64> m_missCount;
+    };
+} } }
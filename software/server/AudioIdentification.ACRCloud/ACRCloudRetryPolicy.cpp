@@ -0,0 +1,345 @@
+//-----------------------------------------------------------------------
+// <copyright file="ACRCloudRetryPolicy.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "ACRCloudRetryPolicy.h"
+#include <agents.h>
+#include <algorithm>
+
+using namespace concurrency;
+using namespace Platform;
+using namespace Windows::Foundation;
+using namespace CrazyGiraffe::AudioIdentification::ACRCloud;
+
+namespace
+{
+    // Number of latencies kept for the p95.
+    const size_t LatencyWindow = 128;
+
+    // Number of latencies needed before the p95 replaces the initial hedge delay.
+    const size_t MinimumLatencySamples = 20;
+
+    // TimeSpan is expressed in 100-nanosecond units.
+    std::chrono::milliseconds ToMilliseconds(TimeSpan value)
+    {
+        return std::chrono::milliseconds(value.Duration / 10000);
+    }
+
+    TimeSpan ToTimeSpan(std::chrono::milliseconds value)
+    {
+        TimeSpan timeSpan = { 0 };
+        timeSpan.Duration = value.count() * 10000;
+        return timeSpan;
+    }
+}
+
+ACRCloudRetryPolicy::ACRCloudRetryPolicy()
+    : m_maxAttempts(3)
+    , m_deadline(15000)
+    , m_initialBackoff(250)
+    , m_maximumBackoff(4000)
+    , m_backoffMultiplier(2.0)
+    , m_jitter(0.5)
+    , m_hedgingEnabled(true)
+    , m_initialHedgeDelay(2000)
+    , m_maximumHedgeRatio(0.1)
+    , m_requestCount(0)
+    , m_retryCount(0)
+    , m_hedgeCount(0)
+    , m_latencies()
+    , m_latencyIndex(0)
+    , m_random(std::random_device()())
+{
+    m_latencies.reserve(LatencyWindow);
+}
+
+uint32 ACRCloudRetryPolicy::MaxAttempts::get()
+{
+    return m_maxAttempts;
+}
+
+void ACRCloudRetryPolicy::MaxAttempts::set(uint32 value)
+{
+    if (value == 0)
+    {
+        throw ref new InvalidArgumentException("value");
+    }
+
+    m_maxAttempts = value;
+}
+
+TimeSpan ACRCloudRetryPolicy::Deadline::get()
+{
+    return ToTimeSpan(m_deadline);
+}
+
+void ACRCloudRetryPolicy::Deadline::set(TimeSpan value)
+{
+    if (value.Duration <= 0)
+    {
+        throw ref new InvalidArgumentException("value");
+    }
+
+    m_deadline = ToMilliseconds(value);
+}
+
+TimeSpan ACRCloudRetryPolicy::InitialBackoff::get()
+{
+    return ToTimeSpan(m_initialBackoff);
+}
+
+void ACRCloudRetryPolicy::InitialBackoff::set(TimeSpan value)
+{
+    if (value.Duration < 0)
+    {
+        throw ref new InvalidArgumentException("value");
+    }
+
+    m_initialBackoff = ToMilliseconds(value);
+}
+
+TimeSpan ACRCloudRetryPolicy::MaximumBackoff::get()
+{
+    return ToTimeSpan(m_maximumBackoff);
+}
+
+void ACRCloudRetryPolicy::MaximumBackoff::set(TimeSpan value)
+{
+    if (value.Duration < 0)
+    {
+        throw ref new InvalidArgumentException("value");
+    }
+
+    m_maximumBackoff = ToMilliseconds(value);
+}
+
+double ACRCloudRetryPolicy::BackoffMultiplier::get()
+{
+    return m_backoffMultiplier;
+}
+
+void ACRCloudRetryPolicy::BackoffMultiplier::set(double value)
+{
+    if (value < 1.0)
+    {
+        throw ref new InvalidArgumentException("value");
+    }
+
+    m_backoffMultiplier = value;
+}
+
+double ACRCloudRetryPolicy::Jitter::get()
+{
+    return m_jitter;
+}
+
+void ACRCloudRetryPolicy::Jitter::set(double value)
+{
+    if (value < 0.0 || value > 1.0)
+    {
+        throw ref new InvalidArgumentException("value");
+    }
+
+    m_jitter = value;
+}
+
+bool ACRCloudRetryPolicy::HedgingEnabled::get()
+{
+    return m_hedgingEnabled;
+}
+
+void ACRCloudRetryPolicy::HedgingEnabled::set(bool value)
+{
+    m_hedgingEnabled = value;
+}
+
+TimeSpan ACRCloudRetryPolicy::InitialHedgeDelay::get()
+{
+    return ToTimeSpan(m_initialHedgeDelay);
+}
+
+void ACRCloudRetryPolicy::InitialHedgeDelay::set(TimeSpan value)
+{
+    if (value.Duration < 0)
+    {
+        throw ref new InvalidArgumentException("value");
+    }
+
+    m_initialHedgeDelay = ToMilliseconds(value);
+}
+
+double ACRCloudRetryPolicy::MaximumHedgeRatio::get()
+{
+    return m_maximumHedgeRatio;
+}
+
+void ACRCloudRetryPolicy::MaximumHedgeRatio::set(double value)
+{
+    if (value < 0.0 || value > 1.0)
+    {
+        throw ref new InvalidArgumentException("value");
+    }
+
+    m_maximumHedgeRatio = value;
+}
+
+uint64 ACRCloudRetryPolicy::RequestCount::get()
+{
+    return m_requestCount;
+}
+
+uint64 ACRCloudRetryPolicy::RetryCount::get()
+{
+    return m_retryCount;
+}
+
+uint64 ACRCloudRetryPolicy::HedgeCount::get()
+{
+    return m_hedgeCount;
+}
+
+TimeSpan ACRCloudRetryPolicy::LatencyP95::get()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return ToTimeSpan(GetLatencyP95());
+}
+
+std::chrono::milliseconds ACRCloudRetryPolicy::GetBackoff(uint32 attempt)
+{
+    // initial * multiplier^(attempt - 1), capped.
+    double backoff = static_cast<double>(m_initialBackoff.count());
+    for (uint32 i = 1; i < attempt && backoff < m_maximumBackoff.count(); i++)
+    {
+        backoff *= m_backoffMultiplier;
+    }
+
+    backoff = (std::min)(backoff, static_cast<double>(m_maximumBackoff.count()));
+
+    // Randomize the last part so deck retries don't line up.
+    std::uniform_real_distribution<double> distribution(1.0 - m_jitter, 1.0);
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        backoff *= distribution(m_random);
+    }
+
+    return std::chrono::milliseconds(static_cast<long long>(backoff));
+}
+
+std::chrono::milliseconds ACRCloudRetryPolicy::GetHedgeDelay()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    std::chrono::milliseconds latencyP95 = GetLatencyP95();
+    return latencyP95.count() > 0 ? latencyP95 : m_initialHedgeDelay;
+}
+
+std::chrono::milliseconds ACRCloudRetryPolicy::GetDeadline()
+{
+    return m_deadline;
+}
+
+void ACRCloudRetryPolicy::OnRequest(bool isRetry)
+{
+    m_requestCount++;
+    if (isRetry)
+    {
+        m_retryCount++;
+    }
+}
+
+bool ACRCloudRetryPolicy::TryAcquireHedge()
+{
+    if (!m_hedgingEnabled)
+    {
+        return false;
+    }
+
+    // Allow one hedge up front, then keep within the ratio.
+    uint64 hedgeCount = m_hedgeCount;
+    while (static_cast<double>(hedgeCount) < (m_maximumHedgeRatio * m_requestCount) + 1.0)
+    {
+        if (m_hedgeCount.compare_exchange_weak(hedgeCount, hedgeCount + 1))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ACRCloudRetryPolicy::RecordLatency(std::chrono::milliseconds latency)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (m_latencies.size() < LatencyWindow)
+    {
+        m_latencies.push_back(latency);
+    }
+    else
+    {
+        m_latencies[m_latencyIndex] = latency;
+        m_latencyIndex = (m_latencyIndex + 1) % LatencyWindow;
+    }
+}
+
+std::chrono::milliseconds ACRCloudRetryPolicy::GetLatencyP95()
+{
+    if (m_latencies.size() < MinimumLatencySamples)
+    {
+        return std::chrono::milliseconds(0);
+    }
+
+    std::vector<std::chrono::milliseconds> latencies(m_latencies);
+    size_t index = (latencies.size() * 95) / 100;
+    std::nth_element(latencies.begin(), latencies.begin() + index, latencies.end());
+    return latencies[index];
+}
+
+/* static */
+task<void> ACRCloudRetryPolicy::Delay(std::chrono::milliseconds delay)
+{
+    return Delay(delay, cancellation_token::none());
+}
+
+/* static */
+task<void> ACRCloudRetryPolicy::Delay(std::chrono::milliseconds delay, cancellation_token cancellationToken)
+{
+    if (delay.count() <= 0 || cancellationToken.is_canceled())
+    {
+        return task_from_result();
+    }
+
+    // From: https://docs.microsoft.com/en-us/cpp/parallel/concrt/how-to-create-a-task-that-completes-after-a-delay
+    task_completion_event<void> completionEvent;
+    auto fireOnce = new timer<int>(static_cast<unsigned int>(delay.count()), 0, nullptr, false);
+    auto callback = new call<int>([completionEvent](int)
+        {
+            completionEvent.set();
+        });
+
+    fireOnce->link_target(callback);
+    fireOnce->start();
+
+    // A canceled delay completes at once and its timer goes with it, rather than waiting to fire.
+    cancellation_token_registration registration;
+    if (cancellationToken.is_cancelable())
+    {
+        registration = cancellationToken.register_callback([completionEvent, fireOnce]()
+            {
+                fireOnce->stop();
+                completionEvent.set();
+            });
+    }
+
+    return task<void>(completionEvent).then([callback, fireOnce, cancellationToken, registration]()
+        {
+            if (cancellationToken.is_cancelable())
+            {
+                cancellationToken.deregister_callback(registration);
+            }
+
+            delete callback;
+            delete fireOnce;
+        }, task_continuation_context::use_arbitrary());
+}
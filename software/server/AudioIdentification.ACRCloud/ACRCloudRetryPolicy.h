@@ -0,0 +1,261 @@
+//-----------------------------------------------------------------------
+// <copyright file="ACRCloudRetryPolicy.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
+{
+    /// <summary>
+    /// Retry and hedging budget for the queries of an <see cref="ACRCloudSessionFactory" />.
+    /// </summary>
+    /// <remarks>
+    /// A failed query is retried with jittered exponential backoff until it succeeds, runs out of
+    /// attempts or passes the deadline. A query that takes longer than the observed p95 latency gets
+    /// one hedged duplicate; the first response wins. Hedges are limited to a fraction of the queries.
+    /// </remarks>
+    public ref class ACRCloudRetryPolicy sealed
+    {
+    public:
+        /// <summary>
+        /// Create an instance of the <see cref="ACRCloudRetryPolicy" /> class.
+        /// </summary>
+        ACRCloudRetryPolicy();
+
+        /// <summary>
+        /// Gets or sets the maximum number of attempts per query, including the first.
+        /// </summary>
+        property uint32 MaxAttempts
+        {
+            uint32 get();
+            void set(uint32 value);
+        }
+
+        /// <summary>
+        /// Gets or sets the time allowed for a query, including retries.
+        /// </summary>
+        property Windows::Foundation::TimeSpan Deadline
+        {
+            Windows::Foundation::TimeSpan get();
+            void set(Windows::Foundation::TimeSpan value);
+        }
+
+        /// <summary>
+        /// Gets or sets the delay before the first retry.
+        /// </summary>
+        property Windows::Foundation::TimeSpan InitialBackoff
+        {
+            Windows::Foundation::TimeSpan get();
+            void set(Windows::Foundation::TimeSpan value);
+        }
+
+        /// <summary>
+        /// Gets or sets the longest delay between retries.
+        /// </summary>
+        property Windows::Foundation::TimeSpan MaximumBackoff
+        {
+            Windows::Foundation::TimeSpan get();
+            void set(Windows::Foundation::TimeSpan value);
+        }
+
+        /// <summary>
+        /// Gets or sets the factor the delay grows by after each retry.
+        /// </summary>
+        property double BackoffMultiplier
+        {
+            double get();
+            void set(double value);
+        }
+
+        /// <summary>
+        /// Gets or sets the fraction of the delay which is randomized, from 0 to 1.
+        /// </summary>
+        property double Jitter
+        {
+            double get();
+            void set(double value);
+        }
+
+        /// <summary>
+        /// Gets or sets a value indicating whether slow queries are hedged.
+        /// </summary>
+        property bool HedgingEnabled
+        {
+            bool get();
+            void set(bool value);
+        }
+
+        /// <summary>
+        /// Gets or sets the hedge delay used until enough latencies have been observed.
+        /// </summary>
+        property Windows::Foundation::TimeSpan InitialHedgeDelay
+        {
+            Windows::Foundation::TimeSpan get();
+            void set(Windows::Foundation::TimeSpan value);
+        }
+
+        /// <summary>
+        /// Gets or sets the largest fraction of queries which may be hedged, from 0 to 1.
+        /// </summary>
+        property double MaximumHedgeRatio
+        {
+            double get();
+            void set(double value);
+        }
+
+        /// <summary>
+        /// Gets the number of queries sent, not counting hedges.
+        /// </summary>
+        property uint64 RequestCount
+        {
+            uint64 get();
+        }
+
+        /// <summary>
+        /// Gets the number of retries sent.
+        /// </summary>
+        property uint64 RetryCount
+        {
+            uint64 get();
+        }
+
+        /// <summary>
+        /// Gets the number of hedges sent.
+        /// </summary>
+        property uint64 HedgeCount
+        {
+            uint64 get();
+        }
+
+        /// <summary>
+        /// Gets the p95 latency of successful queries.
+        /// </summary>
+        property Windows::Foundation::TimeSpan LatencyP95
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+    internal:
+        ///
+        /// Get the jittered delay before a retry.
+        ///
+        std::chrono::milliseconds GetBackoff(uint32 attempt);
+
+        ///
+        /// Get the delay before a query is hedged.
+        ///
+        std::chrono::milliseconds GetHedgeDelay();
+
+        ///
+        /// Get the time allowed for a query.
+        ///
+        std::chrono::milliseconds GetDeadline();
+
+        ///
+        /// Record a query being sent.
+        ///
+        void OnRequest(bool isRetry);
+
+        ///
+        /// Take a hedge out of the budget, if there is one left.
+        ///
+        bool TryAcquireHedge();
+
+        ///
+        /// Record the latency of a successful query.
+        ///
+        void RecordLatency(std::chrono::milliseconds latency);
+
+        ///
+        /// Complete a task after a delay.
+        ///
+        static Concurrency::task<void> Delay(std::chrono::milliseconds delay);
+
+        ///
+        /// Complete a task after a delay, or as soon as the token is canceled, stopping the timer.
+        ///
+        static Concurrency::task<void> Delay(std::chrono::milliseconds delay, Concurrency::cancellation_token cancellationToken);
+
+    private:
+        ///
+        /// Get the p95 latency, or zero if there are too few samples. m_lock must be held.
+        ///
+        std::chrono::milliseconds GetLatencyP95();
+
+    private:
+        ///
+        /// The maximum number of attempts per query.
+        ///
+        uint32 m_maxAttempts;
+
+        ///
+        /// The time allowed for a query.
+        ///
+        std::chrono::milliseconds m_deadline;
+
+        ///
+        /// The delay before the first retry.
+        ///
+        std::chrono::milliseconds m_initialBackoff;
+
+        ///
+        /// The longest delay between retries.
+        ///
+        std::chrono::milliseconds m_maximumBackoff;
+
+        ///
+        /// The factor the delay grows by.
+        ///
+        double m_backoffMultiplier;
+
+        ///
+        /// The fraction of the delay which is randomized.
+        ///
+        double m_jitter;
+
+        ///
+        /// True if slow queries are hedged.
+        ///
+        bool m_hedgingEnabled;
+
+        ///
+        /// The hedge delay used until enough latencies have been observed.
+        ///
+        std::chrono::milliseconds m_initialHedgeDelay;
+
+        ///
+        /// The largest fraction of queries which may be hedged.
+        ///
+        double m_maximumHedgeRatio;
+
+        ///
+        /// Query counters.
+        ///
+        std::atomic<uint64> m_requestCount;
+        std::atomic<uint64> m_retryCount;
+        std::atomic<uint64> m_hedgeCount;
+
+        ///
+        /// The most recent latencies, used as a ring.
+        ///
+        std::vector<std::chrono::milliseconds> m_latencies;
+        size_t m_latencyIndex;
+
+        ///
+        /// Random number generator for the jitter.
+        ///
+        std::mt19937 m_random;
+
+        ///
+        /// Lock for the latencies and the random number generator.
+        ///
+        std::mutex m_lock;
+    };
+} } }
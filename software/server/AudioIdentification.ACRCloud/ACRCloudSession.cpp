@@ -7,6 +7,11 @@
 #include "pch.h"
 #include "ACRCloudSession.h"
 #include "ACRCloudHelpers.h"
+#include "Core/AudioFrameConverter.h"
+#include "Core/SpeedEstimator.h"
+#include "Core/WavFormat.h"
+#include <algorithm>
+#include <cmath>
 
 using namespace Concurrency;
 using namespace Platform;
@@ -19,31 +24,122 @@ using namespace Windows::Web::Http;
 using namespace Windows::Web::Http::Filters;
 using namespace CrazyGiraffe::AudioIdentification;
 using namespace CrazyGiraffe::AudioIdentification::ACRCloud;
+using namespace CrazyGiraffe::Common;
+
+namespace
+{
+    // The speed is corrected when the tuning is this clear, and the tape this far off; less than
+    // 5 cents is within the tuning of most records.
+    const double MinimumSpeedConfidence = 0.5;
+    const double MinimumSpeedError = 0.003;
+
+    // Audio below -34dB for a quarter second is the quiet between tracks, where the hiss is learned.
+    const double GapLevel = 0.02;
+    const CrazyGiraffe::Core::Ticks GapDuration(2500000);
+
+    // The stored samples of a WAV file being built, after the room for its header.
+    int16_t* StoredSamples(std::vector<byte>& fileContent)
+    {
+        return reinterpret_cast<int16_t*>(fileContent.data() + CrazyGiraffe::Core::WavHeaderSize);
+    }
+
+    size_t StoredSampleCount(const std::vector<byte>& fileContent)
+    {
+        return (fileContent.size() - CrazyGiraffe::Core::WavHeaderSize) / sizeof(int16_t);
+    }
+}
 
 ACRCloudSession::ACRCloudSession()
     : m_clientdata()
     , m_options()
+    , m_resultCache()
+    , m_persistentCache()
+    , m_retryPolicy()
+    , m_scheduler()
+    , m_correctSpeed(false)
+    , m_gapDetector()
+    , m_noiseGate()
+    , m_ungatedAudio()
+    , m_addedSamples(0)
+    , m_noiseLock()
+    , m_fingerprintDigest(0)
     , m_bytesPerSecond(0)
     , m_sessionId(Session::CreateSessionIdentifier())
-    , m_status(IdentifyStatus::Invalid)
+    , m_state(std::make_unique<CrazyGiraffe::Core::RecognitionSession>(0))
     , m_tracks((ref new Vector<IReadOnlyTrack^>())->GetView())
     , m_audioQueue()
-    , m_audioQueueSize(0)
-    , m_audioData()
-    , m_audioDataTargetSize(0)\
+    , m_audioStore()
+    , m_audioSize(0)
+    , m_audioSamples(0)
     , m_recognitionTask(create_task([] { task_from_result(); }))
-    , m_recognitionAttempts(0)
+    , m_cancellationTokenSource()
+    , m_metrics()
+    , m_queueLatency(nullptr)
+    , m_scheduleLatency(nullptr)
+    , m_fingerprintLatency(nullptr)
+    , m_queryLatency(nullptr)
+    , m_parseLatency(nullptr)
+    , m_audioBytes(nullptr)
+    , m_speedCorrections(nullptr)
+    , m_queries(nullptr)
+    , m_cacheHits(nullptr)
+    , m_identified(nullptr)
+    , m_traceChain(std::make_shared<TraceChain>())
+{
+}
+
+ACRCloudSession::~ACRCloudSession()
 {
+    // Abort the recognition in flight.
+    m_cancellationTokenSource.cancel();
 }
 
-void ACRCloudSession::Initialize(ACRCloudClientIdData^ clientdata, IHttpFilter^ httpFilter, SessionOptions^ options)
+void ACRCloudSession::Initialize(
+    ACRCloudClientIdData^ clientdata,
+    IHttpFilter^ httpFilter,
+    SessionOptions^ options,
+    ACRCloudResultCache^ resultCache,
+    PersistentTrackCache^ persistentCache,
+    ACRCloudRetryPolicy^ retryPolicy,
+    bool correctSpeed,
+    std::shared_ptr<CrazyGiraffe::Core::NoiseProfile> noiseProfile,
+    bool compressAudio,
+    std::shared_ptr<CrazyGiraffe::Core::SessionScheduler> scheduler,
+    std::shared_ptr<MetricsRegistry> factoryMetrics)
 {
     // Cache the options.
     m_client = ref new ACRCloudClient(clientdata, httpFilter);
     m_clientdata = clientdata;
     m_options = options;
+    m_resultCache = resultCache;
+    m_persistentCache = persistentCache;
+    m_retryPolicy = retryPolicy;
+    m_scheduler = scheduler;
+    m_correctSpeed = correctSpeed;
+    if (noiseProfile != nullptr)
+    {
+        m_gapDetector = std::make_unique<CrazyGiraffe::Core::AudioLevelDetector>(options->SampleRate, options->ChannelCount, GapLevel, GapDuration);
+        m_noiseGate = std::make_unique<CrazyGiraffe::Core::SpectralGate>(options->SampleRate, static_cast<uint16_t>(options->ChannelCount), noiseProfile);
+    }
+
+    // The audio is kept at 8kHz mono, a tenth or less of what is added, until the session ends.
+    m_audioStore = std::make_unique<CrazyGiraffe::Core::CompactAudioStore>(options->SampleRate, static_cast<uint16_t>(options->ChannelCount), compressAudio);
 
     m_bytesPerSecond = options->ChannelCount * options->SampleRate * options->SampleSize / 8;
+    m_state = std::make_unique<CrazyGiraffe::Core::RecognitionSession>(m_bytesPerSecond);
+
+    // Look the metrics up once, so the pipeline records them without locking.
+    m_metrics = std::make_shared<MetricsRegistry>(factoryMetrics);
+    m_queueLatency = &m_metrics->Histogram("queue");
+    m_scheduleLatency = &m_metrics->Histogram("schedule");
+    m_fingerprintLatency = &m_metrics->Histogram("fingerprint");
+    m_queryLatency = &m_metrics->Histogram("query");
+    m_parseLatency = &m_metrics->Histogram("parse");
+    m_audioBytes = &m_metrics->Counter("audio_bytes");
+    m_speedCorrections = &m_metrics->Counter("speed_corrections");
+    m_queries = &m_metrics->Counter("queries");
+    m_cacheHits = &m_metrics->Counter("cache_hits");
+    m_identified = &m_metrics->Counter("identified");
 }
 
 String^ ACRCloudSession::SessionIdentifier::get()
@@ -53,23 +149,50 @@ String^ ACRCloudSession::SessionIdentifier::get()
 
 IdentifyStatus ACRCloudSession::IdentificationStatus::get()
 {
-    return m_status;
+    // The values of the two enumerations match.
+    return static_cast<IdentifyStatus>(m_state->Status());
+}
+
+PipelineMetrics^ ACRCloudSession::Metrics::get()
+{
+    return ToPipelineMetrics(m_metrics != nullptr ? m_metrics->Snapshot() : MetricsSnapshot());
 }
 
 void ACRCloudSession::AddAudioSample(const Array<byte>^ audioData)
 {
-    if (m_status != IdentifyStatus::Complete && m_status != IdentifyStatus::Error && audioData != nullptr)
+    if (!m_state->IsFinished() && audioData != nullptr)
     {
-        // Save the audio data.
-        std::vector<byte> audioVector(begin(audioData), end(audioData));
-        m_audioQueue.push_back(audioVector);
-        m_audioQueueSize += audioData->Length;
+        // Save the audio data; a partial sample at the end is dropped.
+        size_t sampleCount = audioData->Length / (m_options->SampleSize / 8);
+        std::vector<float> samples(sampleCount);
+        CrazyGiraffe::Core::AudioFrameConverter::ConvertToFloat(audioData->Data, sampleCount, m_options->SampleSize, samples.data());
+
+        QueuedAudio queuedAudio;
+        if (m_noiseGate != nullptr)
+        {
+            // Gated and stored by the next attempt; the store keeps a whole number of its samples
+            // for the frames added, so where this sample will end is known now.
+            std::lock_guard<std::mutex> lock(m_noiseLock);
+            m_addedSamples += samples.size();
+            m_ungatedAudio.push_back(std::move(samples));
+            queuedAudio.storedEnd = static_cast<size_t>(m_addedSamples / m_options->ChannelCount * m_audioStore->SampleRate() / m_options->SampleRate);
+        }
+        else
+        {
+            m_audioStore->AddSamples(samples.data(), samples.size());
+            queuedAudio.storedEnd = m_audioStore->SampleCount();
+        }
+
+        queuedAudio.size = audioData->Length;
+        queuedAudio.queued = std::chrono::steady_clock::now();
+        m_audioQueue.push_back(queuedAudio);
+        m_audioBytes->Add(audioData->Length);
 
         // Every three seconds, try recognition on the audio buffer.
-        if ((m_audioDataTargetSize + (3 * m_bytesPerSecond)) < m_audioQueueSize)
+        size_t audioDataTargetSize = 0;
+        if (m_state->AddAudio(audioData->Length, audioDataTargetSize))
         {
-            m_audioDataTargetSize.store(m_audioQueueSize);
-            ProcessAudioSamples(m_audioDataTargetSize);
+            ProcessAudioSamples(static_cast<unsigned long>(audioDataTargetSize));
         }
     }
 }
@@ -87,9 +210,14 @@ IAsyncOperation<IVectorView<IReadOnlyTrack^>^>^ ACRCloudSession::GetTracksAsync(
 
 void ACRCloudSession::UpdateStatus(IdentifyStatus newStatus)
 {
-    // Update.
-    bool changed = (m_status != newStatus);
-    m_status = newStatus;
+    // Update; complete and error are final.
+    bool changed = m_state->SetStatus(static_cast<CrazyGiraffe::Core::IdentifyStatus>(newStatus));
+
+    // Nothing left to recognize.
+    if (newStatus == IdentifyStatus::Complete || newStatus == IdentifyStatus::Error)
+    {
+        m_cancellationTokenSource.cancel();
+    }
 
     if (changed)
     {
@@ -106,88 +234,256 @@ void ACRCloudSession::ProcessAudioSamples(unsigned long audioQueueTargetSize)
         return;
     }
 
-    // E1740 error - [this] seems to be an error but it's a bug in VS2019.
-    // It will show as an error in the editor and during a failed compilation
-    // but will compile cleanly. Move along, nothing to see here.
-    m_recognitionTask = create_task([this, audioQueueTargetSize]
+    // The chain holds a weak reference so a dropped session is freed right away, and the
+    // session token so completing, failing or dropping the session aborts the query in flight.
+    WeakReference weakThis(this);
+    cancellation_token cancellationToken = m_cancellationTokenSource.get_token();
+    //
+    // Every stage is traced as a span with the session, attempt and bytes, when tracing is enabled.
+    // The query and the parse are traced from when they are issued to when they complete.
+    //
+    // The factory's scheduler shares the machine and the backend between sessions: the attempt is put
+    // off by a random jitter, fingerprinting takes its turn on a shared pool, and the query waits for
+    // its turn under a rate limit across all sessions.
+    //
+    std::chrono::milliseconds triggerDelay = (m_scheduler != nullptr) ? m_scheduler->TriggerDelay() : std::chrono::milliseconds(0);
+    m_recognitionTask = ACRCloudRetryPolicy::Delay(triggerDelay).then([weakThis, audioQueueTargetSize]
         {
+            ACRCloudSession^ _this = ResolveSession(weakThis);
+            TraceSpan span("start", _this->m_sessionId->Data(), _this->CurrentAttempt(), _this->m_traceChain.get());
+
             // Only allow 3 attempts.
-            if (m_recognitionAttempts > 2)
+            if (!_this->m_state->CanAttempt())
             {
-                UpdateStatus(IdentifyStatus::Error);
+                _this->UpdateStatus(IdentifyStatus::Error);
                 cancel_current_task();
             }
-        }, task_continuation_context::use_arbitrary())
-    .then([this, audioQueueTargetSize](void)
+        }, cancellationToken)
+    .then([weakThis, audioQueueTargetSize](void)
         {
-            while (m_audioData.size() < audioQueueTargetSize)
+            ACRCloudSession^ _this = ResolveSession(weakThis);
+            TraceSpan span("dequeue", _this->m_sessionId->Data(), _this->CurrentAttempt(), _this->m_traceChain.get());
+            while (_this->m_audioSize < audioQueueTargetSize)
             {
-                if (m_audioQueue.empty())
+                if (_this->m_audioQueue.empty())
                 {
                     break;
                 }
 
-                std::vector<byte> audioVector = m_audioQueue.front();
-                    if (audioVector.empty())
+                QueuedAudio& queuedAudio = _this->m_audioQueue.front();
+                if (queuedAudio.size == 0)
                 {
                     break;
                 }
 
-                for (std::vector<byte>::iterator it = audioVector.begin(); it != audioVector.end(); ++it)
-                {
-                    m_audioData.push_back(*it);
-                }
-
-                m_audioQueue.pop_front();
+                _this->m_queueLatency->Record(std::chrono::steady_clock::now() - queuedAudio.queued);
+                _this->m_audioSize += queuedAudio.size;
+                _this->m_audioSamples = queuedAudio.storedEnd;
+                _this->m_audioQueue.pop_front();
             }
 
-            return task_from_result(m_audioData);
+            span.SetBytes(_this->m_audioSize);
+            return task_from_result(_this->m_audioSamples);
         }, task_continuation_context::use_arbitrary())
-    .then([this](std::vector<byte> audioData)
+    .then([weakThis](size_t audioSamples)
         {
-            size_t audioSecondsAvailable = audioData.size() / m_bytesPerSecond;
-            IBuffer^ fingerprintBuffer = GetFingerprint(audioData, audioSecondsAvailable);
-            return task_from_result(fingerprintBuffer);
+            ACRCloudSession^ _this = ResolveSession(weakThis);
+            task_completion_event<IBuffer^> fingerprinted;
+            std::chrono::steady_clock::time_point scheduled = std::chrono::steady_clock::now();
+            std::function<void()> fingerprint = [weakThis, audioSamples, fingerprinted, scheduled]()
+                {
+                    // A dropped session has no fingerprint, which ends the attempt.
+                    IBuffer^ fingerprintBuffer = nullptr;
+                    ACRCloudSession^ _this = weakThis.Resolve<ACRCloudSession>();
+                    if (_this != nullptr)
+                    {
+                        _this->m_scheduleLatency->Record(std::chrono::steady_clock::now() - scheduled);
+                        TraceSpan span("fingerprint", _this->m_sessionId->Data(), _this->CurrentAttempt(), _this->m_traceChain.get(), audioSamples * sizeof(int16_t));
+                        try
+                        {
+                            // The window is only decoded for as long as it is fingerprinted, after room
+                            // for the WAV header, so it is never copied.
+                            ScopedLatency latency(*_this->m_fingerprintLatency);
+                            if (_this->m_noiseGate != nullptr)
+                            {
+                                _this->ReduceNoise();
+                            }
+
+                            std::vector<byte> fileContent(CrazyGiraffe::Core::WavHeaderSize + audioSamples * sizeof(int16_t));
+                            _this->m_audioStore->Read(0, audioSamples, StoredSamples(fileContent));
+                            if (_this->m_correctSpeed)
+                            {
+                                _this->CorrectPlaybackSpeed(fileContent);
+                            }
+
+                            fingerprintBuffer = _this->GetFingerprint(fileContent);
+                        }
+                        catch (Exception^)
+                        {
+                            LOG_WARNING("ProcessAudioSamples: fingerprint failed");
+                        }
+                        catch (const std::exception& ex)
+                        {
+                            // Out of memory while resampling, or a window the store no longer has;
+                            // the event must still be set or the recognition never completes.
+                            LOG_WARNING("ProcessAudioSamples: fingerprint failed: %s", ex.what());
+                        }
+                        catch (...)
+                        {
+                            LOG_WARNING("ProcessAudioSamples: fingerprint failed");
+                        }
+                    }
+
+                    fingerprinted.set(fingerprintBuffer);
+                };
+
+            if (_this->m_scheduler != nullptr)
+            {
+                _this->m_scheduler->Schedule(ToUtf8(_this->m_sessionId), fingerprint);
+            }
+            else
+            {
+                fingerprint();
+            }
+
+            return create_task(fingerprinted);
         }, task_continuation_context::use_arbitrary())
-    .then([this](IBuffer^ fingerprintBuffer)
+    .then([weakThis](IBuffer^ fingerprintBuffer)
         {
             if (fingerprintBuffer == nullptr)
             {
                 cancel_current_task();
             }
 
-            return m_client->QueryTrackInfoAsync(fingerprintBuffer);
-    }, task_continuation_context::use_arbitrary())
-    .then([this](HttpRequestResult^ result)
-        {
-            if (!result->Succeeded)
+            ACRCloudSession^ _this = ResolveSession(weakThis);
+
+            // Skip the query if the same audio was identified recently, in memory first then on disk.
+            if (_this->m_resultCache != nullptr || _this->m_persistentCache != nullptr)
             {
-                cancel_current_task();
+                TraceSpan span("cache", _this->m_sessionId->Data(), _this->CurrentAttempt(), _this->m_traceChain.get(), fingerprintBuffer->Length);
+
+                _this->m_fingerprintDigest = ACRCloudResultCache::ComputeDigest(fingerprintBuffer);
+
+                ACRCloudTrackResponse^ cachedResponse = nullptr;
+                if (_this->m_resultCache != nullptr)
+                {
+                    cachedResponse = _this->m_resultCache->LookupDigest(_this->m_fingerprintDigest);
+                }
+
+                if (cachedResponse == nullptr && _this->m_persistentCache != nullptr)
+                {
+                    uint32 maximumDistance = _this->m_resultCache != nullptr ? _this->m_resultCache->MaximumDistance : 0;
+                    IVectorView<IReadOnlyTrack^>^ cachedTracks = _this->m_persistentCache->Lookup(_this->m_fingerprintDigest, maximumDistance);
+                    if (cachedTracks != nullptr)
+                    {
+                        cachedResponse = ref new ACRCloudTrackResponse(L"Success", nullptr, 0, cachedTracks);
+                        if (_this->m_resultCache != nullptr)
+                        {
+                            _this->m_resultCache->AddDigest(_this->m_fingerprintDigest, cachedResponse);
+                        }
+                    }
+                }
+
+                if (cachedResponse != nullptr)
+                {
+                    _this->m_cacheHits->Add();
+                    _this->m_identified->Add();
+                    _this->m_state->EndAttempt();
+                    _this->m_tracks = cachedResponse->Tracks;
+                    _this->UpdateStatus(IdentifyStatus::Complete);
+                    cancel_current_task();
+                }
             }
 
-            HttpResponseMessage^ response = result->ResponseMessage;
-            return response->Content->ReadAsStringAsync();
+            // Wait for a turn under the rate limit shared by every session of the factory.
+            std::chrono::milliseconds queryDelay = (_this->m_scheduler != nullptr) ? _this->m_scheduler->ReserveQuery() : std::chrono::milliseconds(0);
+            return ACRCloudRetryPolicy::Delay(queryDelay).then([fingerprintBuffer]()
+                {
+                    return fingerprintBuffer;
+                }, task_continuation_context::use_arbitrary());
         }, task_continuation_context::use_arbitrary())
-    .then([this](String^ responseBody)
+    .then([weakThis, cancellationToken](IBuffer^ fingerprintBuffer)
+        {
+            ACRCloudSession^ _this = ResolveSession(weakThis);
+
+            // The metrics and trace chain are held until the query ends, in case the session is dropped meanwhile.
+            std::shared_ptr<MetricsRegistry> metrics = _this->m_metrics;
+            LatencyHistogram* queryLatency = _this->m_queryLatency;
+            std::chrono::steady_clock::time_point queryStart = std::chrono::steady_clock::now();
+            std::shared_ptr<TraceChain> traceChain = _this->m_traceChain;
+            String^ sessionId = _this->m_sessionId;
+            uint32 attempt = _this->CurrentAttempt();
+            uint32 fingerprintSize = fingerprintBuffer->Length;
+            int64 traceStart = Tracer::Instance().IsEnabled() ? Tracer::Instance().Now() : -1;
+            _this->m_queries->Add();
+            return _this->m_client->QueryTrackResponseAsync(fingerprintBuffer, _this->m_retryPolicy, cancellationToken)
+                .then([metrics, queryLatency, queryStart, traceChain, sessionId, attempt, fingerprintSize, traceStart](task<String^> queryTask)
+                    {
+                        queryLatency->Record(std::chrono::steady_clock::now() - queryStart);
+                        if (traceStart >= 0)
+                        {
+                            Tracer& tracer = Tracer::Instance();
+                            tracer.Record("query", sessionId->Data(), attempt, fingerprintSize, traceStart, tracer.Now(), traceChain.get());
+                        }
+
+                        return queryTask.get();
+                    }, task_continuation_context::use_arbitrary());
+    }, task_continuation_context::use_arbitrary())
+    .then([weakThis](String^ responseBody)
         {
-            if (responseBody->IsEmpty())
+            // Every attempt failed or the deadline passed; try again with more audio.
+            if (responseBody == nullptr)
             {
+                LOG_WARNING("ProcessAudioSamples: query failed");
                 cancel_current_task();
             }
 
-            return m_client->ParseTrackResponseAync(responseBody);
+            ACRCloudSession^ _this = ResolveSession(weakThis);
+            std::shared_ptr<MetricsRegistry> metrics = _this->m_metrics;
+            LatencyHistogram* parseLatency = _this->m_parseLatency;
+            std::chrono::steady_clock::time_point parseStart = std::chrono::steady_clock::now();
+            std::shared_ptr<TraceChain> traceChain = _this->m_traceChain;
+            String^ sessionId = _this->m_sessionId;
+            uint32 attempt = _this->CurrentAttempt();
+            uint32 responseSize = responseBody->Length();
+            int64 traceStart = Tracer::Instance().IsEnabled() ? Tracer::Instance().Now() : -1;
+            return create_task(_this->m_client->ParseTrackResponseAync(responseBody))
+                .then([metrics, parseLatency, parseStart, traceChain, sessionId, attempt, responseSize, traceStart](task<ACRCloudTrackResponse^> parseTask)
+                    {
+                        parseLatency->Record(std::chrono::steady_clock::now() - parseStart);
+                        if (traceStart >= 0)
+                        {
+                            Tracer& tracer = Tracer::Instance();
+                            tracer.Record("parse", sessionId->Data(), attempt, responseSize, traceStart, tracer.Now(), traceChain.get());
+                        }
+
+                        return parseTask.get();
+                    }, task_continuation_context::use_arbitrary());
         }, task_continuation_context::use_arbitrary())
-    .then([this](task<ACRCloudTrackResponse^> previousTask)
+    .then([weakThis](task<ACRCloudTrackResponse^> previousTask)
         {
             try
             {
                 ACRCloudTrackResponse^ trackRepsonse = previousTask.get();
-                m_recognitionAttempts++;
+                ACRCloudSession^ _this = ResolveSession(weakThis);
+                TraceSpan span("complete", _this->m_sessionId->Data(), _this->CurrentAttempt(), _this->m_traceChain.get());
+                _this->m_state->EndAttempt();
 
                 if (trackRepsonse->Code == 0)
                 {
-                    m_tracks = trackRepsonse->Tracks;
-                    UpdateStatus(IdentifyStatus::Complete);
+                    if (_this->m_resultCache != nullptr)
+                    {
+                        _this->m_resultCache->AddDigest(_this->m_fingerprintDigest, trackRepsonse);
+                    }
+
+                    if (_this->m_persistentCache != nullptr && !_this->m_persistentCache->IsReadOnly)
+                    {
+                        _this->m_persistentCache->Add(_this->m_fingerprintDigest, trackRepsonse->Tracks);
+                    }
+
+                    _this->m_identified->Add();
+                    _this->m_tracks = trackRepsonse->Tracks;
+                    _this->UpdateStatus(IdentifyStatus::Complete);
                 }
             }
             catch (const task_canceled&)
@@ -199,7 +495,72 @@ void ACRCloudSession::ProcessAudioSamples(unsigned long audioQueueTargetSize)
         }, task_continuation_context::use_arbitrary());
 }
 
-IBuffer^ ACRCloudSession::GetFingerprint(std::vector<byte>& audioContent, size_t audioContentSize)
+uint32 ACRCloudSession::CurrentAttempt()
+{
+    return m_state->CurrentAttempt();
+}
+
+/* static */
+ACRCloudSession^ ACRCloudSession::ResolveSession(WeakReference weakThis)
+{
+    ACRCloudSession^ session = weakThis.Resolve<ACRCloudSession>();
+    if (session == nullptr || session->m_cancellationTokenSource.get_token().is_canceled())
+    {
+        cancel_current_task();
+    }
+
+    return session;
+}
+
+void ACRCloudSession::ReduceNoise()
+{
+    // Each sample is gated as it was added, so the gaps are heard as before.
+    std::lock_guard<std::mutex> lock(m_noiseLock);
+    std::vector<float> gated;
+    for (; !m_ungatedAudio.empty(); m_ungatedAudio.pop_front())
+    {
+        std::vector<float>& samples = m_ungatedAudio.front();
+        m_gapDetector->ProcessSamples(samples.data(), samples.size(), [](CrazyGiraffe::Core::ThresholdStatus) {});
+        bool isGap = m_gapDetector->Status() == CrazyGiraffe::Core::ThresholdStatus::BelowThreshold;
+
+        gated.resize(samples.size());
+        m_noiseGate->ProcessSamples(samples.data(), samples.size(), isGap, gated.data());
+        m_audioStore->AddSamples(gated.data(), gated.size());
+    }
+}
+
+void ACRCloudSession::CorrectPlaybackSpeed(std::vector<byte>& fileContent)
+{
+    // The tuning peaks which tell the speed are below 4kHz, so the stored audio shows them.
+    const int16_t* stored = StoredSamples(fileContent);
+    std::vector<float> samples(StoredSampleCount(fileContent));
+    for (size_t index = 0; index < samples.size(); index++)
+    {
+        samples[index] = stored[index] / 32768.0f;
+    }
+
+    CrazyGiraffe::Core::SpeedEstimate estimate =
+        CrazyGiraffe::Core::EstimateSpeedFromTuning(samples.data(), samples.size(), m_audioStore->SampleRate(), 1);
+    if (estimate.confidence < MinimumSpeedConfidence || std::abs(estimate.speed - 1.0) < MinimumSpeedError)
+    {
+        return;
+    }
+
+    std::vector<float> corrected;
+    CrazyGiraffe::Core::CorrectSpeed(samples.data(), samples.size(), 1, estimate.speed, corrected);
+    fileContent.resize(CrazyGiraffe::Core::WavHeaderSize + corrected.size() * sizeof(int16_t));
+    int16_t* output = StoredSamples(fileContent);
+    for (size_t index = 0; index < corrected.size(); index++)
+    {
+        float sample = std::max(-1.0f, std::min(corrected[index], 32767.0f / 32768.0f));
+        output[index] = static_cast<int16_t>(std::lround(sample * 32768.0f));
+    }
+
+    m_speedCorrections->Add();
+    LOG_INFO("CorrectPlaybackSpeed: speed %.4f, confidence %.2f", estimate.speed, estimate.confidence);
+}
+
+IBuffer^ ACRCloudSession::GetFingerprint(std::vector<byte>& fileContent)
 {
     IBuffer^ buffer = nullptr;
     int start_time_seconds = 0;
@@ -209,13 +570,13 @@ IBuffer^ ACRCloudSession::GetFingerprint(std::vector<byte>& audioContent, size_t
     Array<byte>^ fingerprintBytes;
     int rc = 0;
 
-    // Create the fingerprint. create_fingerprint expects a 8000 hz stream but we don't have that, Instead,
-    // wrap our stream in a wav header and let create_fingerprint_by_filebuffer handle the conversion.
-    std::vector<byte> fileContent;
-    rc = PrependFileHeader(audioContent, audioContentSize, fileContent);
+    // Create the fingerprint. create_fingerprint expects a 8000 hz stream, which is what is stored unless
+    // the session's rate is lower; wrap it in a wav header and let create_fingerprint_by_filebuffer
+    // handle any conversion.
+    rc = WriteFileHeader(fileContent);
     ACR_CHECK(rc);
 
-    audio_len_seconds = static_cast<int>(audioContentSize / m_bytesPerSecond);
+    audio_len_seconds = static_cast<int>(StoredSampleCount(fileContent) / m_audioStore->SampleRate());
     rc = create_fingerprint_by_filebuffer(
         reinterpret_cast<char*>(fileContent.data()),
         static_cast<int>(fileContent.size()),
@@ -240,107 +601,14 @@ error:
     return buffer;
 }
 
-int ACRCloudSession::PrependFileHeader(const std::vector<byte>& audioContent, size_t audioContentSize, std::vector<byte>& fileContent)
+int ACRCloudSession::WriteFileHeader(std::vector<byte>& fileContent)
 {
-    union byte_converter
-    {
-        int intValue;
-        short shortValue;
-        unsigned char bytes[sizeof(float)];
-    } byte_converter;
-
-    // Get the size of the content.
-    int subChunk2Size = static_cast<int>(audioContent.size());
-
-    //
-    // From: http://soundfile.sapp.org/doc/WaveFormat/
-    //
-    // Offset  Size  Name             Description
-    // 0       4     ChunkID          Contains the letters "RIFF" in ASCII form (0x52494646 big - endian form).
-    fileContent.push_back(0x52);
-    fileContent.push_back(0x49);
-    fileContent.push_back(0x46);
-    fileContent.push_back(0x46);
-
-    // 4       4     ChunkSize        36 + SubChunk2Size, or more precisely : 4 + (8 + SubChunk1Size) + (8 + SubChunk2Size)
-    byte_converter.intValue = 36 + subChunk2Size;
-    fileContent.push_back(byte_converter.bytes[0]);
-    fileContent.push_back(byte_converter.bytes[1]);
-    fileContent.push_back(byte_converter.bytes[2]);
-    fileContent.push_back(byte_converter.bytes[3]);
-
-    // 8       4     Format           Contains the letters "WAVE" (0x57415645 big - endian form).
-    fileContent.push_back(0x57);
-    fileContent.push_back(0x41);
-    fileContent.push_back(0x56);
-    fileContent.push_back(0x45);
-
-    // 12      4     Subchunk1ID      Contains the letters "fmt " (0x666d7420 big - endian form).
-    fileContent.push_back(0x66);
-    fileContent.push_back(0x6d);
-    fileContent.push_back(0x74);
-    fileContent.push_back(0x20);
-
-    // 16      4     Subchunk1Size    16 for PCM. This is the size of the rest of the Subchunk which follows this number.
-    byte_converter.intValue = 16;
-    fileContent.push_back(byte_converter.bytes[0]);
-    fileContent.push_back(byte_converter.bytes[1]);
-    fileContent.push_back(byte_converter.bytes[2]);
-    fileContent.push_back(byte_converter.bytes[3]);
-
-    // 20      2     AudioFormat      PCM = 1 (i.e.Linear quantization) Values other than 1 indicate some form of compression.
-    byte_converter.shortValue = 1;
-    fileContent.push_back(byte_converter.bytes[0]);
-    fileContent.push_back(byte_converter.bytes[1]);
-
-    // 22      2     NumChannels      Mono = 1, Stereo = 2, etc.
-    byte_converter.shortValue = m_options->ChannelCount;
-    fileContent.push_back(byte_converter.bytes[0]);
-    fileContent.push_back(byte_converter.bytes[1]);
-
-    // 24      4     SampleRate       8000, 44100, etc.
-    byte_converter.intValue = m_options->SampleRate;
-    fileContent.push_back(byte_converter.bytes[0]);
-    fileContent.push_back(byte_converter.bytes[1]);
-    fileContent.push_back(byte_converter.bytes[2]);
-    fileContent.push_back(byte_converter.bytes[3]);
-
-    // 28      4     ByteRate         SampleRate * NumChannels * BitsPerSample / 8
-    byte_converter.intValue = m_options->SampleRate * m_options->ChannelCount * m_options->SampleSize / 8;
-    fileContent.push_back(byte_converter.bytes[0]);
-    fileContent.push_back(byte_converter.bytes[1]);
-    fileContent.push_back(byte_converter.bytes[2]);
-    fileContent.push_back(byte_converter.bytes[3]);
-
-    // 32      2     BlockAlign       NumChannels * BitsPerSample / 8. The number of bytes for one sample including all channels.
-    byte_converter.shortValue = m_options->ChannelCount * m_options->SampleSize / 8;
-    fileContent.push_back(byte_converter.bytes[0]);
-    fileContent.push_back(byte_converter.bytes[1]);
-
-    // 34      2     BitsPerSample    8 bits = 8, 16 bits = 16, etc.
-    byte_converter.shortValue = m_options->SampleSize;
-    fileContent.push_back(byte_converter.bytes[0]);
-    fileContent.push_back(byte_converter.bytes[1]);
-
-    // 36      4     Subchunk2ID      Contains the letters "data" (0x64617461 big - endian form).
-    fileContent.push_back(0x64);
-    fileContent.push_back(0x61);
-    fileContent.push_back(0x74);
-    fileContent.push_back(0x61);
-
-    // 40      4     Subchunk2Size    NumSamples * NumChannels * BitsPerSample / 8. This is the number of bytes in the data.
-    byte_converter.intValue = subChunk2Size;
-    fileContent.push_back(byte_converter.bytes[0]);
-    fileContent.push_back(byte_converter.bytes[1]);
-    fileContent.push_back(byte_converter.bytes[2]);
-    fileContent.push_back(byte_converter.bytes[3]);
-
-    // 44      *     Data             The actual sound data.
-    // Iterate the audioContent vector and deep-copy to the member vector.
-    for (std::vector<byte>::const_iterator it = audioContent.cbegin(); it != audioContent.cend(); it++)
-    {
-        fileContent.push_back(*it);
-    }
-
+    // A canonical 44-byte PCM header; see http://soundfile.sapp.org/doc/WaveFormat/.
+    CrazyGiraffe::Core::AudioFormat format = {
+        m_audioStore->SampleRate(),
+        1,
+        16,
+        CrazyGiraffe::Core::SampleType::Pcm };
+    CrazyGiraffe::Core::FrameWavFile(format, fileContent.data(), fileContent.size());
     return 0;
 }
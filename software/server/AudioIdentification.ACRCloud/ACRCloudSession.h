@@ -7,11 +7,34 @@
 #pragma once
 #include "ACRCloudClient.h"
 #include "ACRCloudClientIdData.h"
+#include "ACRCloudResultCache.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "Core/AudioLevelDetector.h"
+#include "Core/CompactAudioStore.h"
+#include "Core/RecognitionSession.h"
+#include "Core/SessionScheduler.h"
+#include "Core/SpectralGate.h"
 #include <SharedQueue.h>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
 {
+    ///
+    /// An audio sample waiting to be fingerprinted: its size as it was added, the samples stored up to
+    /// its end, once any noise reduction has caught up with it, and when it was queued.
+    ///
+    struct QueuedAudio
+    {
+        size_t size;
+        size_t storedEnd;
+        std::chrono::steady_clock::time_point queued;
+    };
+
     /// <summary>
     /// Session for identifying a song.
     /// </summary>
@@ -39,6 +62,14 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
             CrazyGiraffe::AudioIdentification::IdentifyStatus get();
         }
 
+        /// <summary>
+        /// Gets a snapshot of the counters and stage latencies of the session.
+        /// </summary>
+        property CrazyGiraffe::AudioIdentification::PipelineMetrics^ Metrics
+        {
+            CrazyGiraffe::AudioIdentification::PipelineMetrics^ get();
+        }
+
         /// <summary>
         /// Add an audio sample for fingerprint
         /// </summary>
@@ -51,6 +82,11 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
         virtual Windows::Foundation::IAsyncOperation<Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^>^
             GetTracksAsync();
 
+        /// <summary>
+        /// Finalizes an instance of the <see cref="ACRCloudSession" /> class. Aborts the recognition in flight.
+        /// </summary>
+        virtual ~ACRCloudSession();
+
     internal:
         /// <summary>
         /// Prevents a default instance of the <see cref="ACRCloudSession" /> class from being created.
@@ -62,10 +98,26 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
         /// </summary>
         /// <param name="clientdata">the client data.</param>
         /// <param name="options">the options.</param>
+        /// <param name="resultCache">the result cache, or null.</param>
+        /// <param name="persistentCache">the on-disk cache, or null.</param>
+        /// <param name="retryPolicy">the retry policy, or null for no retries.</param>
+        /// <param name="correctSpeed">whether to correct the speed of the tape before fingerprinting.</param>
+        /// <param name="noiseProfile">the hiss learned by the sessions of the deck, or null not to gate it out.</param>
+        /// <param name="compressAudio">whether to keep the stored audio Rice coded.</param>
+        /// <param name="scheduler">the scheduler shared by the sessions of the factory, or null to run unscheduled.</param>
+        /// <param name="factoryMetrics">the metrics of the factory, which the session's add up to.</param>
         void Initialize(
             CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudClientIdData^ clientdata,
             Windows::Web::Http::Filters::IHttpFilter^ httpFilter,
-            CrazyGiraffe::AudioIdentification::SessionOptions^ options);
+            CrazyGiraffe::AudioIdentification::SessionOptions^ options,
+            CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudResultCache^ resultCache,
+            CrazyGiraffe::AudioIdentification::PersistentTrackCache^ persistentCache,
+            CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudRetryPolicy^ retryPolicy,
+            bool correctSpeed,
+            std::shared_ptr<CrazyGiraffe::Core::NoiseProfile> noiseProfile,
+            bool compressAudio,
+            std::shared_ptr<CrazyGiraffe::Core::SessionScheduler> scheduler,
+            std::shared_ptr<CrazyGiraffe::Common::MetricsRegistry> factoryMetrics);
 
     protected:
         /// <summary>
@@ -75,20 +127,41 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
         void UpdateStatus(CrazyGiraffe::AudioIdentification::IdentifyStatus newStatus);
 
     private:
+        ///
+        /// Resolve the session from a recognition task, or cancel the task if it was dropped or cancelled.
+        ///
+        static ACRCloudSession^ ResolveSession(Platform::WeakReference weakThis);
+
+        ///
+        /// Get the attempt in progress, for tracing.
+        ///
+        uint32 CurrentAttempt();
+
+        ///
+        /// Gate the hiss out of the audio added since, learning it while the audio is quiet, and store
+        /// it. Called from the fingerprint work rather than from AddAudioSample, off the audio thread.
+        ///
+        void ReduceNoise();
+
         ///
         /// Process the audio sample upto audioDataSize bytes.
         ///
         void ProcessAudioSamples(unsigned long audioDataSize);
 
         ///
-        /// Get the fingerprint
+        /// Play the audio back at its true speed if the tuning of the music says the tape runs fast or slow.
         ///
-        Windows::Storage::Streams::IBuffer^ GetFingerprint(std::vector<byte>& audioContent, size_t audioContentSize);
+        void CorrectPlaybackSpeed(std::vector<byte>& fileContent);
 
         ///
-        /// Append the file header to the audio content.
+        /// Get the fingerprint of stored audio, which follows room for the file header.
         ///
-        int PrependFileHeader(const std::vector<byte>& audioContent, size_t audioContentSize, std::vector<byte>& fileContent);
+        Windows::Storage::Streams::IBuffer^ GetFingerprint(std::vector<byte>& fileContent);
+
+        ///
+        /// Write the file header into the room before the stored audio.
+        ///
+        int WriteFileHeader(std::vector<byte>& fileContent);
 
     private:
         /// <summary>
@@ -106,6 +179,51 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
         /// </summary>
         CrazyGiraffe::AudioIdentification::SessionOptions^ m_options;
 
+        ///
+        /// The result cache shared by the sessions of a factory, or null.
+        ///
+        CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudResultCache^ m_resultCache;
+
+        ///
+        /// The on-disk cache shared by the sessions of a factory, or null.
+        ///
+        CrazyGiraffe::AudioIdentification::PersistentTrackCache^ m_persistentCache;
+
+        ///
+        /// The retry policy shared by the sessions of a factory, or null.
+        ///
+        CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudRetryPolicy^ m_retryPolicy;
+
+        ///
+        /// The scheduler shared by the sessions of a factory, or null.
+        ///
+        std::shared_ptr<CrazyGiraffe::Core::SessionScheduler> m_scheduler;
+
+        ///
+        /// Whether to correct the speed of the tape before fingerprinting.
+        ///
+        bool m_correctSpeed;
+
+        ///
+        /// Hears the quiet between tracks, and gates the hiss learned there out of the audio; null
+        /// when noise reduction is off.
+        ///
+        std::unique_ptr<CrazyGiraffe::Core::AudioLevelDetector> m_gapDetector;
+        std::unique_ptr<CrazyGiraffe::Core::SpectralGate> m_noiseGate;
+
+        ///
+        /// The samples added and not yet gated and stored, as they were added, and the count of all
+        /// the samples added. The lock keeps the gate to one attempt at a time, in order.
+        ///
+        std::deque<std::vector<float>> m_ungatedAudio;
+        uint64_t m_addedSamples;
+        std::mutex m_noiseLock;
+
+        ///
+        /// The digest of the fingerprint being queried.
+        ///
+        uint64 m_fingerprintDigest;
+
         /// <summary>
         /// Number of bytes per second of audio.
         /// </summary>
@@ -116,10 +234,10 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
         ///
         Platform::String^ m_sessionId;
 
-        /// <summary>
-        /// The status of the session.
-        /// </summary>
-        std::atomic<CrazyGiraffe::AudioIdentification::IdentifyStatus> m_status;
+        ///
+        /// The status, buffered audio size and attempts of the session.
+        ///
+        std::unique_ptr<CrazyGiraffe::Core::RecognitionSession> m_state;
 
         ///
         /// The identified tracks.
@@ -129,31 +247,55 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
         ///
         /// The buffered audio data.
         ///
-        SharedQueue<std::vector<byte>> m_audioQueue;
+        SharedQueue<CrazyGiraffe::AudioIdentification::ACRCloud::QueuedAudio> m_audioQueue;
 
         ///
-        /// The buffered audio data size.
+        /// The audio added, kept at 8kHz mono, and how much of it the attempts have dequeued: the
+        /// bytes as they were added, and the samples stored.
         ///
-        std::atomic<unsigned long> m_audioQueueSize;
+        std::unique_ptr<CrazyGiraffe::Core::CompactAudioStore> m_audioStore;
+        size_t m_audioSize;
+        size_t m_audioSamples;
 
         ///
-        /// The audio/file content.
+        /// The number of recognition attempts.
         ///
-        std::vector<byte> m_audioData;
+        Concurrency::task<void> m_recognitionTask;
 
         ///
-        /// The target size of the audio/file content.
+        /// Cancelled when the session completes, fails or is destroyed.
         ///
-        std::atomic<unsigned long> m_audioDataTargetSize;
+        Concurrency::cancellation_token_source m_cancellationTokenSource;
 
         ///
-        /// The number of recognition attempts.
+        /// The metrics of the session.
         ///
-        Concurrency::task<void> m_recognitionTask;
+        std::shared_ptr<CrazyGiraffe::Common::MetricsRegistry> m_metrics;
 
         ///
-        /// The number of recognition attempts.
+        /// The stages of the pipeline, looked up once: the wait in the audio queue, the wait for the
+        /// scheduler, fingerprinting, querying (all attempts) and parsing the response.
+        ///
+        CrazyGiraffe::Common::LatencyHistogram* m_queueLatency;
+        CrazyGiraffe::Common::LatencyHistogram* m_scheduleLatency;
+        CrazyGiraffe::Common::LatencyHistogram* m_fingerprintLatency;
+        CrazyGiraffe::Common::LatencyHistogram* m_queryLatency;
+        CrazyGiraffe::Common::LatencyHistogram* m_parseLatency;
+
+        ///
+        /// The audio queued, the audio corrected for speed, the queries, the queries answered from a
+        /// cache, and the sessions identified.
+        ///
+        CrazyGiraffe::Common::MetricCounter* m_audioBytes;
+        CrazyGiraffe::Common::MetricCounter* m_speedCorrections;
+        CrazyGiraffe::Common::MetricCounter* m_queries;
+        CrazyGiraffe::Common::MetricCounter* m_cacheHits;
+        CrazyGiraffe::Common::MetricCounter* m_identified;
+
+        ///
+        /// The end of the last traced stage of the recognition chain. Held by the query and parse
+        /// continuations, which may finish after the session is dropped.
         ///
-        std::atomic<int> m_recognitionAttempts;
+        std::shared_ptr<CrazyGiraffe::Common::TraceChain> m_traceChain;
     };
 } } }
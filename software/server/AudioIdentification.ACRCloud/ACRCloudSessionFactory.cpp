@@ -8,6 +8,7 @@
 #include "ACRCloudSessionFactory.h"
 #include "ACRCloudSession.h"
 #include "ACRCloudHelpers.h"
+#include "Trace.h"
 #include <stdlib.h>
 
 using namespace concurrency;
@@ -17,11 +18,23 @@ using namespace Windows::Storage;
 using namespace Windows::Web::Http::Filters;
 using namespace CrazyGiraffe::AudioIdentification;
 using namespace CrazyGiraffe::AudioIdentification::ACRCloud;
+using namespace CrazyGiraffe::Common;
 
 ACRCloudSessionFactory::ACRCloudSessionFactory(ACRCloudClientIdData^ clientdata)
     : m_clientdata(clientdata)
     , m_initialized(false)
     , m_httpFilter(nullptr)
+    , m_resultCache(ref new ACRCloudResultCache())
+    , m_persistentCache(nullptr)
+    , m_retryPolicy(ref new ACRCloudRetryPolicy())
+    , m_correctSpeed(false)
+    , m_reduceNoise(false)
+    , m_shareNoiseProfile(false)
+    , m_noiseProfiles()
+    , m_noiseProfileLock()
+    , m_compressAudio(false)
+    , m_scheduler(std::make_shared<CrazyGiraffe::Core::SessionScheduler>())
+    , m_metrics(std::make_shared<MetricsRegistry>())
 {
 }
 
@@ -29,9 +42,114 @@ ACRCloudSessionFactory::ACRCloudSessionFactory(ACRCloudClientIdData^ clientdata,
     : m_clientdata(clientdata)
     , m_initialized(false)
     , m_httpFilter(httpFilter)
+    , m_resultCache(ref new ACRCloudResultCache())
+    , m_persistentCache(nullptr)
+    , m_retryPolicy(ref new ACRCloudRetryPolicy())
+    , m_correctSpeed(false)
+    , m_reduceNoise(false)
+    , m_shareNoiseProfile(false)
+    , m_noiseProfiles()
+    , m_noiseProfileLock()
+    , m_compressAudio(false)
+    , m_scheduler(std::make_shared<CrazyGiraffe::Core::SessionScheduler>())
+    , m_metrics(std::make_shared<MetricsRegistry>())
 {
 }
 
+ACRCloudResultCache^ ACRCloudSessionFactory::ResultCache::get()
+{
+    return m_resultCache;
+}
+
+void ACRCloudSessionFactory::ResultCache::set(ACRCloudResultCache^ value)
+{
+    m_resultCache = value;
+}
+
+PersistentTrackCache^ ACRCloudSessionFactory::PersistentCache::get()
+{
+    return m_persistentCache;
+}
+
+void ACRCloudSessionFactory::PersistentCache::set(PersistentTrackCache^ value)
+{
+    m_persistentCache = value;
+}
+
+ACRCloudRetryPolicy^ ACRCloudSessionFactory::RetryPolicy::get()
+{
+    return m_retryPolicy;
+}
+
+void ACRCloudSessionFactory::RetryPolicy::set(ACRCloudRetryPolicy^ value)
+{
+    m_retryPolicy = value;
+}
+
+bool ACRCloudSessionFactory::IsSpeedCorrectionEnabled::get()
+{
+    return m_correctSpeed;
+}
+
+void ACRCloudSessionFactory::IsSpeedCorrectionEnabled::set(bool value)
+{
+    m_correctSpeed = value;
+}
+
+bool ACRCloudSessionFactory::IsNoiseReductionEnabled::get()
+{
+    return m_reduceNoise;
+}
+
+void ACRCloudSessionFactory::IsNoiseReductionEnabled::set(bool value)
+{
+    m_reduceNoise = value;
+}
+
+bool ACRCloudSessionFactory::IsNoiseProfileShared::get()
+{
+    return m_shareNoiseProfile;
+}
+
+void ACRCloudSessionFactory::IsNoiseProfileShared::set(bool value)
+{
+    m_shareNoiseProfile = value;
+}
+
+bool ACRCloudSessionFactory::IsAudioCompressionEnabled::get()
+{
+    return m_compressAudio;
+}
+
+void ACRCloudSessionFactory::IsAudioCompressionEnabled::set(bool value)
+{
+    m_compressAudio = value;
+}
+
+PipelineMetrics^ ACRCloudSessionFactory::Metrics::get()
+{
+    return ToPipelineMetrics(m_metrics->Snapshot());
+}
+
+bool ACRCloudSessionFactory::IsTracingEnabled::get()
+{
+    return Tracer::Instance().IsEnabled();
+}
+
+void ACRCloudSessionFactory::IsTracingEnabled::set(bool value)
+{
+    Tracer::Instance().SetEnabled(value);
+}
+
+/* static */
+String^ ACRCloudSessionFactory::ExportTrace()
+{
+    // The trace is ASCII.
+    std::string trace = Tracer::Instance().ExportChromeTrace();
+    std::wstring wideTrace(trace.begin(), trace.end());
+    return ref new String(wideTrace.c_str(), static_cast<unsigned int>(wideTrace.size()));
+}
+
 IAsyncOperation<ISession^>^ ACRCloudSessionFactory::CreateSessionAsync(SessionOptions^ options)
 {
     // E1740 error - [this] seems to be an error but it's a bug in VS2019.
@@ -47,8 +165,59 @@ IAsyncOperation<ISession^>^ ACRCloudSessionFactory::CreateSessionAsync(SessionOp
 
             // Create an initialize a new server.
             ACRCloudSession^ session = ref new ACRCloudSession();
-            session->Initialize(m_clientdata, m_httpFilter, options);
+            session->Initialize(m_clientdata, m_httpFilter, options, m_resultCache, m_persistentCache, m_retryPolicy, m_correctSpeed, GetNoiseProfile(options), m_compressAudio, m_scheduler, m_metrics);
 
             return task_from_result<ISession^>(session);
         });
 }
+
+/* static */
+PersistentTrackCache^ ACRCloudSessionFactory::OpenPersistentCache()
+{
+    String^ folderPath = ApplicationData::Current->LocalFolder->Path + L"\\acrcloud";
+
+    // Only one process can write the cache, the others share it read-only.
+    try
+    {
+        return ref new PersistentTrackCache(folderPath, false);
+    }
+    catch (Exception^)
+    {
+    }
+
+    try
+    {
+        return ref new PersistentTrackCache(folderPath, true);
+    }
+    catch (Exception^)
+    {
+    }
+
+    return nullptr;
+}
+
+std::shared_ptr<CrazyGiraffe::Core::NoiseProfile> ACRCloudSessionFactory::GetNoiseProfile(SessionOptions^ options)
+{
+    if (!m_reduceNoise)
+    {
+        return nullptr;
+    }
+
+    // Hiss is a property of the deck and its tape, so a session which doesn't say where it plays learns its own.
+    String^ deckIdentifier = options->DeckIdentifier;
+    if (!m_shareNoiseProfile && (deckIdentifier == nullptr || deckIdentifier->IsEmpty()))
+    {
+        return std::make_shared<CrazyGiraffe::Core::NoiseProfile>(CrazyGiraffe::Core::SpectralGate::BinCount());
+    }
+
+    // The bins of a profile are of a width in Hz, so only sessions at one rate share it.
+    std::wstring deck = m_shareNoiseProfile ? std::wstring() : std::wstring(deckIdentifier->Data());
+    std::lock_guard<std::mutex> lock(m_noiseProfileLock);
+    std::shared_ptr<CrazyGiraffe::Core::NoiseProfile>& profile = m_noiseProfiles[std::make_pair(deck, static_cast<uint32>(options->SampleRate))];
+    if (profile == nullptr)
+    {
+        profile = std::make_shared<CrazyGiraffe::Core::NoiseProfile>(CrazyGiraffe::Core::SpectralGate::BinCount());
+    }
+
+    return profile;
+}
@@ -6,6 +6,16 @@
 //-----------------------------------------------------------------------
 #pragma once
 #include "ACRCloudClientIdData.h"
+#include "ACRCloudResultCache.h"
+#include "ACRCloudRetryPolicy.h"
+#include "Metrics.h"
+#include "Core/SessionScheduler.h"
+#include "Core/SpectralGate.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
 
 namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
 {
@@ -29,6 +39,106 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
             CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudClientIdData^ clientdata,
             Windows::Web::Http::Filters::IHttpFilter^ httpFilter);
 
+        /// <summary>
+        /// Gets or sets the result cache shared by the sessions. Set to null to disable caching.
+        /// </summary>
+        property CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudResultCache^ ResultCache
+        {
+            CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudResultCache^ get();
+            void set(CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudResultCache^ value);
+        }
+
+        /// <summary>
+        /// Gets or sets the on-disk cache behind the result cache, null by default. Set it to
+        /// <see cref="OpenPersistentCache" /> to keep results across runs.
+        /// </summary>
+        property CrazyGiraffe::AudioIdentification::PersistentTrackCache^ PersistentCache
+        {
+            CrazyGiraffe::AudioIdentification::PersistentTrackCache^ get();
+            void set(CrazyGiraffe::AudioIdentification::PersistentTrackCache^ value);
+        }
+
+        /// <summary>
+        /// Gets or sets the retry and hedging budget shared by the sessions. Set to null to disable retries.
+        /// </summary>
+        property CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudRetryPolicy^ RetryPolicy
+        {
+            CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudRetryPolicy^ get();
+            void set(CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudRetryPolicy^ value);
+        }
+
+        /// <summary>
+        /// Gets or sets a value indicating whether the sessions correct the speed of the tape, as heard
+        /// from the tuning of the music, before fingerprinting. Off by default: music which isn't tuned
+        /// to A440 reads as a tape running off speed, and would be resampled when it needn't be.
+        /// </summary>
+        property bool IsSpeedCorrectionEnabled
+        {
+            bool get();
+            void set(bool value);
+        }
+
+        /// <summary>
+        /// Gets or sets a value indicating whether the sessions gate the hiss out of the audio before
+        /// fingerprinting, as learned from the quiet between tracks. The sessions of a deck, as named by
+        /// <see cref="SessionOptions.DeckIdentifier" />, share what they learn; a session without one learns alone.
+        /// Off by default, as it changes what ACRCloud is sent; the gating is done with the fingerprinting.
+        /// </summary>
+        property bool IsNoiseReductionEnabled
+        {
+            bool get();
+            void set(bool value);
+        }
+
+        /// <summary>
+        /// Gets or sets a value indicating whether every deck shares the hiss learned, for decks known to
+        /// sound alike. Off by default, so a hissy deck doesn't gate the music out of the clean ones.
+        /// </summary>
+        property bool IsNoiseProfileShared
+        {
+            bool get();
+            void set(bool value);
+        }
+
+        /// <summary>
+        /// Gets or sets a value indicating whether the sessions Rice code the audio they keep, which
+        /// takes a fifth less memory for a little more work.
+        /// </summary>
+        property bool IsAudioCompressionEnabled
+        {
+            bool get();
+            void set(bool value);
+        }
+
+        /// <summary>
+        /// Gets a snapshot of the counters and stage latencies of all the sessions created.
+        /// </summary>
+        property CrazyGiraffe::AudioIdentification::PipelineMetrics^ Metrics
+        {
+            CrazyGiraffe::AudioIdentification::PipelineMetrics^ get();
+        }
+
+        /// <summary>
+        /// Gets or sets a value indicating whether the recognition stages of all sessions are traced.
+        /// </summary>
+        static property bool IsTracingEnabled
+        {
+            bool get();
+            void set(bool value);
+        }
+
+        /// <summary>
+        /// Get the latest traced stages of every thread as Chrome trace-event JSON, for chrome://tracing or Perfetto.
+        /// </summary>
+        /// <returns>The trace.</returns>
+        static Platform::String^ ExportTrace();
+
+        /// <summary>
+        /// Open the on-disk cache in the local folder, read-only if another process is writing it.
+        /// </summary>
+        /// <returns>The cache, or null if it can't be opened.</returns>
+        static CrazyGiraffe::AudioIdentification::PersistentTrackCache^ OpenPersistentCache();
+
         /// <summary>
         /// Create a new session to identify a track.
         /// </summary>
@@ -37,6 +147,13 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
         virtual Windows::Foundation::IAsyncOperation<CrazyGiraffe::AudioIdentification::ISession^>^
             CreateSessionAsync(CrazyGiraffe::AudioIdentification::SessionOptions^ options);
 
+    private:
+        ///
+        /// Get the noise profile of a session: shared by its deck at its sample rate, or by every deck if
+        /// sharing is on, or its own. Null if noise reduction is off.
+        ///
+        std::shared_ptr<CrazyGiraffe::Core::NoiseProfile> GetNoiseProfile(CrazyGiraffe::AudioIdentification::SessionOptions^ options);
+
     private:
         /// <summary>
         /// Client data for the factory.
@@ -52,5 +169,49 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace ACRCloud
         /// An Http filter. Used for unit testing.
         ///
         Windows::Web::Http::Filters::IHttpFilter^ m_httpFilter;
+
+        ///
+        /// The result cache shared by the sessions.
+        ///
+        CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudResultCache^ m_resultCache;
+
+        ///
+        /// The on-disk cache shared by the sessions.
+        ///
+        CrazyGiraffe::AudioIdentification::PersistentTrackCache^ m_persistentCache;
+
+        ///
+        /// The retry policy shared by the sessions.
+        ///
+        CrazyGiraffe::AudioIdentification::ACRCloud::ACRCloudRetryPolicy^ m_retryPolicy;
+
+        ///
+        /// Whether the sessions correct the speed of the tape.
+        ///
+        bool m_correctSpeed;
+
+        ///
+        /// Whether the sessions gate out the hiss, whether every deck shares it, and the hiss learned by
+        /// each deck at each rate, so a session starts with what the ones before it on the deck heard.
+        ///
+        bool m_reduceNoise;
+        bool m_shareNoiseProfile;
+        std::map<std::pair<std::wstring, uint32>, std::shared_ptr<CrazyGiraffe::Core::NoiseProfile>> m_noiseProfiles;
+        std::mutex m_noiseProfileLock;
+
+        ///
+        /// Whether the sessions compress the audio they keep.
+        ///
+        bool m_compressAudio;
+
+        ///
+        /// Shares the fingerprinting pool and the query rate between the sessions.
+        ///
+        std::shared_ptr<CrazyGiraffe::Core::SessionScheduler> m_scheduler;
+
+        ///
+        /// The metrics of all the sessions created.
+        ///
+        std::shared_ptr<CrazyGiraffe::Common::MetricsRegistry> m_metrics;
     };
 } } }
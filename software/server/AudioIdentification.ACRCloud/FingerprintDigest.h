@@ -0,0 +1,100 @@
+//-----------------------------------------------------------------------
+// <copyright file="FingerprintDigest.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// A locality-sensitive digest (SimHash) of an ACRCloud fingerprint.
+//
+// The fingerprint is opaque to us, but two fingerprints of the same audio
+// share most of their bytes. Every 4-byte shingle is hashed and votes on
+// each of the 64 digest bits, so similar fingerprints produce digests with
+// a small Hamming distance and identical fingerprints produce identical digests.
+//
+namespace FingerprintDigest
+{
+    // Number of bits per band used to index digests, see BandKey().
+    const unsigned int BandBits = 16;
+
+    // Number of bands in a digest.
+    const unsigned int BandCount = 64 / BandBits;
+
+    // Size of the shingle hashed into the digest.
+    const size_t ShingleSize = 4;
+
+    // FNV-1a, 64 bits.
+    inline uint64_t Fnv1a(const uint8_t* data, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= data[i];
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    // Compute the digest for a fingerprint.
+    inline uint64_t Compute(const uint8_t* data, size_t size)
+    {
+        if (data == nullptr || size == 0)
+        {
+            return 0;
+        }
+
+        if (size < ShingleSize)
+        {
+            return Fnv1a(data, size);
+        }
+
+        int votes[64] = { 0 };
+        for (size_t i = 0; i + ShingleSize <= size; i++)
+        {
+            uint64_t hash = Fnv1a(data + i, ShingleSize);
+            for (unsigned int bit = 0; bit < 64; bit++)
+            {
+                votes[bit] += ((hash >> bit) & 1) ? 1 : -1;
+            }
+        }
+
+        uint64_t digest = 0;
+        for (unsigned int bit = 0; bit < 64; bit++)
+        {
+            if (votes[bit] > 0)
+            {
+                digest |= (1ULL << bit);
+            }
+        }
+
+        return digest;
+    }
+
+    // Number of differing bits between two digests.
+    inline unsigned int Distance(uint64_t left, uint64_t right)
+    {
+        uint64_t value = left ^ right;
+        unsigned int count = 0;
+        while (value != 0)
+        {
+            value &= value - 1;
+            count++;
+        }
+
+        return count;
+    }
+
+    // Key for one band of a digest. Two digests within (BandCount - 1) bits
+    // of each other are guaranteed to share at least one band key.
+    inline uint32_t BandKey(uint64_t digest, unsigned int band)
+    {
+        uint32_t value = static_cast<uint32_t>((digest >> (band * BandBits)) & ((1ULL << BandBits) - 1));
+        return (band << BandBits) | value;
+    }
+}
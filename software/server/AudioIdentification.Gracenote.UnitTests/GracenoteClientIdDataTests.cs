@@ -6,6 +6,7 @@
 //-----------------------------------------------------------------------
 namespace CrazyGiraffe.AudioIdentification.Gracenote.UnitTests
 {
+    using System;
     using CrazyGiraffe.AudioIdentification.Gracenote;
     using Microsoft.VisualStudio.TestTools.UnitTesting;
 
@@ -38,6 +39,25 @@ namespace CrazyGiraffe.AudioIdentification.Gracenote.UnitTests
             Assert.AreEqual(clientTag, cientIdData.ClientTag, "ClientTag");
             Assert.AreEqual(appVersion, cientIdData.AppVersion, "AppVersion");
             Assert.AreEqual(license, cientIdData.License, "License");
+            Assert.AreEqual(GracenoteLookupMode.Online, cientIdData.LookupMode, "LookupMode");
+            Assert.AreEqual(TimeSpan.Zero, cientIdData.CacheExpiration, "CacheExpiration");
+        }
+
+        /// <summary>
+        /// Test the ability to set the lookup mode and cache expiration of an <see cref="GracenoteClientIdData"/>.
+        /// </summary>
+        [TestMethod]
+        public void GracenoteClientIdDataLookupMode()
+        {
+            GracenoteClientIdData cientIdData = new GracenoteClientIdData()
+            {
+                LookupMode = GracenoteLookupMode.Hybrid,
+                CacheExpiration = TimeSpan.FromDays(7),
+            };
+
+            Assert.AreEqual(GracenoteLookupMode.Hybrid, cientIdData.LookupMode, "LookupMode");
+            Assert.AreEqual(TimeSpan.FromDays(7), cientIdData.CacheExpiration, "CacheExpiration");
+            Assert.ThrowsException<ArgumentException>(() => cientIdData.CacheExpiration = TimeSpan.FromSeconds(-1), "CacheExpiration");
         }
     }
 }
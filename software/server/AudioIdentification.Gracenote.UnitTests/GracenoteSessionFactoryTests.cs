@@ -51,5 +51,77 @@ namespace CrazyGiraffe.AudioIdentification.Gracenote.UnitTests
             ISession session = await factory.CreateSessionAsync(options);
             Assert.IsNotNull(session, "session");
         }
+
+        /// <summary>
+        /// Test the ability to initialize ahead of the first session with <see cref="GracenoteSessionFactory.InitializeAsync"/>.
+        /// </summary>
+        /// <returns>A task which can be awaited.</returns>
+        [TestMethod]
+        public async Task GracenoteSessionFactoryInitialize()
+        {
+            string licenseFileName = "License.txt";
+            string licenseData = ResourceHelper.ReadResourceAsString(licenseFileName);
+
+            string clientIdFileName = "GracenoteClientId.xml";
+            XmlDocument doc = ResourceHelper.ReadResourceAsXml(clientIdFileName);
+
+            GracenoteClientIdData clientIdData = new GracenoteClientIdData()
+            {
+                ClientId = doc.SelectSingleNode("//ClientId")?.InnerText,
+                ClientTag = doc.SelectSingleNode("//ClientTag")?.InnerText,
+                AppVersion = doc.SelectSingleNode("//AppVersion")?.InnerText,
+                License = licenseData,
+            };
+
+            GracenoteSessionFactory factory = new GracenoteSessionFactory(clientIdData);
+            Assert.IsNotNull(factory, "factory");
+
+            GracenoteInitializationTimings timings = await factory.InitializeAsync();
+            Assert.IsNotNull(timings, "timings");
+            Assert.IsTrue(timings.Total >= timings.Manager, "Total");
+
+            // Initialized once; later calls return the same timings.
+            GracenoteInitializationTimings again = await factory.InitializeAsync();
+            Assert.AreSame(timings, again, "again");
+
+            ISession session = await factory.CreateSessionAsync(new SessionOptions(44100, 16, 2));
+            Assert.IsNotNull(session, "session");
+        }
+
+        /// <summary>
+        /// Test the ability to create channels ahead of the sessions with <see cref="GracenoteSessionFactory.PrewarmAsync"/>.
+        /// </summary>
+        /// <returns>A task which can be awaited.</returns>
+        [TestMethod]
+        public async Task GracenoteSessionFactoryPrewarm()
+        {
+            string licenseFileName = "License.txt";
+            string licenseData = ResourceHelper.ReadResourceAsString(licenseFileName);
+
+            string clientIdFileName = "GracenoteClientId.xml";
+            XmlDocument doc = ResourceHelper.ReadResourceAsXml(clientIdFileName);
+
+            GracenoteClientIdData clientIdData = new GracenoteClientIdData()
+            {
+                ClientId = doc.SelectSingleNode("//ClientId")?.InnerText,
+                ClientTag = doc.SelectSingleNode("//ClientTag")?.InnerText,
+                AppVersion = doc.SelectSingleNode("//AppVersion")?.InnerText,
+                License = licenseData,
+            };
+
+            GracenoteSessionFactory factory = new GracenoteSessionFactory(clientIdData);
+            Assert.IsNotNull(factory, "factory");
+
+            SessionOptions options = new SessionOptions(44100, 16, 2);
+            uint idleChannels = await factory.PrewarmAsync(options, 2);
+            Assert.AreEqual(2u, idleChannels, "idleChannels");
+
+            // A prewarmed channel is already identifying, so the first sample starts the session.
+            ISession session = await factory.CreateSessionAsync(options);
+            Assert.IsNotNull(session, "session");
+
+            session.AddAudioSample(new byte[1764]);
+            Assert.AreEqual(IdentifyStatus.Incomplete, session.IdentificationStatus, "IdentificationStatus");
+        }
     }
 }
@@ -44,6 +44,39 @@ namespace CrazyGiraffe.AudioIdentification.Gracenote.UnitTests
             session.AddAudioSample(null);
         }
 
+        /// <summary>
+        /// Test that GetTracksAsync returns no tracks before a result is published.
+        /// </summary>
+        /// <returns>A task that can be awaited.</returns>
+        [TestMethod]
+        public async Task GetTracksAsyncNoResult()
+        {
+            ISession session = await CreateSessionAsync().ConfigureAwait(true);
+            Assert.IsNotNull(session, "session");
+
+            var tracks = await session.GetTracksAsync();
+            Assert.IsNotNull(tracks, "tracks");
+            Assert.AreEqual(0, tracks.Count, "tracks.Count");
+        }
+
+        /// <summary>
+        /// Test that AddAudioSample drops a sample which doesn't fit in the write queue rather than wait.
+        /// </summary>
+        /// <returns>A task that can be awaited.</returns>
+        [TestMethod]
+        public async Task AddAudioSampleOverflowDropsFrames()
+        {
+            GracenoteSession session = await CreateSessionAsync(
+                factory => factory.WriteQueueDuration = TimeSpan.FromMilliseconds(100)).ConfigureAwait(true) as GracenoteSession;
+            Assert.IsNotNull(session, "session");
+            Assert.AreEqual(0ul, session.DroppedFrames, "DroppedFrames");
+
+            // One second of 16-bit stereo audio is more than the queue holds.
+            session.AddAudioSample(new byte[176400]);
+            Assert.AreEqual(IdentifyStatus.Incomplete, session.IdentificationStatus, "IdentificationStatus");
+            Assert.AreEqual(44100ul, session.DroppedFrames, "DroppedFrames");
+        }
+
         /// <summary>
         /// Get the session options.
         /// </summary>
@@ -62,8 +95,9 @@ namespace CrazyGiraffe.AudioIdentification.Gracenote.UnitTests
         /// <summary>
         /// Create a new session using the default options.
         /// </summary>
+        /// <param name="configure">Configures the factory, if not null.</param>
         /// <returns>ISession.</returns>
-        private static async Task<ISession> CreateSessionAsync()
+        private static async Task<ISession> CreateSessionAsync(Action<GracenoteSessionFactory> configure = null)
         {
             string licenseFileName = "License.txt";
             Logger.LogMessage(string.Concat("Processing license file: ", licenseFileName, "..."));
@@ -84,8 +118,9 @@ namespace CrazyGiraffe.AudioIdentification.Gracenote.UnitTests
             Assert.AreEqual("1965581575", clientIdData.ClientId, "clientIdData.ClientId");
             Assert.AreEqual("981037DD61C65554E5C1547086EC1376", clientIdData.ClientTag, "clientIdData.ClientTag");
 
-            ISessionFactory factory = new GracenoteSessionFactory(clientIdData);
+            GracenoteSessionFactory factory = new GracenoteSessionFactory(clientIdData);
             Assert.IsNotNull(factory, "factory");
+            configure?.Invoke(factory);
 
             SessionOptions options = GetSessionOptions();
             Assert.IsNotNull(options, "options");
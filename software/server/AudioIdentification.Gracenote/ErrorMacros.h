@@ -6,17 +6,7 @@
 //-----------------------------------------------------------------------
 #pragma once
 
-// Log a message.
-inline void LogMessage(char* format, ...)
-{
-    static char s_acBuf[2048];
-
-    va_list args;
-    va_start(args, format);
-    vsprintf_s(s_acBuf, format, args);
-    OutputDebugStringA(s_acBuf);
-    va_end(args);
-}
+#include "Logger.h"
 
 inline void TraceLastErrnoError(int line_num)
 {
@@ -26,8 +16,8 @@ inline void TraceLastErrnoError(int line_num)
 
     // Error_info will never be GNSDK_NULL.
     // The SDK will always return a pointer to a populated error info structure.
-    LogMessage(
-        "\nerror [on line %d]\n\t0x%08x\n",
+    LOG_ERROR(
+        "error [on line %d] 0x%08x",
         line_num,
         _errno);
 }
@@ -57,8 +47,8 @@ inline void TraceLastGracenoteError(int line_num)
 
     // Error_info will never be GNSDK_NULL.
     // The SDK will always return a pointer to a populated error info structure.
-    LogMessage(
-        "\nerror from: %s()  [on line %d]\n\t0x%08x %s\n",
+    LOG_ERROR(
+        "error from: %s()  [on line %d] 0x%08x %s",
         error_info->error_api,
         line_num,
         error_info->error_code,
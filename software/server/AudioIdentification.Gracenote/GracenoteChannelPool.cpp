@@ -0,0 +1,223 @@
+//-----------------------------------------------------------------------
+// <copyright file="GracenoteChannelPool.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "GracenoteChannelPool.h"
+#include "GracenoteSession.h"
+#include "ErrorMacros.h"
+#include <algorithm>
+
+using namespace concurrency;
+using namespace Platform;
+using namespace CrazyGiraffe::AudioIdentification::Gracenote;
+
+namespace
+{
+    // How long a returned channel may take to finish identifying the previous session's audio.
+    const gnsdk_uint32_t ResetTimeoutMilliseconds = 5000;
+}
+
+GracenoteChannel::GracenoteChannel(const ChannelFormat& format)
+    : m_format(format)
+    , m_channel_handle(nullptr)
+    , m_session()
+    , m_lock()
+{
+}
+
+gnsdk_musicidstream_channel_handle_t GracenoteChannel::Handle() const
+{
+    return m_channel_handle.get();
+}
+
+const ChannelFormat& GracenoteChannel::Format() const
+{
+    return m_format;
+}
+
+void GracenoteChannel::Attach(GracenoteSession^ session)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_session = WeakReference(session);
+}
+
+void GracenoteChannel::Detach()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_session = WeakReference();
+}
+
+GracenoteSession^ GracenoteChannel::ResolveSession()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_session.Resolve<GracenoteSession>();
+}
+
+GracenoteChannelPool::GracenoteChannelPool(
+    user_handle_shared_ptr user_handle,
+    const gnsdk_musicidstream_callbacks_t& callbacks,
+    size_t maximumIdleChannels)
+    : m_user_handle(user_handle)
+    , m_callbacks(callbacks)
+    , m_maximumIdleChannels(maximumIdleChannels)
+    , m_idle()
+    , m_lock()
+{
+}
+
+std::shared_ptr<GracenoteChannel> GracenoteChannelPool::Lease(const ChannelFormat& format)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        std::vector<std::shared_ptr<GracenoteChannel>>& idle = m_idle[format];
+        if (!idle.empty())
+        {
+            std::shared_ptr<GracenoteChannel> channel = idle.back();
+            idle.pop_back();
+            return channel;
+        }
+    }
+
+    // Pool is cold for this format.
+    LOG_DEBUG("%s: no idle channel, creating one", __FUNCTION__);
+    return Create(format);
+}
+
+void GracenoteChannelPool::Return(std::shared_ptr<GracenoteChannel> channel)
+{
+    if (channel == nullptr)
+    {
+        return;
+    }
+
+    // Results for the previous session must not reach the next one.
+    channel->Detach();
+
+    // Reset off the caller's thread; audio_end may wait on the identification in progress.
+    std::shared_ptr<GracenoteChannelPool> pool = shared_from_this();
+    create_task([pool, channel]
+        {
+            if (pool->Reset(*channel))
+            {
+                pool->AddIdle(channel);
+            }
+        }, task_continuation_context::use_arbitrary());
+}
+
+size_t GracenoteChannelPool::Prewarm(const ChannelFormat& format, size_t count)
+{
+    count = (std::min)(count, m_maximumIdleChannels);
+    while (IdleCount(format) < count)
+    {
+        std::shared_ptr<GracenoteChannel> channel = Create(format);
+        if (channel == nullptr)
+        {
+            break;
+        }
+
+        AddIdle(channel);
+    }
+
+    return IdleCount(format);
+}
+
+size_t GracenoteChannelPool::IdleCount(const ChannelFormat& format)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto it = m_idle.find(format);
+    return (it != m_idle.end()) ? it->second.size() : 0;
+}
+
+std::shared_ptr<GracenoteChannel> GracenoteChannelPool::Create(const ChannelFormat& format)
+{
+    std::shared_ptr<GracenoteChannel> channel = std::make_shared<GracenoteChannel>(format);
+    gnsdk_musicidstream_channel_handle_t channel_handle = GNSDK_NULL;
+    gnsdk_error_t error = GNSDK_SUCCESS;
+
+    // The channel is the callback data; it lives as long as the handle.
+    error = gnsdk_musicidstream_channel_create(
+        m_user_handle.get(),
+        gnsdk_musicidstream_preset_radio,
+        &m_callbacks,
+        reinterpret_cast<gnsdk_void_t*>(channel.get()),
+        &channel_handle);
+    GNSDK_CHECK(error);
+
+    channel->m_channel_handle = make_channel_handle_unique_ptr(channel_handle);
+
+    // Set options.
+    error = gnsdk_musicidstream_channel_option_set(
+        channel_handle,
+        GNSDK_MUSICIDSTREAM_OPTION_ENABLE_CONTENT_DATA,
+        GNSDK_VALUE_TRUE);
+    GNSDK_LOG(error);
+
+    error = gnsdk_musicidstream_channel_option_set(
+        channel_handle,
+        GNSDK_MUSICIDSTREAM_OPTION_RESULT_PREFER_COVERART,
+        GNSDK_VALUE_TRUE);
+    GNSDK_LOG(error);
+
+    error = Begin(*channel);
+    GNSDK_CHECK(error);
+
+error:
+    return (error == GNSDK_SUCCESS) ? channel : nullptr;
+}
+
+bool GracenoteChannelPool::Reset(GracenoteChannel& channel)
+{
+    gnsdk_bool_t completed = GNSDK_FALSE;
+    gnsdk_error_t error = GNSDK_SUCCESS;
+    bool ready = false;
+
+    // End the previous audio, if the session didn't, and let its identification finish.
+    GNSDK_LOG(gnsdk_musicidstream_channel_audio_end(channel.Handle()));
+
+    error = gnsdk_musicidstream_channel_wait_for_identify(channel.Handle(), ResetTimeoutMilliseconds, &completed);
+    GNSDK_CHECK(error);
+
+    if (!completed)
+    {
+        LOG_WARNING("%s: identify did not finish, dropping channel", __FUNCTION__);
+        goto error;
+    }
+
+    error = Begin(channel);
+    GNSDK_CHECK(error);
+
+    ready = true;
+error:
+    return ready;
+}
+
+gnsdk_error_t GracenoteChannelPool::Begin(GracenoteChannel& channel)
+{
+    gnsdk_error_t error = GNSDK_SUCCESS;
+
+    error = gnsdk_musicidstream_channel_audio_begin(
+        channel.Handle(),
+        std::get<0>(channel.Format()),
+        std::get<1>(channel.Format()),
+        std::get<2>(channel.Format()));
+    GNSDK_CHECK(error);
+
+    error = gnsdk_musicidstream_channel_identify(channel.Handle());
+    GNSDK_CHECK(error);
+
+error:
+    return error;
+}
+
+void GracenoteChannelPool::AddIdle(std::shared_ptr<GracenoteChannel> channel)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    std::vector<std::shared_ptr<GracenoteChannel>>& idle = m_idle[channel->Format()];
+    if (idle.size() < m_maximumIdleChannels)
+    {
+        idle.push_back(channel);
+    }
+}
@@ -0,0 +1,161 @@
+//-----------------------------------------------------------------------
+// <copyright file="GracenoteChannelPool.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "SmartPointers.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
+{
+    ref class GracenoteSession;
+
+    ///
+    /// The audio format of a channel: sample rate, sample size and channel count.
+    ///
+    typedef std::tuple<unsigned int, unsigned int, unsigned int> ChannelFormat;
+
+    ///
+    /// A musicid-stream channel which is begun and identifying, reused by one session at a time.
+    /// The channel is the callback data for GNSDK, so callbacks find the session it is leased to.
+    ///
+    class GracenoteChannel
+    {
+    public:
+        GracenoteChannel(const ChannelFormat& format);
+
+        ///
+        /// Get the channel handle.
+        ///
+        gnsdk_musicidstream_channel_handle_t Handle() const;
+
+        ///
+        /// Get the audio format of the channel.
+        ///
+        const ChannelFormat& Format() const;
+
+        ///
+        /// Send the callbacks to a session.
+        ///
+        void Attach(GracenoteSession^ session);
+
+        ///
+        /// Stop sending the callbacks to the session.
+        ///
+        void Detach();
+
+        ///
+        /// Get the session the channel is leased to, or null.
+        ///
+        GracenoteSession^ ResolveSession();
+
+    private:
+        friend class GracenoteChannelPool;
+
+        ///
+        /// The audio format.
+        ///
+        ChannelFormat m_format;
+
+        ///
+        /// The channel handle.
+        ///
+        channel_handle_unique_ptr m_channel_handle;
+
+        ///
+        /// The session the channel is leased to.
+        ///
+        Platform::WeakReference m_session;
+
+        ///
+        /// Lock for the session.
+        ///
+        std::mutex m_lock;
+    };
+
+    ///
+    /// Pool of channels, by audio format, shared by the sessions of a factory.
+    ///
+    class GracenoteChannelPool : public std::enable_shared_from_this<GracenoteChannelPool>
+    {
+    public:
+        GracenoteChannelPool(
+            user_handle_shared_ptr user_handle,
+            const gnsdk_musicidstream_callbacks_t& callbacks,
+            size_t maximumIdleChannels);
+
+        ///
+        /// Take an idle channel for the format, or create one. Returns null on failure.
+        ///
+        std::shared_ptr<GracenoteChannel> Lease(const ChannelFormat& format);
+
+        ///
+        /// Give a channel back. It is reset in the background and kept if there is room.
+        ///
+        void Return(std::shared_ptr<GracenoteChannel> channel);
+
+        ///
+        /// Create idle channels for the format, up to count. Returns the number of idle channels.
+        ///
+        size_t Prewarm(const ChannelFormat& format, size_t count);
+
+        ///
+        /// Get the number of idle channels for the format.
+        ///
+        size_t IdleCount(const ChannelFormat& format);
+
+    private:
+        ///
+        /// Create a channel and begin identifying.
+        ///
+        std::shared_ptr<GracenoteChannel> Create(const ChannelFormat& format);
+
+        ///
+        /// End the audio of a used channel and begin identifying again. Returns false if it can't be reused.
+        ///
+        bool Reset(GracenoteChannel& channel);
+
+        ///
+        /// Begin the audio and identifying on a channel.
+        ///
+        gnsdk_error_t Begin(GracenoteChannel& channel);
+
+        ///
+        /// Keep a channel if there is room.
+        ///
+        void AddIdle(std::shared_ptr<GracenoteChannel> channel);
+
+    private:
+        ///
+        /// The user handle the channels are created for.
+        ///
+        user_handle_shared_ptr m_user_handle;
+
+        ///
+        /// The session callbacks.
+        ///
+        gnsdk_musicidstream_callbacks_t m_callbacks;
+
+        ///
+        /// The most idle channels kept per format.
+        ///
+        size_t m_maximumIdleChannels;
+
+        ///
+        /// The idle channels, by format.
+        ///
+        std::map<ChannelFormat, std::vector<std::shared_ptr<GracenoteChannel>>> m_idle;
+
+        ///
+        /// Lock for the idle channels.
+        ///
+        std::mutex m_lock;
+    };
+} } }
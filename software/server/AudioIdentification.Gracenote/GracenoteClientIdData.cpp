@@ -8,6 +8,7 @@
 #include "GracenoteClientIdData.h"
 
 using namespace Platform;
+using namespace Windows::Foundation;
 using namespace CrazyGiraffe::AudioIdentification::Gracenote;
 
 GracenoteClientIdData::GracenoteClientIdData()
@@ -15,6 +16,8 @@ GracenoteClientIdData::GracenoteClientIdData()
     , m_clientTag(L"")
     , m_appVersion(L"")
     , m_license(L"")
+    , m_lookupMode(GracenoteLookupMode::Online)
+    , m_cacheExpiration()
 {
 }
 
@@ -57,3 +60,28 @@ void GracenoteClientIdData::License::set(String^ value)
 {
     m_license = value;
 }
+
+GracenoteLookupMode GracenoteClientIdData::LookupMode::get()
+{
+    return m_lookupMode;
+}
+
+void GracenoteClientIdData::LookupMode::set(GracenoteLookupMode value)
+{
+    m_lookupMode = value;
+}
+
+TimeSpan GracenoteClientIdData::CacheExpiration::get()
+{
+    return m_cacheExpiration;
+}
+
+void GracenoteClientIdData::CacheExpiration::set(TimeSpan value)
+{
+    if (value.Duration < 0)
+    {
+        throw ref new InvalidArgumentException("value");
+    }
+
+    m_cacheExpiration = value;
+}
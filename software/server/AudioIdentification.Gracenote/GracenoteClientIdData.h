@@ -8,6 +8,27 @@
 
 namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
 {
+    /// <summary>
+    /// Where tracks are looked up.
+    /// </summary>
+    public enum class GracenoteLookupMode
+    {
+        /// <summary>
+        /// Look up online only.
+        /// </summary>
+        Online = 0,
+
+        /// <summary>
+        /// Look up in the local database only; works without a connection.
+        /// </summary>
+        Local = 1,
+
+        /// <summary>
+        /// Look up in the local database first and online if it has no match.
+        /// </summary>
+        Hybrid = 2,
+    };
+
     /// <summary>
     /// Class for reading clientId.json. See https://developer.gracenote.com/web-api, Getting Started.
     /// </summary>
@@ -55,6 +76,24 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
             void set(Platform::String^ value);
         }
 
+        /// <summary>
+        /// Where tracks are looked up. The local database is in the gndb folder of the app's local folder.
+        /// </summary>
+        property GracenoteLookupMode LookupMode
+        {
+            GracenoteLookupMode get();
+            void set(GracenoteLookupMode value);
+        }
+
+        /// <summary>
+        /// How long online results are kept in the lookup cache. Zero keeps the GNSDK default.
+        /// </summary>
+        property Windows::Foundation::TimeSpan CacheExpiration
+        {
+            Windows::Foundation::TimeSpan get();
+            void set(Windows::Foundation::TimeSpan value);
+        }
+
     private:
         /// <summary>
         /// The client id.
@@ -75,5 +114,15 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
         /// The client license.
         /// </summary>
         Platform::String^ m_license;
+
+        /// <summary>
+        /// Where tracks are looked up.
+        /// </summary>
+        GracenoteLookupMode m_lookupMode;
+
+        /// <summary>
+        /// How long online results are kept in the lookup cache.
+        /// </summary>
+        Windows::Foundation::TimeSpan m_cacheExpiration;
     };
 } } }
@@ -0,0 +1,67 @@
+//-----------------------------------------------------------------------
+// <copyright file="GracenoteInitializationTimings.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "GracenoteInitializationTimings.h"
+
+using namespace Windows::Foundation;
+using namespace CrazyGiraffe::AudioIdentification::Gracenote;
+
+namespace
+{
+    // TimeSpan is expressed in 100-nanosecond units.
+    TimeSpan ToTimeSpan(std::chrono::steady_clock::duration duration)
+    {
+        TimeSpan timeSpan = { 0 };
+        timeSpan.Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / 100;
+        return timeSpan;
+    }
+}
+
+GracenoteInitializationTimings::GracenoteInitializationTimings(const GracenoteInitializationPhases& phases)
+    : m_phases(phases)
+{
+}
+
+TimeSpan GracenoteInitializationTimings::Storage::get()
+{
+    return ToTimeSpan(m_phases.storage);
+}
+
+TimeSpan GracenoteInitializationTimings::Manager::get()
+{
+    return ToTimeSpan(m_phases.manager);
+}
+
+TimeSpan GracenoteInitializationTimings::Libraries::get()
+{
+    return ToTimeSpan(m_phases.libraries);
+}
+
+TimeSpan GracenoteInitializationTimings::User::get()
+{
+    return ToTimeSpan(m_phases.user);
+}
+
+TimeSpan GracenoteInitializationTimings::Locale::get()
+{
+    return ToTimeSpan(m_phases.locale);
+}
+
+TimeSpan GracenoteInitializationTimings::Total::get()
+{
+    return ToTimeSpan(m_phases.total);
+}
+
+bool GracenoteInitializationTimings::IsUserCached::get()
+{
+    return m_phases.userCached;
+}
+
+bool GracenoteInitializationTimings::IsLocaleCached::get()
+{
+    return m_phases.localeCached;
+}
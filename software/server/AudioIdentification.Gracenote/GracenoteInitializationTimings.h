@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------
+// <copyright file="GracenoteInitializationTimings.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <chrono>
+
+namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
+{
+    ///
+    /// The time spent in each phase of initializing GNSDK.
+    ///
+    struct GracenoteInitializationPhases
+    {
+        std::chrono::steady_clock::duration storage;
+        std::chrono::steady_clock::duration manager;
+        std::chrono::steady_clock::duration libraries;
+        std::chrono::steady_clock::duration user;
+        std::chrono::steady_clock::duration locale;
+        std::chrono::steady_clock::duration total;
+        bool userCached;
+        bool localeCached;
+    };
+
+    /// <summary>
+    /// The time spent in each phase of initializing GNSDK.
+    /// The libraries and the user are set up in parallel, so the phases may add up to more than the total.
+    /// </summary>
+    public ref class GracenoteInitializationTimings sealed
+    {
+    public:
+        /// <summary>
+        /// Gets the time spent finding or creating the storage folder.
+        /// </summary>
+        property Windows::Foundation::TimeSpan Storage
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets the time spent initializing the manager and logging.
+        /// </summary>
+        property Windows::Foundation::TimeSpan Manager
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets the time spent initializing the storage, lookup, DSP and stream libraries.
+        /// </summary>
+        property Windows::Foundation::TimeSpan Libraries
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets the time spent loading or registering the user.
+        /// </summary>
+        property Windows::Foundation::TimeSpan User
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets the time spent loading the locale.
+        /// </summary>
+        property Windows::Foundation::TimeSpan Locale
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets the time spent initializing, from start to finish.
+        /// </summary>
+        property Windows::Foundation::TimeSpan Total
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets a value indicating whether the user came from the cache rather than registration.
+        /// </summary>
+        property bool IsUserCached
+        {
+            bool get();
+        }
+
+        /// <summary>
+        /// Gets a value indicating whether the locale came from the cache rather than a download.
+        /// </summary>
+        property bool IsLocaleCached
+        {
+            bool get();
+        }
+
+    internal:
+        /// <summary>
+        /// Create an instance of the <see cref="GracenoteInitializationTimings" /> class.
+        /// </summary>
+        /// <param name="phases">the measured phases.</param>
+        GracenoteInitializationTimings(const GracenoteInitializationPhases& phases);
+
+    private:
+        ///
+        /// The measured phases.
+        ///
+        GracenoteInitializationPhases m_phases;
+    };
+} } }
@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------
+// <copyright file="GracenoteLookupStatistics.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "GracenoteLookupStatistics.h"
+
+using namespace CrazyGiraffe::AudioIdentification::Gracenote;
+
+GracenoteLookupStatistics::GracenoteLookupStatistics()
+    : m_lookups(0)
+    , m_localLookups(0)
+    , m_localHits(0)
+    , m_onlineLookups(0)
+    , m_onlineHits(0)
+    , m_latencyTicks(0)
+{
+}
+
+void GracenoteLookupStatistics::RecordLookup(bool local, bool online, bool found, std::chrono::steady_clock::duration latency)
+{
+    m_lookups++;
+    m_latencyTicks += latency.count();
+
+    if (local)
+    {
+        m_localLookups++;
+        if (found && !online)
+        {
+            m_localHits++;
+        }
+    }
+
+    if (online)
+    {
+        m_onlineLookups++;
+        if (found)
+        {
+            m_onlineHits++;
+        }
+    }
+}
+
+uint64 GracenoteLookupStatistics::LookupCount() const
+{
+    return m_lookups;
+}
+
+uint64 GracenoteLookupStatistics::LocalLookupCount() const
+{
+    return m_localLookups;
+}
+
+uint64 GracenoteLookupStatistics::LocalHitCount() const
+{
+    return m_localHits;
+}
+
+uint64 GracenoteLookupStatistics::OnlineLookupCount() const
+{
+    return m_onlineLookups;
+}
+
+uint64 GracenoteLookupStatistics::OnlineHitCount() const
+{
+    return m_onlineHits;
+}
+
+std::chrono::steady_clock::duration GracenoteLookupStatistics::TotalLatency() const
+{
+    return std::chrono::steady_clock::duration(m_latencyTicks.load());
+}
@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------
+// <copyright file="GracenoteLookupStatistics.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
+{
+    ///
+    /// Counters for the lookups of the sessions of a factory; safe to record from any thread.
+    ///
+    class GracenoteLookupStatistics
+    {
+    public:
+        GracenoteLookupStatistics();
+
+        ///
+        /// Count a lookup of a session: where it went and how long it took to a result.
+        ///
+        void RecordLookup(bool local, bool online, bool found, std::chrono::steady_clock::duration latency);
+
+        ///
+        /// Get the number of lookups.
+        ///
+        uint64 LookupCount() const;
+
+        ///
+        /// Get the number of lookups which tried the local database.
+        ///
+        uint64 LocalLookupCount() const;
+
+        ///
+        /// Get the number of lookups the local database matched without going online.
+        ///
+        uint64 LocalHitCount() const;
+
+        ///
+        /// Get the number of lookups which went online.
+        ///
+        uint64 OnlineLookupCount() const;
+
+        ///
+        /// Get the number of lookups matched online.
+        ///
+        uint64 OnlineHitCount() const;
+
+        ///
+        /// Get the total time of the lookups.
+        ///
+        std::chrono::steady_clock::duration TotalLatency() const;
+
+    private:
+        std::atomic<uint64> m_lookups;
+        std::atomic<uint64> m_localLookups;
+        std::atomic<uint64> m_localHits;
+        std::atomic<uint64> m_onlineLookups;
+        std::atomic<uint64> m_onlineHits;
+
+        ///
+        /// The total time of the lookups, in steady clock ticks.
+        ///
+        std::atomic<int64> m_latencyTicks;
+    };
+} } }
@@ -16,55 +16,192 @@ using namespace Windows::Foundation;
 using namespace Windows::Foundation::Collections;
 using namespace CrazyGiraffe::AudioIdentification;
 using namespace CrazyGiraffe::AudioIdentification::Gracenote;
+using namespace CrazyGiraffe::Common;
 
-// Track data.
-typedef struct __track
+namespace
 {
-    const char* p_album;
-    const char* p_album_coverart_url;
-    const char* p_album_releasedate;
-    const char* p_album_label;
-    const char* p_album_track_count;
-    const char* p_title;
-    const char* p_artist;
-    const char* p_artist_image_url;
-    const char* p_track_number;
-    const char* p_track_duration;
-    const char* p_track_duration_unit;
-    const char* p_match_position;
-    const char* p_match_duration;
-    const char* p_current_position;
-    const char* p_matchConfidence;
-    const char* p_genre1;
-    const char* p_genre2;
-    const char* p_genre3;
-    const char* p_mood1;
-    const char* p_mood2;
-
-    char* p_fingerprint;
-} _track;
+    // The audio the writer collects before a write, in milliseconds.
+    const uint64 WriteBatchMilliseconds = 100;
+
+    // The GDOs a track is read from. A node comes after its parent.
+    enum GdoNode
+    {
+        AlbumNode,
+        AlbumTitleNode,
+        AlbumCoverArtNode,
+        AlbumCoverArtAssetNode,
+        TrackNode,
+        TrackTitleNode,
+        ArtistNode,
+        GdoNodeCount
+    };
+
+    // How a node is reached from its parent.
+    struct GdoNodeMapping
+    {
+        GdoNode parent;
+        gnsdk_cstr_t child_key;
+        bool required;
+    };
+
+    // The album comes from the response; there is only 1 of every other node.
+    const GdoNodeMapping NodeMap[GdoNodeCount] =
+    {
+        { AlbumNode, GNSDK_NULL, true },
+        { AlbumNode, GNSDK_GDO_CHILD_TITLE_OFFICIAL, false },
+        { AlbumNode, GNSDK_GDO_CHILD_CONTENT_IMAGECOVER, false },
+        { AlbumCoverArtNode, GNSDK_GDO_CHILD_ASSET_SIZE_MEDIUM, false },
+        { AlbumNode, GNSDK_GDO_CHILD_TRACK_MATCHED, true },
+        { TrackNode, GNSDK_GDO_CHILD_TITLE_OFFICIAL, false },
+        { AlbumNode, GNSDK_GDO_CHILD_ARTIST, true },
+    };
+
+    // The values a track is filled from.
+    enum TrackField
+    {
+        IdentifierField,
+        TitleField,
+        ArtistField,
+        AlbumField,
+        GenreField,
+        CoverArtField,
+        MatchConfidenceField,
+        DurationField,
+        DurationUnitsField,
+        MatchPositionField,
+        CurrentPositionField,
+        TrackFieldCount
+    };
+
+    // Where a value is read from.
+    struct GdoFieldMapping
+    {
+        GdoNode node;
+        gnsdk_cstr_t value_key;
+        TrackField field;
+    };
+
+    // Every value is optional.
+    const GdoFieldMapping FieldMap[] =
+    {
+        { TrackNode, GNSDK_GDO_VALUE_TUI, IdentifierField },
+        { TrackTitleNode, GNSDK_GDO_VALUE_DISPLAY, TitleField },
+        { ArtistNode, GNSDK_GDO_VALUE_DISPLAY, ArtistField },
+        { AlbumTitleNode, GNSDK_GDO_VALUE_DISPLAY, AlbumField },
+        { TrackNode, GNSDK_GDO_VALUE_GENRE_LEVEL1, GenreField },
+        { AlbumCoverArtAssetNode, GNSDK_GDO_VALUE_ASSET_URL_GNSDK, CoverArtField },
+        { TrackNode, GNSDK_GDO_VALUE_TEXT_MATCH_SCORE, MatchConfidenceField },
+        { TrackNode, GNSDK_GDO_VALUE_DURATION, DurationField },
+        { TrackNode, GNSDK_GDO_VALUE_DURATION_UNITS, DurationUnitsField },
+        { TrackNode, GNSDK_GDO_VALUE_MATCH_POSITION_MS, MatchPositionField },
+        { TrackNode, GNSDK_GDO_VALUE_CURRENT_POSITION_MS, CurrentPositionField },
+    };
+
+    // GDO values are UTF-8; a missing value is null.
+    String^ ToPlatformString(gnsdk_cstr_t value)
+    {
+        if (value == GNSDK_NULL || *value == '\0')
+        {
+            return nullptr;
+        }
+
+        int length = MultiByteToWideChar(CP_UTF8, 0, value, -1, nullptr, 0);
+        if (length <= 1)
+        {
+            return nullptr;
+        }
+
+        std::vector<wchar_t> buffer(length);
+        MultiByteToWideChar(CP_UTF8, 0, value, -1, buffer.data(), length);
+        return ref new String(buffer.data(), static_cast<unsigned int>(length - 1));
+    }
+
+    // A missing value is 0.
+    int32 ToInt32(gnsdk_cstr_t value)
+    {
+        return (value != GNSDK_NULL) ? atoi(value) : 0;
+    }
+}
+
 
 GracenoteSession::GracenoteSession()
     : m_options()
     , m_sessionId(Session::CreateSessionIdentifier())
     , m_status(IdentifyStatus::Invalid)
-    , m_tracks(ref new Vector<IReadOnlyTrack^>())
-    , m_user_handle(make_user_handle_shared_ptr(GNSDK_NULL))
-    , m_channel_handle(make_channel_handle_unique_ptr(GNSDK_NULL))
-    , m_weak_reference(new WeakReference(this))
+    , m_tracks((ref new Vector<IReadOnlyTrack^>())->GetView())
+    , m_tracksLock()
+    , m_lookupStatistics()
+    , m_lookupStart()
+    , m_localQueried(false)
+    , m_onlineQueried(false)
+    , m_lookupRecorded(false)
+    , m_identifyStart()
+    , m_localQueryStart()
+    , m_onlineQueryStart()
+    , m_lookupLock()
+    , m_metrics()
+    , m_fingerprintLatency(nullptr)
+    , m_localQueryLatency(nullptr)
+    , m_onlineQueryLatency(nullptr)
+    , m_identifyLatency(nullptr)
+    , m_parseLatency(nullptr)
+    , m_audioBytes(nullptr)
+    , m_identified(nullptr)
+    , m_errors(nullptr)
+    , m_channelPool()
+    , m_overflowPolicy(GracenoteOverflowPolicy::DropNewest)
+    , m_writeQueueDuration(0)
+    , m_writer()
+    , m_channelLock()
+{
+}
+
+GracenoteSession::~GracenoteSession()
 {
-    // m_weak_reference will leak but provides a good way to make sure
-    // that any callbacks arriving after this object is destroyed
-    // will be safely handled. The weak reference will fail to resolve
-    // the destroyed class and skip the portions of the callback
-    // that would cause an fault.
+    ReleaseChannel();
 }
 
-void GracenoteSession::Initialize(SessionOptions^ options, gnsdk_user_handle_t user_handle)
+void GracenoteSession::Initialize(
+    SessionOptions^ options,
+    std::shared_ptr<GracenoteChannelPool> channelPool,
+    GracenoteOverflowPolicy overflowPolicy,
+    TimeSpan writeQueueDuration,
+    std::shared_ptr<GracenoteLookupStatistics> lookupStatistics,
+    std::shared_ptr<MetricsRegistry> factoryMetrics)
 {
     // Cache the options.
     m_options = options;
-    m_user_handle = make_user_handle_shared_ptr(user_handle);
+    m_channelPool = channelPool;
+    m_overflowPolicy = overflowPolicy;
+    m_writeQueueDuration = writeQueueDuration.Duration;
+    m_lookupStatistics = lookupStatistics;
+
+    // Look the metrics up once, so the callbacks record them without locking the registry.
+    m_metrics = std::make_shared<MetricsRegistry>(factoryMetrics);
+    m_fingerprintLatency = &m_metrics->Histogram("fingerprint");
+    m_localQueryLatency = &m_metrics->Histogram("local_query");
+    m_onlineQueryLatency = &m_metrics->Histogram("online_query");
+    m_identifyLatency = &m_metrics->Histogram("identify");
+    m_parseLatency = &m_metrics->Histogram("parse");
+    m_audioBytes = &m_metrics->Counter("audio_bytes");
+    m_identified = &m_metrics->Counter("identified");
+    m_errors = &m_metrics->Counter("errors");
+}
+
+/* static */
+gnsdk_musicidstream_callbacks_t GracenoteSession::GetStreamCallbacks()
+{
+    gnsdk_musicidstream_callbacks_t callbacks = { 0 };
+
+    // -Stream requires callbacks to receive identification results.
+    // Here we set the various callbacks for results ands status.
+    callbacks.callback_status = GNSDK_NULL;
+    callbacks.callback_processing_status = GNSDK_NULL;
+    callbacks.callback_identifying_status = StreamIdentifyingStatusCallback;
+    callbacks.callback_result_available = StreamResultAvailableCallback;
+    callbacks.callback_error = StreamCompletedWithErrorCallback;
+
+    return callbacks;
 }
 
 String^ GracenoteSession::SessionIdentifier::get()
@@ -77,38 +214,39 @@ IdentifyStatus GracenoteSession::IdentificationStatus::get()
     return m_status;
 }
 
+uint64 GracenoteSession::DroppedFrames::get()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_channelLock);
+    return (m_writer != nullptr) ? m_writer->DroppedFrames() : 0;
+}
+
+PipelineMetrics^ GracenoteSession::Metrics::get()
+{
+    return ToPipelineMetrics(m_metrics != nullptr ? m_metrics->Snapshot() : MetricsSnapshot());
+}
+
 void GracenoteSession::AddAudioSample(const Array<byte>^ audioData)
 {
-    // If not started, start.
-    if (m_channel_handle.get() == GNSDK_NULL)
+    std::lock_guard<std::recursive_mutex> lock(m_channelLock);
+
+    // If not started, lease a channel which is already identifying.
+    if (m_writer == nullptr && m_status == IdentifyStatus::Invalid && m_channelPool != nullptr)
     {
-        gnsdk_musicidstream_channel_handle_t channel_handle;
-        if (0 == StreamBegin(
-            m_user_handle.get(),
-            m_options->SampleRate,
-            m_options->SampleSize,
-            m_options->ChannelCount,
-            reinterpret_cast<gnsdk_void_t*>(m_weak_reference),
-            &channel_handle))
-        {
-            m_channel_handle = make_channel_handle_unique_ptr(channel_handle);
-            UpdateStatus(IdentifyStatus::Incomplete);
-        }
+        StartWriter();
     }
 
-    // If not complete, add sample data.
-    if (m_channel_handle.get() != GNSDK_NULL)
+    // If not complete, queue sample data; the writer drops it rather than wait.
+    if (m_writer != nullptr)
     {
-        if (m_status == IdentifyStatus::Incomplete)
+        if (m_status == IdentifyStatus::Incomplete && audioData != nullptr)
         {
-            std::vector<unsigned char> audioVector(begin(audioData), end(audioData));
-            StreamWrite(m_channel_handle.get(), audioVector.data(), audioVector.size());
+            m_writer->Write(begin(audioData), audioData->Length);
+            m_audioBytes->Add(audioData->Length);
         }
 
-        if (m_status == IdentifyStatus::Complete)
+        if (m_status == IdentifyStatus::Complete || m_status == IdentifyStatus::Error)
         {
-            // End the fingerprint session and get the track.
-            StreamEnd(m_channel_handle.get());
+            m_writer->Close();
         }
     }
 }
@@ -120,7 +258,8 @@ IAsyncOperation<IVectorView<IReadOnlyTrack^>^>^ GracenoteSession::GetTracksAsync
     // but will compile cleanly. Move along, nothing to see here.
     return create_async([this]() -> task<IVectorView<IReadOnlyTrack^>^>
         {
-            return task_from_result(m_tracks->GetView());
+            std::lock_guard<std::mutex> lock(m_tracksLock);
+            return task_from_result(m_tracks);
         });
 }
 
@@ -137,266 +276,204 @@ void GracenoteSession::UpdateStatus(IdentifyStatus newStatus)
     }
 }
 
-gnsdk_error_t GracenoteSession::StreamBegin(
-    gnsdk_user_handle_t user_handle,
-    unsigned int audio_sample_rate,
-    unsigned int audio_sample_size,
-    unsigned int audio_channels,
-    gnsdk_void_t* _callback_data,
-    gnsdk_musicidstream_channel_handle_t* p_channel_handle)
+void GracenoteSession::StartWriter()
 {
-    gnsdk_musicidstream_channel_handle_t channel_handle = GNSDK_NULL;
-    gnsdk_musicidstream_callbacks_t callbacks = { 0 };
-    gnsdk_error_t error = GNSDK_SUCCESS;
-    int rc = 0;
+    ChannelFormat format(m_options->SampleRate, m_options->SampleSize, m_options->ChannelCount);
+    std::shared_ptr<GracenoteChannel> channel = m_channelPool->Lease(format);
+    if (channel == nullptr)
+    {
+        return;
+    }
 
-    // -Stream requires callbacks to receive identification results.
-    // Here we set the various callbacks for results ands status.
-    callbacks.callback_status = GNSDK_NULL;
-    callbacks.callback_processing_status = GNSDK_NULL;
-    callbacks.callback_identifying_status = StreamIdentifyingStatusCallback;
-    callbacks.callback_result_available = StreamResultAvailableCallback;
-    callbacks.callback_error = StreamCompletedWithErrorCallback;
+    // Sample size is in bits; TimeSpan is in 100-nanosecond units.
+    uint64 bytesPerSecond = static_cast<uint64>(m_options->SampleRate) * (m_options->SampleSize / 8) * m_options->ChannelCount;
+    size_t capacity = static_cast<size_t>((bytesPerSecond * static_cast<uint64>(m_writeQueueDuration)) / 10000000);
+    size_t batchSize = static_cast<size_t>((bytesPerSecond * WriteBatchMilliseconds) / 1000);
 
-    // Create the channel handle
-    error = gnsdk_musicidstream_channel_create(
-        user_handle,
-        gnsdk_musicidstream_preset_radio,
-        &callbacks,
-        _callback_data,
-        &channel_handle);
-    GNSDK_CHECK(error);
+    channel->Attach(this);
+    m_writer = std::make_shared<GracenoteStreamWriter>(m_channelPool, channel, capacity, batchSize, m_overflowPolicy);
+    m_writer->Start();
+    UpdateStatus(IdentifyStatus::Incomplete);
+}
 
-    // initialize the fingerprinter
-    // Note: The sample file shipped is a 44100Hz 16-bit stereo (2 channel) wav file
-    error = gnsdk_musicidstream_channel_audio_begin(
-        channel_handle,
-        audio_sample_rate,
-        audio_sample_size,
-        audio_channels);
-    GNSDK_CHECK(error);
+void GracenoteSession::ReleaseChannel()
+{
+    // The writer gives the channel back once its worker stops.
+    std::lock_guard<std::recursive_mutex> lock(m_channelLock);
+    if (m_writer != nullptr)
+    {
+        m_writer->Close();
+    }
+}
 
-    error = gnsdk_musicidstream_channel_identify(channel_handle);
-    GNSDK_CHECK(error);
+void GracenoteSession::OnIdentifyingStatus(gnsdk_musicidstream_identifying_status_t status)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_lookupLock);
 
-    //gnsdk_musicidstream_channel_set_locale
+    // A pooled channel may have started identifying before it was leased; a phase whose start
+    // the session didn't see isn't recorded.
+    auto recordPhase = [now](LatencyHistogram* histogram, std::chrono::steady_clock::time_point start)
+    {
+        if (start != std::chrono::steady_clock::time_point())
+        {
+            histogram->Record(now - start);
+        }
+    };
 
-    // Set options.
-    error = gnsdk_musicidstream_channel_option_set(
-        channel_handle,
-        GNSDK_MUSICIDSTREAM_OPTION_ENABLE_CONTENT_DATA,
-        GNSDK_VALUE_TRUE);
-    GNSDK_LOG(error);
+    switch (status)
+    {
+    case gnsdk_musicidstream_identifying_started:
+        m_identifyStart = now;
+        break;
 
-    error = gnsdk_musicidstream_channel_option_set(
-        channel_handle,
-        GNSDK_MUSICIDSTREAM_OPTION_RESULT_PREFER_COVERART,
-        GNSDK_VALUE_TRUE);
-    GNSDK_LOG(error);
+    case gnsdk_musicidstream_identifying_fp_generated:
+        recordPhase(m_fingerprintLatency, m_identifyStart);
+        break;
 
-    error = GNSDK_SUCCESS;
-error:
-    if (error != GNSDK_SUCCESS)
-    {
-        GNSDK_LOG(gnsdk_musicidstream_channel_release(channel_handle));
+    case gnsdk_musicidstream_identifying_local_query_started:
+        m_localQueryStart = now;
+        break;
+
+    case gnsdk_musicidstream_identifying_local_query_ended:
+        recordPhase(m_localQueryLatency, m_localQueryStart);
+        break;
+
+    case gnsdk_musicidstream_identifying_online_query_started:
+        m_onlineQueryStart = now;
+        break;
+
+    case gnsdk_musicidstream_identifying_online_query_ended:
+        recordPhase(m_onlineQueryLatency, m_onlineQueryStart);
+        break;
+
+    case gnsdk_musicidstream_identifying_ended:
+        recordPhase(m_identifyLatency, m_identifyStart);
+        break;
+
+    default:
+        break;
     }
-    else
+
+    if (status == gnsdk_musicidstream_identifying_local_query_started ||
+        status == gnsdk_musicidstream_identifying_online_query_started)
     {
-        // return the Channel handle for use at query time
-        *p_channel_handle = channel_handle;
-    }
+        // The lookup starts with the first query.
+        if (!m_localQueried && !m_onlineQueried)
+        {
+            m_lookupStart = std::chrono::steady_clock::now();
+        }
 
-    return error;
+        m_localQueried |= (status == gnsdk_musicidstream_identifying_local_query_started);
+        m_onlineQueried |= (status == gnsdk_musicidstream_identifying_online_query_started);
+    }
 }
 
-void GracenoteSession::StreamEnd(gnsdk_musicidstream_channel_handle_t channel_handle)
+void GracenoteSession::RecordLookup(bool found)
 {
-    if (channel_handle != GNSDK_NULL)
+    std::lock_guard<std::mutex> lock(m_lookupLock);
+    if (m_lookupStatistics == nullptr || m_lookupRecorded || (!m_localQueried && !m_onlineQueried))
     {
-        // signal that we are done
-        GNSDK_LOG(gnsdk_musicidstream_channel_audio_end(channel_handle));
+        return;
     }
+
+    m_lookupRecorded = true;
+    m_lookupStatistics->RecordLookup(
+        m_localQueried,
+        m_onlineQueried,
+        found,
+        std::chrono::steady_clock::now() - m_lookupStart);
 }
 
-gnsdk_error_t GracenoteSession::StreamWrite(
-    gnsdk_musicidstream_channel_handle_t channel_handle,
-    unsigned char* p_pcm_audio,
-    size_t read_size)
+void GracenoteSession::PublishTracks(IVectorView<IReadOnlyTrack^>^ tracks)
 {
-    gnsdk_error_t error = GNSDK_SUCCESS;
-
-    // write audio to the fingerprinter
-    if (channel_handle != GNSDK_NULL)
+    // Readers see no results or all of them, never a partial set.
     {
-        error = gnsdk_musicidstream_channel_audio_write(
-            channel_handle,
-            p_pcm_audio,
-            read_size);
-        GNSDK_CHECK(error);
-
-        LogMessage("\n%s: write %d bytes\n\n", __FUNCTION__, read_size);
+        std::lock_guard<std::mutex> lock(m_tracksLock);
+        m_tracks = tracks;
     }
 
-    error = GNSDK_SUCCESS;
-error:
-    return error;
+    UpdateStatus(IdentifyStatus::Complete);
 }
 
-gnsdk_error_t GracenoteSession::GetTrackData(
-    gnsdk_gdo_handle_t response_gdo,
-    gnsdk_uint32_t album_ordinal,
-    gnsdk_void_t* callback_data,
-    gnsdk_musicidstream_channel_handle_t channel_handle)
+/* static */
+Track^ GracenoteSession::ReadTrack(gnsdk_gdo_handle_t response_gdo, gnsdk_uint32_t album_ordinal)
 {
+    gnsdk_gdo_handle_t nodes[GdoNodeCount] = { GNSDK_NULL };
+    gnsdk_cstr_t values[TrackFieldCount] = { GNSDK_NULL };
+    Track^ track = nullptr;
+    int32 duration = 0;
+    int node = 0;
     gnsdk_error_t error = GNSDK_SUCCESS;
-    gnsdk_gdo_handle_t album_gdo = GNSDK_NULL;
-    gnsdk_gdo_handle_t album_title_gdo = GNSDK_NULL;
-    gnsdk_gdo_handle_t album_coverart_gdo = GNSDK_NULL;
-    gnsdk_gdo_handle_t album_coverart_asset_gdo = GNSDK_NULL;
-    gnsdk_gdo_handle_t track_gdo = GNSDK_NULL;
-    gnsdk_gdo_handle_t track_title_gdo = GNSDK_NULL;
-    gnsdk_gdo_handle_t artist_gdo = GNSDK_NULL;
-    gnsdk_gdo_handle_t artist_image_gdo = GNSDK_NULL;
-    gnsdk_gdo_handle_t artist_image_asset_gdo = GNSDK_NULL;
-    _track track_data = { 0 };
-
-    // Get the album
-    error = gnsdk_manager_gdo_child_get(response_gdo, GNSDK_GDO_CHILD_ALBUM, album_ordinal, &album_gdo);
-    GNSDK_CHECK(error);
 
-    // Get the matched track number: there is only 1. We need this, i.e. GNSDK_CHECK().
-    error = gnsdk_manager_gdo_child_get(album_gdo, GNSDK_GDO_CHILD_TRACK_MATCHED, 1, &track_gdo);
+    // Get the album.
+    error = gnsdk_manager_gdo_child_get(response_gdo, GNSDK_GDO_CHILD_ALBUM, album_ordinal, &nodes[AlbumNode]);
     GNSDK_CHECK(error);
 
-    // Get the artist: there is only 1. We need this, i.e. GNSDK_CHECK().
-    error = gnsdk_manager_gdo_child_get(album_gdo, GNSDK_GDO_CHILD_ARTIST, 1, &artist_gdo);
-    GNSDK_CHECK(error);
-
-    // Get the album title: there is only 1; optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_child_get(album_gdo, GNSDK_GDO_CHILD_TITLE_OFFICIAL, 1, &album_title_gdo);
-    GNSDK_LOG(error);
-
-    if (GNSDK_SUCCESS == error)
+    // Get every node once; an optional node, and so its children, may be missing.
+    for (node = AlbumNode + 1; node < GdoNodeCount; node++)
     {
-        error = gnsdk_manager_gdo_value_get(album_title_gdo, GNSDK_GDO_VALUE_DISPLAY, 1, &track_data.p_album);
-        GNSDK_LOG(error);
-    }
+        const GdoNodeMapping& mapping = NodeMap[node];
+        if (nodes[mapping.parent] == GNSDK_NULL)
+        {
+            continue;
+        }
 
-    // Get the album covert art: there is only 1; optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_child_get(album_gdo, GNSDK_GDO_CHILD_CONTENT_IMAGECOVER, 1, &album_coverart_gdo);
-    GNSDK_LOG(error);
+        error = gnsdk_manager_gdo_child_get(nodes[mapping.parent], mapping.child_key, 1, &nodes[node]);
+        if (mapping.required)
+        {
+            GNSDK_CHECK(error);
+        }
+    }
 
-    if (GNSDK_SUCCESS == error)
+    // Get every value; the strings belong to the nodes, so convert them before release.
+    for (const GdoFieldMapping& mapping : FieldMap)
     {
-        error = gnsdk_manager_gdo_child_get(album_coverart_gdo, GNSDK_GDO_CHILD_ASSET_SIZE_MEDIUM, 1, &album_coverart_asset_gdo);
-        GNSDK_LOG(error);
-
-        if (GNSDK_SUCCESS == error)
+        if (nodes[mapping.node] != GNSDK_NULL)
         {
-            error = gnsdk_manager_gdo_value_get(album_coverart_asset_gdo, GNSDK_GDO_VALUE_ASSET_URL_GNSDK, 1, &track_data.p_album_coverart_url);
-            GNSDK_LOG(error);
+            gnsdk_manager_gdo_value_get(nodes[mapping.node], mapping.value_key, 1, &values[mapping.field]);
         }
     }
 
-    // Album release date; optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_DATE_RELEASE, 1, &track_data.p_album_releasedate);
-    GNSDK_LOG(error);
-
-    // Album label; optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_ALBUM_LABEL, 1, &track_data.p_album_label);
-    GNSDK_LOG(error);
-
-    // Album track count; optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_ALBUM_TRACK_COUNT, 1, &track_data.p_album_track_count);
-    GNSDK_LOG(error);
-
-    // Track title; optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_child_get(track_gdo, GNSDK_GDO_CHILD_TITLE_OFFICIAL, 1, &track_title_gdo);
-    GNSDK_LOG(error);
-
-    if (GNSDK_SUCCESS == error)
+    track = ref new Track();
+    track->Identifier = ToPlatformString(values[IdentifierField]);
+    track->Title = ToPlatformString(values[TitleField]);
+    track->Artist = ToPlatformString(values[ArtistField]);
+    track->Album = ToPlatformString(values[AlbumField]);
+    track->Genre = ToPlatformString(values[GenreField]);
+    track->MatchConfidence = ToPlatformString(values[MatchConfidenceField]);
+    track->MatchPosition = ToInt32(values[MatchPositionField]);
+    track->CurrentPosition = ToInt32(values[CurrentPositionField]);
+
+    // Duration is in milliseconds unless the units say seconds.
+    duration = ToInt32(values[DurationField]);
+    if (values[DurationUnitsField] != GNSDK_NULL && _stricmp(values[DurationUnitsField], "SEC") == 0)
     {
-        error = gnsdk_manager_gdo_value_get(track_title_gdo, GNSDK_GDO_VALUE_DISPLAY, 1, &track_data.p_title);
-        GNSDK_LOG(error);
+        duration *= 1000;
     }
 
-    // Track number on album; optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_TRACK_NUMBER, 1, &track_data.p_track_number);
-    GNSDK_LOG(error);
-
-    // Track duration; optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_DURATION, 1, &track_data.p_track_duration);
-    GNSDK_LOG(error);
-
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_DURATION_UNITS, 1, &track_data.p_track_duration_unit);
-    GNSDK_LOG(error);
-
-    // Position in track where the fingerprint matched; optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_MATCH_POSITION_MS, 1, &track_data.p_match_position);
-    GNSDK_LOG(error);
-
-    // Duration of the matched fingerprint.
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_MATCH_DURATION_MS, 1, &track_data.p_match_duration);
-    GNSDK_LOG(error);
-
-    // Position in track currently (adjusted for query time); optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_CURRENT_POSITION_MS, 1, &track_data.p_current_position);
-    GNSDK_LOG(error);
-
-    // Match confidence; optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_TEXT_MATCH_SCORE, 1, &track_data.p_matchConfidence);
-    GNSDK_LOG(error);
-
-    // Generes; optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_GENRE_LEVEL1, 1, &track_data.p_genre1);
-    GNSDK_LOG(error);
-
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_GENRE_LEVEL2, 1, &track_data.p_genre2);
-    GNSDK_LOG(error);
-
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_GENRE_LEVEL3, 1, &track_data.p_genre3);
-    GNSDK_LOG(error);
-
-    // Moods; optional, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_MOOD_LEVEL1, 1, &track_data.p_mood1);
-    GNSDK_LOG(error);
+    track->Duration = duration;
 
-    error = gnsdk_manager_gdo_value_get(track_gdo, GNSDK_GDO_VALUE_MOOD_LEVEL2, 1, &track_data.p_mood2);
-    GNSDK_LOG(error);
-
-    // Get artist, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_value_get(artist_gdo, GNSDK_GDO_VALUE_DISPLAY, 1, &track_data.p_artist);
-    GNSDK_LOG(error);
-
-    // Get the artist image: there is only 1, i.e. GNSDK_LOG().
-    error = gnsdk_manager_gdo_child_get(artist_gdo, GNSDK_GDO_CHILD_CONTENT_IMAGEARTIST, 1, &artist_image_gdo);
-    GNSDK_LOG(error);
-
-    if (GNSDK_SUCCESS == error)
+    if (values[CoverArtField] != GNSDK_NULL)
     {
-        error = gnsdk_manager_gdo_child_get(artist_image_gdo, GNSDK_GDO_CHILD_ASSET_SIZE_MEDIUM, 1, &artist_image_asset_gdo);
-        GNSDK_LOG(error);
-
-        if (GNSDK_SUCCESS == error)
+        try
+        {
+            track->CovertArtImage = ref new Uri(ToPlatformString(values[CoverArtField]));
+        }
+        catch (Exception^)
         {
-            error = gnsdk_manager_gdo_value_get(artist_image_asset_gdo, GNSDK_GDO_VALUE_ASSET_URL_GNSDK, 1, &track_data.p_artist_image_url);
-            GNSDK_LOG(error);
+            // Not a usable URL; leave it out.
         }
     }
 
     error = GNSDK_SUCCESS;
 error:
-    GNSDK_CLEANUP_GDO(artist_image_asset_gdo);
-    GNSDK_CLEANUP_GDO(artist_image_gdo);
-    GNSDK_CLEANUP_GDO(artist_gdo);
-    GNSDK_CLEANUP_GDO(track_title_gdo);
-    GNSDK_CLEANUP_GDO(track_gdo);
-    GNSDK_CLEANUP_GDO(album_coverart_asset_gdo);
-    GNSDK_CLEANUP_GDO(album_coverart_gdo);
-    GNSDK_CLEANUP_GDO(album_title_gdo);
-    GNSDK_CLEANUP_GDO(album_gdo);
-
-    return error;
+    for (node = GdoNodeCount - 1; node >= 0; node--)
+    {
+        GNSDK_CLEANUP_GDO(nodes[node]);
+    }
+
+    return (error == GNSDK_SUCCESS) ? track : nullptr;
 }
 
 /* static */
@@ -405,10 +482,16 @@ gnsdk_void_t GNSDK_CALLBACK_API GracenoteSession::StreamIdentifyingStatusCallbac
     gnsdk_musicidstream_identifying_status_t status,
     gnsdk_bool_t* pb_abort)
 {
-    GNSDK_UNUSED(callback_data);
-
     gnsdk_cstr_t  tmp = GNSDK_NULL;
 
+    // Use the supplied channel to get the session it is leased to, for its lookup timing.
+    GracenoteChannel* channel = reinterpret_cast<GracenoteChannel*>(callback_data);
+    GracenoteSession^ session = channel->ResolveSession();
+    if (session != nullptr)
+    {
+        session->OnIdentifyingStatus(status);
+    }
+
     switch (status)
     {
     case gnsdk_musicidstream_identifying_status_invalid:
@@ -452,7 +535,7 @@ gnsdk_void_t GNSDK_CALLBACK_API GracenoteSession::StreamIdentifyingStatusCallbac
         break;
     }
 
-    LogMessage("\n%s: status = %s\n\n", __FUNCTION__, tmp);
+    LOG_DEBUG("%s: status = %s", __FUNCTION__, tmp);
 
     // Do not cancel identification
     *pb_abort = GNSDK_FALSE;
@@ -467,12 +550,14 @@ gnsdk_void_t GNSDK_CALLBACK_API GracenoteSession::StreamResultAvailableCallback(
 {
     gnsdk_uint32_t album_count = 0;
     gnsdk_uint32_t album_ordinal = 0;
+    Vector<IReadOnlyTrack^>^ tracks = nullptr;
+    Track^ track = nullptr;
     gnsdk_error_t error = GNSDK_SUCCESS;
 
-    // Use the supplied weak reference to get the session.
-    // The weak reference will fail to resolve a desttoyed class.
-    Platform::WeakReference* reference = reinterpret_cast<Platform::WeakReference*>(callback_data);
-    GracenoteSession^ session = reference->Resolve<GracenoteSession>();
+    // Use the supplied channel to get the session it is leased to.
+    // The channel will fail to resolve a destroyed or detached session.
+    GracenoteChannel* channel = reinterpret_cast<GracenoteChannel*>(callback_data);
+    GracenoteSession^ session = channel->ResolveSession();
     if (session != nullptr)
     {
         // how many albums were found.
@@ -481,20 +566,34 @@ gnsdk_void_t GNSDK_CALLBACK_API GracenoteSession::StreamResultAvailableCallback(
 
         if (album_count == 0)
         {
-            LogMessage("\nNo albums found for the input.\n");
+            LOG_DEBUG("No albums found for the input.");
         }
         else
         {
-            LogMessage("\n%d albums found for the input.\n", album_count);
+            LOG_DEBUG("%d albums found for the input.", album_count);
+        }
 
+        // Collect every album before publishing; an album which can't be read is left out.
+        tracks = ref new Vector<IReadOnlyTrack^>();
+        {
+            ScopedLatency latency(*session->m_parseLatency);
             for (album_ordinal = 1; album_ordinal <= album_count; album_ordinal++)
             {
-                error = session->GetTrackData(response_gdo, album_ordinal, callback_data, channel_handle);
-                GNSDK_CHECK(error);
+                track = ReadTrack(response_gdo, album_ordinal);
+                if (track != nullptr)
+                {
+                    tracks->Append(track);
+                }
             }
         }
 
-        session->UpdateStatus(IdentifyStatus::Complete);
+        if (tracks->Size > 0)
+        {
+            session->m_identified->Add();
+        }
+
+        session->RecordLookup(tracks->Size > 0);
+        session->PublishTracks(tracks->GetView());
     }
 
 error:
@@ -508,17 +607,19 @@ gnsdk_void_t GNSDK_CALLBACK_API GracenoteSession::StreamCompletedWithErrorCallba
     gnsdk_musicidstream_channel_handle_t channel_handle,
     const gnsdk_error_info_t* p_error_info)
 {
-    // Use the supplied weak reference to get the session.
-    // The weak reference will fail to resolve a desttoyed class.
-    Platform::WeakReference* reference = reinterpret_cast<Platform::WeakReference*>(callback_data);
-    GracenoteSession^ session = reference->Resolve<GracenoteSession>();
+    // Use the supplied channel to get the session it is leased to.
+    // The channel will fail to resolve a destroyed or detached session.
+    GracenoteChannel* channel = reinterpret_cast<GracenoteChannel*>(callback_data);
+    GracenoteSession^ session = channel->ResolveSession();
     if (session != nullptr)
     {
+        session->m_errors->Add();
+        session->RecordLookup(false);
         session->UpdateStatus(IdentifyStatus::Error);
 
         // an error occurred during identification
-        LogMessage(
-            "\nerror from: (%s:%s)  [error callback]\n\t0x%08x %s\n",
+        LOG_ERROR(
+            "error from: (%s:%s)  [error callback] 0x%08x %s",
             p_error_info->error_api ? p_error_info->error_api : "API Unknown",
             p_error_info->error_module ? p_error_info->error_module : "Module Unknown",
             p_error_info->error_code,
@@ -6,6 +6,10 @@
 //-----------------------------------------------------------------------
 #pragma once
 
+#include "GracenoteChannelPool.h"
+#include "GracenoteLookupStatistics.h"
+#include "GracenoteStreamWriter.h"
+#include "Metrics.h"
 #include "SmartPointers.h"
 
 namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
@@ -37,6 +41,22 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
             CrazyGiraffe::AudioIdentification::IdentifyStatus get();
         }
 
+        /// <summary>
+        /// Gets the number of audio frames (one sample for every channel) dropped because the write queue was full.
+        /// </summary>
+        property uint64 DroppedFrames
+        {
+            uint64 get();
+        }
+
+        /// <summary>
+        /// Gets a snapshot of the counters and stage latencies of the session.
+        /// </summary>
+        property CrazyGiraffe::AudioIdentification::PipelineMetrics^ Metrics
+        {
+            CrazyGiraffe::AudioIdentification::PipelineMetrics^ get();
+        }
+
         /// <summary>
         /// Add an audio sample for fingerprint
         /// </summary>
@@ -49,6 +69,11 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
         virtual Windows::Foundation::IAsyncOperation<Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^>^
             GetTracksAsync();
 
+        /// <summary>
+        /// Finalizes an instance of the <see cref="GracenoteSession" /> class. Stops the writer, which returns the channel to the pool.
+        /// </summary>
+        virtual ~GracenoteSession();
+
     internal:
         /// <summary>
         /// Prevents a default instance of the <see cref="GracenoteSession" /> class from being created.
@@ -59,8 +84,23 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
         /// Initializes an instance of the <see cref="GracenoteSession" /> class.
         /// </summary>
         /// <param name="options">the options.</param>
-        /// <param name="user_handle">the plugin user handle.</param>
-        void Initialize(CrazyGiraffe::AudioIdentification::SessionOptions^ options, gnsdk_user_handle_t user_handle);
+        /// <param name="channelPool">the channel pool of the factory.</param>
+        /// <param name="overflowPolicy">what to do with audio which doesn't fit in the write queue.</param>
+        /// <param name="writeQueueDuration">the audio the write queue holds.</param>
+        /// <param name="lookupStatistics">the lookup counters of the factory.</param>
+        /// <param name="factoryMetrics">the metrics of the factory, which the session's add up to.</param>
+        void Initialize(
+            CrazyGiraffe::AudioIdentification::SessionOptions^ options,
+            std::shared_ptr<CrazyGiraffe::AudioIdentification::Gracenote::GracenoteChannelPool> channelPool,
+            CrazyGiraffe::AudioIdentification::Gracenote::GracenoteOverflowPolicy overflowPolicy,
+            Windows::Foundation::TimeSpan writeQueueDuration,
+            std::shared_ptr<CrazyGiraffe::AudioIdentification::Gracenote::GracenoteLookupStatistics> lookupStatistics,
+            std::shared_ptr<CrazyGiraffe::Common::MetricsRegistry> factoryMetrics);
+
+        /// <summary>
+        /// Gets the GNSDK callbacks for the channels of a pool. The callback data is the <see cref="GracenoteChannel" />.
+        /// </summary>
+        static gnsdk_musicidstream_callbacks_t GetStreamCallbacks();
 
     protected:
         /// <summary>
@@ -70,29 +110,26 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
         void UpdateStatus(CrazyGiraffe::AudioIdentification::IdentifyStatus newStatus);
 
     private:
-        /// Begin the streaming identification.
-        gnsdk_error_t StreamBegin(
-            gnsdk_user_handle_t user_handle,
-            unsigned int audio_sample_rate,
-            unsigned int audio_sample_size,
-            unsigned int audio_channels,
-            gnsdk_void_t* _callback_data,
-            gnsdk_musicidstream_channel_handle_t* p_channel_handle);
-
-        /// End the streaming identification.
-        void StreamEnd(gnsdk_musicidstream_channel_handle_t channel_handle);
-
-        /// Write samples for streaming identification.
-        gnsdk_error_t StreamWrite(
-            gnsdk_musicidstream_channel_handle_t channel_handle,
-            unsigned char* p_pcm_audio,
-            size_t read_size);
+        /// Lease a channel and start writing to it.
+        void StartWriter();
 
-        gnsdk_error_t GetTrackData(
+        /// Give the channel back to the pool.
+        void ReleaseChannel();
+
+        /// Note the local and online queries of the lookup, and time the phases of identification.
+        void OnIdentifyingStatus(gnsdk_musicidstream_identifying_status_t status);
+
+        /// Count the lookup in the factory's statistics, once.
+        void RecordLookup(bool found);
+
+        /// Replace the identified tracks and complete the session.
+        void PublishTracks(
+            Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^ tracks);
+
+        /// Read the matched track of an album in the response. Returns null if it can't be read.
+        static CrazyGiraffe::AudioIdentification::Track^ ReadTrack(
             gnsdk_gdo_handle_t response_gdo,
-            gnsdk_uint32_t album_ordinal,
-            gnsdk_void_t* callback_data,
-            gnsdk_musicidstream_channel_handle_t channel_handle);
+            gnsdk_uint32_t album_ordinal);
 
     private:
         //
@@ -131,23 +168,97 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
         std::atomic<CrazyGiraffe::AudioIdentification::IdentifyStatus> m_status;
 
         ///
-        /// The identified tracks.
+        /// The identified tracks, replaced all at once.
         ///
-        Platform::Collections::Vector<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^ m_tracks;
+        Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^ m_tracks;
 
-        /// <summary>
-        /// The shared pointer to the user handle.
-        /// </summary>
-        user_handle_shared_ptr m_user_handle;
+        ///
+        /// Lock for the tracks.
+        ///
+        std::mutex m_tracksLock;
+
+        ///
+        /// The lookup counters of the factory.
+        ///
+        std::shared_ptr<CrazyGiraffe::AudioIdentification::Gracenote::GracenoteLookupStatistics> m_lookupStatistics;
+
+        ///
+        /// When the first query of the lookup started.
+        ///
+        std::chrono::steady_clock::time_point m_lookupStart;
+
+        ///
+        /// True once the lookup has queried the local database.
+        ///
+        bool m_localQueried;
+
+        ///
+        /// True once the lookup has gone online.
+        ///
+        bool m_onlineQueried;
+
+        ///
+        /// True once the lookup is counted.
+        ///
+        bool m_lookupRecorded;
+
+        ///
+        /// When the phases in progress started; unset until the session sees them start.
+        ///
+        std::chrono::steady_clock::time_point m_identifyStart;
+        std::chrono::steady_clock::time_point m_localQueryStart;
+        std::chrono::steady_clock::time_point m_onlineQueryStart;
+
+        ///
+        /// Lock for the lookup timing.
+        ///
+        std::mutex m_lookupLock;
+
+        ///
+        /// The metrics of the session.
+        ///
+        std::shared_ptr<CrazyGiraffe::Common::MetricsRegistry> m_metrics;
+
+        ///
+        /// The phases of identification, looked up once: identifying up to the fingerprint, the local
+        /// and online queries, identifying from start to end, and reading the response.
+        ///
+        CrazyGiraffe::Common::LatencyHistogram* m_fingerprintLatency;
+        CrazyGiraffe::Common::LatencyHistogram* m_localQueryLatency;
+        CrazyGiraffe::Common::LatencyHistogram* m_onlineQueryLatency;
+        CrazyGiraffe::Common::LatencyHistogram* m_identifyLatency;
+        CrazyGiraffe::Common::LatencyHistogram* m_parseLatency;
+
+        ///
+        /// The audio queued, the sessions identified and the sessions failed.
+        ///
+        CrazyGiraffe::Common::MetricCounter* m_audioBytes;
+        CrazyGiraffe::Common::MetricCounter* m_identified;
+        CrazyGiraffe::Common::MetricCounter* m_errors;
+
+        ///
+        /// The channel pool of the factory.
+        ///
+        std::shared_ptr<CrazyGiraffe::AudioIdentification::Gracenote::GracenoteChannelPool> m_channelPool;
+
+        ///
+        /// What to do with audio which doesn't fit in the write queue.
+        ///
+        CrazyGiraffe::AudioIdentification::Gracenote::GracenoteOverflowPolicy m_overflowPolicy;
+
+        ///
+        /// The audio the write queue holds, in 100-nanosecond units.
+        ///
+        int64 m_writeQueueDuration;
 
         ///
-        /// The identifying channel handle.
+        /// Writes to the identifying channel leased from the pool.
         ///
-        channel_handle_unique_ptr m_channel_handle;
+        std::shared_ptr<CrazyGiraffe::AudioIdentification::Gracenote::GracenoteStreamWriter> m_writer;
 
         ///
-        /// A weak reference for C-style callbacks.
+        /// Lock for the writer.
         ///
-        Platform::WeakReference* m_weak_reference;
+        std::recursive_mutex m_channelLock;
     };
 } } }
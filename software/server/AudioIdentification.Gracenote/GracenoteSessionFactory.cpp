@@ -15,17 +15,99 @@
 #define GRACENOTELOOKUPDATABASE_ID "8track_db_id"
 #define GRACENOTELOOKUPDATABASE_PATH "gndb"
 
+// The user and locale are saved in the storage folder for the next run.
+#define GRACENOTEUSER_FILE "\\user.txt"
+#define GRACENOTELOCALE_FILE "\\locale.txt"
+
 using namespace concurrency;
 using namespace Platform;
 using namespace Windows::Foundation;
 using namespace Windows::Storage;
 using namespace CrazyGiraffe::AudioIdentification;
 using namespace CrazyGiraffe::AudioIdentification::Gracenote;
+using namespace CrazyGiraffe::Common;
+
+namespace
+{
+    // The most idle channels kept per audio format.
+    const size_t MaximumIdleChannels = 4;
+
+    // The audio a session queues for its writer by default, in 100-nanosecond units.
+    const int64 DefaultWriteQueueDuration = 2 * 10000000LL;
+}
 
 GracenoteSessionFactory::GracenoteSessionFactory(GracenoteClientIdData^ clientdata)
     : m_user_handle(make_user_handle_shared_ptr(GNSDK_NULL))
+    , m_channelPool()
+    , m_overflowPolicy(GracenoteOverflowPolicy::DropNewest)
+    , m_writeQueueDuration()
+    , m_lookupStatistics(std::make_shared<GracenoteLookupStatistics>())
+    , m_metrics(std::make_shared<MetricsRegistry>())
+    , m_initializeTask(task_from_result(false))
+    , m_initializationTimings(nullptr)
+    , m_initializeLock()
 {
     m_clientdata = clientdata;
+    m_writeQueueDuration.Duration = DefaultWriteQueueDuration;
+}
+
+GracenoteOverflowPolicy GracenoteSessionFactory::OverflowPolicy::get()
+{
+    return m_overflowPolicy;
+}
+
+void GracenoteSessionFactory::OverflowPolicy::set(GracenoteOverflowPolicy value)
+{
+    m_overflowPolicy = value;
+}
+
+TimeSpan GracenoteSessionFactory::WriteQueueDuration::get()
+{
+    return m_writeQueueDuration;
+}
+
+void GracenoteSessionFactory::WriteQueueDuration::set(TimeSpan value)
+{
+    if (value.Duration <= 0)
+    {
+        throw ref new InvalidArgumentException("value");
+    }
+
+    m_writeQueueDuration = value;
+}
+
+uint64 GracenoteSessionFactory::LookupCount::get()
+{
+    return m_lookupStatistics->LookupCount();
+}
+
+double GracenoteSessionFactory::LocalHitRate::get()
+{
+    uint64 localLookups = m_lookupStatistics->LocalLookupCount();
+    return (localLookups > 0) ? static_cast<double>(m_lookupStatistics->LocalHitCount()) / localLookups : 0.0;
+}
+
+uint64 GracenoteSessionFactory::OnlineHitCount::get()
+{
+    return m_lookupStatistics->OnlineHitCount();
+}
+
+TimeSpan GracenoteSessionFactory::AverageLookupLatency::get()
+{
+    // TimeSpan is expressed in 100-nanosecond units.
+    TimeSpan latency = { 0 };
+    uint64 lookups = m_lookupStatistics->LookupCount();
+    if (lookups > 0)
+    {
+        latency.Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(m_lookupStatistics->TotalLatency()).count() / 100 / static_cast<int64>(lookups);
+    }
+
+    return latency;
+}
+
+PipelineMetrics^ GracenoteSessionFactory::Metrics::get()
+{
+    return ToPipelineMetrics(m_metrics->Snapshot());
 }
 
 IAsyncOperation<ISession^>^ GracenoteSessionFactory::CreateSessionAsync(SessionOptions^ options)
@@ -33,40 +115,21 @@ IAsyncOperation<ISession^>^ GracenoteSessionFactory::CreateSessionAsync(SessionO
     // E1740 error - [this] seems to be an error but it's a bug in VS2019.
     // It will show as an error in the editor and during a failed compilation
     // but will compile cleanly. Move along, nothing to see here.
-    return create_async([this, &options]() -> task<ISession^>
+    GracenoteOverflowPolicy overflowPolicy = m_overflowPolicy;
+    TimeSpan writeQueueDuration = m_writeQueueDuration;
+    return create_async([this, options, overflowPolicy, writeQueueDuration]() -> task<ISession^>
         {
-            return create_task([this]
-                {
-                    return ApplicationData::Current->LocalFolder->TryGetItemAsync(GRACENOTELOOKUPDATABASE_PATH);
-                }, task_continuation_context::use_arbitrary())
-            .then([this](IStorageItem^ gndbPath)
+            return EnsureInitializedAsync()
+            .then([this, options, overflowPolicy, writeQueueDuration](bool initialized)
                 {
-                    if (gndbPath != nullptr)
-                    {
-                        return ApplicationData::Current->LocalFolder->GetFolderAsync(GRACENOTELOOKUPDATABASE_PATH);
-                    }
-
-                    return ApplicationData::Current->LocalFolder->CreateFolderAsync(GRACENOTELOOKUPDATABASE_PATH);
-                }, task_continuation_context::use_arbitrary())
-            .then([this, options](IStorageFolder^ gndbPath)
-                {
-                    if (gndbPath == nullptr)
+                    if (!initialized)
                     {
                         cancel_current_task();
                     }
 
-                    // Initialize plugin.
-                    if (m_user_handle.get() == GNSDK_NULL)
-                    {
-                        if (0 != Initialize(gndbPath->Path->Data()))
-                        {
-                            cancel_current_task();
-                        }
-                    }
-
                     // Create an initialize a new session.
                     GracenoteSession^ session = ref new GracenoteSession();
-                    session->Initialize(options, m_user_handle.get());
+                    session->Initialize(options, m_channelPool, overflowPolicy, writeQueueDuration, m_lookupStatistics, m_metrics);
 
                     return task_from_result<ISession^>(session);
                 }, task_continuation_context::use_arbitrary())
@@ -79,20 +142,130 @@ IAsyncOperation<ISession^>^ GracenoteSessionFactory::CreateSessionAsync(SessionO
                     }
                     catch (const task_canceled&)
                     {
-                        LogMessage("\nFailed to create session, task cancelled\n");
+                        LOG_ERROR("Failed to create session, task cancelled");
                     }
                     catch (Exception^ ex)
                     {
-                        LogMessage(
-                            "\nFailed to create session, %s\n",
-                            ex->Message->Data());
+                        LOG_ERROR("Failed to create session, %s", ex->Message);
                     }
                     return task_from_result<ISession^>(nullptr);
                 }, task_continuation_context::use_arbitrary());
         });
 }
 
-int GracenoteSessionFactory::Initialize(std::wstring storagePath)
+IAsyncOperation<GracenoteInitializationTimings^>^ GracenoteSessionFactory::InitializeAsync()
+{
+    return create_async([this]() -> task<GracenoteInitializationTimings^>
+        {
+            return EnsureInitializedAsync()
+            .then([this](bool initialized)
+                {
+                    if (!initialized)
+                    {
+                        throw ref new FailureException("GNSDK could not be initialized.");
+                    }
+
+                    std::lock_guard<std::mutex> lock(m_initializeLock);
+                    return m_initializationTimings;
+                }, task_continuation_context::use_arbitrary());
+        });
+}
+
+IAsyncOperation<uint32>^ GracenoteSessionFactory::PrewarmAsync(SessionOptions^ options, uint32 channelCount)
+{
+    if (options == nullptr)
+    {
+        throw ref new InvalidArgumentException("options");
+    }
+
+    return create_async([this, options, channelCount]() -> task<uint32>
+        {
+            return EnsureInitializedAsync()
+            .then([this, options, channelCount](bool initialized)
+                {
+                    if (!initialized)
+                    {
+                        return 0u;
+                    }
+
+                    // Channel setup talks to GNSDK; keep it off the caller's thread.
+                    ChannelFormat format(options->SampleRate, options->SampleSize, options->ChannelCount);
+                    return static_cast<uint32>(m_channelPool->Prewarm(format, channelCount));
+                }, task_continuation_context::use_arbitrary());
+        });
+}
+
+task<bool> GracenoteSessionFactory::EnsureInitializedAsync()
+{
+    std::lock_guard<std::mutex> lock(m_initializeLock);
+    if (m_user_handle.get() != GNSDK_NULL)
+    {
+        return task_from_result(true);
+    }
+
+    // Join the initialization in progress; start again if the last one failed.
+    if (m_initializeTask.is_done())
+    {
+        m_initializeTask = StartInitializeAsync();
+    }
+
+    return m_initializeTask;
+}
+
+task<bool> GracenoteSessionFactory::StartInitializeAsync()
+{
+    std::shared_ptr<GracenoteInitializationPhases> phases = std::make_shared<GracenoteInitializationPhases>();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    return create_task([this]
+        {
+            return ApplicationData::Current->LocalFolder->TryGetItemAsync(GRACENOTELOOKUPDATABASE_PATH);
+        }, task_continuation_context::use_arbitrary())
+    .then([this](IStorageItem^ gndbPath)
+        {
+            if (gndbPath != nullptr)
+            {
+                return ApplicationData::Current->LocalFolder->GetFolderAsync(GRACENOTELOOKUPDATABASE_PATH);
+            }
+
+            return ApplicationData::Current->LocalFolder->CreateFolderAsync(GRACENOTELOOKUPDATABASE_PATH);
+        }, task_continuation_context::use_arbitrary())
+    .then([this, phases, start](IStorageFolder^ gndbPath)
+        {
+            phases->storage = std::chrono::steady_clock::now() - start;
+            if (gndbPath == nullptr)
+            {
+                return false;
+            }
+
+            // Initialize plugin.
+            if (0 != Initialize(gndbPath->Path->Data(), *phases))
+            {
+                return false;
+            }
+
+            phases->total = std::chrono::steady_clock::now() - start;
+
+            std::lock_guard<std::mutex> lock(m_initializeLock);
+            m_initializationTimings = ref new GracenoteInitializationTimings(*phases);
+            return true;
+        }, task_continuation_context::use_arbitrary())
+    .then([](task<bool> previousTask)
+        {
+            try
+            {
+                return previousTask.get();
+            }
+            catch (Exception^ ex)
+            {
+                LOG_ERROR("Failed to initialize, %s", ex->Message);
+            }
+
+            return false;
+        }, task_continuation_context::use_arbitrary());
+}
+
+int GracenoteSessionFactory::Initialize(std::wstring storagePath, GracenoteInitializationPhases& phases)
 {
     size_t size = 0;
     char client_id[MAX_PATH] = { 0 };
@@ -100,7 +273,7 @@ int GracenoteSessionFactory::Initialize(std::wstring storagePath)
     char client_app_version[MAX_PATH] = { 0 };
     char license_data[4096] = { 0 };
     char local_folder[MAX_PATH] = { 0 };
-    int use_local = 0;
+    int use_local = (m_clientdata->LookupMode != GracenoteLookupMode::Online) ? 1 : 0;
     gnsdk_user_handle_t user_handle = GNSDK_NULL;
     int rc = 0;
 
@@ -127,13 +300,19 @@ int GracenoteSessionFactory::Initialize(std::wstring storagePath)
         strlen(license_data),
         use_local,
         local_folder,
-        &user_handle);
+        &user_handle,
+        phases);
     GNSDK_CHECK(rc);
 
 error:
     if (rc == 0)
     {
+        std::lock_guard<std::mutex> lock(m_initializeLock);
         m_user_handle = make_user_handle_shared_ptr(user_handle);
+        m_channelPool = std::make_shared<GracenoteChannelPool>(
+            m_user_handle,
+            GracenoteSession::GetStreamCallbacks(),
+            MaximumIdleChannels);
     }
 
     return rc;
@@ -147,16 +326,21 @@ gnsdk_error_t GracenoteSessionFactory::InitGnSdk(
     gnsdk_size_t license_data_len,
     int use_local,
     const gnsdk_char_t* local_folder,
-    gnsdk_user_handle_t* p_user_handle)
+    gnsdk_user_handle_t* p_user_handle,
+    GracenoteInitializationPhases& phases)
 {
     gnsdk_manager_handle_t sdkmgr_handle = GNSDK_NULL;
     gnsdk_user_handle_t user_handle = GNSDK_NULL;
     gnsdk_error_t error = GNSDK_SUCCESS;
+    gnsdk_error_t library_error = GNSDK_SUCCESS;
+    gnsdk_char_t cache_expiration[32] = { 0 };
+    task<gnsdk_error_t> userTask;
+    std::chrono::steady_clock::time_point phaseStart = std::chrono::steady_clock::now();
     int rc = 0;
 
     // Display GNSDK Version infomation
-    LogMessage(
-        "\nGNSDK Product Version    : %s \t(built %s)\n",
+    LOG_INFO(
+        "GNSDK Product Version    : %s \t(built %s)",
         gnsdk_manager_get_product_version(),
         gnsdk_manager_get_build_date());
 
@@ -171,6 +355,91 @@ gnsdk_error_t GracenoteSessionFactory::InitGnSdk(
     error = EnableLogging(local_folder);
     GNSDK_CHECK(error);
 
+    phases.manager = std::chrono::steady_clock::now() - phaseStart;
+
+    // The user only needs the manager, and registering may go online;
+    // GNSDK allows it alongside the other libraries' initialization.
+    userTask = create_task([this, client_id, client_tag, app_version, use_local, local_folder, &user_handle, &phases]
+        {
+            std::chrono::steady_clock::time_point userStart = std::chrono::steady_clock::now();
+
+            // Get a user handle for our client ID.  This will be passed in for all queries
+            gnsdk_error_t user_error = GetUserHandle(
+                client_id,
+                client_tag,
+                app_version,
+                use_local,
+                local_folder,
+                &user_handle,
+                &phases.userCached);
+
+            phases.user = std::chrono::steady_clock::now() - userStart;
+            return user_error;
+        }, task_continuation_context::use_arbitrary());
+
+    phaseStart = std::chrono::steady_clock::now();
+    library_error = InitLibraries(sdkmgr_handle, use_local, local_folder);
+    phases.libraries = std::chrono::steady_clock::now() - phaseStart;
+
+    // Both must finish before either result is used.
+    error = userTask.get();
+    GNSDK_CHECK(error);
+
+    error = library_error;
+    GNSDK_CHECK(error);
+
+    // Set the user option to use only our local Gracenote DB. Hybrid keeps the online mode,
+    // where the stream tries the local DB first and goes online if it has no match.
+    if (m_clientdata->LookupMode == GracenoteLookupMode::Local)
+    {
+        error = gnsdk_manager_user_option_set(
+            user_handle,
+            GNSDK_USER_OPTION_LOOKUP_MODE,
+            GNSDK_LOOKUP_MODE_LOCAL);
+        GNSDK_CHECK(error);
+    }
+
+    // Keep online results for as long as asked; TimeSpan is in 100-nanosecond units.
+    if (m_clientdata->CacheExpiration.Duration > 0)
+    {
+        sprintf_s(cache_expiration, "%lld", m_clientdata->CacheExpiration.Duration / 10000000);
+        error = gnsdk_manager_user_option_set(
+            user_handle,
+            GNSDK_USER_OPTION_CACHE_EXPIRATION,
+            cache_expiration);
+        GNSDK_LOG(error);
+    }
+
+    // Set the 'locale' to return locale-specifc results values. This examples loads an English locale.
+    phaseStart = std::chrono::steady_clock::now();
+    error = SetLocale(user_handle, local_folder, &phases.localeCached);
+    GNSDK_LOG(error);
+    phases.locale = std::chrono::steady_clock::now() - phaseStart;
+
+    error = GNSDK_SUCCESS;
+error:
+    if (error != GNSDK_SUCCESS)
+    {
+        // Clean up on failure.
+        GNSDK_LOG(gnsdk_manager_user_release(user_handle));
+        GNSDK_LOG(gnsdk_manager_shutdown());
+    }
+    else
+    {
+        // return the User handle for use at query time
+        *p_user_handle = user_handle;
+    }
+
+    return error;
+}
+
+gnsdk_error_t GracenoteSessionFactory::InitLibraries(
+    gnsdk_manager_handle_t sdkmgr_handle,
+    int use_local,
+    const gnsdk_char_t* local_folder)
+{
+    gnsdk_error_t error = GNSDK_SUCCESS;
+
     // Initialize the Storage SQLite Library
     error = gnsdk_storage_sqlite_initialize(sdkmgr_handle);
     GNSDK_CHECK(error);
@@ -201,43 +470,7 @@ gnsdk_error_t GracenoteSessionFactory::InitGnSdk(
     error = gnsdk_musicidstream_initialize(sdkmgr_handle);
     GNSDK_CHECK(error);
 
-    // Get a user handle for our client ID.  This will be passed in for all queries
-    error = GetUserHandle(
-        client_id,
-        client_tag,
-        app_version,
-        use_local,
-        &user_handle);
-    GNSDK_CHECK(error);
-
-    // Set the user option to use our local Gracenote DB unless overridden.
-    if (use_local)
-    {
-        error = gnsdk_manager_user_option_set(
-            user_handle,
-            GNSDK_USER_OPTION_LOOKUP_MODE,
-            GNSDK_LOOKUP_MODE_LOCAL);
-        GNSDK_CHECK(error);
-    }
-
-    // Set the 'locale' to return locale-specifc results values. This examples loads an English locale.
-    error = SetLocale(user_handle, local_folder);
-    GNSDK_LOG(error);
-
-    error = GNSDK_SUCCESS;
 error:
-    if (error != GNSDK_SUCCESS)
-    {
-        // Clean up on failure.
-        GNSDK_LOG(gnsdk_manager_user_release(user_handle));
-        GNSDK_LOG(gnsdk_manager_shutdown());
-    }
-    else
-    {
-        // return the User handle for use at query time
-        *p_user_handle = user_handle;
-    }
-
     return error;
 }
 
@@ -278,7 +511,7 @@ gnsdk_error_t GracenoteSessionFactory::OpenLocalDb(const gnsdk_char_t* local_fol
     error = gnsdk_manager_gdo_render(db_info_gdo, GNSDK_GDO_RENDER_XML, &db_info_xml);
     GNSDK_CHECK(error);
 
-    LogMessage("Gracenote DB Info:\n%s\n", db_info_xml);
+    LOG_INFO("Gracenote DB Info:\n%s", db_info_xml);
 
 error:
     GNSDK_CLEANUP_RENDERED_STR(db_info_xml);
@@ -293,7 +526,9 @@ gnsdk_error_t GracenoteSessionFactory::GetUserHandle(
     const gnsdk_char_t* client_tag,
     const gnsdk_char_t* app_version,
     int use_local,
-    gnsdk_user_handle_t* p_user_handle)
+    const gnsdk_char_t* local_folder,
+    gnsdk_user_handle_t* p_user_handle,
+    bool* p_cached)
 {
     // Load existing user handle, or register new one.
     // GNSDK requires a user handle instance to perform queries.
@@ -314,13 +549,18 @@ gnsdk_error_t GracenoteSessionFactory::GetUserHandle(
     gnsdk_user_handle_t user_handle = GNSDK_NULL;
     gnsdk_cstr_t userRegistrationMode = GNSDK_USER_REGISTER_MODE_ONLINE;
     gnsdk_char_t serialized_user_buf[1024] = { 0 };
+    gnsdk_char_t userPath[MAX_PATH] = { 0 };
     file_unique_ptr readFile = NULL;
     file_unique_ptr writeFile = NULL;
     gnsdk_str_t serialized_user = GNSDK_NULL;
     gnsdk_error_t error = GNSDK_SUCCESS;
 
-    // Do we have a user saved locally?
-    readFile = make_fopen("user.txt", "r");
+    // Do we have a user saved locally? The storage folder is writable, unlike the working directory.
+    strcat_s(userPath, MAX_PATH, local_folder);
+    strcat_s(userPath, MAX_PATH, GRACENOTEUSER_FILE);
+    *p_cached = false;
+
+    readFile = make_fopen(userPath, "r");
     if (readFile)
     {
         fgets(serialized_user_buf, sizeof(serialized_user_buf), readFile.get());
@@ -341,6 +581,7 @@ gnsdk_error_t GracenoteSessionFactory::GetUserHandle(
                 {
                     // Return handle.
                     *p_user_handle = user_handle;
+                    *p_cached = true;
                     return error;
                 }
             }
@@ -365,7 +606,7 @@ gnsdk_error_t GracenoteSessionFactory::GetUserHandle(
     GNSDK_CHECK(error);
 
     // Save newly registered user for use next time
-    writeFile = make_fopen("user.txt", "w");
+    writeFile = make_fopen(userPath, "w");
     if (writeFile.get())
     {
         fputs(serialized_user, writeFile.get());
@@ -392,7 +633,7 @@ error:
     return error;
 }
 
-gnsdk_error_t GracenoteSessionFactory::SetLocale(gnsdk_user_handle_t user_handle, const gnsdk_char_t* local_folder)
+gnsdk_error_t GracenoteSessionFactory::SetLocale(gnsdk_user_handle_t user_handle, const gnsdk_char_t* local_folder, bool* p_cached)
 {
     /// Set application locale. Note that this is only necessary if you are using
     /// locale - dependant fields such as genre, mood, origin, era, etc.Your app
@@ -400,22 +641,63 @@ gnsdk_error_t GracenoteSessionFactory::SetLocale(gnsdk_user_handle_t user_handle
     /// to do this initialization as a matter of course.
 
     gnsdk_locale_handle_t locale_handle = GNSDK_NULL;
+    gnsdk_char_t localePath[MAX_PATH] = { 0 };
+    std::vector<gnsdk_char_t> serialized_locale_buf;
+    file_unique_ptr readFile = NULL;
+    file_unique_ptr writeFile = NULL;
+    gnsdk_str_t serialized_locale = GNSDK_NULL;
+    long length = 0;
     gnsdk_error_t error = GNSDK_SUCCESS;
 
     // Set the location of Gracenote Lists DB
     error = gnsdk_manager_storage_location_set(GNSDK_MANAGER_STORAGE_LISTS, local_folder);
     GNSDK_CHECK(error);
 
-    error = gnsdk_manager_locale_load(
-        GNSDK_LOCALE_GROUP_MUSIC,
-        GNSDK_LANG_ENGLISH,
-        GNSDK_REGION_GLOBAL,
-        GNSDK_DESCRIPTOR_DEFAULT,
-        user_handle,
-        GNSDK_NULL,
-        GNSDK_NULL,
-        &locale_handle);
-    GNSDK_CHECK(error);
+    // A locale saved by an earlier run saves loading the lists.
+    strcat_s(localePath, MAX_PATH, local_folder);
+    strcat_s(localePath, MAX_PATH, GRACENOTELOCALE_FILE);
+    *p_cached = false;
+
+    readFile = make_fopen(localePath, "rb");
+    if (readFile && fseek(readFile.get(), 0, SEEK_END) == 0 && (length = ftell(readFile.get())) > 0)
+    {
+        serialized_locale_buf.resize(length + 1, 0);
+        rewind(readFile.get());
+        if (fread(serialized_locale_buf.data(), 1, length, readFile.get()) == static_cast<size_t>(length))
+        {
+            error = gnsdk_manager_locale_deserialize(serialized_locale_buf.data(), &locale_handle);
+            GNSDK_LOG(error);
+
+            *p_cached = (error == GNSDK_SUCCESS);
+        }
+    }
+
+    if (!*p_cached)
+    {
+        error = gnsdk_manager_locale_load(
+            GNSDK_LOCALE_GROUP_MUSIC,
+            GNSDK_LANG_ENGLISH,
+            GNSDK_REGION_GLOBAL,
+            GNSDK_DESCRIPTOR_DEFAULT,
+            user_handle,
+            GNSDK_NULL,
+            GNSDK_NULL,
+            &locale_handle);
+        GNSDK_CHECK(error);
+
+        // Save the locale for use next time; optional, i.e. GNSDK_LOG().
+        error = gnsdk_manager_locale_serialize(locale_handle, &serialized_locale);
+        GNSDK_LOG(error);
+
+        if (error == GNSDK_SUCCESS)
+        {
+            writeFile = make_fopen(localePath, "wb");
+            if (writeFile.get())
+            {
+                fputs(serialized_locale, writeFile.get());
+            }
+        }
+    }
 
     // Setting the 'locale' as default
     // If default not set, no locale-specific results would be available
@@ -423,6 +705,11 @@ gnsdk_error_t GracenoteSessionFactory::SetLocale(gnsdk_user_handle_t user_handle
     GNSDK_CHECK(error);
 
 error:
+    if (serialized_locale != GNSDK_NULL)
+    {
+        GNSDK_LOG(gnsdk_manager_string_free(serialized_locale));
+    }
+
     if (locale_handle != GNSDK_NULL)
     {
         // The manager will hold onto the locale when set as default
@@ -441,11 +728,15 @@ gnsdk_error_t GracenoteSessionFactory::EnableLogging(const gnsdk_char_t* local_f
     strcat_s(logPath, MAX_PATH, local_folder);
     strcat_s(logPath, MAX_PATH, "\\gracenote.log");
 
+    // Verbose SDK logging costs a file write on every call; keep it to debug builds.
     error = gnsdk_manager_logging_enable(
         logPath,
         GNSDK_LOG_PKG_ALL,
-        //GNSDK_LOG_LEVEL_ERROR | GNSDK_LOG_LEVEL_WARNING,
+#ifdef _DEBUG
         GNSDK_LOG_LEVEL_ALL,
+#else
+        GNSDK_LOG_LEVEL_ERROR | GNSDK_LOG_LEVEL_WARNING,
+#endif
         GNSDK_LOG_OPTION_ALL,
         0,
         GNSDK_FALSE);
@@ -5,8 +5,14 @@
 // </copyright>
 //-----------------------------------------------------------------------
 #pragma once
+#include "GracenoteChannelPool.h"
 #include "GracenoteClientIdData.h"
+#include "GracenoteInitializationTimings.h"
+#include "GracenoteLookupStatistics.h"
+#include "GracenoteStreamWriter.h"
+#include "Metrics.h"
 #include "SmartPointers.h"
+#include <mutex>
 
 namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
 {
@@ -22,6 +28,64 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
         /// <param name="clientdata">Client data for the factory.</param>
         GracenoteSessionFactory(GracenoteClientIdData^ clientdata);
 
+        /// <summary>
+        /// Gets or sets what new sessions do with audio which doesn't fit in their write queue.
+        /// </summary>
+        property CrazyGiraffe::AudioIdentification::Gracenote::GracenoteOverflowPolicy OverflowPolicy
+        {
+            CrazyGiraffe::AudioIdentification::Gracenote::GracenoteOverflowPolicy get();
+            void set(CrazyGiraffe::AudioIdentification::Gracenote::GracenoteOverflowPolicy value);
+        }
+
+        /// <summary>
+        /// Gets or sets the audio the write queue of new sessions holds before samples are dropped.
+        /// </summary>
+        property Windows::Foundation::TimeSpan WriteQueueDuration
+        {
+            Windows::Foundation::TimeSpan get();
+            void set(Windows::Foundation::TimeSpan value);
+        }
+
+        /// <summary>
+        /// Gets the number of lookups by the sessions.
+        /// </summary>
+        property uint64 LookupCount
+        {
+            uint64 get();
+        }
+
+        /// <summary>
+        /// Gets the share of the lookups which tried the local database and were matched there, from 0 to 1.
+        /// </summary>
+        property double LocalHitRate
+        {
+            double get();
+        }
+
+        /// <summary>
+        /// Gets the number of lookups matched online.
+        /// </summary>
+        property uint64 OnlineHitCount
+        {
+            uint64 get();
+        }
+
+        /// <summary>
+        /// Gets the average time from the first query of a lookup to its result.
+        /// </summary>
+        property Windows::Foundation::TimeSpan AverageLookupLatency
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets a snapshot of the counters and identification phase latencies of all the sessions created.
+        /// </summary>
+        property CrazyGiraffe::AudioIdentification::PipelineMetrics^ Metrics
+        {
+            CrazyGiraffe::AudioIdentification::PipelineMetrics^ get();
+        }
+
         /// <summary>
         /// Create a new session to identify a track.
         /// </summary>
@@ -30,11 +94,41 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
         virtual Windows::Foundation::IAsyncOperation<CrazyGiraffe::AudioIdentification::ISession^>^
             CreateSessionAsync(CrazyGiraffe::AudioIdentification::SessionOptions^ options);
 
+        /// <summary>
+        /// Initialize the plugin ahead of the first session. Call at startup so the first session
+        /// costs the same as every other one. Concurrent calls, and sessions, share one initialization.
+        /// </summary>
+        /// <returns>The time spent in each phase of the initialization.</returns>
+        Windows::Foundation::IAsyncOperation<CrazyGiraffe::AudioIdentification::Gracenote::GracenoteInitializationTimings^>^
+            InitializeAsync();
+
+        /// <summary>
+        /// Initialize the plugin and create channels ahead of the sessions which will use them.
+        /// Call at startup so new sessions start streaming immediately.
+        /// </summary>
+        /// <param name="options">Options of the sessions which will be created.</param>
+        /// <param name="channelCount">The number of channels to create.</param>
+        /// <returns>The number of idle channels for the options.</returns>
+        Windows::Foundation::IAsyncOperation<uint32>^
+            PrewarmAsync(CrazyGiraffe::AudioIdentification::SessionOptions^ options, uint32 channelCount);
+
     private:
+        /// <summary>
+        /// Initialize the plugin if it isn't already, or join the initialization in progress.
+        /// </summary>
+        Concurrency::task<bool> EnsureInitializedAsync();
+
+        /// <summary>
+        /// Find the storage folder and initialize the plugin.
+        /// </summary>
+        Concurrency::task<bool> StartInitializeAsync();
+
         /// <summary>
         /// Initialize the plugin(s).
         /// </summary>
-        int Initialize(std::wstring storagePath);
+        int Initialize(
+            std::wstring storagePath,
+            CrazyGiraffe::AudioIdentification::Gracenote::GracenoteInitializationPhases& phases);
 
         /// Initializing the GNSDK is required before any other APIs can be called.
         /// First step is to always initialize the Manager module, then use the returned
@@ -47,7 +141,16 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
             gnsdk_size_t license_data_len,
             int use_local,
             const gnsdk_char_t* local_folder,
-            gnsdk_user_handle_t* p_user_handle);
+            gnsdk_user_handle_t* p_user_handle,
+            CrazyGiraffe::AudioIdentification::Gracenote::GracenoteInitializationPhases& phases);
+
+        ///
+        /// Initialize the storage, lookup, DSP and stream libraries.
+        ///
+        gnsdk_error_t InitLibraries(
+            gnsdk_manager_handle_t sdkmgr_handle,
+            int use_local,
+            const gnsdk_char_t* local_folder);
 
         /// When your program is terminating, or you no longer need GNSDK, you should
         /// call gnsdk_manager_shutdown(). No other shutdown operations are required.
@@ -70,12 +173,14 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
             const gnsdk_char_t* client_tag,
             const gnsdk_char_t* app_version,
             int use_local,
-            gnsdk_user_handle_t* p_user_handle);
+            const gnsdk_char_t* local_folder,
+            gnsdk_user_handle_t* p_user_handle,
+            bool* p_cached);
 
         ///
-        /// Set the locale for the user
+        /// Set the locale for the user; a locale saved by an earlier run is used if there is one.
         ///
-        gnsdk_error_t SetLocale(gnsdk_user_handle_t user_handle, const gnsdk_char_t* local_folder);
+        gnsdk_error_t SetLocale(gnsdk_user_handle_t user_handle, const gnsdk_char_t* local_folder, bool* p_cached);
 
         ///
         /// Enable logging fro the Gacenote SDK
@@ -92,5 +197,45 @@ namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
         /// The shared pointer to the user handle.
         /// </summary>
         user_handle_shared_ptr m_user_handle;
+
+        ///
+        /// The channels shared by the sessions.
+        ///
+        std::shared_ptr<CrazyGiraffe::AudioIdentification::Gracenote::GracenoteChannelPool> m_channelPool;
+
+        ///
+        /// What new sessions do with audio which doesn't fit in their write queue.
+        ///
+        CrazyGiraffe::AudioIdentification::Gracenote::GracenoteOverflowPolicy m_overflowPolicy;
+
+        ///
+        /// The audio the write queue of new sessions holds.
+        ///
+        Windows::Foundation::TimeSpan m_writeQueueDuration;
+
+        ///
+        /// The lookup counters of the sessions.
+        ///
+        std::shared_ptr<CrazyGiraffe::AudioIdentification::Gracenote::GracenoteLookupStatistics> m_lookupStatistics;
+
+        ///
+        /// The metrics of all the sessions created.
+        ///
+        std::shared_ptr<CrazyGiraffe::Common::MetricsRegistry> m_metrics;
+
+        ///
+        /// The initialization in progress, or the last one.
+        ///
+        Concurrency::task<bool> m_initializeTask;
+
+        ///
+        /// The time spent initializing, once initialized.
+        ///
+        CrazyGiraffe::AudioIdentification::Gracenote::GracenoteInitializationTimings^ m_initializationTimings;
+
+        ///
+        /// Lock for initializing the plugin.
+        ///
+        std::mutex m_initializeLock;
     };
 } } }
@@ -0,0 +1,189 @@
+//-----------------------------------------------------------------------
+// <copyright file="GracenoteStreamWriter.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "GracenoteStreamWriter.h"
+#include "ErrorMacros.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace CrazyGiraffe::AudioIdentification::Gracenote;
+
+namespace
+{
+    // The longest queued audio waits for a batch to fill.
+    const std::chrono::milliseconds MaximumBatchDelay(50);
+
+    // Round up to a power of two, so ring positions survive the counters wrapping.
+    size_t RoundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+
+        return result;
+    }
+}
+
+GracenoteStreamWriter::GracenoteStreamWriter(
+    std::shared_ptr<GracenoteChannelPool> channelPool,
+    std::shared_ptr<GracenoteChannel> channel,
+    size_t capacity,
+    size_t batchSize,
+    GracenoteOverflowPolicy policy)
+    : m_channelPool(channelPool)
+    , m_channel(channel)
+    , m_buffer(RoundUpToPowerOfTwo((std::max)(capacity, batchSize)))
+    , m_head(0)
+    , m_tail(0)
+    , m_batchSize((std::max<size_t>)(batchSize, 1))
+    , m_frameSize(1)
+    , m_policy(policy)
+    , m_discardRequested(false)
+    , m_closed(false)
+    , m_droppedBytes(0)
+    , m_wakeLock()
+    , m_wake()
+    , m_worker()
+{
+    // Sample size is in bits.
+    const ChannelFormat& format = m_channel->Format();
+    m_frameSize = (std::max<size_t>)((std::get<1>(format) / 8) * std::get<2>(format), 1);
+}
+
+void GracenoteStreamWriter::Start()
+{
+    // The worker keeps the writer, and so the channel, until it has given the channel back.
+    std::shared_ptr<GracenoteStreamWriter> writer = shared_from_this();
+    m_worker = std::thread([writer]
+        {
+            writer->Run();
+        });
+}
+
+bool GracenoteStreamWriter::Write(const unsigned char* data, size_t size)
+{
+    if (m_closed || data == nullptr || size == 0)
+    {
+        return false;
+    }
+
+    size_t head = m_head.load(std::memory_order_relaxed);
+    size_t tail = m_tail.load(std::memory_order_acquire);
+    size_t capacity = m_buffer.size();
+    if (size > capacity - (head - tail))
+    {
+        // Full: the caller must not wait for the worker.
+        m_droppedBytes += size;
+        if (m_policy == GracenoteOverflowPolicy::DropBacklog)
+        {
+            m_discardRequested = true;
+            m_wake.notify_one();
+        }
+
+        return false;
+    }
+
+    // Copy in at most two pieces around the end of the ring.
+    size_t offset = head & (capacity - 1);
+    size_t first = (std::min)(size, capacity - offset);
+    memcpy(m_buffer.data() + offset, data, first);
+    memcpy(m_buffer.data(), data + first, size - first);
+    m_head.store(head + size, std::memory_order_release);
+
+    if ((head + size) - tail >= m_batchSize)
+    {
+        m_wake.notify_one();
+    }
+
+    return true;
+}
+
+void GracenoteStreamWriter::Close()
+{
+    if (m_closed.exchange(true))
+    {
+        return;
+    }
+
+    m_wake.notify_one();
+
+    // The thread keeps the writer, so the last reference may go on it; it can't be joined here.
+    if (m_worker.joinable())
+    {
+        m_worker.detach();
+    }
+}
+
+uint64 GracenoteStreamWriter::DroppedFrames() const
+{
+    return m_droppedBytes / m_frameSize;
+}
+
+void GracenoteStreamWriter::Run()
+{
+    while (!m_closed)
+    {
+        {
+            // A missed notification costs one batch delay at most.
+            std::unique_lock<std::mutex> lock(m_wakeLock);
+            m_wake.wait_for(lock, MaximumBatchDelay, [this]
+                {
+                    return m_closed || m_discardRequested ||
+                        (m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_relaxed)) >= m_batchSize;
+                });
+        }
+
+        if (m_closed)
+        {
+            break;
+        }
+
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t head = m_head.load(std::memory_order_acquire);
+        size_t queued = head - tail;
+
+        if (m_discardRequested.exchange(false))
+        {
+            // Stale audio; skip to what the caller queues next.
+            m_droppedBytes += queued;
+            m_tail.store(head, std::memory_order_release);
+            continue;
+        }
+
+        if (queued == 0)
+        {
+            continue;
+        }
+
+        // Everything queued, in one write unless it wraps.
+        size_t capacity = m_buffer.size();
+        size_t offset = tail & (capacity - 1);
+        size_t first = (std::min)(queued, capacity - offset);
+        WriteChannel(m_buffer.data() + offset, first);
+        if (queued > first)
+        {
+            WriteChannel(m_buffer.data(), queued - first);
+        }
+
+        m_tail.store(head, std::memory_order_release);
+    }
+
+    // End the fingerprint session; the pool resets the channel for the next session.
+    m_channelPool->Return(m_channel);
+    m_channel = nullptr;
+}
+
+void GracenoteStreamWriter::WriteChannel(const unsigned char* data, size_t size)
+{
+    // A failed write loses that audio; identification carries on with the rest.
+    GNSDK_LOG(gnsdk_musicidstream_channel_audio_write(
+        m_channel->Handle(),
+        data,
+        size));
+}
@@ -0,0 +1,151 @@
+//-----------------------------------------------------------------------
+// <copyright file="GracenoteStreamWriter.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "GracenoteChannelPool.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CrazyGiraffe { namespace AudioIdentification { namespace Gracenote
+{
+    /// <summary>
+    /// What a session does with audio which doesn't fit in its write queue.
+    /// </summary>
+    public enum class GracenoteOverflowPolicy
+    {
+        /// <summary>
+        /// Drop the sample which doesn't fit; the queued audio is kept.
+        /// </summary>
+        DropNewest = 0,
+
+        /// <summary>
+        /// Drop the sample which doesn't fit and the queued audio, so the channel catches up with live audio.
+        /// </summary>
+        DropBacklog = 1,
+    };
+
+    ///
+    /// Writes the audio of a session to its channel on a worker thread of its own, so the caller never
+    /// waits on GNSDK and the worker, which sleeps for most of the session, holds no pool thread.
+    /// Samples go through a single-producer, single-consumer ring; the worker writes what has
+    /// accumulated in as few calls as possible. The writer owns the channel and returns it to the
+    /// pool once closed.
+    ///
+    class GracenoteStreamWriter : public std::enable_shared_from_this<GracenoteStreamWriter>
+    {
+    public:
+        GracenoteStreamWriter(
+            std::shared_ptr<GracenoteChannelPool> channelPool,
+            std::shared_ptr<GracenoteChannel> channel,
+            size_t capacity,
+            size_t batchSize,
+            GracenoteOverflowPolicy policy);
+
+        ///
+        /// Start the worker thread.
+        ///
+        void Start();
+
+        ///
+        /// Queue a sample without blocking. Returns false if it was dropped.
+        ///
+        bool Write(const unsigned char* data, size_t size);
+
+        ///
+        /// Stop the worker without blocking; queued audio is discarded and the channel returned. The
+        /// thread is detached and ends on its own.
+        ///
+        void Close();
+
+        ///
+        /// Get the number of audio frames (one sample for every channel) dropped.
+        ///
+        uint64 DroppedFrames() const;
+
+    private:
+        ///
+        /// Drain the ring into the channel until closed.
+        ///
+        void Run();
+
+        ///
+        /// Write a span of the ring to the channel.
+        ///
+        void WriteChannel(const unsigned char* data, size_t size);
+
+    private:
+        ///
+        /// The pool the channel goes back to.
+        ///
+        std::shared_ptr<GracenoteChannelPool> m_channelPool;
+
+        ///
+        /// The channel written to.
+        ///
+        std::shared_ptr<GracenoteChannel> m_channel;
+
+        ///
+        /// The ring; the size is a power of two.
+        ///
+        std::vector<unsigned char> m_buffer;
+
+        ///
+        /// Bytes queued by the caller since the start; only the caller writes it.
+        ///
+        std::atomic<size_t> m_head;
+
+        ///
+        /// Bytes taken by the worker since the start; only the worker writes it.
+        ///
+        std::atomic<size_t> m_tail;
+
+        ///
+        /// The queued bytes which wake the worker.
+        ///
+        size_t m_batchSize;
+
+        ///
+        /// The bytes in an audio frame.
+        ///
+        size_t m_frameSize;
+
+        ///
+        /// What to do with audio which doesn't fit.
+        ///
+        GracenoteOverflowPolicy m_policy;
+
+        ///
+        /// True when the worker should discard the queued audio.
+        ///
+        std::atomic<bool> m_discardRequested;
+
+        ///
+        /// True once closed.
+        ///
+        std::atomic<bool> m_closed;
+
+        ///
+        /// The bytes dropped.
+        ///
+        std::atomic<uint64> m_droppedBytes;
+
+        ///
+        /// Wakes the worker; the caller only notifies, it never takes the lock.
+        ///
+        std::mutex m_wakeLock;
+        std::condition_variable m_wake;
+
+        ///
+        /// The worker thread, until closed.
+        ///
+        std::thread m_worker;
+    };
+} } }
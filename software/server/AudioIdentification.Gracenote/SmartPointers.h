@@ -28,7 +28,7 @@ inline file_unique_ptr make_fopen(const char* file_name, const char* file_mode)
     errno_t _errno = fopen_s(&file_handle, file_name, file_mode);
     if (_errno != 0)
     {
-        LogMessage("\nerror [on line %d]\n\t0x%08x\n", __LINE__, _errno);
+        LOG_ERROR("error [on line %d] 0x%08x", __LINE__, _errno);
         return nullptr;
     }
 
@@ -55,19 +55,19 @@ inline user_handle_shared_ptr make_user_handle_shared_ptr(gnsdk_user_handle_t us
 {
     if (user_handle == GNSDK_NULL)
     {
-        LogMessage("\nerror [on line %d]\n\tuser_handle is null\n", __LINE__);
+        LOG_ERROR("error [on line %d] user_handle is null", __LINE__);
         return nullptr;
     }
 
     return user_handle_shared_ptr(user_handle, UserHandleDeleter);
 }
 
-// Smartpointer for FILE.
+// Smartpointer for gnsdk_musicidstream_channel_handle_t.
 struct ChannelHandleDeleter
 {
     void operator()(gnsdk_musicidstream_channel_handle_t channel_handle)
     {
-        if (channel_handle == GNSDK_NULL)
+        if (channel_handle != GNSDK_NULL)
         {
             GNSDK_LOG(gnsdk_musicidstream_channel_release(channel_handle));
         }
@@ -80,7 +80,7 @@ inline channel_handle_unique_ptr make_channel_handle_unique_ptr(gnsdk_musicidstr
 {
     if (channel_handle == GNSDK_NULL)
     {
-        LogMessage("\nerror [on line %d]\n\tchannel_handle is null\n", __LINE__);
+        LOG_ERROR("error [on line %d] channel_handle is null", __LINE__);
         return nullptr;
     }
 
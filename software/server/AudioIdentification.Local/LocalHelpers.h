@@ -0,0 +1,38 @@
+//-----------------------------------------------------------------------
+// <copyright file="LocalHelpers.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Convert to UTF-8, as the core catalog takes it.
+inline std::string ToUtf8(Platform::String^ value)
+{
+    if (value == nullptr || value->IsEmpty())
+    {
+        return std::string();
+    }
+
+    int length = WideCharToMultiByte(CP_UTF8, 0, value->Data(), static_cast<int>(value->Length()), nullptr, 0, nullptr, nullptr);
+    std::string buffer(length, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, value->Data(), static_cast<int>(value->Length()), &buffer[0], length, nullptr, nullptr);
+    return buffer;
+}
+
+// Convert from UTF-8, as the core catalog returns it.
+inline Platform::String^ FromUtf8(const std::string& value)
+{
+    if (value.empty())
+    {
+        return L"";
+    }
+
+    int length = MultiByteToWideChar(CP_UTF8, 0, value.data(), static_cast<int>(value.size()), nullptr, 0);
+    std::vector<wchar_t> buffer(length);
+    MultiByteToWideChar(CP_UTF8, 0, value.data(), static_cast<int>(value.size()), buffer.data(), length);
+    return ref new Platform::String(buffer.data(), static_cast<unsigned int>(length));
+}
@@ -0,0 +1,195 @@
+//-----------------------------------------------------------------------
+// <copyright file="LocalSession.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "LocalSession.h"
+#include "LocalHelpers.h"
+#include "Logger.h"
+#include "Core/AudioFrameConverter.h"
+#include "Core/SpeedEstimator.h"
+
+using namespace Concurrency;
+using namespace Platform;
+using namespace Platform::Collections;
+using namespace Windows::Foundation;
+using namespace Windows::Foundation::Collections;
+using namespace CrazyGiraffe::AudioIdentification;
+using namespace CrazyGiraffe::AudioIdentification::Local;
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    // A worn deck runs up to 6% off; the landmarks still agree a quarter of a percent off the speed.
+    const double MaximumSpeedError = 0.06;
+    const double SpeedStep = 0.005;
+}
+
+LocalSession::LocalSession()
+    : m_sessionId(Session::CreateSessionIdentifier())
+    , m_sampleRate(0)
+    , m_channelCount(0)
+    , m_sampleSize(0)
+    , m_catalog()
+    , m_searchPool()
+    , m_state(std::make_unique<RecognitionSession>(0))
+    , m_fingerprinter()
+    , m_samples()
+    , m_heard()
+    , m_fingerprinterLock()
+    , m_tracks((ref new Vector<IReadOnlyTrack^>())->GetView())
+    , m_recognitionTask(create_task([] { task_from_result(); }))
+{
+}
+
+void LocalSession::Initialize(SessionOptions^ options, std::shared_ptr<const LandmarkCatalog> catalog, std::shared_ptr<WorkStealingPool> searchPool)
+{
+    if (options == nullptr || options->SampleRate < LandmarkFingerprinter::AnalysisRate || options->ChannelCount == 0
+        || options->SampleSize == 0 || options->SampleSize % 8 != 0)
+    {
+        throw ref new InvalidArgumentException(L"options");
+    }
+
+    m_sampleRate = options->SampleRate;
+    m_channelCount = options->ChannelCount;
+    m_sampleSize = options->SampleSize;
+    m_catalog = catalog;
+    m_searchPool = searchPool;
+    m_state = std::make_unique<RecognitionSession>(options->ChannelCount * options->SampleRate * options->SampleSize / 8);
+    m_fingerprinter = std::make_unique<LandmarkFingerprinter>(options->SampleRate, options->ChannelCount);
+}
+
+String^ LocalSession::SessionIdentifier::get()
+{
+    return m_sessionId;
+}
+
+IdentifyStatus LocalSession::IdentificationStatus::get()
+{
+    // The values of the two enumerations match.
+    return static_cast<IdentifyStatus>(m_state->Status());
+}
+
+void LocalSession::AddAudioSample(const Array<byte>^ audioData)
+{
+    if (m_state->IsFinished() || audioData == nullptr)
+    {
+        return;
+    }
+
+    // Fingerprinting is a few transforms a second, cheap enough to keep up with the audio.
+    {
+        size_t sampleCount = audioData->Length / (m_sampleSize / 8);
+        m_samples.resize(sampleCount);
+        AudioFrameConverter::ConvertToFloat(audioData->Data, sampleCount, m_sampleSize, m_samples.data());
+
+        std::lock_guard<std::mutex> lock(m_fingerprinterLock);
+        m_fingerprinter->AddSamples(m_samples.data(), m_samples.size());
+        m_heard.insert(m_heard.end(), m_samples.begin(), m_samples.end());
+    }
+
+    // Every three seconds, try to match what has been heard so far.
+    size_t audioDataTargetSize = 0;
+    if (m_state->AddAudio(audioData->Length, audioDataTargetSize) && m_recognitionTask.is_done())
+    {
+        WeakReference weakThis(this);
+        m_recognitionTask = create_task([weakThis]
+            {
+                LocalSession^ _this = weakThis.Resolve<LocalSession>();
+                if (_this != nullptr)
+                {
+                    _this->Identify();
+                }
+            });
+    }
+}
+
+IAsyncOperation<IVectorView<IReadOnlyTrack^>^>^ LocalSession::GetTracksAsync()
+{
+    // E1740 error - [this] seems to be an error but it's a bug in VS2019.
+    // It will show as an error in the editor and during a failed compilation
+    // but will compile cleanly. Move along, nothing to see here.
+    return create_async([this]() -> task<IVectorView<IReadOnlyTrack^>^>
+        {
+            return task_from_result(m_tracks);
+        });
+}
+
+void LocalSession::UpdateStatus(IdentifyStatus newStatus)
+{
+    // Update; complete and error are final.
+    if (m_state->SetStatus(static_cast<CrazyGiraffe::Core::IdentifyStatus>(newStatus)))
+    {
+        StatusChangedEventArgs^ eventArgs = ref new StatusChangedEventArgs(newStatus);
+        StatusChanged(this, eventArgs);
+    }
+}
+
+void LocalSession::Identify()
+{
+    // Only allow 3 attempts.
+    if (!m_state->CanAttempt())
+    {
+        UpdateStatus(IdentifyStatus::Error);
+        return;
+    }
+
+    // The landmarks still waiting on later peaks are left for the next attempt.
+    std::vector<Landmark> landmarks;
+    {
+        std::lock_guard<std::mutex> lock(m_fingerprinterLock);
+        landmarks = m_fingerprinter->Landmarks();
+    }
+
+    TrackInfo trackInfo;
+    bool matched = m_catalog != nullptr && m_catalog->Identify(landmarks, LandmarkIndex::DefaultMinimumScore, trackInfo);
+
+    // A tape played fast or slow only matches once its speed is corrected; try the speeds nearby.
+    if (!matched && m_catalog != nullptr)
+    {
+        std::vector<float> heard;
+        {
+            std::lock_guard<std::mutex> lock(m_fingerprinterLock);
+            heard = m_heard;
+        }
+
+        LandmarkMatch match = {};
+        double speed = 1.0;
+        if (MatchAtSpeeds(*m_catalog, heard.data(), heard.size(), m_sampleRate, m_channelCount,
+            MaximumSpeedError, SpeedStep, LandmarkIndex::DefaultMinimumScore, m_searchPool.get(), match, speed))
+        {
+            LOG_INFO("Identify: matched at speed %.3f", speed);
+            trackInfo = m_catalog->MatchedTrack(match);
+            matched = true;
+        }
+    }
+
+    m_state->EndAttempt();
+    if (!matched)
+    {
+        LOG_INFO("Identify: no match in %u landmarks", static_cast<uint32>(landmarks.size()));
+        return;
+    }
+
+    // The match position is where the session's audio starts in the track.
+    Track^ track = ref new Track();
+    track->Identifier = FromUtf8(trackInfo.identifier);
+    track->Title = FromUtf8(trackInfo.title);
+    track->Artist = FromUtf8(trackInfo.artist);
+    track->Album = FromUtf8(trackInfo.album);
+    track->MatchConfidence = FromUtf8(trackInfo.matchConfidence);
+    track->Duration = trackInfo.duration;
+    track->MatchPosition = trackInfo.matchPosition;
+
+    if (!trackInfo.genre.empty())
+    {
+        track->Genre = FromUtf8(trackInfo.genre);
+    }
+
+    Vector<IReadOnlyTrack^>^ tracks = ref new Vector<IReadOnlyTrack^>();
+    tracks->Append(track);
+    m_tracks = tracks->GetView();
+    UpdateStatus(IdentifyStatus::Complete);
+}
@@ -0,0 +1,145 @@
+//-----------------------------------------------------------------------
+// <copyright file="LocalSession.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+#include "Core/LandmarkFingerprinter.h"
+#include "Core/LandmarkCatalog.h"
+#include "Core/RecognitionSession.h"
+#include "Core/WorkStealingPool.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace CrazyGiraffe { namespace AudioIdentification { namespace Local
+{
+    /// <summary>
+    /// Session for identifying a song against a local catalog.
+    /// </summary>
+    public ref class LocalSession sealed : CrazyGiraffe::AudioIdentification::ISession
+    {
+    public:
+        /// <summary>
+        /// Event handler for status changed.
+        /// </summary>
+        virtual event CrazyGiraffe::AudioIdentification::StatusChangedEventHandler^ StatusChanged;
+
+        /// <summary>
+        /// Gets the identifier for the session.
+        /// </summary>
+        virtual property Platform::String^ SessionIdentifier
+        {
+            Platform::String^ get();
+        }
+
+        /// <summary>
+        /// Gets the sample status.
+        /// </summary>
+        virtual property CrazyGiraffe::AudioIdentification::IdentifyStatus IdentificationStatus
+        {
+            CrazyGiraffe::AudioIdentification::IdentifyStatus get();
+        }
+
+        /// <summary>
+        /// Add an audio sample for fingerprint
+        /// </summary>
+        /// <param name="audioData">audio data as byte array</param>
+        virtual void AddAudioSample(const Platform::Array<byte>^ audioData);
+
+        /// <summary>
+        /// Gets the identified track(s).
+        /// </summary>
+        virtual Windows::Foundation::IAsyncOperation<Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^>^
+            GetTracksAsync();
+
+    internal:
+        /// <summary>
+        /// Prevents a default instance of the <see cref="LocalSession" /> class from being created.
+        /// </summary>
+        LocalSession();
+
+        /// <summary>
+        /// Initializes an instance of the <see cref="LocalSession" /> class.
+        /// </summary>
+        /// <param name="options">the options.</param>
+        /// <param name="catalog">the catalog to match against.</param>
+        /// <param name="searchPool">the pool shared by the sessions of the factory, to search at other speeds on.</param>
+        void Initialize(
+            CrazyGiraffe::AudioIdentification::SessionOptions^ options,
+            std::shared_ptr<const CrazyGiraffe::Core::LandmarkCatalog> catalog,
+            std::shared_ptr<CrazyGiraffe::Core::WorkStealingPool> searchPool);
+
+    protected:
+        /// <summary>
+        /// Update the status and send notifications.
+        /// </summary>
+        /// <param name="newStatus">the new status.</param>
+        void UpdateStatus(CrazyGiraffe::AudioIdentification::IdentifyStatus newStatus);
+
+    private:
+        ///
+        /// Match the landmarks so far against the catalog.
+        ///
+        void Identify();
+
+    private:
+        ///
+        /// The session id.
+        ///
+        Platform::String^ m_sessionId;
+
+        ///
+        /// The format of the audio.
+        ///
+        uint32 m_sampleRate;
+        uint16 m_channelCount;
+        uint16 m_sampleSize;
+
+        ///
+        /// The catalog shared by the sessions of a factory.
+        ///
+        std::shared_ptr<const CrazyGiraffe::Core::LandmarkCatalog> m_catalog;
+
+        ///
+        /// The pool shared by the sessions of a factory.
+        ///
+        std::shared_ptr<CrazyGiraffe::Core::WorkStealingPool> m_searchPool;
+
+        ///
+        /// The status, audio size and attempts of the session.
+        ///
+        std::unique_ptr<CrazyGiraffe::Core::RecognitionSession> m_state;
+
+        ///
+        /// Fingerprints the audio as it comes, so an attempt only has to match.
+        ///
+        std::unique_ptr<CrazyGiraffe::Core::LandmarkFingerprinter> m_fingerprinter;
+
+        ///
+        /// The audio converted to floats; kept to save allocating per sample.
+        ///
+        std::vector<float> m_samples;
+
+        ///
+        /// The audio heard so far, to search again at other speeds if it doesn't match as it is.
+        ///
+        std::vector<float> m_heard;
+
+        ///
+        /// Guards the fingerprinter and the audio heard, between the audio thread and an attempt.
+        ///
+        std::mutex m_fingerprinterLock;
+
+        ///
+        /// The identified tracks.
+        ///
+        Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^ m_tracks;
+
+        ///
+        /// The attempt in progress.
+        ///
+        Concurrency::task<void> m_recognitionTask;
+    };
+} } }
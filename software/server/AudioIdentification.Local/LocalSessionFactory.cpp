@@ -0,0 +1,154 @@
+//-----------------------------------------------------------------------
+// <copyright file="LocalSessionFactory.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "LocalSessionFactory.h"
+#include "LocalSession.h"
+#include "LocalHelpers.h"
+#include "Logger.h"
+#include "Core/AudioFrameConverter.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace concurrency;
+using namespace Platform;
+using namespace Windows::Foundation;
+using namespace CrazyGiraffe::AudioIdentification;
+using namespace CrazyGiraffe::AudioIdentification::Local;
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    // The catalog the sessions search, as the index would be saved.
+    std::shared_ptr<const LandmarkCatalog> CreateCatalog(const LandmarkIndex& index)
+    {
+        std::stringstream saved;
+        index.Save(saved);
+        std::string bytes = saved.str();
+        return std::make_shared<LandmarkCatalog>(std::vector<uint8_t>(bytes.begin(), bytes.end()));
+    }
+}
+
+LocalSessionFactory::LocalSessionFactory()
+    : m_index(std::make_unique<LandmarkIndex>())
+    , m_catalog()
+    , m_catalogLock()
+    , m_searchPool(std::make_shared<WorkStealingPool>(0))
+{
+    m_catalog = CreateCatalog(*m_index);
+}
+
+LocalSessionFactory::LocalSessionFactory(String^ catalogPath)
+    : m_index()
+    , m_catalog()
+    , m_catalogLock()
+    , m_searchPool(std::make_shared<WorkStealingPool>(0))
+{
+    if (catalogPath == nullptr || catalogPath->IsEmpty())
+    {
+        throw ref new InvalidArgumentException(L"catalogPath");
+    }
+
+    try
+    {
+        m_catalog = std::make_shared<LandmarkCatalog>(ToUtf8(catalogPath));
+    }
+    catch (const std::runtime_error& ex)
+    {
+        LOG_WARNING("LocalSessionFactory: catalog failed to open: %s", ex.what());
+        throw ref new InvalidArgumentException(L"catalogPath");
+    }
+}
+
+uint32 LocalSessionFactory::TrackCount::get()
+{
+    return static_cast<uint32>(Catalog()->TrackCount());
+}
+
+void LocalSessionFactory::AddTrack(IReadOnlyTrack^ track, const Array<byte>^ audioData, SessionOptions^ format)
+{
+    if (track == nullptr)
+    {
+        throw ref new InvalidArgumentException(L"track");
+    }
+
+    if (audioData == nullptr)
+    {
+        throw ref new InvalidArgumentException(L"audioData");
+    }
+
+    if (format == nullptr || format->SampleRate < LandmarkFingerprinter::AnalysisRate || format->ChannelCount == 0
+        || format->SampleSize == 0 || format->SampleSize % 8 != 0)
+    {
+        throw ref new InvalidArgumentException(L"format");
+    }
+
+    // Integer PCM, as the sessions take it.
+    size_t sampleCount = audioData->Length / (format->SampleSize / 8);
+    std::vector<float> samples(sampleCount);
+    AudioFrameConverter::ConvertToFloat(audioData->Data, sampleCount, format->SampleSize, samples.data());
+    std::vector<Landmark> landmarks = LandmarkFingerprinter::Fingerprint(samples.data(), samples.size(), format->SampleRate, format->ChannelCount);
+
+    TrackInfo trackInfo;
+    trackInfo.identifier = ToUtf8(track->Identifier);
+    trackInfo.title = ToUtf8(track->Title);
+    trackInfo.artist = ToUtf8(track->Artist);
+    trackInfo.album = ToUtf8(track->Album);
+    trackInfo.genre = ToUtf8(track->Genre);
+    trackInfo.duration = track->Duration;
+
+    // Sessions keep the catalog they started with.
+    std::lock_guard<std::mutex> lock(m_catalogLock);
+    if (m_index == nullptr)
+    {
+        throw ref new FailureException(L"A catalog opened from a file can't be added to.");
+    }
+
+    m_index->AddTrack(trackInfo, landmarks);
+    m_catalog = CreateCatalog(*m_index);
+}
+
+void LocalSessionFactory::SaveCatalog(String^ catalogPath)
+{
+    if (catalogPath == nullptr || catalogPath->IsEmpty())
+    {
+        throw ref new InvalidArgumentException(L"catalogPath");
+    }
+
+    std::lock_guard<std::mutex> lock(m_catalogLock);
+    if (m_index == nullptr)
+    {
+        throw ref new FailureException(L"A catalog opened from a file is already saved.");
+    }
+
+    std::ofstream stream(catalogPath->Data(), std::ios::binary | std::ios::trunc);
+    m_index->Save(stream);
+    stream.flush();
+    if (!stream)
+    {
+        throw ref new FailureException(L"The catalog could not be written.");
+    }
+}
+
+IAsyncOperation<ISession^>^ LocalSessionFactory::CreateSessionAsync(SessionOptions^ options)
+{
+    std::shared_ptr<const LandmarkCatalog> catalog = Catalog();
+    std::shared_ptr<WorkStealingPool> searchPool = m_searchPool;
+    return create_async([catalog, searchPool, options]() -> task<ISession^>
+        {
+            LocalSession^ session = ref new LocalSession();
+            session->Initialize(options, catalog, searchPool);
+
+            return task_from_result<ISession^>(session);
+        });
+}
+
+std::shared_ptr<const LandmarkCatalog> LocalSessionFactory::Catalog()
+{
+    std::lock_guard<std::mutex> lock(m_catalogLock);
+    return m_catalog;
+}
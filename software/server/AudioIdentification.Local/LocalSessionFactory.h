@@ -0,0 +1,96 @@
+//-----------------------------------------------------------------------
+// <copyright file="LocalSessionFactory.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+#include "Core/LandmarkCatalog.h"
+#include "Core/WorkStealingPool.h"
+#include <memory>
+#include <mutex>
+
+namespace CrazyGiraffe { namespace AudioIdentification { namespace Local
+{
+    /// <summary>
+    /// Identifies tracks offline, against a catalog of landmark fingerprints.
+    /// </summary>
+    public ref class LocalSessionFactory sealed : public CrazyGiraffe::AudioIdentification::ISessionFactory
+    {
+    public:
+        /// <summary>
+        /// Create an instance of the <see cref="LocalSessionFactory" /> class with an empty catalog,
+        /// to add tracks to.
+        /// </summary>
+        LocalSessionFactory();
+
+        /// <summary>
+        /// Create an instance of the <see cref="LocalSessionFactory" /> class. The catalog is mapped
+        /// and searched in place, and can't be added to.
+        /// </summary>
+        /// <param name="catalogPath">The path of a catalog saved by <see cref="SaveCatalog" /> or the catalog tool.</param>
+        LocalSessionFactory(Platform::String^ catalogPath);
+
+        /// <summary>
+        /// Gets the number of tracks in the catalog.
+        /// </summary>
+        property uint32 TrackCount
+        {
+            uint32 get();
+        }
+
+        /// <summary>
+        /// Fingerprint a whole track and add it to the catalog. Sessions already created don't see it.
+        /// Not allowed on a catalog opened from a file.
+        /// </summary>
+        /// <param name="track">The track, as it is to be identified.</param>
+        /// <param name="audioData">The audio of the track, as PCM.</param>
+        /// <param name="format">The format of the audio.</param>
+        void AddTrack(
+            CrazyGiraffe::AudioIdentification::IReadOnlyTrack^ track,
+            const Platform::Array<byte>^ audioData,
+            CrazyGiraffe::AudioIdentification::SessionOptions^ format);
+
+        /// <summary>
+        /// Write the catalog to a file.
+        /// </summary>
+        /// <param name="catalogPath">The path of the file.</param>
+        void SaveCatalog(Platform::String^ catalogPath);
+
+        /// <summary>
+        /// Create a new session to identify a track.
+        /// </summary>
+        /// <param name="options">Options for the session.</param>
+        /// <returns>A new session to identify a track.</returns>
+        virtual Windows::Foundation::IAsyncOperation<CrazyGiraffe::AudioIdentification::ISession^>^
+            CreateSessionAsync(CrazyGiraffe::AudioIdentification::SessionOptions^ options);
+
+    private:
+        ///
+        /// Get the catalog as it is now.
+        ///
+        std::shared_ptr<const CrazyGiraffe::Core::LandmarkCatalog> Catalog();
+
+    private:
+        ///
+        /// The tracks added, or null if the catalog was opened from a file.
+        ///
+        std::unique_ptr<CrazyGiraffe::Core::LandmarkIndex> m_index;
+
+        ///
+        /// The catalog the sessions search. Never changed once shared with a session; adding a track
+        /// replaces it.
+        ///
+        std::shared_ptr<const CrazyGiraffe::Core::LandmarkCatalog> m_catalog;
+
+        ///
+        /// Guards m_index and m_catalog.
+        ///
+        std::mutex m_catalogLock;
+
+        ///
+        /// The pool the sessions search at other speeds on.
+        ///
+        std::shared_ptr<CrazyGiraffe::Core::WorkStealingPool> m_searchPool;
+    };
+} } }
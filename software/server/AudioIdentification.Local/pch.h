@@ -0,0 +1,10 @@
+﻿//-----------------------------------------------------------------------
+// <copyright file="pch.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <collection.h>
+#include <ppltasks.h>
@@ -13,12 +13,12 @@ namespace CrazyGiraffe.AudioIdentification.ScenarioTests
     using System.Linq;
     using System.Reflection;
     using System.Text;
-    using System.Threading;
     using System.Threading.Tasks;
     using System.Xml;
     using CrazyGiraffe.AudioIdentification;
     using Microsoft.VisualStudio.TestTools.UnitTesting;
     using Microsoft.VisualStudio.TestTools.UnitTesting.Logging;
+    using Windows.ApplicationModel;
 
     /// <summary>
     /// Base class for identifying audio.
@@ -186,9 +186,9 @@ namespace CrazyGiraffe.AudioIdentification.ScenarioTests
         ///  Process a WAV file.
         /// </summary>
         /// <param name="fileName">The WAV file name.</param>
-        /// <param name="realtime">True to run the samples in real time, false otherwise.</param>
+        /// <param name="speed">1 to run the samples in real time, N for N times as fast, 0 for as fast as the session takes them.</param>
         /// <returns>A task which can be awaited to receive a session.</returns>
-        protected async Task<ISession> ProcessWavFileAsync(string fileName, bool realtime = true)
+        protected async Task<ISession> ProcessWavFileAsync(string fileName, double speed = 1)
         {
             ISessionFactory factory;
             ISession session;
@@ -206,29 +206,14 @@ namespace CrazyGiraffe.AudioIdentification.ScenarioTests
             }
 
             Logger.LogMessage(string.Concat("Processing file: ", fileName, "..."));
-            byte[] fileData = ReadResourceAsByteArray(fileName);
+            SessionReplay replay = new SessionReplay(speed);
+            replay.AddFile(Path.Combine(Package.Current.InstalledLocation.Path, fileName));
 
-            // Check for PCM file.
-            int audioFormat = BitConverter.ToInt16(fileData, 20);
-            Assert.AreEqual(1, audioFormat, string.Concat("unable to read non-PCM file: ", audioFormat.ToString(CultureInfo.InvariantCulture)));
-
-            // Read parameters.
-            short channelCount = BitConverter.ToInt16(fileData, 22);
-            Assert.AreEqual(2, channelCount, string.Concat("ChannelCount not supported: ", channelCount.ToString(CultureInfo.InvariantCulture)));
-
-            int sampleRate = BitConverter.ToInt32(fileData, 24);
-            Assert.AreEqual(44100, sampleRate, string.Concat("SampleRate not supported: ", sampleRate.ToString(CultureInfo.InvariantCulture)));
-
-            short sampleSize = BitConverter.ToInt16(fileData, 34);
-            Assert.AreEqual(16, sampleSize, string.Concat("SampleSize not supported: ", sampleSize.ToString(CultureInfo.InvariantCulture)));
-
-            // Create session options.
-            SessionOptions options = new SessionOptions()
-            {
-                ChannelCount = (ushort)channelCount,
-                SampleRate = (ushort)sampleRate,
-                SampleSize = (ushort)sampleSize,
-            };
+            // Check the format.
+            SessionOptions options = replay.GetOptions(0);
+            Assert.AreEqual(2, options.ChannelCount, string.Concat("ChannelCount not supported: ", options.ChannelCount.ToString(CultureInfo.InvariantCulture)));
+            Assert.AreEqual(44100, options.SampleRate, string.Concat("SampleRate not supported: ", options.SampleRate.ToString(CultureInfo.InvariantCulture)));
+            Assert.AreEqual(16, options.SampleSize, string.Concat("SampleSize not supported: ", options.SampleSize.ToString(CultureInfo.InvariantCulture)));
 
             // Create the session.
             try
@@ -244,27 +229,10 @@ namespace CrazyGiraffe.AudioIdentification.ScenarioTests
                 throw;
             }
 
-            // Feed samples to the session.
+            // Feed samples to the session, in 10 ms blocks mapped from the file, until it completes or fails.
             try
             {
-                int dataIndex = 44;
-                int blockSize = 1764; // 176400 bytes per second @ 44.1k, 2 channels, 16 bits per sample, or 1764 bytes per 10 ms.
-                do
-                {
-                    byte[] block = fileData.Skip(dataIndex).Take(blockSize).ToArray();
-                    dataIndex += block.Length;
-
-                    Logger.LogMessage(string.Concat("Processing ", block.Length.ToString(CultureInfo.InvariantCulture), "bytes..."));
-                    session.AddAudioSample(block);
-                    if (realtime)
-                    {
-                        // Simulate real-time deleivery of samples.
-                        Thread.Sleep(10);
-                    }
-                }
-                while (session.IdentificationStatus != IdentifyStatus.Complete &&
-                    session.IdentificationStatus != IdentifyStatus.Error &&
-                    dataIndex < fileData.Length);
+                await replay.RunAsync(new ISession[] { session });
             }
             catch (Exception ex)
             {
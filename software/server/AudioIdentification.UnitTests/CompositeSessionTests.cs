@@ -0,0 +1,219 @@
+﻿//-----------------------------------------------------------------------
+// <copyright file="CompositeSessionTests.cs" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+namespace CrazyGiraffe.AudioIdentification.UnitTests
+{
+    using System;
+    using System.Collections.Generic;
+    using System.Threading.Tasks;
+    using CrazyGiraffe.AudioIdentification;
+    using CrazyGiraffe.AudioIdentification.UnitTests.Mocks;
+    using Microsoft.VisualStudio.TestTools.UnitTesting;
+
+    /// <summary>
+    /// Test class to test <see cref="CompositeSessionFactory"/> and <see cref="CompositeSession"/>.
+    /// </summary>
+    [TestClass]
+    public class CompositeSessionTests
+    {
+        /// <summary>
+        /// Time to wait for a session to finish.
+        /// </summary>
+        private static readonly TimeSpan Timeout = TimeSpan.FromSeconds(10);
+
+        /// <summary>
+        /// Test that a composite factory needs at least one backend.
+        /// </summary>
+        [TestMethod]
+        public void CompositeSessionFactoryInvalidArgs()
+        {
+            Assert.ThrowsException<ArgumentException>(() => new CompositeSessionFactory(new List<ISessionFactory>()), "empty");
+        }
+
+        /// <summary>
+        /// Test that the first backend to match wins and the others stop getting audio.
+        /// </summary>
+        /// <returns>A task which can be awaited.</returns>
+        [TestMethod]
+        public async Task CompositeSessionFirstMatchWins()
+        {
+            IReadOnlyTrack track = MockTrack.CreateRandom();
+            MockSessionFactory fast = new MockSessionFactory(1, new[] { track });
+            MockSessionFactory slow = new MockSessionFactory(10, new[] { MockTrack.CreateRandom() });
+            CompositeSessionFactory factory = new CompositeSessionFactory(new ISessionFactory[] { slow, fast });
+
+            CompositeSession session = (CompositeSession)await factory.CreateSessionAsync(CreateOptions());
+            Assert.IsNotNull(session, "session");
+            Assert.AreEqual(-1, session.WinningBackendIndex, "WinningBackendIndex");
+
+            Task<IdentifyStatus> finished = WaitForStatusAsync(session);
+            session.AddAudioSample(new byte[16]);
+            Assert.AreEqual(IdentifyStatus.Complete, await finished, "IdentificationStatus");
+
+            Assert.AreEqual(1, session.WinningBackendIndex, "WinningBackendIndex");
+            Assert.AreSame(fast.MockSession, session.WinningSession, "WinningSession");
+            Assert.IsTrue(session.WinningLatency >= TimeSpan.Zero, "WinningLatency");
+            Assert.IsFalse(session.IsConfirmed, "IsConfirmed");
+
+            IReadOnlyList<IReadOnlyTrack> tracks = await session.GetTracksAsync();
+            Assert.AreEqual(1, tracks.Count, "tracks.Count");
+            Assert.AreEqual(track.Title, tracks[0].Title, "Title");
+
+            // The slower backend no longer gets audio, and is closed.
+            session.AddAudioSample(new byte[16]);
+            Assert.AreEqual(1, slow.MockSession.AddedFrames, "AddedFrames");
+            Assert.IsTrue(slow.MockSession.IsDisposed, "slow.IsDisposed");
+            Assert.IsFalse(fast.MockSession.IsDisposed, "fast.IsDisposed");
+        }
+
+        /// <summary>
+        /// Test that a backend with a match below the minimum confidence is dropped at once.
+        /// </summary>
+        /// <returns>A task which can be awaited.</returns>
+        [TestMethod]
+        public async Task CompositeSessionLowConfidenceDropped()
+        {
+            MockSessionFactory low = new MockSessionFactory(1, new[] { MockTrack.CreateRandom("10") });
+            MockSessionFactory high = new MockSessionFactory(3, new[] { MockTrack.CreateRandom("90") });
+            CompositeSessionFactory factory = new CompositeSessionFactory(new ISessionFactory[] { low, high })
+            {
+                MinimumConfidence = 50,
+            };
+
+            CompositeSession session = (CompositeSession)await factory.CreateSessionAsync(CreateOptions());
+            Task<IdentifyStatus> finished = WaitForStatusAsync(session);
+            session.AddAudioSample(new byte[16]);
+            session.AddAudioSample(new byte[16]);
+            session.AddAudioSample(new byte[16]);
+            Assert.AreEqual(IdentifyStatus.Complete, await finished, "IdentificationStatus");
+            Assert.AreEqual(1, session.WinningBackendIndex, "WinningBackendIndex");
+            Assert.AreEqual(1, low.MockSession.AddedFrames, "AddedFrames");
+            Assert.IsTrue(low.MockSession.IsDisposed, "low.IsDisposed");
+        }
+
+        /// <summary>
+        /// Test that a match without a numeric confidence is only accepted when asked for.
+        /// </summary>
+        /// <returns>A task which can be awaited.</returns>
+        [TestMethod]
+        public async Task CompositeSessionUnratedMatch()
+        {
+            foreach (string confidence in new[] { null, string.Empty, "high" })
+            {
+                CompositeSessionFactory factory = new CompositeSessionFactory(new ISessionFactory[]
+                {
+                    new MockSessionFactory(1, new[] { MockTrack.CreateRandom(confidence) }),
+                });
+
+                CompositeSession session = (CompositeSession)await factory.CreateSessionAsync(CreateOptions());
+                Task<IdentifyStatus> finished = WaitForStatusAsync(session);
+                session.AddAudioSample(new byte[16]);
+                Assert.AreEqual(IdentifyStatus.Error, await finished, "IdentificationStatus");
+
+                factory.AcceptUnratedMatches = true;
+                session = (CompositeSession)await factory.CreateSessionAsync(CreateOptions());
+                finished = WaitForStatusAsync(session);
+                session.AddAudioSample(new byte[16]);
+                Assert.AreEqual(IdentifyStatus.Complete, await finished, "IdentificationStatus accepted");
+            }
+        }
+
+        /// <summary>
+        /// Test that a match is held until a second backend agrees.
+        /// </summary>
+        /// <returns>A task which can be awaited.</returns>
+        [TestMethod]
+        public async Task CompositeSessionConfirmation()
+        {
+            IReadOnlyTrack track = MockTrack.CreateRandom();
+            MockSessionFactory first = new MockSessionFactory(1, new[] { track });
+            MockSessionFactory second = new MockSessionFactory(2, new[] { track });
+            CompositeSessionFactory factory = new CompositeSessionFactory(new ISessionFactory[] { first, second })
+            {
+                RequireConfirmation = true,
+            };
+
+            CompositeSession session = (CompositeSession)await factory.CreateSessionAsync(CreateOptions());
+            Task<IdentifyStatus> finished = WaitForStatusAsync(session);
+            session.AddAudioSample(new byte[16]);
+            session.AddAudioSample(new byte[16]);
+            Assert.AreEqual(IdentifyStatus.Complete, await finished, "IdentificationStatus");
+
+            Assert.AreEqual(0, session.WinningBackendIndex, "WinningBackendIndex");
+            Assert.IsTrue(session.IsConfirmed, "IsConfirmed");
+            Assert.AreEqual(2, second.MockSession.AddedFrames, "AddedFrames");
+        }
+
+        /// <summary>
+        /// Test that a failed backend doesn't fail the session.
+        /// </summary>
+        /// <returns>A task which can be awaited.</returns>
+        [TestMethod]
+        public async Task CompositeSessionBackendError()
+        {
+            MockSessionFactory failing = new MockSessionFactory(1, null);
+            MockSessionFactory working = new MockSessionFactory(2, new[] { MockTrack.CreateRandom() });
+            CompositeSessionFactory factory = new CompositeSessionFactory(new ISessionFactory[] { failing, working });
+
+            CompositeSession session = (CompositeSession)await factory.CreateSessionAsync(CreateOptions());
+            Task<IdentifyStatus> finished = WaitForStatusAsync(session);
+            session.AddAudioSample(new byte[16]);
+            session.AddAudioSample(new byte[16]);
+            Assert.AreEqual(IdentifyStatus.Complete, await finished, "IdentificationStatus");
+            Assert.AreEqual(1, session.WinningBackendIndex, "WinningBackendIndex");
+        }
+
+        /// <summary>
+        /// Test that the session fails when every backend fails.
+        /// </summary>
+        /// <returns>A task which can be awaited.</returns>
+        [TestMethod]
+        public async Task CompositeSessionAllBackendsError()
+        {
+            CompositeSessionFactory factory = new CompositeSessionFactory(new ISessionFactory[]
+            {
+                new MockSessionFactory(1, null),
+                new MockSessionFactory(1, null),
+            });
+
+            CompositeSession session = (CompositeSession)await factory.CreateSessionAsync(CreateOptions());
+            Task<IdentifyStatus> finished = WaitForStatusAsync(session);
+            session.AddAudioSample(new byte[16]);
+            Assert.AreEqual(IdentifyStatus.Error, await finished, "IdentificationStatus");
+            Assert.AreEqual(-1, session.WinningBackendIndex, "WinningBackendIndex");
+        }
+
+        /// <summary>
+        /// Create session options for the tests.
+        /// </summary>
+        /// <returns>The session options.</returns>
+        private static SessionOptions CreateOptions()
+        {
+            return new SessionOptions(11025, 8, 1);
+        }
+
+        /// <summary>
+        /// Wait for a session to complete or fail.
+        /// </summary>
+        /// <param name="session">The session.</param>
+        /// <returns>The final status.</returns>
+        private static async Task<IdentifyStatus> WaitForStatusAsync(ISession session)
+        {
+            TaskCompletionSource<IdentifyStatus> completion = new TaskCompletionSource<IdentifyStatus>();
+            session.StatusChanged += (sender, eventArgs) =>
+            {
+                if (eventArgs.Status == IdentifyStatus.Complete || eventArgs.Status == IdentifyStatus.Error)
+                {
+                    completion.TrySetResult(eventArgs.Status);
+                }
+            };
+
+            Task finished = await Task.WhenAny(completion.Task, Task.Delay(Timeout));
+            Assert.AreSame(completion.Task, finished, "Timeout");
+            return completion.Task.Result;
+        }
+    }
+}
@@ -0,0 +1,119 @@
+﻿//-----------------------------------------------------------------------
+// <copyright file="MockSession.cs" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+namespace CrazyGiraffe.AudioIdentification.UnitTests.Mocks
+{
+    using System;
+    using System.Collections.Generic;
+    using System.Threading.Tasks;
+    using CrazyGiraffe.AudioIdentification;
+    using Windows.Foundation;
+
+    /// <summary>
+    /// Mock session for identifying a song.
+    /// </summary>
+    internal class MockSession : ISession, IDisposable
+    {
+        /// <summary>
+        /// Number of frames needed to identify.
+        /// </summary>
+        private readonly int neededFrames;
+
+        /// <summary>
+        /// The tracks found, or null to fail.
+        /// </summary>
+        private readonly List<IReadOnlyTrack> resultingTracks;
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="MockSession" /> class.
+        /// </summary>
+        /// <param name="neededFrames">Number of frames needed to identify.</param>
+        /// <param name="resultingTracks">The tracks found, or null to fail.</param>
+        internal MockSession(int neededFrames, IEnumerable<IReadOnlyTrack> resultingTracks)
+        {
+            this.neededFrames = neededFrames;
+            this.resultingTracks = (resultingTracks == null) ? null : new List<IReadOnlyTrack>(resultingTracks);
+            this.AddedFrames = 0;
+            this.IdentificationStatus = IdentifyStatus.Invalid;
+            this.SessionIdentifier = Guid.NewGuid().ToString();
+            this.Tracks = new List<IReadOnlyTrack>();
+        }
+
+        /// <inheritdoc/>
+        public event StatusChangedEventHandler StatusChanged;
+
+        /// <inheritdoc/>
+        public string SessionIdentifier { get; private set; }
+
+        /// <inheritdoc/>
+        public IdentifyStatus IdentificationStatus { get; private set; }
+
+        /// <summary>
+        /// Gets the number of frames added.
+        /// </summary>
+        public int AddedFrames { get; private set; }
+
+        /// <summary>
+        /// Gets a collection of tracks.
+        /// </summary>
+        public List<IReadOnlyTrack> Tracks { get; private set; }
+
+        /// <summary>
+        /// Gets a value indicating whether the session was closed.
+        /// </summary>
+        public bool IsDisposed { get; private set; }
+
+        /// <inheritdoc/>
+        public void AddAudioSample(byte[] audioData)
+        {
+            this.AddedFrames++;
+            if (this.IdentificationStatus == IdentifyStatus.Invalid)
+            {
+                this.UpdateStatus(IdentifyStatus.Incomplete);
+            }
+
+            if (this.IdentificationStatus == IdentifyStatus.Incomplete && this.AddedFrames >= this.neededFrames)
+            {
+                if (this.resultingTracks == null)
+                {
+                    this.UpdateStatus(IdentifyStatus.Error);
+                }
+                else
+                {
+                    this.Tracks = this.resultingTracks;
+                    this.UpdateStatus(IdentifyStatus.Complete);
+                }
+            }
+        }
+
+        /// <inheritdoc/>
+        public IAsyncOperation<IReadOnlyList<IReadOnlyTrack>> GetTracksAsync()
+        {
+            return Task.FromResult<IReadOnlyList<IReadOnlyTrack>>(this.Tracks).AsAsyncOperation();
+        }
+
+        /// <inheritdoc/>
+        public void Dispose()
+        {
+            this.IsDisposed = true;
+        }
+
+        /// <summary>
+        /// Update the status and send notifications.
+        /// </summary>
+        /// <param name="newStatus">The new status.</param>
+        private void UpdateStatus(IdentifyStatus newStatus)
+        {
+            bool changed = this.IdentificationStatus != newStatus;
+            this.IdentificationStatus = newStatus;
+
+            if (changed)
+            {
+                this.StatusChanged?.Invoke(this, new StatusChangedEventArgs(newStatus));
+            }
+        }
+    }
+}
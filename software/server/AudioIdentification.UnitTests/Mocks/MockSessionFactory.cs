@@ -0,0 +1,52 @@
+﻿//-----------------------------------------------------------------------
+// <copyright file="MockSessionFactory.cs" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+namespace CrazyGiraffe.AudioIdentification.UnitTests.Mocks
+{
+    using System.Collections.Generic;
+    using System.Threading.Tasks;
+    using CrazyGiraffe.AudioIdentification;
+    using Windows.Foundation;
+
+    /// <summary>
+    /// Mock AudioIdentification session factory.
+    /// </summary>
+    internal class MockSessionFactory : ISessionFactory
+    {
+        /// <summary>
+        /// Initializes a new instance of the <see cref="MockSessionFactory"/> class.
+        /// </summary>
+        /// <param name="neededFrames">Number of frames needed to identify.</param>
+        /// <param name="resultingTracks">The tracks found, or null to fail.</param>
+        public MockSessionFactory(int neededFrames, IEnumerable<IReadOnlyTrack> resultingTracks)
+        {
+            this.NeededFrames = neededFrames;
+            this.ResultingTracks = resultingTracks;
+        }
+
+        /// <summary>
+        /// Gets the last session created.
+        /// </summary>
+        public MockSession MockSession { get; private set; }
+
+        /// <summary>
+        /// Gets the number of frames needed to identify.
+        /// </summary>
+        public int NeededFrames { get; private set; }
+
+        /// <summary>
+        /// Gets the tracks found, or null to fail.
+        /// </summary>
+        public IEnumerable<IReadOnlyTrack> ResultingTracks { get; private set; }
+
+        /// <inheritdoc/>
+        public IAsyncOperation<ISession> CreateSessionAsync(SessionOptions options)
+        {
+            this.MockSession = new MockSession(this.NeededFrames, this.ResultingTracks);
+            return Task.FromResult<ISession>(this.MockSession).AsAsyncOperation();
+        }
+    }
+}
@@ -7,6 +7,7 @@
 namespace CrazyGiraffe.AudioIdentification.UnitTests.Mocks
 {
     using System;
+    using System.Globalization;
     using CrazyGiraffe.AudioIdentification;
 
     /// <summary>
@@ -77,6 +78,16 @@ namespace CrazyGiraffe.AudioIdentification.UnitTests.Mocks
         /// </summary>
         /// <returns>A track with random data.</returns>
         public static IReadOnlyTrack CreateRandom()
+        {
+            return CreateRandom(new Random().Next(100).ToString(CultureInfo.InvariantCulture));
+        }
+
+        /// <summary>
+        /// Create a track with random data.
+        /// </summary>
+        /// <param name="matchConfidence">The match confidence of the track.</param>
+        /// <returns>A track with random data.</returns>
+        public static IReadOnlyTrack CreateRandom(string matchConfidence)
         {
             Random random = new Random();
             int duration = random.Next(100000);
@@ -88,7 +99,7 @@ namespace CrazyGiraffe.AudioIdentification.UnitTests.Mocks
                 Album = Guid.NewGuid().ToString(),
                 Genre = Guid.NewGuid().ToString(),
                 CovertArtImage = GetTestJpgUri(),
-                MatchConfidence = Guid.NewGuid().ToString(),
+                MatchConfidence = matchConfidence,
                 Duration = duration,
                 MatchPosition = random.Next(duration),
                 CurrentPosition = random.Next(duration),
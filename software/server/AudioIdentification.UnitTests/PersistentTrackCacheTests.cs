@@ -0,0 +1,167 @@
+﻿//-----------------------------------------------------------------------
+// <copyright file="PersistentTrackCacheTests.cs" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+namespace CrazyGiraffe.AudioIdentification.UnitTests
+{
+    using System;
+    using System.Collections.Generic;
+    using System.IO;
+    using CrazyGiraffe.AudioIdentification;
+    using CrazyGiraffe.AudioIdentification.UnitTests.Mocks;
+    using Microsoft.VisualStudio.TestTools.UnitTesting;
+    using Windows.Storage;
+
+    /// <summary>
+    /// Test class to test <see cref="PersistentTrackCache"/>.
+    /// </summary>
+    [TestClass]
+    public class PersistentTrackCacheTests
+    {
+        /// <summary>
+        /// Test the ability to add and find tracks.
+        /// </summary>
+        [TestMethod]
+        public void PersistentTrackCacheLookupSuccess()
+        {
+            IReadOnlyTrack track = MockTrack.CreateRandom();
+            using (PersistentTrackCache cache = new PersistentTrackCache(CreateFolderPath(), false))
+            {
+                Assert.IsFalse(cache.IsReadOnly, "IsReadOnly");
+                Assert.AreEqual(0u, cache.Count, "Count");
+                Assert.IsNull(cache.Lookup(0x1234, 0), "Lookup");
+
+                cache.Add(0x1234, CreateTracks(track));
+                Assert.AreEqual(1u, cache.Count, "Count");
+
+                IReadOnlyList<IReadOnlyTrack> tracks = cache.Lookup(0x1234, 0);
+                Assert.IsNotNull(tracks, "tracks");
+                Assert.AreEqual(1, tracks.Count, "tracks.Count");
+                AssertTrack(track, tracks[0]);
+            }
+        }
+
+        /// <summary>
+        /// Test the ability to find tracks for a digest which differs slightly.
+        /// </summary>
+        [TestMethod]
+        public void PersistentTrackCacheNearLookupSuccess()
+        {
+            using (PersistentTrackCache cache = new PersistentTrackCache(CreateFolderPath(), false))
+            {
+                cache.Add(0xFF00FF00FF00FF00, CreateTracks(MockTrack.CreateRandom()));
+
+                Assert.IsNull(cache.Lookup(0xFF00FF00FF00FF03, 1), "Lookup distance 1");
+                Assert.IsNotNull(cache.Lookup(0xFF00FF00FF00FF03, 2), "Lookup distance 2");
+
+                cache.Compact();
+                Assert.IsNull(cache.Lookup(0xFF00FF00FF00FF03, 1), "Lookup distance 1 after Compact");
+                Assert.IsNotNull(cache.Lookup(0xFF00FF00FF00FF03, 2), "Lookup distance 2 after Compact");
+                Assert.IsNotNull(cache.Lookup(0x7F00FF00FF00FF03, 3), "Lookup distance 3 after Compact");
+            }
+        }
+
+        /// <summary>
+        /// Test the tracks survive reopening the cache, before and after compaction.
+        /// </summary>
+        [TestMethod]
+        public void PersistentTrackCacheReopenSuccess()
+        {
+            string folderPath = CreateFolderPath();
+            IReadOnlyTrack track1 = MockTrack.CreateRandom();
+            IReadOnlyTrack track2 = MockTrack.CreateRandom();
+
+            using (PersistentTrackCache cache = new PersistentTrackCache(folderPath, false))
+            {
+                cache.Add(1, CreateTracks(track1));
+                cache.Compact();
+                cache.Add(2, CreateTracks(track2));
+            }
+
+            using (PersistentTrackCache cache = new PersistentTrackCache(folderPath, false))
+            {
+                Assert.AreEqual(2u, cache.Count, "Count");
+                AssertTrack(track1, cache.Lookup(1, 0)[0]);
+                AssertTrack(track2, cache.Lookup(2, 0)[0]);
+            }
+        }
+
+        /// <summary>
+        /// Test a read-only cache sees the writer's tracks and can't be changed.
+        /// </summary>
+        [TestMethod]
+        public void PersistentTrackCacheReadOnly()
+        {
+            string folderPath = CreateFolderPath();
+            IReadOnlyTrack track = MockTrack.CreateRandom();
+
+            using (PersistentTrackCache writer = new PersistentTrackCache(folderPath, false))
+            using (PersistentTrackCache reader = new PersistentTrackCache(folderPath, true))
+            {
+                Assert.IsTrue(reader.IsReadOnly, "IsReadOnly");
+                Assert.ThrowsException<UnauthorizedAccessException>(() => reader.Add(1, CreateTracks(track)));
+
+                writer.Add(1, CreateTracks(track));
+                Assert.IsNull(reader.Lookup(1, 0), "Lookup before Refresh");
+
+                reader.Refresh();
+                AssertTrack(track, reader.Lookup(1, 0)[0]);
+            }
+        }
+
+        /// <summary>
+        /// Test expired tracks are not returned.
+        /// </summary>
+        [TestMethod]
+        public void PersistentTrackCacheExpired()
+        {
+            using (PersistentTrackCache cache = new PersistentTrackCache(CreateFolderPath(), false))
+            {
+                cache.Add(1, CreateTracks(MockTrack.CreateRandom()));
+                cache.MaximumAge = TimeSpan.Zero;
+                Assert.IsNull(cache.Lookup(1, 0), "Lookup");
+            }
+        }
+
+        /// <summary>
+        /// Create a folder for a cache.
+        /// </summary>
+        /// <returns>The folder path.</returns>
+        private static string CreateFolderPath()
+        {
+            return Path.Combine(ApplicationData.Current.LocalFolder.Path, Guid.NewGuid().ToString());
+        }
+
+        /// <summary>
+        /// Create a list of tracks.
+        /// </summary>
+        /// <param name="track">The track.</param>
+        /// <returns>The tracks.</returns>
+        private static IReadOnlyList<IReadOnlyTrack> CreateTracks(IReadOnlyTrack track)
+        {
+            return new List<IReadOnlyTrack>() { track }.AsReadOnly();
+        }
+
+        /// <summary>
+        /// Assert two tracks are the same.
+        /// </summary>
+        /// <param name="expected">The expected track.</param>
+        /// <param name="actual">The actual track.</param>
+        private static void AssertTrack(IReadOnlyTrack expected, IReadOnlyTrack actual)
+        {
+            Assert.IsNotNull(actual, "track");
+            Assert.AreEqual(expected.Identifier, actual.Identifier, "Identifier");
+            Assert.AreEqual(expected.Title, actual.Title, "Title");
+            Assert.AreEqual(expected.Artist, actual.Artist, "Artist");
+            Assert.AreEqual(expected.Album, actual.Album, "Album");
+            Assert.AreEqual(expected.Genre, actual.Genre, "Genre");
+            Assert.AreEqual(expected.CovertArtImage, actual.CovertArtImage, "CovertArtImage");
+            Assert.AreEqual(expected.MatchConfidence, actual.MatchConfidence, "MatchConfidence");
+            Assert.AreEqual(expected.Duration, actual.Duration, "Duration");
+            Assert.AreEqual(expected.MatchPosition, actual.MatchPosition, "MatchPosition");
+            Assert.AreEqual(expected.CurrentPosition, actual.CurrentPosition, "CurrentPosition");
+        }
+    }
+}
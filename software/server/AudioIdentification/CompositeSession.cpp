@@ -0,0 +1,401 @@
+//-----------------------------------------------------------------------
+// <copyright file="CompositeSession.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "CompositeSession.h"
+
+using namespace concurrency;
+using namespace Platform;
+using namespace Platform::Collections;
+using namespace Windows::Foundation;
+using namespace Windows::Foundation::Collections;
+using namespace CrazyGiraffe::AudioIdentification;
+
+namespace
+{
+    // Case-insensitive comparison; a null string is empty.
+    bool EqualsIgnoreCase(String^ left, String^ right)
+    {
+        const wchar_t* leftData = (left == nullptr) ? L"" : left->Data();
+        const wchar_t* rightData = (right == nullptr) ? L"" : right->Data();
+        return CompareStringOrdinal(leftData, -1, rightData, -1, TRUE) == CSTR_EQUAL;
+    }
+}
+
+CompositeSession::CompositeSession(
+    const std::vector<ISession^>& sessions,
+    double minimumConfidence,
+    bool acceptUnratedMatches,
+    bool requireConfirmation)
+    : m_sessionId(Session::CreateSessionIdentifier())
+    , m_status(IdentifyStatus::Invalid)
+    , m_backends()
+    , m_minimumConfidence(minimumConfidence)
+    , m_acceptUnratedMatches(acceptUnratedMatches)
+    , m_requireConfirmation(requireConfirmation)
+    , m_candidateIndex(-1)
+    , m_candidateTracks(nullptr)
+    , m_winnerIndex(-1)
+    , m_winnerSession(nullptr)
+    , m_confirmed(false)
+    , m_startTime(std::chrono::steady_clock::now())
+    , m_winnerLatency(0)
+    , m_tracks((ref new Vector<IReadOnlyTrack^>())->GetView())
+{
+    m_backends.reserve(sessions.size());
+    for (ISession^ session : sessions)
+    {
+        Backend backend = { session, { 0 }, false };
+        m_backends.push_back(backend);
+    }
+
+    for (size_t i = 0; i < m_backends.size(); i++)
+    {
+        SubscribeBackend(i);
+    }
+}
+
+String^ CompositeSession::SessionIdentifier::get()
+{
+    return m_sessionId;
+}
+
+IdentifyStatus CompositeSession::IdentificationStatus::get()
+{
+    return m_status;
+}
+
+int32 CompositeSession::WinningBackendIndex::get()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_winnerIndex;
+}
+
+ISession^ CompositeSession::WinningSession::get()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_winnerSession;
+}
+
+TimeSpan CompositeSession::WinningLatency::get()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    // TimeSpan is expressed in 100-nanosecond units.
+    TimeSpan latency = { 0 };
+    latency.Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(m_winnerLatency).count() / 100;
+    return latency;
+}
+
+bool CompositeSession::IsConfirmed::get()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_confirmed;
+}
+
+void CompositeSession::AddAudioSample(const Array<byte>^ audioData)
+{
+    if (m_status == IdentifyStatus::Complete || m_status == IdentifyStatus::Error)
+    {
+        return;
+    }
+
+    // Take the backends still racing; they may finish while the sample is forwarded.
+    std::vector<ISession^> sessions;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_status == IdentifyStatus::Invalid)
+        {
+            m_startTime = std::chrono::steady_clock::now();
+        }
+
+        sessions.reserve(m_backends.size());
+        for (const Backend& backend : m_backends)
+        {
+            if (backend.session != nullptr && !backend.finished)
+            {
+                sessions.push_back(backend.session);
+            }
+        }
+    }
+
+    // Only from Invalid: a backend may have set a final status since, which must not go back to Incomplete.
+    IdentifyStatus expectedStatus = IdentifyStatus::Invalid;
+    if (m_status.compare_exchange_strong(expectedStatus, IdentifyStatus::Incomplete))
+    {
+        StatusChangedEventArgs^ eventArgs = ref new StatusChangedEventArgs(IdentifyStatus::Incomplete);
+        StatusChanged(this, eventArgs);
+    }
+
+    // Every backend gets the same array; nothing is copied here.
+    for (ISession^ session : sessions)
+    {
+        session->AddAudioSample(audioData);
+    }
+}
+
+IAsyncOperation<IVectorView<IReadOnlyTrack^>^>^ CompositeSession::GetTracksAsync()
+{
+    // E1740 error - [this] seems to be an error but it's a bug in VS2019.
+    // It will show as an error in the editor and during a failed compilation
+    // but will compile cleanly. Move along, nothing to see here.
+    return create_async([this]() -> task<IVectorView<IReadOnlyTrack^>^>
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return task_from_result(m_tracks);
+        });
+}
+
+void CompositeSession::SubscribeBackend(size_t index)
+{
+    // Backends must not keep this session alive.
+    WeakReference weakThis(this);
+    m_backends[index].statusChangedToken = m_backends[index].session->StatusChanged +=
+        ref new StatusChangedEventHandler([weakThis, index](Object^ sender, StatusChangedEventArgs^ eventArgs)
+        {
+            CompositeSession^ that = weakThis.Resolve<CompositeSession>();
+            if (that != nullptr)
+            {
+                that->OnBackendStatusChanged(index, eventArgs->Status);
+            }
+        });
+}
+
+void CompositeSession::OnBackendStatusChanged(size_t index, IdentifyStatus status)
+{
+    if (status == IdentifyStatus::Error)
+    {
+        OnBackendResult(index, nullptr);
+        return;
+    }
+
+    if (status != IdentifyStatus::Complete)
+    {
+        return;
+    }
+
+    ISession^ session;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        session = m_backends[index].session;
+    }
+
+    if (session == nullptr)
+    {
+        return;
+    }
+
+    WeakReference weakThis(this);
+    create_task(session->GetTracksAsync())
+        .then([weakThis, index](task<IVectorView<IReadOnlyTrack^>^> previousTask)
+        {
+            IVectorView<IReadOnlyTrack^>^ tracks = nullptr;
+            try
+            {
+                tracks = previousTask.get();
+            }
+            catch (Exception^)
+            {
+                // Treated as a failed backend.
+            }
+
+            CompositeSession^ that = weakThis.Resolve<CompositeSession>();
+            if (that != nullptr)
+            {
+                that->OnBackendResult(index, tracks);
+            }
+        }, task_continuation_context::use_arbitrary());
+}
+
+void CompositeSession::OnBackendResult(size_t index, IVectorView<IReadOnlyTrack^>^ tracks)
+{
+    IdentifyStatus newStatus = IdentifyStatus::Invalid;
+    std::vector<ISession^> droppedSessions;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_winnerIndex >= 0 || m_backends[index].finished)
+        {
+            return;
+        }
+
+        m_backends[index].finished = true;
+        bool confident = (tracks != nullptr) && IsConfident(tracks);
+        if (!confident)
+        {
+            // Nothing more to come from it.
+            DropBackend(index, droppedSessions);
+        }
+
+        if (confident && (!m_requireConfirmation || m_backends.size() == 1))
+        {
+            // First confident match wins.
+            ChooseResult(index, tracks, false, droppedSessions);
+            newStatus = IdentifyStatus::Complete;
+        }
+        else if (confident && m_candidateIndex < 0)
+        {
+            // Hold it until a second backend agrees.
+            m_candidateIndex = static_cast<int32>(index);
+            m_candidateTracks = tracks;
+            if (AllOthersFinished(index))
+            {
+                ChooseResult(index, tracks, false, droppedSessions);
+                newStatus = IdentifyStatus::Complete;
+            }
+        }
+        else if (confident && IsSameTrack(m_candidateTracks, tracks))
+        {
+            ChooseResult(m_candidateIndex, m_candidateTracks, true, droppedSessions);
+            newStatus = IdentifyStatus::Complete;
+        }
+        else if (m_candidateIndex >= 0)
+        {
+            // No confirmation coming; use the first result.
+            if (AllOthersFinished(m_candidateIndex))
+            {
+                ChooseResult(m_candidateIndex, m_candidateTracks, false, droppedSessions);
+                newStatus = IdentifyStatus::Complete;
+            }
+        }
+        else if (AllOthersFinished(index))
+        {
+            // Every backend failed or found nothing confident.
+            for (size_t i = 0; i < m_backends.size(); i++)
+            {
+                DropBackend(i, droppedSessions);
+            }
+
+            newStatus = IdentifyStatus::Error;
+        }
+    }
+
+    CloseSessions(droppedSessions);
+
+    if (newStatus != IdentifyStatus::Invalid)
+    {
+        UpdateStatus(newStatus);
+    }
+}
+
+bool CompositeSession::IsConfident(IVectorView<IReadOnlyTrack^>^ tracks)
+{
+    for (IReadOnlyTrack^ track : tracks)
+    {
+        String^ confidence = track->MatchConfidence;
+        if (confidence == nullptr || confidence->IsEmpty())
+        {
+            if (m_acceptUnratedMatches)
+            {
+                return true;
+            }
+
+            continue;
+        }
+
+        wchar_t* end = nullptr;
+        double value = wcstod(confidence->Data(), &end);
+        bool isNumeric = (end != confidence->Data()) && (*end == L'\0');
+        if (isNumeric ? (value >= m_minimumConfidence) : m_acceptUnratedMatches)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* static */
+bool CompositeSession::IsSameTrack(IVectorView<IReadOnlyTrack^>^ left, IVectorView<IReadOnlyTrack^>^ right)
+{
+    for (IReadOnlyTrack^ leftTrack : left)
+    {
+        for (IReadOnlyTrack^ rightTrack : right)
+        {
+            if (EqualsIgnoreCase(leftTrack->Title, rightTrack->Title) &&
+                EqualsIgnoreCase(leftTrack->Artist, rightTrack->Artist))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool CompositeSession::AllOthersFinished(size_t index)
+{
+    for (size_t i = 0; i < m_backends.size(); i++)
+    {
+        if (i != index && !m_backends[i].finished)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CompositeSession::ChooseResult(
+    size_t index,
+    IVectorView<IReadOnlyTrack^>^ tracks,
+    bool confirmed,
+    std::vector<ISession^>& droppedSessions)
+{
+    m_winnerIndex = static_cast<int32>(index);
+    m_winnerSession = m_backends[index].session;
+    m_winnerLatency = std::chrono::steady_clock::now() - m_startTime;
+    m_confirmed = confirmed;
+    m_tracks = tracks;
+    m_candidateTracks = nullptr;
+
+    // Stop feeding the slower backends and let them go.
+    for (size_t i = 0; i < m_backends.size(); i++)
+    {
+        DropBackend(i, droppedSessions);
+    }
+}
+
+void CompositeSession::DropBackend(size_t index, std::vector<ISession^>& droppedSessions)
+{
+    Backend& backend = m_backends[index];
+    if (backend.session != nullptr)
+    {
+        backend.session->StatusChanged -= backend.statusChangedToken;
+        if (backend.session != m_winnerSession)
+        {
+            droppedSessions.push_back(backend.session);
+        }
+
+        backend.session = nullptr;
+    }
+
+    backend.finished = true;
+}
+
+/* static */
+void CompositeSession::CloseSessions(const std::vector<ISession^>& sessions)
+{
+    for (ISession^ session : sessions)
+    {
+        IClosable^ closable = dynamic_cast<IClosable^>(session);
+        if (closable != nullptr)
+        {
+            // Calls Close.
+            delete closable;
+        }
+    }
+}
+
+void CompositeSession::UpdateStatus(IdentifyStatus newStatus)
+{
+    // Update.
+    IdentifyStatus oldStatus = m_status.exchange(newStatus);
+    if (oldStatus != newStatus)
+    {
+        StatusChangedEventArgs^ eventArgs = ref new StatusChangedEventArgs(newStatus);
+        StatusChanged(this, eventArgs);
+    }
+}
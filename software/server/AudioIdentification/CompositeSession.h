@@ -0,0 +1,252 @@
+//-----------------------------------------------------------------------
+// <copyright file="CompositeSession.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "Session.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace CrazyGiraffe { namespace AudioIdentification
+{
+    /// <summary>
+    /// Session which races several backend sessions for the same audio.
+    /// </summary>
+    public ref class CompositeSession sealed : ISession
+    {
+    public:
+        /// <summary>
+        /// Event handler for status changed.
+        /// </summary>
+        virtual event StatusChangedEventHandler^ StatusChanged;
+
+        /// <summary>
+        /// Gets the identifier for the session.
+        /// </summary>
+        virtual property Platform::String^ SessionIdentifier
+        {
+            Platform::String^ get();
+        }
+
+        /// <summary>
+        /// Gets the sample status.
+        /// </summary>
+        virtual property IdentifyStatus IdentificationStatus
+        {
+            IdentifyStatus get();
+        }
+
+        /// <summary>
+        /// Gets the index of the backend whose result was chosen, or -1.
+        /// </summary>
+        property int32 WinningBackendIndex
+        {
+            int32 get();
+        }
+
+        /// <summary>
+        /// Gets the backend session whose result was chosen, or null.
+        /// </summary>
+        property CrazyGiraffe::AudioIdentification::ISession^ WinningSession
+        {
+            CrazyGiraffe::AudioIdentification::ISession^ get();
+        }
+
+        /// <summary>
+        /// Gets the time from the first audio sample to the chosen result.
+        /// </summary>
+        property Windows::Foundation::TimeSpan WinningLatency
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets a value indicating whether a second backend agreed with the chosen result.
+        /// </summary>
+        property bool IsConfirmed
+        {
+            bool get();
+        }
+
+        /// <summary>
+        /// Add an audio sample for fingerprint. The same buffer is passed to every backend still racing.
+        /// </summary>
+        /// <param name="audioData">audio data as byte array</param>
+        virtual void AddAudioSample(const Platform::Array<byte>^ audioData);
+
+        /// <summary>
+        /// Gets the identified track(s).
+        /// </summary>
+        virtual Windows::Foundation::IAsyncOperation<Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^>^
+            GetTracksAsync();
+
+    internal:
+        /// <summary>
+        /// Create an instance of the <see cref="CompositeSession" /> class.
+        /// </summary>
+        /// <param name="sessions">The backend sessions.</param>
+        /// <param name="minimumConfidence">The lowest match confidence accepted.</param>
+        /// <param name="acceptUnratedMatches">True to accept tracks without a numeric confidence.</param>
+        /// <param name="requireConfirmation">True to wait for a second backend to agree.</param>
+        CompositeSession(
+            const std::vector<CrazyGiraffe::AudioIdentification::ISession^>& sessions,
+            double minimumConfidence,
+            bool acceptUnratedMatches,
+            bool requireConfirmation);
+
+    private:
+        ///
+        /// A backend session.
+        ///
+        struct Backend
+        {
+            CrazyGiraffe::AudioIdentification::ISession^ session;
+            Windows::Foundation::EventRegistrationToken statusChangedToken;
+            bool finished;
+        };
+
+        ///
+        /// Listen to the status of a backend.
+        ///
+        void SubscribeBackend(size_t index);
+
+        ///
+        /// Handle a status change from a backend.
+        ///
+        void OnBackendStatusChanged(size_t index, CrazyGiraffe::AudioIdentification::IdentifyStatus status);
+
+        ///
+        /// Handle the tracks from a backend, or null if it failed.
+        ///
+        void OnBackendResult(
+            size_t index,
+            Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^ tracks);
+
+        ///
+        /// Check if the tracks are a confident match. A track without a numeric confidence is only
+        /// confident if unrated matches are accepted.
+        ///
+        bool IsConfident(Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^ tracks);
+
+        ///
+        /// Check if two results are the same track.
+        ///
+        static bool IsSameTrack(
+            Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^ left,
+            Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^ right);
+
+        ///
+        /// Check if all backends other than the candidate have finished. m_lock must be held.
+        ///
+        bool AllOthersFinished(size_t index);
+
+        ///
+        /// Choose a result and drop the other backends. m_lock must be held; the caller sends the status
+        /// and closes the dropped sessions.
+        ///
+        void ChooseResult(
+            size_t index,
+            Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^ tracks,
+            bool confirmed,
+            std::vector<CrazyGiraffe::AudioIdentification::ISession^>& droppedSessions);
+
+        ///
+        /// Stop listening to a backend and hand it to the caller to close, unless it's the winner.
+        /// m_lock must be held.
+        ///
+        void DropBackend(size_t index, std::vector<CrazyGiraffe::AudioIdentification::ISession^>& droppedSessions);
+
+        ///
+        /// Close dropped sessions, which cancels their queries in flight. ISession has no way to cancel,
+        /// so this relies on backends which implement IClosable; others are just released.
+        /// m_lock must not be held, as closing may wait for the backend.
+        ///
+        static void CloseSessions(const std::vector<CrazyGiraffe::AudioIdentification::ISession^>& sessions);
+
+        ///
+        /// Update to a final status and send notifications.
+        ///
+        void UpdateStatus(CrazyGiraffe::AudioIdentification::IdentifyStatus newStatus);
+
+    private:
+        ///
+        /// The session id.
+        ///
+        Platform::String^ m_sessionId;
+
+        /// <summary>
+        /// The status of the session.
+        /// </summary>
+        std::atomic<CrazyGiraffe::AudioIdentification::IdentifyStatus> m_status;
+
+        ///
+        /// The backend sessions. Dropped backends have a null session.
+        ///
+        std::vector<Backend> m_backends;
+
+        ///
+        /// The lowest match confidence accepted.
+        ///
+        double m_minimumConfidence;
+
+        ///
+        /// True to accept tracks without a numeric confidence.
+        ///
+        bool m_acceptUnratedMatches;
+
+        ///
+        /// True to wait for a second backend to agree.
+        ///
+        bool m_requireConfirmation;
+
+        ///
+        /// The first result, waiting for confirmation, or -1.
+        ///
+        int32 m_candidateIndex;
+
+        ///
+        /// The tracks of the first result, waiting for confirmation.
+        ///
+        Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^ m_candidateTracks;
+
+        ///
+        /// The chosen backend, or -1.
+        ///
+        int32 m_winnerIndex;
+
+        ///
+        /// The chosen backend session.
+        ///
+        CrazyGiraffe::AudioIdentification::ISession^ m_winnerSession;
+
+        ///
+        /// True if a second backend agreed with the chosen result.
+        ///
+        bool m_confirmed;
+
+        ///
+        /// The time of the first audio sample.
+        ///
+        std::chrono::steady_clock::time_point m_startTime;
+
+        ///
+        /// The time from the first audio sample to the chosen result.
+        ///
+        std::chrono::steady_clock::duration m_winnerLatency;
+
+        ///
+        /// The identified tracks.
+        ///
+        Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^ m_tracks;
+
+        ///
+        /// Lock for the backends and the result.
+        ///
+        std::mutex m_lock;
+    };
+} }
@@ -0,0 +1,124 @@
+//-----------------------------------------------------------------------
+// <copyright file="CompositeSessionFactory.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "CompositeSessionFactory.h"
+
+using namespace concurrency;
+using namespace Platform;
+using namespace Platform::Collections;
+using namespace Windows::Foundation;
+using namespace Windows::Foundation::Collections;
+using namespace CrazyGiraffe::AudioIdentification;
+
+CompositeSessionFactory::CompositeSessionFactory(IIterable<ISessionFactory^>^ factories)
+    : m_factories(ref new Vector<ISessionFactory^>())
+    , m_minimumConfidence(0.0)
+    , m_acceptUnratedMatches(false)
+    , m_requireConfirmation(false)
+{
+    if (factories == nullptr)
+    {
+        throw ref new InvalidArgumentException("factories");
+    }
+
+    for (ISessionFactory^ factory : factories)
+    {
+        if (factory == nullptr)
+        {
+            throw ref new InvalidArgumentException("factories");
+        }
+
+        m_factories->Append(factory);
+    }
+
+    if (m_factories->Size == 0)
+    {
+        throw ref new InvalidArgumentException("factories");
+    }
+}
+
+IVectorView<ISessionFactory^>^ CompositeSessionFactory::Factories::get()
+{
+    return m_factories->GetView();
+}
+
+double CompositeSessionFactory::MinimumConfidence::get()
+{
+    return m_minimumConfidence;
+}
+
+void CompositeSessionFactory::MinimumConfidence::set(double value)
+{
+    m_minimumConfidence = value;
+}
+
+bool CompositeSessionFactory::AcceptUnratedMatches::get()
+{
+    return m_acceptUnratedMatches;
+}
+
+void CompositeSessionFactory::AcceptUnratedMatches::set(bool value)
+{
+    m_acceptUnratedMatches = value;
+}
+
+bool CompositeSessionFactory::RequireConfirmation::get()
+{
+    return m_requireConfirmation;
+}
+
+void CompositeSessionFactory::RequireConfirmation::set(bool value)
+{
+    m_requireConfirmation = value;
+}
+
+IAsyncOperation<ISession^>^ CompositeSessionFactory::CreateSessionAsync(SessionOptions^ options)
+{
+    // Create the backend sessions in parallel; a backend which can't create one is left out.
+    std::vector<task<ISession^>> sessionTasks;
+    for (ISessionFactory^ factory : m_factories)
+    {
+        sessionTasks.push_back(create_task(factory->CreateSessionAsync(options))
+            .then([](task<ISession^> previousTask) -> ISession^
+            {
+                try
+                {
+                    return previousTask.get();
+                }
+                catch (Exception^)
+                {
+                    return nullptr;
+                }
+            }, task_continuation_context::use_arbitrary()));
+    }
+
+    double minimumConfidence = m_minimumConfidence;
+    bool acceptUnratedMatches = m_acceptUnratedMatches;
+    bool requireConfirmation = m_requireConfirmation;
+    return create_async([sessionTasks, minimumConfidence, acceptUnratedMatches, requireConfirmation]() -> task<ISession^>
+        {
+            return when_all(sessionTasks.begin(), sessionTasks.end())
+                .then([minimumConfidence, acceptUnratedMatches, requireConfirmation](std::vector<ISession^> results) -> ISession^
+                {
+                    std::vector<ISession^> sessions;
+                    for (ISession^ session : results)
+                    {
+                        if (session != nullptr)
+                        {
+                            sessions.push_back(session);
+                        }
+                    }
+
+                    if (sessions.empty())
+                    {
+                        throw ref new FailureException("No backend session could be created.");
+                    }
+
+                    return ref new CompositeSession(sessions, minimumConfidence, acceptUnratedMatches, requireConfirmation);
+                }, task_continuation_context::use_arbitrary());
+        });
+}
@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------
+// <copyright file="CompositeSessionFactory.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+#include "CompositeSession.h"
+#include "SessionFactory.h"
+
+namespace CrazyGiraffe { namespace AudioIdentification
+{
+    /// <summary>
+    /// Session factory which races the sessions of several backend factories.
+    /// </summary>
+    public ref class CompositeSessionFactory sealed : public ISessionFactory
+    {
+    public:
+        /// <summary>
+        /// Create an instance of the <see cref="CompositeSessionFactory" /> class.
+        /// </summary>
+        /// <param name="factories">The backend factories.</param>
+        CompositeSessionFactory(Windows::Foundation::Collections::IIterable<CrazyGiraffe::AudioIdentification::ISessionFactory^>^ factories);
+
+        /// <summary>
+        /// Gets the backend factories.
+        /// </summary>
+        property Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::ISessionFactory^>^ Factories
+        {
+            Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::ISessionFactory^>^ get();
+        }
+
+        /// <summary>
+        /// Gets or sets the lowest match confidence accepted.
+        /// </summary>
+        property double MinimumConfidence
+        {
+            double get();
+            void set(double value);
+        }
+
+        /// <summary>
+        /// Gets or sets a value indicating whether tracks without a numeric confidence are accepted.
+        /// Off by default, so a backend which doesn't rate its matches can't win the race.
+        /// </summary>
+        property bool AcceptUnratedMatches
+        {
+            bool get();
+            void set(bool value);
+        }
+
+        /// <summary>
+        /// Gets or sets a value indicating whether a second backend must agree with the first result.
+        /// The first result is used anyway once every other backend has finished.
+        /// </summary>
+        property bool RequireConfirmation
+        {
+            bool get();
+            void set(bool value);
+        }
+
+        /// <summary>
+        /// Create a new session to identify a track.
+        /// </summary>
+        /// <param name="options">Options for the session.</param>
+        /// <returns>A new session to identify a track.</returns>
+        virtual Windows::Foundation::IAsyncOperation<CrazyGiraffe::AudioIdentification::ISession^>^
+            CreateSessionAsync(CrazyGiraffe::AudioIdentification::SessionOptions^ options);
+
+    private:
+        ///
+        /// The backend factories.
+        ///
+        Platform::Collections::Vector<CrazyGiraffe::AudioIdentification::ISessionFactory^>^ m_factories;
+
+        ///
+        /// The lowest match confidence accepted.
+        ///
+        double m_minimumConfidence;
+
+        ///
+        /// True to accept tracks without a numeric confidence.
+        ///
+        bool m_acceptUnratedMatches;
+
+        ///
+        /// True if a second backend must agree with the first result.
+        ///
+        bool m_requireConfirmation;
+    };
+} }
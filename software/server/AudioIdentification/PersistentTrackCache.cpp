@@ -0,0 +1,861 @@
+//-----------------------------------------------------------------------
+// <copyright file="PersistentTrackCache.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "PersistentTrackCache.h"
+#include <algorithm>
+#include <fileapifromapp.h>
+
+using namespace Platform;
+using namespace Platform::Collections;
+using namespace Windows::Foundation;
+using namespace Windows::Foundation::Collections;
+using namespace CrazyGiraffe::AudioIdentification;
+
+namespace
+{
+    //
+    // File layout, all values little-endian:
+    //
+    // tracks.log    LogHeader, then records. A record is a RecordHeader followed by
+    //               the payload, padded to 8 bytes. Records are only ever appended.
+    // tracks.idx    IndexHeader, then IndexEntry[count] sorted by digest, then for each
+    //               of the BandCount bands a BandEntry[count] sorted by key. The index
+    //               covers the log up to IndexHeader::logSize; records after that are
+    //               scanned when the cache is opened.
+    //
+    // Payload:      uint32 trackCount, then per track the strings Identifier, Title,
+    //               Artist, Album, Genre, CovertArtImage and MatchConfidence (each a
+    //               uint32 character count and UTF-16 characters) and the int32 values
+    //               Duration, MatchPosition and CurrentPosition.
+    //
+    const wchar_t* LogFileName = L"tracks.log";
+    const wchar_t* IndexFileName = L"tracks.idx";
+    const wchar_t* IndexTempFileName = L"tracks.idx.tmp";
+
+    const uint32_t LogMagic = 0x474C4354;      // "TCLG"
+    const uint32_t IndexMagic = 0x58494354;    // "TCIX"
+    const uint32_t FormatVersion = 1;
+    const uint32_t IndexVersion = 2;
+
+    // Digests are split into bands of this many bits to find near matches. Two digests
+    // within (BandCount - 1) bits of each other share at least one band.
+    const unsigned int BandBits = 16;
+    const unsigned int BandCount = 64 / BandBits;
+
+    // Rewrite the index once this many records are outside of it.
+    const size_t CompactionThreshold = 256;
+
+    // Results older than this are ignored, in 100-nanosecond units.
+    const int64_t DefaultMaximumAge = 30LL * 24 * 60 * 60 * 10000000;
+
+    struct LogHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+    };
+
+    struct RecordHeader
+    {
+        uint32_t size;
+        uint32_t checksum;
+        uint64_t digest;
+        int64_t timestamp;
+    };
+
+    struct IndexHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t logSize;
+        uint64_t count;
+    };
+
+    uint64_t Align(uint64_t size)
+    {
+        return (size + 7) & ~7ULL;
+    }
+
+    // FNV-1a, 32 bits.
+    uint32_t Checksum(const uint8_t* data, size_t size)
+    {
+        uint32_t hash = 2166136261U;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= data[i];
+            hash *= 16777619U;
+        }
+
+        return hash;
+    }
+
+    uint32_t BandValue(uint64_t digest, unsigned int band)
+    {
+        return static_cast<uint32_t>((digest >> (band * BandBits)) & ((1ULL << BandBits) - 1));
+    }
+
+    uint32_t TailBandKey(uint64_t digest, unsigned int band)
+    {
+        return (band << BandBits) | BandValue(digest, band);
+    }
+
+    unsigned int BitCount(uint64_t value)
+    {
+        unsigned int count = 0;
+        while (value != 0)
+        {
+            value &= value - 1;
+            count++;
+        }
+
+        return count;
+    }
+
+    int64_t GetFileTimeNow()
+    {
+        FILETIME fileTime;
+        GetSystemTimeAsFileTime(&fileTime);
+        return (static_cast<int64_t>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime;
+    }
+
+    void ThrowLastError()
+    {
+        throw Exception::CreateException(HRESULT_FROM_WIN32(GetLastError()));
+    }
+
+    void WriteValue(std::vector<uint8_t>& buffer, const void* value, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(value);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    void WriteString(std::vector<uint8_t>& buffer, String^ value)
+    {
+        uint32_t length = value != nullptr ? value->Length() : 0;
+        WriteValue(buffer, &length, sizeof(length));
+        if (length > 0)
+        {
+            WriteValue(buffer, value->Data(), length * sizeof(wchar_t));
+        }
+    }
+
+    bool ReadValue(const uint8_t*& data, const uint8_t* end, void* value, size_t size)
+    {
+        if (static_cast<size_t>(end - data) < size)
+        {
+            return false;
+        }
+
+        memcpy(value, data, size);
+        data += size;
+        return true;
+    }
+
+    bool ReadString(const uint8_t*& data, const uint8_t* end, String^& value)
+    {
+        uint32_t length = 0;
+        if (!ReadValue(data, end, &length, sizeof(length)) ||
+            static_cast<size_t>(end - data) / sizeof(wchar_t) < length)
+        {
+            return false;
+        }
+
+        std::wstring text(length, L'\0');
+        memcpy(&text[0], data, length * sizeof(wchar_t));
+        data += length * sizeof(wchar_t);
+        value = length > 0 ? ref new String(text.c_str(), length) : nullptr;
+        return true;
+    }
+
+    std::vector<uint8_t> SerializeRecord(uint64_t digest, IVectorView<IReadOnlyTrack^>^ tracks)
+    {
+        std::vector<uint8_t> record(sizeof(RecordHeader));
+
+        uint32_t trackCount = tracks->Size;
+        WriteValue(record, &trackCount, sizeof(trackCount));
+        for (IReadOnlyTrack^ track : tracks)
+        {
+            WriteString(record, track->Identifier);
+            WriteString(record, track->Title);
+            WriteString(record, track->Artist);
+            WriteString(record, track->Album);
+            WriteString(record, track->Genre);
+            WriteString(record, track->CovertArtImage != nullptr ? track->CovertArtImage->AbsoluteUri : nullptr);
+            WriteString(record, track->MatchConfidence);
+
+            int32_t duration = track->Duration;
+            int32_t matchPosition = track->MatchPosition;
+            int32_t currentPosition = track->CurrentPosition;
+            WriteValue(record, &duration, sizeof(duration));
+            WriteValue(record, &matchPosition, sizeof(matchPosition));
+            WriteValue(record, &currentPosition, sizeof(currentPosition));
+        }
+
+        size_t payloadSize = record.size() - sizeof(RecordHeader);
+        record.resize(sizeof(RecordHeader) + static_cast<size_t>(Align(payloadSize)));
+
+        RecordHeader header;
+        header.size = static_cast<uint32_t>(payloadSize);
+        header.checksum = Checksum(record.data() + sizeof(RecordHeader), payloadSize);
+        header.digest = digest;
+        header.timestamp = GetFileTimeNow();
+        memcpy(record.data(), &header, sizeof(header));
+
+        return record;
+    }
+
+    IVectorView<IReadOnlyTrack^>^ DeserializeRecord(const uint8_t* record)
+    {
+        const RecordHeader* header = reinterpret_cast<const RecordHeader*>(record);
+        const uint8_t* data = record + sizeof(RecordHeader);
+        const uint8_t* end = data + header->size;
+
+        uint32_t trackCount = 0;
+        if (!ReadValue(data, end, &trackCount, sizeof(trackCount)))
+        {
+            return nullptr;
+        }
+
+        Vector<IReadOnlyTrack^>^ tracks = ref new Vector<IReadOnlyTrack^>();
+        for (uint32_t i = 0; i < trackCount; i++)
+        {
+            String^ identifier = nullptr;
+            String^ title = nullptr;
+            String^ artist = nullptr;
+            String^ album = nullptr;
+            String^ genre = nullptr;
+            String^ coverArtImage = nullptr;
+            String^ matchConfidence = nullptr;
+            int32_t duration = 0;
+            int32_t matchPosition = 0;
+            int32_t currentPosition = 0;
+
+            if (!ReadString(data, end, identifier) ||
+                !ReadString(data, end, title) ||
+                !ReadString(data, end, artist) ||
+                !ReadString(data, end, album) ||
+                !ReadString(data, end, genre) ||
+                !ReadString(data, end, coverArtImage) ||
+                !ReadString(data, end, matchConfidence) ||
+                !ReadValue(data, end, &duration, sizeof(duration)) ||
+                !ReadValue(data, end, &matchPosition, sizeof(matchPosition)) ||
+                !ReadValue(data, end, &currentPosition, sizeof(currentPosition)))
+            {
+                return nullptr;
+            }
+
+            Track^ track = ref new Track();
+            track->Identifier = identifier;
+            track->Title = title;
+            track->Artist = artist;
+            track->Album = album;
+            track->Genre = genre;
+            track->CovertArtImage = coverArtImage != nullptr ? ref new Uri(coverArtImage) : nullptr;
+            track->MatchConfidence = matchConfidence;
+            track->Duration = duration;
+            track->MatchPosition = matchPosition;
+            track->CurrentPosition = currentPosition;
+            tracks->Append(track);
+        }
+
+        return tracks->GetView();
+    }
+}
+
+PersistentTrackCache::PersistentTrackCache(String^ folderPath, bool readOnly)
+    : m_folderPath(folderPath)
+    , m_readOnly(readOnly)
+    , m_maximumAge(DefaultMaximumAge)
+    , m_log({ INVALID_HANDLE_VALUE, nullptr, nullptr, 0 })
+    , m_logSize(0)
+    , m_index({ INVALID_HANDLE_VALUE, nullptr, nullptr, 0 })
+    , m_indexedLogSize(0)
+    , m_tail()
+    , m_tailBands()
+{
+    if (folderPath == nullptr || folderPath->IsEmpty())
+    {
+        throw ref new InvalidArgumentException("folderPath");
+    }
+
+    if (!readOnly && !CreateDirectoryFromAppW(folderPath->Data(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
+    {
+        ThrowLastError();
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    OpenLog();
+    OpenIndex();
+    ScanLog();
+}
+
+PersistentTrackCache::~PersistentTrackCache()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    CloseIndex();
+
+    UnmapFile(m_log);
+    if (m_log.file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_log.file);
+        m_log.file = INVALID_HANDLE_VALUE;
+    }
+}
+
+String^ PersistentTrackCache::FolderPath::get()
+{
+    return m_folderPath;
+}
+
+bool PersistentTrackCache::IsReadOnly::get()
+{
+    return m_readOnly;
+}
+
+uint32 PersistentTrackCache::Count::get()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    uint64_t count = 0;
+    GetIndexEntries(count);
+    for (auto& entry : m_tail)
+    {
+        uint64_t offset = 0;
+        if (!FindIndexEntry(entry.first, offset))
+        {
+            count++;
+        }
+    }
+
+    return static_cast<uint32>(count);
+}
+
+TimeSpan PersistentTrackCache::MaximumAge::get()
+{
+    TimeSpan timeSpan = { 0 };
+    timeSpan.Duration = m_maximumAge;
+    return timeSpan;
+}
+
+void PersistentTrackCache::MaximumAge::set(TimeSpan value)
+{
+    m_maximumAge = value.Duration;
+}
+
+IVectorView<IReadOnlyTrack^>^ PersistentTrackCache::Lookup(uint64 digest, uint32 maximumDistance)
+{
+    // Near matches are found through the bands.
+    if (maximumDistance >= BandCount)
+    {
+        throw ref new InvalidArgumentException("maximumDistance");
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    uint64_t offset = 0;
+    if (!FindRecord(digest, maximumDistance, offset))
+    {
+        return nullptr;
+    }
+
+    const uint8_t* record = GetRecord(offset);
+    if (record == nullptr || IsExpired(record))
+    {
+        return nullptr;
+    }
+
+    return DeserializeRecord(record);
+}
+
+void PersistentTrackCache::Add(uint64 digest, IVectorView<IReadOnlyTrack^>^ tracks)
+{
+    if (m_readOnly)
+    {
+        throw ref new AccessDeniedException();
+    }
+
+    if (tracks == nullptr)
+    {
+        throw ref new InvalidArgumentException("tracks");
+    }
+
+    std::vector<uint8_t> record = SerializeRecord(digest, tracks);
+
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    // Append at the end of the valid records, overwriting anything left by a torn write.
+    OVERLAPPED overlapped = { 0 };
+    overlapped.Offset = static_cast<DWORD>(m_logSize);
+    overlapped.OffsetHigh = static_cast<DWORD>(m_logSize >> 32);
+
+    DWORD written = 0;
+    if (!WriteFile(m_log.file, record.data(), static_cast<DWORD>(record.size()), &written, &overlapped) ||
+        written != record.size())
+    {
+        ThrowLastError();
+    }
+
+    AddTailEntry(digest, m_logSize);
+    m_logSize += record.size();
+
+    if (m_tail.size() >= CompactionThreshold)
+    {
+        CompactIndex();
+    }
+}
+
+void PersistentTrackCache::Compact()
+{
+    if (m_readOnly)
+    {
+        throw ref new AccessDeniedException();
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    CompactIndex();
+}
+
+void PersistentTrackCache::Refresh()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    // The log may have grown and the index may have been replaced.
+    UnmapFile(m_log);
+    OpenLog();
+    CloseIndex();
+    OpenIndex();
+    ScanLog();
+}
+
+std::wstring PersistentTrackCache::GetFilePath(const wchar_t* fileName) const
+{
+    std::wstring path(m_folderPath->Data());
+    if (!path.empty() && path.back() != L'\\')
+    {
+        path += L'\\';
+    }
+
+    return path + fileName;
+}
+
+/* static */
+bool PersistentTrackCache::MapFile(MappedFile& mappedFile)
+{
+    LARGE_INTEGER fileSize = { 0 };
+    if (mappedFile.file == INVALID_HANDLE_VALUE ||
+        !GetFileSizeEx(mappedFile.file, &fileSize) ||
+        fileSize.QuadPart == 0)
+    {
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingFromApp(mappedFile.file, nullptr, PAGE_READONLY, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        return false;
+    }
+
+    void* view = MapViewOfFileFromApp(mapping, FILE_MAP_READ, 0, 0);
+    if (view == nullptr)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    mappedFile.mapping = mapping;
+    mappedFile.view = static_cast<const uint8_t*>(view);
+    mappedFile.size = static_cast<uint64_t>(fileSize.QuadPart);
+    return true;
+}
+
+/* static */
+void PersistentTrackCache::UnmapFile(MappedFile& mappedFile)
+{
+    if (mappedFile.view != nullptr)
+    {
+        UnmapViewOfFile(mappedFile.view);
+        mappedFile.view = nullptr;
+    }
+
+    if (mappedFile.mapping != nullptr)
+    {
+        CloseHandle(mappedFile.mapping);
+        mappedFile.mapping = nullptr;
+    }
+
+    mappedFile.size = 0;
+}
+
+void PersistentTrackCache::OpenLog()
+{
+    if (m_log.file == INVALID_HANDLE_VALUE)
+    {
+        // Only one writer: a writer shares read access only, a reader shares read and write.
+        std::wstring logPath = GetFilePath(LogFileName);
+        m_log.file = CreateFile2FromAppW(
+            logPath.c_str(),
+            m_readOnly ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE,
+            m_readOnly ? FILE_SHARE_READ | FILE_SHARE_WRITE : FILE_SHARE_READ,
+            m_readOnly ? OPEN_EXISTING : OPEN_ALWAYS,
+            nullptr);
+
+        if (m_log.file == INVALID_HANDLE_VALUE)
+        {
+            // A reader may open the cache before a writer has created it.
+            if (m_readOnly && GetLastError() == ERROR_FILE_NOT_FOUND)
+            {
+                return;
+            }
+
+            ThrowLastError();
+        }
+
+        // Start a new log if it's empty or not ours.
+        LogHeader header = { 0 };
+        DWORD read = 0;
+        if (!m_readOnly &&
+            (!ReadFile(m_log.file, &header, sizeof(header), &read, nullptr) ||
+             read != sizeof(header) ||
+             header.magic != LogMagic ||
+             header.version != FormatVersion))
+        {
+            header.magic = LogMagic;
+            header.version = FormatVersion;
+
+            LARGE_INTEGER position = { 0 };
+            DWORD written = 0;
+            if (!SetFilePointerEx(m_log.file, position, nullptr, FILE_BEGIN) ||
+                !SetEndOfFile(m_log.file) ||
+                !WriteFile(m_log.file, &header, sizeof(header), &written, nullptr))
+            {
+                ThrowLastError();
+            }
+        }
+    }
+
+    MapFile(m_log);
+}
+
+void PersistentTrackCache::OpenIndex()
+{
+    m_indexedLogSize = sizeof(LogHeader);
+
+    // Readers share delete so the writer can replace the index while it is mapped.
+    std::wstring indexPath = GetFilePath(IndexFileName);
+    m_index.file = CreateFile2FromAppW(
+        indexPath.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_DELETE,
+        OPEN_EXISTING,
+        nullptr);
+
+    if (!MapFile(m_index))
+    {
+        CloseIndex();
+        return;
+    }
+
+    // Ignore an index that doesn't match the log.
+    const IndexHeader* header = reinterpret_cast<const IndexHeader*>(m_index.view);
+    if (m_index.size < sizeof(IndexHeader) ||
+        header->magic != IndexMagic ||
+        header->version != IndexVersion ||
+        header->logSize < sizeof(LogHeader) ||
+        header->logSize > m_log.size ||
+        header->count > (m_index.size - sizeof(IndexHeader)) / (sizeof(IndexEntry) + BandCount * sizeof(BandEntry)))
+    {
+        CloseIndex();
+        return;
+    }
+
+    m_indexedLogSize = header->logSize;
+}
+
+void PersistentTrackCache::CloseIndex()
+{
+    UnmapFile(m_index);
+    if (m_index.file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_index.file);
+        m_index.file = INVALID_HANDLE_VALUE;
+    }
+}
+
+void PersistentTrackCache::CompactIndex()
+{
+    // Merge the index and the tail, the tail has the latest records.
+    uint64_t indexCount = 0;
+    const IndexEntry* indexEntries = GetIndexEntries(indexCount);
+
+    std::vector<IndexEntry> entries;
+    entries.reserve(static_cast<size_t>(indexCount) + m_tail.size());
+    for (uint64_t i = 0; i < indexCount; i++)
+    {
+        if (m_tail.find(indexEntries[i].digest) == m_tail.end())
+        {
+            entries.push_back(indexEntries[i]);
+        }
+    }
+
+    for (auto& entry : m_tail)
+    {
+        entries.push_back({ entry.first, entry.second });
+    }
+
+    // Drop expired results.
+    entries.erase(
+        std::remove_if(entries.begin(), entries.end(), [this](const IndexEntry& entry)
+            {
+                const uint8_t* record = GetRecord(entry.offset);
+                return record == nullptr || IsExpired(record);
+            }),
+        entries.end());
+
+    std::sort(entries.begin(), entries.end(), [](const IndexEntry& left, const IndexEntry& right)
+        {
+            return left.digest < right.digest;
+        });
+
+    std::vector<BandEntry> bandEntries;
+    bandEntries.reserve(entries.size() * BandCount);
+    for (unsigned int band = 0; band < BandCount; band++)
+    {
+        size_t first = bandEntries.size();
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            bandEntries.push_back({ BandValue(entries[i].digest, band), static_cast<uint32_t>(i) });
+        }
+
+        std::sort(bandEntries.begin() + first, bandEntries.end(), [](const BandEntry& left, const BandEntry& right)
+            {
+                return left.key < right.key;
+            });
+    }
+
+    // Write the new index next to the old one.
+    IndexHeader header;
+    header.magic = IndexMagic;
+    header.version = IndexVersion;
+    header.logSize = m_logSize;
+    header.count = entries.size();
+
+    std::wstring indexPath = GetFilePath(IndexFileName);
+    std::wstring indexTempPath = GetFilePath(IndexTempFileName);
+    HANDLE file = CreateFile2FromAppW(indexTempPath.c_str(), GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    DWORD written = 0;
+    DWORD entriesSize = static_cast<DWORD>(entries.size() * sizeof(IndexEntry));
+    DWORD bandEntriesSize = static_cast<DWORD>(bandEntries.size() * sizeof(BandEntry));
+    bool succeeded =
+        WriteFile(file, &header, sizeof(header), &written, nullptr) &&
+        (entriesSize == 0 || WriteFile(file, entries.data(), entriesSize, &written, nullptr)) &&
+        (bandEntriesSize == 0 || WriteFile(file, bandEntries.data(), bandEntriesSize, &written, nullptr)) &&
+        FlushFileBuffers(file);
+    CloseHandle(file);
+
+    // Swap it in. If that fails, keep the old index and the tail and try again next time.
+    if (succeeded)
+    {
+        CloseIndex();
+        succeeded =
+            ReplaceFileFromAppW(indexPath.c_str(), indexTempPath.c_str(), nullptr, REPLACEFILE_IGNORE_MERGE_ERRORS, nullptr, nullptr) ||
+            (GetLastError() == ERROR_FILE_NOT_FOUND && MoveFileFromAppW(indexTempPath.c_str(), indexPath.c_str()));
+    }
+
+    if (!succeeded)
+    {
+        DeleteFileFromAppW(indexTempPath.c_str());
+    }
+
+    // Rebuild the tail from whatever the current index covers.
+    UnmapFile(m_log);
+    MapFile(m_log);
+    CloseIndex();
+    OpenIndex();
+    ScanLog();
+}
+
+void PersistentTrackCache::ScanLog()
+{
+    m_tail.clear();
+    m_tailBands.clear();
+    m_logSize = m_indexedLogSize;
+
+    // Stop at the first incomplete or damaged record.
+    while (m_log.view != nullptr && m_logSize + sizeof(RecordHeader) <= m_log.size)
+    {
+        const RecordHeader* header = reinterpret_cast<const RecordHeader*>(m_log.view + m_logSize);
+        uint64_t recordSize = sizeof(RecordHeader) + Align(header->size);
+        if (recordSize > m_log.size - m_logSize ||
+            header->checksum != Checksum(m_log.view + m_logSize + sizeof(RecordHeader), header->size))
+        {
+            break;
+        }
+
+        AddTailEntry(header->digest, m_logSize);
+        m_logSize += recordSize;
+    }
+}
+
+bool PersistentTrackCache::FindRecord(uint64_t digest, uint32_t maximumDistance, uint64_t& offset)
+{
+    // Exact match.
+    auto tailEntry = m_tail.find(digest);
+    if (tailEntry != m_tail.end())
+    {
+        offset = tailEntry->second;
+        return true;
+    }
+
+    if (FindIndexEntry(digest, offset))
+    {
+        return true;
+    }
+
+    if (maximumDistance == 0)
+    {
+        return false;
+    }
+
+    // Near match: check the digests that share a band, the tail first as it has the latest records.
+    unsigned int bestDistance = maximumDistance + 1;
+    uint64_t indexCount = 0;
+    const IndexEntry* indexEntries = GetIndexEntries(indexCount);
+    for (unsigned int band = 0; band < BandCount; band++)
+    {
+        auto range = m_tailBands.equal_range(TailBandKey(digest, band));
+        for (auto candidate = range.first; candidate != range.second; ++candidate)
+        {
+            unsigned int distance = BitCount(candidate->second ^ digest);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                offset = m_tail[candidate->second];
+            }
+        }
+
+        uint64_t bandCount = 0;
+        const BandEntry* bandEntries = GetBandEntries(band, bandCount);
+        const BandEntry* bandEnd = bandEntries + bandCount;
+        uint32_t key = BandValue(digest, band);
+        const BandEntry* bandEntry = std::lower_bound(bandEntries, bandEnd, key, [](const BandEntry& left, uint32_t right)
+            {
+                return left.key < right;
+            });
+
+        for (; bandEntry != bandEnd && bandEntry->key == key; ++bandEntry)
+        {
+            if (bandEntry->entry >= indexCount)
+            {
+                continue;
+            }
+
+            const IndexEntry& entry = indexEntries[bandEntry->entry];
+            unsigned int distance = BitCount(entry.digest ^ digest);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                offset = entry.offset;
+            }
+        }
+    }
+
+    return bestDistance <= maximumDistance;
+}
+
+bool PersistentTrackCache::FindIndexEntry(uint64_t digest, uint64_t& offset) const
+{
+    uint64_t indexCount = 0;
+    const IndexEntry* indexEntries = GetIndexEntries(indexCount);
+    const IndexEntry* indexEnd = indexEntries + indexCount;
+
+    const IndexEntry* entry = std::lower_bound(indexEntries, indexEnd, digest, [](const IndexEntry& left, uint64_t right)
+        {
+            return left.digest < right;
+        });
+
+    if (entry == indexEnd || entry->digest != digest)
+    {
+        return false;
+    }
+
+    offset = entry->offset;
+    return true;
+}
+
+const uint8_t* PersistentTrackCache::GetRecord(uint64_t offset)
+{
+    // Records appended since the log was mapped need a new view.
+    if (offset + sizeof(RecordHeader) > m_log.size)
+    {
+        UnmapFile(m_log);
+        MapFile(m_log);
+    }
+
+    if (m_log.view == nullptr || offset < sizeof(LogHeader) || offset + sizeof(RecordHeader) > m_log.size)
+    {
+        return nullptr;
+    }
+
+    const uint8_t* record = m_log.view + offset;
+    const RecordHeader* header = reinterpret_cast<const RecordHeader*>(record);
+    if (header->size > m_log.size - offset - sizeof(RecordHeader) ||
+        header->checksum != Checksum(record + sizeof(RecordHeader), header->size))
+    {
+        return nullptr;
+    }
+
+    return record;
+}
+
+const PersistentTrackCache::IndexEntry* PersistentTrackCache::GetIndexEntries(uint64_t& count) const
+{
+    if (m_index.view == nullptr)
+    {
+        count = 0;
+        return nullptr;
+    }
+
+    count = reinterpret_cast<const IndexHeader*>(m_index.view)->count;
+    return reinterpret_cast<const IndexEntry*>(m_index.view + sizeof(IndexHeader));
+}
+
+const PersistentTrackCache::BandEntry* PersistentTrackCache::GetBandEntries(unsigned int band, uint64_t& count) const
+{
+    const IndexEntry* indexEntries = GetIndexEntries(count);
+    if (indexEntries == nullptr)
+    {
+        return nullptr;
+    }
+
+    return reinterpret_cast<const BandEntry*>(indexEntries + count) + band * count;
+}
+
+void PersistentTrackCache::AddTailEntry(uint64_t digest, uint64_t offset)
+{
+    // A digest written again only moves to the newer record.
+    auto inserted = m_tail.emplace(digest, offset);
+    if (!inserted.second)
+    {
+        inserted.first->second = offset;
+        return;
+    }
+
+    for (unsigned int band = 0; band < BandCount; band++)
+    {
+        m_tailBands.emplace(TailBandKey(digest, band), digest);
+    }
+}
+
+bool PersistentTrackCache::IsExpired(const uint8_t* record) const
+{
+    const RecordHeader* header = reinterpret_cast<const RecordHeader*>(record);
+    return header->timestamp + m_maximumAge < GetFileTimeNow();
+}
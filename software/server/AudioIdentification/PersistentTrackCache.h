@@ -0,0 +1,259 @@
+//-----------------------------------------------------------------------
+// <copyright file="PersistentTrackCache.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "Track.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CrazyGiraffe { namespace AudioIdentification
+{
+    /// <summary>
+    /// On-disk cache of identified tracks keyed on a 64-bit fingerprint digest.
+    /// </summary>
+    /// <remarks>
+    /// The cache is an append-only log of results plus a compacted index sorted by digest.
+    /// Both files are memory-mapped when the cache is opened so a restarted process is warm
+    /// immediately. One process opens the cache for writing; any number of processes may
+    /// open it read-only at the same time.
+    /// </remarks>
+    public ref class PersistentTrackCache sealed
+    {
+    public:
+        /// <summary>
+        /// Open or create an instance of the <see cref="PersistentTrackCache" /> class.
+        /// </summary>
+        /// <param name="folderPath">The folder containing the cache files.</param>
+        /// <param name="readOnly">True to open the cache read-only.</param>
+        PersistentTrackCache(Platform::String^ folderPath, bool readOnly);
+
+        /// <summary>
+        /// Destroy an instance of the <see cref="PersistentTrackCache" /> class.
+        /// </summary>
+        virtual ~PersistentTrackCache();
+
+        /// <summary>
+        /// Gets the folder containing the cache files.
+        /// </summary>
+        property Platform::String^ FolderPath
+        {
+            Platform::String^ get();
+        }
+
+        /// <summary>
+        /// Gets a value indicating whether the cache is read-only.
+        /// </summary>
+        property bool IsReadOnly
+        {
+            bool get();
+        }
+
+        /// <summary>
+        /// Gets the number of cached results.
+        /// </summary>
+        property uint32 Count
+        {
+            uint32 get();
+        }
+
+        /// <summary>
+        /// Gets or sets how long a result stays valid.
+        /// </summary>
+        property Windows::Foundation::TimeSpan MaximumAge
+        {
+            Windows::Foundation::TimeSpan get();
+            void set(Windows::Foundation::TimeSpan value);
+        }
+
+        /// <summary>
+        /// Find the cached tracks for a digest.
+        /// </summary>
+        /// <param name="digest">The fingerprint digest.</param>
+        /// <param name="maximumDistance">The maximum number of differing digest bits for a match, less than 4.</param>
+        /// <returns>The cached tracks or null.</returns>
+        Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^
+            Lookup(uint64 digest, uint32 maximumDistance);
+
+        /// <summary>
+        /// Append the tracks for a digest to the cache.
+        /// </summary>
+        /// <param name="digest">The fingerprint digest.</param>
+        /// <param name="tracks">The identified tracks.</param>
+        void Add(
+            uint64 digest,
+            Windows::Foundation::Collections::IVectorView<CrazyGiraffe::AudioIdentification::IReadOnlyTrack^>^ tracks);
+
+        /// <summary>
+        /// Rewrite the index to cover the whole log.
+        /// </summary>
+        void Compact();
+
+        /// <summary>
+        /// Pick up results appended by the writer since the cache was opened.
+        /// </summary>
+        void Refresh();
+
+    private:
+        ///
+        /// A read-only view of a file.
+        ///
+        struct MappedFile
+        {
+            HANDLE file;
+            HANDLE mapping;
+            const uint8_t* view;
+            uint64_t size;
+        };
+
+        ///
+        /// An index entry: the offset of the latest record for a digest.
+        ///
+        struct IndexEntry
+        {
+            uint64_t digest;
+            uint64_t offset;
+        };
+
+        ///
+        /// A band table entry: one 16-bit band of a digest and the index entry it belongs to.
+        ///
+        struct BandEntry
+        {
+            uint32_t key;
+            uint32_t entry;
+        };
+
+        ///
+        /// Get the path of a cache file.
+        ///
+        std::wstring GetFilePath(const wchar_t* fileName) const;
+
+        ///
+        /// Map a file. m_lock must be held.
+        ///
+        static bool MapFile(MappedFile& mappedFile);
+
+        ///
+        /// Unmap a file, leaving the file handle open. m_lock must be held.
+        ///
+        static void UnmapFile(MappedFile& mappedFile);
+
+        ///
+        /// Open and map the log, creating it if writable. m_lock must be held.
+        ///
+        void OpenLog();
+
+        ///
+        /// Open and map the index and validate it. m_lock must be held.
+        ///
+        void OpenIndex();
+
+        ///
+        /// Close the index. m_lock must be held.
+        ///
+        void CloseIndex();
+
+        ///
+        /// Write a new index covering the whole log. m_lock must be held.
+        ///
+        void CompactIndex();
+
+        ///
+        /// Add the records after the indexed part of the log to the tail. m_lock must be held.
+        ///
+        void ScanLog();
+
+        ///
+        /// Find the offset of the closest record for a digest. m_lock must be held.
+        ///
+        bool FindRecord(uint64_t digest, uint32_t maximumDistance, uint64_t& offset);
+
+        ///
+        /// Find the offset of a digest in the index. m_lock must be held.
+        ///
+        bool FindIndexEntry(uint64_t digest, uint64_t& offset) const;
+
+        ///
+        /// Get a validated record from the log, remapping if needed. m_lock must be held.
+        ///
+        const uint8_t* GetRecord(uint64_t offset);
+
+        ///
+        /// Get the index entries. m_lock must be held.
+        ///
+        const IndexEntry* GetIndexEntries(uint64_t& count) const;
+
+        ///
+        /// Get the band table of the index for a band, sorted by key. m_lock must be held.
+        ///
+        const BandEntry* GetBandEntries(unsigned int band, uint64_t& count) const;
+
+        ///
+        /// Add a record to the tail. m_lock must be held.
+        ///
+        void AddTailEntry(uint64_t digest, uint64_t offset);
+
+        ///
+        /// Check if a record is older than the maximum age.
+        ///
+        bool IsExpired(const uint8_t* record) const;
+
+    private:
+        ///
+        /// The folder containing the cache files.
+        ///
+        Platform::String^ m_folderPath;
+
+        ///
+        /// True if the cache is read-only.
+        ///
+        bool m_readOnly;
+
+        ///
+        /// How long a result stays valid, in 100-nanosecond units.
+        ///
+        int64_t m_maximumAge;
+
+        ///
+        /// The log.
+        ///
+        MappedFile m_log;
+
+        ///
+        /// The end of the valid records in the log.
+        ///
+        uint64_t m_logSize;
+
+        ///
+        /// The index.
+        ///
+        MappedFile m_index;
+
+        ///
+        /// The part of the log covered by the index.
+        ///
+        uint64_t m_indexedLogSize;
+
+        ///
+        /// The records after the indexed part of the log, by digest.
+        ///
+        std::unordered_map<uint64_t, uint64_t> m_tail;
+
+        ///
+        /// The digests of the tail by band key, to find near matches.
+        ///
+        std::unordered_multimap<uint32_t, uint64_t> m_tailBands;
+
+        ///
+        /// Lock for the files and the tail.
+        ///
+        std::mutex m_lock;
+    };
+} }
@@ -0,0 +1,81 @@
+//-----------------------------------------------------------------------
+// <copyright file="PipelineMetrics.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "PipelineMetrics.h"
+
+using namespace Platform;
+using namespace Windows::Foundation;
+using namespace Windows::Foundation::Collections;
+using namespace CrazyGiraffe::AudioIdentification;
+
+LatencySummary::LatencySummary(
+    uint64 count,
+    TimeSpan mean,
+    TimeSpan median,
+    TimeSpan percentile90,
+    TimeSpan percentile99,
+    TimeSpan maximum)
+    : m_count(count)
+    , m_mean(mean)
+    , m_median(median)
+    , m_percentile90(percentile90)
+    , m_percentile99(percentile99)
+    , m_maximum(maximum)
+{
+}
+
+uint64 LatencySummary::Count::get()
+{
+    return m_count;
+}
+
+TimeSpan LatencySummary::Mean::get()
+{
+    return m_mean;
+}
+
+TimeSpan LatencySummary::Median::get()
+{
+    return m_median;
+}
+
+TimeSpan LatencySummary::Percentile90::get()
+{
+    return m_percentile90;
+}
+
+TimeSpan LatencySummary::Percentile99::get()
+{
+    return m_percentile99;
+}
+
+TimeSpan LatencySummary::Maximum::get()
+{
+    return m_maximum;
+}
+
+PipelineMetrics::PipelineMetrics(
+    IMapView<String^, uint64>^ counters,
+    IMapView<String^, LatencySummary^>^ latencies)
+    : m_counters(counters)
+    , m_latencies(latencies)
+{
+    if (m_counters == nullptr || m_latencies == nullptr)
+    {
+        throw ref new InvalidArgumentException(counters == nullptr ? L"counters" : L"latencies");
+    }
+}
+
+IMapView<String^, uint64>^ PipelineMetrics::Counters::get()
+{
+    return m_counters;
+}
+
+IMapView<String^, LatencySummary^>^ PipelineMetrics::Latencies::get()
+{
+    return m_latencies;
+}
@@ -0,0 +1,141 @@
+//-----------------------------------------------------------------------
+// <copyright file="PipelineMetrics.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+namespace CrazyGiraffe { namespace AudioIdentification
+{
+    /// <summary>
+    /// The latencies recorded for a stage of identification.
+    /// </summary>
+    public ref class LatencySummary sealed
+    {
+    public:
+        /// <summary>
+        /// Initializes a new instance of the <see cref="LatencySummary" /> class.
+        /// </summary>
+        /// <param name="count">The number of latencies recorded.</param>
+        /// <param name="mean">The mean latency.</param>
+        /// <param name="median">The median latency.</param>
+        /// <param name="percentile90">The 90th percentile latency.</param>
+        /// <param name="percentile99">The 99th percentile latency.</param>
+        /// <param name="maximum">The longest latency.</param>
+        LatencySummary(
+            uint64 count,
+            Windows::Foundation::TimeSpan mean,
+            Windows::Foundation::TimeSpan median,
+            Windows::Foundation::TimeSpan percentile90,
+            Windows::Foundation::TimeSpan percentile99,
+            Windows::Foundation::TimeSpan maximum);
+
+        /// <summary>
+        /// Gets the number of latencies recorded.
+        /// </summary>
+        property uint64 Count
+        {
+            uint64 get();
+        }
+
+        /// <summary>
+        /// Gets the mean latency.
+        /// </summary>
+        property Windows::Foundation::TimeSpan Mean
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets the median latency.
+        /// </summary>
+        property Windows::Foundation::TimeSpan Median
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets the 90th percentile latency.
+        /// </summary>
+        property Windows::Foundation::TimeSpan Percentile90
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets the 99th percentile latency.
+        /// </summary>
+        property Windows::Foundation::TimeSpan Percentile99
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+        /// <summary>
+        /// Gets the longest latency.
+        /// </summary>
+        property Windows::Foundation::TimeSpan Maximum
+        {
+            Windows::Foundation::TimeSpan get();
+        }
+
+    private:
+        ///
+        /// The number of latencies recorded.
+        ///
+        uint64 m_count;
+
+        ///
+        /// The mean, median, percentile and longest latencies.
+        ///
+        Windows::Foundation::TimeSpan m_mean;
+        Windows::Foundation::TimeSpan m_median;
+        Windows::Foundation::TimeSpan m_percentile90;
+        Windows::Foundation::TimeSpan m_percentile99;
+        Windows::Foundation::TimeSpan m_maximum;
+    };
+
+    /// <summary>
+    /// A snapshot of the counters and stage latencies of a session, or of all the sessions of a factory.
+    /// Percentiles are accurate to within 1/16.
+    /// </summary>
+    public ref class PipelineMetrics sealed
+    {
+    public:
+        /// <summary>
+        /// Initializes a new instance of the <see cref="PipelineMetrics" /> class.
+        /// </summary>
+        /// <param name="counters">The counters, by name.</param>
+        /// <param name="latencies">The stage latencies, by name.</param>
+        PipelineMetrics(
+            Windows::Foundation::Collections::IMapView<Platform::String^, uint64>^ counters,
+            Windows::Foundation::Collections::IMapView<Platform::String^, CrazyGiraffe::AudioIdentification::LatencySummary^>^ latencies);
+
+        /// <summary>
+        /// Gets the counters, by name.
+        /// </summary>
+        property Windows::Foundation::Collections::IMapView<Platform::String^, uint64>^ Counters
+        {
+            Windows::Foundation::Collections::IMapView<Platform::String^, uint64>^ get();
+        }
+
+        /// <summary>
+        /// Gets the stage latencies, by name.
+        /// </summary>
+        property Windows::Foundation::Collections::IMapView<Platform::String^, CrazyGiraffe::AudioIdentification::LatencySummary^>^ Latencies
+        {
+            Windows::Foundation::Collections::IMapView<Platform::String^, CrazyGiraffe::AudioIdentification::LatencySummary^>^ get();
+        }
+
+    private:
+        ///
+        /// The counters, by name.
+        ///
+        Windows::Foundation::Collections::IMapView<Platform::String^, uint64>^ m_counters;
+
+        ///
+        /// The stage latencies, by name.
+        ///
+        Windows::Foundation::Collections::IMapView<Platform::String^, CrazyGiraffe::AudioIdentification::LatencySummary^>^ m_latencies;
+    };
+} }
@@ -13,6 +13,7 @@ SessionOptions::SessionOptions()
     : m_sampleRate(44100)
     , m_sampleSize(16)
     , m_channelCount(2)
+    , m_deckIdentifier(nullptr)
 {
 }
 
@@ -21,6 +22,7 @@ SessionOptions::SessionOptions(SessionOptions^ options)
     this->SampleRate = options->SampleRate;
     this->SampleSize = options->SampleSize;
     this->ChannelCount = options->ChannelCount;
+    this->DeckIdentifier = options->DeckIdentifier;
 }
 
 SessionOptions::SessionOptions(
@@ -31,6 +33,7 @@ SessionOptions::SessionOptions(
     this->SampleRate = SampleRate;
     this->SampleSize = SampleSize;
     this->ChannelCount = ChannelCount;
+    this->DeckIdentifier = nullptr;
 }
 
 uint16 SessionOptions::SampleRate::get()
@@ -62,3 +65,13 @@ void SessionOptions::ChannelCount::set(uint16 value)
 {
     m_channelCount = value;
 }
+
+Platform::String^ SessionOptions::DeckIdentifier::get()
+{
+    return m_deckIdentifier;
+}
+
+void SessionOptions::DeckIdentifier::set(Platform::String^ value)
+{
+    m_deckIdentifier = value;
+}
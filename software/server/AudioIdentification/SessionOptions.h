@@ -97,6 +97,16 @@ namespace CrazyGiraffe { namespace AudioIdentification
             void set(uint16 value);
         }
 
+        /// <summary>
+        /// Gets or sets what the audio is played on, e.g. "deck1", so the sessions of one deck can
+        /// share what they learn about it; null if the session stands alone.
+        /// </summary>
+        property Platform::String^ DeckIdentifier
+        {
+            Platform::String^ get();
+            void set(Platform::String^ value);
+        }
+
     private:
         /// <summary>
         /// The audio sample rate in Hz, e.g. 44100.
@@ -112,5 +122,10 @@ namespace CrazyGiraffe { namespace AudioIdentification
         /// The number of audio channels, e.g. 2.
         /// </summary>
         uint16 m_channelCount;
+
+        /// <summary>
+        /// What the audio is played on.
+        /// </summary>
+        Platform::String^ m_deckIdentifier;
     };
 } }
@@ -0,0 +1,140 @@
+//-----------------------------------------------------------------------
+// <copyright file="SessionReplay.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "pch.h"
+#include "SessionReplay.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace concurrency;
+using namespace Platform;
+using namespace Platform::Collections;
+using namespace Windows::Foundation;
+using namespace Windows::Foundation::Collections;
+using namespace CrazyGiraffe::AudioIdentification;
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    std::string ToUtf8(String^ value)
+    {
+        int length = WideCharToMultiByte(CP_UTF8, 0, value->Data(), static_cast<int>(value->Length()), nullptr, 0, nullptr, nullptr);
+        std::string buffer(length, '\0');
+        WideCharToMultiByte(CP_UTF8, 0, value->Data(), static_cast<int>(value->Length()), &buffer[0], length, nullptr, nullptr);
+        return buffer;
+    }
+}
+
+SessionReplay::SessionReplay(double speed)
+    : m_replay()
+{
+    try
+    {
+        m_replay = std::make_unique<WavReplay>(speed);
+    }
+    catch (const std::invalid_argument&)
+    {
+        throw ref new InvalidArgumentException(L"speed");
+    }
+}
+
+unsigned int SessionReplay::AddFile(String^ path)
+{
+    if (path == nullptr || path->IsEmpty())
+    {
+        throw ref new InvalidArgumentException(L"path");
+    }
+
+    size_t file = 0;
+    try
+    {
+        file = m_replay->AddFile(ToUtf8(path));
+    }
+    catch (const std::runtime_error&)
+    {
+        throw ref new InvalidArgumentException(L"path");
+    }
+
+    // Sessions take PCM, at a rate which fits their options.
+    const AudioFormat& format = m_replay->Format(file);
+    if (format.sampleType != SampleType::Pcm || format.sampleRate > UINT16_MAX)
+    {
+        m_replay->RemoveLastFile();
+        throw ref new InvalidArgumentException(L"path");
+    }
+
+    return static_cast<unsigned int>(file);
+}
+
+unsigned int SessionReplay::FileCount::get()
+{
+    return static_cast<unsigned int>(m_replay->FileCount());
+}
+
+SessionOptions^ SessionReplay::GetOptions(unsigned int file)
+{
+    if (file >= m_replay->FileCount())
+    {
+        throw ref new OutOfBoundsException(L"file");
+    }
+
+    const AudioFormat& format = m_replay->Format(file);
+    return ref new SessionOptions(
+        static_cast<uint16>(format.sampleRate),
+        format.bitsPerSample,
+        format.channelCount);
+}
+
+IAsyncAction^ SessionReplay::RunAsync(IIterable<ISession^>^ sessions)
+{
+    if (sessions == nullptr)
+    {
+        throw ref new InvalidArgumentException(L"sessions");
+    }
+
+    std::vector<ISession^> fileSessions;
+    for (ISession^ session : sessions)
+    {
+        if (session == nullptr)
+        {
+            throw ref new InvalidArgumentException(L"sessions");
+        }
+
+        fileSessions.push_back(session);
+    }
+
+    if (fileSessions.size() != m_replay->FileCount())
+    {
+        throw ref new InvalidArgumentException(L"sessions");
+    }
+
+    // A stop stays until reset, so a run canceled before it starts doesn't start.
+    m_replay->Reset();
+
+    return create_async([this, fileSessions](cancellation_token token)
+    {
+        // The blocks point into the mapped files, so each is copied once, into the array a session takes.
+        m_replay->Run([this, &fileSessions, &token](size_t file, const uint8_t* data, size_t size)
+        {
+            if (token.is_canceled())
+            {
+                m_replay->Stop();
+                return false;
+            }
+
+            ISession^ session = fileSessions[file];
+            session->AddAudioSample(ref new Array<byte>(const_cast<uint8_t*>(data), static_cast<unsigned int>(size)));
+            IdentifyStatus status = session->IdentificationStatus;
+            return status != IdentifyStatus::Complete && status != IdentifyStatus::Error;
+        });
+
+        if (token.is_canceled())
+        {
+            cancel_current_task();
+        }
+    });
+}
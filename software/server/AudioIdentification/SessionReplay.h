@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------
+// <copyright file="SessionReplay.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+#include "Session.h"
+#include "SessionOptions.h"
+#include "Core/WavReplay.h"
+#include <memory>
+
+namespace CrazyGiraffe { namespace AudioIdentification
+{
+    /// <summary>
+    /// Replays WAV files into sessions as if the audio were being captured.
+    /// </summary>
+    /// <remarks>
+    /// The files are memory-mapped and handed to the sessions in 10ms blocks, interleaved by
+    /// the time of each block. The speed only paces the blocks: a run at any speed feeds the
+    /// sessions the same blocks in the same order as a run in real time.
+    /// </remarks>
+    public ref class SessionReplay sealed
+    {
+    public:
+        /// <summary>
+        /// Initializes a new instance of the <see cref="SessionReplay" /> class.
+        /// </summary>
+        /// <param name="speed">1 for real time, 100 for a hundred times as fast, 0 for as fast as the sessions take the audio.</param>
+        SessionReplay(double speed);
+
+        /// <summary>
+        /// Add a PCM WAV file to replay.
+        /// </summary>
+        /// <param name="path">The path of the file.</param>
+        /// <returns>The index of the file.</returns>
+        unsigned int AddFile(Platform::String^ path);
+
+        /// <summary>
+        /// Gets the number of files to replay.
+        /// </summary>
+        property unsigned int FileCount
+        {
+            unsigned int get();
+        }
+
+        /// <summary>
+        /// Get session options in the format of a file.
+        /// </summary>
+        /// <param name="file">The index of the file.</param>
+        /// <returns>Options for a session to identify the file.</returns>
+        CrazyGiraffe::AudioIdentification::SessionOptions^ GetOptions(unsigned int file);
+
+        /// <summary>
+        /// Replay the files into their sessions, one session for each file. A session is no longer
+        /// fed once its identification is complete or has failed.
+        /// </summary>
+        /// <param name="sessions">The sessions, in the order of the files.</param>
+        /// <returns>An action which completes when every file has ended or its session is done.</returns>
+        Windows::Foundation::IAsyncAction^ RunAsync(
+            Windows::Foundation::Collections::IIterable<CrazyGiraffe::AudioIdentification::ISession^>^ sessions);
+
+    private:
+        ///
+        /// The mapped files.
+        ///
+        std::unique_ptr<CrazyGiraffe::Core::WavReplay> m_replay;
+    };
+} }
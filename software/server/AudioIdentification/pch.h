@@ -6,5 +6,6 @@
 //-----------------------------------------------------------------------
 #pragma once
 
+#include <windows.h>
 #include <collection.h>
 #include <ppltasks.h>
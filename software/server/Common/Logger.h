@@ -0,0 +1,828 @@
+//-----------------------------------------------------------------------
+// <copyright file="Logger.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Levels, lowest first.
+#define LOG_LEVEL_DEBUG     0
+#define LOG_LEVEL_INFO      1
+#define LOG_LEVEL_WARNING   2
+#define LOG_LEVEL_ERROR     3
+#define LOG_LEVEL_NONE      4
+
+// Messages below this level are compiled out.
+#ifndef LOG_LEVEL_MINIMUM
+#ifdef NDEBUG
+#define LOG_LEVEL_MINIMUM LOG_LEVEL_INFO
+#else
+#define LOG_LEVEL_MINIMUM LOG_LEVEL_DEBUG
+#endif
+#endif
+
+// Log a printf-style message. The arguments are captured by value and formatted later
+// on the logger's thread; the format must be a string literal.
+#define LOG_AT_LEVEL(level, ...) do { \
+  if ((level) >= LOG_LEVEL_MINIMUM) { \
+    ::CrazyGiraffe::Common::Logger::Instance().Log( \
+      static_cast<::CrazyGiraffe::Common::LogLevel>(level), __VA_ARGS__); \
+  } \
+} while (0)
+
+#define LOG_DEBUG(...)      LOG_AT_LEVEL(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)       LOG_AT_LEVEL(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARNING(...)    LOG_AT_LEVEL(LOG_LEVEL_WARNING, __VA_ARGS__)
+#define LOG_ERROR(...)      LOG_AT_LEVEL(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+namespace CrazyGiraffe { namespace Common
+{
+    ///
+    /// Severity of a message.
+    ///
+    enum class LogLevel : uint8_t
+    {
+        Debug = LOG_LEVEL_DEBUG,
+        Info = LOG_LEVEL_INFO,
+        Warning = LOG_LEVEL_WARNING,
+        Error = LOG_LEVEL_ERROR,
+        None = LOG_LEVEL_NONE,
+    };
+
+    ///
+    /// A captured argument of a message.
+    ///
+    struct LogArgument
+    {
+        enum class Kind : uint8_t
+        {
+            Signed,
+            Unsigned,
+            Double,
+            Pointer,
+            String,
+        };
+
+        Kind kind;
+        union
+        {
+            int64_t signedValue;
+            uint64_t unsignedValue;
+            double doubleValue;
+            const void* pointerValue;
+
+            // Where the UTF-8 text is in the record, and whether it was cut short to fit.
+            struct
+            {
+                uint16_t offset;
+                uint16_t length;
+                bool truncated;
+            } text;
+        };
+    };
+
+    ///
+    /// A message as captured on the caller's thread; nothing in it is formatted yet.
+    ///
+    struct LogRecord
+    {
+        static const size_t MaximumArguments = 8;
+        static const size_t TextCapacity = 160;
+
+        int64_t timestamp;
+        uint32_t threadId;
+        LogLevel level;
+        uint8_t argumentCount;
+        uint16_t textLength;
+        const char* format;
+        LogArgument arguments[MaximumArguments];
+        char text[TextCapacity];
+    };
+
+    ///
+    /// Where formatted messages go. Sinks are called on the logger's thread only.
+    ///
+    class LogSink
+    {
+    public:
+        virtual ~LogSink() {}
+
+        ///
+        /// Write a message; text is the formatted message.
+        ///
+        virtual void Write(const LogRecord& record, const char* text) = 0;
+
+        ///
+        /// Write out anything buffered.
+        ///
+        virtual void Flush() {}
+    };
+
+    ///
+    /// Writes formatted messages to the debugger.
+    ///
+    class DebugOutputLogSink : public LogSink
+    {
+    public:
+        virtual void Write(const LogRecord& record, const char* text) override
+        {
+            static const char* const LevelNames[] = { "DEBUG", "INFO", "WARNING", "ERROR", "NONE" };
+
+            char line[1024];
+            snprintf(line, sizeof(line), "[%s %u] %s\n", LevelNames[static_cast<int>(record.level)], record.threadId, text);
+#ifdef _WIN32
+            OutputDebugStringA(line);
+#else
+            fputs(line, stderr);
+#endif
+        }
+    };
+
+    ///
+    /// Writes messages unformatted to a file, for decoding off the device: per message the timestamp,
+    /// thread, level, format and the arguments, each string prefixed with its 16-bit length. The top
+    /// bit of the length is set on a string which was cut short.
+    ///
+    class BinaryFileLogSink : public LogSink
+    {
+    public:
+        explicit BinaryFileLogSink(const char* path)
+            : m_file(nullptr)
+        {
+#ifdef _WIN32
+            fopen_s(&m_file, path, "wb");
+#else
+            m_file = fopen(path, "wb");
+#endif
+        }
+
+        virtual ~BinaryFileLogSink()
+        {
+            if (m_file != nullptr)
+            {
+                fclose(m_file);
+            }
+        }
+
+        virtual void Write(const LogRecord& record, const char* /* text */) override
+        {
+            if (m_file == nullptr)
+            {
+                return;
+            }
+
+            uint16_t formatLength = static_cast<uint16_t>(strlen(record.format));
+            fwrite(&record.timestamp, sizeof(record.timestamp), 1, m_file);
+            fwrite(&record.threadId, sizeof(record.threadId), 1, m_file);
+            fwrite(&record.level, sizeof(record.level), 1, m_file);
+            fwrite(&formatLength, sizeof(formatLength), 1, m_file);
+            fwrite(record.format, 1, formatLength, m_file);
+            fwrite(&record.argumentCount, sizeof(record.argumentCount), 1, m_file);
+            for (uint8_t i = 0; i < record.argumentCount; i++)
+            {
+                const LogArgument& argument = record.arguments[i];
+                fwrite(&argument.kind, sizeof(argument.kind), 1, m_file);
+                if (argument.kind == LogArgument::Kind::String)
+                {
+                    uint16_t length = argument.text.length | (argument.text.truncated ? 0x8000 : 0);
+                    fwrite(&length, sizeof(length), 1, m_file);
+                    fwrite(record.text + argument.text.offset, 1, argument.text.length, m_file);
+                }
+                else
+                {
+                    fwrite(&argument.unsignedValue, sizeof(argument.unsignedValue), 1, m_file);
+                }
+            }
+        }
+
+        virtual void Flush() override
+        {
+            if (m_file != nullptr)
+            {
+                fflush(m_file);
+            }
+        }
+
+    private:
+        FILE* m_file;
+    };
+
+    ///
+    /// Logger which never blocks the caller: every thread captures messages into its own
+    /// single-producer, single-consumer ring, and one background thread formats them for the sinks.
+    /// A message which finds its ring full is dropped and counted. Strings are copied into the
+    /// message up to its text capacity; one cut short ends in an ellipsis and is counted.
+    /// A ring is freed once its thread has exited and its messages are written out, and whatever
+    /// is still captured when the process exits is written out then.
+    ///
+    class Logger
+    {
+    public:
+        ///
+        /// Get the logger of the module. It lives until the process exits, so it is never
+        /// torn down under the loader lock.
+        ///
+        static Logger& Instance()
+        {
+            static Logger* s_instance = Create();
+            return *s_instance;
+        }
+
+        ///
+        /// Set the lowest level logged at run time; it can't go below LOG_LEVEL_MINIMUM.
+        ///
+        void SetLevel(LogLevel level)
+        {
+            m_level = level;
+        }
+
+        ///
+        /// Add a sink.
+        ///
+        void AddSink(std::shared_ptr<LogSink> sink)
+        {
+            std::lock_guard<std::mutex> lock(m_sinkLock);
+            m_sinks.push_back(sink);
+        }
+
+        ///
+        /// Remove every sink, including the debugger.
+        ///
+        void ClearSinks()
+        {
+            std::lock_guard<std::mutex> lock(m_sinkLock);
+            m_sinks.clear();
+        }
+
+        ///
+        /// Get the number of messages dropped because a ring was full.
+        ///
+        uint64_t DroppedCount() const
+        {
+            return m_dropped;
+        }
+
+        ///
+        /// Get the number of messages with a string cut short to fit.
+        ///
+        uint64_t TruncatedCount() const
+        {
+            return m_truncated;
+        }
+
+        ///
+        /// Get the number of rings: one per thread which has logged, until its messages are written
+        /// out after it exits.
+        ///
+        size_t RingCount()
+        {
+            std::lock_guard<std::mutex> lock(m_ringLock);
+            return m_rings.size();
+        }
+
+        ///
+        /// Capture a message.
+        ///
+        template <typename... Args>
+        void Log(LogLevel level, const char* format, const Args&... args)
+        {
+            static_assert(sizeof...(Args) <= LogRecord::MaximumArguments, "Too many log arguments.");
+            if (level < m_level)
+            {
+                return;
+            }
+
+            Ring& ring = ThreadRing();
+            uint32_t head = ring.head.load(std::memory_order_relaxed);
+            if (head - ring.tail.load(std::memory_order_acquire) >= RingCapacity)
+            {
+                m_dropped++;
+                return;
+            }
+
+            LogRecord& record = ring.records[head % RingCapacity];
+            record.timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+            record.threadId = ring.threadId;
+            record.level = level;
+            record.argumentCount = 0;
+            record.textLength = 0;
+            record.format = format;
+            CaptureArguments(record, args...);
+            for (uint8_t i = 0; i < record.argumentCount; i++)
+            {
+                if (record.arguments[i].kind == LogArgument::Kind::String && record.arguments[i].text.truncated)
+                {
+                    m_truncated++;
+                    break;
+                }
+            }
+
+            ring.head.store(head + 1, std::memory_order_release);
+            if (level >= LogLevel::Error)
+            {
+                m_wake.notify_one();
+            }
+        }
+
+        ///
+        /// Format and write out everything captured so far, on the caller's thread.
+        ///
+        void Flush()
+        {
+            std::unique_lock<std::mutex> drainLock(m_drainLock);
+            Drain();
+        }
+
+    private:
+        static const uint32_t RingCapacity = 128;
+
+        ///
+        /// The messages of one thread.
+        ///
+        struct Ring
+        {
+            std::array<LogRecord, RingCapacity> records;
+            std::atomic<uint32_t> head;
+            std::atomic<uint32_t> tail;
+            std::atomic<bool> retired;
+            uint32_t threadId;
+        };
+
+        ///
+        /// Retires the ring of a thread when the thread exits.
+        ///
+        struct RingOwner
+        {
+            Ring* ring;
+
+            ~RingOwner()
+            {
+                if (ring != nullptr)
+                {
+                    ring->retired.store(true, std::memory_order_release);
+
+                    // A message logged later still gets a ring, if a new one.
+                    ring = nullptr;
+                }
+            }
+        };
+
+        static Logger* Create()
+        {
+            Logger* logger = new Logger();
+            std::atexit(FlushAtExit);
+            return logger;
+        }
+
+        ///
+        /// Write out what is still captured when the process exits. The logger's thread may have
+        /// been stopped in the middle of a drain, so this gives up rather than wait for it.
+        ///
+        static void FlushAtExit()
+        {
+            Logger& logger = Instance();
+            std::unique_lock<std::mutex> drainLock(logger.m_drainLock, std::try_to_lock);
+            if (drainLock.owns_lock())
+            {
+                logger.Drain();
+            }
+        }
+
+        Logger()
+            : m_level(static_cast<LogLevel>(LOG_LEVEL_MINIMUM))
+            , m_dropped(0)
+            , m_truncated(0)
+            , m_nextThreadId(1)
+        {
+            m_sinks.push_back(std::make_shared<DebugOutputLogSink>());
+
+            // The thread outlives the module's static destructors; see Instance.
+            std::thread([this]
+                {
+                    for (;;)
+                    {
+                        {
+                            std::unique_lock<std::mutex> lock(m_wakeLock);
+                            m_wake.wait_for(lock, std::chrono::milliseconds(20));
+                        }
+
+                        std::unique_lock<std::mutex> drainLock(m_drainLock);
+                        Drain();
+                    }
+                }).detach();
+        }
+
+        Ring& ThreadRing()
+        {
+            thread_local RingOwner t_owner = { nullptr };
+            if (t_owner.ring == nullptr)
+            {
+                // Drain frees the ring once the owner has retired it and it is empty.
+                std::unique_ptr<Ring> ring(new Ring());
+                ring->head = 0;
+                ring->tail = 0;
+                ring->retired = false;
+                ring->threadId = m_nextThreadId++;
+                t_owner.ring = ring.get();
+
+                std::lock_guard<std::mutex> lock(m_ringLock);
+                m_rings.push_back(std::move(ring));
+            }
+
+            return *t_owner.ring;
+        }
+
+        void CaptureArguments(LogRecord&)
+        {
+        }
+
+        template <typename T, typename... Rest>
+        void CaptureArguments(LogRecord& record, const T& value, const Rest&... rest)
+        {
+            Capture(record, record.arguments[record.argumentCount++], value);
+            CaptureArguments(record, rest...);
+        }
+
+        template <typename T>
+        static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+            Capture(LogRecord&, LogArgument& argument, const T& value)
+        {
+            if (std::is_signed<T>::value)
+            {
+                argument.kind = LogArgument::Kind::Signed;
+                argument.signedValue = static_cast<int64_t>(value);
+            }
+            else
+            {
+                argument.kind = LogArgument::Kind::Unsigned;
+                argument.unsignedValue = static_cast<uint64_t>(value);
+            }
+        }
+
+        template <typename T>
+        static typename std::enable_if<std::is_floating_point<T>::value>::type
+            Capture(LogRecord&, LogArgument& argument, const T& value)
+        {
+            argument.kind = LogArgument::Kind::Double;
+            argument.doubleValue = static_cast<double>(value);
+        }
+
+        template <typename T>
+        static typename std::enable_if<std::is_pointer<T>::value &&
+            !std::is_same<typename std::remove_cv<typename std::remove_pointer<T>::type>::type, char>::value &&
+            !std::is_same<typename std::remove_cv<typename std::remove_pointer<T>::type>::type, wchar_t>::value>::type
+            Capture(LogRecord&, LogArgument& argument, const T& value)
+        {
+            argument.kind = LogArgument::Kind::Pointer;
+            argument.pointerValue = value;
+        }
+
+        // Strings may not outlive the call, so they are copied into the record.
+        static void Capture(LogRecord& record, LogArgument& argument, const char* value)
+        {
+            argument.kind = LogArgument::Kind::String;
+            argument.text.offset = record.textLength;
+            argument.text.length = 0;
+            argument.text.truncated = false;
+            if (value == nullptr)
+            {
+                value = "(null)";
+            }
+
+            size_t valueLength = strlen(value);
+            size_t length = (std::min)(valueLength, LogRecord::TextCapacity - record.textLength);
+
+            // Don't leave half of a UTF-8 sequence behind.
+            while (length < valueLength && length > 0 && (static_cast<uint8_t>(value[length]) & 0xC0) == 0x80)
+            {
+                length--;
+            }
+
+            memcpy(record.text + record.textLength, value, length);
+            argument.text.length = static_cast<uint16_t>(length);
+            argument.text.truncated = (length < valueLength);
+            record.textLength += static_cast<uint16_t>(length);
+        }
+
+        static void Capture(LogRecord& record, LogArgument& argument, char* value)
+        {
+            Capture(record, argument, const_cast<const char*>(value));
+        }
+
+        template <size_t N>
+        static void Capture(LogRecord& record, LogArgument& argument, const char (&value)[N])
+        {
+            Capture(record, argument, static_cast<const char*>(value));
+        }
+
+        // Wide strings are stored as UTF-8.
+        static void Capture(LogRecord& record, LogArgument& argument, const wchar_t* value)
+        {
+            argument.kind = LogArgument::Kind::String;
+            argument.text.offset = record.textLength;
+            argument.text.length = 0;
+            argument.text.truncated = false;
+            if (value == nullptr)
+            {
+                Capture(record, argument, "(null)");
+                return;
+            }
+
+            size_t length = record.textLength;
+            for (; *value != L'\0'; value++)
+            {
+                uint32_t codePoint = static_cast<uint32_t>(*value);
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF && value[1] >= 0xDC00 && value[1] <= 0xDFFF)
+                {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (static_cast<uint32_t>(value[1]) - 0xDC00);
+                    value++;
+                }
+
+                char encoded[4];
+                size_t encodedLength = 0;
+                if (codePoint < 0x80)
+                {
+                    encoded[encodedLength++] = static_cast<char>(codePoint);
+                }
+                else if (codePoint < 0x800)
+                {
+                    encoded[encodedLength++] = static_cast<char>(0xC0 | (codePoint >> 6));
+                    encoded[encodedLength++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+                else if (codePoint < 0x10000)
+                {
+                    encoded[encodedLength++] = static_cast<char>(0xE0 | (codePoint >> 12));
+                    encoded[encodedLength++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                    encoded[encodedLength++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+                else
+                {
+                    encoded[encodedLength++] = static_cast<char>(0xF0 | (codePoint >> 18));
+                    encoded[encodedLength++] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                    encoded[encodedLength++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                    encoded[encodedLength++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+
+                if (length + encodedLength > LogRecord::TextCapacity)
+                {
+                    argument.text.truncated = true;
+                    break;
+                }
+
+                memcpy(record.text + length, encoded, encodedLength);
+                length += encodedLength;
+            }
+
+            argument.text.length = static_cast<uint16_t>(length - record.textLength);
+            record.textLength = static_cast<uint16_t>(length);
+        }
+
+        static void Capture(LogRecord& record, LogArgument& argument, wchar_t* value)
+        {
+            Capture(record, argument, const_cast<const wchar_t*>(value));
+        }
+
+        template <size_t N>
+        static void Capture(LogRecord& record, LogArgument& argument, const wchar_t (&value)[N])
+        {
+            Capture(record, argument, static_cast<const wchar_t*>(value));
+        }
+
+        static void Capture(LogRecord& record, LogArgument& argument, const std::string& value)
+        {
+            Capture(record, argument, value.c_str());
+        }
+
+        static void Capture(LogRecord& record, LogArgument& argument, const std::wstring& value)
+        {
+            Capture(record, argument, value.c_str());
+        }
+
+#ifdef __cplusplus_winrt
+        static void Capture(LogRecord& record, LogArgument& argument, Platform::String^ value)
+        {
+            Capture(record, argument, (value != nullptr) ? value->Data() : L"(null)");
+        }
+#endif
+
+        ///
+        /// Format a message. The argument, not the conversion, decides how a value is printed,
+        /// so %s with a wide string or %d with a 64-bit value print correctly.
+        ///
+        static std::string Format(const LogRecord& record)
+        {
+            std::string result;
+            uint8_t argumentIndex = 0;
+            const char* p = record.format;
+            while (*p != '\0')
+            {
+                if (*p != '%')
+                {
+                    result.push_back(*p++);
+                    continue;
+                }
+
+                if (p[1] == '%')
+                {
+                    result.push_back('%');
+                    p += 2;
+                    continue;
+                }
+
+                // Flags, width and precision are kept; length modifiers are replaced.
+                std::string spec(1, '%');
+                p++;
+                while (*p != '\0' && strchr("-+ #0123456789.*", *p) != nullptr)
+                {
+                    if (*p != '*')
+                    {
+                        spec.push_back(*p++);
+                        continue;
+                    }
+
+                    // A width or precision of * is taken from the next argument, as printf does;
+                    // one which isn't an integer is left out.
+                    p++;
+                    if (argumentIndex < record.argumentCount)
+                    {
+                        const LogArgument& argument = record.arguments[argumentIndex++];
+                        if (argument.kind == LogArgument::Kind::Signed || argument.kind == LogArgument::Kind::Unsigned)
+                        {
+                            // No wider than the buffer it is formatted into.
+                            const long long limit = 255;
+                            long long value = (argument.kind == LogArgument::Kind::Signed)
+                                ? (std::max)(-limit, (std::min)(static_cast<long long>(argument.signedValue), limit))
+                                : static_cast<long long>((std::min)(argument.unsignedValue, static_cast<uint64_t>(limit)));
+                            if (value >= 0 || spec.back() != '.')
+                            {
+                                spec.append(std::to_string(value));
+                            }
+                            else
+                            {
+                                // A negative precision is taken as if omitted.
+                                spec.pop_back();
+                            }
+                        }
+                    }
+                }
+
+                while (*p != '\0' && strchr("hlLzjtwI", *p) != nullptr)
+                {
+                    p++;
+                }
+
+                char conversion = (*p != '\0') ? *p++ : 's';
+                if (argumentIndex >= record.argumentCount)
+                {
+                    result.append("<missing>");
+                    continue;
+                }
+
+                char buffer[256];
+                const LogArgument& argument = record.arguments[argumentIndex++];
+                switch (argument.kind)
+                {
+                case LogArgument::Kind::Signed:
+                    spec.append("ll");
+                    spec.push_back(strchr("dixXo", conversion) != nullptr ? conversion : 'd');
+                    snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<long long>(argument.signedValue));
+                    break;
+
+                case LogArgument::Kind::Unsigned:
+                    spec.append("ll");
+                    spec.push_back(strchr("uxXo", conversion) != nullptr ? conversion : 'u');
+                    snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<unsigned long long>(argument.unsignedValue));
+                    break;
+
+                case LogArgument::Kind::Double:
+                    spec.push_back(strchr("fFeEgGaA", conversion) != nullptr ? conversion : 'g');
+                    snprintf(buffer, sizeof(buffer), spec.c_str(), argument.doubleValue);
+                    break;
+
+                case LogArgument::Kind::Pointer:
+                    snprintf(buffer, sizeof(buffer), "%p", argument.pointerValue);
+                    break;
+
+                case LogArgument::Kind::String:
+                default:
+                    {
+                        // U+2026, so a string cut short doesn't read as the whole of it.
+                        std::string text(record.text + argument.text.offset, argument.text.length);
+                        if (argument.text.truncated)
+                        {
+                            text.append("\xE2\x80\xA6");
+                        }
+
+                        spec.push_back('s');
+                        snprintf(buffer, sizeof(buffer), spec.c_str(), text.c_str());
+                    }
+                    break;
+                }
+
+                result.append(buffer);
+            }
+
+            // Messages carry their own line breaks; the sinks add one.
+            while (!result.empty() && (result.back() == '\n' || result.back() == '\r'))
+            {
+                result.pop_back();
+            }
+
+            return result;
+        }
+
+        ///
+        /// Format everything captured and write it to the sinks, and free the rings of threads which
+        /// have exited. m_drainLock must be held.
+        ///
+        void Drain()
+        {
+            std::vector<Ring*> rings;
+            {
+                std::lock_guard<std::mutex> lock(m_ringLock);
+                for (const std::unique_ptr<Ring>& ring : m_rings)
+                {
+                    rings.push_back(ring.get());
+                }
+            }
+
+            std::vector<Ring*> retiredRings;
+            std::unique_lock<std::mutex> sinkLock(m_sinkLock);
+            for (Ring* ring : rings)
+            {
+                // Retired before the head is read, so nothing can be added after it.
+                bool retired = ring->retired.load(std::memory_order_acquire);
+                uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+                uint32_t head = ring->head.load(std::memory_order_acquire);
+                for (; tail != head; tail++)
+                {
+                    const LogRecord& record = ring->records[tail % RingCapacity];
+                    std::string text = Format(record);
+                    for (const std::shared_ptr<LogSink>& sink : m_sinks)
+                    {
+                        sink->Write(record, text.c_str());
+                    }
+                }
+
+                ring->tail.store(tail, std::memory_order_release);
+                if (retired)
+                {
+                    retiredRings.push_back(ring);
+                }
+            }
+
+            for (const std::shared_ptr<LogSink>& sink : m_sinks)
+            {
+                sink->Flush();
+            }
+
+            sinkLock.unlock();
+            if (!retiredRings.empty())
+            {
+                std::lock_guard<std::mutex> lock(m_ringLock);
+                m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(), [&retiredRings](const std::unique_ptr<Ring>& ring)
+                    {
+                        return std::find(retiredRings.begin(), retiredRings.end(), ring.get()) != retiredRings.end();
+                    }), m_rings.end());
+            }
+        }
+
+    private:
+        std::atomic<LogLevel> m_level;
+        std::atomic<uint64_t> m_dropped;
+        std::atomic<uint64_t> m_truncated;
+        std::atomic<uint32_t> m_nextThreadId;
+
+        std::vector<std::unique_ptr<Ring>> m_rings;
+        std::mutex m_ringLock;
+
+        std::vector<std::shared_ptr<LogSink>> m_sinks;
+        std::mutex m_sinkLock;
+
+        std::mutex m_drainLock;
+        std::mutex m_wakeLock;
+        std::condition_variable m_wake;
+    };
+} }
@@ -0,0 +1,361 @@
+//-----------------------------------------------------------------------
+// <copyright file="Metrics.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace CrazyGiraffe { namespace Common
+{
+    ///
+    /// A counter which only goes up. Adding to it also adds to its parent, if any.
+    ///
+    class MetricCounter
+    {
+    public:
+        explicit MetricCounter(MetricCounter* parent = nullptr)
+            : m_value(0)
+            , m_parent(parent)
+        {
+        }
+
+        void Add(uint64_t value = 1)
+        {
+            m_value.fetch_add(value, std::memory_order_relaxed);
+            if (m_parent != nullptr)
+            {
+                m_parent->Add(value);
+            }
+        }
+
+        uint64_t Value() const
+        {
+            return m_value.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<uint64_t> m_value;
+        MetricCounter* m_parent;
+    };
+
+    ///
+    /// The recorded latencies of a histogram at one point in time, in microseconds.
+    ///
+    struct LatencySnapshot
+    {
+        uint64_t count;
+        uint64_t sum;
+        uint64_t maximum;
+        std::vector<uint64_t> buckets;
+
+        uint64_t Mean() const
+        {
+            return (count > 0) ? (sum / count) : 0;
+        }
+
+        ///
+        /// Get the latency which the given fraction (0 to 1) of the recorded latencies are at or below.
+        /// It is the top of its bucket, so it overstates by less than 1/16.
+        ///
+        uint64_t Percentile(double fraction) const;
+    };
+
+    ///
+    /// A latency histogram with log-linear buckets, in the manner of HdrHistogram: every power of two
+    /// is split into 16 buckets, so a latency is known to within 1/16 from 1 microsecond to 12 days in
+    /// a fixed 5KB. Recording is lock-free. Recording also records in the parent, if any.
+    ///
+    class LatencyHistogram
+    {
+    public:
+        static const int SubBucketBits = 4;
+        static const uint64_t SubBucketCount = 1ull << SubBucketBits;
+        static const int MaximumMagnitude = 40;
+        static const size_t BucketCount = (MaximumMagnitude - SubBucketBits + 1) * SubBucketCount;
+        static const uint64_t MaximumValue = (1ull << MaximumMagnitude) - 1;
+
+        explicit LatencyHistogram(LatencyHistogram* parent = nullptr)
+            : m_count(0)
+            , m_sum(0)
+            , m_maximum(0)
+            , m_parent(parent)
+        {
+            for (std::atomic<uint64_t>& bucket : m_buckets)
+            {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void Record(std::chrono::steady_clock::duration latency)
+        {
+            int64_t microseconds = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+            RecordMicroseconds(microseconds > 0 ? static_cast<uint64_t>(microseconds) : 0);
+        }
+
+        void RecordMicroseconds(uint64_t value)
+        {
+            if (value > MaximumValue)
+            {
+                value = MaximumValue;
+            }
+
+            m_buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            m_sum.fetch_add(value, std::memory_order_relaxed);
+
+            uint64_t maximum = m_maximum.load(std::memory_order_relaxed);
+            while (value > maximum && !m_maximum.compare_exchange_weak(maximum, value, std::memory_order_relaxed))
+            {
+            }
+
+            if (m_parent != nullptr)
+            {
+                m_parent->RecordMicroseconds(value);
+            }
+        }
+
+        ///
+        /// Copy the counts. Recording carries on meanwhile, so the totals may be a few records apart.
+        ///
+        LatencySnapshot Snapshot() const
+        {
+            LatencySnapshot snapshot;
+            snapshot.count = m_count.load(std::memory_order_relaxed);
+            snapshot.sum = m_sum.load(std::memory_order_relaxed);
+            snapshot.maximum = m_maximum.load(std::memory_order_relaxed);
+            snapshot.buckets.reserve(BucketCount);
+            for (const std::atomic<uint64_t>& bucket : m_buckets)
+            {
+                snapshot.buckets.push_back(bucket.load(std::memory_order_relaxed));
+            }
+
+            return snapshot;
+        }
+
+        ///
+        /// Get the bucket of a value: values below 32 have their own, then 16 per power of two.
+        ///
+        static size_t BucketIndex(uint64_t value)
+        {
+            int shift = HighestBit(value | SubBucketCount) - SubBucketBits;
+            return static_cast<size_t>(shift) * SubBucketCount + static_cast<size_t>(value >> shift);
+        }
+
+        ///
+        /// Get the highest value which falls in a bucket.
+        ///
+        static uint64_t BucketHighestValue(size_t index)
+        {
+            if (index < 2 * SubBucketCount)
+            {
+                return index;
+            }
+
+            int shift = static_cast<int>(index / SubBucketCount) - 1;
+            uint64_t mantissa = (index % SubBucketCount) + SubBucketCount;
+            return ((mantissa + 1) << shift) - 1;
+        }
+
+    private:
+        static int HighestBit(uint64_t value)
+        {
+#ifdef _MSC_VER
+            unsigned long index = 0;
+            _BitScanReverse64(&index, value);
+            return static_cast<int>(index);
+#else
+            return 63 - __builtin_clzll(value);
+#endif
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, BucketCount> m_buckets;
+        std::atomic<uint64_t> m_count;
+        std::atomic<uint64_t> m_sum;
+        std::atomic<uint64_t> m_maximum;
+        LatencyHistogram* m_parent;
+    };
+
+    inline uint64_t LatencySnapshot::Percentile(double fraction) const
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(count) + 0.5);
+        rank = (rank < 1) ? 1 : ((rank > count) ? count : rank);
+
+        uint64_t seen = 0;
+        for (size_t index = 0; index < buckets.size(); index++)
+        {
+            seen += buckets[index];
+            if (seen >= rank)
+            {
+                uint64_t value = LatencyHistogram::BucketHighestValue(index);
+                return (value < maximum) ? value : maximum;
+            }
+        }
+
+        return maximum;
+    }
+
+    ///
+    /// Records the time from construction to destruction in a histogram.
+    ///
+    class ScopedLatency
+    {
+    public:
+        explicit ScopedLatency(LatencyHistogram& histogram)
+            : m_histogram(histogram)
+            , m_start(std::chrono::steady_clock::now())
+        {
+        }
+
+        ~ScopedLatency()
+        {
+            m_histogram.Record(std::chrono::steady_clock::now() - m_start);
+        }
+
+    private:
+        ScopedLatency(const ScopedLatency&) = delete;
+        ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+        LatencyHistogram& m_histogram;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    ///
+    /// The metrics of a registry at one point in time, by name.
+    ///
+    struct MetricsSnapshot
+    {
+        std::vector<std::pair<std::string, uint64_t>> counters;
+        std::vector<std::pair<std::string, LatencySnapshot>> latencies;
+    };
+
+    ///
+    /// Named counters and histograms. A session's registry has the factory's as its parent, so the
+    /// factory's holds the totals of all its sessions. Looking a metric up takes a lock; hold on to
+    /// the reference, which lives as long as the registry, and record through it.
+    ///
+    class MetricsRegistry
+    {
+    public:
+        explicit MetricsRegistry(std::shared_ptr<MetricsRegistry> parent = nullptr)
+            : m_parent(parent)
+        {
+        }
+
+        MetricCounter& Counter(const std::string& name)
+        {
+            MetricCounter* parent = (m_parent != nullptr) ? &m_parent->Counter(name) : nullptr;
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            std::unique_ptr<MetricCounter>& counter = m_counters[name];
+            if (counter == nullptr)
+            {
+                counter.reset(new MetricCounter(parent));
+            }
+
+            return *counter;
+        }
+
+        LatencyHistogram& Histogram(const std::string& name)
+        {
+            LatencyHistogram* parent = (m_parent != nullptr) ? &m_parent->Histogram(name) : nullptr;
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            std::unique_ptr<LatencyHistogram>& histogram = m_histograms[name];
+            if (histogram == nullptr)
+            {
+                histogram.reset(new LatencyHistogram(parent));
+            }
+
+            return *histogram;
+        }
+
+        MetricsSnapshot Snapshot() const
+        {
+            MetricsSnapshot snapshot;
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            for (const auto& counter : m_counters)
+            {
+                snapshot.counters.emplace_back(counter.first, counter.second->Value());
+            }
+
+            for (const auto& histogram : m_histograms)
+            {
+                snapshot.latencies.emplace_back(histogram.first, histogram.second->Snapshot());
+            }
+
+            return snapshot;
+        }
+
+    private:
+        std::shared_ptr<MetricsRegistry> m_parent;
+        mutable std::mutex m_lock;
+        std::map<std::string, std::unique_ptr<MetricCounter>> m_counters;
+        std::map<std::string, std::unique_ptr<LatencyHistogram>> m_histograms;
+    };
+} }
+
+#ifdef __cplusplus_winrt
+namespace CrazyGiraffe { namespace Common
+{
+    ///
+    /// Convert a snapshot for the identification backends, which reference CrazyGiraffe.AudioIdentification.
+    ///
+    inline CrazyGiraffe::AudioIdentification::PipelineMetrics^ ToPipelineMetrics(const MetricsSnapshot& snapshot)
+    {
+        // TimeSpan is expressed in 100-nanosecond units.
+        auto toTimeSpan = [](uint64_t microseconds)
+        {
+            Windows::Foundation::TimeSpan timeSpan = { static_cast<int64_t>(microseconds) * 10 };
+            return timeSpan;
+        };
+
+        Platform::Collections::Map<Platform::String^, uint64>^ counters = ref new Platform::Collections::Map<Platform::String^, uint64>();
+        for (const auto& counter : snapshot.counters)
+        {
+            std::wstring name(counter.first.begin(), counter.first.end());
+            counters->Insert(ref new Platform::String(name.c_str()), counter.second);
+        }
+
+        Platform::Collections::Map<Platform::String^, CrazyGiraffe::AudioIdentification::LatencySummary^>^ latencies =
+            ref new Platform::Collections::Map<Platform::String^, CrazyGiraffe::AudioIdentification::LatencySummary^>();
+        for (const auto& latency : snapshot.latencies)
+        {
+            std::wstring name(latency.first.begin(), latency.first.end());
+            latencies->Insert(
+                ref new Platform::String(name.c_str()),
+                ref new CrazyGiraffe::AudioIdentification::LatencySummary(
+                    latency.second.count,
+                    toTimeSpan(latency.second.Mean()),
+                    toTimeSpan(latency.second.Percentile(0.5)),
+                    toTimeSpan(latency.second.Percentile(0.9)),
+                    toTimeSpan(latency.second.Percentile(0.99)),
+                    toTimeSpan(latency.second.maximum)));
+        }
+
+        return ref new CrazyGiraffe::AudioIdentification::PipelineMetrics(counters->GetView(), latencies->GetView());
+    }
+} }
+#endif
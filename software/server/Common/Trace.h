@@ -0,0 +1,284 @@
+//-----------------------------------------------------------------------
+// <copyright file="Trace.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Common
+{
+    ///
+    /// A finished span: what ran, for which session and attempt, on which thread, when, and how long
+    /// it waited after the previous stage of its chain.
+    ///
+    struct TraceEvent
+    {
+        static const size_t SessionCapacity = 40;
+
+        const char* name;
+        char session[SessionCapacity];
+        uint32_t attempt;
+        uint32_t threadId;
+        uint64_t bytes;
+        int64_t start;
+        int64_t duration;
+        int64_t wait;
+    };
+
+    ///
+    /// The end of the last span of a task chain, so the next span knows how long it waited to run.
+    ///
+    class TraceChain
+    {
+    public:
+        TraceChain()
+            : m_lastEnd(-1)
+        {
+        }
+
+        ///
+        /// Get the end of the last span, or -1 if none.
+        ///
+        int64_t LastEnd() const
+        {
+            return m_lastEnd.load(std::memory_order_relaxed);
+        }
+
+        void SetLastEnd(int64_t value)
+        {
+            m_lastEnd.store(value, std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<int64_t> m_lastEnd;
+    };
+
+    ///
+    /// Tracer which records spans into a buffer per thread, for export as Chrome trace-event JSON
+    /// (chrome://tracing, ui.perfetto.dev). Off by default; when off, a span costs one relaxed load.
+    /// Each thread keeps its latest spans; older ones are overwritten.
+    ///
+    class Tracer
+    {
+    public:
+        ///
+        /// Get the tracer of the module. It lives until the process exits, like the logger.
+        ///
+        static Tracer& Instance()
+        {
+            static Tracer* s_instance = new Tracer();
+            return *s_instance;
+        }
+
+        bool IsEnabled() const
+        {
+            return m_enabled.load(std::memory_order_relaxed);
+        }
+
+        void SetEnabled(bool enabled)
+        {
+            m_enabled.store(enabled, std::memory_order_relaxed);
+        }
+
+        ///
+        /// Get the time of the tracer, in microseconds.
+        ///
+        int64_t Now() const
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+        }
+
+        ///
+        /// Record a span which ran from start to end on the calling thread.
+        ///
+        void Record(
+            const char* name,
+            const wchar_t* session,
+            uint32_t attempt,
+            uint64_t bytes,
+            int64_t start,
+            int64_t end,
+            TraceChain* chain = nullptr)
+        {
+            Buffer& buffer = ThreadBuffer();
+            uint32_t head = buffer.head.load(std::memory_order_relaxed);
+            TraceEvent& event = buffer.events[head % BufferCapacity];
+            event.name = name;
+            event.attempt = attempt;
+            event.threadId = buffer.threadId;
+            event.bytes = bytes;
+            event.start = start;
+            event.duration = end - start;
+            event.wait = -1;
+
+            // Session identifiers are GUIDs, so ASCII.
+            size_t length = 0;
+            for (; session != nullptr && session[length] != L'\0' && length < TraceEvent::SessionCapacity - 1; length++)
+            {
+                event.session[length] = static_cast<char>(session[length]);
+            }
+
+            event.session[length] = '\0';
+
+            if (chain != nullptr)
+            {
+                int64_t lastEnd = chain->LastEnd();
+                event.wait = (lastEnd >= 0 && lastEnd <= start) ? (start - lastEnd) : -1;
+                chain->SetLastEnd(end);
+            }
+
+            buffer.head.store(head + 1, std::memory_order_release);
+        }
+
+        ///
+        /// Write the spans of every thread as Chrome trace-event JSON.
+        ///
+        std::string ExportChromeTrace()
+        {
+            std::vector<TraceEvent> events;
+            {
+                std::lock_guard<std::mutex> lock(m_bufferLock);
+                for (const std::unique_ptr<Buffer>& buffer : m_buffers)
+                {
+                    uint32_t head = buffer->head.load(std::memory_order_acquire);
+                    uint32_t first = (head > BufferCapacity) ? (head - BufferCapacity) : 0;
+                    size_t copied = events.size();
+                    for (uint32_t index = first; index < head; index++)
+                    {
+                        events.push_back(buffer->events[index % BufferCapacity]);
+                    }
+
+                    // Drop what the thread overwrote, or may be overwriting, while it was copied.
+                    uint32_t after = buffer->head.load(std::memory_order_acquire) + 1;
+                    uint32_t overwritten = (after > first + BufferCapacity) ? (after - first - BufferCapacity) : 0;
+                    events.erase(events.begin() + copied, events.begin() + copied + (std::min<size_t>)(overwritten, head - first));
+                }
+            }
+
+            std::string json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+            char line[256];
+            for (size_t index = 0; index < events.size(); index++)
+            {
+                const TraceEvent& event = events[index];
+                snprintf(
+                    line,
+                    sizeof(line),
+                    "%s\n{\"name\":\"%s\",\"cat\":\"recognition\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%lld,\"dur\":%lld,"
+                    "\"args\":{\"session\":\"%s\",\"attempt\":%u,\"bytes\":%llu,\"wait_us\":%lld}}",
+                    (index > 0) ? "," : "",
+                    event.name,
+                    event.threadId,
+                    static_cast<long long>(event.start),
+                    static_cast<long long>(event.duration),
+                    event.session,
+                    event.attempt,
+                    static_cast<unsigned long long>(event.bytes),
+                    static_cast<long long>(event.wait));
+                json.append(line);
+            }
+
+            json.append("\n]}\n");
+            return json;
+        }
+
+    private:
+        static const uint32_t BufferCapacity = 1024;
+
+        ///
+        /// The spans of one thread; only the thread writes it.
+        ///
+        struct Buffer
+        {
+            std::array<TraceEvent, BufferCapacity> events;
+            std::atomic<uint32_t> head;
+            uint32_t threadId;
+        };
+
+        Tracer()
+            : m_enabled(false)
+            , m_epoch(std::chrono::steady_clock::now())
+            , m_nextThreadId(1)
+        {
+        }
+
+        Buffer& ThreadBuffer()
+        {
+            thread_local Buffer* t_buffer = nullptr;
+            if (t_buffer == nullptr)
+            {
+                // Only threads which record get a buffer, so none exist until tracing is enabled.
+                std::unique_ptr<Buffer> buffer(new Buffer());
+                buffer->head = 0;
+                buffer->threadId = m_nextThreadId++;
+                t_buffer = buffer.get();
+
+                std::lock_guard<std::mutex> lock(m_bufferLock);
+                m_buffers.push_back(std::move(buffer));
+            }
+
+            return *t_buffer;
+        }
+
+    private:
+        std::atomic<bool> m_enabled;
+        std::chrono::steady_clock::time_point m_epoch;
+        std::atomic<uint32_t> m_nextThreadId;
+        std::mutex m_bufferLock;
+        std::vector<std::unique_ptr<Buffer>> m_buffers;
+    };
+
+    ///
+    /// Records the time from construction to destruction as a span, if tracing is enabled
+    /// when it is constructed. The bytes can be set once they are known.
+    ///
+    class TraceSpan
+    {
+    public:
+        TraceSpan(const char* name, const wchar_t* session, uint32_t attempt, TraceChain* chain = nullptr, uint64_t bytes = 0)
+            : m_name(name)
+            , m_session(session)
+            , m_attempt(attempt)
+            , m_chain(chain)
+            , m_bytes(bytes)
+            , m_start(Tracer::Instance().IsEnabled() ? Tracer::Instance().Now() : -1)
+        {
+        }
+
+        ~TraceSpan()
+        {
+            if (m_start >= 0)
+            {
+                Tracer& tracer = Tracer::Instance();
+                tracer.Record(m_name, m_session, m_attempt, m_bytes, m_start, tracer.Now(), m_chain);
+            }
+        }
+
+        void SetBytes(uint64_t bytes)
+        {
+            m_bytes = bytes;
+        }
+
+    private:
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+
+        const char* m_name;
+        const wchar_t* m_session;
+        uint32_t m_attempt;
+        TraceChain* m_chain;
+        uint64_t m_bytes;
+        int64_t m_start;
+    };
+} }
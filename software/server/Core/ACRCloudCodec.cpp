@@ -0,0 +1,230 @@
+//-----------------------------------------------------------------------
+// <copyright file="ACRCloudCodec.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "ACRCloudCodec.h"
+#include "Crypto.h"
+#include "Json.h"
+#include "Logger.h"
+#include <sstream>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    const char* const Method = "POST";
+    const char* const DataType = "fingerprint";
+    const char* const SignatureVersion = "1";
+    const char* const BoundaryHeader = "acrcloud___copyright___2015___";
+
+    void AppendText(std::vector<uint8_t>& body, const std::string& text)
+    {
+        body.insert(body.end(), text.begin(), text.end());
+    }
+
+    void AppendField(std::vector<uint8_t>& body, const std::string& boundary, const char* name, const std::string& value)
+    {
+        AppendText(body, "--" + boundary + "\r\n");
+        AppendText(body, "Content-Type: text/plain; charset=UTF-8\r\n");
+        AppendText(body, std::string("Content-Disposition: form-data; name=\"") + name + "\"\r\n\r\n");
+        AppendText(body, value);
+        AppendText(body, "\r\n");
+    }
+
+    // The first object of a named array, or nullptr if it's missing or empty.
+    const JsonValue* FirstOf(const JsonValue& object, const char* name)
+    {
+        const JsonValue* array = object.Find(name);
+        if (array == nullptr || array->AsArray().empty())
+        {
+            return nullptr;
+        }
+
+        return &array->AsArray().front();
+    }
+
+    TrackInfo ParseTrack(const JsonValue& music)
+    {
+        TrackInfo track;
+
+        // Get basic metadata. Per the docs, this stuff is required.
+        // Please note: Only ACRID, Track Title, Artists Name and Album Name fields are required, other fields are optional.
+        track.identifier = music["acrid"].AsString();
+        track.title = music["title"].AsString();
+        track.album = music["album"]["name"].AsString();
+
+        // Get artist (first one)
+        if (!music["artists"].AsArray().empty())
+        {
+            track.artist = music["artists"].AsArray().front()["name"].AsString();
+        }
+
+        // Get extended metadata. Per the docs, this stuff is optional.
+        const JsonValue* genre = FirstOf(music, "genres");
+        if (genre != nullptr)
+        {
+            track.genre = (*genre)["name"].AsString();
+        }
+
+        const JsonValue* duration = music.Find("duration_ms");
+        if (duration != nullptr)
+        {
+            track.duration = static_cast<int32_t>(duration->AsNumber());
+        }
+
+        const JsonValue* playOffset = music.Find("play_offset_ms");
+        if (playOffset != nullptr)
+        {
+            track.currentPosition = static_cast<int32_t>(playOffset->AsNumber());
+            track.matchPosition = track.currentPosition;
+        }
+
+        const JsonValue* score = music.Find("score");
+        if (score != nullptr)
+        {
+            std::ostringstream scoreStream;
+            scoreStream << score->AsNumber();
+            track.matchConfidence = scoreStream.str();
+        }
+
+        // Get external info to retrieve cover art; just grab the first one.
+        const JsonValue* externalLinks = music.Find("external_metadata");
+        const JsonValue* musicbrainz = (externalLinks != nullptr) ? FirstOf(*externalLinks, "musicbrainz") : nullptr;
+        const JsonValue* musicbrainzTrack = (musicbrainz != nullptr) ? musicbrainz->Find("track") : nullptr;
+        if (musicbrainzTrack != nullptr)
+        {
+            track.coverArtUrl = "http://coverartarchive.org/release/" + (*musicbrainzTrack)["id"].AsString() + "/front";
+        }
+
+        return track;
+    }
+}
+
+const char* const ACRCloudCodec::RequestPath = "/v1/identify";
+
+std::string ACRCloudCodec::CreateSignature(const std::string& input, const std::string& key)
+{
+    Sha1Digest hash = HmacSha1(
+        reinterpret_cast<const uint8_t*>(key.data()),
+        key.size(),
+        reinterpret_cast<const uint8_t*>(input.data()),
+        input.size());
+    return Base64Encode(hash.data(), hash.size());
+}
+
+ACRCloudRequestFields ACRCloudCodec::CreateRequestFields(
+    const std::string& accessKey,
+    const std::string& accessSecret,
+    int64_t timestamp,
+    size_t sampleBytes)
+{
+    ACRCloudRequestFields fields;
+    fields.accessKey = accessKey;
+    fields.timestamp = std::to_string(timestamp);
+    fields.dataType = DataType;
+    fields.signatureVersion = SignatureVersion;
+    fields.sampleBytes = std::to_string(sampleBytes);
+
+    std::ostringstream signatureInput;
+    signatureInput << Method << "\n" << RequestPath << "\n" << accessKey << "\n";
+    signatureInput << DataType << "\n" << SignatureVersion << "\n" << timestamp;
+    fields.signature = CreateSignature(signatureInput.str(), accessSecret);
+
+    return fields;
+}
+
+std::string ACRCloudCodec::CreateBoundary(uint64_t unique)
+{
+    std::ostringstream boundary;
+    boundary << BoundaryHeader << std::hex << unique;
+    return boundary.str();
+}
+
+std::string ACRCloudCodec::CreateContentType(const std::string& boundary)
+{
+    return "multipart/form-data; boundary=" + boundary;
+}
+
+std::vector<uint8_t> ACRCloudCodec::CreateRequestBody(
+    const ACRCloudRequestFields& fields,
+    const std::string& boundary,
+    const uint8_t* sample,
+    size_t sampleSize)
+{
+    std::vector<uint8_t> body;
+    body.reserve(1024 + sampleSize);
+
+    AppendField(body, boundary, "access_key", fields.accessKey);
+    AppendField(body, boundary, "timestamp", fields.timestamp);
+    AppendField(body, boundary, "signature", fields.signature);
+    AppendField(body, boundary, "data_type", fields.dataType);
+    AppendField(body, boundary, "signature_version", fields.signatureVersion);
+    AppendField(body, boundary, "sample_bytes", fields.sampleBytes);
+
+    AppendText(body, "--" + boundary + "\r\n");
+    AppendText(body, "Content-Disposition: form-data; name=\"sample\"; filename=\"sample\"\r\n");
+    AppendText(body, "Content-Type: application/octet-stream\r\n\r\n");
+    if (sampleSize > 0)
+    {
+        body.insert(body.end(), sample, sample + sampleSize);
+    }
+
+    AppendText(body, "\r\n--" + boundary + "--\r\n");
+    return body;
+}
+
+ACRCloudTrackResult ACRCloudCodec::ParseTrackResponse(const std::string& responseBody)
+{
+    ACRCloudTrackResult result;
+    JsonValue root = JsonValue::Parse(responseBody);
+
+    //"status":{
+    //    "msg":"Success",
+    //    "version" : "1.0",
+    //    "code" : 0
+    //},
+    const JsonValue* status = root.Find("status");
+    if (status == nullptr)
+    {
+        LOG_WARNING("ParseTrackResponse: status missing");
+        return result;
+    }
+
+    result.message = (*status)["msg"].AsString();
+    result.version = (*status)["version"].AsString();
+    result.code = static_cast<int16_t>((*status)["code"].AsNumber());
+    if (result.code != 0)
+    {
+        LOG_DEBUG("ParseTrackResponse: code = %d", static_cast<int>(result.code));
+        return result;
+    }
+
+    //"metadata":{
+    //    "timestamp_utc":"2020-01-19 02:58:28",
+    //    "music" : [
+    //        ...
+    //    ]
+    const JsonValue* metadata = root.Find("metadata");
+    const JsonValue* music = (metadata != nullptr) ? metadata->Find("music") : nullptr;
+    if (music == nullptr)
+    {
+        LOG_WARNING("ParseTrackResponse: music missing");
+        return result;
+    }
+
+    for (const JsonValue& entry : music->AsArray())
+    {
+        try
+        {
+            result.tracks.push_back(ParseTrack(entry));
+        }
+        catch (const JsonError& ex)
+        {
+            LOG_WARNING("ParseTrackResponse track exception: %s", ex.what());
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,97 @@
+//-----------------------------------------------------------------------
+// <copyright file="ACRCloudCodec.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "Track.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// The signed fields of an identify request.
+    ///
+    struct ACRCloudRequestFields
+    {
+        std::string accessKey;
+        std::string timestamp;
+        std::string signature;
+        std::string dataType;
+        std::string signatureVersion;
+        std::string sampleBytes;
+    };
+
+    ///
+    /// The status and tracks of an identify response.
+    ///
+    struct ACRCloudTrackResult
+    {
+        ACRCloudTrackResult()
+            : code(-1)
+        {
+        }
+
+        std::string message;
+        std::string version;
+        int16_t code;
+        std::vector<TrackInfo> tracks;
+    };
+
+    ///
+    /// Encodes identify requests and decodes their responses, per the ACRCloud identification API
+    /// (https://docs.acrcloud.com/reference/identification-api), with no transport.
+    ///
+    class ACRCloudCodec
+    {
+    public:
+        ///
+        /// The path of the identify endpoint.
+        ///
+        static const char* const RequestPath;
+
+        ///
+        /// Create the base64 HMAC-SHA1 signature of input.
+        ///
+        static std::string CreateSignature(const std::string& input, const std::string& key);
+
+        ///
+        /// Create the signed fields for a fingerprint of the given size, at a Unix time.
+        ///
+        static ACRCloudRequestFields CreateRequestFields(
+            const std::string& accessKey,
+            const std::string& accessSecret,
+            int64_t timestamp,
+            size_t sampleBytes);
+
+        ///
+        /// Create a mime boundary which is unique for a unique value, such as the time.
+        ///
+        static std::string CreateBoundary(uint64_t unique);
+
+        ///
+        /// Get the content type of a multi-part form with the given boundary.
+        ///
+        static std::string CreateContentType(const std::string& boundary);
+
+        ///
+        /// Create the multi-part form of a request, with the fingerprint as the sample.
+        ///
+        static std::vector<uint8_t> CreateRequestBody(
+            const ACRCloudRequestFields& fields,
+            const std::string& boundary,
+            const uint8_t* sample,
+            size_t sampleSize);
+
+        ///
+        /// Parse a response. A track missing a required field is skipped; a malformed
+        /// document or status throws JsonError.
+        ///
+        static ACRCloudTrackResult ParseTrackResponse(const std::string& responseBody);
+    };
+} }
@@ -0,0 +1,319 @@
+//-----------------------------------------------------------------------
+// <copyright file="ArtifactDetector.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "ArtifactDetector.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    // A click's second difference stands this far above its recent level, and above the dither.
+    const float ClickRatio = 12.0f;
+    const float MinimumClick = 0.001f;
+
+    // The recent level of the second difference follows about this long.
+    const double ClickLevelSeconds = 0.01;
+
+    // A run of outliers ends after this many frames without one; the frame after the run must be in.
+    const uint64_t ClickGuard = 4;
+
+    // The second difference over the next couple of milliseconds tells a click, after which it is
+    // back within 3dB of its level, from an onset of the music.
+    const double ClickPostSeconds = 0.002;
+    const float OnsetRatio = 2.0f;
+
+    // A dropout falls 25dB below the recent level of the blocks, from a block within 6dB of it, and
+    // ends once back within 10dB, unless the level was already quiet (-40dB). Music dies away into
+    // its gaps rather than falling into them.
+    const float DropoutRatio = 0.003f;
+    const float AbruptRatio = 0.25f;
+    const float RecoveryRatio = 0.1f;
+    const float MinimumLevel = 1e-4f;
+
+    // The recent level of the blocks follows about this many blocks.
+    const float LevelRate = 0.05f;
+}
+
+ArtifactDetector::ArtifactDetector(uint32_t sampleRate, uint16_t channelCount)
+    : m_channelCount(channelCount)
+    , m_maximumClick(0)
+    , m_maximumDropout(0)
+    , m_blockFrames(0)
+    , m_latency(0)
+    , m_buffer()
+    , m_frameCount(0)
+    , m_channel(0)
+    , m_previous()
+    , m_clickLevel(0)
+    , m_clickRate(0)
+    , m_inClick(false)
+    , m_clickFirst(0)
+    , m_clickLast(0)
+    , m_clickPost(0)
+    , m_clickPostFrames(0)
+    , m_clickPostFill(0)
+    , m_blockEnergy(0)
+    , m_blockFill(0)
+    , m_previousEnergy()
+    , m_level(0)
+    , m_inDropout(false)
+    , m_dropoutFirst(0)
+    , m_pendingDropouts()
+    , m_clickCount(0)
+    , m_dropoutCount(0)
+{
+    if (sampleRate < 1000)
+    {
+        throw std::invalid_argument("sampleRate");
+    }
+
+    if (channelCount == 0)
+    {
+        throw std::invalid_argument("channelCount");
+    }
+
+    m_maximumClick = sampleRate * MaximumClickMilliseconds / 1000;
+    m_maximumDropout = sampleRate * MaximumDropoutMilliseconds / 1000;
+    m_blockFrames = sampleRate / 1000;
+    m_clickRate = static_cast<float>(1.0 / (ClickLevelSeconds * sampleRate));
+    m_clickPostFrames = static_cast<uint32_t>(ClickPostSeconds * sampleRate);
+
+    // A click is bridged once the frames after it are heard, well within the latency. A dropout,
+    // widened by a block either side, is filled once as much audio again has followed it; the output
+    // waits for that, and the buffer keeps as much again before it for the fill.
+    uint32_t maximumRegion = m_maximumDropout + 2 * m_blockFrames;
+    m_latency = 2 * maximumRegion + 1;
+    m_buffer.assign(static_cast<size_t>(m_latency + maximumRegion + 2) * channelCount, 0.0f);
+}
+
+uint32_t ArtifactDetector::Latency() const
+{
+    return m_latency;
+}
+
+uint32_t ArtifactDetector::ClickCount() const
+{
+    return m_clickCount;
+}
+
+uint32_t ArtifactDetector::DropoutCount() const
+{
+    return m_dropoutCount;
+}
+
+void ArtifactDetector::ProcessSamples(const float* input, size_t count, float* output, const ArtifactHandler& repaired)
+{
+    for (size_t index = 0; index < count; index++)
+    {
+        // The frame a latency back was last repaired by the frame before this one.
+        output[index] = (m_frameCount >= m_latency) ? Sample(m_frameCount - m_latency, m_channel) : 0.0f;
+        Sample(m_frameCount, m_channel) = input[index];
+        if (++m_channel < m_channelCount)
+        {
+            continue;
+        }
+
+        m_channel = 0;
+        AnalyseFrame(repaired);
+        m_frameCount++;
+    }
+}
+
+void ArtifactDetector::AnalyseFrame(const ArtifactHandler& repaired)
+{
+    uint64_t frame = m_frameCount;
+    float mix = 0;
+    for (uint16_t channel = 0; channel < m_channelCount; channel++)
+    {
+        mix += Sample(frame, channel);
+    }
+
+    mix /= m_channelCount;
+
+    // An impulse stands out in the second difference, which music, falling off with frequency, doesn't.
+    float difference = mix - 2 * m_previous[0] + m_previous[1];
+    m_previous[1] = m_previous[0];
+    m_previous[0] = mix;
+
+    FindClick(frame, difference * difference, repaired);
+    FindDropout(frame, mix, repaired);
+}
+
+void ArtifactDetector::FindClick(uint64_t frame, float power, const ArtifactHandler& repaired)
+{
+    if (m_clickPostFill > 0)
+    {
+        // A click leaves the music after it as it was before; an onset of the music doesn't.
+        m_clickPost += power;
+        if (++m_clickPostFill >= m_clickPostFrames)
+        {
+            float after = m_clickPost / m_clickPostFrames;
+            m_clickPostFill = 0;
+            if (after < OnsetRatio * m_clickLevel)
+            {
+                RepairClick(m_clickFirst, m_clickLast, repaired);
+            }
+            else
+            {
+                m_clickLevel = after;
+            }
+        }
+
+        return;
+    }
+
+    bool isOutlier = frame >= 2 && power > ClickRatio * ClickRatio * m_clickLevel && power > MinimumClick * MinimumClick;
+    if (isOutlier)
+    {
+        if (!m_inClick)
+        {
+            m_inClick = true;
+            m_clickFirst = frame;
+        }
+
+        m_clickLast = frame;
+
+        // Too long for a click: a transient of the music, which the level should now follow.
+        if (m_clickLast - m_clickFirst + 1 > m_maximumClick + 2)
+        {
+            m_inClick = false;
+            m_clickLevel = power;
+        }
+    }
+    else if (m_inClick && frame - m_clickLast >= ClickGuard)
+    {
+        m_inClick = false;
+        m_clickPost = power;
+        m_clickPostFill = 1;
+    }
+    else if (!m_inClick)
+    {
+        m_clickLevel += (power - m_clickLevel) * m_clickRate;
+    }
+}
+
+void ArtifactDetector::FindDropout(uint64_t frame, float mix, const ArtifactHandler& repaired)
+{
+    m_blockEnergy += mix * mix;
+    if (++m_blockFill == m_blockFrames)
+    {
+        float energy = m_blockEnergy / m_blockFrames;
+        uint64_t blockFirst = frame + 1 - m_blockFrames;
+        m_blockEnergy = 0;
+        m_blockFill = 0;
+
+        if (!m_inDropout)
+        {
+            if (m_level >= MinimumLevel && energy < m_level * DropoutRatio && m_previousEnergy[1] >= m_level * AbruptRatio)
+            {
+                m_inDropout = true;
+                m_dropoutFirst = blockFirst;
+            }
+            else
+            {
+                m_level += (energy - m_level) * LevelRate;
+            }
+        }
+        else if (energy >= m_level * RecoveryRatio)
+        {
+            // The edges are somewhere in the blocks either side, which held up too well to count.
+            m_inDropout = false;
+            uint64_t first = m_dropoutFirst - m_blockFrames;
+            uint64_t length = blockFirst + m_blockFrames - first;
+            m_pendingDropouts.push_back({ ArtifactType::Dropout, first, static_cast<uint32_t>(length) });
+            m_level += (energy - m_level) * LevelRate;
+        }
+        else if (frame + 1 - m_dropoutFirst > m_maximumDropout)
+        {
+            // Too long for a dropout: a pause in the music, which the level should now follow.
+            m_inDropout = false;
+            m_level = energy;
+        }
+
+        m_previousEnergy[1] = m_previousEnergy[0];
+        m_previousEnergy[0] = energy;
+    }
+
+    // A dropout is filled once the audio after it, as long as it, is in.
+    while (!m_pendingDropouts.empty() && frame + 1 >= m_pendingDropouts.front().position + 2 * m_pendingDropouts.front().length)
+    {
+        const Artifact& dropout = m_pendingDropouts.front();
+        RepairDropout(dropout.position, dropout.position + dropout.length - 1, repaired);
+        m_pendingDropouts.erase(m_pendingDropouts.begin());
+    }
+}
+
+void ArtifactDetector::RepairClick(uint64_t first, uint64_t last, const ArtifactHandler& repaired)
+{
+    // The outliers run two frames past the impulse, so the frames before the first and at the last
+    // are clean. A cubic between them, matching their slopes, follows the music across. A lone
+    // outlier leaves nothing between them.
+    if (first < 2 || last == first)
+    {
+        return;
+    }
+
+    uint64_t before = first - 1;
+    uint64_t after = last;
+    float span = static_cast<float>(after - before);
+    for (uint16_t channel = 0; channel < m_channelCount; channel++)
+    {
+        float start = Sample(before, channel);
+        float end = Sample(after, channel);
+        float startSlope = (start - Sample(before - 1, channel)) * span;
+        float endSlope = (Sample(after + 1, channel) - end) * span;
+        for (uint64_t frame = before + 1; frame < after; frame++)
+        {
+            float t = static_cast<float>(frame - before) / span;
+            float t2 = t * t;
+            float t3 = t2 * t;
+            Sample(frame, channel) =
+                (2 * t3 - 3 * t2 + 1) * start + (t3 - 2 * t2 + t) * startSlope + (-2 * t3 + 3 * t2) * end + (t3 - t2) * endSlope;
+        }
+    }
+
+    m_clickCount++;
+    if (repaired)
+    {
+        repaired({ ArtifactType::Click, before + 1, static_cast<uint32_t>(after - before - 1) });
+    }
+}
+
+void ArtifactDetector::RepairDropout(uint64_t first, uint64_t last, const ArtifactHandler& repaired)
+{
+    // The audio before the dropout, reversed, fades into the audio after it, reversed, so the fill
+    // meets each edge at the sample next to it.
+    uint64_t length = last - first + 1;
+    if (first < length)
+    {
+        return;
+    }
+
+    for (uint16_t channel = 0; channel < m_channelCount; channel++)
+    {
+        for (uint64_t offset = 0; offset < length; offset++)
+        {
+            float fraction = static_cast<float>(offset + 1) / static_cast<float>(length + 1);
+            float before = Sample(first - 1 - offset, channel);
+            float after = Sample(last + length - offset, channel);
+            Sample(first + offset, channel) = before + (after - before) * fraction;
+        }
+    }
+
+    m_dropoutCount++;
+    if (repaired)
+    {
+        repaired({ ArtifactType::Dropout, first, static_cast<uint32_t>(length) });
+    }
+}
+
+float& ArtifactDetector::Sample(uint64_t frame, uint16_t channel)
+{
+    size_t frames = m_buffer.size() / m_channelCount;
+    return m_buffer[static_cast<size_t>(frame % frames) * m_channelCount + channel];
+}
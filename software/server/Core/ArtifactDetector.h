@@ -0,0 +1,167 @@
+//-----------------------------------------------------------------------
+// <copyright file="ArtifactDetector.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// The kind of damage a worn tape does.
+    ///
+    enum class ArtifactType
+    {
+        ///
+        /// A short impulse, such as a splice or a scratch.
+        ///
+        Click = 0,
+
+        ///
+        /// A short collapse of the level, where the tape lost contact with the head.
+        ///
+        Dropout = 1,
+    };
+
+    ///
+    /// A repaired artifact: the frame of the input it starts at, and its length in frames.
+    ///
+    struct Artifact
+    {
+        ArtifactType type;
+        uint64_t position;
+        uint32_t length;
+    };
+
+    ///
+    /// Finds and repairs the clicks and dropouts of a stream. A click is a run of a few samples whose
+    /// second difference stands far above its level before and after, and is bridged by a cubic; a
+    /// dropout is a few milliseconds suddenly far below the recent level, and is filled by crossfading
+    /// the audio either side of it, mirrored. Longer runs are left alone, as the music. The output is the
+    /// input, repaired, late by the latency; each sample costs a few operations a channel.
+    ///
+    class ArtifactDetector
+    {
+    public:
+        ///
+        /// Called with each artifact as it is repaired.
+        ///
+        using ArtifactHandler = std::function<void(const Artifact&)>;
+
+        ///
+        /// The longest click and dropout repaired, in milliseconds.
+        ///
+        static const uint32_t MaximumClickMilliseconds = 1;
+        static const uint32_t MaximumDropoutMilliseconds = 30;
+
+        ArtifactDetector(uint32_t sampleRate, uint16_t channelCount);
+
+        ///
+        /// Get the frames the output is behind the input.
+        ///
+        uint32_t Latency() const;
+
+        ///
+        /// Get the artifacts repaired so far.
+        ///
+        uint32_t ClickCount() const;
+        uint32_t DropoutCount() const;
+
+        ///
+        /// Repair interleaved samples, -1 to 1, into as many samples of output.
+        ///
+        void ProcessSamples(const float* input, size_t count, float* output, const ArtifactHandler& repaired);
+
+    private:
+        ///
+        /// Mix the newest frame down and look for artifacts in it.
+        ///
+        void AnalyseFrame(const ArtifactHandler& repaired);
+
+        ///
+        /// Add the second difference of a frame to the run of outliers, or to the level after one.
+        ///
+        void FindClick(uint64_t frame, float power, const ArtifactHandler& repaired);
+
+        ///
+        /// Add the mix of a frame to the block, and look for a dropout once it is full.
+        ///
+        void FindDropout(uint64_t frame, float mix, const ArtifactHandler& repaired);
+
+        void RepairClick(uint64_t first, uint64_t last, const ArtifactHandler& repaired);
+
+        void RepairDropout(uint64_t first, uint64_t last, const ArtifactHandler& repaired);
+
+        ///
+        /// Get a sample of a frame held in the buffer.
+        ///
+        float& Sample(uint64_t frame, uint16_t channel);
+
+    private:
+        ///
+        /// The input format.
+        ///
+        uint16_t m_channelCount;
+
+        ///
+        /// The limits, in frames.
+        ///
+        uint32_t m_maximumClick;
+        uint32_t m_maximumDropout;
+        uint32_t m_blockFrames;
+        uint32_t m_latency;
+
+        ///
+        /// The frames from before the output, for the mirrored fill, to the newest, interleaved.
+        ///
+        std::vector<float> m_buffer;
+        uint64_t m_frameCount;
+
+        ///
+        /// The channels of the frame being added.
+        ///
+        uint16_t m_channel;
+
+        ///
+        /// The click search: the last two frames of the mix, the recent level of its second
+        /// difference, the run of outliers, if any, and the level after a run once it ends.
+        ///
+        float m_previous[2];
+        float m_clickLevel;
+        float m_clickRate;
+        bool m_inClick;
+        uint64_t m_clickFirst;
+        uint64_t m_clickLast;
+        float m_clickPost;
+        uint32_t m_clickPostFrames;
+        uint32_t m_clickPostFill;
+
+        ///
+        /// The dropout search: the energy of the block so far and of the last two, the recent level
+        /// of the blocks, and the collapsed blocks, if any.
+        ///
+        float m_blockEnergy;
+        uint32_t m_blockFill;
+        float m_previousEnergy[2];
+        float m_level;
+        bool m_inDropout;
+        uint64_t m_dropoutFirst;
+
+        ///
+        /// The dropouts found, waiting on the audio after them.
+        ///
+        std::vector<Artifact> m_pendingDropouts;
+
+        ///
+        /// The artifacts repaired.
+        ///
+        uint32_t m_clickCount;
+        uint32_t m_dropoutCount;
+    };
+} }
@@ -0,0 +1,61 @@
+//-----------------------------------------------------------------------
+// <copyright file="AudioFormat.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// A duration in 100-nanosecond units, as Windows::Foundation::TimeSpan.
+    ///
+    using Ticks = std::chrono::duration<int64_t, std::ratio<1, 10000000>>;
+
+    ///
+    /// How samples are encoded.
+    ///
+    enum class SampleType
+    {
+        ///
+        /// Little-endian integers.
+        ///
+        Pcm = 0,
+
+        ///
+        /// 32-bit floats from -1 to 1.
+        ///
+        Float = 1,
+    };
+
+    ///
+    /// The format of interleaved audio.
+    ///
+    struct AudioFormat
+    {
+        uint32_t sampleRate;
+        uint16_t channelCount;
+        uint16_t bitsPerSample;
+        SampleType sampleType;
+
+        ///
+        /// Get the bytes of one sample for every channel.
+        ///
+        uint32_t BytesPerFrame() const
+        {
+            return static_cast<uint32_t>(channelCount) * (bitsPerSample / 8);
+        }
+
+        ///
+        /// Get the bytes of one second of audio.
+        ///
+        uint32_t BytesPerSecond() const
+        {
+            return sampleRate * BytesPerFrame();
+        }
+    };
+} }
@@ -0,0 +1,107 @@
+//-----------------------------------------------------------------------
+// <copyright file="AudioFrameConverter.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "AudioFrameConverter.h"
+#include <cstring>
+#include <stdexcept>
+
+using namespace CrazyGiraffe::Core;
+
+AudioFrameConverter::AudioFrameConverter(SampleType sampleType, uint32_t bitsPerSample)
+    : m_sampleType(sampleType)
+    , m_sampleSize(sizeof(float))
+    , m_maxValue(0)
+{
+    if (m_sampleType == SampleType::Pcm)
+    {
+        switch (bitsPerSample)
+        {
+        case 8:
+            m_sampleSize = 1;
+            m_maxValue = 0xff;
+            break;
+        case 16:
+            m_sampleSize = 2;
+            m_maxValue = 0xffff;
+            break;
+        case 24:
+            m_sampleSize = 3;
+            m_maxValue = 0xffffff;
+            break;
+        case 32:
+            m_sampleSize = 4;
+            m_maxValue = 0xffffffff;
+            break;
+        default:
+            throw std::invalid_argument("bitsPerSample");
+        }
+    }
+}
+
+size_t AudioFrameConverter::OutputSize(size_t sampleCount) const
+{
+    return sampleCount * m_sampleSize;
+}
+
+void AudioFrameConverter::Convert(const float* samples, size_t sampleCount, uint8_t* output) const
+{
+    if (m_sampleType == SampleType::Float)
+    {
+        memcpy(output, samples, sampleCount * sizeof(float));
+        return;
+    }
+
+    for (size_t i = 0; i < sampleCount; i++)
+    {
+        // Negative samples wrap to their two's complement, as the cast to uint32 does on Windows.
+        double scaled = static_cast<double>(samples[i]) * m_maxValue;
+        uint32_t value = static_cast<uint32_t>(static_cast<int64_t>(scaled));
+        for (uint32_t byte = 0; byte < m_sampleSize; byte++)
+        {
+            *output++ = static_cast<uint8_t>(value >> (byte * 8));
+        }
+    }
+}
+
+std::vector<uint8_t> AudioFrameConverter::Convert(const float* samples, size_t sampleCount) const
+{
+    std::vector<uint8_t> output(OutputSize(sampleCount));
+    Convert(samples, sampleCount, output.data());
+    return output;
+}
+
+void AudioFrameConverter::ConvertToFloat(const uint8_t* input, size_t sampleCount, uint32_t bitsPerSample, float* samples)
+{
+    uint32_t sampleSize = bitsPerSample / 8;
+    if (sampleSize < 1 || sampleSize > 4)
+    {
+        throw std::invalid_argument("bitsPerSample");
+    }
+
+    // 8-bit PCM is unsigned; wider PCM is signed.
+    double scale = 1.0 / static_cast<double>(1ull << (bitsPerSample - 1));
+    for (size_t i = 0; i < sampleCount; i++)
+    {
+        uint32_t value = 0;
+        for (uint32_t byte = 0; byte < sampleSize; byte++)
+        {
+            value |= static_cast<uint32_t>(*input++) << (byte * 8);
+        }
+
+        int64_t sample = 0;
+        if (sampleSize == 1)
+        {
+            sample = static_cast<int64_t>(value) - 128;
+        }
+        else
+        {
+            uint32_t signBit = 1u << (bitsPerSample - 1);
+            sample = (value & signBit) ? static_cast<int64_t>(value) - (static_cast<int64_t>(signBit) << 1) : value;
+        }
+
+        samples[i] = static_cast<float>(sample * scale);
+    }
+}
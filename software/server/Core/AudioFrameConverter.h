@@ -0,0 +1,60 @@
+//-----------------------------------------------------------------------
+// <copyright file="AudioFrameConverter.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "AudioFormat.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// Converts float samples to the sample type and size of an output format.
+    ///
+    class AudioFrameConverter
+    {
+    public:
+        ///
+        /// Create a converter. Throws std::invalid_argument if PCM bits are not 8, 16, 24 or 32.
+        ///
+        AudioFrameConverter(SampleType sampleType, uint32_t bitsPerSample);
+
+        ///
+        /// Get the bytes the given count of samples converts to.
+        ///
+        size_t OutputSize(size_t sampleCount) const;
+
+        ///
+        /// Convert samples into output, which must hold OutputSize(sampleCount) bytes.
+        ///
+        void Convert(const float* samples, size_t sampleCount, uint8_t* output) const;
+
+        std::vector<uint8_t> Convert(const float* samples, size_t sampleCount) const;
+
+        ///
+        /// Convert little-endian PCM samples to floats from -1 to 1, as the inverse of Convert.
+        ///
+        static void ConvertToFloat(const uint8_t* input, size_t sampleCount, uint32_t bitsPerSample, float* samples);
+
+    private:
+        ///
+        /// The output sample type.
+        ///
+        SampleType m_sampleType;
+
+        ///
+        /// The bytes of each output sample.
+        ///
+        uint32_t m_sampleSize;
+
+        ///
+        /// The value a sample of 1.0 converts to.
+        ///
+        uint32_t m_maxValue;
+    };
+} }
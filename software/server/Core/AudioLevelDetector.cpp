@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------
+// <copyright file="AudioLevelDetector.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "AudioLevelDetector.h"
+#include <cmath>
+
+using namespace CrazyGiraffe::Core;
+
+AudioLevelDetector::AudioLevelDetector(
+    uint32_t sampleRate,
+    uint32_t channelCount,
+    double thresholdValue,
+    Ticks thresholdDuration)
+    : m_thresholdValue(thresholdValue)
+    , m_thresholdDuration(thresholdDuration)
+    , m_status(ThresholdStatus::Unknown)
+    , m_thresholdMaxCount(0)
+    , m_thresholdBelowCount(0)
+    , m_thresholdAboveCount(0)
+{
+    // The max count is the samples per second (for every channel) over the duration.
+    int64_t samplesPerSecond = static_cast<int64_t>(sampleRate) * channelCount;
+    m_thresholdMaxCount = (samplesPerSecond * m_thresholdDuration.count()) / Ticks::period::den;
+}
+
+double AudioLevelDetector::ThresholdValue() const
+{
+    return m_thresholdValue;
+}
+
+Ticks AudioLevelDetector::ThresholdDuration() const
+{
+    return m_thresholdDuration;
+}
+
+ThresholdStatus AudioLevelDetector::Status() const
+{
+    return m_status;
+}
+
+void AudioLevelDetector::ProcessSamples(const float* samples, size_t sampleCount, const StatusChangedHandler& statusChanged)
+{
+    if (samples == nullptr)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < sampleCount; i++)
+    {
+        double level = std::abs(samples[i]);
+        if (m_status != ThresholdStatus::BelowThreshold && level <= m_thresholdValue)
+        {
+            if (++m_thresholdBelowCount >= m_thresholdMaxCount)
+            {
+                m_status = ThresholdStatus::BelowThreshold;
+                m_thresholdBelowCount = 0;
+                if (statusChanged)
+                {
+                    statusChanged(m_status);
+                }
+            }
+        }
+        else if (m_status != ThresholdStatus::AboveThreshold && level > m_thresholdValue)
+        {
+            if (++m_thresholdAboveCount >= m_thresholdMaxCount)
+            {
+                m_status = ThresholdStatus::AboveThreshold;
+                m_thresholdAboveCount = 0;
+                if (statusChanged)
+                {
+                    statusChanged(m_status);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+//-----------------------------------------------------------------------
+// <copyright file="AudioLevelDetector.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "AudioFormat.h"
+#include <cstddef>
+#include <functional>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// Whether the level has stayed below or above the threshold.
+    ///
+    enum class ThresholdStatus
+    {
+        ///
+        /// Level is unknown.
+        ///
+        Unknown = 0,
+
+        ///
+        /// Level has been below the threshold for the threshold duration.
+        ///
+        BelowThreshold = 1,
+
+        ///
+        /// Level has been above the threshold for the threshold duration.
+        ///
+        AboveThreshold = 2,
+    };
+
+    ///
+    /// Detects a level held for a period of time, in float samples.
+    ///
+    class AudioLevelDetector
+    {
+    public:
+        ///
+        /// Called with the new status whenever it changes.
+        ///
+        using StatusChangedHandler = std::function<void(ThresholdStatus)>;
+
+        AudioLevelDetector(
+            uint32_t sampleRate,
+            uint32_t channelCount,
+            double thresholdValue,
+            Ticks thresholdDuration);
+
+        double ThresholdValue() const;
+
+        Ticks ThresholdDuration() const;
+
+        ThresholdStatus Status() const;
+
+        ///
+        /// Process interleaved samples. The channels aren't told apart: every sample counts towards the duration.
+        ///
+        void ProcessSamples(const float* samples, size_t sampleCount, const StatusChangedHandler& statusChanged);
+
+    private:
+        ///
+        /// The audio threshold value.
+        ///
+        double m_thresholdValue;
+
+        ///
+        /// The audio threshold duration.
+        ///
+        Ticks m_thresholdDuration;
+
+        ///
+        /// The status of the level.
+        ///
+        ThresholdStatus m_status;
+
+        ///
+        /// The count of samples needed to meet the threshold.
+        ///
+        int64_t m_thresholdMaxCount;
+
+        ///
+        /// The count of samples below the threshold.
+        ///
+        int64_t m_thresholdBelowCount;
+
+        ///
+        /// The count of samples above the threshold.
+        ///
+        int64_t m_thresholdAboveCount;
+    };
+} }
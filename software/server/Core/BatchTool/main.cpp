@@ -0,0 +1,306 @@
+//-----------------------------------------------------------------------
+// <copyright file="main.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "ACRCloudServices.h"
+#include "BatchIdentifier.h"
+#include "Json.h"
+#include "Logger.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::Ingest;
+
+namespace
+{
+    const char* const Usage =
+        "Usage: 8track-batch [options] FILE...\n"
+        "\n"
+        "Identifies whole WAV rips offline, on every core. Each file is split into programs and\n"
+        "segments where the level drops, and the segments are identified under a query rate shared by\n"
+        "the batch; a segment heard before in the batch takes the earlier result. A timeline of each\n"
+        "file is written to the output folder, named as the file.\n"
+        "\n"
+        "  --host HOST            ACRCloud host\n"
+        "  --access-key KEY       ACRCloud access key\n"
+        "  --access-secret SECRET ACRCloud access secret\n"
+        "  --extractor PATH       ACRCloud extractor library (libacrcloud_extr_tool.so)\n"
+        "  -o FOLDER              where the timelines go (.)\n"
+        "  --csv                  write CSV timelines rather than JSON\n"
+        "  -j N                   workers to split and fingerprint on (one per core)\n"
+        "  --qps N                queries per second across the batch, 0 for no limit (10)\n"
+        "  --burst N              queries sent at once after a quiet spell (10)\n"
+        "  --threshold LEVEL      the level which starts and ends segments, 0 to 1, or -1 for\n"
+        "                         a segment per file (0.03)\n"
+        "  --threshold-ms MS      how long the level must hold (1000)\n"
+        "  --program-gap-ms MS    the quiet which starts another program (4000)\n"
+        "\n"
+        "Without a host, keys and extractor, segments are timed but not identified.\n";
+
+    BatchIdentifier* g_batch = nullptr;
+
+    void OnSignal(int)
+    {
+        if (g_batch != nullptr)
+        {
+            g_batch->Stop();
+        }
+    }
+
+    const char* StatusName(IdentifyStatus status)
+    {
+        switch (status)
+        {
+        case IdentifyStatus::Incomplete: return "Incomplete";
+        case IdentifyStatus::Complete: return "Complete";
+        case IdentifyStatus::Error: return "Error";
+        default: return "Invalid";
+        }
+    }
+
+    std::string FormatSeconds(double seconds)
+    {
+        char text[32];
+        snprintf(text, sizeof(text), "%.2f", seconds);
+        return text;
+    }
+
+    // Quote a CSV field if it needs it, doubling its quotes (RFC 4180).
+    std::string QuoteCsv(const std::string& value)
+    {
+        if (value.find_first_of(",\"\r\n") == std::string::npos)
+        {
+            return value;
+        }
+
+        std::string quoted = "\"";
+        for (char c : value)
+        {
+            quoted += (c == '"') ? "\"\"" : std::string(1, c);
+        }
+
+        return quoted + "\"";
+    }
+
+    std::string TimelineJson(const BatchTimeline& timeline)
+    {
+        std::string text = "{\"file\":" + QuoteJson(timeline.path);
+        text += ",\"duration_seconds\":" + FormatSeconds(timeline.durationSeconds) + ",\"segments\":[";
+        for (size_t i = 0; i < timeline.segments.size(); i++)
+        {
+            const BatchSegment& segment = timeline.segments[i];
+            text += (i > 0) ? ",\n" : "\n";
+            text += "{\"program\":" + std::to_string(segment.program);
+            text += ",\"segment\":" + std::to_string(segment.number);
+            text += ",\"start_seconds\":" + FormatSeconds(segment.startSeconds);
+            text += ",\"end_seconds\":" + FormatSeconds(segment.endSeconds);
+            text += ",\"status\":" + QuoteJson(StatusName(segment.status));
+            text += ",\"attempts\":" + std::to_string(segment.attempts);
+            text += ",\"duplicate_of\":";
+            if (segment.duplicateFile.empty())
+            {
+                text += "null";
+            }
+            else
+            {
+                text += "{\"file\":" + QuoteJson(segment.duplicateFile) + ",\"segment\":" + std::to_string(segment.duplicateNumber) + "}";
+            }
+
+            text += ",\"tracks\":[";
+            for (size_t j = 0; j < segment.tracks.size(); j++)
+            {
+                const TrackInfo& track = segment.tracks[j];
+                text += (j > 0) ? "," : "";
+                text += "{\"id\":" + QuoteJson(track.identifier);
+                text += ",\"title\":" + QuoteJson(track.title);
+                text += ",\"artist\":" + QuoteJson(track.artist);
+                text += ",\"album\":" + QuoteJson(track.album);
+                text += ",\"genre\":" + QuoteJson(track.genre);
+                text += ",\"score\":" + QuoteJson(track.matchConfidence);
+                text += ",\"duration_ms\":" + std::to_string(track.duration);
+                text += ",\"position_ms\":" + std::to_string(track.currentPosition) + "}";
+            }
+
+            text += "]}";
+        }
+
+        return text + "\n]}\n";
+    }
+
+    // A row for each segment, with its best track.
+    std::string TimelineCsv(const BatchTimeline& timeline)
+    {
+        std::string text = "program,segment,start_seconds,end_seconds,status,attempts,duplicate_file,duplicate_segment,id,title,artist,album,score\n";
+        for (const BatchSegment& segment : timeline.segments)
+        {
+            TrackInfo track = segment.tracks.empty() ? TrackInfo() : segment.tracks[0];
+            text += std::to_string(segment.program);
+            text += "," + std::to_string(segment.number);
+            text += "," + FormatSeconds(segment.startSeconds);
+            text += "," + FormatSeconds(segment.endSeconds);
+            text += "," + std::string(StatusName(segment.status));
+            text += "," + std::to_string(segment.attempts);
+            text += "," + QuoteCsv(segment.duplicateFile);
+            text += "," + (segment.duplicateFile.empty() ? std::string() : std::to_string(segment.duplicateNumber));
+            text += "," + QuoteCsv(track.identifier);
+            text += "," + QuoteCsv(track.title);
+            text += "," + QuoteCsv(track.artist);
+            text += "," + QuoteCsv(track.album);
+            text += "," + QuoteCsv(track.matchConfidence) + "\n";
+        }
+
+        return text;
+    }
+
+    // The timeline of rips/side1.wav is FOLDER/side1.json.
+    std::string TimelinePath(const std::string& folder, const std::string& path, bool csv)
+    {
+        size_t slash = path.find_last_of('/');
+        std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+        size_t dot = name.find_last_of('.');
+        name = (dot == std::string::npos || dot == 0) ? name : name.substr(0, dot);
+        return folder + "/" + name + (csv ? ".csv" : ".json");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string host;
+    std::string accessKey;
+    std::string accessSecret;
+    std::string extractorPath;
+    std::string outputFolder = ".";
+    bool csv = false;
+    BatchOptions options;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument(argv[i]);
+        bool hasValue = (i + 1 < argc);
+        if (argument == "--host" && hasValue)
+        {
+            host = argv[++i];
+        }
+        else if (argument == "--access-key" && hasValue)
+        {
+            accessKey = argv[++i];
+        }
+        else if (argument == "--access-secret" && hasValue)
+        {
+            accessSecret = argv[++i];
+        }
+        else if (argument == "--extractor" && hasValue)
+        {
+            extractorPath = argv[++i];
+        }
+        else if (argument == "-o" && hasValue)
+        {
+            outputFolder = argv[++i];
+        }
+        else if (argument == "--csv")
+        {
+            csv = true;
+        }
+        else if (argument == "-j" && hasValue)
+        {
+            options.workerCount = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else if (argument == "--qps" && hasValue)
+        {
+            options.queriesPerSecond = atof(argv[++i]);
+        }
+        else if (argument == "--burst" && hasValue)
+        {
+            options.queryBurst = atof(argv[++i]);
+        }
+        else if (argument == "--threshold" && hasValue)
+        {
+            options.thresholdValue = atof(argv[++i]);
+        }
+        else if (argument == "--threshold-ms" && hasValue)
+        {
+            options.thresholdDuration = std::chrono::duration_cast<Ticks>(std::chrono::milliseconds(atoi(argv[++i])));
+        }
+        else if (argument == "--program-gap-ms" && hasValue)
+        {
+            options.programGap = std::chrono::duration_cast<Ticks>(std::chrono::milliseconds(atoi(argv[++i])));
+        }
+        else if (argument[0] != '-')
+        {
+            files.push_back(argument);
+        }
+        else
+        {
+            fputs(Usage, stderr);
+            return 2;
+        }
+    }
+
+    if (files.empty())
+    {
+        fputs(Usage, stderr);
+        return 2;
+    }
+
+    // Identification needs both the extractor and the service.
+    std::shared_ptr<ACRCloudExtractor> extractor;
+    std::shared_ptr<ACRCloudIdentifier> identifier;
+    if (!extractorPath.empty() && !host.empty() && !accessKey.empty() && !accessSecret.empty())
+    {
+        extractor = std::make_shared<ACRCloudExtractor>();
+        if (!extractor->Load(extractorPath))
+        {
+            CrazyGiraffe::Common::Logger::Instance().Flush();
+            return 1;
+        }
+
+        identifier = std::make_shared<ACRCloudIdentifier>(host, accessKey, accessSecret);
+    }
+    else
+    {
+        LOG_WARNING("No extractor or ACRCloud credentials; segments are not identified");
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    BatchIdentifier batch(options, extractor, identifier);
+    g_batch = &batch;
+    struct sigaction action = {};
+    action.sa_handler = OnSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    size_t unwritten = 0;
+    size_t failed = batch.Run(files, [&outputFolder, csv, &unwritten](const BatchTimeline& timeline)
+        {
+            if (!timeline.read)
+            {
+                return;
+            }
+
+            std::string path = TimelinePath(outputFolder, timeline.path, csv);
+            std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+            stream << (csv ? TimelineCsv(timeline) : TimelineJson(timeline));
+            stream.close();
+            if (!stream)
+            {
+                LOG_ERROR("Timeline could not be written: %s", path.c_str());
+                unwritten++;
+            }
+        });
+    g_batch = nullptr;
+
+    BatchStatistics statistics = batch.Statistics();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "%zu files, %zu segments, %zu queries, %zu reused: %.1fh of audio in %.1fs\n",
+        statistics.files, statistics.segments, statistics.queries, statistics.reused, statistics.audioSeconds / 3600, seconds);
+
+    CrazyGiraffe::Common::Logger::Instance().Flush();
+    return (failed == 0 && unwritten == 0) ? 0 : 1;
+}
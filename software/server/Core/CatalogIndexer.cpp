@@ -0,0 +1,140 @@
+//-----------------------------------------------------------------------
+// <copyright file="CatalogIndexer.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "CatalogIndexer.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "WavFormat.h"
+#include "WorkStealingPool.h"
+#include <exception>
+#include <memory>
+#include <stdexcept>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    // The samples converted at a time, so a long rip isn't converted whole.
+    const size_t BlockSamples = 1 << 16;
+
+    // The file name, without the folder or extension.
+    std::string TrackName(const std::string& path)
+    {
+        size_t start = path.find_last_of("/\\");
+        start = (start == std::string::npos) ? 0 : start + 1;
+        size_t end = path.find_last_of('.');
+        end = (end == std::string::npos || end < start) ? path.size() : end;
+        return path.substr(start, end - start);
+    }
+
+    // What a worker found for a file.
+    struct IndexedFile
+    {
+        bool indexed;
+        std::vector<Landmark> landmarks;
+        int32_t duration;
+    };
+
+    // Open a WAV file the fingerprinter can analyse.
+    bool OpenAnalysable(const uint8_t* file, size_t fileSize, std::unique_ptr<WavReader>& reader)
+    {
+        try
+        {
+            reader = std::make_unique<WavReader>(file, fileSize);
+        }
+        catch (const std::runtime_error&)
+        {
+            return false;
+        }
+
+        return reader->Format().sampleRate >= LandmarkFingerprinter::AnalysisRate;
+    }
+}
+
+bool CrazyGiraffe::Core::FingerprintWav(const uint8_t* file, size_t fileSize, std::vector<Landmark>& landmarks, int32_t& duration)
+{
+    std::unique_ptr<WavReader> reader;
+    if (!OpenAnalysable(file, fileSize, reader))
+    {
+        return false;
+    }
+
+    const AudioFormat& format = reader->Format();
+    size_t blockFrames = BlockSamples / format.channelCount;
+
+    LandmarkFingerprinter fingerprinter(format.sampleRate, format.channelCount);
+    std::vector<float> samples(blockFrames * format.channelCount);
+    for (size_t frames = reader->Read(samples.data(), blockFrames); frames > 0; frames = reader->Read(samples.data(), blockFrames))
+    {
+        fingerprinter.AddSamples(samples.data(), frames * format.channelCount);
+    }
+
+    fingerprinter.Flush();
+    landmarks = fingerprinter.Landmarks();
+    duration = static_cast<int32_t>(static_cast<uint64_t>(reader->FrameCount()) * 1000 / format.sampleRate);
+    return true;
+}
+
+bool CrazyGiraffe::Core::ReadWav(const uint8_t* file, size_t fileSize, std::vector<float>& samples, AudioFormat& format)
+{
+    std::unique_ptr<WavReader> reader;
+    if (!OpenAnalysable(file, fileSize, reader))
+    {
+        return false;
+    }
+
+    format = reader->Format();
+    samples.resize(reader->FrameCount() * format.channelCount);
+    reader->Read(samples.data(), reader->FrameCount());
+    return true;
+}
+
+size_t CrazyGiraffe::Core::IndexWavFiles(const std::vector<std::string>& paths, size_t workerCount, LandmarkIndex& index)
+{
+    // Each worker fills in its own file's result.
+    std::vector<IndexedFile> results(paths.size());
+    {
+        WorkStealingPool pool(workerCount);
+        for (size_t fileIndex = 0; fileIndex < paths.size(); fileIndex++)
+        {
+            IndexedFile* result = &results[fileIndex];
+            const std::string* path = &paths[fileIndex];
+            result->indexed = false;
+            pool.Post([result, path]
+                {
+                    try
+                    {
+                        MappedFile file(*path);
+                        result->indexed = FingerprintWav(file.Data(), file.Size(), result->landmarks, result->duration);
+                        if (!result->indexed)
+                        {
+                            LOG_WARNING("IndexWavFiles: not a WAV file: %s", path->c_str());
+                        }
+                    }
+                    catch (const std::exception& ex)
+                    {
+                        LOG_WARNING("IndexWavFiles: %s", ex.what());
+                    }
+                });
+        }
+    }
+
+    size_t added = 0;
+    for (size_t fileIndex = 0; fileIndex < paths.size(); fileIndex++)
+    {
+        if (results[fileIndex].indexed)
+        {
+            TrackInfo track;
+            track.identifier = TrackName(paths[fileIndex]);
+            track.title = track.identifier;
+            track.duration = results[fileIndex].duration;
+            index.AddTrack(track, results[fileIndex].landmarks);
+            added++;
+        }
+    }
+
+    return added;
+}
@@ -0,0 +1,37 @@
+//-----------------------------------------------------------------------
+// <copyright file="CatalogIndexer.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "AudioFormat.h"
+#include "LandmarkIndex.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// Fingerprint a WAV file in memory, a block at a time. Returns false if it isn't a PCM or float
+    /// WAV file the fingerprinter can analyse. The duration is in milliseconds.
+    ///
+    bool FingerprintWav(const uint8_t* file, size_t fileSize, std::vector<Landmark>& landmarks, int32_t& duration);
+
+    ///
+    /// Read the whole of a WAV file in memory as interleaved floats, for an excerpt to search at other
+    /// speeds. Returns false as FingerprintWav does.
+    ///
+    bool ReadWav(const uint8_t* file, size_t fileSize, std::vector<float>& samples, AudioFormat& format);
+
+    ///
+    /// Fingerprint WAV files on a pool of workers, zero meaning one per core, and add them to an index
+    /// in the order given, so the same files always make the same catalog. Each track is named for its
+    /// file, without the folder or extension. Files which can't be read or aren't WAV are logged and
+    /// skipped. Returns the tracks added.
+    ///
+    size_t IndexWavFiles(const std::vector<std::string>& paths, size_t workerCount, LandmarkIndex& index);
+} }
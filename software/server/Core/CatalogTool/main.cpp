@@ -0,0 +1,268 @@
+//-----------------------------------------------------------------------
+// <copyright file="main.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "CatalogIndexer.h"
+#include "Json.h"
+#include "LandmarkCatalog.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "SpeedEstimator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <sys/stat.h>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    const char* const Usage =
+        "Usage: 8track-catalog index [options] -o CATALOG PATH...\n"
+        "       8track-catalog identify [options] CATALOG FILE...\n"
+        "\n"
+        "index fingerprints WAV files, and the WAV files in folders, on every core and writes a\n"
+        "catalog. identify matches WAV files against a catalog and writes a JSON line for each.\n"
+        "\n"
+        "  -o CATALOG     the catalog to write\n"
+        "  -j N           workers to fingerprint on (one per core)\n"
+        "  --score N      landmarks which must agree for a match (8)\n"
+        "  --speed P      search up to P percent fast or slow if a file doesn't match as it is (0)\n";
+
+    // The step between the speeds searched; the landmarks still agree a quarter of a percent off.
+    const double SpeedStep = 0.005;
+
+    bool IsWavFile(const std::string& name)
+    {
+        if (name.size() < 4)
+        {
+            return false;
+        }
+
+        std::string extension = name.substr(name.size() - 4);
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(tolower(c)); });
+        return extension == ".wav";
+    }
+
+    // Add a file, or the WAV files under a folder.
+    void AddPath(const std::string& path, std::vector<std::string>& files)
+    {
+        struct stat status = {};
+        if (stat(path.c_str(), &status) != 0)
+        {
+            LOG_WARNING("Not found: %s", path.c_str());
+            return;
+        }
+
+        if (!S_ISDIR(status.st_mode))
+        {
+            files.push_back(path);
+            return;
+        }
+
+        DIR* folder = opendir(path.c_str());
+        if (folder == nullptr)
+        {
+            LOG_WARNING("Folder could not be read: %s", path.c_str());
+            return;
+        }
+
+        // In name order, so a folder always makes the same catalog.
+        std::vector<std::string> names;
+        for (dirent* entry = readdir(folder); entry != nullptr; entry = readdir(folder))
+        {
+            std::string name(entry->d_name);
+            if (name != "." && name != "..")
+            {
+                names.push_back(name);
+            }
+        }
+
+        closedir(folder);
+        std::sort(names.begin(), names.end());
+        for (const std::string& name : names)
+        {
+            std::string child = path + "/" + name;
+            struct stat childStatus = {};
+            if (stat(child.c_str(), &childStatus) == 0 && (S_ISDIR(childStatus.st_mode) || IsWavFile(name)))
+            {
+                AddPath(child, files);
+            }
+        }
+    }
+
+    int Index(const std::vector<std::string>& paths, const std::string& catalogPath, size_t workerCount)
+    {
+        std::vector<std::string> files;
+        for (const std::string& path : paths)
+        {
+            AddPath(path, files);
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        LandmarkIndex index;
+        size_t added = IndexWavFiles(files, workerCount, index);
+
+        std::ofstream stream(catalogPath, std::ios::binary | std::ios::trunc);
+        index.Save(stream);
+        stream.close();
+        if (!stream)
+        {
+            LOG_ERROR("Catalog could not be written: %s", catalogPath.c_str());
+            return 1;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        fprintf(stderr, "Indexed %zu of %zu files in %.1fs\n", added, files.size(), seconds);
+        return (added == files.size()) ? 0 : 1;
+    }
+
+    int Identify(const std::string& catalogPath, const std::vector<std::string>& files, uint32_t minimumScore, double maximumSpeedError, size_t workerCount)
+    {
+        LandmarkCatalog catalog(catalogPath);
+        std::unique_ptr<WorkStealingPool> pool = (maximumSpeedError > 0) ? std::make_unique<WorkStealingPool>(workerCount) : nullptr;
+        int failed = 0;
+        for (const std::string& path : files)
+        {
+            std::unique_ptr<MappedFile> file;
+            std::vector<Landmark> landmarks;
+            int32_t duration = 0;
+            bool read = false;
+            try
+            {
+                file = std::make_unique<MappedFile>(path);
+                read = FingerprintWav(file->Data(), file->Size(), landmarks, duration);
+            }
+            catch (const std::exception& ex)
+            {
+                LOG_WARNING("%s", ex.what());
+            }
+
+            if (!read)
+            {
+                LOG_WARNING("Not a WAV file: %s", path.c_str());
+                failed++;
+                continue;
+            }
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            TrackInfo track;
+            bool matched = catalog.Identify(landmarks, minimumScore, track);
+            double speed = 1.0;
+
+            // A tape played fast or slow only matches once its speed is corrected.
+            AudioFormat format = {};
+            std::vector<float> samples;
+            LandmarkMatch match = {};
+            if (!matched && pool != nullptr && ReadWav(file->Data(), file->Size(), samples, format)
+                && MatchAtSpeeds(catalog, samples.data(), samples.size(), format.sampleRate, format.channelCount,
+                    maximumSpeedError, SpeedStep, minimumScore, pool.get(), match, speed))
+            {
+                track = catalog.MatchedTrack(match);
+                matched = true;
+            }
+
+            double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            char elapsed[32];
+            snprintf(elapsed, sizeof(elapsed), "%.2f", milliseconds);
+            std::string line = "{\"file\":" + QuoteJson(path) + ",\"query_ms\":" + elapsed + ",\"track\":";
+            if (matched)
+            {
+                line += "{\"id\":" + QuoteJson(track.identifier);
+                line += ",\"title\":" + QuoteJson(track.title);
+                line += ",\"score\":" + QuoteJson(track.matchConfidence);
+                line += ",\"duration_ms\":" + std::to_string(track.duration);
+                line += ",\"position_ms\":" + std::to_string(track.matchPosition);
+                snprintf(elapsed, sizeof(elapsed), "%.3f", speed);
+                line += std::string(",\"speed\":") + elapsed + "}}\n";
+            }
+            else
+            {
+                line += "null}\n";
+            }
+
+            fputs(line.c_str(), stdout);
+        }
+
+        return (failed == 0) ? 0 : 1;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fputs(Usage, stderr);
+        return 2;
+    }
+
+    std::string command(argv[1]);
+    std::string catalogPath;
+    size_t workerCount = 0;
+    uint32_t minimumScore = LandmarkIndex::DefaultMinimumScore;
+    double maximumSpeedError = 0;
+    std::vector<std::string> paths;
+    for (int i = 2; i < argc; i++)
+    {
+        std::string argument(argv[i]);
+        bool hasValue = (i + 1 < argc);
+        if (argument == "-o" && hasValue)
+        {
+            catalogPath = argv[++i];
+        }
+        else if (argument == "-j" && hasValue)
+        {
+            workerCount = static_cast<size_t>(atoi(argv[++i]));
+        }
+        else if (argument == "--score" && hasValue)
+        {
+            minimumScore = static_cast<uint32_t>(atoi(argv[++i]));
+        }
+        else if (argument == "--speed" && hasValue)
+        {
+            maximumSpeedError = atof(argv[++i]) / 100;
+        }
+        else if (argument[0] != '-')
+        {
+            paths.push_back(argument);
+        }
+        else
+        {
+            fputs(Usage, stderr);
+            return 2;
+        }
+    }
+
+    int result = 2;
+    try
+    {
+        if (command == "index" && !catalogPath.empty() && !paths.empty())
+        {
+            result = Index(paths, catalogPath, workerCount);
+        }
+        else if (command == "identify" && paths.size() >= 2)
+        {
+            result = Identify(paths[0], std::vector<std::string>(paths.begin() + 1, paths.end()), minimumScore, maximumSpeedError, workerCount);
+        }
+        else
+        {
+            fputs(Usage, stderr);
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR("%s", ex.what());
+        result = 1;
+    }
+
+    CrazyGiraffe::Common::Logger::Instance().Flush();
+    return result;
+}
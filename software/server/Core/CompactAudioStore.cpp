@@ -0,0 +1,393 @@
+//-----------------------------------------------------------------------
+// <copyright file="CompactAudioStore.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "CompactAudioStore.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    const double Pi = 3.14159265358979323846;
+
+    // Filter taps per input sample per Hz of transition band, for a Blackman window's -74dB stop band.
+    const double BlackmanTransition = 5.5;
+
+    // Design a Blackman-windowed sinc low-pass for a rate, from its passband edge to the Nyquist of
+    // the storage rate, with unit gain at DC. The taps are odd in number and symmetric.
+    std::vector<float> DesignLowPass(uint32_t sampleRate, uint32_t passbandEdge, uint32_t stopbandEdge)
+    {
+        double transition = static_cast<double>(stopbandEdge - passbandEdge);
+        size_t tapCount = static_cast<size_t>(std::ceil(BlackmanTransition * sampleRate / transition)) | 1;
+        double cutoff = (passbandEdge + stopbandEdge) / 2.0 / sampleRate;
+        double middle = (tapCount - 1) / 2.0;
+
+        std::vector<float> taps(tapCount);
+        double sum = 0;
+        for (size_t index = 0; index < tapCount; index++)
+        {
+            double offset = index - middle;
+            double sinc = (offset == 0) ? 2 * cutoff : std::sin(2 * Pi * cutoff * offset) / (Pi * offset);
+            double window = 0.42 - 0.5 * std::cos(2 * Pi * index / (tapCount - 1)) + 0.08 * std::cos(4 * Pi * index / (tapCount - 1));
+            taps[index] = static_cast<float>(sinc * window);
+            sum += taps[index];
+        }
+
+        for (float& tap : taps)
+        {
+            tap = static_cast<float>(tap / sum);
+        }
+
+        return taps;
+    }
+
+    // The largest Rice parameter; a difference of two 16-bit samples, zigzagged, takes 17 bits.
+    const uint8_t MaximumParameter = 15;
+    const uint32_t DifferenceBits = 17;
+
+    // A quotient of this many ones is followed by the difference as it is, so a jump costs at most
+    // this and 17 bits.
+    const uint32_t EscapeQuotient = 24;
+
+    // Signed differences to unsigned, small either way to small: 0, -1, 1, -2, 2...
+    uint32_t Zigzag(int32_t value)
+    {
+        return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    }
+
+    int32_t Unzigzag(uint32_t value)
+    {
+        return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+    }
+
+    // Bits are written and read from the top of each byte down.
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& output)
+            : m_output(output)
+            , m_bit(8)
+        {
+        }
+
+        void Write(uint32_t value, uint32_t bits)
+        {
+            while (bits-- > 0)
+            {
+                if (m_bit == 8)
+                {
+                    m_output.push_back(0);
+                    m_bit = 0;
+                }
+
+                m_output.back() |= static_cast<uint8_t>(((value >> bits) & 1) << (7 - m_bit));
+                m_bit++;
+            }
+        }
+
+        void WriteOnes(uint32_t count)
+        {
+            while (count-- > 0)
+            {
+                Write(1, 1);
+            }
+        }
+
+    private:
+        std::vector<uint8_t>& m_output;
+        uint32_t m_bit;
+    };
+
+    class BitReader
+    {
+    public:
+        explicit BitReader(const std::vector<uint8_t>& input)
+            : m_input(input)
+            , m_position(0)
+        {
+        }
+
+        uint32_t Read(uint32_t bits)
+        {
+            uint32_t value = 0;
+            while (bits-- > 0)
+            {
+                value = (value << 1) | ((m_input[m_position >> 3] >> (7 - (m_position & 7))) & 1);
+                m_position++;
+            }
+
+            return value;
+        }
+
+    private:
+        const std::vector<uint8_t>& m_input;
+        size_t m_position;
+    };
+}
+
+CompactAudioStore::CompactAudioStore(uint32_t sampleRate, uint16_t channelCount, bool compress)
+    : m_sampleRate(sampleRate)
+    , m_channelCount(channelCount)
+    , m_storageRate((sampleRate < StorageRate) ? sampleRate : StorageRate)
+    , m_compress(compress)
+    , m_frameSum(0)
+    , m_frameChannel(0)
+    , m_sum(0)
+    , m_phase(0)
+    , m_filter()
+    , m_history()
+    , m_historyIndex(0)
+    , m_lock()
+    , m_blocks()
+    , m_pending()
+{
+    if (sampleRate == 0)
+    {
+        throw std::invalid_argument("sampleRate");
+    }
+
+    if (channelCount == 0)
+    {
+        throw std::invalid_argument("channelCount");
+    }
+
+    m_pending.reserve(BlockSize);
+    if (sampleRate > StorageRate)
+    {
+        m_filter = DesignLowPass(sampleRate, PassbandEdge, StorageRate / 2);
+        m_history.resize(2 * (m_filter.size() + 1));
+    }
+}
+
+uint32_t CompactAudioStore::SampleRate() const
+{
+    return m_storageRate;
+}
+
+void CompactAudioStore::AddSamples(const float* samples, size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (size_t index = 0; index < count; index++)
+    {
+        m_frameSum += samples[index];
+        if (++m_frameChannel < m_channelCount)
+        {
+            continue;
+        }
+
+        // Mix down and average the input over each stored sample, sharing the input samples on the
+        // boundaries, as the landmark fingerprinter does.
+        float sample = m_frameSum / m_channelCount;
+        m_frameSum = 0;
+        m_frameChannel = 0;
+
+        if (!m_filter.empty())
+        {
+            // Only the filtered input at the stored sample's time is worked out, between the last two
+            // frames; the input is faster than the storage, so that is at most once a frame.
+            size_t historySize = m_history.size() / 2;
+            m_history[m_historyIndex] = sample;
+            m_history[m_historyIndex + historySize] = sample;
+            m_historyIndex = (m_historyIndex + 1) % historySize;
+
+            m_phase += m_storageRate;
+            if (m_phase >= m_sampleRate)
+            {
+                m_phase -= m_sampleRate;
+                float fraction = 1.0f - static_cast<float>(m_phase) / static_cast<float>(m_storageRate);
+                float stored = (1.0f - fraction) * FilteredSample(false) + fraction * FilteredSample(true);
+                AddStoredSample(static_cast<int16_t>(std::lround(std::max(-1.0f, std::min(stored, 32767.0f / 32768.0f)) * 32768.0f)));
+            }
+
+            continue;
+        }
+
+        uint32_t remaining = m_storageRate;
+        while (m_phase + remaining >= m_sampleRate)
+        {
+            uint32_t taken = m_sampleRate - m_phase;
+            m_sum += sample * static_cast<float>(taken);
+            float stored = m_sum / static_cast<float>(m_sampleRate);
+            AddStoredSample(static_cast<int16_t>(std::lround(std::max(-1.0f, std::min(stored, 32767.0f / 32768.0f)) * 32768.0f)));
+            m_sum = 0;
+            m_phase = 0;
+            remaining -= taken;
+        }
+
+        m_sum += sample * static_cast<float>(remaining);
+        m_phase += remaining;
+    }
+}
+
+float CompactAudioStore::FilteredSample(bool last) const
+{
+    // The oldest frame held is at m_historyIndex; the filter is symmetric, so it needn't be reversed.
+    const float* frames = m_history.data() + m_historyIndex + (last ? 1 : 0);
+    float sum = 0;
+    for (size_t index = 0; index < m_filter.size(); index++)
+    {
+        sum += m_filter[index] * frames[index];
+    }
+
+    return sum;
+}
+
+size_t CompactAudioStore::SampleCount() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_blocks.size() * BlockSize + m_pending.size();
+}
+
+size_t CompactAudioStore::StoredSize() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    size_t size = m_pending.capacity() * sizeof(int16_t);
+    for (const Block& block : m_blocks)
+    {
+        size += sizeof(Block) + block.samples.capacity() * sizeof(int16_t) + block.coded.capacity();
+    }
+
+    return size;
+}
+
+void CompactAudioStore::Read(size_t first, size_t count, int16_t* output) const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (first + count < first || first + count > m_blocks.size() * BlockSize + m_pending.size())
+    {
+        throw std::out_of_range("count");
+    }
+
+    // Only the blocks the window covers are decoded.
+    std::vector<int16_t> decoded;
+    while (count > 0)
+    {
+        size_t blockIndex = first / BlockSize;
+        size_t offset = first % BlockSize;
+        size_t taken = std::min<size_t>(count, BlockSize - offset);
+        const int16_t* source = nullptr;
+        if (blockIndex == m_blocks.size())
+        {
+            source = m_pending.data();
+        }
+        else if (m_blocks[blockIndex].coded.empty())
+        {
+            source = m_blocks[blockIndex].samples.data();
+        }
+        else
+        {
+            decoded.resize(BlockSize);
+            Decode(m_blocks[blockIndex], decoded.data());
+            source = decoded.data();
+        }
+
+        std::copy(source + offset, source + offset + taken, output);
+        output += taken;
+        first += taken;
+        count -= taken;
+    }
+}
+
+std::vector<int16_t> CompactAudioStore::Read(size_t first, size_t count) const
+{
+    std::vector<int16_t> output(count);
+    Read(first, count, output.data());
+    return output;
+}
+
+void CompactAudioStore::AddStoredSample(int16_t sample)
+{
+    m_pending.push_back(sample);
+    if (m_pending.size() == BlockSize)
+    {
+        CloseBlock();
+    }
+}
+
+void CompactAudioStore::CloseBlock()
+{
+    Block block = {};
+    if (m_compress)
+    {
+        Encode(m_pending, block);
+    }
+
+    if (block.coded.empty() || block.coded.size() >= BlockSize * sizeof(int16_t))
+    {
+        block.coded.clear();
+        block.coded.shrink_to_fit();
+        block.samples = m_pending;
+    }
+
+    m_blocks.push_back(std::move(block));
+    m_pending.clear();
+}
+
+/* static */
+void CompactAudioStore::Encode(const std::vector<int16_t>& samples, Block& block)
+{
+    // The differences of music at 8kHz are small next to the samples. The parameter is the one the
+    // mean difference suggests: each difference is its quotient by 2^parameter, in unary, then the
+    // remainder.
+    std::vector<uint32_t> differences(samples.size());
+    uint64_t sum = 0;
+    int32_t previous = 0;
+    for (size_t index = 0; index < samples.size(); index++)
+    {
+        differences[index] = Zigzag(static_cast<int32_t>(samples[index]) - previous);
+        previous = samples[index];
+        sum += differences[index];
+    }
+
+    uint8_t parameter = 0;
+    while (parameter < MaximumParameter && (static_cast<uint64_t>(samples.size()) << (parameter + 1)) <= sum)
+    {
+        parameter++;
+    }
+
+    block.parameter = parameter;
+    block.coded.reserve(samples.size() * sizeof(int16_t));
+    BitWriter writer(block.coded);
+    for (uint32_t difference : differences)
+    {
+        uint32_t quotient = difference >> parameter;
+        if (quotient >= EscapeQuotient)
+        {
+            writer.WriteOnes(EscapeQuotient);
+            writer.Write(difference, DifferenceBits);
+            continue;
+        }
+
+        writer.WriteOnes(quotient);
+        writer.Write(0, 1);
+        writer.Write(difference, parameter);
+    }
+
+    block.coded.shrink_to_fit();
+}
+
+/* static */
+void CompactAudioStore::Decode(const Block& block, int16_t* output)
+{
+    BitReader reader(block.coded);
+    int32_t previous = 0;
+    for (uint32_t index = 0; index < BlockSize; index++)
+    {
+        uint32_t quotient = 0;
+        while (quotient < EscapeQuotient && reader.Read(1) == 1)
+        {
+            quotient++;
+        }
+
+        uint32_t difference = (quotient == EscapeQuotient)
+            ? reader.Read(DifferenceBits)
+            : ((quotient << block.parameter) | reader.Read(block.parameter));
+        previous += Unzigzag(difference);
+        output[index] = static_cast<int16_t>(previous);
+    }
+}
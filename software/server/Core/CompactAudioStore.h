@@ -0,0 +1,147 @@
+//-----------------------------------------------------------------------
+// <copyright file="CompactAudioStore.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// Holds the audio of a session in little memory: the input is mixed down to 8kHz mono, the band
+    /// the fingerprints are made from, low-pass filtered first so what is above 4kHz doesn't fold
+    /// down into it, and kept as 16-bit samples in blocks. With compression on, each
+    /// full block is kept as the differences of its samples, Rice coded, which is lossless; a block
+    /// which wouldn't be smaller is kept as it is. Blocks are only decoded when they are read. Thread
+    /// safe, so audio can be added while a window of it is read.
+    ///
+    class CompactAudioStore
+    {
+    public:
+        ///
+        /// The rate the audio is kept at, when the input is at least this.
+        ///
+        static const uint32_t StorageRate = 8000;
+
+        ///
+        /// The anti-aliasing filter passes up to here and stops from the storage rate's Nyquist, 4kHz.
+        ///
+        static const uint32_t PassbandEdge = 3200;
+
+        ///
+        /// The samples per block.
+        ///
+        static const uint32_t BlockSize = 4096;
+
+        ///
+        /// Create a store for interleaved input of a format. Throws std::invalid_argument if there is
+        /// no rate or no channel.
+        ///
+        CompactAudioStore(uint32_t sampleRate, uint16_t channelCount, bool compress);
+
+        ///
+        /// Get the rate of the stored samples: the storage rate, or the input rate if that is lower.
+        ///
+        uint32_t SampleRate() const;
+
+        ///
+        /// Add interleaved samples, -1 to 1. A partial frame at the end is held for the next call.
+        /// A whole number of samples is stored for the frames added so far, their count times the
+        /// storage rate over the input rate.
+        ///
+        void AddSamples(const float* samples, size_t count);
+
+        ///
+        /// Get the samples stored.
+        ///
+        size_t SampleCount() const;
+
+        ///
+        /// Get the bytes the stored audio takes.
+        ///
+        size_t StoredSize() const;
+
+        ///
+        /// Read count samples from first into output. Throws std::out_of_range past the samples stored.
+        ///
+        void Read(size_t first, size_t count, int16_t* output) const;
+
+        std::vector<int16_t> Read(size_t first, size_t count) const;
+
+    private:
+        ///
+        /// A full block; samples are kept as they are when coded is empty.
+        ///
+        struct Block
+        {
+            std::vector<int16_t> samples;
+            std::vector<uint8_t> coded;
+            uint8_t parameter;
+        };
+
+        CompactAudioStore(const CompactAudioStore&) = delete;
+        CompactAudioStore& operator=(const CompactAudioStore&) = delete;
+
+        void AddStoredSample(int16_t sample);
+
+        ///
+        /// Get the filtered input at the frame before the last, or at the last.
+        ///
+        float FilteredSample(bool last) const;
+
+        ///
+        /// Move the filled pending samples to a block, coding them if that is smaller.
+        ///
+        void CloseBlock();
+
+        static void Encode(const std::vector<int16_t>& samples, Block& block);
+
+        static void Decode(const Block& block, int16_t* output);
+
+    private:
+        ///
+        /// The input format, and the rate stored.
+        ///
+        uint32_t m_sampleRate;
+        uint16_t m_channelCount;
+        uint32_t m_storageRate;
+        bool m_compress;
+
+        ///
+        /// The mixdown: the channels of the frame, and the weighted sum of the input since the last
+        /// stored sample and how much of it that covers, in units where a stored sample is m_sampleRate.
+        /// The sum is only kept when the input is at the storage rate or lower, and isn't filtered.
+        ///
+        float m_frameSum;
+        uint16_t m_frameChannel;
+        float m_sum;
+        uint32_t m_phase;
+
+        ///
+        /// The windowed-sinc low-pass taken before decimating, empty when the input is at the storage
+        /// rate or lower, and the mixed input it needs: the last taps plus one frames, held twice over
+        /// so the frames are always in one piece from m_historyIndex.
+        ///
+        std::vector<float> m_filter;
+        std::vector<float> m_history;
+        size_t m_historyIndex;
+
+        ///
+        /// Guards the blocks and pending samples.
+        ///
+        mutable std::mutex m_lock;
+
+        std::vector<Block> m_blocks;
+
+        ///
+        /// The samples of the block being filled.
+        ///
+        std::vector<int16_t> m_pending;
+    };
+} }
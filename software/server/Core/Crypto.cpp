@@ -0,0 +1,190 @@
+//-----------------------------------------------------------------------
+// <copyright file="Crypto.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "Crypto.h"
+#include <cstring>
+#include <vector>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    const size_t Sha1BlockSize = 64;
+
+    uint32_t RotateLeft(uint32_t value, int bits)
+    {
+        return (value << bits) | (value >> (32 - bits));
+    }
+
+    void Sha1Block(uint32_t state[5], const uint8_t* block)
+    {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++)
+        {
+            w[i] = (static_cast<uint32_t>(block[i * 4]) << 24)
+                | (static_cast<uint32_t>(block[i * 4 + 1]) << 16)
+                | (static_cast<uint32_t>(block[i * 4 + 2]) << 8)
+                | static_cast<uint32_t>(block[i * 4 + 3]);
+        }
+
+        for (int i = 16; i < 80; i++)
+        {
+            w[i] = RotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = state[0];
+        uint32_t b = state[1];
+        uint32_t c = state[2];
+        uint32_t d = state[3];
+        uint32_t e = state[4];
+        for (int i = 0; i < 80; i++)
+        {
+            uint32_t f = 0;
+            uint32_t k = 0;
+            if (i < 20)
+            {
+                f = (b & c) | (~b & d);
+                k = 0x5a827999;
+            }
+            else if (i < 40)
+            {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            }
+            else if (i < 60)
+            {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8f1bbcdc;
+            }
+            else
+            {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+
+            uint32_t temp = RotateLeft(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = RotateLeft(b, 30);
+            b = a;
+            a = temp;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+}
+
+Sha1Digest CrazyGiraffe::Core::Sha1(const uint8_t* data, size_t size)
+{
+    uint32_t state[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+    size_t whole = size - (size % Sha1BlockSize);
+    for (size_t offset = 0; offset < whole; offset += Sha1BlockSize)
+    {
+        Sha1Block(state, data + offset);
+    }
+
+    // Pad with 0x80, zeros, then the size in bits, big-endian, to a whole block.
+    uint8_t tail[Sha1BlockSize * 2] = { 0 };
+    size_t remaining = size - whole;
+    if (remaining > 0)
+    {
+        memcpy(tail, data + whole, remaining);
+    }
+
+    tail[remaining] = 0x80;
+    size_t tailSize = (remaining + 1 + 8 <= Sha1BlockSize) ? Sha1BlockSize : Sha1BlockSize * 2;
+    uint64_t bits = static_cast<uint64_t>(size) * 8;
+    for (int i = 0; i < 8; i++)
+    {
+        tail[tailSize - 1 - i] = static_cast<uint8_t>(bits >> (i * 8));
+    }
+
+    for (size_t offset = 0; offset < tailSize; offset += Sha1BlockSize)
+    {
+        Sha1Block(state, tail + offset);
+    }
+
+    Sha1Digest digest;
+    for (int i = 0; i < 5; i++)
+    {
+        digest[i * 4] = static_cast<uint8_t>(state[i] >> 24);
+        digest[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
+        digest[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
+        digest[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+    }
+
+    return digest;
+}
+
+Sha1Digest CrazyGiraffe::Core::HmacSha1(const uint8_t* key, size_t keySize, const uint8_t* data, size_t size)
+{
+    // Keys longer than a block are hashed first.
+    uint8_t blockKey[Sha1BlockSize] = { 0 };
+    if (keySize > Sha1BlockSize)
+    {
+        Sha1Digest keyDigest = Sha1(key, keySize);
+        memcpy(blockKey, keyDigest.data(), keyDigest.size());
+    }
+    else if (keySize > 0)
+    {
+        memcpy(blockKey, key, keySize);
+    }
+
+    std::vector<uint8_t> inner(Sha1BlockSize + size);
+    for (size_t i = 0; i < Sha1BlockSize; i++)
+    {
+        inner[i] = blockKey[i] ^ 0x36;
+    }
+
+    if (size > 0)
+    {
+        memcpy(inner.data() + Sha1BlockSize, data, size);
+    }
+
+    Sha1Digest innerDigest = Sha1(inner.data(), inner.size());
+
+    uint8_t outer[Sha1BlockSize + innerDigest.size()];
+    for (size_t i = 0; i < Sha1BlockSize; i++)
+    {
+        outer[i] = blockKey[i] ^ 0x5c;
+    }
+
+    memcpy(outer + Sha1BlockSize, innerDigest.data(), innerDigest.size());
+    return Sha1(outer, sizeof(outer));
+}
+
+std::string CrazyGiraffe::Core::Base64Encode(const uint8_t* data, size_t size)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string encoded;
+    encoded.reserve(((size + 2) / 3) * 4);
+    for (size_t i = 0; i < size; i += 3)
+    {
+        uint32_t group = static_cast<uint32_t>(data[i]) << 16;
+        if (i + 1 < size)
+        {
+            group |= static_cast<uint32_t>(data[i + 1]) << 8;
+        }
+
+        if (i + 2 < size)
+        {
+            group |= data[i + 2];
+        }
+
+        encoded.push_back(alphabet[(group >> 18) & 0x3f]);
+        encoded.push_back(alphabet[(group >> 12) & 0x3f]);
+        encoded.push_back((i + 1 < size) ? alphabet[(group >> 6) & 0x3f] : '=');
+        encoded.push_back((i + 2 < size) ? alphabet[group & 0x3f] : '=');
+    }
+
+    return encoded;
+}
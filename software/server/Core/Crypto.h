@@ -0,0 +1,35 @@
+//-----------------------------------------------------------------------
+// <copyright file="Crypto.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// A SHA-1 digest.
+    ///
+    using Sha1Digest = std::array<uint8_t, 20>;
+
+    ///
+    /// Get the SHA-1 digest of data.
+    ///
+    Sha1Digest Sha1(const uint8_t* data, size_t size);
+
+    ///
+    /// Get the HMAC-SHA1 of data with a key (RFC 2104).
+    ///
+    Sha1Digest HmacSha1(const uint8_t* key, size_t keySize, const uint8_t* data, size_t size);
+
+    ///
+    /// Encode data as padded base64 (RFC 4648).
+    ///
+    std::string Base64Encode(const uint8_t* data, size_t size);
+} }
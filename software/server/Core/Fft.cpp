@@ -0,0 +1,193 @@
+//-----------------------------------------------------------------------
+// <copyright file="Fft.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "Fft.h"
+#include <cmath>
+#include <stdexcept>
+
+#ifdef CORE_FFT_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    const double Pi = 3.14159265358979323846;
+}
+
+Fft::Fft(size_t size, bool useSimd)
+    : m_size(size)
+    , m_useSimd(false)
+    , m_bitReverse(size)
+    , m_twiddleReal()
+    , m_twiddleImaginary()
+    , m_real(size)
+    , m_imaginary(size)
+{
+    if (size < 4 || (size & (size - 1)) != 0 || size > 0x80000000u)
+    {
+        throw std::invalid_argument("size");
+    }
+
+#ifdef CORE_FFT_SSE2
+    m_useSimd = useSimd;
+#else
+    (void)useSimd;
+#endif
+
+    int bits = 0;
+    while ((static_cast<size_t>(1) << bits) < size)
+    {
+        bits++;
+    }
+
+    for (size_t index = 0; index < size; index++)
+    {
+        uint32_t reversed = 0;
+        for (int bit = 0; bit < bits; bit++)
+        {
+            reversed |= ((index >> bit) & 1u) << (bits - 1 - bit);
+        }
+
+        m_bitReverse[index] = reversed;
+    }
+
+    // Computed in double and rounded once, so they don't depend on the float maths of the machine.
+    for (size_t half = 1; half < size; half *= 2)
+    {
+        for (size_t k = 0; k < half; k++)
+        {
+            double angle = -Pi * static_cast<double>(k) / static_cast<double>(half);
+            m_twiddleReal.push_back(static_cast<float>(std::cos(angle)));
+            m_twiddleImaginary.push_back(static_cast<float>(std::sin(angle)));
+        }
+    }
+}
+
+size_t Fft::Size() const
+{
+    return m_size;
+}
+
+bool Fft::IsSimd() const
+{
+    return m_useSimd;
+}
+
+void Fft::PowerSpectrum(const float* input, float* power)
+{
+    for (size_t index = 0; index < m_size; index++)
+    {
+        m_real[m_bitReverse[index]] = input[index];
+        m_imaginary[m_bitReverse[index]] = 0;
+    }
+
+    Transform();
+
+    for (size_t bin = 0; bin <= m_size / 2; bin++)
+    {
+        power[bin] = m_real[bin] * m_real[bin] + m_imaginary[bin] * m_imaginary[bin];
+    }
+}
+
+void Fft::Forward(const float* input, float* real, float* imaginary)
+{
+    for (size_t index = 0; index < m_size; index++)
+    {
+        m_real[m_bitReverse[index]] = input[index];
+        m_imaginary[m_bitReverse[index]] = 0;
+    }
+
+    Transform();
+
+    for (size_t bin = 0; bin <= m_size / 2; bin++)
+    {
+        real[bin] = m_real[bin];
+        imaginary[bin] = m_imaginary[bin];
+    }
+}
+
+void Fft::Inverse(const float* real, const float* imaginary, float* output)
+{
+    // The inverse is the conjugate of the forward transform of the conjugate. The upper bins of a
+    // real signal are the conjugates of the lower, so their conjugates are the lower bins as they are.
+    size_t half = m_size / 2;
+    for (size_t bin = 0; bin < m_size; bin++)
+    {
+        bool isLower = bin <= half;
+        size_t source = isLower ? bin : m_size - bin;
+        m_real[m_bitReverse[bin]] = real[source];
+        m_imaginary[m_bitReverse[bin]] = isLower ? -imaginary[source] : imaginary[source];
+    }
+
+    Transform();
+
+    float scale = 1.0f / static_cast<float>(m_size);
+    for (size_t index = 0; index < m_size; index++)
+    {
+        output[index] = m_real[index] * scale;
+    }
+}
+
+void Fft::Transform()
+{
+    float* real = m_real.data();
+    float* imaginary = m_imaginary.data();
+    const float* twiddleReal = m_twiddleReal.data();
+    const float* twiddleImaginary = m_twiddleImaginary.data();
+
+    for (size_t half = 1; half < m_size; half *= 2)
+    {
+        for (size_t start = 0; start < m_size; start += 2 * half)
+        {
+            size_t k = 0;
+
+#ifdef CORE_FFT_SSE2
+            // Four butterflies at a time, once the stage is wide enough.
+            if (m_useSimd)
+            {
+                for (; k + 4 <= half; k += 4)
+                {
+                    size_t top = start + k;
+                    size_t bottom = top + half;
+                    __m128 wr = _mm_loadu_ps(twiddleReal + k);
+                    __m128 wi = _mm_loadu_ps(twiddleImaginary + k);
+                    __m128 br = _mm_loadu_ps(real + bottom);
+                    __m128 bi = _mm_loadu_ps(imaginary + bottom);
+                    __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+                    __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+                    __m128 ar = _mm_loadu_ps(real + top);
+                    __m128 ai = _mm_loadu_ps(imaginary + top);
+                    _mm_storeu_ps(real + top, _mm_add_ps(ar, tr));
+                    _mm_storeu_ps(imaginary + top, _mm_add_ps(ai, ti));
+                    _mm_storeu_ps(real + bottom, _mm_sub_ps(ar, tr));
+                    _mm_storeu_ps(imaginary + bottom, _mm_sub_ps(ai, ti));
+                }
+            }
+#endif
+
+            for (; k < half; k++)
+            {
+                size_t top = start + k;
+                size_t bottom = top + half;
+                float br = real[bottom];
+                float bi = imaginary[bottom];
+                float tr = br * twiddleReal[k] - bi * twiddleImaginary[k];
+                float ti = br * twiddleImaginary[k] + bi * twiddleReal[k];
+                float ar = real[top];
+                float ai = imaginary[top];
+                real[top] = ar + tr;
+                imaginary[top] = ai + ti;
+                real[bottom] = ar - tr;
+                imaginary[bottom] = ai - ti;
+            }
+        }
+
+        twiddleReal += half;
+        twiddleImaginary += half;
+    }
+}
@@ -0,0 +1,89 @@
+//-----------------------------------------------------------------------
+// <copyright file="Fft.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CORE_FFT_SSE2 1
+#endif
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// A radix-2 FFT of a fixed size, for the spectra of real frames. The butterflies run four at a
+    /// time with SSE2 where the compiler targets it. The vector and scalar paths do the same float
+    /// operations in the same order, so a frame has the same spectrum on every machine.
+    ///
+    class Fft
+    {
+    public:
+        ///
+        /// Set up for a size, a power of two of at least 4.
+        ///
+        explicit Fft(size_t size, bool useSimd = true);
+
+        size_t Size() const;
+
+        ///
+        /// Get whether the butterflies run on SSE2.
+        ///
+        bool IsSimd() const;
+
+        ///
+        /// Transform Size() real samples into the power (magnitude squared) of bins 0 to Size()/2.
+        ///
+        void PowerSpectrum(const float* input, float* power);
+
+        ///
+        /// Transform Size() real samples into the complex spectrum of bins 0 to Size()/2.
+        ///
+        void Forward(const float* input, float* real, float* imaginary);
+
+        ///
+        /// Transform bins 0 to Size()/2 of the spectrum of real samples back into Size() samples, as
+        /// the inverse of Forward.
+        ///
+        void Inverse(const float* real, const float* imaginary, float* output);
+
+    private:
+        ///
+        /// Transform the complex scratch buffers in place.
+        ///
+        void Transform();
+
+    private:
+        ///
+        /// The size.
+        ///
+        size_t m_size;
+
+        ///
+        /// Whether the butterflies run on SSE2.
+        ///
+        bool m_useSimd;
+
+        ///
+        /// Where each input sample goes, in bit-reversed order.
+        ///
+        std::vector<uint32_t> m_bitReverse;
+
+        ///
+        /// The twiddles of every stage, one after the other, so a stage reads them in sequence.
+        ///
+        std::vector<float> m_twiddleReal;
+        std::vector<float> m_twiddleImaginary;
+
+        ///
+        /// The scratch buffers.
+        ///
+        std::vector<float> m_real;
+        std::vector<float> m_imaginary;
+    };
+} }
@@ -0,0 +1,107 @@
+//-----------------------------------------------------------------------
+// <copyright file="ACRCloudServices.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "ACRCloudServices.h"
+#include "ACRCloudCodec.h"
+#include "Logger.h"
+#include <chrono>
+#include <ctime>
+#include <dlfcn.h>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::Ingest;
+
+namespace
+{
+    // Queries give up after this long, and are tried again with more audio.
+    const uint32_t QueryTimeoutSeconds = 10;
+}
+
+ACRCloudExtractor::ACRCloudExtractor()
+    : m_library(nullptr)
+    , m_createFingerprint(nullptr)
+    , m_free(nullptr)
+{
+}
+
+ACRCloudExtractor::~ACRCloudExtractor()
+{
+    if (m_library != nullptr)
+    {
+        dlclose(m_library);
+    }
+}
+
+bool ACRCloudExtractor::Load(const std::string& path)
+{
+    m_library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (m_library == nullptr)
+    {
+        LOG_ERROR("ACRCloudExtractor: %s", dlerror());
+        return false;
+    }
+
+    m_createFingerprint = reinterpret_cast<CreateFingerprintFunction>(dlsym(m_library, "create_fingerprint_by_filebuffer"));
+    m_free = reinterpret_cast<FreeFunction>(dlsym(m_library, "acr_free"));
+    if (m_createFingerprint == nullptr || m_free == nullptr)
+    {
+        LOG_ERROR("ACRCloudExtractor: %s is not the extractor library", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<uint8_t> ACRCloudExtractor::CreateFingerprint(const std::vector<uint8_t>& wavFile, uint32_t seconds)
+{
+    std::vector<uint8_t> fingerprint;
+    if (m_createFingerprint == nullptr)
+    {
+        return fingerprint;
+    }
+
+    // The library takes a mutable buffer but doesn't write it.
+    char* output = nullptr;
+    int rc = m_createFingerprint(
+        const_cast<char*>(reinterpret_cast<const char*>(wavFile.data())),
+        static_cast<int>(wavFile.size()),
+        0,
+        static_cast<int>(seconds),
+        0,
+        &output);
+    if (rc > 0 && output != nullptr)
+    {
+        fingerprint.assign(output, output + rc);
+    }
+
+    if (output != nullptr)
+    {
+        m_free(output);
+    }
+
+    return fingerprint;
+}
+
+ACRCloudIdentifier::ACRCloudIdentifier(const std::string& host, const std::string& accessKey, const std::string& accessSecret)
+    : m_transport(host, QueryTimeoutSeconds)
+    , m_accessKey(accessKey)
+    , m_accessSecret(accessSecret)
+{
+}
+
+bool ACRCloudIdentifier::Identify(const std::vector<uint8_t>& fingerprint, std::string& responseBody)
+{
+    ACRCloudRequestFields fields = ACRCloudCodec::CreateRequestFields(
+        m_accessKey,
+        m_accessSecret,
+        static_cast<int64_t>(time(nullptr)),
+        fingerprint.size());
+
+    uint64_t unique = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+    std::string boundary = ACRCloudCodec::CreateBoundary(unique);
+    std::vector<uint8_t> body = ACRCloudCodec::CreateRequestBody(fields, boundary, fingerprint.data(), fingerprint.size());
+    return m_transport.Post(ACRCloudCodec::RequestPath, ACRCloudCodec::CreateContentType(boundary), body, responseBody);
+}
@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------
+// <copyright file="ACRCloudServices.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "HttpTransport.h"
+#include "IngestDaemon.h"
+#include <string>
+
+namespace CrazyGiraffe { namespace Core { namespace Ingest
+{
+    ///
+    /// Fingerprints with the ACRCloud extractor library (libacrcloud_extr_tool.so), loaded at run time
+    /// so the daemon builds and runs without it.
+    ///
+    class ACRCloudExtractor : public Fingerprinter
+    {
+    public:
+        ACRCloudExtractor();
+
+        virtual ~ACRCloudExtractor();
+
+        ///
+        /// Load the library. Returns false if it or its functions aren't found.
+        ///
+        bool Load(const std::string& path);
+
+        virtual std::vector<uint8_t> CreateFingerprint(const std::vector<uint8_t>& wavFile, uint32_t seconds) override;
+
+    private:
+        typedef int (*CreateFingerprintFunction)(char*, int, int, int, char, char**);
+        typedef void (*FreeFunction)(char*);
+
+        ///
+        /// The library handle.
+        ///
+        void* m_library;
+
+        ///
+        /// create_fingerprint_by_filebuffer.
+        ///
+        CreateFingerprintFunction m_createFingerprint;
+
+        ///
+        /// acr_free.
+        ///
+        FreeFunction m_free;
+    };
+
+    ///
+    /// Identifies fingerprints with the ACRCloud identify API.
+    ///
+    class ACRCloudIdentifier : public TrackIdentifier
+    {
+    public:
+        ACRCloudIdentifier(const std::string& host, const std::string& accessKey, const std::string& accessSecret);
+
+        virtual bool Identify(const std::vector<uint8_t>& fingerprint, std::string& responseBody) override;
+
+    private:
+        ///
+        /// The transport to the host.
+        ///
+        HttpTransport m_transport;
+
+        ///
+        /// The access key.
+        ///
+        std::string m_accessKey;
+
+        ///
+        /// The access secret.
+        ///
+        std::string m_accessSecret;
+    };
+} } }
@@ -0,0 +1,427 @@
+//-----------------------------------------------------------------------
+// <copyright file="BatchIdentifier.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "BatchIdentifier.h"
+#include "ACRCloudCodec.h"
+#include "AudioLevelDetector.h"
+#include "Json.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "WavFormat.h"
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::Ingest;
+
+namespace
+{
+    // The level is measured over each 10ms.
+    const uint32_t LevelsPerSecond = 100;
+
+    // The audio a session would have by its last attempt, which is also what duplicates are found by.
+    const uint32_t MaximumQuerySeconds = RecognitionSession::MaxAttempts * RecognitionSession::AttemptIntervalSeconds;
+
+    size_t TicksToFrames(Ticks ticks, uint32_t sampleRate)
+    {
+        return static_cast<size_t>(static_cast<uint64_t>(ticks.count() > 0 ? ticks.count() : 0) * sampleRate / Ticks::period::den);
+    }
+}
+
+///
+/// A file being identified.
+///
+struct BatchIdentifier::FileJob
+{
+    FileJob()
+        : timeline()
+        , file()
+        , chunk()
+        , segmentFrames()
+        , remaining(0)
+    {
+    }
+
+    BatchTimeline timeline;
+    std::unique_ptr<MappedFile> file;
+    WavDataChunk chunk;
+
+    ///
+    /// The first frame and the frame count of each segment.
+    ///
+    std::vector<std::pair<size_t, size_t>> segmentFrames;
+
+    ///
+    /// The segments not yet done.
+    ///
+    std::atomic<size_t> remaining;
+};
+
+BatchIdentifier::BatchIdentifier(
+    const BatchOptions& options,
+    std::shared_ptr<Fingerprinter> fingerprinter,
+    std::shared_ptr<TrackIdentifier> identifier)
+    : m_options(options)
+    , m_fingerprinter(fingerprinter)
+    , m_identifier(identifier)
+    , m_queryBucket(options.queriesPerSecond, options.queryBurst)
+    , m_runLock()
+    , m_fileEnded()
+    , m_handler()
+    , m_remainingFiles(0)
+    , m_failedFiles(0)
+    , m_segmentLock()
+    , m_segmentIndex()
+    , m_knownSegments()
+    , m_statisticsLock()
+    , m_statistics()
+    , m_stopping(false)
+    , m_pool(options.workerCount)
+{
+}
+
+BatchIdentifier::~BatchIdentifier()
+{
+}
+
+size_t BatchIdentifier::Run(const std::vector<std::string>& paths, const BatchTimelineHandler& handler)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_runLock);
+        m_handler = handler;
+        m_remainingFiles = paths.size();
+        m_failedFiles = 0;
+    }
+
+    // A file is split on one worker; its segments are then spread across them all.
+    for (const std::string& path : paths)
+    {
+        std::shared_ptr<FileJob> job = std::make_shared<FileJob>();
+        job->timeline.path = path;
+        m_pool.Post([this, job] { SplitFile(job); });
+    }
+
+    std::unique_lock<std::mutex> lock(m_runLock);
+    m_fileEnded.wait(lock, [this] { return m_remainingFiles == 0; });
+    m_handler = nullptr;
+    return m_failedFiles;
+}
+
+BatchStatistics BatchIdentifier::Statistics() const
+{
+    std::lock_guard<std::mutex> lock(m_statisticsLock);
+    return m_statistics;
+}
+
+void BatchIdentifier::Stop()
+{
+    m_stopping = true;
+}
+
+void BatchIdentifier::SplitFile(std::shared_ptr<FileJob> job)
+{
+    BatchTimeline& timeline = job->timeline;
+    std::unique_ptr<WavReader> reader;
+    try
+    {
+        job->file = std::make_unique<MappedFile>(timeline.path);
+        reader = std::make_unique<WavReader>(job->file->Data(), job->file->Size());
+        ReadWavHeader(job->file->Data(), job->file->Size(), job->chunk);
+    }
+    catch (const std::runtime_error& ex)
+    {
+        LOG_WARNING("%s: %s", timeline.path.c_str(), ex.what());
+    }
+
+    if (reader == nullptr || reader->Format().sampleRate < LevelsPerSecond)
+    {
+        LOG_WARNING("Not a WAV file: %s", timeline.path.c_str());
+        EndFile(*job);
+        return;
+    }
+
+    const AudioFormat& format = reader->Format();
+    timeline.read = true;
+    timeline.durationSeconds = static_cast<double>(reader->FrameCount()) / format.sampleRate;
+    {
+        std::lock_guard<std::mutex> lock(m_statisticsLock);
+        m_statistics.audioSeconds += timeline.durationSeconds;
+    }
+
+    // The level of each 10ms, as loud as the audio sounds, starts and ends the segments; one level
+    // is a sample to the detector. A segment starts and ends where the level began to hold.
+    std::vector<std::pair<size_t, size_t>>& segments = job->segmentFrames;
+    if (m_options.thresholdValue < 0)
+    {
+        segments.emplace_back(0, reader->FrameCount());
+    }
+    else
+    {
+        size_t blockFrames = format.sampleRate / LevelsPerSecond;
+        size_t heldFrames = TicksToFrames(m_options.thresholdDuration, format.sampleRate);
+        AudioLevelDetector detector(LevelsPerSecond, 1, m_options.thresholdValue, m_options.thresholdDuration);
+        std::vector<float> samples(blockFrames * format.channelCount);
+        size_t start = 0;
+        bool inSegment = false;
+        for (size_t frames = reader->Read(samples.data(), blockFrames); frames > 0; frames = reader->Read(samples.data(), blockFrames))
+        {
+            double sum = 0;
+            for (size_t index = 0; index < frames * format.channelCount; index++)
+            {
+                sum += static_cast<double>(samples[index]) * samples[index];
+            }
+
+            float level = static_cast<float>(std::sqrt(sum / (frames * format.channelCount)));
+            size_t position = reader->Position();
+            size_t since = (position > heldFrames) ? (position - heldFrames) : 0;
+            detector.ProcessSamples(&level, 1, [&segments, &start, &inSegment, since](ThresholdStatus status)
+                {
+                    size_t previousEnd = segments.empty() ? 0 : (segments.back().first + segments.back().second);
+                    if (status == ThresholdStatus::AboveThreshold)
+                    {
+                        start = (since > previousEnd) ? since : previousEnd;
+                        inSegment = true;
+                    }
+                    else if (status == ThresholdStatus::BelowThreshold && inSegment)
+                    {
+                        segments.emplace_back(start, (since > start) ? (since - start) : 0);
+                        inSegment = false;
+                    }
+                });
+        }
+
+        if (inSegment)
+        {
+            segments.emplace_back(start, reader->FrameCount() - start);
+        }
+    }
+
+    // A long enough quiet between segments is the change to another program.
+    size_t programGapFrames = TicksToFrames(m_options.programGap, format.sampleRate);
+    uint32_t program = 1;
+    for (size_t index = 0; index < segments.size(); index++)
+    {
+        size_t previousEnd = (index == 0) ? segments[0].first : (segments[index - 1].first + segments[index - 1].second);
+        program += (index > 0 && segments[index].first - previousEnd >= programGapFrames) ? 1 : 0;
+
+        BatchSegment segment;
+        segment.program = program;
+        segment.number = static_cast<uint32_t>(index + 1);
+        segment.startSeconds = static_cast<double>(segments[index].first) / format.sampleRate;
+        segment.endSeconds = static_cast<double>(segments[index].first + segments[index].second) / format.sampleRate;
+        segment.status = IdentifyStatus::Incomplete;
+        segment.attempts = 0;
+        segment.duplicateNumber = 0;
+        timeline.segments.push_back(segment);
+    }
+
+    LOG_INFO("%s: %zu segments in %zu programs", timeline.path.c_str(), segments.size(), segments.empty() ? 0 : static_cast<size_t>(program));
+    if (segments.empty())
+    {
+        EndFile(*job);
+        return;
+    }
+
+    job->remaining = segments.size();
+    for (size_t index = 0; index < segments.size(); index++)
+    {
+        m_pool.Post([this, job, index] { IdentifySegment(job, index); });
+    }
+}
+
+void BatchIdentifier::IdentifySegment(std::shared_ptr<FileJob> job, size_t index)
+{
+    const AudioFormat& format = job->chunk.format;
+    size_t firstFrame = job->segmentFrames[index].first;
+    size_t frameCount = job->segmentFrames[index].second;
+    BatchSegment& segment = job->timeline.segments[index];
+
+    // A session tries with AttemptIntervalSeconds of audio, so a shorter segment is only timed.
+    if (m_stopping || frameCount <= static_cast<size_t>(RecognitionSession::AttemptIntervalSeconds) * format.sampleRate)
+    {
+        EndSegment(job);
+        return;
+    }
+
+    // Duplicates are found by the landmarks of all the audio a session would query with, which don't
+    // depend on the exact start of the segment.
+    size_t queryFrames = static_cast<size_t>(MaximumQuerySeconds) * format.sampleRate;
+    queryFrames = (frameCount < queryFrames) ? frameCount : queryFrames;
+    std::vector<Landmark> landmarks;
+    if (m_fingerprinter != nullptr && m_identifier != nullptr && format.sampleRate >= LandmarkFingerprinter::AnalysisRate)
+    {
+        WavReader reader(job->file->Data(), job->file->Size());
+        std::vector<float> samples(queryFrames * format.channelCount);
+        reader.Seek(firstFrame);
+        size_t frames = reader.Read(samples.data(), queryFrames);
+        landmarks = LandmarkFingerprinter::Fingerprint(samples.data(), frames * format.channelCount, format.sampleRate, format.channelCount);
+    }
+
+    // The segment is known before it is queried, so a duplicate waits for its result rather than
+    // querying alongside it. A duplicate only waits on a segment known before it, so none wait on each other.
+    std::promise<SegmentOutcome> promise;
+    std::unique_ptr<KnownSegment> original;
+    if (!landmarks.empty())
+    {
+        std::lock_guard<std::mutex> lock(m_segmentLock);
+        LandmarkMatch match = {};
+        if (m_segmentIndex.Match(landmarks, LandmarkIndex::DefaultMinimumScore, match))
+        {
+            original = std::make_unique<KnownSegment>(m_knownSegments[match.track]);
+        }
+
+        TrackInfo track;
+        track.identifier = std::to_string(m_knownSegments.size());
+        m_segmentIndex.AddTrack(track, landmarks);
+        m_knownSegments.push_back({ job->timeline.path, segment.number, promise.get_future().share() });
+    }
+
+    SegmentOutcome outcome = {};
+    outcome.status = IdentifyStatus::Incomplete;
+    bool reused = false;
+    if (original != nullptr)
+    {
+        outcome = original->outcome.get();
+        reused = outcome.answered;
+        if (reused)
+        {
+            segment.duplicateFile = original->path;
+            segment.duplicateNumber = original->number;
+            LOG_INFO("%s: segment %u is segment %u of %s", job->timeline.path.c_str(), segment.number, original->number, original->path.c_str());
+        }
+    }
+
+    if (!reused)
+    {
+        outcome = Query(*job, firstFrame, queryFrames);
+    }
+
+    promise.set_value(outcome);
+    segment.status = outcome.status;
+    segment.attempts = reused ? 0 : outcome.attempts;
+    segment.tracks = outcome.tracks;
+    if (reused)
+    {
+        std::lock_guard<std::mutex> lock(m_statisticsLock);
+        m_statistics.reused++;
+    }
+
+    EndSegment(job);
+}
+
+BatchIdentifier::SegmentOutcome BatchIdentifier::Query(const FileJob& job, size_t firstFrame, size_t frameCount)
+{
+    SegmentOutcome outcome = {};
+    outcome.status = IdentifyStatus::Incomplete;
+    if (m_fingerprinter == nullptr || m_identifier == nullptr)
+    {
+        return outcome;
+    }
+
+    // The attempts of a session: AttemptIntervalSeconds more audio each time, until one is identified
+    // or there is no more audio. A failed fingerprint or query is tried again with more, as a session does.
+    const AudioFormat& format = job.chunk.format;
+    const uint8_t* data = job.file->Data() + job.chunk.offset + firstFrame * format.BytesPerFrame();
+    RecognitionSession state(format.BytesPerSecond());
+    state.SetStatus(IdentifyStatus::Incomplete);
+    outcome.answered = true;
+    size_t previousFrames = 0;
+    for (uint32_t attempt = 1; attempt <= RecognitionSession::MaxAttempts && state.CanAttempt() && !m_stopping; attempt++)
+    {
+        size_t frames = static_cast<size_t>(attempt * RecognitionSession::AttemptIntervalSeconds) * format.sampleRate;
+        frames = (frameCount < frames) ? frameCount : frames;
+        if (frames == previousFrames)
+        {
+            break;
+        }
+
+        previousFrames = frames;
+        std::vector<uint8_t> wavFile = CreateWavFile(format, data, frames * format.BytesPerFrame());
+        std::vector<uint8_t> fingerprint = m_fingerprinter->CreateFingerprint(wavFile, static_cast<uint32_t>(frames / format.sampleRate));
+        if (fingerprint.empty())
+        {
+            LOG_WARNING("%s: no fingerprint", job.timeline.path.c_str());
+            outcome.answered = false;
+            continue;
+        }
+
+        std::this_thread::sleep_for(m_queryBucket.Reserve(TokenBucket::Clock::now()));
+        {
+            std::lock_guard<std::mutex> lock(m_statisticsLock);
+            m_statistics.queries++;
+        }
+
+        std::string responseBody;
+        if (!m_identifier->Identify(fingerprint, responseBody))
+        {
+            LOG_WARNING("%s: query failed", job.timeline.path.c_str());
+            outcome.answered = false;
+            continue;
+        }
+
+        ACRCloudTrackResult result;
+        try
+        {
+            result = ACRCloudCodec::ParseTrackResponse(responseBody);
+        }
+        catch (const JsonError& ex)
+        {
+            LOG_WARNING("%s: %s", job.timeline.path.c_str(), ex.what());
+            outcome.answered = false;
+            continue;
+        }
+
+        state.EndAttempt();
+        if (result.code == 0)
+        {
+            outcome.tracks = result.tracks;
+            state.SetStatus(IdentifyStatus::Complete);
+        }
+    }
+
+    // Every answer was that there is no match.
+    if (outcome.answered && !state.IsFinished() && state.Attempts() > 0 && !m_stopping)
+    {
+        state.SetStatus(IdentifyStatus::Error);
+    }
+
+    outcome.status = state.Status();
+    outcome.attempts = state.Attempts();
+    return outcome;
+}
+
+void BatchIdentifier::EndSegment(std::shared_ptr<FileJob> job)
+{
+    if (--job->remaining == 0)
+    {
+        EndFile(*job);
+    }
+}
+
+void BatchIdentifier::EndFile(FileJob& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_statisticsLock);
+        m_statistics.files++;
+        m_statistics.segments += job.timeline.segments.size();
+    }
+
+    std::lock_guard<std::mutex> lock(m_runLock);
+    if (!job.timeline.read)
+    {
+        m_failedFiles++;
+    }
+
+    if (m_handler)
+    {
+        m_handler(job.timeline);
+    }
+
+    m_remainingFiles--;
+    m_fileEnded.notify_all();
+}
@@ -0,0 +1,258 @@
+//-----------------------------------------------------------------------
+// <copyright file="BatchIdentifier.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "IngestDaemon.h"
+#include "LandmarkIndex.h"
+#include "SessionScheduler.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core { namespace Ingest
+{
+    ///
+    /// How a batch splits and identifies its files.
+    ///
+    struct BatchOptions
+    {
+        BatchOptions()
+            : workerCount(0)
+            , queriesPerSecond(10)
+            , queryBurst(10)
+            , thresholdValue(0.03)
+            , thresholdDuration(Ticks(10000000))
+            , programGap(Ticks(40000000))
+        {
+        }
+
+        ///
+        /// The threads which split and fingerprint; zero means one per core.
+        ///
+        size_t workerCount;
+
+        ///
+        /// The queries sent per second, across the batch, or zero for no limit.
+        ///
+        double queriesPerSecond;
+
+        ///
+        /// The queries which may be sent at once after a quiet spell.
+        ///
+        double queryBurst;
+
+        ///
+        /// The level, of each 10ms of audio, which starts and ends a segment, or negative for one
+        /// segment per file.
+        ///
+        double thresholdValue;
+
+        ///
+        /// How long the level must hold.
+        ///
+        Ticks thresholdDuration;
+
+        ///
+        /// The quiet between two segments which starts another program.
+        ///
+        Ticks programGap;
+    };
+
+    ///
+    /// A stretch of sound in a file, and what it was identified as.
+    ///
+    struct BatchSegment
+    {
+        ///
+        /// The program and the segment, counting from 1 in the file.
+        ///
+        uint32_t program;
+        uint32_t number;
+
+        double startSeconds;
+        double endSeconds;
+        IdentifyStatus status;
+        uint32_t attempts;
+
+        ///
+        /// The segment whose result was taken, by the path of its file and its number; the path is
+        /// empty if the segment was queried itself.
+        ///
+        std::string duplicateFile;
+        uint32_t duplicateNumber;
+
+        std::vector<TrackInfo> tracks;
+    };
+
+    ///
+    /// The segments of a file.
+    ///
+    struct BatchTimeline
+    {
+        std::string path;
+
+        ///
+        /// False if the file couldn't be read as a WAV file.
+        ///
+        bool read;
+
+        double durationSeconds;
+        std::vector<BatchSegment> segments;
+    };
+
+    ///
+    /// Called with the timeline of each file once its segments are done, one at a time, from any thread.
+    ///
+    using BatchTimelineHandler = std::function<void(const BatchTimeline&)>;
+
+    ///
+    /// What a batch did.
+    ///
+    struct BatchStatistics
+    {
+        size_t files;
+        size_t segments;
+        size_t queries;
+        size_t reused;
+        double audioSeconds;
+    };
+
+    ///
+    /// Identifies whole WAV files offline, as fast as the cores and the query rate allow rather than
+    /// at the speed they play. Each file is mapped and split into segments where the level holds
+    /// below the threshold, and its segments are fingerprinted on a pool, with the attempts a session
+    /// would make on the same audio. Queries are limited to a rate across the batch. A segment whose
+    /// landmarks match one already in the batch takes its result rather than querying again. Without
+    /// a fingerprinter and an identifier, segments are only timed. Both must be thread safe.
+    ///
+    class BatchIdentifier
+    {
+    public:
+        BatchIdentifier(
+            const BatchOptions& options,
+            std::shared_ptr<Fingerprinter> fingerprinter,
+            std::shared_ptr<TrackIdentifier> identifier);
+
+        ///
+        /// Run the work started, then stop.
+        ///
+        ~BatchIdentifier();
+
+        ///
+        /// Identify the files. Returns the count which couldn't be read.
+        ///
+        size_t Run(const std::vector<std::string>& paths, const BatchTimelineHandler& handler);
+
+        BatchStatistics Statistics() const;
+
+        ///
+        /// Stop starting segments, from any thread; the segments not started are reported Incomplete.
+        ///
+        void Stop();
+
+    private:
+        struct FileJob;
+
+        ///
+        /// The result of a segment, for the segments which duplicate it.
+        ///
+        struct SegmentOutcome
+        {
+            IdentifyStatus status;
+            uint32_t attempts;
+            std::vector<TrackInfo> tracks;
+
+            ///
+            /// Whether every attempt had an answer, so a duplicate would get the same.
+            ///
+            bool answered;
+        };
+
+        ///
+        /// A segment the duplicates are found among.
+        ///
+        struct KnownSegment
+        {
+            std::string path;
+            uint32_t number;
+            std::shared_future<SegmentOutcome> outcome;
+        };
+
+        void SplitFile(std::shared_ptr<FileJob> job);
+
+        void IdentifySegment(std::shared_ptr<FileJob> job, size_t index);
+
+        ///
+        /// Make the attempts of a session on the start of a segment.
+        ///
+        SegmentOutcome Query(const FileJob& job, size_t firstFrame, size_t frameCount);
+
+        void EndSegment(std::shared_ptr<FileJob> job);
+
+        void EndFile(FileJob& job);
+
+    private:
+        BatchIdentifier(const BatchIdentifier&) = delete;
+        BatchIdentifier& operator=(const BatchIdentifier&) = delete;
+
+        ///
+        /// The options.
+        ///
+        BatchOptions m_options;
+
+        ///
+        /// The fingerprinter.
+        ///
+        std::shared_ptr<Fingerprinter> m_fingerprinter;
+
+        ///
+        /// The identifier.
+        ///
+        std::shared_ptr<TrackIdentifier> m_identifier;
+
+        ///
+        /// The query rate limit.
+        ///
+        TokenBucket m_queryBucket;
+
+        ///
+        /// Where timelines go, one at a time, and the files not yet done.
+        ///
+        std::mutex m_runLock;
+        std::condition_variable m_fileEnded;
+        BatchTimelineHandler m_handler;
+        size_t m_remainingFiles;
+        size_t m_failedFiles;
+
+        ///
+        /// The landmarks of the segments seen, each track of the index being a known segment.
+        ///
+        std::mutex m_segmentLock;
+        LandmarkIndex m_segmentIndex;
+        std::vector<KnownSegment> m_knownSegments;
+
+        ///
+        /// The counts.
+        ///
+        mutable std::mutex m_statisticsLock;
+        BatchStatistics m_statistics;
+
+        std::atomic<bool> m_stopping;
+
+        ///
+        /// The pool. Last, so it finishes its work before the rest goes.
+        ///
+        WorkStealingPool m_pool;
+    };
+} } }
@@ -0,0 +1,190 @@
+//-----------------------------------------------------------------------
+// <copyright file="HttpTransport.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "HttpTransport.h"
+#include "Logger.h"
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+using namespace CrazyGiraffe::Core::Ingest;
+
+namespace
+{
+    // Closes the socket on every path.
+    class SocketHandle
+    {
+    public:
+        explicit SocketHandle(int socket)
+            : m_socket(socket)
+        {
+        }
+
+        ~SocketHandle()
+        {
+            if (m_socket >= 0)
+            {
+                close(m_socket);
+            }
+        }
+
+        int Get() const
+        {
+            return m_socket;
+        }
+
+    private:
+        SocketHandle(const SocketHandle&) = delete;
+        SocketHandle& operator=(const SocketHandle&) = delete;
+
+        int m_socket;
+    };
+
+    bool SendAll(int socket, const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t sent = send(socket, data, size, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            if (sent <= 0)
+            {
+                return false;
+            }
+
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+
+        return true;
+    }
+}
+
+HttpTransport::HttpTransport(const std::string& host, uint32_t timeoutSeconds)
+    : m_hostName(host)
+    , m_port("80")
+    , m_timeoutSeconds(timeoutSeconds)
+{
+    size_t colon = host.rfind(':');
+    if (colon != std::string::npos)
+    {
+        m_hostName = host.substr(0, colon);
+        m_port = host.substr(colon + 1);
+    }
+}
+
+bool HttpTransport::Post(
+    const std::string& path,
+    const std::string& contentType,
+    const std::vector<uint8_t>& body,
+    std::string& responseBody)
+{
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    int rc = getaddrinfo(m_hostName.c_str(), m_port.c_str(), &hints, &addresses);
+    if (rc != 0)
+    {
+        LOG_WARNING("HttpTransport: cannot resolve %s: %s", m_hostName.c_str(), gai_strerror(rc));
+        return false;
+    }
+
+    // Connect to the first address which answers.
+    int connected = -1;
+    for (addrinfo* address = addresses; address != nullptr && connected < 0; address = address->ai_next)
+    {
+        int candidate = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (candidate < 0)
+        {
+            continue;
+        }
+
+        timeval timeout = {};
+        timeout.tv_sec = m_timeoutSeconds;
+        setsockopt(candidate, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(candidate, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if (connect(candidate, address->ai_addr, address->ai_addrlen) == 0)
+        {
+            connected = candidate;
+        }
+        else
+        {
+            close(candidate);
+        }
+    }
+
+    freeaddrinfo(addresses);
+    SocketHandle socketHandle(connected);
+    if (connected < 0)
+    {
+        LOG_WARNING("HttpTransport: cannot connect to %s", m_hostName.c_str());
+        return false;
+    }
+
+    // HTTP/1.0 so the response is never chunked and ends when the connection closes.
+    std::string request;
+    request.append("POST ").append(path).append(" HTTP/1.0\r\n");
+    request.append("Host: ").append(m_hostName).append("\r\n");
+    request.append("Content-Type: ").append(contentType).append("\r\n");
+    request.append("Content-Length: ").append(std::to_string(body.size())).append("\r\n");
+    request.append("Connection: close\r\n\r\n");
+    if (!SendAll(connected, request.data(), request.size()) ||
+        !SendAll(connected, reinterpret_cast<const char*>(body.data()), body.size()))
+    {
+        LOG_WARNING("HttpTransport: send failed");
+        return false;
+    }
+
+    std::string response;
+    char buffer[4096];
+    for (;;)
+    {
+        ssize_t received = recv(connected, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (received < 0)
+        {
+            LOG_WARNING("HttpTransport: receive failed");
+            return false;
+        }
+
+        if (received == 0)
+        {
+            break;
+        }
+
+        response.append(buffer, static_cast<size_t>(received));
+    }
+
+    // "HTTP/1.x 200 OK"
+    size_t headerEnd = response.find("\r\n\r\n");
+    if (response.compare(0, 5, "HTTP/") != 0 || headerEnd == std::string::npos)
+    {
+        LOG_WARNING("HttpTransport: malformed response");
+        return false;
+    }
+
+    size_t statusStart = response.find(' ');
+    int status = (statusStart != std::string::npos) ? atoi(response.c_str() + statusStart + 1) : 0;
+    if (status < 200 || status > 299)
+    {
+        LOG_WARNING("HttpTransport: status %d", status);
+        return false;
+    }
+
+    responseBody = response.substr(headerEnd + 4);
+    return true;
+}
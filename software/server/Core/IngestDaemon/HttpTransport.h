@@ -0,0 +1,51 @@
+//-----------------------------------------------------------------------
+// <copyright file="HttpTransport.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core { namespace Ingest
+{
+    ///
+    /// A blocking HTTP/1.0 client over POSIX sockets, for plain http:// endpoints.
+    ///
+    class HttpTransport
+    {
+    public:
+        ///
+        /// Create a transport to a host, as "name" or "name:port".
+        ///
+        HttpTransport(const std::string& host, uint32_t timeoutSeconds);
+
+        ///
+        /// Post a body. Returns false on a transport error or a status other than 2xx.
+        ///
+        bool Post(
+            const std::string& path,
+            const std::string& contentType,
+            const std::vector<uint8_t>& body,
+            std::string& responseBody);
+
+    private:
+        ///
+        /// The host name.
+        ///
+        std::string m_hostName;
+
+        ///
+        /// The port.
+        ///
+        std::string m_port;
+
+        ///
+        /// The send and receive timeout.
+        ///
+        uint32_t m_timeoutSeconds;
+    };
+} } }
@@ -0,0 +1,463 @@
+//-----------------------------------------------------------------------
+// <copyright file="IngestDaemon.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "IngestDaemon.h"
+#include "ACRCloudCodec.h"
+#include "AudioFrameConverter.h"
+#include "AudioLevelDetector.h"
+#include "Json.h"
+#include "Logger.h"
+#include "SpectralGate.h"
+#include "WavFormat.h"
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <thread>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::Ingest;
+
+namespace
+{
+    // Audio is read a tenth of a second at a time.
+    const uint32_t ReadsPerSecond = 10;
+
+    // The audio kept for a session; attempts past this use the start of the session.
+    const uint32_t MaximumSessionSeconds = 30;
+
+    // Enough to hold the header of any WAV file worth reading.
+    const size_t HeaderProbeSize = 4096;
+}
+
+///
+/// A session in progress, shared with its recognition.
+///
+struct Deck::ActiveSession
+{
+    ActiveSession(uint32_t number, size_t bytesPerSecond, double startSeconds)
+        : number(number)
+        , state(bytesPerSecond)
+        , startSeconds(startSeconds)
+        , clicks(0)
+        , dropouts(0)
+        , reported(false)
+    {
+    }
+
+    uint32_t number;
+    RecognitionSession state;
+    double startSeconds;
+    std::atomic<uint32_t> clicks;
+    std::atomic<uint32_t> dropouts;
+    std::mutex lock;
+    std::vector<uint8_t> audio;
+    std::vector<TrackInfo> tracks;
+    std::atomic<bool> reported;
+};
+
+Deck::Deck(
+    const DeckOptions& options,
+    std::shared_ptr<Fingerprinter> fingerprinter,
+    std::shared_ptr<TrackIdentifier> identifier,
+    DeckResultHandler resultHandler)
+    : m_options(options)
+    , m_fingerprinter(fingerprinter)
+    , m_identifier(identifier)
+    , m_resultHandler(resultHandler)
+    , m_session()
+    , m_recognition()
+    , m_synchronous(false)
+    , m_sessionCount(0)
+{
+}
+
+Deck::~Deck()
+{
+    if (m_recognition.valid())
+    {
+        m_recognition.wait();
+    }
+}
+
+bool Deck::Run(const std::atomic<bool>& stopping)
+{
+    FILE* input = (m_options.path == "-") ? stdin : fopen(m_options.path.c_str(), "rb");
+    if (input == nullptr)
+    {
+        LOG_ERROR("Deck %s: cannot open %s", m_options.name.c_str(), m_options.path.c_str());
+        return false;
+    }
+
+    // A file waits for recognition; there is nothing live to fall behind.
+    struct stat status = {};
+    m_synchronous = (fstat(fileno(input), &status) == 0) && S_ISREG(status.st_mode);
+
+    // WAV input describes itself; raw input is as configured.
+    std::vector<uint8_t> buffer(HeaderProbeSize);
+    size_t pending = fread(buffer.data(), 1, buffer.size(), input);
+    size_t offset = 0;
+    WavDataChunk chunk = {};
+    bool bounded = false;
+    uint64_t remaining = 0;
+    if (ReadWavHeader(buffer.data(), pending, chunk))
+    {
+        m_options.format = chunk.format;
+        offset = chunk.offset;
+
+        // The samples end with the data chunk, ahead of any tags; a stream which doesn't know its
+        // length runs to the end.
+        bounded = chunk.declaredSize != 0 && chunk.declaredSize != 0xFFFFFFFF;
+        remaining = chunk.declaredSize;
+    }
+
+    const AudioFormat& format = m_options.format;
+    uint32_t bytesPerFrame = format.BytesPerFrame();
+    bool isFloat = (format.sampleType == SampleType::Float);
+    if (bytesPerFrame == 0 || format.sampleRate == 0 || (isFloat && format.bitsPerSample != 32) || (!isFloat && format.bitsPerSample > 32))
+    {
+        LOG_ERROR("Deck %s: unsupported format", m_options.name.c_str());
+        if (input != stdin)
+        {
+            fclose(input);
+        }
+
+        return false;
+    }
+
+    // Sessions start and end with the level, or one spans the stream.
+    bool detectLevel = m_options.thresholdValue >= 0;
+    AudioLevelDetector detector(format.sampleRate, format.channelCount, detectLevel ? m_options.thresholdValue : 0, m_options.thresholdDuration);
+    std::vector<float> samples;
+
+    // The clicks and dropouts are repaired before the level is detected, so a dropout doesn't end
+    // a session; the hiss is learned while the level is below the threshold, between the tracks.
+    std::unique_ptr<ArtifactDetector> repairer;
+    std::unique_ptr<SpectralGate> gate;
+    std::unique_ptr<AudioFrameConverter> converter;
+    std::vector<float> processed;
+    std::vector<uint8_t> processedBuffer;
+    if (m_options.repair)
+    {
+        repairer = std::make_unique<ArtifactDetector>(format.sampleRate, format.channelCount);
+    }
+
+    if (m_options.denoise)
+    {
+        gate = std::make_unique<SpectralGate>(format.sampleRate, format.channelCount);
+    }
+
+    if (repairer != nullptr || gate != nullptr)
+    {
+        converter = std::make_unique<AudioFrameConverter>(format.sampleType, format.bitsPerSample);
+    }
+
+    uint64_t position = 0;
+    size_t readSize = (format.BytesPerSecond() / ReadsPerSecond / bytesPerFrame) * bytesPerFrame;
+    readSize = (readSize > 0) ? readSize : bytesPerFrame;
+    buffer.erase(buffer.begin(), buffer.begin() + offset);
+    pending -= offset;
+    if (bounded)
+    {
+        pending = (pending > remaining) ? static_cast<size_t>(remaining) : pending;
+        remaining -= pending;
+    }
+
+    buffer.resize(pending > readSize ? pending : readSize);
+
+    if (!detectLevel)
+    {
+        StartSession(0);
+    }
+
+    for (;;)
+    {
+        if (pending < bytesPerFrame)
+        {
+            size_t room = buffer.size() - pending;
+            room = (bounded && room > remaining) ? static_cast<size_t>(remaining) : room;
+            size_t read = fread(buffer.data() + pending, 1, room, input);
+            pending += read;
+            remaining -= bounded ? read : 0;
+        }
+
+        size_t size = pending - (pending % bytesPerFrame);
+        if (size == 0 || stopping)
+        {
+            break;
+        }
+
+        size_t sampleCount = size / (format.bitsPerSample / 8);
+        if (detectLevel || converter != nullptr)
+        {
+            samples.resize(sampleCount);
+            if (isFloat)
+            {
+                memcpy(samples.data(), buffer.data(), size);
+            }
+            else
+            {
+                AudioFrameConverter::ConvertToFloat(buffer.data(), sampleCount, format.bitsPerSample, samples.data());
+            }
+        }
+
+        if (repairer != nullptr)
+        {
+            processed.resize(sampleCount);
+            repairer->ProcessSamples(samples.data(), sampleCount, processed.data(), [this](const Artifact& artifact)
+                {
+                    AddArtifact(artifact);
+                });
+            samples.swap(processed);
+        }
+
+        if (detectLevel)
+        {
+            detector.ProcessSamples(samples.data(), sampleCount, [this, position](ThresholdStatus status)
+                {
+                    if (status == ThresholdStatus::AboveThreshold)
+                    {
+                        StartSession(position);
+                    }
+                    else if (status == ThresholdStatus::BelowThreshold)
+                    {
+                        EndSession();
+                    }
+                });
+        }
+
+        if (gate != nullptr)
+        {
+            processed.resize(sampleCount);
+            gate->ProcessSamples(samples.data(), sampleCount, detector.Status() == ThresholdStatus::BelowThreshold, processed.data());
+            samples.swap(processed);
+        }
+
+        if (converter != nullptr)
+        {
+            processedBuffer.resize(size);
+            converter->Convert(samples.data(), sampleCount, processedBuffer.data());
+            AddAudio(processedBuffer.data(), size);
+        }
+        else
+        {
+            AddAudio(buffer.data(), size);
+        }
+
+        position += size;
+
+        // Keep a partial frame for the next read.
+        memmove(buffer.data(), buffer.data() + size, pending - size);
+        pending -= size;
+    }
+
+    bool failed = ferror(input) != 0 && !stopping;
+    if (input != stdin)
+    {
+        fclose(input);
+    }
+
+    EndSession();
+    return !failed;
+}
+
+void Deck::StartSession(uint64_t position)
+{
+    EndSession();
+
+    double startSeconds = static_cast<double>(position) / m_options.format.BytesPerSecond();
+    m_session = std::make_shared<ActiveSession>(++m_sessionCount, m_options.format.BytesPerSecond(), startSeconds);
+    m_session->state.SetStatus(IdentifyStatus::Incomplete);
+    LOG_INFO("Deck %s: session %u started at %.1fs", m_options.name.c_str(), m_session->number, startSeconds);
+}
+
+void Deck::EndSession()
+{
+    if (m_session == nullptr)
+    {
+        return;
+    }
+
+    // Let the attempt in flight finish, so its outcome is the one reported.
+    if (m_recognition.valid())
+    {
+        m_recognition.wait();
+    }
+
+    Report(*m_session);
+    m_session.reset();
+}
+
+void Deck::AddAudio(const uint8_t* data, size_t size)
+{
+    if (m_session == nullptr || m_session->state.IsFinished())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_session->lock);
+        if (m_session->audio.size() < static_cast<size_t>(MaximumSessionSeconds) * m_options.format.BytesPerSecond())
+        {
+            m_session->audio.insert(m_session->audio.end(), data, data + size);
+        }
+    }
+
+    // Skip the attempt if one is in progress; the next one has all the audio.
+    size_t targetSize = 0;
+    if (m_session->state.AddAudio(size, targetSize) && m_fingerprinter != nullptr && m_identifier != nullptr)
+    {
+        if (m_synchronous)
+        {
+            Recognize(m_session, targetSize);
+        }
+        else if (!m_recognition.valid() || m_recognition.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            m_recognition = std::async(std::launch::async, &Deck::Recognize, this, m_session, targetSize);
+        }
+    }
+}
+
+void Deck::AddArtifact(const Artifact& artifact)
+{
+    bool isClick = artifact.type == ArtifactType::Click;
+    LOG_DEBUG("Deck %s: %s at %.3fs", m_options.name.c_str(), isClick ? "click" : "dropout",
+        static_cast<double>(artifact.position) / m_options.format.sampleRate);
+    if (m_session != nullptr)
+    {
+        (isClick ? m_session->clicks : m_session->dropouts)++;
+    }
+}
+
+void Deck::Recognize(std::shared_ptr<ActiveSession> session, size_t targetSize)
+{
+    // Only allow 3 attempts.
+    if (!session->state.CanAttempt())
+    {
+        if (session->state.SetStatus(IdentifyStatus::Error))
+        {
+            Report(*session);
+        }
+
+        return;
+    }
+
+    std::vector<uint8_t> wavFile;
+    {
+        std::lock_guard<std::mutex> lock(session->lock);
+        size_t size = (targetSize < session->audio.size()) ? targetSize : session->audio.size();
+        wavFile = CreateWavFile(m_options.format, session->audio.data(), size);
+    }
+
+    uint32_t seconds = static_cast<uint32_t>((wavFile.size() - WavHeaderSize) / m_options.format.BytesPerSecond());
+    std::vector<uint8_t> fingerprint = m_fingerprinter->CreateFingerprint(wavFile, seconds);
+    if (fingerprint.empty())
+    {
+        LOG_WARNING("Deck %s: no fingerprint", m_options.name.c_str());
+        return;
+    }
+
+    // A failed query or response is tried again with more audio.
+    std::string responseBody;
+    if (!m_identifier->Identify(fingerprint, responseBody))
+    {
+        LOG_WARNING("Deck %s: query failed", m_options.name.c_str());
+        return;
+    }
+
+    ACRCloudTrackResult result;
+    try
+    {
+        result = ACRCloudCodec::ParseTrackResponse(responseBody);
+    }
+    catch (const JsonError& ex)
+    {
+        LOG_WARNING("Deck %s: %s", m_options.name.c_str(), ex.what());
+        return;
+    }
+
+    session->state.EndAttempt();
+    if (result.code == 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(session->lock);
+            session->tracks = result.tracks;
+        }
+
+        if (session->state.SetStatus(IdentifyStatus::Complete))
+        {
+            Report(*session);
+        }
+    }
+}
+
+void Deck::Report(ActiveSession& session)
+{
+    if (session.reported.exchange(true) || !m_resultHandler)
+    {
+        return;
+    }
+
+    DeckResult result;
+    result.deck = m_options.name;
+    result.session = session.number;
+    result.status = session.state.Status();
+    result.attempts = session.state.Attempts();
+    result.startSeconds = session.startSeconds;
+    result.clicks = session.clicks;
+    result.dropouts = session.dropouts;
+    {
+        std::lock_guard<std::mutex> lock(session.lock);
+        result.tracks = session.tracks;
+    }
+
+    m_resultHandler(result);
+}
+
+IngestDaemon::IngestDaemon(
+    std::shared_ptr<Fingerprinter> fingerprinter,
+    std::shared_ptr<TrackIdentifier> identifier,
+    DeckResultHandler resultHandler)
+    : m_fingerprinter(fingerprinter)
+    , m_identifier(identifier)
+    , m_resultHandler(resultHandler)
+    , m_decks()
+    , m_stopping(false)
+{
+}
+
+void IngestDaemon::AddDeck(const DeckOptions& options)
+{
+    m_decks.push_back(options);
+}
+
+int IngestDaemon::Run()
+{
+    std::atomic<int> failed(0);
+    std::vector<std::thread> threads;
+    for (const DeckOptions& options : m_decks)
+    {
+        threads.emplace_back([this, options, &failed]
+            {
+                Deck deck(options, m_fingerprinter, m_identifier, m_resultHandler);
+                if (!deck.Run(m_stopping))
+                {
+                    failed++;
+                }
+            });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    return failed;
+}
+
+void IngestDaemon::Stop()
+{
+    m_stopping = true;
+}
@@ -0,0 +1,229 @@
+//-----------------------------------------------------------------------
+// <copyright file="IngestDaemon.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "ArtifactDetector.h"
+#include "AudioFormat.h"
+#include "RecognitionSession.h"
+#include "Track.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core { namespace Ingest
+{
+    ///
+    /// Creates a fingerprint from a WAV file. Returns an empty fingerprint on failure.
+    ///
+    class Fingerprinter
+    {
+    public:
+        virtual ~Fingerprinter() {}
+
+        virtual std::vector<uint8_t> CreateFingerprint(const std::vector<uint8_t>& wavFile, uint32_t seconds) = 0;
+    };
+
+    ///
+    /// Looks a fingerprint up. Returns false if the query failed.
+    ///
+    class TrackIdentifier
+    {
+    public:
+        virtual ~TrackIdentifier() {}
+
+        virtual bool Identify(const std::vector<uint8_t>& fingerprint, std::string& responseBody) = 0;
+    };
+
+    ///
+    /// One stream to ingest.
+    ///
+    struct DeckOptions
+    {
+        DeckOptions()
+            : format({ 44100, 2, 16, SampleType::Pcm })
+            , thresholdValue(-1)
+            , thresholdDuration(Ticks(5000000))
+            , denoise(false)
+            , repair(false)
+        {
+        }
+
+        ///
+        /// The name the results are reported under.
+        ///
+        std::string name;
+
+        ///
+        /// The file or pipe to read; "-" is standard input.
+        ///
+        std::string path;
+
+        ///
+        /// The format of raw input. WAV input uses the format in its header.
+        ///
+        AudioFormat format;
+
+        ///
+        /// The level which starts and ends a session, or negative to run one session over the whole stream.
+        ///
+        double thresholdValue;
+
+        ///
+        /// How long the level must hold.
+        ///
+        Ticks thresholdDuration;
+
+        ///
+        /// Whether to gate the hiss out of the audio before fingerprinting, as learned below the threshold.
+        ///
+        bool denoise;
+
+        ///
+        /// Whether to repair the clicks and dropouts of worn tape.
+        ///
+        bool repair;
+    };
+
+    ///
+    /// The outcome of a session.
+    ///
+    struct DeckResult
+    {
+        std::string deck;
+        uint32_t session;
+        IdentifyStatus status;
+        uint32_t attempts;
+        double startSeconds;
+        std::vector<TrackInfo> tracks;
+
+        ///
+        /// The clicks and dropouts repaired in the session.
+        ///
+        uint32_t clicks;
+        uint32_t dropouts;
+    };
+
+    ///
+    /// Called with the outcome of each session, from any thread.
+    ///
+    using DeckResultHandler = std::function<void(const DeckResult&)>;
+
+    ///
+    /// Reads one stream and runs recognition sessions on it: one over the whole stream, or one for
+    /// each stretch of audio above the threshold. On a pipe, recognition runs beside the reading, at
+    /// most one attempt at a time, so a slow lookup doesn't stall it; a file waits for each attempt. Without a fingerprinter and an
+    /// identifier, sessions are only timed. Both are shared by every deck, so must be thread safe.
+    ///
+    class Deck
+    {
+    public:
+        Deck(
+            const DeckOptions& options,
+            std::shared_ptr<Fingerprinter> fingerprinter,
+            std::shared_ptr<TrackIdentifier> identifier,
+            DeckResultHandler resultHandler);
+
+        ~Deck();
+
+        ///
+        /// Read the stream to its end. Returns false if it couldn't be opened or read.
+        ///
+        bool Run(const std::atomic<bool>& stopping);
+
+    private:
+        struct ActiveSession;
+
+        void StartSession(uint64_t position);
+
+        void EndSession();
+
+        void AddAudio(const uint8_t* data, size_t size);
+
+        void AddArtifact(const Artifact& artifact);
+
+        void Recognize(std::shared_ptr<ActiveSession> session, size_t targetSize);
+
+        void Report(ActiveSession& session);
+
+    private:
+        ///
+        /// The options.
+        ///
+        DeckOptions m_options;
+
+        ///
+        /// The fingerprinter.
+        ///
+        std::shared_ptr<Fingerprinter> m_fingerprinter;
+
+        ///
+        /// The identifier.
+        ///
+        std::shared_ptr<TrackIdentifier> m_identifier;
+
+        ///
+        /// Where outcomes go.
+        ///
+        DeckResultHandler m_resultHandler;
+
+        ///
+        /// The session in progress, if any.
+        ///
+        std::shared_ptr<ActiveSession> m_session;
+
+        ///
+        /// The recognition in flight, if any.
+        ///
+        std::future<void> m_recognition;
+
+        ///
+        /// Whether attempts run on the reading thread.
+        ///
+        bool m_synchronous;
+
+        ///
+        /// The sessions started.
+        ///
+        uint32_t m_sessionCount;
+    };
+
+    ///
+    /// Runs a deck per stream, each on its own thread.
+    ///
+    class IngestDaemon
+    {
+    public:
+        IngestDaemon(
+            std::shared_ptr<Fingerprinter> fingerprinter,
+            std::shared_ptr<TrackIdentifier> identifier,
+            DeckResultHandler resultHandler);
+
+        void AddDeck(const DeckOptions& options);
+
+        ///
+        /// Run every deck to the end of its stream. Returns the count which failed.
+        ///
+        int Run();
+
+        ///
+        /// Stop reading; sessions in progress are reported.
+        ///
+        void Stop();
+
+    private:
+        std::shared_ptr<Fingerprinter> m_fingerprinter;
+        std::shared_ptr<TrackIdentifier> m_identifier;
+        DeckResultHandler m_resultHandler;
+        std::vector<DeckOptions> m_decks;
+        std::atomic<bool> m_stopping;
+    };
+} } }
@@ -0,0 +1,222 @@
+//-----------------------------------------------------------------------
+// <copyright file="main.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "ACRCloudServices.h"
+#include "IngestDaemon.h"
+#include "Json.h"
+#include "Logger.h"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::Ingest;
+
+namespace
+{
+    const char* const Usage =
+        "Usage: 8track-ingestd [options] name=path...\n"
+        "\n"
+        "Runs identification sessions on PCM streams, one deck per name=path; a path of - is\n"
+        "standard input. WAV input uses its own format. Results are written as JSON lines.\n"
+        "\n"
+        "  --host HOST            ACRCloud host\n"
+        "  --access-key KEY       ACRCloud access key\n"
+        "  --access-secret SECRET ACRCloud access secret\n"
+        "  --extractor PATH       ACRCloud extractor library (libacrcloud_extr_tool.so)\n"
+        "  --rate HZ              raw input sample rate (44100)\n"
+        "  --channels N           raw input channels (2)\n"
+        "  --bits N               raw input bits per sample: 8, 16, 24, 32 (16)\n"
+        "  --float                raw input is 32-bit float\n"
+        "  --threshold LEVEL      start and end sessions on this level, 0 to 1 (off)\n"
+        "  --threshold-ms MS      how long the level must hold (500)\n"
+        "  --denoise              gate out the hiss heard below the threshold\n"
+        "  --repair               repair the clicks and dropouts of worn tape\n"
+        "\n"
+        "Without a host, keys and extractor, sessions are timed but not identified.\n";
+
+    IngestDaemon* g_daemon = nullptr;
+
+    void OnSignal(int)
+    {
+        if (g_daemon != nullptr)
+        {
+            g_daemon->Stop();
+        }
+    }
+
+    const char* StatusName(IdentifyStatus status)
+    {
+        switch (status)
+        {
+        case IdentifyStatus::Incomplete: return "Incomplete";
+        case IdentifyStatus::Complete: return "Complete";
+        case IdentifyStatus::Error: return "Error";
+        default: return "Invalid";
+        }
+    }
+
+    void WriteResult(const DeckResult& result)
+    {
+        static std::mutex s_outputLock;
+
+        std::string line = "{\"deck\":" + QuoteJson(result.deck);
+        line += ",\"session\":" + std::to_string(result.session);
+        line += ",\"status\":" + QuoteJson(StatusName(result.status));
+        line += ",\"attempts\":" + std::to_string(result.attempts);
+        line += ",\"clicks\":" + std::to_string(result.clicks);
+        line += ",\"dropouts\":" + std::to_string(result.dropouts);
+
+        char start[32];
+        snprintf(start, sizeof(start), "%.1f", result.startSeconds);
+        line += ",\"start_seconds\":" + std::string(start) + ",\"tracks\":[";
+        for (size_t i = 0; i < result.tracks.size(); i++)
+        {
+            const TrackInfo& track = result.tracks[i];
+            line += (i > 0) ? "," : "";
+            line += "{\"id\":" + QuoteJson(track.identifier);
+            line += ",\"title\":" + QuoteJson(track.title);
+            line += ",\"artist\":" + QuoteJson(track.artist);
+            line += ",\"album\":" + QuoteJson(track.album);
+            line += ",\"genre\":" + QuoteJson(track.genre);
+            line += ",\"score\":" + QuoteJson(track.matchConfidence);
+            line += ",\"duration_ms\":" + std::to_string(track.duration);
+            line += ",\"position_ms\":" + std::to_string(track.currentPosition) + "}";
+        }
+
+        line += "]}\n";
+
+        std::lock_guard<std::mutex> lock(s_outputLock);
+        fputs(line.c_str(), stdout);
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string host;
+    std::string accessKey;
+    std::string accessSecret;
+    std::string extractorPath;
+    DeckOptions defaults;
+    std::vector<std::pair<std::string, std::string>> decks;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument(argv[i]);
+        bool hasValue = (i + 1 < argc);
+        if (argument == "--host" && hasValue)
+        {
+            host = argv[++i];
+        }
+        else if (argument == "--access-key" && hasValue)
+        {
+            accessKey = argv[++i];
+        }
+        else if (argument == "--access-secret" && hasValue)
+        {
+            accessSecret = argv[++i];
+        }
+        else if (argument == "--extractor" && hasValue)
+        {
+            extractorPath = argv[++i];
+        }
+        else if (argument == "--rate" && hasValue)
+        {
+            defaults.format.sampleRate = static_cast<uint32_t>(atoi(argv[++i]));
+        }
+        else if (argument == "--channels" && hasValue)
+        {
+            defaults.format.channelCount = static_cast<uint16_t>(atoi(argv[++i]));
+        }
+        else if (argument == "--bits" && hasValue)
+        {
+            defaults.format.bitsPerSample = static_cast<uint16_t>(atoi(argv[++i]));
+        }
+        else if (argument == "--float")
+        {
+            defaults.format.sampleType = SampleType::Float;
+            defaults.format.bitsPerSample = 32;
+        }
+        else if (argument == "--threshold" && hasValue)
+        {
+            defaults.thresholdValue = atof(argv[++i]);
+        }
+        else if (argument == "--threshold-ms" && hasValue)
+        {
+            defaults.thresholdDuration = std::chrono::duration_cast<Ticks>(std::chrono::milliseconds(atoi(argv[++i])));
+        }
+        else if (argument == "--denoise")
+        {
+            defaults.denoise = true;
+        }
+        else if (argument == "--repair")
+        {
+            defaults.repair = true;
+        }
+        else if (argument.find('=') != std::string::npos && argument[0] != '-')
+        {
+            size_t separator = argument.find('=');
+            decks.emplace_back(argument.substr(0, separator), argument.substr(separator + 1));
+        }
+        else
+        {
+            fputs(Usage, stderr);
+            return 2;
+        }
+    }
+
+    if (decks.empty())
+    {
+        fputs(Usage, stderr);
+        return 2;
+    }
+
+    // Identification needs both the extractor and the service.
+    std::shared_ptr<ACRCloudExtractor> extractor;
+    std::shared_ptr<ACRCloudIdentifier> identifier;
+    if (!extractorPath.empty() && !host.empty() && !accessKey.empty() && !accessSecret.empty())
+    {
+        extractor = std::make_shared<ACRCloudExtractor>();
+        if (!extractor->Load(extractorPath))
+        {
+            CrazyGiraffe::Common::Logger::Instance().Flush();
+            return 1;
+        }
+
+        identifier = std::make_shared<ACRCloudIdentifier>(host, accessKey, accessSecret);
+    }
+    else
+    {
+        LOG_WARNING("No extractor or ACRCloud credentials; sessions are not identified");
+    }
+
+    IngestDaemon daemon(extractor, identifier, WriteResult);
+    for (const std::pair<std::string, std::string>& deck : decks)
+    {
+        // Options apply to every deck, wherever they are given.
+        DeckOptions options = defaults;
+        options.name = deck.first;
+        options.path = deck.second;
+        daemon.AddDeck(options);
+    }
+
+    // No SA_RESTART, so a blocked read returns and the deck ends its session.
+    g_daemon = &daemon;
+    struct sigaction action = {};
+    action.sa_handler = OnSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    int failed = daemon.Run();
+    g_daemon = nullptr;
+
+    CrazyGiraffe::Common::Logger::Instance().Flush();
+    return (failed == 0) ? 0 : 1;
+}
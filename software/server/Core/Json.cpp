@@ -0,0 +1,517 @@
+//-----------------------------------------------------------------------
+// <copyright file="Json.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "Json.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    // Deeper documents are rejected rather than overflowing the stack.
+    const int MaximumDepth = 64;
+}
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// A recursive-descent parser over the text of a document.
+    ///
+    class JsonParser
+    {
+    public:
+        explicit JsonParser(const std::string& text)
+            : m_text(text)
+            , m_position(0)
+        {
+        }
+
+        JsonValue ParseDocument()
+        {
+            JsonValue value = ParseValue(0);
+            SkipWhitespace();
+            if (m_position != m_text.size())
+            {
+                Fail("trailing characters");
+            }
+
+            return value;
+        }
+
+    private:
+        JsonValue ParseValue(int depth)
+        {
+            if (depth > MaximumDepth)
+            {
+                Fail("too deep");
+            }
+
+            SkipWhitespace();
+            JsonValue value;
+            char next = Peek();
+            if (next == '{')
+            {
+                value.m_type = JsonType::Object;
+                ParseObject(value, depth);
+            }
+            else if (next == '[')
+            {
+                value.m_type = JsonType::Array;
+                ParseArray(value, depth);
+            }
+            else if (next == '"')
+            {
+                value.m_type = JsonType::String;
+                value.m_string = ParseString();
+            }
+            else if (next == '-' || (next >= '0' && next <= '9'))
+            {
+                value.m_type = JsonType::Number;
+                value.m_number = ParseNumber();
+            }
+            else if (Consume("true"))
+            {
+                value.m_type = JsonType::Boolean;
+                value.m_boolean = true;
+            }
+            else if (Consume("false"))
+            {
+                value.m_type = JsonType::Boolean;
+                value.m_boolean = false;
+            }
+            else if (!Consume("null"))
+            {
+                Fail("unexpected character");
+            }
+
+            return value;
+        }
+
+        void ParseObject(JsonValue& value, int depth)
+        {
+            m_position++;
+            SkipWhitespace();
+            if (Peek() == '}')
+            {
+                m_position++;
+                return;
+            }
+
+            for (;;)
+            {
+                SkipWhitespace();
+                if (Peek() != '"')
+                {
+                    Fail("expected a member name");
+                }
+
+                std::string name = ParseString();
+                SkipWhitespace();
+                Expect(':');
+                value.m_object.emplace_back(std::move(name), ParseValue(depth + 1));
+
+                SkipWhitespace();
+                if (Peek() == ',')
+                {
+                    m_position++;
+                    continue;
+                }
+
+                Expect('}');
+                return;
+            }
+        }
+
+        void ParseArray(JsonValue& value, int depth)
+        {
+            m_position++;
+            SkipWhitespace();
+            if (Peek() == ']')
+            {
+                m_position++;
+                return;
+            }
+
+            for (;;)
+            {
+                value.m_array.push_back(ParseValue(depth + 1));
+                SkipWhitespace();
+                if (Peek() == ',')
+                {
+                    m_position++;
+                    continue;
+                }
+
+                Expect(']');
+                return;
+            }
+        }
+
+        std::string ParseString()
+        {
+            std::string result;
+            m_position++;
+            for (;;)
+            {
+                if (m_position >= m_text.size())
+                {
+                    Fail("unterminated string");
+                }
+
+                char next = m_text[m_position++];
+                if (next == '"')
+                {
+                    return result;
+                }
+
+                if (static_cast<unsigned char>(next) < 0x20)
+                {
+                    Fail("control character in string");
+                }
+
+                if (next != '\\')
+                {
+                    result.push_back(next);
+                    continue;
+                }
+
+                if (m_position >= m_text.size())
+                {
+                    Fail("unterminated escape");
+                }
+
+                char escape = m_text[m_position++];
+                switch (escape)
+                {
+                case '"': result.push_back('"'); break;
+                case '\\': result.push_back('\\'); break;
+                case '/': result.push_back('/'); break;
+                case 'b': result.push_back('\b'); break;
+                case 'f': result.push_back('\f'); break;
+                case 'n': result.push_back('\n'); break;
+                case 'r': result.push_back('\r'); break;
+                case 't': result.push_back('\t'); break;
+                case 'u': AppendCodePoint(result, ParseEscapedCodePoint()); break;
+                default: Fail("invalid escape");
+                }
+            }
+        }
+
+        uint32_t ParseEscapedCodePoint()
+        {
+            uint32_t codePoint = ParseHex4();
+
+            // A high surrogate must be followed by an escaped low surrogate.
+            if (codePoint >= 0xd800 && codePoint <= 0xdbff)
+            {
+                if (!Consume("\\u"))
+                {
+                    Fail("unpaired surrogate");
+                }
+
+                uint32_t low = ParseHex4();
+                if (low < 0xdc00 || low > 0xdfff)
+                {
+                    Fail("unpaired surrogate");
+                }
+
+                codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+            }
+            else if (codePoint >= 0xdc00 && codePoint <= 0xdfff)
+            {
+                Fail("unpaired surrogate");
+            }
+
+            return codePoint;
+        }
+
+        uint32_t ParseHex4()
+        {
+            if (m_position + 4 > m_text.size())
+            {
+                Fail("truncated escape");
+            }
+
+            uint32_t value = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                char digit = m_text[m_position++];
+                value <<= 4;
+                if (digit >= '0' && digit <= '9')
+                {
+                    value |= static_cast<uint32_t>(digit - '0');
+                }
+                else if (digit >= 'a' && digit <= 'f')
+                {
+                    value |= static_cast<uint32_t>(digit - 'a' + 10);
+                }
+                else if (digit >= 'A' && digit <= 'F')
+                {
+                    value |= static_cast<uint32_t>(digit - 'A' + 10);
+                }
+                else
+                {
+                    Fail("invalid escape");
+                }
+            }
+
+            return value;
+        }
+
+        static void AppendCodePoint(std::string& output, uint32_t codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                output.push_back(static_cast<char>(codePoint));
+            }
+            else if (codePoint < 0x800)
+            {
+                output.push_back(static_cast<char>(0xc0 | (codePoint >> 6)));
+                output.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+            }
+            else if (codePoint < 0x10000)
+            {
+                output.push_back(static_cast<char>(0xe0 | (codePoint >> 12)));
+                output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+                output.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+            }
+            else
+            {
+                output.push_back(static_cast<char>(0xf0 | (codePoint >> 18)));
+                output.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f)));
+                output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+                output.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+            }
+        }
+
+        double ParseNumber()
+        {
+            // Check the grammar, then let strtod convert; it accepts more than JSON does.
+            size_t start = m_position;
+            if (Peek() == '-')
+            {
+                m_position++;
+            }
+
+            if (!SkipDigits())
+            {
+                Fail("invalid number");
+            }
+
+            if (Peek() == '.')
+            {
+                m_position++;
+                if (!SkipDigits())
+                {
+                    Fail("invalid number");
+                }
+            }
+
+            if (Peek() == 'e' || Peek() == 'E')
+            {
+                m_position++;
+                if (Peek() == '+' || Peek() == '-')
+                {
+                    m_position++;
+                }
+
+                if (!SkipDigits())
+                {
+                    Fail("invalid number");
+                }
+            }
+
+            std::string number = m_text.substr(start, m_position - start);
+            return strtod(number.c_str(), nullptr);
+        }
+
+        bool SkipDigits()
+        {
+            size_t start = m_position;
+            while (m_position < m_text.size() && m_text[m_position] >= '0' && m_text[m_position] <= '9')
+            {
+                m_position++;
+            }
+
+            return m_position > start;
+        }
+
+        void SkipWhitespace()
+        {
+            while (m_position < m_text.size())
+            {
+                char next = m_text[m_position];
+                if (next != ' ' && next != '\t' && next != '\n' && next != '\r')
+                {
+                    break;
+                }
+
+                m_position++;
+            }
+        }
+
+        char Peek() const
+        {
+            return (m_position < m_text.size()) ? m_text[m_position] : '\0';
+        }
+
+        bool Consume(const char* literal)
+        {
+            size_t length = 0;
+            for (; literal[length] != '\0'; length++)
+            {
+                if (m_position + length >= m_text.size() || m_text[m_position + length] != literal[length])
+                {
+                    return false;
+                }
+            }
+
+            m_position += length;
+            return true;
+        }
+
+        void Expect(char expected)
+        {
+            if (Peek() != expected)
+            {
+                Fail(std::string("expected '") + expected + "'");
+            }
+
+            m_position++;
+        }
+
+        [[noreturn]] void Fail(const std::string& reason) const
+        {
+            throw JsonError("JSON: " + reason + " at offset " + std::to_string(m_position));
+        }
+
+    private:
+        const std::string& m_text;
+        size_t m_position;
+    };
+} }
+
+JsonValue::JsonValue()
+    : m_type(JsonType::Null)
+    , m_boolean(false)
+    , m_number(0)
+    , m_string()
+    , m_array()
+    , m_object()
+{
+}
+
+JsonValue JsonValue::Parse(const std::string& text)
+{
+    JsonParser parser(text);
+    return parser.ParseDocument();
+}
+
+JsonType JsonValue::Type() const
+{
+    return m_type;
+}
+
+bool JsonValue::IsNull() const
+{
+    return m_type == JsonType::Null;
+}
+
+bool JsonValue::AsBoolean() const
+{
+    if (m_type != JsonType::Boolean)
+    {
+        throw JsonError("JSON: not a boolean");
+    }
+
+    return m_boolean;
+}
+
+double JsonValue::AsNumber() const
+{
+    if (m_type != JsonType::Number)
+    {
+        throw JsonError("JSON: not a number");
+    }
+
+    return m_number;
+}
+
+const std::string& JsonValue::AsString() const
+{
+    if (m_type != JsonType::String)
+    {
+        throw JsonError("JSON: not a string");
+    }
+
+    return m_string;
+}
+
+const std::vector<JsonValue>& JsonValue::AsArray() const
+{
+    if (m_type != JsonType::Array)
+    {
+        throw JsonError("JSON: not an array");
+    }
+
+    return m_array;
+}
+
+const JsonValue* JsonValue::Find(const std::string& name) const
+{
+    for (const std::pair<std::string, JsonValue>& member : m_object)
+    {
+        if (member.first == name)
+        {
+            return &member.second;
+        }
+    }
+
+    return nullptr;
+}
+
+const JsonValue& JsonValue::operator[](const std::string& name) const
+{
+    const JsonValue* value = Find(name);
+    if (value == nullptr)
+    {
+        throw JsonError("JSON: no member '" + name + "'");
+    }
+
+    return *value;
+}
+
+std::string CrazyGiraffe::Core::QuoteJson(const std::string& text)
+{
+    std::string quoted("\"");
+    for (char next : text)
+    {
+        switch (next)
+        {
+        case '"': quoted.append("\\\""); break;
+        case '\\': quoted.append("\\\\"); break;
+        case '\n': quoted.append("\\n"); break;
+        case '\r': quoted.append("\\r"); break;
+        case '\t': quoted.append("\\t"); break;
+        default:
+            if (static_cast<unsigned char>(next) < 0x20)
+            {
+                char escape[8];
+                snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(next)));
+                quoted.append(escape);
+            }
+            else
+            {
+                quoted.push_back(next);
+            }
+        }
+    }
+
+    quoted.push_back('"');
+    return quoted;
+}
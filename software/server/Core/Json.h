@@ -0,0 +1,99 @@
+//-----------------------------------------------------------------------
+// <copyright file="Json.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// Thrown when JSON is malformed, or a value isn't of the type asked for.
+    ///
+    class JsonError : public std::runtime_error
+    {
+    public:
+        explicit JsonError(const std::string& message)
+            : std::runtime_error(message)
+        {
+        }
+    };
+
+    ///
+    /// The kind of a JSON value.
+    ///
+    enum class JsonType
+    {
+        Null,
+        Boolean,
+        Number,
+        String,
+        Array,
+        Object,
+    };
+
+    ///
+    /// A parsed JSON value, enough for the responses of the identification services.
+    /// Strings are UTF-8; objects keep their members in order.
+    ///
+    class JsonValue
+    {
+    public:
+        JsonValue();
+
+        ///
+        /// Parse a document. Throws JsonError if it is malformed.
+        ///
+        static JsonValue Parse(const std::string& text);
+
+        JsonType Type() const;
+
+        bool IsNull() const;
+
+        ///
+        /// Get the value. Throws JsonError if it is of another type.
+        ///
+        bool AsBoolean() const;
+
+        double AsNumber() const;
+
+        const std::string& AsString() const;
+
+        ///
+        /// Get the elements of an array. Throws JsonError if it isn't one.
+        ///
+        const std::vector<JsonValue>& AsArray() const;
+
+        ///
+        /// Get a member of an object, or nullptr if there is none or it isn't an object.
+        ///
+        const JsonValue* Find(const std::string& name) const;
+
+        ///
+        /// Get a member of an object. Throws JsonError if there is none.
+        ///
+        const JsonValue& operator[](const std::string& name) const;
+
+    private:
+        friend class JsonParser;
+
+        JsonType m_type;
+        bool m_boolean;
+        double m_number;
+        std::string m_string;
+        std::vector<JsonValue> m_array;
+        std::vector<std::pair<std::string, JsonValue>> m_object;
+    };
+
+    ///
+    /// Quote and escape UTF-8 text as a JSON string.
+    ///
+    std::string QuoteJson(const std::string& text);
+} }
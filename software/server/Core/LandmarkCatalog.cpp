@@ -0,0 +1,399 @@
+//-----------------------------------------------------------------------
+// <copyright file="LandmarkCatalog.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "LandmarkCatalog.h"
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    const char CatalogMagic[4] = { '8', 'T', 'L', 'M' };
+    const uint32_t CatalogVersion = 2;
+
+    // The magic, the version, and the counts of tracks, hashes, postings and posting bytes.
+    const size_t HeaderSize = 24;
+
+    // A hash and the offset of its postings.
+    const size_t DirectoryEntrySize = 8;
+
+    // Strings longer than this are not from a catalog.
+    const uint32_t MaximumStringSize = 1 << 16;
+
+    // Values are written little-endian, whatever the machine.
+    void WriteUInt32(std::vector<uint8_t>& output, uint32_t value)
+    {
+        output.push_back(static_cast<uint8_t>(value));
+        output.push_back(static_cast<uint8_t>(value >> 8));
+        output.push_back(static_cast<uint8_t>(value >> 16));
+        output.push_back(static_cast<uint8_t>(value >> 24));
+    }
+
+    void WriteString(std::vector<uint8_t>& output, const std::string& value)
+    {
+        WriteUInt32(output, static_cast<uint32_t>(value.size()));
+        output.insert(output.end(), value.begin(), value.end());
+    }
+
+    // Seven bits a byte, low first, with the top bit set on all but the last.
+    void WriteVarint(std::vector<uint8_t>& output, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            output.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+
+        output.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint32_t ReadUInt32(const uint8_t* input)
+    {
+        return static_cast<uint32_t>(input[0])
+            | (static_cast<uint32_t>(input[1]) << 8)
+            | (static_cast<uint32_t>(input[2]) << 16)
+            | (static_cast<uint32_t>(input[3]) << 24);
+    }
+
+    // Reads from a cursor, throwing if the catalog ends first.
+    class CatalogReader
+    {
+    public:
+        CatalogReader(const uint8_t* begin, const uint8_t* end)
+            : m_position(begin)
+            , m_end(end)
+        {
+        }
+
+        const uint8_t* Position() const
+        {
+            return m_position;
+        }
+
+        bool AtEnd() const
+        {
+            return m_position == m_end;
+        }
+
+        uint32_t UInt32()
+        {
+            const uint8_t* bytes = Take(4);
+            return ReadUInt32(bytes);
+        }
+
+        std::string String()
+        {
+            uint32_t size = UInt32();
+            if (size > MaximumStringSize)
+            {
+                throw std::runtime_error("catalog string is too long");
+            }
+
+            const uint8_t* bytes = Take(size);
+            return std::string(reinterpret_cast<const char*>(bytes), size);
+        }
+
+        uint32_t Varint()
+        {
+            uint32_t value = 0;
+            for (int shift = 0; shift < 35; shift += 7)
+            {
+                uint8_t byte = *Take(1);
+                value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return value;
+                }
+            }
+
+            throw std::runtime_error("catalog posting is corrupt");
+        }
+
+        const uint8_t* Take(size_t size)
+        {
+            if (static_cast<size_t>(m_end - m_position) < size)
+            {
+                throw std::runtime_error("catalog is truncated");
+            }
+
+            const uint8_t* bytes = m_position;
+            m_position += size;
+            return bytes;
+        }
+
+    private:
+        const uint8_t* m_position;
+        const uint8_t* m_end;
+    };
+}
+
+LandmarkCatalog::LandmarkCatalog(const std::string& path)
+    : m_file(new MappedFile(path))
+    , m_bytes()
+    , m_data(nullptr)
+    , m_size(0)
+    , m_tracks()
+    , m_directory(nullptr)
+    , m_hashCount(0)
+    , m_postings(nullptr)
+    , m_postingsSize(0)
+    , m_postingCount(0)
+{
+    m_data = m_file->Data();
+    m_size = m_file->Size();
+    Open();
+}
+
+LandmarkCatalog::LandmarkCatalog(std::vector<uint8_t> bytes)
+    : m_file()
+    , m_bytes(std::move(bytes))
+    , m_data(nullptr)
+    , m_size(0)
+    , m_tracks()
+    , m_directory(nullptr)
+    , m_hashCount(0)
+    , m_postings(nullptr)
+    , m_postingsSize(0)
+    , m_postingCount(0)
+{
+    m_data = m_bytes.data();
+    m_size = m_bytes.size();
+    Open();
+}
+
+size_t LandmarkCatalog::TrackCount() const
+{
+    return m_tracks.size();
+}
+
+const TrackInfo& LandmarkCatalog::Track(size_t index) const
+{
+    return m_tracks.at(index);
+}
+
+size_t LandmarkCatalog::HashCount() const
+{
+    return m_hashCount;
+}
+
+size_t LandmarkCatalog::PostingCount() const
+{
+    return m_postingCount;
+}
+
+bool LandmarkCatalog::Match(const std::vector<Landmark>& query, uint32_t minimumScore, LandmarkMatch& match) const
+{
+    OffsetVotes votes;
+    for (const Landmark& landmark : query)
+    {
+        const uint8_t* begin = nullptr;
+        const uint8_t* end = nullptr;
+        if (!FindPostings(landmark.hash, begin, end))
+        {
+            continue;
+        }
+
+        // Each track is a step from the one before; each time a step from the one before in the
+        // same track, or from zero in a new one.
+        CatalogReader reader(begin, end);
+        uint32_t track = 0;
+        uint32_t time = 0;
+        while (!reader.AtEnd())
+        {
+            uint32_t trackStep = reader.Varint();
+            uint32_t timeStep = reader.Varint();
+            track += trackStep;
+            time = (trackStep == 0) ? (time + timeStep) : timeStep;
+            if (track >= m_tracks.size())
+            {
+                throw std::runtime_error("catalog posting has no track");
+            }
+
+            votes.Add(track, time, landmark.time);
+        }
+    }
+
+    return votes.Best(minimumScore, match);
+}
+
+bool LandmarkCatalog::Identify(const std::vector<Landmark>& query, uint32_t minimumScore, TrackInfo& track) const
+{
+    LandmarkMatch match = {};
+    if (!Match(query, minimumScore, match))
+    {
+        return false;
+    }
+
+    track = MatchedTrack(match);
+    return true;
+}
+
+TrackInfo LandmarkCatalog::MatchedTrack(const LandmarkMatch& match) const
+{
+    // A query from before the track starts is matched from its start.
+    double position = std::max(match.offset, 0) * LandmarkFingerprinter::FrameSeconds() * 1000;
+    TrackInfo track = m_tracks[match.track];
+    track.matchPosition = static_cast<int32_t>(position + 0.5);
+    track.matchConfidence = std::to_string(match.score);
+    return track;
+}
+
+/* static */
+void LandmarkCatalog::Write(const LandmarkIndex& index, std::ostream& stream)
+{
+    // By hash, then by track and time, so the same catalog always writes the same bytes.
+    std::vector<uint32_t> hashes;
+    hashes.reserve(index.m_postings.size());
+    for (const auto& postings : index.m_postings)
+    {
+        hashes.push_back(postings.first);
+    }
+
+    std::sort(hashes.begin(), hashes.end());
+
+    std::vector<uint8_t> directory;
+    std::vector<uint8_t> postings;
+    directory.reserve(hashes.size() * DirectoryEntrySize + 4);
+    for (uint32_t hash : hashes)
+    {
+        std::vector<LandmarkIndex::Posting> sorted = index.m_postings.at(hash);
+        std::sort(sorted.begin(), sorted.end(), [](const LandmarkIndex::Posting& left, const LandmarkIndex::Posting& right)
+            {
+                return (left.track != right.track) ? (left.track < right.track) : (left.time < right.time);
+            });
+
+        WriteUInt32(directory, hash);
+        WriteUInt32(directory, static_cast<uint32_t>(postings.size()));
+
+        uint32_t track = 0;
+        uint32_t time = 0;
+        for (const LandmarkIndex::Posting& posting : sorted)
+        {
+            WriteVarint(postings, posting.track - track);
+            WriteVarint(postings, (posting.track == track) ? (posting.time - time) : posting.time);
+            track = posting.track;
+            time = posting.time;
+        }
+    }
+
+    WriteUInt32(directory, static_cast<uint32_t>(postings.size()));
+
+    std::vector<uint8_t> header(CatalogMagic, CatalogMagic + sizeof(CatalogMagic));
+    WriteUInt32(header, CatalogVersion);
+    WriteUInt32(header, static_cast<uint32_t>(index.m_tracks.size()));
+    WriteUInt32(header, static_cast<uint32_t>(hashes.size()));
+    WriteUInt32(header, static_cast<uint32_t>(index.m_postingCount));
+    WriteUInt32(header, static_cast<uint32_t>(postings.size()));
+    for (const TrackInfo& track : index.m_tracks)
+    {
+        WriteString(header, track.identifier);
+        WriteString(header, track.title);
+        WriteString(header, track.artist);
+        WriteString(header, track.album);
+        WriteString(header, track.genre);
+        WriteString(header, track.coverArtUrl);
+        WriteUInt32(header, static_cast<uint32_t>(track.duration));
+    }
+
+    stream.write(reinterpret_cast<const char*>(header.data()), header.size());
+    stream.write(reinterpret_cast<const char*>(directory.data()), directory.size());
+    stream.write(reinterpret_cast<const char*>(postings.data()), postings.size());
+    if (!stream)
+    {
+        throw std::runtime_error("catalog could not be written");
+    }
+}
+
+void LandmarkCatalog::Open()
+{
+    CatalogReader reader(m_data, m_data + m_size);
+    if (m_size < HeaderSize || memcmp(reader.Take(sizeof(CatalogMagic)), CatalogMagic, sizeof(CatalogMagic)) != 0)
+    {
+        throw std::runtime_error("not a landmark catalog");
+    }
+
+    if (reader.UInt32() != CatalogVersion)
+    {
+        throw std::runtime_error("unsupported catalog version");
+    }
+
+    uint32_t trackCount = reader.UInt32();
+    m_hashCount = reader.UInt32();
+    m_postingCount = reader.UInt32();
+    m_postingsSize = reader.UInt32();
+
+    // Each track is at least its string sizes and duration.
+    if (trackCount > m_size / 28)
+    {
+        throw std::runtime_error("catalog is truncated");
+    }
+
+    m_tracks.reserve(trackCount);
+    for (uint32_t index = 0; index < trackCount; index++)
+    {
+        TrackInfo track;
+        track.identifier = reader.String();
+        track.title = reader.String();
+        track.artist = reader.String();
+        track.album = reader.String();
+        track.genre = reader.String();
+        track.coverArtUrl = reader.String();
+        track.duration = static_cast<int32_t>(reader.UInt32());
+        m_tracks.push_back(track);
+    }
+
+    // The rest is exactly the directory and the postings.
+    size_t rest = static_cast<size_t>(m_data + m_size - reader.Position());
+    if (m_hashCount > rest / DirectoryEntrySize || rest != m_hashCount * DirectoryEntrySize + 4 + m_postingsSize)
+    {
+        throw std::runtime_error("catalog is truncated");
+    }
+
+    m_directory = reader.Take(m_hashCount * DirectoryEntrySize + 4);
+    m_postings = reader.Take(m_postingsSize);
+}
+
+bool LandmarkCatalog::FindPostings(uint32_t hash, const uint8_t*& begin, const uint8_t*& end) const
+{
+    // A binary search of the directory, in place.
+    size_t low = 0;
+    size_t high = m_hashCount;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (ReadUInt32(m_directory + middle * DirectoryEntrySize) < hash)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    const uint8_t* entry = m_directory + low * DirectoryEntrySize;
+    if (low == m_hashCount || ReadUInt32(entry) != hash)
+    {
+        return false;
+    }
+
+    // The next entry's offset, or the end of the postings after the last, ends these.
+    uint32_t first = ReadUInt32(entry + 4);
+    uint32_t last = (low + 1 < m_hashCount)
+        ? ReadUInt32(entry + DirectoryEntrySize + 4)
+        : ReadUInt32(m_directory + m_hashCount * DirectoryEntrySize);
+    if (first > last || last > m_postingsSize)
+    {
+        throw std::runtime_error("catalog directory is corrupt");
+    }
+
+    begin = m_postings + first;
+    end = m_postings + last;
+    return true;
+}
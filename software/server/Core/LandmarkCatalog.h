@@ -0,0 +1,113 @@
+//-----------------------------------------------------------------------
+// <copyright file="LandmarkCatalog.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "LandmarkIndex.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// A saved LandmarkIndex, searched in place. The file is a directory of the hashes, sorted, each
+    /// with where its postings start; and the postings of each hash, sorted by track and time and
+    /// delta-encoded as variable-length integers. Only the tracks are read when it opens, so a catalog
+    /// of thousands of tracks opens at once and a query reads just the pages of the hashes it has.
+    ///
+    class LandmarkCatalog
+    {
+    public:
+        ///
+        /// Map a catalog file. Throws std::runtime_error if it can't be read or is not a catalog.
+        ///
+        explicit LandmarkCatalog(const std::string& path);
+
+        ///
+        /// Search a catalog in memory. Throws std::runtime_error if it is not one.
+        ///
+        explicit LandmarkCatalog(std::vector<uint8_t> bytes);
+
+        size_t TrackCount() const;
+
+        const TrackInfo& Track(size_t index) const;
+
+        ///
+        /// Get the distinct hashes, and the postings across all of them.
+        ///
+        size_t HashCount() const;
+        size_t PostingCount() const;
+
+        ///
+        /// Find the best match of landmarks. Returns false if none scores the minimum. Throws
+        /// std::runtime_error if the postings it reads are corrupt.
+        ///
+        bool Match(const std::vector<Landmark>& query, uint32_t minimumScore, LandmarkMatch& match) const;
+
+        ///
+        /// Find the track landmarks are from, with where in the track they start, in milliseconds, as
+        /// its match position and the landmarks which agree as its match confidence.
+        ///
+        bool Identify(const std::vector<Landmark>& query, uint32_t minimumScore, TrackInfo& track) const;
+
+        ///
+        /// Get the track of a match, with its match position and confidence as Identify gives them.
+        ///
+        TrackInfo MatchedTrack(const LandmarkMatch& match) const;
+
+        ///
+        /// Write an index as a catalog.
+        ///
+        static void Write(const LandmarkIndex& index, std::ostream& stream);
+
+    private:
+        LandmarkCatalog(const LandmarkCatalog&) = delete;
+        LandmarkCatalog& operator=(const LandmarkCatalog&) = delete;
+
+        ///
+        /// Read the header and the tracks, and find the directory and the postings.
+        ///
+        void Open();
+
+        ///
+        /// Find the postings of a hash. Returns false if it isn't in the catalog.
+        ///
+        bool FindPostings(uint32_t hash, const uint8_t*& begin, const uint8_t*& end) const;
+
+    private:
+        ///
+        /// The catalog, in a mapped file or in memory.
+        ///
+        std::unique_ptr<MappedFile> m_file;
+        std::vector<uint8_t> m_bytes;
+        const uint8_t* m_data;
+        size_t m_size;
+
+        ///
+        /// The tracks.
+        ///
+        std::vector<TrackInfo> m_tracks;
+
+        ///
+        /// The directory: a hash and the offset of its postings, for each hash, then the end of the
+        /// postings.
+        ///
+        const uint8_t* m_directory;
+        size_t m_hashCount;
+
+        ///
+        /// The postings of all the hashes.
+        ///
+        const uint8_t* m_postings;
+        size_t m_postingsSize;
+        size_t m_postingCount;
+    };
+} }
@@ -0,0 +1,300 @@
+//-----------------------------------------------------------------------
+// <copyright file="LandmarkFingerprinter.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "LandmarkFingerprinter.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    const double Pi = 3.14159265358979323846;
+
+    // The bins which can hold peaks: 250Hz, above turntable rumble, to just under 4kHz.
+    const uint32_t MinimumBin = 32;
+    const uint32_t MaximumBin = LandmarkFingerprinter::FrameSize / 2 - 1;
+
+    // A peak is the loudest point within this many frames and bins either side.
+    const uint32_t PeakFrames = 3;
+    const uint32_t PeakBins = 8;
+
+    // A peak stands this far (log10 power) above the mean of its frame, and above silence.
+    const float PeakAboveMean = 1.0f;
+    const float PeakFloor = -2.0f;
+
+    // The loudest peaks kept per frame.
+    const size_t PeaksPerFrame = 5;
+
+    // An anchor pairs with the first peaks in this zone after it.
+    const uint32_t MinimumPairFrames = 1;
+    const uint32_t MaximumPairFrames = 63;
+    const int32_t MaximumPairBins = 127;
+    const size_t PairsPerAnchor = 5;
+
+    // The anchor bin (9 bits), the bin difference (8 bits) and the frame difference (6 bits).
+    uint32_t HashPair(uint32_t anchorBin, uint32_t targetBin, uint32_t frames)
+    {
+        int32_t bins = static_cast<int32_t>(targetBin) - static_cast<int32_t>(anchorBin);
+        return (anchorBin << 14) | (static_cast<uint32_t>(bins + 128) << 6) | frames;
+    }
+}
+
+LandmarkFingerprinter::LandmarkFingerprinter(uint32_t sampleRate, uint16_t channelCount)
+    : m_sampleRate(sampleRate)
+    , m_channelCount(channelCount)
+    , m_sum(0)
+    , m_phase(0)
+    , m_frameSum(0)
+    , m_frameChannel(0)
+    , m_samples()
+    , m_window(FrameSize)
+    , m_fft(FrameSize)
+    , m_frame(FrameSize)
+    , m_power(FrameSize / 2 + 1)
+    , m_spectra()
+    , m_nextPick(0)
+    , m_peaks()
+    , m_frameCount(0)
+    , m_landmarks()
+{
+    if (sampleRate < AnalysisRate)
+    {
+        throw std::invalid_argument("sampleRate");
+    }
+
+    if (channelCount == 0)
+    {
+        throw std::invalid_argument("channelCount");
+    }
+
+    // A periodic Hann window.
+    for (uint32_t index = 0; index < FrameSize; index++)
+    {
+        m_window[index] = static_cast<float>(0.5 - 0.5 * std::cos(2 * Pi * index / FrameSize));
+    }
+
+    m_samples.reserve(FrameSize);
+}
+
+void LandmarkFingerprinter::AddSamples(const float* samples, size_t count)
+{
+    for (size_t index = 0; index < count; index++)
+    {
+        m_frameSum += samples[index];
+        if (++m_frameChannel < m_channelCount)
+        {
+            continue;
+        }
+
+        // Mix down, then average the input over each sample of the analysis rate. Each input sample
+        // spans AnalysisRate units and each output m_sampleRate, so a sample on the boundary of two
+        // outputs is shared between them; whole samples alone would jitter and add spurs.
+        float sample = m_frameSum / m_channelCount;
+        m_frameSum = 0;
+        m_frameChannel = 0;
+
+        uint32_t remaining = AnalysisRate;
+        while (m_phase + remaining >= m_sampleRate)
+        {
+            uint32_t taken = m_sampleRate - m_phase;
+            m_sum += sample * static_cast<float>(taken);
+            AddAnalysisSample(m_sum / static_cast<float>(m_sampleRate));
+            m_sum = 0;
+            m_phase = 0;
+            remaining -= taken;
+        }
+
+        m_sum += sample * static_cast<float>(remaining);
+        m_phase += remaining;
+    }
+}
+
+void LandmarkFingerprinter::Flush()
+{
+    // The last frames have fewer neighbours.
+    while (m_nextPick < m_spectra.size())
+    {
+        PickPeaks(m_nextPick++);
+    }
+
+    PairAnchors(UINT32_MAX);
+
+    m_spectra.clear();
+    m_nextPick = 0;
+    m_samples.clear();
+}
+
+const std::vector<Landmark>& LandmarkFingerprinter::Landmarks() const
+{
+    return m_landmarks;
+}
+
+uint32_t LandmarkFingerprinter::FrameCount() const
+{
+    return m_frameCount;
+}
+
+/* static */
+double LandmarkFingerprinter::FrameSeconds()
+{
+    return static_cast<double>(HopSize) / AnalysisRate;
+}
+
+/* static */
+std::vector<Landmark> LandmarkFingerprinter::Fingerprint(const float* samples, size_t count, uint32_t sampleRate, uint16_t channelCount)
+{
+    LandmarkFingerprinter fingerprinter(sampleRate, channelCount);
+    fingerprinter.AddSamples(samples, count);
+    fingerprinter.Flush();
+    return fingerprinter.m_landmarks;
+}
+
+void LandmarkFingerprinter::AddAnalysisSample(float sample)
+{
+    m_samples.push_back(sample);
+    if (m_samples.size() == FrameSize)
+    {
+        AnalyseFrame();
+        m_samples.erase(m_samples.begin(), m_samples.begin() + HopSize);
+    }
+}
+
+void LandmarkFingerprinter::AnalyseFrame()
+{
+    for (uint32_t index = 0; index < FrameSize; index++)
+    {
+        m_frame[index] = m_samples[index] * m_window[index];
+    }
+
+    m_fft.PowerSpectrum(m_frame.data(), m_power.data());
+
+    Spectrum spectrum;
+    spectrum.time = m_frameCount++;
+    spectrum.level.resize(m_power.size());
+    for (size_t bin = 0; bin < m_power.size(); bin++)
+    {
+        spectrum.level[bin] = std::log10(m_power[bin] + 1e-10f);
+    }
+
+    m_spectra.push_back(std::move(spectrum));
+
+    // A spectrum's peaks are picked once the spectra after it are in.
+    while (m_nextPick < m_spectra.size() && m_spectra.size() - 1 - m_nextPick >= PeakFrames)
+    {
+        PickPeaks(m_nextPick++);
+    }
+
+    // Keep the spectra before the next to pick, as its neighbours.
+    while (m_nextPick > PeakFrames)
+    {
+        m_spectra.pop_front();
+        m_nextPick--;
+    }
+}
+
+void LandmarkFingerprinter::PickPeaks(size_t index)
+{
+    const Spectrum& spectrum = m_spectra[index];
+
+    float mean = 0;
+    for (uint32_t bin = MinimumBin; bin <= MaximumBin; bin++)
+    {
+        mean += spectrum.level[bin];
+    }
+
+    mean /= static_cast<float>(MaximumBin - MinimumBin + 1);
+
+    size_t firstFrame = (index > PeakFrames) ? (index - PeakFrames) : 0;
+    size_t lastFrame = (index + PeakFrames < m_spectra.size()) ? (index + PeakFrames) : (m_spectra.size() - 1);
+
+    std::vector<std::pair<float, uint32_t>> candidates;
+    for (uint32_t bin = MinimumBin; bin <= MaximumBin; bin++)
+    {
+        float level = spectrum.level[bin];
+        if (level < PeakFloor || level < mean + PeakAboveMean)
+        {
+            continue;
+        }
+
+        // A tie goes to the earlier point, so flat tops give one peak.
+        uint32_t firstBin = (bin > MinimumBin + PeakBins) ? (bin - PeakBins) : MinimumBin;
+        uint32_t lastBin = (bin + PeakBins < MaximumBin) ? (bin + PeakBins) : MaximumBin;
+        bool isPeak = true;
+        for (size_t frame = firstFrame; frame <= lastFrame && isPeak; frame++)
+        {
+            const std::vector<float>& neighbour = m_spectra[frame].level;
+            for (uint32_t other = firstBin; other <= lastBin; other++)
+            {
+                bool isEarlier = (frame < index) || (frame == index && other < bin);
+                if ((frame != index || other != bin) && (isEarlier ? neighbour[other] >= level : neighbour[other] > level))
+                {
+                    isPeak = false;
+                    break;
+                }
+            }
+        }
+
+        if (isPeak)
+        {
+            candidates.emplace_back(level, bin);
+        }
+    }
+
+    // The loudest, then the lowest, for the same choice every time.
+    std::sort(candidates.begin(), candidates.end(), [](const std::pair<float, uint32_t>& left, const std::pair<float, uint32_t>& right)
+        {
+            return (left.first != right.first) ? (left.first > right.first) : (left.second < right.second);
+        });
+
+    if (candidates.size() > PeaksPerFrame)
+    {
+        candidates.resize(PeaksPerFrame);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const std::pair<float, uint32_t>& left, const std::pair<float, uint32_t>& right)
+        {
+            return left.second < right.second;
+        });
+
+    for (const std::pair<float, uint32_t>& candidate : candidates)
+    {
+        m_peaks.push_back({ spectrum.time, candidate.second });
+    }
+
+    if (spectrum.time >= MaximumPairFrames)
+    {
+        PairAnchors(spectrum.time - MaximumPairFrames);
+    }
+}
+
+void LandmarkFingerprinter::PairAnchors(uint32_t lastAnchorTime)
+{
+    while (!m_peaks.empty() && m_peaks.front().time <= lastAnchorTime)
+    {
+        const Peak anchor = m_peaks.front();
+        m_peaks.pop_front();
+
+        size_t pairs = 0;
+        for (size_t index = 0; index < m_peaks.size() && pairs < PairsPerAnchor; index++)
+        {
+            const Peak& target = m_peaks[index];
+            uint32_t frames = target.time - anchor.time;
+            if (frames > MaximumPairFrames)
+            {
+                break;
+            }
+
+            int32_t bins = static_cast<int32_t>(target.bin) - static_cast<int32_t>(anchor.bin);
+            if (frames >= MinimumPairFrames && bins >= -MaximumPairBins && bins <= MaximumPairBins)
+            {
+                m_landmarks.push_back({ HashPair(anchor.bin, target.bin, frames), anchor.time });
+                pairs++;
+            }
+        }
+    }
+}
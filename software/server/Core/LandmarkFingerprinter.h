@@ -0,0 +1,170 @@
+//-----------------------------------------------------------------------
+// <copyright file="LandmarkFingerprinter.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "Fft.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// A pair of spectral peaks: the hash of their frequencies and spacing, and the frame of the first.
+    ///
+    struct Landmark
+    {
+        uint32_t hash;
+        uint32_t time;
+    };
+
+    ///
+    /// Computes landmark hashes from streamed audio, in the manner of Wang's constellation maps:
+    /// the audio is mixed down to 8kHz mono, the peaks of its spectrogram are picked, and each peak is
+    /// paired with the next few peaks after it. The hashes don't depend on the input rate or level, and
+    /// the same audio always gives the same landmarks.
+    ///
+    class LandmarkFingerprinter
+    {
+    public:
+        ///
+        /// The rate the audio is analysed at.
+        ///
+        static const uint32_t AnalysisRate = 8000;
+
+        ///
+        /// The samples per spectrum, and the samples between spectra.
+        ///
+        static const uint32_t FrameSize = 1024;
+        static const uint32_t HopSize = 256;
+
+        LandmarkFingerprinter(uint32_t sampleRate, uint16_t channelCount);
+
+        ///
+        /// Add interleaved samples, -1 to 1.
+        ///
+        void AddSamples(const float* samples, size_t count);
+
+        ///
+        /// Pick the peaks and pair the landmarks which were waiting on later audio. Audio added after
+        /// this starts a new stretch, as if after a gap.
+        ///
+        void Flush();
+
+        ///
+        /// Get the landmarks so far, in the order of their time.
+        ///
+        const std::vector<Landmark>& Landmarks() const;
+
+        ///
+        /// Get the spectra computed so far.
+        ///
+        uint32_t FrameCount() const;
+
+        ///
+        /// Get the seconds between frames.
+        ///
+        static double FrameSeconds();
+
+        ///
+        /// Get the landmarks of a whole stream.
+        ///
+        static std::vector<Landmark> Fingerprint(const float* samples, size_t count, uint32_t sampleRate, uint16_t channelCount);
+
+    private:
+        ///
+        /// A peak of the spectrogram.
+        ///
+        struct Peak
+        {
+            uint32_t time;
+            uint32_t bin;
+        };
+
+        ///
+        /// The spectrum of a frame, as log power, with the frame it is.
+        ///
+        struct Spectrum
+        {
+            uint32_t time;
+            std::vector<float> level;
+        };
+
+        void AddAnalysisSample(float sample);
+
+        void AnalyseFrame();
+
+        ///
+        /// Pick the peaks of the spectrum at an index of m_spectra, from its neighbours.
+        ///
+        void PickPeaks(size_t index);
+
+        ///
+        /// Pair the anchors up to a frame with the peaks after them.
+        ///
+        void PairAnchors(uint32_t lastAnchorTime);
+
+    private:
+        ///
+        /// The input format.
+        ///
+        uint32_t m_sampleRate;
+        uint16_t m_channelCount;
+
+        ///
+        /// The mixdown to the analysis rate: the weighted sum of the input since the last output, and
+        /// how much of the output it covers, in units where an output is m_sampleRate.
+        ///
+        float m_sum;
+        uint32_t m_phase;
+
+        ///
+        /// The channels of the frame being mixed down.
+        ///
+        float m_frameSum;
+        uint16_t m_frameChannel;
+
+        ///
+        /// The audio at the analysis rate not yet analysed.
+        ///
+        std::vector<float> m_samples;
+
+        ///
+        /// The window, the transform and its scratch.
+        ///
+        std::vector<float> m_window;
+        Fft m_fft;
+        std::vector<float> m_frame;
+        std::vector<float> m_power;
+
+        ///
+        /// The spectra whose peaks, or whose neighbours' peaks, are still to be picked.
+        ///
+        std::deque<Spectrum> m_spectra;
+
+        ///
+        /// The index in m_spectra of the next spectrum to pick peaks in.
+        ///
+        size_t m_nextPick;
+
+        ///
+        /// The peaks not yet paired with everything after them.
+        ///
+        std::deque<Peak> m_peaks;
+
+        ///
+        /// The frames analysed.
+        ///
+        uint32_t m_frameCount;
+
+        ///
+        /// The landmarks.
+        ///
+        std::vector<Landmark> m_landmarks;
+    };
+} }
@@ -0,0 +1,103 @@
+//-----------------------------------------------------------------------
+// <copyright file="LandmarkIndex.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "LandmarkIndex.h"
+#include "LandmarkCatalog.h"
+
+using namespace CrazyGiraffe::Core;
+
+OffsetVotes::OffsetVotes()
+    : m_scores()
+{
+}
+
+void OffsetVotes::Add(uint32_t track, uint32_t trackTime, uint32_t queryTime)
+{
+    int32_t offset = static_cast<int32_t>(trackTime) - static_cast<int32_t>(queryTime);
+    uint64_t key = (static_cast<uint64_t>(track) << 32) | static_cast<uint32_t>(offset);
+    m_scores[key]++;
+}
+
+bool OffsetVotes::Best(uint32_t minimumScore, LandmarkMatch& match) const
+{
+    bool found = false;
+    for (const std::pair<const uint64_t, uint32_t>& score : m_scores)
+    {
+        size_t track = static_cast<size_t>(score.first >> 32);
+        int32_t offset = static_cast<int32_t>(static_cast<uint32_t>(score.first));
+        if (score.second < minimumScore)
+        {
+            continue;
+        }
+
+        if (!found
+            || score.second > match.score
+            || (score.second == match.score && (track < match.track || (track == match.track && offset < match.offset))))
+        {
+            match.track = track;
+            match.offset = offset;
+            match.score = score.second;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+LandmarkIndex::LandmarkIndex()
+    : m_tracks()
+    , m_postings()
+    , m_postingCount(0)
+{
+}
+
+size_t LandmarkIndex::AddTrack(const TrackInfo& track, const std::vector<Landmark>& landmarks)
+{
+    uint32_t index = static_cast<uint32_t>(m_tracks.size());
+    m_tracks.push_back(track);
+    for (const Landmark& landmark : landmarks)
+    {
+        m_postings[landmark.hash].push_back({ index, landmark.time });
+    }
+
+    m_postingCount += landmarks.size();
+    return index;
+}
+
+size_t LandmarkIndex::TrackCount() const
+{
+    return m_tracks.size();
+}
+
+const TrackInfo& LandmarkIndex::Track(size_t index) const
+{
+    return m_tracks.at(index);
+}
+
+bool LandmarkIndex::Match(const std::vector<Landmark>& query, uint32_t minimumScore, LandmarkMatch& match) const
+{
+    OffsetVotes votes;
+    for (const Landmark& landmark : query)
+    {
+        auto postings = m_postings.find(landmark.hash);
+        if (postings == m_postings.end())
+        {
+            continue;
+        }
+
+        for (const Posting& posting : postings->second)
+        {
+            votes.Add(posting.track, posting.time, landmark.time);
+        }
+    }
+
+    return votes.Best(minimumScore, match);
+}
+
+void LandmarkIndex::Save(std::ostream& stream) const
+{
+    LandmarkCatalog::Write(*this, stream);
+}
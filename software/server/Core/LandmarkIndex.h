@@ -0,0 +1,118 @@
+//-----------------------------------------------------------------------
+// <copyright file="LandmarkIndex.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "LandmarkFingerprinter.h"
+#include "Track.h"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <unordered_map>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// The best match of a query: the track, the frame of the track the query starts at, and the
+    /// landmarks which agree on both.
+    ///
+    struct LandmarkMatch
+    {
+        size_t track;
+        int32_t offset;
+        uint32_t score;
+    };
+
+    ///
+    /// Counts the landmarks of a query which agree on each track and time offset.
+    ///
+    class OffsetVotes
+    {
+    public:
+        OffsetVotes();
+
+        ///
+        /// Count a landmark of the query found in a track.
+        ///
+        void Add(uint32_t track, uint32_t trackTime, uint32_t queryTime);
+
+        ///
+        /// Find the track and offset most landmarks agree on; a tie goes to the first track, then the
+        /// earliest offset. Returns false if none scores the minimum.
+        ///
+        bool Best(uint32_t minimumScore, LandmarkMatch& match) const;
+
+    private:
+        ///
+        /// The votes, by track in the high half and offset in the low.
+        ///
+        std::unordered_map<uint64_t, uint32_t> m_scores;
+    };
+
+    ///
+    /// A catalog of tracks searchable by landmark. A query matches the track with the most landmarks
+    /// in common at one time offset, which noise and other music rarely line up.
+    ///
+    class LandmarkIndex
+    {
+    public:
+        ///
+        /// The landmarks which must agree before a match is believed.
+        ///
+        static const uint32_t DefaultMinimumScore = 8;
+
+        LandmarkIndex();
+
+        ///
+        /// Add a track and its landmarks. Returns its index.
+        ///
+        size_t AddTrack(const TrackInfo& track, const std::vector<Landmark>& landmarks);
+
+        size_t TrackCount() const;
+
+        const TrackInfo& Track(size_t index) const;
+
+        ///
+        /// Find the best match of landmarks. Returns false if none scores the minimum.
+        ///
+        bool Match(const std::vector<Landmark>& query, uint32_t minimumScore, LandmarkMatch& match) const;
+
+        ///
+        /// Write the catalog, for LandmarkCatalog to search in place. The same catalog always writes
+        /// the same bytes.
+        ///
+        void Save(std::ostream& stream) const;
+
+    private:
+        friend class LandmarkCatalog;
+
+        ///
+        /// Where a hash occurs.
+        ///
+        struct Posting
+        {
+            uint32_t track;
+            uint32_t time;
+        };
+
+    private:
+        ///
+        /// The tracks.
+        ///
+        std::vector<TrackInfo> m_tracks;
+
+        ///
+        /// Where each hash occurs, in the order added.
+        ///
+        std::unordered_map<uint32_t, std::vector<Posting>> m_postings;
+
+        ///
+        /// The postings, across all hashes.
+        ///
+        size_t m_postingCount;
+    };
+} }
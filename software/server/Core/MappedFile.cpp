@@ -0,0 +1,141 @@
+//-----------------------------------------------------------------------
+// <copyright file="MappedFile.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "MappedFile.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <vector>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace CrazyGiraffe::Core;
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+    : m_data(nullptr)
+    , m_size(0)
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+{
+    int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::vector<wchar_t> widePath(length > 0 ? length : 1);
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, widePath.data(), length);
+
+    // The app-container calls, which desktop Windows has too.
+    m_file = CreateFile2(widePath.data(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, OPEN_EXISTING, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("file could not be opened: " + path);
+    }
+
+    FILE_STANDARD_INFO info = {};
+    if (!GetFileInformationByHandleEx(m_file, FileStandardInfo, &info, sizeof(info)))
+    {
+        CloseHandle(m_file);
+        throw std::runtime_error("file size could not be read: " + path);
+    }
+
+    m_size = static_cast<size_t>(info.EndOfFile.QuadPart);
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    m_mapping = CreateFileMappingFromApp(m_file, nullptr, PAGE_READONLY, 0, nullptr);
+    void* view = (m_mapping != nullptr) ? MapViewOfFileFromApp(m_mapping, FILE_MAP_READ, 0, 0) : nullptr;
+    if (view == nullptr)
+    {
+        if (m_mapping != nullptr)
+        {
+            CloseHandle(m_mapping);
+        }
+
+        CloseHandle(m_file);
+        throw std::runtime_error("file could not be mapped: " + path);
+    }
+
+    m_data = static_cast<const uint8_t*>(view);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+    }
+
+    CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+    : m_data(nullptr)
+    , m_size(0)
+    , m_file(nullptr)
+    , m_mapping(nullptr)
+{
+    int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+    {
+        throw std::runtime_error("file could not be opened: " + path);
+    }
+
+    struct stat status = {};
+    if (fstat(file, &status) != 0)
+    {
+        close(file);
+        throw std::runtime_error("file size could not be read: " + path);
+    }
+
+    // The mapping holds the file open.
+    m_size = static_cast<size_t>(status.st_size);
+    if (m_size > 0)
+    {
+        void* view = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, file, 0);
+        if (view == MAP_FAILED)
+        {
+            close(file);
+            throw std::runtime_error("file could not be mapped: " + path);
+        }
+
+        m_data = static_cast<const uint8_t*>(view);
+    }
+
+    close(file);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+}
+
+#endif
+
+const uint8_t* MappedFile::Data() const
+{
+    return m_data;
+}
+
+size_t MappedFile::Size() const
+{
+    return m_size;
+}
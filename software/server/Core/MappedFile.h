@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------------
+// <copyright file="MappedFile.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// A file mapped read-only into memory, so its pages are read as they are touched and shared
+    /// between the processes which map it.
+    ///
+    class MappedFile
+    {
+    public:
+        ///
+        /// Map a file, by its UTF-8 path. Throws std::runtime_error if it can't be opened.
+        ///
+        explicit MappedFile(const std::string& path);
+
+        ~MappedFile();
+
+        ///
+        /// Get the bytes of the file; null if it is empty.
+        ///
+        const uint8_t* Data() const;
+
+        size_t Size() const;
+
+    private:
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ///
+        /// The mapping.
+        ///
+        const uint8_t* m_data;
+        size_t m_size;
+
+        ///
+        /// The file and mapping handles, on Windows.
+        ///
+        void* m_file;
+        void* m_mapping;
+    };
+} }
@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------
+// <copyright file="RecognitionSession.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "RecognitionSession.h"
+
+using namespace CrazyGiraffe::Core;
+
+RecognitionSession::RecognitionSession(size_t bytesPerSecond)
+    : m_bytesPerSecond(bytesPerSecond)
+    , m_status(IdentifyStatus::Invalid)
+    , m_attempts(0)
+    , m_audioSize(0)
+    , m_targetSize(0)
+{
+}
+
+IdentifyStatus RecognitionSession::Status() const
+{
+    return m_status;
+}
+
+bool RecognitionSession::IsFinished() const
+{
+    IdentifyStatus status = m_status;
+    return status == IdentifyStatus::Complete || status == IdentifyStatus::Error;
+}
+
+uint32_t RecognitionSession::Attempts() const
+{
+    return m_attempts;
+}
+
+uint32_t RecognitionSession::CurrentAttempt() const
+{
+    // Attempts are counted when they end.
+    return m_attempts + 1;
+}
+
+size_t RecognitionSession::AudioSize() const
+{
+    return m_audioSize;
+}
+
+bool RecognitionSession::AddAudio(size_t size, size_t& targetSize)
+{
+    if (IsFinished() || size == 0)
+    {
+        return false;
+    }
+
+    size_t audioSize = m_audioSize.fetch_add(size) + size;
+
+    // Every three seconds, try recognition on the audio buffer.
+    size_t lastTargetSize = m_targetSize;
+    if ((lastTargetSize + (AttemptIntervalSeconds * m_bytesPerSecond)) < audioSize
+        && m_targetSize.compare_exchange_strong(lastTargetSize, audioSize))
+    {
+        targetSize = audioSize;
+        return true;
+    }
+
+    return false;
+}
+
+bool RecognitionSession::CanAttempt() const
+{
+    return !IsFinished() && m_attempts < MaxAttempts;
+}
+
+void RecognitionSession::EndAttempt()
+{
+    m_attempts++;
+}
+
+bool RecognitionSession::SetStatus(IdentifyStatus status)
+{
+    IdentifyStatus current = m_status;
+    do
+    {
+        if (current == status || current == IdentifyStatus::Complete || current == IdentifyStatus::Error)
+        {
+            return false;
+        }
+    }
+    while (!m_status.compare_exchange_weak(current, status));
+
+    return true;
+}
@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------
+// <copyright file="RecognitionSession.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// The identification status, as CrazyGiraffe.AudioIdentification.IdentifyStatus.
+    ///
+    enum class IdentifyStatus
+    {
+        Invalid = 0,
+        Incomplete = 1,
+        Complete = 2,
+        Error = 3,
+    };
+
+    ///
+    /// The state of a recognition session: how much audio has come, when to try recognition, how many
+    /// attempts are left, and the status. Complete and Error are final. The backend does the attempts;
+    /// this decides when they happen. Safe to use from the audio thread and the recognition task at once.
+    ///
+    class RecognitionSession
+    {
+    public:
+        ///
+        /// The attempts made before the session gives up.
+        ///
+        static const uint32_t MaxAttempts = 3;
+
+        ///
+        /// The seconds of new audio which start another attempt.
+        ///
+        static const uint32_t AttemptIntervalSeconds = 3;
+
+        explicit RecognitionSession(size_t bytesPerSecond);
+
+        IdentifyStatus Status() const;
+
+        ///
+        /// Get whether the status is final.
+        ///
+        bool IsFinished() const;
+
+        ///
+        /// Get the attempts which have ended.
+        ///
+        uint32_t Attempts() const;
+
+        ///
+        /// Get the attempt in progress, counting from 1.
+        ///
+        uint32_t CurrentAttempt() const;
+
+        ///
+        /// Get the bytes of audio added.
+        ///
+        size_t AudioSize() const;
+
+        ///
+        /// Count added audio. Returns true, with the audio to attempt recognition on, when there is
+        /// another AttemptIntervalSeconds of audio since the last attempt. Ignored once finished.
+        ///
+        bool AddAudio(size_t size, size_t& targetSize);
+
+        ///
+        /// Get whether another attempt is allowed.
+        ///
+        bool CanAttempt() const;
+
+        ///
+        /// Count an attempt as ended.
+        ///
+        void EndAttempt();
+
+        ///
+        /// Change the status. Returns true if it changed; a final status doesn't.
+        ///
+        bool SetStatus(IdentifyStatus status);
+
+    private:
+        ///
+        /// The bytes of one second of audio.
+        ///
+        size_t m_bytesPerSecond;
+
+        ///
+        /// The status.
+        ///
+        std::atomic<IdentifyStatus> m_status;
+
+        ///
+        /// The attempts which have ended.
+        ///
+        std::atomic<uint32_t> m_attempts;
+
+        ///
+        /// The bytes of audio added.
+        ///
+        std::atomic<size_t> m_audioSize;
+
+        ///
+        /// The audio size of the last attempt.
+        ///
+        std::atomic<size_t> m_targetSize;
+    };
+} }
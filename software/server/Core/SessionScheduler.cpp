@@ -0,0 +1,144 @@
+//-----------------------------------------------------------------------
+// <copyright file="SessionScheduler.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "SessionScheduler.h"
+#include <utility>
+
+using namespace CrazyGiraffe::Core;
+
+TokenBucket::TokenBucket(double ratePerSecond, double burst)
+    : m_lock()
+    , m_ratePerSecond(ratePerSecond)
+    , m_burst(burst >= 1 ? burst : 1)
+    , m_tokens(burst >= 1 ? burst : 1)
+    , m_updated(Clock::now())
+{
+}
+
+TokenBucket::Clock::duration TokenBucket::Reserve(Clock::time_point now)
+{
+    if (m_ratePerSecond <= 0)
+    {
+        return Clock::duration::zero();
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    // Refill for the time since the last reservation, up to the burst.
+    if (now > m_updated)
+    {
+        double elapsed = std::chrono::duration<double>(now - m_updated).count();
+        m_tokens = (m_tokens + elapsed * m_ratePerSecond < m_burst) ? (m_tokens + elapsed * m_ratePerSecond) : m_burst;
+        m_updated = now;
+    }
+
+    // A reservation beyond the tokens is paid back by waiting.
+    m_tokens -= 1;
+    if (m_tokens >= 0)
+    {
+        return Clock::duration::zero();
+    }
+
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(-m_tokens / m_ratePerSecond));
+}
+
+SessionScheduler::SessionScheduler(const SchedulerOptions& options)
+    : m_options(options)
+    , m_lock()
+    , m_queues()
+    , m_turns()
+    , m_pendingCount(0)
+    , m_queryBucket(options.queriesPerSecond, options.queryBurst)
+    , m_randomLock()
+    , m_random(std::random_device()())
+    , m_pool(options.workerCount)
+{
+}
+
+SessionScheduler::~SessionScheduler()
+{
+}
+
+const SchedulerOptions& SessionScheduler::Options() const
+{
+    return m_options;
+}
+
+void SessionScheduler::Schedule(const std::string& session, std::function<void()> work)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        std::deque<std::function<void()>>& queue = m_queues[session];
+        if (queue.empty())
+        {
+            m_turns.push_back(session);
+        }
+
+        queue.push_back(std::move(work));
+        m_pendingCount++;
+    }
+
+    // Each post runs one piece of work, whichever session's turn it is by then.
+    m_pool.Post([this] { RunNext(); });
+}
+
+size_t SessionScheduler::PendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_pendingCount;
+}
+
+std::chrono::milliseconds SessionScheduler::ReserveQuery()
+{
+    // Rounded up, so the query is never early.
+    TokenBucket::Clock::duration wait = m_queryBucket.Reserve(TokenBucket::Clock::now());
+    std::chrono::milliseconds delay = std::chrono::duration_cast<std::chrono::milliseconds>(wait);
+    return (delay < wait) ? delay + std::chrono::milliseconds(1) : delay;
+}
+
+std::chrono::milliseconds SessionScheduler::TriggerDelay()
+{
+    if (m_options.triggerJitter.count() <= 0)
+    {
+        return std::chrono::milliseconds(0);
+    }
+
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> distribution(0, m_options.triggerJitter.count());
+    std::lock_guard<std::mutex> lock(m_randomLock);
+    return std::chrono::milliseconds(distribution(m_random));
+}
+
+void SessionScheduler::RunNext()
+{
+    std::function<void()> work;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_turns.empty())
+        {
+            return;
+        }
+
+        // Take the next session's oldest work; it goes to the back of the line if it has more.
+        std::string session = std::move(m_turns.front());
+        m_turns.pop_front();
+
+        auto queue = m_queues.find(session);
+        work = std::move(queue->second.front());
+        queue->second.pop_front();
+        m_pendingCount--;
+
+        if (queue->second.empty())
+        {
+            m_queues.erase(queue);
+        }
+        else
+        {
+            m_turns.push_back(std::move(session));
+        }
+    }
+
+    work();
+}
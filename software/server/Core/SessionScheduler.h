@@ -0,0 +1,168 @@
+//-----------------------------------------------------------------------
+// <copyright file="SessionScheduler.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "WorkStealingPool.h"
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// How a scheduler shares the machine and the backend between sessions.
+    ///
+    struct SchedulerOptions
+    {
+        SchedulerOptions()
+            : workerCount(0)
+            , queriesPerSecond(10)
+            , queryBurst(10)
+            , triggerJitter(1000)
+        {
+        }
+
+        ///
+        /// The threads which fingerprint; zero means one per core.
+        ///
+        size_t workerCount;
+
+        ///
+        /// The queries sent per second, across all sessions, or zero for no limit.
+        ///
+        double queriesPerSecond;
+
+        ///
+        /// The queries which may be sent at once after a quiet spell.
+        ///
+        double queryBurst;
+
+        ///
+        /// The most an attempt is put off, so sessions which started together don't query together.
+        ///
+        std::chrono::milliseconds triggerJitter;
+    };
+
+    ///
+    /// A token bucket: a rate with room for a burst. A reservation always succeeds, and says how long
+    /// to wait before using it, so callers over the rate are spaced out rather than refused.
+    ///
+    class TokenBucket
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        TokenBucket(double ratePerSecond, double burst);
+
+        ///
+        /// Take a token. Returns how long after now it may be used; zero if there is no limit.
+        ///
+        Clock::duration Reserve(Clock::time_point now);
+
+    private:
+        std::mutex m_lock;
+        double m_ratePerSecond;
+        double m_burst;
+        double m_tokens;
+        Clock::time_point m_updated;
+    };
+
+    ///
+    /// Schedules the recognition of many sessions on a shared pool. Work is queued per session and
+    /// the pool takes from the sessions in turn, so a session with a backlog can't starve the others.
+    /// Queries are limited to a rate across all sessions, and attempts are put off by a random jitter
+    /// so that sessions which started together drift apart. Owned by a session factory.
+    ///
+    class SessionScheduler
+    {
+    public:
+        explicit SessionScheduler(const SchedulerOptions& options = SchedulerOptions());
+
+        ///
+        /// Run the work scheduled, then stop.
+        ///
+        ~SessionScheduler();
+
+        const SchedulerOptions& Options() const;
+
+        ///
+        /// Queue work for a session; it runs on the pool after the work already queued for the session.
+        ///
+        void Schedule(const std::string& session, std::function<void()> work);
+
+        ///
+        /// Get the work queued and not yet started, across all sessions.
+        ///
+        size_t PendingCount() const;
+
+        ///
+        /// Reserve a query. Returns how long to wait before sending it.
+        ///
+        std::chrono::milliseconds ReserveQuery();
+
+        ///
+        /// Get how long to put an attempt off, between zero and the jitter.
+        ///
+        std::chrono::milliseconds TriggerDelay();
+
+    private:
+        ///
+        /// Run the next work of the next session in turn.
+        ///
+        void RunNext();
+
+    private:
+        SessionScheduler(const SessionScheduler&) = delete;
+        SessionScheduler& operator=(const SessionScheduler&) = delete;
+
+        ///
+        /// The options.
+        ///
+        SchedulerOptions m_options;
+
+        ///
+        /// Guards the queues.
+        ///
+        mutable std::mutex m_lock;
+
+        ///
+        /// The work of each session with work queued.
+        ///
+        std::unordered_map<std::string, std::deque<std::function<void()>>> m_queues;
+
+        ///
+        /// The sessions with work queued, in the order they get their next turn.
+        ///
+        std::deque<std::string> m_turns;
+
+        ///
+        /// The work queued, across all sessions.
+        ///
+        size_t m_pendingCount;
+
+        ///
+        /// The query rate limit.
+        ///
+        TokenBucket m_queryBucket;
+
+        ///
+        /// The source of the jitter.
+        ///
+        std::mutex m_randomLock;
+        std::mt19937 m_random;
+
+        ///
+        /// The pool. Last, so it finishes its work before the queues go.
+        ///
+        WorkStealingPool m_pool;
+    };
+} }
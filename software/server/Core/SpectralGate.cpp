@@ -0,0 +1,276 @@
+//-----------------------------------------------------------------------
+// <copyright file="SpectralGate.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "SpectralGate.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#ifdef CORE_FFT_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    const double Pi = 3.14159265358979323846;
+
+    // The profile follows the noise over about this many frames once learned.
+    const uint32_t ProfileFrames = 64;
+
+    // A bin is turned down by twice the noise in it, so the hiss under the music goes too, but never
+    // below -20dB, which keeps the music from warbling.
+    const float Oversubtraction = 2.0f;
+    const float GainFloor = 0.1f;
+
+    // The gains follow the power smoothed over this many bins either side, and over a few frames, so
+    // the noise doesn't leave lone bins standing; the fingerprinters would take those for peaks.
+    const size_t SmoothingBins = 3;
+    const float SmoothingRate = 0.2f;
+
+    // Keeps the division finite in silence.
+    const float MinimumPower = 1e-20f;
+}
+
+NoiseProfile::NoiseProfile(size_t binCount)
+    : m_lock()
+    , m_power(binCount, 0.0f)
+    , m_frameCount(0)
+{
+    if (binCount == 0)
+    {
+        throw std::invalid_argument("binCount");
+    }
+}
+
+size_t NoiseProfile::BinCount() const
+{
+    return m_power.size();
+}
+
+uint32_t NoiseProfile::FrameCount() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_frameCount;
+}
+
+void NoiseProfile::Learn(const float* power)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_frameCount++;
+    float rate = 1.0f / static_cast<float>(std::min(m_frameCount, ProfileFrames));
+    for (size_t bin = 0; bin < m_power.size(); bin++)
+    {
+        m_power[bin] += (power[bin] - m_power[bin]) * rate;
+    }
+}
+
+bool NoiseProfile::Get(std::vector<float>& power) const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (m_frameCount < MinimumFrames)
+    {
+        return false;
+    }
+
+    power = m_power;
+    return true;
+}
+
+/* static */
+size_t SpectralGate::BinCount()
+{
+    return FrameSize / 2 + 1;
+}
+
+/* static */
+uint32_t SpectralGate::Latency()
+{
+    return FrameSize;
+}
+
+SpectralGate::SpectralGate(uint32_t sampleRate, uint16_t channelCount, std::shared_ptr<NoiseProfile> profile)
+    : m_channelCount(channelCount)
+    , m_profile(profile)
+    , m_window(FrameSize)
+    , m_overlapScale(0)
+    , m_fft(FrameSize)
+    , m_frame(FrameSize)
+    , m_real(BinCount())
+    , m_imaginary(BinCount())
+    , m_power(BinCount())
+    , m_noise()
+    , m_spread(BinCount())
+    , m_input(channelCount, std::vector<float>(FrameSize, 0.0f))
+    , m_overlap(channelCount, std::vector<float>(FrameSize, 0.0f))
+    , m_ready(channelCount, std::vector<float>(HopSize, 0.0f))
+    , m_smoothed(channelCount)
+    , m_fill(0)
+    , m_channel(0)
+    , m_hopIsGap(false)
+{
+    if (sampleRate == 0)
+    {
+        throw std::invalid_argument("sampleRate");
+    }
+
+    if (channelCount == 0)
+    {
+        throw std::invalid_argument("channelCount");
+    }
+
+    if (m_profile == nullptr)
+    {
+        m_profile = std::make_shared<NoiseProfile>(BinCount());
+    }
+    else if (m_profile->BinCount() != BinCount())
+    {
+        throw std::invalid_argument("profile");
+    }
+
+    // The windows multiply to a Hann window, and Hann windows a quarter apart add up to 2.
+    for (uint32_t index = 0; index < FrameSize; index++)
+    {
+        m_window[index] = static_cast<float>(std::sqrt(0.5 - 0.5 * std::cos(2 * Pi * index / FrameSize)));
+    }
+
+    m_overlapScale = static_cast<float>(HopSize * 2) / FrameSize;
+}
+
+const std::shared_ptr<NoiseProfile>& SpectralGate::Profile() const
+{
+    return m_profile;
+}
+
+void SpectralGate::ProcessSamples(const float* input, size_t count, bool isGap, float* output)
+{
+    m_hopIsGap = m_hopIsGap || isGap;
+    for (size_t index = 0; index < count; index++)
+    {
+        m_input[m_channel][FrameSize - HopSize + m_fill] = input[index];
+        output[index] = m_ready[m_channel][m_fill];
+        if (++m_channel < m_channelCount)
+        {
+            continue;
+        }
+
+        m_channel = 0;
+        if (++m_fill < HopSize)
+        {
+            continue;
+        }
+
+        // The profile is read once a hop, for every channel.
+        bool isGated = m_profile->Get(m_noise);
+        for (uint16_t channel = 0; channel < m_channelCount; channel++)
+        {
+            ProcessFrame(channel, m_hopIsGap, isGated);
+        }
+
+        m_fill = 0;
+        m_hopIsGap = isGap;
+    }
+}
+
+void SpectralGate::ProcessFrame(uint16_t channel, bool isGap, bool isGated)
+{
+    std::vector<float>& input = m_input[channel];
+    std::vector<float>& overlap = m_overlap[channel];
+
+    for (uint32_t index = 0; index < FrameSize; index++)
+    {
+        m_frame[index] = input[index] * m_window[index];
+    }
+
+    m_fft.Forward(m_frame.data(), m_real.data(), m_imaginary.data());
+    for (size_t bin = 0; bin < m_power.size(); bin++)
+    {
+        m_power[bin] = m_real[bin] * m_real[bin] + m_imaginary[bin] * m_imaginary[bin];
+    }
+
+    if (isGap)
+    {
+        m_profile->Learn(m_power.data());
+    }
+
+    if (isGated)
+    {
+        // Smooth across the bins, then blend into the last frame's.
+        size_t binCount = BinCount();
+        float sum = 0;
+        size_t first = 0;
+        size_t last = 0;
+        for (size_t bin = 0; bin < binCount; bin++)
+        {
+            for (; last < binCount && last <= bin + SmoothingBins; last++)
+            {
+                sum += m_power[last];
+            }
+
+            for (; first + SmoothingBins < bin; first++)
+            {
+                sum -= m_power[first];
+            }
+
+            m_spread[bin] = sum / static_cast<float>(last - first);
+        }
+
+        std::vector<float>& smoothed = m_smoothed[channel];
+        if (smoothed.empty())
+        {
+            smoothed = m_spread;
+        }
+
+        size_t bin = 0;
+
+#ifdef CORE_FFT_SSE2
+        // Four bins at a time; the same operations as below, so the paths agree.
+        if (m_fft.IsSimd())
+        {
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 rate = _mm_set1_ps(SmoothingRate);
+            const __m128 oversubtraction = _mm_set1_ps(Oversubtraction);
+            const __m128 floor = _mm_set1_ps(GainFloor);
+            const __m128 minimumPower = _mm_set1_ps(MinimumPower);
+            for (; bin + 4 <= binCount; bin += 4)
+            {
+                __m128 power = _mm_loadu_ps(smoothed.data() + bin);
+                power = _mm_add_ps(power, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(m_spread.data() + bin), power), rate));
+                _mm_storeu_ps(smoothed.data() + bin, power);
+                power = _mm_max_ps(power, minimumPower);
+                __m128 noise = _mm_loadu_ps(m_noise.data() + bin);
+                __m128 gain = _mm_sub_ps(one, _mm_div_ps(_mm_mul_ps(oversubtraction, noise), power));
+                gain = _mm_max_ps(gain, floor);
+                _mm_storeu_ps(m_real.data() + bin, _mm_mul_ps(_mm_loadu_ps(m_real.data() + bin), gain));
+                _mm_storeu_ps(m_imaginary.data() + bin, _mm_mul_ps(_mm_loadu_ps(m_imaginary.data() + bin), gain));
+            }
+        }
+#endif
+
+        for (; bin < binCount; bin++)
+        {
+            smoothed[bin] += (m_spread[bin] - smoothed[bin]) * SmoothingRate;
+            float power = std::max(smoothed[bin], MinimumPower);
+            float gain = 1.0f - (Oversubtraction * m_noise[bin]) / power;
+            gain = std::max(gain, GainFloor);
+            m_real[bin] *= gain;
+            m_imaginary[bin] *= gain;
+        }
+    }
+
+    m_fft.Inverse(m_real.data(), m_imaginary.data(), m_frame.data());
+    for (uint32_t index = 0; index < FrameSize; index++)
+    {
+        overlap[index] += m_frame[index] * m_window[index] * m_overlapScale;
+    }
+
+    // The oldest hop has had every frame over it added; the rest move up a hop.
+    std::copy(overlap.begin(), overlap.begin() + HopSize, m_ready[channel].begin());
+    std::copy(overlap.begin() + HopSize, overlap.end(), overlap.begin());
+    std::fill(overlap.end() - HopSize, overlap.end(), 0.0f);
+    std::copy(input.begin() + HopSize, input.end(), input.begin());
+}
@@ -0,0 +1,159 @@
+//-----------------------------------------------------------------------
+// <copyright file="SpectralGate.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "Fft.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// The power spectrum of the noise of a tape, learned from its gaps. Thread safe, so the gates of
+    /// several sessions can share what any of them hears.
+    ///
+    class NoiseProfile
+    {
+    public:
+        ///
+        /// The gap frames averaged before the profile is used.
+        ///
+        static const uint32_t MinimumFrames = 8;
+
+        explicit NoiseProfile(size_t binCount);
+
+        size_t BinCount() const;
+
+        ///
+        /// Get the gap frames learned.
+        ///
+        uint32_t FrameCount() const;
+
+        ///
+        /// Learn the power spectrum of a frame of a gap. The profile is the mean of the first frames,
+        /// then follows the noise as it changes.
+        ///
+        void Learn(const float* power);
+
+        ///
+        /// Get the profile. Returns false until enough frames are learned.
+        ///
+        bool Get(std::vector<float>& power) const;
+
+    private:
+        NoiseProfile(const NoiseProfile&) = delete;
+        NoiseProfile& operator=(const NoiseProfile&) = delete;
+
+    private:
+        ///
+        /// Guards the power and count.
+        ///
+        mutable std::mutex m_lock;
+
+        std::vector<float> m_power;
+
+        uint32_t m_frameCount;
+    };
+
+    ///
+    /// Reduces steady noise, such as tape hiss, by spectral gating: each bin of a short-time spectrum
+    /// is turned down by how much of it the noise profile says is noise, judged from the power smoothed
+    /// over nearby bins and frames so what is left of the noise stays flat, and the frames are added
+    /// back together. The gains are worked out four bins at a time with SSE2 where the compiler
+    /// targets it. Until the profile is learned, the audio passes through unchanged but for the latency.
+    ///
+    class SpectralGate
+    {
+    public:
+        ///
+        /// The samples per frame, and between frames.
+        ///
+        static const uint32_t FrameSize = 2048;
+        static const uint32_t HopSize = 512;
+
+        ///
+        /// Get the bins of the frames, for a profile.
+        ///
+        static size_t BinCount();
+
+        ///
+        /// Create a gate learning into, and gating by, a profile; null gives the gate its own.
+        ///
+        SpectralGate(uint32_t sampleRate, uint16_t channelCount, std::shared_ptr<NoiseProfile> profile = nullptr);
+
+        const std::shared_ptr<NoiseProfile>& Profile() const;
+
+        ///
+        /// Get the frames the output is behind the input.
+        ///
+        static uint32_t Latency();
+
+        ///
+        /// Gate interleaved samples, -1 to 1, into as many samples of output. Frames completed while
+        /// isGap is set, because a level detector says the tape is between tracks, are learned as noise.
+        ///
+        void ProcessSamples(const float* input, size_t count, bool isGap, float* output);
+
+    private:
+        ///
+        /// Gate the frame of a channel, adding it to the channel's output.
+        ///
+        void ProcessFrame(uint16_t channel, bool isGap, bool isGated);
+
+    private:
+        ///
+        /// The input format.
+        ///
+        uint16_t m_channelCount;
+
+        ///
+        /// The profile learned into and gated by.
+        ///
+        std::shared_ptr<NoiseProfile> m_profile;
+
+        ///
+        /// The square root of a periodic Hann window, for analysis and again for synthesis, and the
+        /// scale of their overlapped product.
+        ///
+        std::vector<float> m_window;
+        float m_overlapScale;
+
+        ///
+        /// The transform and its scratch.
+        ///
+        Fft m_fft;
+        std::vector<float> m_frame;
+        std::vector<float> m_real;
+        std::vector<float> m_imaginary;
+        std::vector<float> m_power;
+        std::vector<float> m_noise;
+        std::vector<float> m_spread;
+
+        ///
+        /// For each channel: the last frame of input, the frames being added together, the hop of
+        /// output ready to go, and the smoothed power, once gating starts.
+        ///
+        std::vector<std::vector<float>> m_input;
+        std::vector<std::vector<float>> m_overlap;
+        std::vector<std::vector<float>> m_ready;
+        std::vector<std::vector<float>> m_smoothed;
+
+        ///
+        /// The frames of the hop so far, and the channel of the frame.
+        ///
+        uint32_t m_fill;
+        uint16_t m_channel;
+
+        ///
+        /// Whether any of the hop so far was a gap.
+        ///
+        bool m_hopIsGap;
+    };
+} }
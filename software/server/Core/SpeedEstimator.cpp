@@ -0,0 +1,259 @@
+//-----------------------------------------------------------------------
+// <copyright file="SpeedEstimator.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "SpeedEstimator.h"
+#include "Fft.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    const double Pi = 3.14159265358979323846;
+
+    // The tuning is read from peaks in this band, where the bins are finest in cents and the
+    // partials are mostly fundamentals and low harmonics.
+    const double MinimumPeakHz = 400;
+    const double MaximumPeakHz = 4000;
+
+    // Frames of about 85ms at 48kHz, half overlapped.
+    const size_t TuningFrameSize = 4096;
+
+    // A peak is the loudest bin this far either side, and no more than 30dB below its frame's loudest.
+    const size_t PeakBins = 2;
+    const float PeakBelowLoudest = 1e-3f;
+    const size_t PeaksPerFrame = 8;
+
+    // Fewer peaks than this say nothing about the tuning.
+    const size_t MinimumPeaks = 20;
+
+    // Mix interleaved audio down to mono.
+    std::vector<float> MixDown(const float* samples, size_t count, uint16_t channelCount)
+    {
+        size_t frames = count / channelCount;
+        std::vector<float> mono(frames);
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            float sum = 0;
+            for (uint16_t channel = 0; channel < channelCount; channel++)
+            {
+                sum += samples[frame * channelCount + channel];
+            }
+
+            mono[frame] = sum / channelCount;
+        }
+
+        return mono;
+    }
+}
+
+SpeedEstimate CrazyGiraffe::Core::EstimateSpeedFromTuning(const float* samples, size_t count, uint32_t sampleRate, uint16_t channelCount)
+{
+    SpeedEstimate estimate = { 1.0, 0.0 };
+    if (channelCount == 0 || sampleRate == 0)
+    {
+        return estimate;
+    }
+
+    std::vector<float> mono = MixDown(samples, count, channelCount);
+    std::vector<float> window(TuningFrameSize);
+    for (size_t index = 0; index < TuningFrameSize; index++)
+    {
+        window[index] = static_cast<float>(0.5 - 0.5 * std::cos(2 * Pi * index / TuningFrameSize));
+    }
+
+    Fft fft(TuningFrameSize);
+    std::vector<float> frame(TuningFrameSize);
+    std::vector<float> power(TuningFrameSize / 2 + 1);
+    double binHz = static_cast<double>(sampleRate) / TuningFrameSize;
+    size_t firstBin = std::max<size_t>(static_cast<size_t>(MinimumPeakHz / binHz), PeakBins);
+    size_t lastBin = std::min<size_t>(static_cast<size_t>(MaximumPeakHz / binHz), power.size() - 1 - PeakBins);
+
+    // Each peak's offset from the nearest semitone, as an angle round a circle of one semitone,
+    // so offsets of -49 and +49 cents agree they are near the same note.
+    double sumCos = 0;
+    double sumSin = 0;
+    size_t peakCount = 0;
+    for (size_t start = 0; start + TuningFrameSize <= mono.size(); start += TuningFrameSize / 2)
+    {
+        for (size_t index = 0; index < TuningFrameSize; index++)
+        {
+            frame[index] = mono[start + index] * window[index];
+        }
+
+        fft.PowerSpectrum(frame.data(), power.data());
+        float loudest = *std::max_element(power.begin() + firstBin, power.begin() + lastBin + 1);
+        if (loudest <= 0)
+        {
+            continue;
+        }
+
+        std::vector<std::pair<float, size_t>> peaks;
+        for (size_t bin = firstBin; bin <= lastBin; bin++)
+        {
+            if (power[bin] < loudest * PeakBelowLoudest)
+            {
+                continue;
+            }
+
+            bool isPeak = true;
+            for (size_t other = bin - PeakBins; other <= bin + PeakBins && isPeak; other++)
+            {
+                isPeak = (other == bin) || (other < bin ? power[other] < power[bin] : power[other] <= power[bin]);
+            }
+
+            if (isPeak)
+            {
+                peaks.emplace_back(power[bin], bin);
+            }
+        }
+
+        std::sort(peaks.begin(), peaks.end(), [](const std::pair<float, size_t>& left, const std::pair<float, size_t>& right)
+            {
+                return left.first > right.first;
+            });
+
+        for (size_t index = 0; index < peaks.size() && index < PeaksPerFrame; index++)
+        {
+            // The true frequency, between bins: a Hann window's peak is near a parabola in log power.
+            size_t bin = peaks[index].second;
+            double left = std::log(power[bin - 1] + 1e-20);
+            double middle = std::log(power[bin] + 1e-20);
+            double right = std::log(power[bin + 1] + 1e-20);
+            double curve = left - 2 * middle + right;
+            double delta = (curve < 0) ? 0.5 * (left - right) / curve : 0;
+            double frequency = (bin + delta) * binHz;
+
+            double cents = 1200 * std::log2(frequency / 440.0);
+            double angle = 2 * Pi * cents / 100;
+            sumCos += std::cos(angle);
+            sumSin += std::sin(angle);
+            peakCount++;
+        }
+    }
+
+    if (peakCount < MinimumPeaks)
+    {
+        return estimate;
+    }
+
+    // Sharp peaks mean the tape runs fast.
+    double offsetCents = std::atan2(sumSin, sumCos) * 100 / (2 * Pi);
+    estimate.speed = std::pow(2.0, offsetCents / 1200);
+    estimate.confidence = std::sqrt(sumCos * sumCos + sumSin * sumSin) / peakCount;
+    return estimate;
+}
+
+void CrazyGiraffe::Core::CorrectSpeed(const float* samples, size_t count, uint16_t channelCount, double speed, std::vector<float>& output)
+{
+    size_t frames = (channelCount > 0) ? count / channelCount : 0;
+    size_t outputFrames = (frames > 0) ? static_cast<size_t>((frames - 1) * speed) + 1 : 0;
+    output.resize(outputFrames * channelCount);
+
+    // Linear interpolation is close enough below 4kHz, the band which is fingerprinted.
+    for (size_t frame = 0; frame < outputFrames; frame++)
+    {
+        double position = frame / speed;
+        size_t before = static_cast<size_t>(position);
+        size_t after = std::min(before + 1, frames - 1);
+        float fraction = static_cast<float>(position - before);
+        for (uint16_t channel = 0; channel < channelCount; channel++)
+        {
+            float first = samples[before * channelCount + channel];
+            float second = samples[after * channelCount + channel];
+            output[frame * channelCount + channel] = first + (second - first) * fraction;
+        }
+    }
+}
+
+bool CrazyGiraffe::Core::MatchAtSpeeds(
+    const LandmarkCatalog& catalog,
+    const float* samples,
+    size_t count,
+    uint32_t sampleRate,
+    uint16_t channelCount,
+    double maximumError,
+    double step,
+    uint32_t minimumScore,
+    WorkStealingPool* pool,
+    LandmarkMatch& match,
+    double& speed)
+{
+    // Nearest 1 first, so a tie keeps the smaller correction.
+    std::vector<double> speeds(1, 1.0);
+    for (double error = step; error <= maximumError + step / 2; error += step)
+    {
+        speeds.push_back(1.0 + error);
+        speeds.push_back(1.0 - error);
+    }
+
+    std::vector<float> mono = MixDown(samples, count, channelCount);
+    std::vector<LandmarkMatch> matches(speeds.size());
+    std::vector<char> found(speeds.size(), 0);
+
+    std::mutex lock;
+    std::condition_variable finished;
+    size_t remaining = speeds.size();
+    for (size_t index = 0; index < speeds.size(); index++)
+    {
+        // Each search fills in its own speed's result; a corrupt catalog is no match.
+        auto search = [&, index]
+            {
+                try
+                {
+                    std::vector<float> corrected;
+                    CorrectSpeed(mono.data(), mono.size(), 1, speeds[index], corrected);
+                    std::vector<Landmark> landmarks = LandmarkFingerprinter::Fingerprint(corrected.data(), corrected.size(), sampleRate, 1);
+                    found[index] = catalog.Match(landmarks, minimumScore, matches[index]) ? 1 : 0;
+                }
+                catch (const std::exception& ex)
+                {
+                    LOG_WARNING("MatchAtSpeeds: %s", ex.what());
+                }
+            };
+
+        if (pool == nullptr)
+        {
+            search();
+            continue;
+        }
+
+        pool->Post([&, search]
+            {
+                search();
+
+                std::lock_guard<std::mutex> guard(lock);
+                if (--remaining == 0)
+                {
+                    finished.notify_all();
+                }
+            });
+    }
+
+    if (pool != nullptr)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        finished.wait(guard, [&remaining] { return remaining == 0; });
+    }
+
+    bool any = false;
+    for (size_t index = 0; index < speeds.size(); index++)
+    {
+        if (found[index] && (!any || matches[index].score > match.score))
+        {
+            match = matches[index];
+            speed = speeds[index];
+            any = true;
+        }
+    }
+
+    return any;
+}
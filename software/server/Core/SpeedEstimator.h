@@ -0,0 +1,59 @@
+//-----------------------------------------------------------------------
+// <copyright file="SpeedEstimator.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "LandmarkCatalog.h"
+#include "WorkStealingPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// How fast audio was played back, as a ratio to its true speed, and how sure the estimate is,
+    /// from 0 to 1.
+    ///
+    struct SpeedEstimate
+    {
+        double speed;
+        double confidence;
+    };
+
+    ///
+    /// Estimate the playback speed of music from its tuning: the spectral peaks of music tuned to
+    /// A440 sit on the semitones, so how far they sit off them, together, is how fast the tape runs.
+    /// Errors up to half a semitone (2.9%) either way are told apart, which covers worn decks. Music
+    /// which isn't tuned to equal temperament has a low confidence.
+    ///
+    SpeedEstimate EstimateSpeedFromTuning(const float* samples, size_t count, uint32_t sampleRate, uint16_t channelCount);
+
+    ///
+    /// Play interleaved audio at 1/speed of the speed it was played at, so audio played at a speed
+    /// is back at its true speed. The output is at the same rate, and longer by the speed.
+    ///
+    void CorrectSpeed(const float* samples, size_t count, uint16_t channelCount, double speed, std::vector<float>& output);
+
+    ///
+    /// Find the best match of audio against a catalog at speeds from 1 - maximumError to
+    /// 1 + maximumError, a step apart, on a pool if one is given. The offset is in the frames of the
+    /// corrected audio. A tie goes to the speed nearer 1. Returns false if none scores the minimum. The
+    /// searches run on the pool while the caller waits, so it mustn't be one of the pool's workers.
+    ///
+    bool MatchAtSpeeds(
+        const LandmarkCatalog& catalog,
+        const float* samples,
+        size_t count,
+        uint32_t sampleRate,
+        uint16_t channelCount,
+        double maximumError,
+        double step,
+        uint32_t minimumScore,
+        WorkStealingPool* pool,
+        LandmarkMatch& match,
+        double& speed);
+} }
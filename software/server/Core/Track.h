@@ -0,0 +1,38 @@
+//-----------------------------------------------------------------------
+// <copyright file="Track.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// An identified track, as CrazyGiraffe.AudioIdentification.Track, in UTF-8.
+    /// Positions and duration are in milliseconds, or -1 if unknown.
+    ///
+    struct TrackInfo
+    {
+        TrackInfo()
+            : duration(-1)
+            , matchPosition(-1)
+            , currentPosition(-1)
+        {
+        }
+
+        std::string identifier;
+        std::string title;
+        std::string artist;
+        std::string album;
+        std::string genre;
+        std::string coverArtUrl;
+        std::string matchConfidence;
+        int32_t duration;
+        int32_t matchPosition;
+        int32_t currentPosition;
+    };
+} }
@@ -0,0 +1,106 @@
+//-----------------------------------------------------------------------
+// <copyright file="ACRCloudCodecTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "ACRCloudCodec.h"
+#include "Json.h"
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    const char* const TrackResponse =
+        "{\"status\":{\"msg\":\"Success\",\"version\":\"1.0\",\"code\":0},"
+        "\"metadata\":{\"timestamp_utc\":\"2020-01-19 02:58:28\",\"music\":["
+        "{\"acrid\":\"6049f11da7095e8bb8266871d4a70873\",\"title\":\"Hello\",\"album\":{\"name\":\"25\"},"
+        "\"artists\":[{\"name\":\"Adele\"}],\"genres\":[{\"name\":\"Pop\"}],\"duration_ms\":295000,"
+        "\"play_offset_ms\":9040,\"score\":87.5,"
+        "\"external_metadata\":{\"musicbrainz\":[{\"track\":{\"id\":\"0a8e8d55-4b83-4f8a-9732-fbb5ded9f344\"}}]}},"
+        "{\"acrid\":\"missing-title\",\"album\":{\"name\":\"25\"},\"artists\":[]}"
+        "]}}";
+}
+
+/// <summary>
+/// Test the request fields are signed over the method, path, key, type, version and time.
+/// </summary>
+TEST_METHOD(CreateRequestFields)
+{
+    ACRCloudRequestFields fields = ACRCloudCodec::CreateRequestFields("key", "secret", 1579402708, 1234);
+
+    std::string expected = ACRCloudCodec::CreateSignature("POST\n/v1/identify\nkey\nfingerprint\n1\n1579402708", "secret");
+    Assert::AreEqual(expected, fields.signature, "Signature is over the canonical string.");
+    Assert::AreEqual(std::string("1579402708"), fields.timestamp, "Timestamp is decimal.");
+    Assert::AreEqual(std::string("1234"), fields.sampleBytes, "Sample bytes is decimal.");
+    Assert::AreEqual(std::string("fingerprint"), fields.dataType, "Data type is fingerprint.");
+    Assert::AreEqual(std::string("1"), fields.signatureVersion, "Signature version is 1.");
+    Assert::AreEqual(static_cast<size_t>(28), fields.signature.size(), "Signature is a base64 SHA-1.");
+}
+
+/// <summary>
+/// Test the multi-part body has every field and the sample.
+/// </summary>
+TEST_METHOD(CreateRequestBody)
+{
+    ACRCloudRequestFields fields = ACRCloudCodec::CreateRequestFields("key", "secret", 1, 3);
+    std::string boundary = ACRCloudCodec::CreateBoundary(0xabc);
+    uint8_t sample[] = { 0x00, 0xff, 0x10 };
+    std::vector<uint8_t> body = ACRCloudCodec::CreateRequestBody(fields, boundary, sample, sizeof(sample));
+    std::string text(body.begin(), body.end());
+
+    Assert::AreEqual(std::string("acrcloud___copyright___2015___abc"), boundary, "Boundary ends in hex.");
+    Assert::AreEqual(std::string("multipart/form-data; boundary=") + boundary, ACRCloudCodec::CreateContentType(boundary), "Content type.");
+    for (const char* name : { "access_key", "timestamp", "signature", "data_type", "signature_version", "sample_bytes" })
+    {
+        Assert::IsTrue(text.find(std::string("name=\"") + name + "\"\r\n\r\n") != std::string::npos, name);
+    }
+
+    std::string samplePart = "filename=\"sample\"\r\nContent-Type: application/octet-stream\r\n\r\n" + std::string(sample, sample + 3) + "\r\n--" + boundary + "--\r\n";
+    Assert::IsTrue(text.size() > samplePart.size() && text.compare(text.size() - samplePart.size(), samplePart.size(), samplePart) == 0, "Sample is last.");
+}
+
+/// <summary>
+/// Test a response with tracks parses, skipping a track without a title.
+/// </summary>
+TEST_METHOD(ParseTrackResponse)
+{
+    ACRCloudTrackResult result = ACRCloudCodec::ParseTrackResponse(TrackResponse);
+
+    Assert::AreEqual(std::string("Success"), result.message, "Message.");
+    Assert::AreEqual(std::string("1.0"), result.version, "Version.");
+    Assert::AreEqual(0, result.code, "Code.");
+    Assert::AreEqual(static_cast<size_t>(1), result.tracks.size(), "The track without a title is skipped.");
+
+    const TrackInfo& track = result.tracks[0];
+    Assert::AreEqual(std::string("6049f11da7095e8bb8266871d4a70873"), track.identifier, "Identifier.");
+    Assert::AreEqual(std::string("Hello"), track.title, "Title.");
+    Assert::AreEqual(std::string("Adele"), track.artist, "Artist.");
+    Assert::AreEqual(std::string("25"), track.album, "Album.");
+    Assert::AreEqual(std::string("Pop"), track.genre, "Genre.");
+    Assert::AreEqual(295000, track.duration, "Duration.");
+    Assert::AreEqual(9040, track.matchPosition, "Match position.");
+    Assert::AreEqual(9040, track.currentPosition, "Current position.");
+    Assert::AreEqual(std::string("87.5"), track.matchConfidence, "Score.");
+    Assert::AreEqual(
+        std::string("http://coverartarchive.org/release/0a8e8d55-4b83-4f8a-9732-fbb5ded9f344/front"),
+        track.coverArtUrl,
+        "Cover art.");
+}
+
+/// <summary>
+/// Test error and incomplete responses.
+/// </summary>
+TEST_METHOD(ParseTrackResponseNoResult)
+{
+    ACRCloudTrackResult noResult = ACRCloudCodec::ParseTrackResponse("{\"status\":{\"msg\":\"No result\",\"version\":\"1.0\",\"code\":1001}}");
+    Assert::AreEqual(1001, noResult.code, "Code.");
+    Assert::AreEqual(static_cast<size_t>(0), noResult.tracks.size(), "No tracks.");
+
+    ACRCloudTrackResult noStatus = ACRCloudCodec::ParseTrackResponse("{}");
+    Assert::AreEqual(-1, noStatus.code, "No status.");
+
+    Assert::ThrowsException<JsonError>([] { ACRCloudCodec::ParseTrackResponse("<html>"); }, "Not JSON.");
+}
@@ -0,0 +1,171 @@
+//-----------------------------------------------------------------------
+// <copyright file="ArtifactDetectorTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "TestAudio.h"
+#include "ArtifactDetector.h"
+#include <cmath>
+#include <vector>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    // Repair a stream, flushed out past the latency, and return the output lined up with the input.
+    std::vector<float> Repair(ArtifactDetector& detector, const std::vector<float>& samples, uint16_t channelCount, std::vector<Artifact>& artifacts)
+    {
+        std::vector<float> input(samples);
+        input.resize(samples.size() + detector.Latency() * channelCount, 0.0f);
+        std::vector<float> output(input.size());
+
+        // In odd chunks, so artifacts span buffers.
+        for (size_t offset = 0; offset < input.size(); offset += 999)
+        {
+            size_t size = std::min(static_cast<size_t>(999), input.size() - offset);
+            detector.ProcessSamples(input.data() + offset, size, output.data() + offset, [&artifacts](const Artifact& artifact)
+                {
+                    artifacts.push_back(artifact);
+                });
+        }
+
+        return std::vector<float>(output.begin() + detector.Latency() * channelCount, output.end());
+    }
+
+    // Add the same value to every channel of a frame.
+    void AddToFrame(std::vector<float>& samples, uint16_t channelCount, size_t frame, float value)
+    {
+        for (uint16_t channel = 0; channel < channelCount; channel++)
+        {
+            samples[frame * channelCount + channel] += value;
+        }
+    }
+
+    std::vector<float> CreateTone(double frequency, double seconds, uint32_t sampleRate, uint16_t channelCount)
+    {
+        const double Pi = 3.14159265358979323846;
+        size_t frames = static_cast<size_t>(seconds * sampleRate);
+        std::vector<float> samples(frames * channelCount);
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            AddToFrame(samples, channelCount, frame, static_cast<float>(0.3 * std::sin(2 * Pi * frequency * frame / sampleRate)));
+        }
+
+        return samples;
+    }
+}
+
+/// <summary>
+/// Test the format must be one it can repair.
+/// </summary>
+TEST_METHOD(InvalidFormat)
+{
+    Assert::ThrowsException<std::invalid_argument>([] { ArtifactDetector detector(0, 2); }, "No rate.");
+    Assert::ThrowsException<std::invalid_argument>([] { ArtifactDetector detector(44100, 0); }, "No channels.");
+}
+
+/// <summary>
+/// Test clean music passes through, late by the latency, with nothing found.
+/// </summary>
+TEST_METHOD(CleanMusicPassesThrough)
+{
+    std::vector<float> music = CreateTestMusic(1, 0, 10, 44100, 2);
+    ArtifactDetector detector(44100, 2);
+    std::vector<Artifact> artifacts;
+    std::vector<float> output = Repair(detector, music, 2, artifacts);
+
+    Assert::AreEqual(static_cast<size_t>(0), artifacts.size(), "No artifacts in clean music.");
+    bool same = true;
+    for (size_t index = 0; index < music.size() && same; index++)
+    {
+        same = output[index] == music[index];
+    }
+
+    Assert::IsTrue(same, "Output is the input, delayed.");
+}
+
+/// <summary>
+/// Test clicks are found where they are and bridged.
+/// </summary>
+TEST_METHOD(RepairsClicks)
+{
+    std::vector<float> music = CreateTestMusic(2, 0, 5, 44100, 2);
+    std::vector<float> clicked(music);
+    size_t clicks[] = { 30000, 100000, 170000 };
+    for (size_t click : clicks)
+    {
+        AddToFrame(clicked, 2, click, 0.6f);
+        AddToFrame(clicked, 2, click + 1, -0.4f);
+    }
+
+    ArtifactDetector detector(44100, 2);
+    std::vector<Artifact> artifacts;
+    std::vector<float> output = Repair(detector, clicked, 2, artifacts);
+
+    Assert::AreEqual(static_cast<size_t>(3), artifacts.size(), "Each click is found.");
+    Assert::AreEqual(3u, detector.ClickCount(), "Each click is counted.");
+    for (size_t index = 0; index < 3; index++)
+    {
+        Assert::IsTrue(artifacts[index].type == ArtifactType::Click, "Found as a click.");
+        Assert::IsTrue(artifacts[index].position <= clicks[index] && artifacts[index].position + artifacts[index].length > clicks[index] + 1, "Covers the click.");
+        Assert::IsTrue(artifacts[index].length <= 8, "Only the click is bridged.");
+        Assert::IsTrue(std::fabs(output[clicks[index] * 2] - music[clicks[index] * 2]) < 0.1, "Click is gone.");
+    }
+}
+
+/// <summary>
+/// Test a dropout is found and filled to about the level around it.
+/// </summary>
+TEST_METHOD(RepairsDropout)
+{
+    std::vector<float> tone = CreateTone(440, 2, 44100, 1);
+    std::vector<float> dropped(tone);
+    size_t first = 44100;
+    size_t length = 441;
+    for (size_t frame = first; frame < first + length; frame++)
+    {
+        dropped[frame] *= 0.02f;
+    }
+
+    ArtifactDetector detector(44100, 1);
+    std::vector<Artifact> artifacts;
+    std::vector<float> output = Repair(detector, dropped, 1, artifacts);
+
+    Assert::AreEqual(1u, detector.DropoutCount(), "One dropout.");
+    Artifact dropout = {};
+    for (const Artifact& artifact : artifacts)
+    {
+        dropout = (artifact.type == ArtifactType::Dropout) ? artifact : dropout;
+    }
+
+    Assert::IsTrue(dropout.type == ArtifactType::Dropout, "Found as a dropout.");
+    Assert::IsTrue(dropout.position <= first && dropout.position + dropout.length >= first + length, "Covers the dropout.");
+    Assert::IsTrue(dropout.length < length + 2 * 44, "Only the dropout is filled.");
+
+    double energy = 0;
+    for (size_t frame = first; frame < first + length; frame++)
+    {
+        energy += output[frame] * output[frame];
+    }
+
+    Assert::IsTrue(std::sqrt(energy / length) > 0.3 / std::sqrt(2.0) * 0.5, "Filled to within 6dB of the tone.");
+}
+
+/// <summary>
+/// Test a pause in the music is left alone.
+/// </summary>
+TEST_METHOD(PauseIsNotDropout)
+{
+    std::vector<float> music = CreateTone(440, 1, 44100, 2);
+    music.resize(music.size() + 44100, 0.0f);
+    std::vector<float> more = CreateTone(440, 1, 44100, 2);
+    music.insert(music.end(), more.begin(), more.end());
+
+    ArtifactDetector detector(44100, 2);
+    std::vector<Artifact> artifacts;
+    Repair(detector, music, 2, artifacts);
+    Assert::AreEqual(0u, detector.DropoutCount(), "A pause isn't a dropout.");
+}
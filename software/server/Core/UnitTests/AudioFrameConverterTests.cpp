@@ -0,0 +1,75 @@
+//-----------------------------------------------------------------------
+// <copyright file="AudioFrameConverterTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "AudioFrameConverter.h"
+#include <cstring>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+/// <summary>
+/// Test float samples convert to 16-bit little-endian PCM.
+/// </summary>
+TEST_METHOD(ConvertPcm16)
+{
+    AudioFrameConverter converter(SampleType::Pcm, 16);
+    float samples[] = { 0.0f, 0.5f, -0.5f };
+    std::vector<uint8_t> output = converter.Convert(samples, 3);
+
+    Assert::AreEqual(static_cast<size_t>(6), output.size(), "Each sample is 2 bytes.");
+    Assert::AreEqual(0x00, output[0] | (output[1] << 8), "Zero converts to zero.");
+    Assert::AreEqual(0x7fff, output[2] | (output[3] << 8), "Half converts to half of 0xffff.");
+    Assert::AreEqual(0x8001, output[4] | (output[5] << 8), "Negative half wraps around.");
+}
+
+/// <summary>
+/// Test float samples convert to 24-bit PCM.
+/// </summary>
+TEST_METHOD(ConvertPcm24)
+{
+    AudioFrameConverter converter(SampleType::Pcm, 24);
+    float samples[] = { 1.0f };
+    std::vector<uint8_t> output = converter.Convert(samples, 1);
+
+    Assert::AreEqual(static_cast<size_t>(3), output.size(), "Each sample is 3 bytes.");
+    Assert::AreEqual(0xffffff, output[0] | (output[1] << 8) | (output[2] << 16), "One converts to the maximum.");
+}
+
+/// <summary>
+/// Test float samples are copied as is.
+/// </summary>
+TEST_METHOD(ConvertFloat)
+{
+    AudioFrameConverter converter(SampleType::Float, 32);
+    float samples[] = { 0.25f, -1.0f };
+    std::vector<uint8_t> output = converter.Convert(samples, 2);
+
+    Assert::AreEqual(sizeof(samples), output.size(), "Each sample is 4 bytes.");
+    Assert::IsTrue(memcmp(samples, output.data(), sizeof(samples)) == 0, "Samples are copied.");
+}
+
+/// <summary>
+/// Test unsupported sizes throw.
+/// </summary>
+TEST_METHOD(ConvertInvalidBits)
+{
+    Assert::ThrowsException<std::invalid_argument>([] { AudioFrameConverter converter(SampleType::Pcm, 12); }, "12 bits is not supported.");
+}
+
+/// <summary>
+/// Test signed PCM converts back to floats.
+/// </summary>
+TEST_METHOD(ConvertToFloat)
+{
+    uint8_t input[] = { 0x00, 0x40, 0x00, 0xc0, 0xff, 0x7f };
+    float samples[3] = { 0 };
+    AudioFrameConverter::ConvertToFloat(input, 3, 16, samples);
+
+    Assert::AreNear(0.5, samples[0], 1e-6, "0x4000 is half.");
+    Assert::AreNear(-0.5, samples[1], 1e-6, "0xc000 is negative half.");
+    Assert::AreNear(1.0, samples[2], 1e-4, "0x7fff is nearly one.");
+}
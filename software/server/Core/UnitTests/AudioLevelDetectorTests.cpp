@@ -0,0 +1,61 @@
+//-----------------------------------------------------------------------
+// <copyright file="AudioLevelDetectorTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "AudioLevelDetector.h"
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+/// <summary>
+/// Test a level held above the threshold for the duration is detected once.
+/// </summary>
+TEST_METHOD(DetectAboveThreshold)
+{
+    // 1 second at 100 samples/second, stereo: 200 samples.
+    AudioLevelDetector detector(100, 2, 0.5, Ticks(10000000));
+    std::vector<ThresholdStatus> changes;
+    std::vector<float> samples(199, 0.75f);
+
+    detector.ProcessSamples(samples.data(), samples.size(), [&changes](ThresholdStatus status) { changes.push_back(status); });
+    Assert::AreEqual(ThresholdStatus::Unknown, detector.Status(), "Status is unknown before the duration.");
+
+    detector.ProcessSamples(samples.data(), 1, [&changes](ThresholdStatus status) { changes.push_back(status); });
+    Assert::AreEqual(ThresholdStatus::AboveThreshold, detector.Status(), "Status is above after the duration.");
+
+    detector.ProcessSamples(samples.data(), samples.size(), [&changes](ThresholdStatus status) { changes.push_back(status); });
+    Assert::AreEqual(static_cast<size_t>(1), changes.size(), "Status changed once.");
+}
+
+/// <summary>
+/// Test negative samples count by their magnitude, and silence is detected after loud audio.
+/// </summary>
+TEST_METHOD(DetectBelowThresholdAfterAbove)
+{
+    AudioLevelDetector detector(100, 1, 0.1, Ticks(10000000));
+    std::vector<ThresholdStatus> changes;
+    std::vector<float> loud(100, -0.9f);
+    std::vector<float> quiet(100, 0.01f);
+
+    detector.ProcessSamples(loud.data(), loud.size(), [&changes](ThresholdStatus status) { changes.push_back(status); });
+    detector.ProcessSamples(quiet.data(), quiet.size(), [&changes](ThresholdStatus status) { changes.push_back(status); });
+
+    Assert::AreEqual(static_cast<size_t>(2), changes.size(), "Status changed twice.");
+    Assert::AreEqual(ThresholdStatus::AboveThreshold, changes[0], "Loud audio is above.");
+    Assert::AreEqual(ThresholdStatus::BelowThreshold, changes[1], "Quiet audio is below.");
+    Assert::AreEqual(0.1, detector.ThresholdValue(), "Threshold value is kept.");
+    Assert::AreEqual(static_cast<int64_t>(10000000), detector.ThresholdDuration().count(), "Threshold duration is kept.");
+}
+
+/// <summary>
+/// Test null samples are ignored.
+/// </summary>
+TEST_METHOD(ProcessNullSamples)
+{
+    AudioLevelDetector detector(100, 1, 0.1, Ticks(0));
+    detector.ProcessSamples(nullptr, 10, nullptr);
+    Assert::AreEqual(ThresholdStatus::Unknown, detector.Status(), "Status is unknown.");
+}
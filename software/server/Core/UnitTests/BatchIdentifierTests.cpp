@@ -0,0 +1,211 @@
+//-----------------------------------------------------------------------
+// <copyright file="BatchIdentifierTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "FakeServices.h"
+#include "TestAudio.h"
+#include "BatchIdentifier.h"
+#include "WavFormat.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::Ingest;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    // Always answers the same.
+    class FakeIdentifier : public TrackIdentifier
+    {
+    public:
+        explicit FakeIdentifier(bool identify)
+            : m_identify(identify)
+        {
+        }
+
+        virtual bool Identify(const std::vector<uint8_t>&, std::string& responseBody) override
+        {
+            responseBody = m_identify ? TrackResponse : NoResultResponse;
+            return true;
+        }
+
+    private:
+        bool m_identify;
+    };
+
+    // Write a WAV file of 8kHz mono 16-bit: each span is seconds of a piece of music by its seed, or
+    // of silence for seed 0.
+    std::string WriteRip(const char* name, const std::vector<std::pair<uint32_t, int>>& spans)
+    {
+        std::vector<uint8_t> samples;
+        for (const std::pair<uint32_t, int>& span : spans)
+        {
+            std::vector<float> music = (span.first > 0) ? CreateTestMusic(span.first, 0, span.second, 8000, 1) : std::vector<float>(span.second * 8000);
+            for (float sample : music)
+            {
+                int16_t value = static_cast<int16_t>(std::lround(std::max(-1.0f, std::min(sample, 0.99f)) * 32767));
+                samples.push_back(static_cast<uint8_t>(value));
+                samples.push_back(static_cast<uint8_t>(value >> 8));
+            }
+        }
+
+        AudioFormat format = { 8000, 1, 16, SampleType::Pcm };
+        std::vector<uint8_t> file = CreateWavFile(format, samples.data(), samples.size());
+        std::string path = std::string(name) + ".wav";
+        FILE* output = fopen(path.c_str(), "wb");
+        fwrite(file.data(), 1, file.size(), output);
+        fclose(output);
+        return path;
+    }
+
+    BatchOptions TestOptions()
+    {
+        BatchOptions options;
+        options.workerCount = 4;
+        options.queriesPerSecond = 0;
+        options.thresholdValue = 0.01;
+        options.thresholdDuration = Ticks(5000000);
+        options.programGap = Ticks(40000000);
+        return options;
+    }
+
+    std::map<std::string, BatchTimeline> RunBatch(BatchIdentifier& batch, const std::vector<std::string>& paths, size_t expectedFailures = 0)
+    {
+        std::map<std::string, BatchTimeline> timelines;
+        size_t failed = batch.Run(paths, [&timelines](const BatchTimeline& timeline)
+            {
+                timelines[timeline.path] = timeline;
+            });
+        Assert::AreEqual(expectedFailures, failed, "Files read.");
+        Assert::AreEqual(paths.size(), timelines.size(), "A timeline for each file.");
+        return timelines;
+    }
+}
+
+/// <summary>
+/// Test a rip is split into segments where the level drops, and into programs where it drops for longer.
+/// </summary>
+TEST_METHOD(SplitsProgramsAndSegments)
+{
+    std::string path = WriteRip("SplitsProgramsAndSegments", { { 0, 2 }, { 1, 5 }, { 0, 2 }, { 2, 5 }, { 0, 6 }, { 3, 5 }, { 0, 1 } });
+    BatchIdentifier batch(TestOptions(), nullptr, nullptr);
+    BatchTimeline timeline = RunBatch(batch, { path })[path];
+    remove(path.c_str());
+
+    Assert::IsTrue(timeline.read, "File is read.");
+    Assert::AreNear(26.0, timeline.durationSeconds, 1e-9, "Duration of the file.");
+    Assert::AreEqual(static_cast<size_t>(3), timeline.segments.size(), "Three segments.");
+
+    double starts[] = { 2, 9, 20 };
+    uint32_t programs[] = { 1, 1, 2 };
+    for (size_t index = 0; index < 3; index++)
+    {
+        const BatchSegment& segment = timeline.segments[index];
+        Assert::AreEqual(static_cast<uint32_t>(index + 1), segment.number, "Segments in order.");
+        Assert::AreEqual(programs[index], segment.program, "The long gap starts another program.");
+        Assert::AreNear(starts[index], segment.startSeconds, 0.3, "Segment starts with the sound.");
+        Assert::AreNear(starts[index] + 5, segment.endSeconds, 0.3, "Segment ends with the sound.");
+        Assert::AreEqual(IdentifyStatus::Incomplete, segment.status, "Segments are only timed.");
+    }
+
+    BatchStatistics statistics = batch.Statistics();
+    Assert::AreEqual(static_cast<size_t>(3), statistics.segments, "Segments counted.");
+    Assert::AreEqual(static_cast<size_t>(0), statistics.queries, "Nothing to query with.");
+}
+
+/// <summary>
+/// Test each segment gets the attempts of a session, on the audio a session would have.
+/// </summary>
+TEST_METHOD(SessionAttempts)
+{
+    std::string identified = WriteRip("SessionAttemptsIdentified", { { 1, 12 } });
+    std::string notIdentified = WriteRip("SessionAttemptsNotIdentified", { { 2, 12 } });
+    std::shared_ptr<FakeFingerprinter> fingerprinter = std::make_shared<FakeFingerprinter>();
+
+    BatchIdentifier identifyingBatch(TestOptions(), fingerprinter, std::make_shared<FakeIdentifier>(true));
+    BatchSegment segment = RunBatch(identifyingBatch, { identified })[identified].segments.at(0);
+    Assert::AreEqual(IdentifyStatus::Complete, segment.status, "Segment is identified.");
+    Assert::AreEqual(1u, segment.attempts, "On the first attempt.");
+    Assert::AreEqual(std::string("Hello"), segment.tracks.at(0).title, "Track is reported.");
+    Assert::AreEqual(3u, fingerprinter->fingerprintSeconds.at(0), "First attempt has three seconds.");
+
+    fingerprinter->fingerprintSeconds.clear();
+    BatchIdentifier failingBatch(TestOptions(), fingerprinter, std::make_shared<FakeIdentifier>(false));
+    segment = RunBatch(failingBatch, { notIdentified })[notIdentified].segments.at(0);
+    remove(identified.c_str());
+    remove(notIdentified.c_str());
+
+    Assert::AreEqual(IdentifyStatus::Error, segment.status, "Segment is not identified.");
+    Assert::AreEqual(3u, segment.attempts, "Three attempts.");
+    Assert::IsTrue(fingerprinter->fingerprintSeconds == std::vector<uint32_t>({ 3, 6, 9 }), "Three more seconds each attempt.");
+    Assert::IsTrue(fingerprinter->valid, "Fingerprints are of WAV files.");
+}
+
+/// <summary>
+/// Test a segment heard before in the batch, in the same file or another, takes the earlier result.
+/// </summary>
+TEST_METHOD(ReusesDuplicates)
+{
+    std::string first = WriteRip("ReusesDuplicatesFirst", { { 4, 12 }, { 0, 2 } });
+    std::string second = WriteRip("ReusesDuplicatesSecond", { { 0, 1 }, { 4, 12 }, { 0, 2 }, { 5, 12 }, { 0, 2 } });
+    std::shared_ptr<FakeFingerprinter> fingerprinter = std::make_shared<FakeFingerprinter>();
+    BatchIdentifier batch(TestOptions(), fingerprinter, std::make_shared<FakeIdentifier>(true));
+    std::map<std::string, BatchTimeline> timelines = RunBatch(batch, { first, second });
+    remove(first.c_str());
+    remove(second.c_str());
+
+    // Either copy of the piece may be the one queried.
+    const BatchSegment& firstCopy = timelines[first].segments.at(0);
+    const BatchSegment& secondCopy = timelines[second].segments.at(0);
+    Assert::IsTrue(firstCopy.duplicateFile.empty() != secondCopy.duplicateFile.empty(), "One copy is a duplicate.");
+    const BatchSegment& duplicate = firstCopy.duplicateFile.empty() ? secondCopy : firstCopy;
+    Assert::AreEqual(firstCopy.duplicateFile.empty() ? first : second, duplicate.duplicateFile, "Of the other copy.");
+    Assert::AreEqual(1u, duplicate.duplicateNumber, "Of its first segment.");
+    Assert::AreEqual(IdentifyStatus::Complete, duplicate.status, "The result is taken.");
+    Assert::AreEqual(std::string("Hello"), duplicate.tracks.at(0).title, "With its tracks.");
+    Assert::AreEqual(0u, duplicate.attempts, "Without attempts of its own.");
+    Assert::IsTrue(timelines[second].segments.at(1).duplicateFile.empty(), "Other music is queried.");
+
+    BatchStatistics statistics = batch.Statistics();
+    Assert::AreEqual(static_cast<size_t>(2), statistics.queries, "One query for each piece.");
+    Assert::AreEqual(static_cast<size_t>(1), statistics.reused, "One result reused.");
+}
+
+/// <summary>
+/// Test queries across the batch are held to the rate.
+/// </summary>
+TEST_METHOD(QueryRateLimit)
+{
+    std::string path = WriteRip("QueryRateLimit", { { 6, 4 }, { 0, 2 }, { 7, 4 }, { 0, 2 }, { 8, 4 }, { 0, 2 }, { 9, 4 }, { 0, 2 } });
+    BatchOptions options = TestOptions();
+    options.queriesPerSecond = 10;
+    options.queryBurst = 1;
+    BatchIdentifier batch(options, std::make_shared<FakeFingerprinter>(), std::make_shared<FakeIdentifier>(true));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    BatchTimeline timeline = RunBatch(batch, { path })[path];
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    remove(path.c_str());
+
+    Assert::AreEqual(static_cast<size_t>(4), timeline.segments.size(), "Four segments.");
+    Assert::AreEqual(static_cast<size_t>(4), batch.Statistics().queries, "A query each.");
+    Assert::IsTrue(elapsed >= 0.29, "The three after the first wait a tenth of a second each.");
+}
+
+/// <summary>
+/// Test a file which can't be read fails, with an empty timeline.
+/// </summary>
+TEST_METHOD(UnreadableFile)
+{
+    BatchIdentifier batch(TestOptions(), nullptr, nullptr);
+    BatchTimeline timeline = RunBatch(batch, { "does-not-exist.wav" }, 1)["does-not-exist.wav"];
+    Assert::IsFalse(timeline.read, "Not read.");
+    Assert::AreEqual(static_cast<size_t>(0), timeline.segments.size(), "No segments.");
+}
@@ -0,0 +1,107 @@
+//-----------------------------------------------------------------------
+// <copyright file="CatalogIndexerTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "TestAudio.h"
+#include "AudioFrameConverter.h"
+#include "CatalogIndexer.h"
+#include "LandmarkCatalog.h"
+#include "WavFormat.h"
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    // Write 16-bit stereo test music as a WAV file.
+    std::string WriteMusic(const std::string& name, uint32_t seed, double seconds)
+    {
+        std::vector<float> music = CreateTestMusic(seed, 0, seconds, 44100, 2);
+        AudioFrameConverter converter(SampleType::Pcm, 16);
+        std::vector<uint8_t> file(WavHeaderSize + converter.OutputSize(music.size()));
+        converter.Convert(music.data(), music.size(), file.data() + WavHeaderSize);
+
+        AudioFormat format = { 44100, 2, 16, SampleType::Pcm };
+        FrameWavFile(format, file.data(), file.size());
+        std::string path = name + ".wav";
+        FILE* output = fopen(path.c_str(), "wb");
+        fwrite(file.data(), 1, file.size(), output);
+        fclose(output);
+        return path;
+    }
+
+    std::string SaveIndex(const LandmarkIndex& index)
+    {
+        std::stringstream saved;
+        index.Save(saved);
+        return saved.str();
+    }
+}
+
+/// <summary>
+/// Test a WAV file fingerprints, and reads, as its samples do.
+/// </summary>
+TEST_METHOD(FingerprintWavFile)
+{
+    std::vector<float> music = CreateTestMusic(5, 0, 5, 8000, 1);
+    AudioFormat format = { 8000, 1, 32, SampleType::Float };
+    std::vector<uint8_t> file = CreateWavFile(format, reinterpret_cast<const uint8_t*>(music.data()), music.size() * sizeof(float));
+
+    std::vector<Landmark> landmarks;
+    int32_t duration = 0;
+    Assert::IsTrue(FingerprintWav(file.data(), file.size(), landmarks, duration), "Float WAV is read.");
+    Assert::AreEqual(5000, duration, "Duration of the samples.");
+
+    std::vector<Landmark> expected = LandmarkFingerprinter::Fingerprint(music.data(), music.size(), 8000, 1);
+    Assert::AreEqual(expected.size(), landmarks.size(), "Same landmarks as the samples.");
+
+    std::vector<float> samples;
+    AudioFormat read = {};
+    Assert::IsTrue(ReadWav(file.data(), file.size(), samples, read), "Float WAV is read whole.");
+    Assert::AreEqual(8000u, read.sampleRate, "With its format.");
+    Assert::IsTrue(samples == music, "As its samples.");
+
+    uint8_t other[64] = {};
+    Assert::IsFalse(FingerprintWav(other, sizeof(other), landmarks, duration), "Not a WAV file.");
+    Assert::IsFalse(ReadWav(other, sizeof(other), samples, read), "Not a WAV file to read.");
+}
+
+/// <summary>
+/// Test files are indexed in the order given, whatever the workers, and other files are skipped.
+/// </summary>
+TEST_METHOD(IndexesInOrder)
+{
+    std::vector<std::string> paths;
+    paths.push_back(WriteMusic("IndexesInOrder-b", 21, 8));
+    paths.push_back("IndexesInOrder-missing.wav");
+    paths.push_back(WriteMusic("IndexesInOrder-a", 22, 8));
+    paths.push_back(WriteMusic("IndexesInOrder-c", 23, 8));
+
+    LandmarkIndex parallel;
+    LandmarkIndex serial;
+    Assert::AreEqual(static_cast<size_t>(3), IndexWavFiles(paths, 4, parallel), "Three files are indexed.");
+    Assert::AreEqual(static_cast<size_t>(3), IndexWavFiles(paths, 1, serial), "Three files on one worker.");
+
+    Assert::AreEqual(std::string("IndexesInOrder-b"), parallel.Track(0).identifier, "Named for the file.");
+    Assert::AreEqual(std::string("IndexesInOrder-a"), parallel.Track(1).identifier, "In the order given.");
+    Assert::AreEqual(8000, parallel.Track(2).duration, "With its duration.");
+    Assert::IsTrue(SaveIndex(parallel) == SaveIndex(serial), "Same catalog on any workers.");
+
+    std::string saved = SaveIndex(parallel);
+    LandmarkCatalog catalog(std::vector<uint8_t>(saved.begin(), saved.end()));
+    std::vector<float> recording = CreateTestMusic(22, 3, 4, 48000, 1);
+    TrackInfo track;
+    Assert::IsTrue(catalog.Identify(LandmarkFingerprinter::Fingerprint(recording.data(), recording.size(), 48000, 1), LandmarkIndex::DefaultMinimumScore, track), "A recording is identified.");
+    Assert::AreEqual(std::string("IndexesInOrder-a"), track.identifier, "As its file.");
+
+    for (const std::string& path : paths)
+    {
+        remove(path.c_str());
+    }
+}
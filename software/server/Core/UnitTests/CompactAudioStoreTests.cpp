@@ -0,0 +1,204 @@
+//-----------------------------------------------------------------------
+// <copyright file="CompactAudioStoreTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "TestAudio.h"
+#include "CompactAudioStore.h"
+#include "LandmarkIndex.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    std::vector<float> ToFloat(const std::vector<int16_t>& samples)
+    {
+        std::vector<float> output(samples.size());
+        for (size_t index = 0; index < samples.size(); index++)
+        {
+            output[index] = samples[index] / 32768.0f;
+        }
+
+        return output;
+    }
+
+    // The RMS level of a tone of a frequency once stored, past the filter's start.
+    double StoredToneLevel(uint32_t sampleRate, uint16_t channelCount, double frequency)
+    {
+        const double Pi = 3.14159265358979323846;
+        std::vector<float> tone(sampleRate * channelCount);
+        for (size_t index = 0; index < tone.size(); index++)
+        {
+            tone[index] = static_cast<float>(0.5 * std::sin(2 * Pi * frequency * (index / channelCount) / sampleRate));
+        }
+
+        CompactAudioStore store(sampleRate, channelCount, false);
+        store.AddSamples(tone.data(), tone.size());
+        std::vector<float> stored = ToFloat(store.Read(store.SampleCount() / 4, store.SampleCount() / 2));
+
+        double sum = 0;
+        for (float sample : stored)
+        {
+            sum += sample * sample;
+        }
+
+        return std::sqrt(sum / stored.size());
+    }
+}
+
+/// <summary>
+/// Test the format must be one it can store.
+/// </summary>
+TEST_METHOD(InvalidFormat)
+{
+    Assert::ThrowsException<std::invalid_argument>([] { CompactAudioStore store(0, 2, false); }, "No rate.");
+    Assert::ThrowsException<std::invalid_argument>([] { CompactAudioStore store(44100, 0, false); }, "No channels.");
+}
+
+/// <summary>
+/// Test CD audio is kept at 8kHz mono, in a tenth of the memory.
+/// </summary>
+TEST_METHOD(StoresAtStorageRate)
+{
+    std::vector<float> music = CreateTestMusic(1, 0, 10, 44100, 2);
+    CompactAudioStore store(44100, 2, false);
+    store.AddSamples(music.data(), music.size());
+
+    Assert::AreEqual(static_cast<uint32_t>(CompactAudioStore::StorageRate), store.SampleRate(), "Stored at 8kHz.");
+    Assert::AreEqual(static_cast<size_t>(80000), store.SampleCount(), "Ten seconds of mono.");
+    Assert::IsTrue(store.StoredSize() * 10 < music.size() * sizeof(int16_t), "A tenth of the 16-bit input.");
+    Assert::ThrowsException<std::out_of_range>([&store] { store.Read(79999, 2); }, "Past the end.");
+
+    CompactAudioStore slow(4000, 1, false);
+    Assert::AreEqual(static_cast<uint32_t>(4000), slow.SampleRate(), "A lower rate is kept.");
+}
+
+/// <summary>
+/// Test compressed blocks read back exactly as they were stored, in less memory, in any window.
+/// </summary>
+TEST_METHOD(CompressionIsLossless)
+{
+    // Music, then full scale square waves whose jumps escape the coding.
+    std::vector<float> audio = CreateTestMusic(2, 0, 10, 48000, 2);
+    for (size_t index = 0; index < 48000 * 2; index++)
+    {
+        audio.push_back(((index / 12) % 2 == 0) ? 1.0f : -1.0f);
+    }
+
+    CompactAudioStore plain(48000, 2, false);
+    CompactAudioStore compressed(48000, 2, true);
+    plain.AddSamples(audio.data(), audio.size());
+    compressed.AddSamples(audio.data(), audio.size());
+
+    Assert::AreEqual(plain.SampleCount(), compressed.SampleCount(), "Same samples.");
+    Assert::IsTrue(plain.Read(0, plain.SampleCount()) == compressed.Read(0, compressed.SampleCount()), "Same audio.");
+    Assert::IsTrue(plain.Read(5000, 9000) == compressed.Read(5000, 9000), "Same window across blocks.");
+    Assert::IsTrue(compressed.StoredSize() * 10 < plain.StoredSize() * 9, "Compression saves a tenth.");
+}
+
+/// <summary>
+/// Test the stored audio doesn't depend on how the input is split into buffers.
+/// </summary>
+TEST_METHOD(StreamedInAnyChunks)
+{
+    std::vector<float> music = CreateTestMusic(3, 0, 3, 44100, 2);
+    CompactAudioStore whole(44100, 2, true);
+    whole.AddSamples(music.data(), music.size());
+
+    // Odd chunk sizes split frames across buffers.
+    CompactAudioStore chunked(44100, 2, true);
+    size_t chunkSizes[] = { 1, 3, 441, 4409, 8820 };
+    size_t offset = 0;
+    for (size_t chunk = 0; offset < music.size(); chunk++)
+    {
+        size_t size = std::min(chunkSizes[chunk % 5], music.size() - offset);
+        chunked.AddSamples(music.data() + offset, size);
+        offset += size;
+    }
+
+    Assert::AreEqual(whole.SampleCount(), chunked.SampleCount(), "Same samples.");
+    Assert::IsTrue(whole.Read(0, whole.SampleCount()) == chunked.Read(0, chunked.SampleCount()), "Same audio.");
+}
+
+/// <summary>
+/// Test the stored audio has the landmarks of the input.
+/// </summary>
+TEST_METHOD(KeepsLandmarks)
+{
+    std::vector<float> music = CreateTestMusic(4, 0, 10, 44100, 2);
+    LandmarkIndex index;
+    TrackInfo track = {};
+    track.identifier = "4";
+    index.AddTrack(track, LandmarkFingerprinter::Fingerprint(music.data(), music.size(), 44100, 2));
+
+    CompactAudioStore store(44100, 2, true);
+    store.AddSamples(music.data(), music.size());
+    std::vector<float> stored = ToFloat(store.Read(0, store.SampleCount()));
+
+    LandmarkMatch storedMatch = {};
+    LandmarkMatch inputMatch = {};
+    Assert::IsTrue(index.Match(LandmarkFingerprinter::Fingerprint(stored.data(), stored.size(), store.SampleRate(), 1), LandmarkIndex::DefaultMinimumScore, storedMatch), "Stored audio matches.");
+    index.Match(LandmarkFingerprinter::Fingerprint(music.data(), music.size(), 44100, 2), LandmarkIndex::DefaultMinimumScore, inputMatch);
+    Assert::IsTrue(storedMatch.score * 2 > inputMatch.score, "Most landmarks are kept.");
+}
+
+/// <summary>
+/// Test what is above 4kHz is filtered out rather than folded down into the stored band.
+/// </summary>
+TEST_METHOD(FiltersAboveStorageBand)
+{
+    const double ToneLevel = 0.5 / std::sqrt(2.0);
+    Assert::AreNear(ToneLevel, StoredToneLevel(44100, 2, 1000), ToneLevel * 0.05, "1kHz is kept.");
+    Assert::AreNear(ToneLevel, StoredToneLevel(48000, 1, 3000), ToneLevel * 0.05, "3kHz is kept.");
+    Assert::IsTrue(StoredToneLevel(44100, 2, 6000) < ToneLevel * 0.001, "6kHz is stopped, not stored as 2kHz.");
+    Assert::IsTrue(StoredToneLevel(48000, 1, 4500) < ToneLevel * 0.001, "4.5kHz is stopped, not stored as 3.5kHz.");
+    Assert::IsTrue(StoredToneLevel(11025, 1, 5000) < ToneLevel * 0.001, "5kHz is stopped at a low rate too.");
+}
+
+/// <summary>
+/// Test excerpts of stored audio are identified as often as the input they were stored from.
+/// </summary>
+TEST_METHOD(IdentifiedAsInput)
+{
+    const uint32_t TrackCount = 8;
+    LandmarkIndex index;
+    for (uint32_t seed = 10; seed < 10 + TrackCount; seed++)
+    {
+        std::vector<float> music = CreateTestMusic(seed, 0, 20, 44100, 2);
+        TrackInfo track = {};
+        track.identifier = std::to_string(seed);
+        index.AddTrack(track, LandmarkFingerprinter::Fingerprint(music.data(), music.size(), 44100, 2));
+    }
+
+    uint32_t storedIdentified = 0;
+    uint32_t inputIdentified = 0;
+    for (uint32_t seed = 10; seed < 10 + TrackCount; seed++)
+    {
+        std::vector<float> excerpt = CreateTestMusic(seed, 7, 5, 44100, 2);
+        CompactAudioStore store(44100, 2, true);
+        store.AddSamples(excerpt.data(), excerpt.size());
+        std::vector<float> stored = ToFloat(store.Read(0, store.SampleCount()));
+
+        LandmarkMatch match = {};
+        if (index.Match(LandmarkFingerprinter::Fingerprint(stored.data(), stored.size(), store.SampleRate(), 1), LandmarkIndex::DefaultMinimumScore, match) &&
+            match.track == seed - 10)
+        {
+            storedIdentified++;
+        }
+
+        if (index.Match(LandmarkFingerprinter::Fingerprint(excerpt.data(), excerpt.size(), 44100, 2), LandmarkIndex::DefaultMinimumScore, match) &&
+            match.track == seed - 10)
+        {
+            inputIdentified++;
+        }
+    }
+
+    Assert::AreEqual(TrackCount, inputIdentified, "Every input excerpt is identified.");
+    Assert::AreEqual(inputIdentified, storedIdentified, "Every stored excerpt is identified.");
+}
@@ -0,0 +1,81 @@
+//-----------------------------------------------------------------------
+// <copyright file="CryptoTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "Crypto.h"
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    const uint8_t* Bytes(const std::string& text)
+    {
+        return reinterpret_cast<const uint8_t*>(text.data());
+    }
+
+    std::string ToHex(const Sha1Digest& digest)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex;
+        for (uint8_t value : digest)
+        {
+            hex.push_back(digits[value >> 4]);
+            hex.push_back(digits[value & 0xf]);
+        }
+
+        return hex;
+    }
+}
+
+/// <summary>
+/// Test SHA-1 against the FIPS 180 vectors, including one spanning two padding blocks.
+/// </summary>
+TEST_METHOD(Sha1Vectors)
+{
+    std::string abc("abc");
+    std::string twoBlocks("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+    std::string million(1000000, 'a');
+
+    Assert::AreEqual(std::string("da39a3ee5e6b4b0d3255bfef95601890afd80709"), ToHex(Sha1(nullptr, 0)), "Empty.");
+    Assert::AreEqual(std::string("a9993e364706816aba3e25717850c26c9cd0d89d"), ToHex(Sha1(Bytes(abc), abc.size())), "abc.");
+    Assert::AreEqual(std::string("84983e441c3bd26ebaae4aa1f95129e5e54670f1"), ToHex(Sha1(Bytes(twoBlocks), twoBlocks.size())), "Two blocks.");
+    Assert::AreEqual(std::string("34aa973cd4c4daa4f61eeb2bdbad27316534016f"), ToHex(Sha1(Bytes(million), million.size())), "A million a's.");
+}
+
+/// <summary>
+/// Test HMAC-SHA1 against the RFC 2202 vectors, including a key longer than a block.
+/// </summary>
+TEST_METHOD(HmacSha1Vectors)
+{
+    std::string key("Jefe");
+    std::string data("what do ya want for nothing?");
+    std::string longKey(80, '\xaa');
+    std::string longData("Test Using Larger Than Block-Size Key - Hash Key First");
+
+    Assert::AreEqual(
+        std::string("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79"),
+        ToHex(HmacSha1(Bytes(key), key.size(), Bytes(data), data.size())),
+        "Short key.");
+    Assert::AreEqual(
+        std::string("aa4ae5e15272d00e95705637ce8a3b55ed402112"),
+        ToHex(HmacSha1(Bytes(longKey), longKey.size(), Bytes(longData), longData.size())),
+        "Long key.");
+}
+
+/// <summary>
+/// Test base64 against the RFC 4648 vectors.
+/// </summary>
+TEST_METHOD(Base64Vectors)
+{
+    const char* inputs[] = { "", "f", "fo", "foo", "foob", "fooba", "foobar" };
+    const char* outputs[] = { "", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy" };
+    for (size_t i = 0; i < 7; i++)
+    {
+        std::string input(inputs[i]);
+        Assert::AreEqual(std::string(outputs[i]), Base64Encode(Bytes(input), input.size()), input);
+    }
+}
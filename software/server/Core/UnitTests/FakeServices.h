@@ -0,0 +1,45 @@
+//-----------------------------------------------------------------------
+// <copyright file="FakeServices.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "IngestDaemon.h"
+#include "WavFormat.h"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core { namespace UnitTests
+{
+    ///
+    /// An ACRCloud response which identifies a track, and one which doesn't.
+    ///
+    const char* const TrackResponse =
+        "{\"status\":{\"msg\":\"Success\",\"version\":\"1.0\",\"code\":0},"
+        "\"metadata\":{\"music\":[{\"acrid\":\"1\",\"title\":\"Hello\",\"album\":{\"name\":\"25\"},\"artists\":[{\"name\":\"Adele\"}]}]}}";
+
+    const char* const NoResultResponse = "{\"status\":{\"msg\":\"No result\",\"version\":\"1.0\",\"code\":1001}}";
+
+    ///
+    /// Counts the seconds it was asked to fingerprint, and checks it was given WAV files.
+    ///
+    class FakeFingerprinter : public Ingest::Fingerprinter
+    {
+    public:
+        virtual std::vector<uint8_t> CreateFingerprint(const std::vector<uint8_t>& wavFile, uint32_t seconds) override
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            WavDataChunk chunk = {};
+            valid = valid && ReadWavHeader(wavFile.data(), wavFile.size(), chunk);
+            fingerprintSeconds.push_back(seconds);
+            return std::vector<uint8_t>(16, 0x5a);
+        }
+
+        std::mutex m_lock;
+        std::vector<uint32_t> fingerprintSeconds;
+        bool valid = true;
+    };
+} } }
@@ -0,0 +1,124 @@
+//-----------------------------------------------------------------------
+// <copyright file="FftTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "Fft.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+/// <summary>
+/// Test the size must be a power of two.
+/// </summary>
+TEST_METHOD(InvalidSize)
+{
+    Assert::ThrowsException<std::invalid_argument>([] { Fft fft(0); }, "Zero is invalid.");
+    Assert::ThrowsException<std::invalid_argument>([] { Fft fft(2); }, "Two is too small.");
+    Assert::ThrowsException<std::invalid_argument>([] { Fft fft(48); }, "48 is not a power of two.");
+}
+
+/// <summary>
+/// Test a sine lands in its bin.
+/// </summary>
+TEST_METHOD(SineInItsBin)
+{
+    const size_t Size = 64;
+    std::vector<float> input(Size);
+    for (size_t index = 0; index < Size; index++)
+    {
+        input[index] = static_cast<float>(std::sin(2 * 3.14159265358979323846 * 8 * index / Size));
+    }
+
+    Fft fft(Size);
+    std::vector<float> power(Size / 2 + 1);
+    fft.PowerSpectrum(input.data(), power.data());
+
+    // A unit sine has magnitude Size / 2 in its bin.
+    Assert::AreNear(32.0 * 32.0, power[8], 0.01, "Power is in bin 8.");
+    for (size_t bin = 0; bin < power.size(); bin++)
+    {
+        if (bin != 8)
+        {
+            Assert::AreNear(0, power[bin], 0.001, "Other bins are empty.");
+        }
+    }
+}
+
+/// <summary>
+/// Test a constant is all DC.
+/// </summary>
+TEST_METHOD(ConstantIsDc)
+{
+    std::vector<float> input(16, 0.5f);
+    std::vector<float> power(9);
+    Fft fft(16);
+    fft.PowerSpectrum(input.data(), power.data());
+
+    Assert::AreNear(64, power[0], 0.0001, "DC is the sum, squared.");
+    for (size_t bin = 1; bin < power.size(); bin++)
+    {
+        Assert::AreNear(0, power[bin], 0.0001, "No other bins.");
+    }
+}
+
+/// <summary>
+/// Test the vector path gives exactly the scalar result.
+/// </summary>
+TEST_METHOD(SimdMatchesScalar)
+{
+    const size_t Size = 1024;
+    std::vector<float> input(Size);
+    uint32_t state = 1;
+    for (float& sample : input)
+    {
+        state = state * 1664525u + 1013904223u;
+        sample = static_cast<float>(state >> 8) / (1 << 24) - 0.5f;
+    }
+
+    Fft simd(Size, true);
+    Fft scalar(Size, false);
+    Assert::IsFalse(scalar.IsSimd(), "Scalar when asked.");
+
+    std::vector<float> simdPower(Size / 2 + 1);
+    std::vector<float> scalarPower(Size / 2 + 1);
+    simd.PowerSpectrum(input.data(), simdPower.data());
+    scalar.PowerSpectrum(input.data(), scalarPower.data());
+
+    Assert::IsTrue(memcmp(simdPower.data(), scalarPower.data(), simdPower.size() * sizeof(float)) == 0, "Same bits on both paths.");
+}
+
+/// <summary>
+/// Test the inverse of the forward transform is the input, on either path.
+/// </summary>
+TEST_METHOD(InverseRestoresInput)
+{
+    const size_t Size = 256;
+    std::vector<float> input(Size);
+    uint32_t state = 3;
+    for (float& sample : input)
+    {
+        state = state * 1664525u + 1013904223u;
+        sample = static_cast<float>(state >> 8) / (1 << 24) - 0.5f;
+    }
+
+    bool paths[] = { true, false };
+    for (bool useSimd : paths)
+    {
+        Fft fft(Size, useSimd);
+        std::vector<float> real(Size / 2 + 1);
+        std::vector<float> imaginary(Size / 2 + 1);
+        std::vector<float> output(Size);
+        fft.Forward(input.data(), real.data(), imaginary.data());
+        fft.Inverse(real.data(), imaginary.data(), output.data());
+        for (size_t index = 0; index < Size; index++)
+        {
+            Assert::AreNear(input[index], output[index], 1e-5, "Same samples back.");
+        }
+    }
+}
@@ -0,0 +1,243 @@
+//-----------------------------------------------------------------------
+// <copyright file="IngestDaemonTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "FakeServices.h"
+#include "IngestDaemon.h"
+#include "WavFormat.h"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::Ingest;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    // Answers "no result" until the given query.
+    class FakeIdentifier : public TrackIdentifier
+    {
+    public:
+        explicit FakeIdentifier(int identifyOnQuery)
+            : m_identifyOnQuery(identifyOnQuery)
+            , m_queries(0)
+        {
+        }
+
+        virtual bool Identify(const std::vector<uint8_t>&, std::string& responseBody) override
+        {
+            responseBody = (++m_queries >= m_identifyOnQuery) ? TrackResponse : NoResultResponse;
+            return true;
+        }
+
+    private:
+        int m_identifyOnQuery;
+        std::atomic<int> m_queries;
+    };
+
+    // Write a WAV file of 8kHz mono 16-bit: each span is seconds of silence or of a loud square wave.
+    std::string WriteStream(const char* name, const std::vector<std::pair<bool, int>>& spans)
+    {
+        std::vector<uint8_t> samples;
+        for (const std::pair<bool, int>& span : spans)
+        {
+            for (int i = 0; i < span.second * 8000; i++)
+            {
+                int16_t value = span.first ? ((i % 20 < 10) ? 16000 : -16000) : 0;
+                samples.push_back(static_cast<uint8_t>(value));
+                samples.push_back(static_cast<uint8_t>(value >> 8));
+            }
+        }
+
+        AudioFormat format = { 8000, 1, 16, SampleType::Pcm };
+        std::vector<uint8_t> file = CreateWavFile(format, samples.data(), samples.size());
+        std::string path = std::string(name) + ".wav";
+        FILE* output = fopen(path.c_str(), "wb");
+        fwrite(file.data(), 1, file.size(), output);
+        fclose(output);
+        return path;
+    }
+
+    // Write a WAV file of 8kHz mono 16-bit: seconds of a tone, which drops out for 10ms each second.
+    std::string WriteWornTape(const char* name, int seconds)
+    {
+        std::vector<uint8_t> samples;
+        for (int i = 0; i < seconds * 8000; i++)
+        {
+            bool isDropout = (i % 8000) >= 4000 && (i % 8000) < 4080;
+            int16_t value = isDropout ? 0 : static_cast<int16_t>(10000 * std::sin(2 * 3.14159265358979323846 * 440 * i / 8000));
+            samples.push_back(static_cast<uint8_t>(value));
+            samples.push_back(static_cast<uint8_t>(value >> 8));
+        }
+
+        AudioFormat format = { 8000, 1, 16, SampleType::Pcm };
+        std::vector<uint8_t> file = CreateWavFile(format, samples.data(), samples.size());
+        std::string path = std::string(name) + ".wav";
+        FILE* output = fopen(path.c_str(), "wb");
+        fwrite(file.data(), 1, file.size(), output);
+        fclose(output);
+        return path;
+    }
+
+    std::vector<DeckResult> RunDeck(
+        const DeckOptions& options,
+        std::shared_ptr<Fingerprinter> fingerprinter,
+        std::shared_ptr<TrackIdentifier> identifier)
+    {
+        std::mutex lock;
+        std::vector<DeckResult> results;
+        IngestDaemon daemon(fingerprinter, identifier, [&lock, &results](const DeckResult& result)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                results.push_back(result);
+            });
+        daemon.AddDeck(options);
+        Assert::AreEqual(0, daemon.Run(), "Deck ran.");
+        return results;
+    }
+}
+
+/// <summary>
+/// Test a stream is identified on a later attempt, with the format from its WAV header.
+/// </summary>
+TEST_METHOD(IdentifyStream)
+{
+    DeckOptions options;
+    options.name = "a";
+    options.path = WriteStream("IdentifyStream", { { true, 12 } });
+    std::shared_ptr<FakeFingerprinter> fingerprinter = std::make_shared<FakeFingerprinter>();
+
+    std::vector<DeckResult> results = RunDeck(options, fingerprinter, std::make_shared<FakeIdentifier>(2));
+    remove(options.path.c_str());
+
+    Assert::AreEqual(static_cast<size_t>(1), results.size(), "One session.");
+    Assert::AreEqual(IdentifyStatus::Complete, results[0].status, "Session is complete.");
+    Assert::AreEqual(2u, results[0].attempts, "Identified on the second attempt.");
+    Assert::AreEqual(std::string("Hello"), results[0].tracks.at(0).title, "Track is reported.");
+    Assert::IsTrue(fingerprinter->valid, "Fingerprints are of WAV files.");
+    Assert::AreEqual(3u, fingerprinter->fingerprintSeconds.at(0), "First attempt has three seconds.");
+    Assert::AreEqual(6u, fingerprinter->fingerprintSeconds.at(1), "Second attempt has six seconds.");
+}
+
+/// <summary>
+/// Test a stream which isn't identified ends in error after three attempts.
+/// </summary>
+TEST_METHOD(StreamNotIdentified)
+{
+    DeckOptions options;
+    options.name = "b";
+    options.path = WriteStream("StreamNotIdentified", { { true, 20 } });
+
+    std::vector<DeckResult> results = RunDeck(options, std::make_shared<FakeFingerprinter>(), std::make_shared<FakeIdentifier>(100));
+    remove(options.path.c_str());
+
+    Assert::AreEqual(static_cast<size_t>(1), results.size(), "One session.");
+    Assert::AreEqual(IdentifyStatus::Error, results[0].status, "Session failed.");
+    Assert::AreEqual(3u, results[0].attempts, "Three attempts.");
+}
+
+/// <summary>
+/// Test each stretch of sound above the threshold is a session of its own.
+/// </summary>
+TEST_METHOD(SessionPerStretchOfSound)
+{
+    DeckOptions options;
+    options.name = "c";
+    options.path = WriteStream("SessionPerStretchOfSound", { { false, 2 }, { true, 4 }, { false, 2 }, { true, 4 }, { false, 2 } });
+    options.thresholdValue = 0.1;
+    options.thresholdDuration = Ticks(5000000);
+
+    std::vector<DeckResult> results = RunDeck(options, nullptr, nullptr);
+    remove(options.path.c_str());
+
+    Assert::AreEqual(static_cast<size_t>(2), results.size(), "Two sessions.");
+    Assert::AreEqual(1u, results[0].session, "First session.");
+    // Sessions start with the read in which the level held long enough.
+    Assert::AreNear(2.5, results[0].startSeconds, 0.3, "First session starts after the threshold duration.");
+    Assert::AreNear(8.5, results[1].startSeconds, 0.3, "Second session starts after the threshold duration.");
+    Assert::AreEqual(IdentifyStatus::Incomplete, results[1].status, "Sessions are only timed.");
+}
+
+/// <summary>
+/// Test denoised audio still makes a session per stretch of sound, each identified.
+/// </summary>
+TEST_METHOD(DenoisedSessions)
+{
+    DeckOptions options;
+    options.name = "e";
+    options.path = WriteStream("DenoisedSessions", { { false, 2 }, { true, 7 }, { false, 2 }, { true, 7 }, { false, 2 } });
+    options.thresholdValue = 0.1;
+    options.thresholdDuration = Ticks(5000000);
+    options.denoise = true;
+    std::shared_ptr<FakeFingerprinter> fingerprinter = std::make_shared<FakeFingerprinter>();
+
+    std::vector<DeckResult> results = RunDeck(options, fingerprinter, std::make_shared<FakeIdentifier>(1));
+    remove(options.path.c_str());
+
+    Assert::AreEqual(static_cast<size_t>(2), results.size(), "Two sessions.");
+    Assert::AreEqual(IdentifyStatus::Complete, results[1].status, "Second session is identified.");
+    Assert::IsTrue(fingerprinter->valid, "Fingerprints are of WAV files.");
+}
+
+/// <summary>
+/// Test the dropouts of a worn tape are repaired and counted against the session.
+/// </summary>
+TEST_METHOD(RepairedSession)
+{
+    DeckOptions options;
+    options.name = "f";
+    options.path = WriteWornTape("RepairedSession", 6);
+    options.repair = true;
+
+    std::vector<DeckResult> results = RunDeck(options, nullptr, nullptr);
+    remove(options.path.c_str());
+
+    Assert::AreEqual(static_cast<size_t>(1), results.size(), "One session.");
+    Assert::AreEqual(6u, results[0].dropouts, "Each dropout is repaired.");
+    Assert::AreEqual(0u, results[0].clicks, "No clicks.");
+}
+
+/// <summary>
+/// Test the chunks after the samples, such as tags, aren't taken for audio.
+/// </summary>
+TEST_METHOD(TrailingChunkNotAudio)
+{
+    DeckOptions options;
+    options.name = "g";
+    options.path = WriteStream("TrailingChunkNotAudio", { { false, 3 } });
+    options.thresholdValue = 0.1;
+    options.thresholdDuration = Ticks(5000000);
+
+    // Two seconds' worth of loud bytes in a LIST chunk.
+    std::vector<uint8_t> trailer(8 + 2 * 16000, 0x7F);
+    uint32_t trailerSize = static_cast<uint32_t>(trailer.size() - 8);
+    memcpy(trailer.data(), "LIST", 4);
+    memcpy(trailer.data() + 4, &trailerSize, sizeof(trailerSize));
+    FILE* output = fopen(options.path.c_str(), "ab");
+    fwrite(trailer.data(), 1, trailer.size(), output);
+    fclose(output);
+
+    std::vector<DeckResult> results = RunDeck(options, nullptr, nullptr);
+    remove(options.path.c_str());
+
+    Assert::AreEqual(static_cast<size_t>(0), results.size(), "No session for the trailing chunk.");
+}
+
+/// <summary>
+/// Test a missing stream fails.
+/// </summary>
+TEST_METHOD(MissingStream)
+{
+    DeckOptions options;
+    options.name = "d";
+    options.path = "does-not-exist.pcm";
+    IngestDaemon daemon(nullptr, nullptr, nullptr);
+    daemon.AddDeck(options);
+    Assert::AreEqual(1, daemon.Run(), "Deck failed.");
+}
@@ -0,0 +1,63 @@
+//-----------------------------------------------------------------------
+// <copyright file="JsonTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "Json.h"
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+/// <summary>
+/// Test a document with every type parses.
+/// </summary>
+TEST_METHOD(ParseDocument)
+{
+    JsonValue root = JsonValue::Parse(" { \"a\" : [1, -2.5e1, true, false, null], \"b\": {\"c\": \"d\"} } ");
+
+    const std::vector<JsonValue>& a = root["a"].AsArray();
+    Assert::AreEqual(static_cast<size_t>(5), a.size(), "Array has 5 elements.");
+    Assert::AreEqual(1.0, a[0].AsNumber(), "Integer.");
+    Assert::AreEqual(-25.0, a[1].AsNumber(), "Exponent.");
+    Assert::IsTrue(a[2].AsBoolean(), "True.");
+    Assert::IsFalse(a[3].AsBoolean(), "False.");
+    Assert::IsTrue(a[4].IsNull(), "Null.");
+    Assert::AreEqual(std::string("d"), root["b"]["c"].AsString(), "Nested object.");
+    Assert::IsTrue(root.Find("missing") == nullptr, "Missing member.");
+}
+
+/// <summary>
+/// Test escapes decode to UTF-8, including surrogate pairs.
+/// </summary>
+TEST_METHOD(ParseEscapes)
+{
+    JsonValue value = JsonValue::Parse("\"\\\"\\\\\\/\\n\\u00e9\\ud83c\\udfb5\"");
+    Assert::AreEqual(std::string("\"\\/\n\xc3\xa9\xf0\x9f\x8e\xb5"), value.AsString(), "Escapes decode.");
+}
+
+/// <summary>
+/// Test malformed documents and wrong types throw.
+/// </summary>
+TEST_METHOD(ParseInvalid)
+{
+    Assert::ThrowsException<JsonError>([] { JsonValue::Parse("{\"a\":1,}"); }, "Trailing comma.");
+    Assert::ThrowsException<JsonError>([] { JsonValue::Parse("[1] x"); }, "Trailing characters.");
+    Assert::ThrowsException<JsonError>([] { JsonValue::Parse("\"abc"); }, "Unterminated string.");
+    Assert::ThrowsException<JsonError>([] { JsonValue::Parse("01x"); }, "Bad number.");
+    Assert::ThrowsException<JsonError>([] { JsonValue::Parse("\"\\ud800\""); }, "Unpaired surrogate.");
+    Assert::ThrowsException<JsonError>([] { JsonValue::Parse(std::string(100, '[') + std::string(100, ']')); }, "Too deep.");
+    Assert::ThrowsException<JsonError>([] { JsonValue::Parse("1").AsString(); }, "Not a string.");
+    Assert::ThrowsException<JsonError>([] { JsonValue::Parse("{}")["a"]; }, "No member.");
+}
+
+/// <summary>
+/// Test text is quoted so it parses back.
+/// </summary>
+TEST_METHOD(QuoteText)
+{
+    std::string text("a \"b\"\\\n\x01\xc3\xa9");
+    Assert::AreEqual(std::string("\"a \\\"b\\\"\\\\\\n\\u0001\xc3\xa9\""), QuoteJson(text), "Text is escaped.");
+    Assert::AreEqual(text, JsonValue::Parse(QuoteJson(text)).AsString(), "Quoted text parses back.");
+}
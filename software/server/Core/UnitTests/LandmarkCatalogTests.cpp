@@ -0,0 +1,140 @@
+//-----------------------------------------------------------------------
+// <copyright file="LandmarkCatalogTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "TestAudio.h"
+#include "LandmarkCatalog.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    // A catalog of three 20 second tracks, seeded 10, 11 and 12.
+    LandmarkIndex CreateIndex()
+    {
+        LandmarkIndex index;
+        for (uint32_t seed = 10; seed < 13; seed++)
+        {
+            std::vector<float> music = CreateTestMusic(seed, 0, 20, 44100, 2);
+            TrackInfo track;
+            track.identifier = std::to_string(seed);
+            track.title = "Track " + std::to_string(seed);
+            track.artist = "Artist";
+            track.album = "Album";
+            track.duration = 20000;
+            index.AddTrack(track, LandmarkFingerprinter::Fingerprint(music.data(), music.size(), 44100, 2));
+        }
+
+        return index;
+    }
+
+    std::string SaveIndex(const LandmarkIndex& index)
+    {
+        std::stringstream saved;
+        index.Save(saved);
+        return saved.str();
+    }
+
+    std::vector<uint8_t> ToBytes(const std::string& saved)
+    {
+        return std::vector<uint8_t>(saved.begin(), saved.end());
+    }
+
+    std::vector<Landmark> CreateQuery(uint32_t seed, double startSeconds, double seconds)
+    {
+        std::vector<float> recording = CreateTestMusic(seed, startSeconds, seconds, 48000, 2);
+        return LandmarkFingerprinter::Fingerprint(recording.data(), recording.size(), 48000, 2);
+    }
+}
+
+/// <summary>
+/// Test a saved catalog matches as the index it was saved from does.
+/// </summary>
+TEST_METHOD(MatchesAsIndex)
+{
+    LandmarkIndex index = CreateIndex();
+    LandmarkCatalog catalog(ToBytes(SaveIndex(index)));
+    Assert::AreEqual(static_cast<size_t>(3), catalog.TrackCount(), "Three tracks.");
+    Assert::AreEqual(std::string("Track 12"), catalog.Track(2).title, "Titles load.");
+    Assert::AreEqual(20000, catalog.Track(2).duration, "Durations load.");
+
+    LandmarkMatch expected = {};
+    LandmarkMatch actual = {};
+    std::vector<Landmark> query = CreateQuery(12, 2, 6);
+    Assert::IsTrue(index.Match(query, LandmarkIndex::DefaultMinimumScore, expected), "Index matches.");
+    Assert::IsTrue(catalog.Match(query, LandmarkIndex::DefaultMinimumScore, actual), "Catalog matches.");
+    Assert::AreEqual(expected.track, actual.track, "Same track.");
+    Assert::AreEqual(expected.offset, actual.offset, "Same offset.");
+    Assert::AreEqual(expected.score, actual.score, "Same score.");
+
+    LandmarkMatch unknown = {};
+    Assert::IsFalse(catalog.Match(CreateQuery(99, 3, 6), LandmarkIndex::DefaultMinimumScore, unknown), "Unknown music doesn't match.");
+}
+
+/// <summary>
+/// Test identifying fills in the track with where the query starts in it.
+/// </summary>
+TEST_METHOD(IdentifyFillsMatchPosition)
+{
+    LandmarkCatalog catalog(ToBytes(SaveIndex(CreateIndex())));
+
+    TrackInfo track;
+    Assert::IsTrue(catalog.Identify(CreateQuery(11, 7, 6), LandmarkIndex::DefaultMinimumScore, track), "Excerpt is identified.");
+    Assert::AreEqual(std::string("11"), track.identifier, "Its track.");
+    Assert::AreEqual(std::string("Artist"), track.artist, "With the catalog's details.");
+    Assert::AreNear(7000, track.matchPosition, 100, "Where it starts.");
+    Assert::IsTrue(atoi(track.matchConfidence.c_str()) >= 50, "Many landmarks agree.");
+}
+
+/// <summary>
+/// Test a catalog is searched in place from its file, and is smaller than its postings as integers.
+/// </summary>
+TEST_METHOD(MapsCatalogFile)
+{
+    LandmarkIndex index = CreateIndex();
+    std::string saved = SaveIndex(index);
+    Assert::IsTrue(saved == SaveIndex(CreateIndex()), "The same catalog saves the same bytes.");
+
+    const char* path = "MapsCatalogFile.8tlm";
+    FILE* output = fopen(path, "wb");
+    fwrite(saved.data(), 1, saved.size(), output);
+    fclose(output);
+
+    {
+        LandmarkCatalog catalog(path);
+        Assert::AreEqual(static_cast<size_t>(3), catalog.TrackCount(), "Three tracks.");
+
+        // Sorted and delta-encoded, the postings take less than a hash, track and time each.
+        Assert::IsTrue(saved.size() < catalog.PostingCount() * 12, "Postings are compact.");
+        Assert::IsTrue(catalog.HashCount() < catalog.PostingCount(), "Hashes are shared.");
+
+        TrackInfo track;
+        Assert::IsTrue(catalog.Identify(CreateQuery(10, 12, 4), LandmarkIndex::DefaultMinimumScore, track), "Mapped catalog matches.");
+        Assert::AreEqual(std::string("10"), track.identifier, "Its track.");
+    }
+
+    remove(path);
+}
+
+/// <summary>
+/// Test a file which isn't a whole catalog is refused.
+/// </summary>
+TEST_METHOD(RejectsOtherFiles)
+{
+    std::string other("RIFF\x24\x00\x00\x00WAVEfmt \x10\x00\x00\x00", 20);
+    Assert::ThrowsException<std::runtime_error>([&other] { LandmarkCatalog catalog(ToBytes(other)); }, "Not a catalog.");
+
+    std::string saved = SaveIndex(CreateIndex());
+    Assert::ThrowsException<std::runtime_error>([&saved] { LandmarkCatalog catalog(ToBytes(saved.substr(0, saved.size() / 2))); }, "Truncated catalog.");
+    Assert::ThrowsException<std::runtime_error>([&saved] { LandmarkCatalog catalog(ToBytes(saved.substr(0, 10))); }, "Truncated header.");
+    Assert::ThrowsException<std::runtime_error>([] { LandmarkCatalog catalog(std::string("does-not-exist.8tlm")); }, "Missing file.");
+}
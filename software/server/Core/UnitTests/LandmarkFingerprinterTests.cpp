@@ -0,0 +1,132 @@
+//-----------------------------------------------------------------------
+// <copyright file="LandmarkFingerprinterTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "TestAudio.h"
+#include "LandmarkFingerprinter.h"
+#include <vector>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    bool SameLandmarks(const std::vector<Landmark>& left, const std::vector<Landmark>& right)
+    {
+        if (left.size() != right.size())
+        {
+            return false;
+        }
+
+        for (size_t index = 0; index < left.size(); index++)
+        {
+            if (left[index].hash != right[index].hash || left[index].time != right[index].time)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+/// <summary>
+/// Test the format must be one it can analyse.
+/// </summary>
+TEST_METHOD(InvalidFormat)
+{
+    Assert::ThrowsException<std::invalid_argument>([] { LandmarkFingerprinter fingerprinter(4000, 2); }, "Below the analysis rate.");
+    Assert::ThrowsException<std::invalid_argument>([] { LandmarkFingerprinter fingerprinter(44100, 0); }, "No channels.");
+}
+
+/// <summary>
+/// Test music gives landmarks, in time order, at a steady rate.
+/// </summary>
+TEST_METHOD(MusicHasLandmarks)
+{
+    std::vector<float> music = CreateTestMusic(1, 0, 10, 44100, 2);
+    std::vector<Landmark> landmarks = LandmarkFingerprinter::Fingerprint(music.data(), music.size(), 44100, 2);
+
+    // About 10 seconds of frames, a few peaks each, a few pairs each.
+    Assert::IsTrue(landmarks.size() > 500, "Enough landmarks to match on.");
+    for (size_t index = 1; index < landmarks.size(); index++)
+    {
+        Assert::IsTrue(landmarks[index - 1].time <= landmarks[index].time, "Landmarks are in time order.");
+    }
+
+    Assert::IsTrue(landmarks.back().time < 10 / LandmarkFingerprinter::FrameSeconds(), "Times are frames of the audio.");
+}
+
+/// <summary>
+/// Test silence has no landmarks.
+/// </summary>
+TEST_METHOD(SilenceHasNoLandmarks)
+{
+    std::vector<float> silence(44100 * 5, 0.0f);
+    std::vector<Landmark> landmarks = LandmarkFingerprinter::Fingerprint(silence.data(), silence.size(), 44100, 1);
+    Assert::AreEqual(static_cast<size_t>(0), landmarks.size(), "No peaks in silence.");
+}
+
+/// <summary>
+/// Test the same audio gives the same landmarks.
+/// </summary>
+TEST_METHOD(Deterministic)
+{
+    std::vector<float> music = CreateTestMusic(2, 0, 5, 48000, 2);
+    std::vector<Landmark> first = LandmarkFingerprinter::Fingerprint(music.data(), music.size(), 48000, 2);
+    std::vector<Landmark> second = LandmarkFingerprinter::Fingerprint(music.data(), music.size(), 48000, 2);
+    Assert::IsTrue(SameLandmarks(first, second), "Same landmarks every time.");
+}
+
+/// <summary>
+/// Test the landmarks don't depend on how the audio is split into buffers.
+/// </summary>
+TEST_METHOD(StreamedInAnyChunks)
+{
+    std::vector<float> music = CreateTestMusic(3, 0, 5, 44100, 2);
+    std::vector<Landmark> whole = LandmarkFingerprinter::Fingerprint(music.data(), music.size(), 44100, 2);
+
+    // Odd chunk sizes split frames across buffers.
+    LandmarkFingerprinter fingerprinter(44100, 2);
+    size_t chunkSizes[] = { 1, 3, 441, 4409, 8820 };
+    size_t offset = 0;
+    for (size_t chunk = 0; offset < music.size(); chunk++)
+    {
+        size_t size = chunkSizes[chunk % 5];
+        size = (offset + size < music.size()) ? size : (music.size() - offset);
+        fingerprinter.AddSamples(music.data() + offset, size);
+        offset += size;
+    }
+
+    fingerprinter.Flush();
+    Assert::IsTrue(SameLandmarks(whole, fingerprinter.Landmarks()), "Same landmarks in chunks.");
+}
+
+/// <summary>
+/// Test the same music at another rate and channel count gives mostly the same hashes.
+/// </summary>
+TEST_METHOD(RateIndependent)
+{
+    std::vector<float> reference = CreateTestMusic(4, 0, 10, 44100, 2);
+    std::vector<float> recording = CreateTestMusic(4, 0, 10, 48000, 1);
+    std::vector<Landmark> referenceLandmarks = LandmarkFingerprinter::Fingerprint(reference.data(), reference.size(), 44100, 2);
+    std::vector<Landmark> recordingLandmarks = LandmarkFingerprinter::Fingerprint(recording.data(), recording.size(), 48000, 1);
+
+    size_t shared = 0;
+    for (const Landmark& landmark : recordingLandmarks)
+    {
+        for (const Landmark& other : referenceLandmarks)
+        {
+            if (other.hash == landmark.hash && other.time == landmark.time)
+            {
+                shared++;
+                break;
+            }
+        }
+    }
+
+    Assert::IsTrue(shared * 2 > recordingLandmarks.size(), "Most landmarks survive the change of rate.");
+}
@@ -0,0 +1,67 @@
+//-----------------------------------------------------------------------
+// <copyright file="LandmarkIndexTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "TestAudio.h"
+#include "LandmarkIndex.h"
+#include <string>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    // A catalog of three 20 second tracks, seeded 10, 11 and 12.
+    LandmarkIndex CreateCatalog()
+    {
+        LandmarkIndex index;
+        for (uint32_t seed = 10; seed < 13; seed++)
+        {
+            std::vector<float> music = CreateTestMusic(seed, 0, 20, 44100, 2);
+            TrackInfo track;
+            track.identifier = std::to_string(seed);
+            track.title = "Track " + std::to_string(seed);
+            track.artist = "Artist";
+            track.album = "Album";
+            track.duration = 20000;
+            index.AddTrack(track, LandmarkFingerprinter::Fingerprint(music.data(), music.size(), 44100, 2));
+        }
+
+        return index;
+    }
+
+    std::vector<Landmark> CreateQuery(uint32_t seed, double startSeconds, double seconds)
+    {
+        std::vector<float> recording = CreateTestMusic(seed, startSeconds, seconds, 48000, 2);
+        return LandmarkFingerprinter::Fingerprint(recording.data(), recording.size(), 48000, 2);
+    }
+}
+
+/// <summary>
+/// Test an excerpt, recorded at another rate, matches its track at its offset.
+/// </summary>
+TEST_METHOD(MatchesExcerpt)
+{
+    LandmarkIndex index = CreateCatalog();
+    Assert::AreEqual(static_cast<size_t>(3), index.TrackCount(), "Three tracks.");
+
+    LandmarkMatch match = {};
+    Assert::IsTrue(index.Match(CreateQuery(11, 7, 6), LandmarkIndex::DefaultMinimumScore, match), "Excerpt matches.");
+    Assert::AreEqual(std::string("11"), index.Track(match.track).identifier, "Matches its track.");
+    Assert::AreNear(7.0, match.offset * LandmarkFingerprinter::FrameSeconds(), 0.1, "Matches where it starts.");
+    Assert::IsTrue(match.score >= 50, "Many landmarks agree.");
+}
+
+/// <summary>
+/// Test music not in the catalog doesn't match.
+/// </summary>
+TEST_METHOD(UnknownDoesNotMatch)
+{
+    LandmarkIndex index = CreateCatalog();
+    LandmarkMatch match = {};
+    Assert::IsFalse(index.Match(CreateQuery(99, 3, 6), LandmarkIndex::DefaultMinimumScore, match), "Unknown music doesn't match.");
+    Assert::IsFalse(index.Match(std::vector<Landmark>(), LandmarkIndex::DefaultMinimumScore, match), "Nothing doesn't match.");
+}
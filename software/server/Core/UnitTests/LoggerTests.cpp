@@ -0,0 +1,122 @@
+//-----------------------------------------------------------------------
+// <copyright file="LoggerTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "Logger.h"
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace CrazyGiraffe::Common;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    const char* const Ellipsis = "\xE2\x80\xA6";
+
+    // Keeps the formatted messages.
+    class CaptureLogSink : public LogSink
+    {
+    public:
+        virtual void Write(const LogRecord&, const char* text) override
+        {
+            messages.push_back(text);
+        }
+
+        std::vector<std::string> messages;
+    };
+
+    // Log a message and get it back as the sinks see it.
+    template <typename... Args>
+    std::string LogAndCapture(const char* format, const Args&... args)
+    {
+        std::shared_ptr<CaptureLogSink> sink = std::make_shared<CaptureLogSink>();
+        Logger& logger = Logger::Instance();
+        logger.Flush();
+        logger.ClearSinks();
+        logger.AddSink(sink);
+        logger.Log(LogLevel::Error, format, args...);
+        logger.Flush();
+        logger.ClearSinks();
+        return sink->messages.empty() ? std::string() : sink->messages.back();
+    }
+}
+
+/// <summary>
+/// Test a string which fits is logged whole, without a marker.
+/// </summary>
+TEST_METHOD(ShortStringWhole)
+{
+    uint64_t truncated = Logger::Instance().TruncatedCount();
+    Assert::AreEqual(std::string("name=side1 ok"), LogAndCapture("name=%s %s", "side1", std::string("ok")), "Message is formatted.");
+    Assert::AreEqual(truncated, Logger::Instance().TruncatedCount(), "Nothing truncated.");
+}
+
+/// <summary>
+/// Test a string longer than the text capacity ends in an ellipsis and is counted.
+/// </summary>
+TEST_METHOD(LongStringMarked)
+{
+    uint64_t truncated = Logger::Instance().TruncatedCount();
+    std::string value(LogRecord::TextCapacity + 40, 'x');
+    std::string message = LogAndCapture("[%s]", value);
+
+    Assert::AreEqual("[" + std::string(LogRecord::TextCapacity, 'x') + Ellipsis + "]", message, "Cut at the capacity and marked.");
+    Assert::AreEqual(truncated + 1, Logger::Instance().TruncatedCount(), "Truncation counted.");
+}
+
+/// <summary>
+/// Test a string which finds the text capacity used by an earlier one is marked, and is not cut inside a character.
+/// </summary>
+TEST_METHOD(SharedCapacityMarked)
+{
+    std::string first(LogRecord::TextCapacity - 1, 'a');
+    std::string message = LogAndCapture("%s|%s", first, std::wstring(L"\u00E9\u00E9"));
+    Assert::AreEqual(first + "|" + Ellipsis, message, "Second string has no room for a whole character.");
+
+    message = LogAndCapture("%s|%s", first, std::string("\xC3\xA9\xC3\xA9"));
+    Assert::AreEqual(first + "|" + Ellipsis, message, "Narrow strings are cut between characters too.");
+}
+
+/// <summary>
+/// Test a width or precision of * is taken from the arguments.
+/// </summary>
+TEST_METHOD(StarWidthAndPrecision)
+{
+    Assert::AreEqual(std::string("[   42|3.14|ab]"), LogAndCapture("[%*d|%.*f|%.*s]", 5, 42, 2, 3.14159, 2, "abc"), "Width and precision used.");
+    Assert::AreEqual(std::string("[42   ]"), LogAndCapture("[%*d]", -5, 42), "Negative width left-justifies.");
+    Assert::AreEqual(std::string("[abc]"), LogAndCapture("[%.*s]", -1, "abc"), "Negative precision is omitted.");
+    Assert::AreEqual(std::string("[42]"), LogAndCapture("[%*d]", "x", 42), "Width which isn't an integer is left out.");
+    Assert::AreEqual(std::string("[<missing>]"), LogAndCapture("[%*d]", 5), "Width without a value.");
+}
+
+/// <summary>
+/// Test the ring of a thread which has exited is freed once its messages are written out.
+/// </summary>
+TEST_METHOD(ExitedThreadRingFreed)
+{
+    Logger& logger = Logger::Instance();
+    LogAndCapture("main");
+    size_t ringCount = logger.RingCount();
+
+    std::shared_ptr<CaptureLogSink> sink = std::make_shared<CaptureLogSink>();
+    logger.ClearSinks();
+    logger.AddSink(sink);
+    for (int i = 0; i < 4; i++)
+    {
+        std::thread([i]
+            {
+                Logger::Instance().Log(LogLevel::Error, "thread %d", i);
+            }).join();
+    }
+
+    logger.Flush();
+    logger.ClearSinks();
+
+    Assert::AreEqual(static_cast<size_t>(4), sink->messages.size(), "Every message written out.");
+    Assert::AreEqual(ringCount, logger.RingCount(), "Rings of exited threads freed.");
+}
@@ -0,0 +1,64 @@
+//-----------------------------------------------------------------------
+// <copyright file="RecognitionSessionTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "RecognitionSession.h"
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+/// <summary>
+/// Test an attempt is due every three seconds of audio.
+/// </summary>
+TEST_METHOD(AddAudioEveryThreeSeconds)
+{
+    RecognitionSession session(100);
+    size_t targetSize = 0;
+
+    Assert::IsFalse(session.AddAudio(300, targetSize), "Three seconds is not past the interval.");
+    Assert::IsTrue(session.AddAudio(1, targetSize), "Past three seconds starts an attempt.");
+    Assert::AreEqual(static_cast<size_t>(301), targetSize, "Attempt is on all the audio.");
+    Assert::IsFalse(session.AddAudio(300, targetSize), "Not three more seconds.");
+    Assert::IsTrue(session.AddAudio(1, targetSize), "Three more seconds starts an attempt.");
+    Assert::AreEqual(static_cast<size_t>(602), targetSize, "Attempt is on all the audio.");
+}
+
+/// <summary>
+/// Test attempts run out after three.
+/// </summary>
+TEST_METHOD(AttemptsRunOut)
+{
+    RecognitionSession session(100);
+    for (uint32_t attempt = 1; attempt <= RecognitionSession::MaxAttempts; attempt++)
+    {
+        Assert::AreEqual(attempt, session.CurrentAttempt(), "Attempts count from 1.");
+        Assert::IsTrue(session.CanAttempt(), "Attempt is allowed.");
+        session.EndAttempt();
+    }
+
+    Assert::IsFalse(session.CanAttempt(), "No attempts left.");
+    Assert::AreEqual(3u, session.Attempts(), "Three attempts ended.");
+}
+
+/// <summary>
+/// Test final statuses don't change, and a finished session ignores audio.
+/// </summary>
+TEST_METHOD(FinalStatus)
+{
+    RecognitionSession session(100);
+    size_t targetSize = 0;
+
+    Assert::AreEqual(IdentifyStatus::Invalid, session.Status(), "Status starts invalid.");
+    Assert::IsTrue(session.SetStatus(IdentifyStatus::Incomplete), "Invalid to incomplete.");
+    Assert::IsFalse(session.SetStatus(IdentifyStatus::Incomplete), "Same status is no change.");
+    Assert::IsTrue(session.SetStatus(IdentifyStatus::Complete), "Incomplete to complete.");
+    Assert::IsFalse(session.SetStatus(IdentifyStatus::Error), "Complete is final.");
+    Assert::AreEqual(IdentifyStatus::Complete, session.Status(), "Status stays complete.");
+    Assert::IsTrue(session.IsFinished(), "Session is finished.");
+    Assert::IsFalse(session.AddAudio(1000, targetSize), "Audio is ignored.");
+    Assert::AreEqual(static_cast<size_t>(0), session.AudioSize(), "Audio is not counted.");
+    Assert::IsFalse(session.CanAttempt(), "No attempts once finished.");
+}
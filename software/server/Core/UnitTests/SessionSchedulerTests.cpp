@@ -0,0 +1,175 @@
+//-----------------------------------------------------------------------
+// <copyright file="SessionSchedulerTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "SessionScheduler.h"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    std::chrono::milliseconds::rep Milliseconds(TokenBucket::Clock::duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    }
+}
+
+/// <summary>
+/// Test sessions take turns, however much work each has queued.
+/// </summary>
+TEST_METHOD(SessionsTakeTurns)
+{
+    std::mutex lock;
+    std::condition_variable released;
+    bool isReleased = false;
+    std::vector<std::string> order;
+    {
+        SchedulerOptions options;
+        options.workerCount = 1;
+        SessionScheduler scheduler(options);
+
+        // Hold the only worker while the work is queued.
+        scheduler.Schedule("gate", [&lock, &released, &isReleased]
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                released.wait(guard, [&isReleased] { return isReleased; });
+            });
+
+        for (const char* session : { "a", "a", "a", "b", "b", "b" })
+        {
+            scheduler.Schedule(session, [&lock, &order, session]
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    order.push_back(session);
+                });
+        }
+
+        Assert::IsTrue(scheduler.PendingCount() >= 6, "Work waits behind the gate.");
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            isReleased = true;
+        }
+
+        released.notify_all();
+    }
+
+    std::string joined;
+    for (const std::string& session : order)
+    {
+        joined += session;
+    }
+
+    Assert::AreEqual(std::string("ababab"), joined, "Sessions alternate.");
+}
+
+/// <summary>
+/// Test the work of a session runs in the order it was scheduled.
+/// </summary>
+TEST_METHOD(SessionWorkInOrder)
+{
+    std::mutex lock;
+    std::vector<int> order;
+    {
+        SchedulerOptions options;
+        options.workerCount = 1;
+        SessionScheduler scheduler(options);
+        for (int index = 0; index < 20; index++)
+        {
+            scheduler.Schedule("a", [&lock, &order, index]
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    order.push_back(index);
+                });
+        }
+    }
+
+    Assert::AreEqual(static_cast<size_t>(20), order.size(), "All the work ran.");
+    for (int index = 0; index < 20; index++)
+    {
+        Assert::AreEqual(index, order[index], "Work runs in order.");
+    }
+}
+
+/// <summary>
+/// Test the bucket allows a burst, then spaces reservations at the rate.
+/// </summary>
+TEST_METHOD(TokenBucketSpacesReservations)
+{
+    TokenBucket bucket(10, 2);
+    TokenBucket::Clock::time_point now = TokenBucket::Clock::now() + std::chrono::seconds(1);
+
+    Assert::AreEqual(0LL, static_cast<long long>(Milliseconds(bucket.Reserve(now))), "First of the burst is now.");
+    Assert::AreEqual(0LL, static_cast<long long>(Milliseconds(bucket.Reserve(now))), "Second of the burst is now.");
+    Assert::AreEqual(100LL, static_cast<long long>(Milliseconds(bucket.Reserve(now))), "Next waits a tenth of a second.");
+    Assert::AreEqual(200LL, static_cast<long long>(Milliseconds(bucket.Reserve(now))), "Next waits two tenths.");
+
+    // The debt is repaid, and no more than the burst saved up.
+    now += std::chrono::seconds(10);
+    Assert::AreEqual(0LL, static_cast<long long>(Milliseconds(bucket.Reserve(now))), "Refilled.");
+    Assert::AreEqual(0LL, static_cast<long long>(Milliseconds(bucket.Reserve(now))), "Refilled to the burst.");
+    Assert::AreEqual(100LL, static_cast<long long>(Milliseconds(bucket.Reserve(now))), "Not past the burst.");
+}
+
+/// <summary>
+/// Test a zero rate is no limit.
+/// </summary>
+TEST_METHOD(TokenBucketUnlimited)
+{
+    TokenBucket bucket(0, 1);
+    TokenBucket::Clock::time_point now = TokenBucket::Clock::now();
+    for (int index = 0; index < 100; index++)
+    {
+        Assert::AreEqual(0LL, static_cast<long long>(Milliseconds(bucket.Reserve(now))), "Never waits.");
+    }
+}
+
+/// <summary>
+/// Test queries past the burst are spaced at the rate.
+/// </summary>
+TEST_METHOD(ReserveQueryAtRate)
+{
+    SchedulerOptions options;
+    options.workerCount = 1;
+    options.queriesPerSecond = 4;
+    options.queryBurst = 1;
+    SessionScheduler scheduler(options);
+
+    Assert::AreEqual(0LL, static_cast<long long>(scheduler.ReserveQuery().count()), "First query is now.");
+    Assert::AreNear(250, static_cast<double>(scheduler.ReserveQuery().count()), 5, "Second waits a quarter second.");
+    Assert::AreNear(500, static_cast<double>(scheduler.ReserveQuery().count()), 5, "Third waits half a second.");
+}
+
+/// <summary>
+/// Test the trigger delay stays within the jitter.
+/// </summary>
+TEST_METHOD(TriggerDelayWithinJitter)
+{
+    SchedulerOptions options;
+    options.workerCount = 1;
+    options.triggerJitter = std::chrono::milliseconds(50);
+    SessionScheduler scheduler(options);
+
+    bool varies = false;
+    std::chrono::milliseconds first = scheduler.TriggerDelay();
+    for (int index = 0; index < 100; index++)
+    {
+        std::chrono::milliseconds delay = scheduler.TriggerDelay();
+        Assert::IsTrue(delay.count() >= 0 && delay.count() <= 50, "Delay is within the jitter.");
+        varies = varies || (delay != first);
+    }
+
+    Assert::IsTrue(varies, "Delay is random.");
+
+    options.triggerJitter = std::chrono::milliseconds(0);
+    SessionScheduler unjittered(options);
+    Assert::AreEqual(0LL, static_cast<long long>(unjittered.TriggerDelay().count()), "No jitter, no delay.");
+}
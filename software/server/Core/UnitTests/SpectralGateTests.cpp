@@ -0,0 +1,165 @@
+//-----------------------------------------------------------------------
+// <copyright file="SpectralGateTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "TestAudio.h"
+#include "LandmarkIndex.h"
+#include "SpectralGate.h"
+#include <cmath>
+#include <vector>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    // Tape hiss: white noise, the same in every channel.
+    std::vector<float> AddHiss(const std::vector<float>& samples, uint16_t channelCount, float level, uint32_t seed)
+    {
+        std::vector<float> hissy(samples);
+        uint32_t state = seed;
+        for (size_t index = 0; index < hissy.size(); index += channelCount)
+        {
+            state = state * 1664525u + 1013904223u;
+            float hiss = level * (static_cast<float>(state >> 8) / (1 << 23) - 1.0f);
+            for (uint16_t channel = 0; channel < channelCount; channel++)
+            {
+                hissy[index + channel] += hiss;
+            }
+        }
+
+        return hissy;
+    }
+
+    double Rms(const float* samples, size_t count)
+    {
+        double sum = 0;
+        for (size_t index = 0; index < count; index++)
+        {
+            sum += static_cast<double>(samples[index]) * samples[index];
+        }
+
+        return std::sqrt(sum / count);
+    }
+
+    // Gate a second of hiss as a gap, then the audio after it, and return the gated audio.
+    std::vector<float> GateAfterGap(SpectralGate& gate, const std::vector<float>& audio, uint16_t channelCount, float hissLevel)
+    {
+        std::vector<float> gap = AddHiss(std::vector<float>(44100 * channelCount, 0.0f), channelCount, hissLevel, 5);
+        std::vector<float> output(gap.size());
+        gate.ProcessSamples(gap.data(), gap.size(), true, output.data());
+
+        // Flush the audio out past the latency.
+        std::vector<float> input(audio);
+        input.resize(audio.size() + SpectralGate::Latency() * channelCount, 0.0f);
+        output.resize(input.size());
+        gate.ProcessSamples(input.data(), input.size(), false, output.data());
+        return std::vector<float>(output.begin() + SpectralGate::Latency() * channelCount, output.end());
+    }
+}
+
+/// <summary>
+/// Test the format must be one it can gate.
+/// </summary>
+TEST_METHOD(InvalidFormat)
+{
+    Assert::ThrowsException<std::invalid_argument>([] { SpectralGate gate(0, 2); }, "No rate.");
+    Assert::ThrowsException<std::invalid_argument>([] { SpectralGate gate(44100, 0); }, "No channels.");
+    Assert::ThrowsException<std::invalid_argument>([] { SpectralGate gate(44100, 2, std::make_shared<NoiseProfile>(10)); }, "Profile of other frames.");
+}
+
+/// <summary>
+/// Test audio passes through, late by the latency, until the noise is learned.
+/// </summary>
+TEST_METHOD(PassesThroughUntilLearned)
+{
+    std::vector<float> music = CreateTestMusic(1, 0, 1, 44100, 2);
+    SpectralGate gate(44100, 2);
+    std::vector<float> output(music.size());
+
+    // In odd chunks, so hops span buffers.
+    for (size_t offset = 0; offset < music.size(); offset += 1001)
+    {
+        size_t size = std::min(static_cast<size_t>(1001), music.size() - offset);
+        gate.ProcessSamples(music.data() + offset, size, false, output.data() + offset);
+    }
+
+    size_t latency = SpectralGate::Latency() * 2;
+    double error = 0;
+    for (size_t index = latency; index < music.size(); index++)
+    {
+        error = std::max(error, static_cast<double>(std::fabs(output[index] - music[index - latency])));
+    }
+
+    Assert::IsTrue(error < 1e-4, "Output is the input, delayed.");
+    Assert::AreEqual(static_cast<uint32_t>(0), gate.Profile()->FrameCount(), "Nothing learned outside a gap.");
+}
+
+/// <summary>
+/// Test hiss heard in a gap is taken out of the audio after it.
+/// </summary>
+TEST_METHOD(RemovesHiss)
+{
+    std::vector<float> silence(44100 * 2 * 2, 0.0f);
+    std::vector<float> hiss = AddHiss(silence, 2, 0.02f, 9);
+    SpectralGate gate(44100, 2);
+    std::vector<float> gated = GateAfterGap(gate, hiss, 2, 0.02f);
+
+    Assert::IsTrue(gate.Profile()->FrameCount() >= NoiseProfile::MinimumFrames, "Gap is learned.");
+    double before = Rms(hiss.data(), hiss.size());
+    double after = Rms(gated.data(), gated.size());
+    Assert::IsTrue(after < before * 0.2, "Hiss is down by more than 14dB.");
+}
+
+/// <summary>
+/// Test music under hiss keeps its level and matches better once gated.
+/// </summary>
+TEST_METHOD(ImprovesMatch)
+{
+    LandmarkIndex index;
+    std::vector<float> track = CreateTestMusic(20, 0, 20, 44100, 2);
+    TrackInfo info = {};
+    info.identifier = "20";
+    index.AddTrack(info, LandmarkFingerprinter::Fingerprint(track.data(), track.size(), 44100, 2));
+
+    std::vector<float> music = CreateTestMusic(20, 5, 8, 44100, 2);
+    std::vector<float> hissy = AddHiss(music, 2, 0.15f, 3);
+    SpectralGate gate(44100, 2);
+    std::vector<float> gated = GateAfterGap(gate, hissy, 2, 0.15f);
+
+    Assert::AreNear(Rms(music.data(), music.size()), Rms(gated.data(), gated.size()), Rms(music.data(), music.size()) * 0.3, "Music keeps its level.");
+
+    LandmarkMatch noisyMatch = {};
+    LandmarkMatch gatedMatch = {};
+    index.Match(LandmarkFingerprinter::Fingerprint(hissy.data(), hissy.size(), 44100, 2), 1, noisyMatch);
+    Assert::IsTrue(index.Match(LandmarkFingerprinter::Fingerprint(gated.data(), gated.size(), 44100, 2), LandmarkIndex::DefaultMinimumScore, gatedMatch), "Gated music matches.");
+    Assert::IsTrue(gatedMatch.score > noisyMatch.score, "More landmarks agree once gated.");
+}
+
+/// <summary>
+/// Test gates sharing a profile gate by what any of them learned.
+/// </summary>
+TEST_METHOD(SharesProfile)
+{
+    std::shared_ptr<NoiseProfile> profile = std::make_shared<NoiseProfile>(SpectralGate::BinCount());
+    SpectralGate learner(48000, 1, profile);
+    SpectralGate other(44100, 2, profile);
+    Assert::IsTrue(learner.Profile() == other.Profile(), "Same profile.");
+
+    std::vector<float> gap = AddHiss(std::vector<float>(48000, 0.0f), 1, 0.02f, 5);
+    std::vector<float> output(gap.size());
+    learner.ProcessSamples(gap.data(), gap.size(), true, output.data());
+
+    std::vector<float> learned;
+    Assert::IsTrue(profile->Get(learned), "Profile is learned by one gate.");
+
+    std::vector<float> hiss = AddHiss(std::vector<float>(44100 * 2 * 2, 0.0f), 2, 0.02f, 9);
+    hiss.resize(hiss.size() + SpectralGate::Latency() * 2, 0.0f);
+    output.resize(hiss.size());
+    other.ProcessSamples(hiss.data(), hiss.size(), false, output.data());
+    size_t latency = SpectralGate::Latency() * 2;
+    Assert::IsTrue(Rms(output.data() + latency, output.size() - latency) < Rms(hiss.data(), hiss.size() - latency) * 0.2, "Other gate takes the hiss out.");
+}
@@ -0,0 +1,125 @@
+//-----------------------------------------------------------------------
+// <copyright file="SpeedEstimatorTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "TestAudio.h"
+#include "LandmarkIndex.h"
+#include "SpeedEstimator.h"
+#include <cmath>
+#include <sstream>
+#include <string>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    // A catalog of three 30 second tracks, seeded 20, 21 and 22.
+    LandmarkCatalog CreateCatalog()
+    {
+        LandmarkIndex index;
+        for (uint32_t seed = 20; seed < 23; seed++)
+        {
+            std::vector<float> music = CreateTestMusic(seed, 0, 30, 44100, 1);
+            TrackInfo track;
+            track.identifier = std::to_string(seed);
+            track.duration = 30000;
+            index.AddTrack(track, LandmarkFingerprinter::Fingerprint(music.data(), music.size(), 44100, 1));
+        }
+
+        std::stringstream stream;
+        index.Save(stream);
+        std::string bytes = stream.str();
+        return LandmarkCatalog(std::vector<uint8_t>(bytes.begin(), bytes.end()));
+    }
+}
+
+/// <summary>
+/// Test the speed of tuned music is read from how far its peaks are off the semitones.
+/// </summary>
+TEST_METHOD(EstimatesFromTuning)
+{
+    double speeds[] = { 1.0, 1.025, 0.975 };
+    for (double speed : speeds)
+    {
+        std::vector<float> music = CreateTestMusic(5, 2, 8, 48000, 2, speed, true);
+        SpeedEstimate estimate = EstimateSpeedFromTuning(music.data(), music.size(), 48000, 2);
+        Assert::AreNear(speed, estimate.speed, 0.003, "Speed from the tuning.");
+        Assert::IsTrue(estimate.confidence > 0.5, "Confident of tuned music.");
+    }
+}
+
+/// <summary>
+/// Test music which isn't tuned, or silence, gives no confident estimate.
+/// </summary>
+TEST_METHOD(UntunedIsNotConfident)
+{
+    std::vector<float> music = CreateTestMusic(5, 2, 8, 48000, 2);
+    Assert::IsTrue(EstimateSpeedFromTuning(music.data(), music.size(), 48000, 2).confidence < 0.5, "Not confident of untuned music.");
+
+    std::vector<float> silence(48000 * 2, 0.0f);
+    SpeedEstimate estimate = EstimateSpeedFromTuning(silence.data(), silence.size(), 48000, 1);
+    Assert::AreEqual(0.0, estimate.confidence, "No confidence in silence.");
+    Assert::AreEqual(1.0, estimate.speed, "Silence is at speed.");
+}
+
+/// <summary>
+/// Test correcting a speed moves a tone back to its pitch, on every channel.
+/// </summary>
+TEST_METHOD(CorrectsTone)
+{
+    const double Pi = 3.14159265358979323846;
+    const uint32_t SampleRate = 8000;
+    std::vector<float> tone(SampleRate * 2 * 2);
+    for (size_t frame = 0; frame < tone.size() / 2; frame++)
+    {
+        tone[frame * 2] = static_cast<float>(std::sin(2 * Pi * 1030 * frame / SampleRate));
+        tone[frame * 2 + 1] = -tone[frame * 2];
+    }
+
+    std::vector<float> corrected;
+    CorrectSpeed(tone.data(), tone.size(), 2, 1.03, corrected);
+    Assert::AreNear(1.03 * tone.size(), static_cast<double>(corrected.size()), 4.0, "Longer by the speed.");
+
+    // Count the rising zero crossings of the left channel: 1000 a second.
+    size_t crossings = 0;
+    for (size_t frame = 1; frame < corrected.size() / 2; frame++)
+    {
+        crossings += (corrected[(frame - 1) * 2] < 0 && corrected[frame * 2] >= 0) ? 1 : 0;
+        Assert::AreNear(-corrected[frame * 2], static_cast<double>(corrected[frame * 2 + 1]), 1e-6, "Channels are corrected alike.");
+    }
+
+    double seconds = static_cast<double>(corrected.size() / 2) / SampleRate;
+    Assert::AreNear(1000.0, crossings / seconds, 2.0, "Back at pitch.");
+}
+
+/// <summary>
+/// Test an excerpt played fast only matches once searched at its speed, on a pool or not.
+/// </summary>
+TEST_METHOD(MatchesAtSpeed)
+{
+    LandmarkCatalog catalog = CreateCatalog();
+    std::vector<float> excerpt = CreateTestMusic(21, 10, 8, 48000, 2, 1.04);
+
+    LandmarkMatch match = {};
+    std::vector<Landmark> nominal = LandmarkFingerprinter::Fingerprint(excerpt.data(), excerpt.size(), 48000, 2);
+    Assert::IsFalse(catalog.Match(nominal, LandmarkIndex::DefaultMinimumScore, match), "Too fast to match as it is.");
+
+    WorkStealingPool pool(4);
+    WorkStealingPool* pools[] = { nullptr, &pool };
+    for (WorkStealingPool* searchPool : pools)
+    {
+        double speed = 0;
+        Assert::IsTrue(MatchAtSpeeds(catalog, excerpt.data(), excerpt.size(), 48000, 2, 0.06, 0.005, LandmarkIndex::DefaultMinimumScore, searchPool, match, speed), "Matches at some speed.");
+        Assert::AreEqual(std::string("21"), catalog.Track(match.track).identifier, "Matches its track.");
+        Assert::AreNear(1.04, speed, 0.0051, "At its speed.");
+        Assert::AreNear(10.0, match.offset * LandmarkFingerprinter::FrameSeconds(), 0.1, "Where it starts.");
+    }
+
+    std::vector<float> unknown = CreateTestMusic(99, 0, 8, 48000, 2, 1.04);
+    double speed = 0;
+    Assert::IsFalse(MatchAtSpeeds(catalog, unknown.data(), unknown.size(), 48000, 2, 0.06, 0.005, LandmarkIndex::DefaultMinimumScore, &pool, match, speed), "Unknown music matches at no speed.");
+}
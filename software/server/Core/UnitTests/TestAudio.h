@@ -0,0 +1,76 @@
+//-----------------------------------------------------------------------
+// <copyright file="TestAudio.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core { namespace UnitTests
+{
+    ///
+    /// A repeatable stand-in for music: a plucked quarter-second note at a time, each a few partials
+    /// picked by the seed, under a little noise. The same seed gives the same piece at any rate, so a recording
+    /// at one rate can be matched against a reference at another. Tuned music has its partials on the
+    /// semitones of A440, and a speed plays the piece that much fast, from the same start.
+    ///
+    inline std::vector<float> CreateTestMusic(
+        uint32_t seed,
+        double startSeconds,
+        double seconds,
+        uint32_t sampleRate,
+        uint16_t channelCount,
+        double speed = 1.0,
+        bool tuned = false)
+    {
+        const double Pi = 3.14159265358979323846;
+        const double NoteSeconds = 0.25;
+        const double AttackSeconds = 0.005;
+        const double DecaySeconds = 0.08;
+        const int Partials = 3;
+
+        // The notes, from the start of the piece, so an excerpt has the same notes as the whole.
+        size_t noteCount = static_cast<size_t>((startSeconds + seconds * speed) / NoteSeconds) + 1;
+        std::vector<double> frequencies(noteCount * Partials);
+        uint32_t state = seed * 2654435761u + 1;
+        for (double& frequency : frequencies)
+        {
+            state = state * 1664525u + 1013904223u;
+            frequency = 300.0 + (state >> 8) % 3200;
+            if (tuned)
+            {
+                frequency = 440.0 * std::pow(2.0, std::round(12 * std::log2(frequency / 440.0)) / 12);
+            }
+        }
+
+        size_t frames = static_cast<size_t>(seconds * sampleRate);
+        std::vector<float> samples(frames * channelCount);
+        uint32_t noise = seed + 7;
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            double time = startSeconds + speed * frame / sampleRate;
+            size_t note = static_cast<size_t>(time / NoteSeconds);
+            double sinceNote = time - note * NoteSeconds;
+            double envelope = std::min(sinceNote / AttackSeconds, 1.0) * std::exp(-sinceNote / DecaySeconds);
+            double value = 0;
+            for (int partial = 0; partial < Partials; partial++)
+            {
+                value += 0.2 * envelope * std::sin(2 * Pi * frequencies[note * Partials + partial] * time);
+            }
+
+            noise = noise * 1664525u + 1013904223u;
+            value += 0.01 * (static_cast<double>(noise >> 8) / (1 << 24) - 0.5);
+            for (uint16_t channel = 0; channel < channelCount; channel++)
+            {
+                samples[frame * channelCount + channel] = static_cast<float>(value);
+            }
+        }
+
+        return samples;
+    }
+} } }
@@ -0,0 +1,174 @@
+//-----------------------------------------------------------------------
+// <copyright file="TestHarness.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+///
+/// Declare a test method; it is run by RunTests, in the order declared.
+///
+#define TEST_METHOD(name) \
+    static void name(); \
+    static const ::CrazyGiraffe::Core::UnitTests::TestRegistration name##Registration(#name, name); \
+    static void name()
+
+namespace CrazyGiraffe { namespace Core { namespace UnitTests
+{
+    ///
+    /// Thrown when an assertion fails.
+    ///
+    class AssertFailedException : public std::runtime_error
+    {
+    public:
+        explicit AssertFailedException(const std::string& message)
+            : std::runtime_error(message)
+        {
+        }
+    };
+
+    ///
+    /// The test methods of the executable.
+    ///
+    inline std::vector<std::pair<const char*, void (*)()>>& TestMethods()
+    {
+        static std::vector<std::pair<const char*, void (*)()>> s_methods;
+        return s_methods;
+    }
+
+    struct TestRegistration
+    {
+        TestRegistration(const char* name, void (*method)())
+        {
+            TestMethods().emplace_back(name, method);
+        }
+    };
+
+    ///
+    /// Assertions, as Microsoft.VisualStudio.TestTools.UnitTesting.Assert; each takes a message.
+    ///
+    class Assert
+    {
+    public:
+        static void IsTrue(bool condition, const std::string& message)
+        {
+            if (!condition)
+            {
+                throw AssertFailedException("Assert.IsTrue failed. " + message);
+            }
+        }
+
+        static void IsFalse(bool condition, const std::string& message)
+        {
+            if (condition)
+            {
+                throw AssertFailedException("Assert.IsFalse failed. " + message);
+            }
+        }
+
+        template <typename TExpected, typename TActual>
+        static void AreEqual(const TExpected& expected, const TActual& actual, const std::string& message)
+        {
+            if (!(expected == actual))
+            {
+                std::ostringstream text;
+                text << "Assert.AreEqual failed. Expected:<" << Printable(expected) << ">. Actual:<" << Printable(actual) << ">. " << message;
+                throw AssertFailedException(text.str());
+            }
+        }
+
+        static void AreNear(double expected, double actual, double tolerance, const std::string& message)
+        {
+            if (!(std::fabs(expected - actual) <= tolerance))
+            {
+                std::ostringstream text;
+                text << "Assert.AreNear failed. Expected:<" << expected << "> +/- " << tolerance << ". Actual:<" << actual << ">. " << message;
+                throw AssertFailedException(text.str());
+            }
+        }
+
+        template <typename TException>
+        static void ThrowsException(const std::function<void()>& action, const std::string& message)
+        {
+            try
+            {
+                action();
+            }
+            catch (const TException&)
+            {
+                return;
+            }
+
+            throw AssertFailedException("Assert.ThrowsException failed. " + message);
+        }
+
+    private:
+        template <typename T, typename = void>
+        struct IsStreamable : std::false_type
+        {
+        };
+
+        template <typename T>
+        struct IsStreamable<T, decltype(void(std::declval<std::ostream&>() << std::declval<const T&>()))> : std::true_type
+        {
+        };
+
+        template <typename T>
+        static std::string Printable(const T& value)
+        {
+            if constexpr (std::is_enum<T>::value)
+            {
+                return std::to_string(static_cast<long long>(value));
+            }
+            else if constexpr (std::is_same<T, unsigned char>::value || std::is_same<T, signed char>::value)
+            {
+                return std::to_string(static_cast<int>(value));
+            }
+            else if constexpr (IsStreamable<T>::value)
+            {
+                std::ostringstream text;
+                text << value;
+                return text.str();
+            }
+            else
+            {
+                return "?";
+            }
+        }
+    };
+
+    ///
+    /// Run every test method; returns the exit code for ctest.
+    ///
+    inline int RunTests()
+    {
+        int failed = 0;
+        for (const std::pair<const char*, void (*)()>& method : TestMethods())
+        {
+            try
+            {
+                method.second();
+                printf("Passed %s\n", method.first);
+            }
+            catch (const std::exception& ex)
+            {
+                printf("Failed %s: %s\n", method.first, ex.what());
+                failed++;
+            }
+        }
+
+        printf("%d of %d tests failed\n", failed, static_cast<int>(TestMethods().size()));
+        return (failed == 0) ? 0 : 1;
+    }
+} } }
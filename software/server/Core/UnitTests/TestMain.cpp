@@ -0,0 +1,12 @@
+//-----------------------------------------------------------------------
+// <copyright file="TestMain.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+
+int main()
+{
+    return CrazyGiraffe::Core::UnitTests::RunTests();
+}
@@ -0,0 +1,145 @@
+//-----------------------------------------------------------------------
+// <copyright file="WavFormatTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "WavFormat.h"
+#include <cstring>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+/// <summary>
+/// Test the header is the canonical 44 bytes.
+/// </summary>
+TEST_METHOD(WriteHeader)
+{
+    AudioFormat format = { 44100, 2, 16, SampleType::Pcm };
+    uint8_t data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    std::vector<uint8_t> file = CreateWavFile(format, data, sizeof(data));
+
+    Assert::AreEqual(WavHeaderSize + sizeof(data), file.size(), "Header plus data.");
+    Assert::IsTrue(memcmp(file.data(), "RIFF", 4) == 0, "ChunkID is RIFF.");
+    Assert::AreEqual(36 + 8, file[4], "ChunkSize is 36 plus the data.");
+    Assert::IsTrue(memcmp(file.data() + 8, "WAVEfmt ", 8) == 0, "Format is WAVE.");
+    Assert::AreEqual(1, file[20], "AudioFormat is PCM.");
+    Assert::AreEqual(2, file[22], "NumChannels is 2.");
+    Assert::AreEqual(44100, file[24] | (file[25] << 8), "SampleRate is 44100.");
+    Assert::AreEqual(176400, file[28] | (file[29] << 8) | (file[30] << 16), "ByteRate is 176400.");
+    Assert::AreEqual(4, file[32], "BlockAlign is 4.");
+    Assert::AreEqual(16, file[34], "BitsPerSample is 16.");
+    Assert::IsTrue(memcmp(file.data() + 36, "data", 4) == 0, "Subchunk2ID is data.");
+    Assert::AreEqual(8, file[40], "Subchunk2Size is 8.");
+    Assert::IsTrue(memcmp(file.data() + 44, data, sizeof(data)) == 0, "Data follows the header.");
+}
+
+/// <summary>
+/// Test a written header reads back, past an extra chunk.
+/// </summary>
+TEST_METHOD(ReadHeaderSkipsChunks)
+{
+    AudioFormat format = { 8000, 1, 16, SampleType::Pcm };
+    uint8_t data[6] = { 1, 2, 3, 4, 5, 6 };
+    std::vector<uint8_t> file = CreateWavFile(format, data, sizeof(data));
+
+    // Insert an odd-sized LIST chunk before data; it is padded to even.
+    uint8_t list[] = { 'L', 'I', 'S', 'T', 3, 0, 0, 0, 'a', 'b', 'c', 0 };
+    file.insert(file.begin() + 36, list, list + sizeof(list));
+
+    WavDataChunk chunk = {};
+    Assert::IsTrue(ReadWavHeader(file.data(), file.size(), chunk), "File is read.");
+    Assert::AreEqual(8000u, chunk.format.sampleRate, "SampleRate is read.");
+    Assert::AreEqual(1, chunk.format.channelCount, "NumChannels is read.");
+    Assert::AreEqual(16, chunk.format.bitsPerSample, "BitsPerSample is read.");
+    Assert::AreEqual(WavHeaderSize + sizeof(list), chunk.offset, "Data is after the LIST chunk.");
+    Assert::AreEqual(sizeof(data), chunk.size, "Data size is read.");
+}
+
+/// <summary>
+/// Test a data chunk still being written is cut to whole frames.
+/// </summary>
+TEST_METHOD(ReadHeaderTruncated)
+{
+    AudioFormat format = { 8000, 2, 16, SampleType::Pcm };
+    uint8_t data[16] = { 0 };
+    std::vector<uint8_t> file = CreateWavFile(format, data, sizeof(data));
+    file.resize(WavHeaderSize + 6);
+
+    WavDataChunk chunk = {};
+    Assert::IsTrue(ReadWavHeader(file.data(), file.size(), chunk), "File is read.");
+    Assert::AreEqual(static_cast<size_t>(4), chunk.size, "Size is one whole frame.");
+}
+
+/// <summary>
+/// Test other files are rejected.
+/// </summary>
+TEST_METHOD(ReadHeaderInvalid)
+{
+    const char text[] = "RIFF\x04\x00\x00\x00JUNKJUNK";
+    WavDataChunk chunk = {};
+    Assert::IsFalse(ReadWavHeader(reinterpret_cast<const uint8_t*>(text), sizeof(text) - 1, chunk), "Not a WAV file.");
+    Assert::IsFalse(ReadWavHeader(nullptr, 0, chunk), "No file.");
+}
+
+/// <summary>
+/// Test a header framed into a reserved prefix makes the same file as a copy, without moving the samples.
+/// </summary>
+TEST_METHOD(FrameInPlace)
+{
+    AudioFormat format = { 8000, 1, 16, SampleType::Pcm };
+    uint8_t data[6] = { 1, 2, 3, 4, 5, 6 };
+    std::vector<uint8_t> file(WavHeaderSize + sizeof(data));
+    memcpy(file.data() + WavHeaderSize, data, sizeof(data));
+    FrameWavFile(format, file.data(), file.size());
+
+    Assert::IsTrue(file == CreateWavFile(format, data, sizeof(data)), "Same as a copied file.");
+    Assert::ThrowsException<std::invalid_argument>([&file, &format] { FrameWavFile(format, file.data(), WavHeaderSize - 1); }, "No room for the header.");
+}
+
+/// <summary>
+/// Test the reader converts the samples a block at a time, and seeks.
+/// </summary>
+TEST_METHOD(ReaderStreamsBlocks)
+{
+    AudioFormat format = { 8000, 2, 16, SampleType::Pcm };
+    std::vector<uint8_t> data;
+    for (int16_t value = -500; value < 500; value += 100)
+    {
+        data.push_back(static_cast<uint8_t>(value));
+        data.push_back(static_cast<uint8_t>(static_cast<uint16_t>(value) >> 8));
+    }
+
+    std::vector<uint8_t> file = CreateWavFile(format, data.data(), data.size());
+    WavReader reader(file.data(), file.size());
+    Assert::AreEqual(8000u, reader.Format().sampleRate, "Format is read.");
+    Assert::AreEqual(static_cast<size_t>(5), reader.FrameCount(), "Five frames.");
+
+    float samples[6] = {};
+    Assert::AreEqual(static_cast<size_t>(3), reader.Read(samples, 3), "A block of three.");
+    Assert::AreEqual(-500.0f / 32768, samples[0], "First sample.");
+    Assert::AreEqual(0.0f, samples[5], "Last of the block.");
+    Assert::AreEqual(static_cast<size_t>(2), reader.Read(samples, 3), "What is left.");
+    Assert::AreEqual(400.0f / 32768, samples[3], "Last sample.");
+    Assert::AreEqual(static_cast<size_t>(0), reader.Read(samples, 3), "Nothing at the end.");
+
+    reader.Seek(4);
+    Assert::AreEqual(static_cast<size_t>(4), reader.Position(), "Seeks.");
+    Assert::AreEqual(static_cast<size_t>(1), reader.Read(samples, 3), "Reads from the frame sought.");
+    Assert::AreEqual(300.0f / 32768, samples[0], "Sample after the seek.");
+}
+
+/// <summary>
+/// Test the reader rejects files it can't convert.
+/// </summary>
+TEST_METHOD(ReaderInvalid)
+{
+    const char text[] = "RIFF\x04\x00\x00\x00JUNKJUNK";
+    Assert::ThrowsException<std::runtime_error>([&text] { WavReader reader(reinterpret_cast<const uint8_t*>(text), sizeof(text) - 1); }, "Not a WAV file.");
+
+    AudioFormat format = { 8000, 1, 64, SampleType::Float };
+    uint8_t data[8] = {};
+    std::vector<uint8_t> file = CreateWavFile(format, data, sizeof(data));
+    Assert::ThrowsException<std::runtime_error>([&file] { WavReader reader(file.data(), file.size()); }, "Doubles aren't read.");
+}
@@ -0,0 +1,215 @@
+//-----------------------------------------------------------------------
+// <copyright file="WavReplayTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "WavReplay.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    // Write a WAV file of 16-bit samples counting up, so every block is different.
+    std::string WriteCounting(const std::string& name, uint32_t sampleRate, uint16_t channelCount, double seconds)
+    {
+        AudioFormat format = { sampleRate, channelCount, 16, SampleType::Pcm };
+        size_t sampleCount = static_cast<size_t>(sampleRate * seconds) * channelCount;
+        std::vector<uint8_t> file(WavHeaderSize + sampleCount * 2);
+        for (size_t index = 0; index < sampleCount; index++)
+        {
+            file[WavHeaderSize + index * 2] = static_cast<uint8_t>(index);
+            file[WavHeaderSize + index * 2 + 1] = static_cast<uint8_t>(index >> 8);
+        }
+
+        FrameWavFile(format, file.data(), file.size());
+        std::string path = name + ".wav";
+        FILE* output = fopen(path.c_str(), "wb");
+        fwrite(file.data(), 1, file.size(), output);
+        fclose(output);
+        return path;
+    }
+
+    std::vector<uint8_t> ReadSamples(const std::string& path)
+    {
+        MappedFile file(path);
+        WavDataChunk chunk = {};
+        ReadWavHeader(file.Data(), file.Size(), chunk);
+        return std::vector<uint8_t>(file.Data() + chunk.offset, file.Data() + chunk.offset + chunk.size);
+    }
+}
+
+/// <summary>
+/// Test the speed, blocks and files must be ones it can replay.
+/// </summary>
+TEST_METHOD(InvalidArguments)
+{
+    Assert::ThrowsException<std::invalid_argument>([] { WavReplay replay(-1); }, "Negative speed.");
+    Assert::ThrowsException<std::invalid_argument>([] { WavReplay replay(1, 0); }, "Empty blocks.");
+
+    FILE* output = fopen("ReplayText.wav", "wb");
+    fputs("not a WAV file", output);
+    fclose(output);
+    WavReplay replay(0);
+    Assert::ThrowsException<std::runtime_error>([&replay] { replay.AddFile("ReplayText.wav"); }, "Not a WAV file.");
+    Assert::ThrowsException<std::runtime_error>([&replay] { replay.AddFile("ReplayMissing.wav"); }, "No file.");
+    Assert::AreEqual(static_cast<size_t>(0), replay.FileCount(), "Nothing added.");
+    remove("ReplayText.wav");
+}
+
+/// <summary>
+/// Test a file is handed out whole, in 10ms blocks.
+/// </summary>
+TEST_METHOD(ReplaysWholeFile)
+{
+    std::string path = WriteCounting("ReplayWhole", 44100, 2, 1.005);
+    WavReplay replay(0);
+    Assert::AreEqual(static_cast<size_t>(0), replay.AddFile(path), "First file.");
+    Assert::AreEqual(44100u, replay.Format(0).sampleRate, "Format is read.");
+
+    std::vector<uint8_t> replayed;
+    std::vector<size_t> sizes;
+    replay.Run([&replayed, &sizes](size_t, const uint8_t* data, size_t size)
+        {
+            replayed.insert(replayed.end(), data, data + size);
+            sizes.push_back(size);
+            return true;
+        });
+
+    Assert::IsTrue(replayed == ReadSamples(path), "Every sample, in order.");
+    Assert::AreEqual(static_cast<size_t>(101), sizes.size(), "A hundred blocks and a part.");
+    Assert::AreEqual(static_cast<size_t>(1764), sizes[0], "10ms of CD audio.");
+    Assert::AreEqual(static_cast<size_t>(220 * 4), sizes.back(), "The rest.");
+    remove(path.c_str());
+}
+
+/// <summary>
+/// Test files at different rates are interleaved by the time of their blocks, and each can be stopped.
+/// </summary>
+TEST_METHOD(InterleavesFiles)
+{
+    std::string first = WriteCounting("ReplayFirst", 44100, 2, 0.5);
+    std::string second = WriteCounting("ReplaySecond", 8000, 1, 1);
+    WavReplay replay(0, 20);
+    replay.AddFile(first);
+    replay.AddFile(second);
+
+    std::vector<std::pair<size_t, double>> blocks;
+    double times[2] = { 0, 0 };
+    replay.Run([&blocks, &times, &replay](size_t file, const uint8_t*, size_t size)
+        {
+            const AudioFormat& format = replay.Format(file);
+            blocks.emplace_back(file, times[file]);
+            times[file] += static_cast<double>(size) / format.BytesPerSecond();
+            return file != 1 || blocks.size() < 40;
+        });
+
+    for (size_t index = 1; index < blocks.size(); index++)
+    {
+        Assert::IsTrue(blocks[index - 1].second <= blocks[index].second, "Blocks in time order.");
+    }
+
+    Assert::AreNear(0.5, times[0], 1e-9, "The first file plays through.");
+    Assert::IsTrue(times[1] < 0.5, "The second file stops when asked.");
+    remove(first.c_str());
+    remove(second.c_str());
+}
+
+/// <summary>
+/// Test a paced replay takes the time of the audio over the speed, hands out the same blocks, and stops.
+/// </summary>
+TEST_METHOD(PacedReplay)
+{
+    std::string path = WriteCounting("ReplayPaced", 8000, 1, 1);
+    std::vector<uint8_t> fast;
+    WavReplay fastReplay(0);
+    fastReplay.AddFile(path);
+    fastReplay.Run([&fast](size_t, const uint8_t* data, size_t size)
+        {
+            fast.insert(fast.end(), data, data + size);
+            return true;
+        });
+
+    // The last block is due at 0.99s of audio, 99ms at ten times the speed.
+    std::vector<uint8_t> paced;
+    WavReplay pacedReplay(10);
+    pacedReplay.AddFile(path);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pacedReplay.Run([&paced](size_t, const uint8_t* data, size_t size)
+        {
+            paced.insert(paced.end(), data, data + size);
+            return true;
+        });
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    Assert::IsTrue(elapsed >= 0.099, "Paced to ten times real time.");
+    Assert::IsTrue(paced == fast, "Same blocks at any speed.");
+
+    // Stopped from the handler, in the first second of a real time run.
+    size_t blockCount = 0;
+    WavReplay realTime(1);
+    realTime.AddFile(path);
+    realTime.Run([&blockCount, &realTime](size_t, const uint8_t*, size_t)
+        {
+            if (++blockCount == 5)
+            {
+                realTime.Stop();
+            }
+
+            return true;
+        });
+
+    Assert::AreEqual(static_cast<size_t>(5), blockCount, "Stops.");
+
+    // A stop stays until reset, so one which comes before the run isn't lost.
+    blockCount = 0;
+    auto count = [&blockCount](size_t, const uint8_t*, size_t)
+        {
+            blockCount++;
+            return true;
+        };
+
+    realTime.Run(count);
+    Assert::AreEqual(static_cast<size_t>(0), blockCount, "Still stopped.");
+
+    WavReplay stoppedFirst(0);
+    stoppedFirst.AddFile(path);
+    stoppedFirst.Stop();
+    stoppedFirst.Run(count);
+    Assert::AreEqual(static_cast<size_t>(0), blockCount, "Stopped before the run.");
+
+    stoppedFirst.Reset();
+    stoppedFirst.Run(count);
+    Assert::AreEqual(static_cast<size_t>(100), blockCount, "Runs again once reset.");
+    remove(path.c_str());
+}
+
+/// <summary>
+/// Test the file added last can be taken back.
+/// </summary>
+TEST_METHOD(RemoveLastFile)
+{
+    std::string path = WriteCounting("ReplayRemove", 8000, 1, 0.1);
+    WavReplay replay(0);
+    replay.AddFile(path);
+    replay.AddFile(path);
+    replay.RemoveLastFile();
+    Assert::AreEqual(static_cast<size_t>(1), replay.FileCount(), "One file left.");
+
+    size_t blockCount = 0;
+    replay.Run([&blockCount](size_t file, const uint8_t*, size_t)
+        {
+            Assert::AreEqual(static_cast<size_t>(0), file, "Only the first file.");
+            blockCount++;
+            return true;
+        });
+
+    Assert::AreEqual(static_cast<size_t>(10), blockCount, "Its blocks.");
+    remove(path.c_str());
+}
@@ -0,0 +1,119 @@
+//-----------------------------------------------------------------------
+// <copyright file="WorkStealingPoolTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "WorkStealingPool.h"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    // Wait for a count, or give up after a few seconds.
+    bool WaitFor(const std::atomic<int>& count, int expected)
+    {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (count < expected && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return count >= expected;
+    }
+}
+
+/// <summary>
+/// Test zero workers means one per core.
+/// </summary>
+TEST_METHOD(DefaultWorkerCount)
+{
+    WorkStealingPool pool(0);
+    Assert::IsTrue(pool.WorkerCount() >= 1, "At least one worker.");
+}
+
+/// <summary>
+/// Test all the work posted runs before the pool goes.
+/// </summary>
+TEST_METHOD(RunsAllWork)
+{
+    std::atomic<int> count(0);
+    {
+        WorkStealingPool pool(4);
+        for (int index = 0; index < 1000; index++)
+        {
+            pool.Post([&count] { count++; });
+        }
+    }
+
+    Assert::AreEqual(1000, count.load(), "All the work ran.");
+}
+
+/// <summary>
+/// Test work posted by work runs, even while the pool is going.
+/// </summary>
+TEST_METHOD(RunsWorkPostedByWork)
+{
+    std::atomic<int> count(0);
+    {
+        WorkStealingPool pool(2);
+        for (int index = 0; index < 10; index++)
+        {
+            pool.Post([&pool, &count]
+                {
+                    for (int child = 0; child < 10; child++)
+                    {
+                        pool.Post([&count] { count++; });
+                    }
+                });
+        }
+    }
+
+    Assert::AreEqual(100, count.load(), "All the work posted by work ran.");
+}
+
+/// <summary>
+/// Test an idle worker steals work queued on a busy one.
+/// </summary>
+TEST_METHOD(IdleWorkerSteals)
+{
+    std::atomic<int> count(0);
+    std::atomic<bool> stolen(false);
+    {
+        WorkStealingPool pool(2);
+
+        // Work posted from a worker goes on its own queue; it only runs while the worker waits if stolen.
+        pool.Post([&pool, &count, &stolen]
+            {
+                for (int index = 0; index < 10; index++)
+                {
+                    pool.Post([&count] { count++; });
+                }
+
+                stolen = WaitFor(count, 10);
+            });
+    }
+
+    Assert::IsTrue(stolen, "The other worker ran the work while its own worker waited.");
+}
+
+/// <summary>
+/// Test work which throws doesn't stop the worker.
+/// </summary>
+TEST_METHOD(WorkWhichThrows)
+{
+    std::atomic<int> count(0);
+    {
+        WorkStealingPool pool(1);
+        pool.Post([] { throw std::runtime_error("failed"); });
+        pool.Post([&count] { count++; });
+    }
+
+    Assert::AreEqual(1, count.load(), "The work after ran.");
+}
@@ -0,0 +1,128 @@
+//-----------------------------------------------------------------------
+// <copyright file="WowFlutterAnalyzerTests.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "TestHarness.h"
+#include "WowFlutterAnalyzer.h"
+#include <cmath>
+#include <functional>
+#include <vector>
+
+using namespace CrazyGiraffe::Core;
+using namespace CrazyGiraffe::Core::UnitTests;
+
+namespace
+{
+    const double Pi = 3.14159265358979323846;
+
+    // A tone played at a speed which changes with time, on every channel.
+    std::vector<float> CreateWarpedTone(double frequency, double seconds, uint32_t sampleRate, uint16_t channelCount, const std::function<double(double)>& speed)
+    {
+        size_t frames = static_cast<size_t>(seconds * sampleRate);
+        std::vector<float> samples(frames * channelCount);
+        double phase = 0;
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            for (uint16_t channel = 0; channel < channelCount; channel++)
+            {
+                samples[frame * channelCount + channel] = static_cast<float>(0.5 * std::sin(phase));
+            }
+
+            phase += 2 * Pi * frequency * speed(static_cast<double>(frame) / sampleRate) / sampleRate;
+            phase = std::fmod(phase, 2 * Pi);
+        }
+
+        return samples;
+    }
+
+    // Analyse audio, returning the reports.
+    std::vector<WowFlutter> Analyse(WowFlutterAnalyzer& analyzer, const std::vector<float>& samples)
+    {
+        std::vector<WowFlutter> reports;
+        analyzer.ProcessSamples(samples.data(), samples.size(), [&reports](const WowFlutter& measured) { reports.push_back(measured); });
+        return reports;
+    }
+}
+
+/// <summary>
+/// Test the format and reference must be ones it can analyse.
+/// </summary>
+TEST_METHOD(InvalidFormat)
+{
+    Assert::ThrowsException<std::invalid_argument>([] { WowFlutterAnalyzer analyzer(0, 2, 3150); }, "No rate.");
+    Assert::ThrowsException<std::invalid_argument>([] { WowFlutterAnalyzer analyzer(48000, 0, 3150); }, "No channels.");
+    Assert::ThrowsException<std::invalid_argument>([] { WowFlutterAnalyzer analyzer(8000, 1, 3150); }, "Reference too near the rate.");
+    Assert::ThrowsException<std::invalid_argument>([] { WowFlutterAnalyzer analyzer(48000, 1, -1); }, "Negative reference.");
+}
+
+/// <summary>
+/// Test a steady tone off its reference is drift, with no wow or flutter, reported at the report rate.
+/// </summary>
+TEST_METHOD(SteadyToneIsDrift)
+{
+    WowFlutterAnalyzer analyzer(48000, 2, 3150);
+    std::vector<WowFlutter> reports = Analyse(analyzer, CreateWarpedTone(3150, 6, 48000, 2, [](double) { return 1.015; }));
+
+    Assert::AreEqual(static_cast<size_t>(6 * WowFlutterAnalyzer::ReportRate), reports.size(), "Reported at the report rate.");
+    const WowFlutter& last = reports.back();
+    Assert::IsTrue(last.locked, "The tone is tracked.");
+    Assert::AreNear(0.015, last.drift, 0.0002, "1.5% fast.");
+    Assert::AreNear(3150 * 1.015, last.frequency, 0.5, "At the tone's frequency.");
+    Assert::AreNear(1 / 1.015, last.correction, 0.0002, "Slow the motor by as much.");
+    Assert::IsTrue(last.wow < 0.0002, "No wow.");
+    Assert::IsTrue(last.flutter < 0.0002, "No flutter.");
+}
+
+/// <summary>
+/// Test a slow warble is wow, and a fast one flutter, each as the RMS of the speed.
+/// </summary>
+TEST_METHOD(SeparatesWowAndFlutter)
+{
+    WowFlutterAnalyzer wowAnalyzer(48000, 1, 3150);
+    std::vector<WowFlutter> wowReports = Analyse(wowAnalyzer, CreateWarpedTone(3150, 12, 48000, 1, [](double time) { return 1 + 0.005 * std::sin(2 * Pi * 1.0 * time); }));
+    const WowFlutter& wow = wowReports.back();
+    Assert::AreNear(0.005 / std::sqrt(2.0), wow.wow, 0.0005, "1Hz warble is wow.");
+    Assert::IsTrue(wow.flutter < wow.wow / 5, "Not flutter.");
+    Assert::AreNear(0.0, wow.drift, 0.001, "Nor drift.");
+
+    WowFlutterAnalyzer flutterAnalyzer(48000, 1, 3150);
+    std::vector<WowFlutter> flutterReports = Analyse(flutterAnalyzer, CreateWarpedTone(3150, 8, 48000, 1, [](double time) { return 1 + 0.002 * std::sin(2 * Pi * 20.0 * time); }));
+    const WowFlutter& flutter = flutterReports.back();
+    Assert::AreNear(0.002 / std::sqrt(2.0), flutter.flutter, 0.0002, "20Hz warble is flutter.");
+    Assert::IsTrue(flutter.wow < flutter.flutter / 5, "Not wow.");
+}
+
+/// <summary>
+/// Test without a reference, the first second is the reference, and a sweep after it is drift.
+/// </summary>
+TEST_METHOD(LearnsReference)
+{
+    WowFlutterAnalyzer analyzer(44100, 2, 0);
+    std::vector<float> sweep = CreateWarpedTone(1000, 10, 44100, 2, [](double time)
+        {
+            return (time < 3) ? 1.0 : (time < 5) ? 1 + 0.01 * (time - 3) / 2 : 1.01;
+        });
+
+    std::vector<WowFlutter> reports = Analyse(analyzer, sweep);
+    Assert::IsFalse(reports.front().locked, "Not locked while learning.");
+    Assert::AreNear(1000.0, analyzer.ReferenceFrequency(), 0.1, "The tone is the reference.");
+    Assert::AreNear(0.0, reports[3 * WowFlutterAnalyzer::ReportRate - 1].drift, 0.0002, "At speed before the sweep.");
+    Assert::AreNear(0.01, reports.back().drift, 0.0002, "1% fast after it.");
+    Assert::AreNear(1 / 1.01, reports.back().correction, 0.0002, "Correction follows.");
+}
+
+/// <summary>
+/// Test silence loses the tone, and the speed is held until it returns.
+/// </summary>
+TEST_METHOD(SilenceUnlocks)
+{
+    WowFlutterAnalyzer analyzer(48000, 1, 3150);
+    Analyse(analyzer, CreateWarpedTone(3150, 4, 48000, 1, [](double) { return 0.99; }));
+    Assert::IsTrue(analyzer.Current().locked, "Locked on the tone.");
+
+    std::vector<WowFlutter> reports = Analyse(analyzer, std::vector<float>(48000, 0.0f));
+    Assert::IsFalse(reports.back().locked, "Lost in silence.");
+    Assert::AreNear(-0.01, reports.back().drift, 0.0005, "Speed is held.");
+}
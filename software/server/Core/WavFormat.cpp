@@ -0,0 +1,213 @@
+//-----------------------------------------------------------------------
+// <copyright file="WavFormat.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "WavFormat.h"
+#include "AudioFrameConverter.h"
+#include <cstring>
+#include <stdexcept>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    const uint16_t WaveFormatPcm = 1;
+    const uint16_t WaveFormatFloat = 3;
+
+    uint8_t* WriteTag(uint8_t* output, const char* tag)
+    {
+        memcpy(output, tag, 4);
+        return output + 4;
+    }
+
+    uint8_t* WriteUInt16(uint8_t* output, uint16_t value)
+    {
+        output[0] = static_cast<uint8_t>(value);
+        output[1] = static_cast<uint8_t>(value >> 8);
+        return output + 2;
+    }
+
+    uint8_t* WriteUInt32(uint8_t* output, uint32_t value)
+    {
+        output[0] = static_cast<uint8_t>(value);
+        output[1] = static_cast<uint8_t>(value >> 8);
+        output[2] = static_cast<uint8_t>(value >> 16);
+        output[3] = static_cast<uint8_t>(value >> 24);
+        return output + 4;
+    }
+
+    uint16_t ReadUInt16(const uint8_t* input)
+    {
+        return static_cast<uint16_t>(input[0] | (input[1] << 8));
+    }
+
+    uint32_t ReadUInt32(const uint8_t* input)
+    {
+        return static_cast<uint32_t>(input[0])
+            | (static_cast<uint32_t>(input[1]) << 8)
+            | (static_cast<uint32_t>(input[2]) << 16)
+            | (static_cast<uint32_t>(input[3]) << 24);
+    }
+}
+
+void CrazyGiraffe::Core::WriteWavHeader(const AudioFormat& format, uint32_t dataSize, uint8_t* header)
+{
+    uint16_t audioFormat = (format.sampleType == SampleType::Float) ? WaveFormatFloat : WaveFormatPcm;
+    uint16_t blockAlign = static_cast<uint16_t>(format.channelCount * format.bitsPerSample / 8);
+    uint32_t byteRate = format.sampleRate * blockAlign;
+
+    // ChunkID, ChunkSize (36 + SubChunk2Size), Format
+    header = WriteTag(header, "RIFF");
+    header = WriteUInt32(header, 36 + dataSize);
+    header = WriteTag(header, "WAVE");
+
+    // Subchunk1ID, Subchunk1Size (16 for PCM), AudioFormat, NumChannels, SampleRate, ByteRate, BlockAlign, BitsPerSample
+    header = WriteTag(header, "fmt ");
+    header = WriteUInt32(header, 16);
+    header = WriteUInt16(header, audioFormat);
+    header = WriteUInt16(header, format.channelCount);
+    header = WriteUInt32(header, format.sampleRate);
+    header = WriteUInt32(header, byteRate);
+    header = WriteUInt16(header, blockAlign);
+    header = WriteUInt16(header, format.bitsPerSample);
+
+    // Subchunk2ID, Subchunk2Size
+    header = WriteTag(header, "data");
+    WriteUInt32(header, dataSize);
+}
+
+std::vector<uint8_t> CrazyGiraffe::Core::CreateWavFile(const AudioFormat& format, const uint8_t* data, size_t dataSize)
+{
+    std::vector<uint8_t> file(WavHeaderSize + dataSize);
+    if (dataSize > 0)
+    {
+        memcpy(file.data() + WavHeaderSize, data, dataSize);
+    }
+
+    FrameWavFile(format, file.data(), file.size());
+    return file;
+}
+
+void CrazyGiraffe::Core::FrameWavFile(const AudioFormat& format, uint8_t* file, size_t fileSize)
+{
+    // The RIFF size counts 36 bytes of the header as well.
+    if (fileSize < WavHeaderSize || fileSize - WavHeaderSize > UINT32_MAX - 36)
+    {
+        throw std::invalid_argument("fileSize");
+    }
+
+    WriteWavHeader(format, static_cast<uint32_t>(fileSize - WavHeaderSize), file);
+}
+
+bool CrazyGiraffe::Core::ReadWavHeader(const uint8_t* file, size_t fileSize, WavDataChunk& chunk)
+{
+    if (file == nullptr || fileSize < 12 || memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0)
+    {
+        return false;
+    }
+
+    bool hasFormat = false;
+    size_t offset = 12;
+    while (offset + 8 <= fileSize)
+    {
+        const uint8_t* chunkHeader = file + offset;
+        uint32_t chunkSize = ReadUInt32(chunkHeader + 4);
+        size_t body = offset + 8;
+
+        if (memcmp(chunkHeader, "fmt ", 4) == 0)
+        {
+            if (chunkSize < 16 || body + 16 > fileSize)
+            {
+                return false;
+            }
+
+            uint16_t audioFormat = ReadUInt16(file + body);
+            if (audioFormat != WaveFormatPcm && audioFormat != WaveFormatFloat)
+            {
+                return false;
+            }
+
+            chunk.format.sampleType = (audioFormat == WaveFormatFloat) ? SampleType::Float : SampleType::Pcm;
+            chunk.format.channelCount = ReadUInt16(file + body + 2);
+            chunk.format.sampleRate = ReadUInt32(file + body + 4);
+            chunk.format.bitsPerSample = ReadUInt16(file + body + 14);
+            hasFormat = chunk.format.channelCount > 0 && chunk.format.bitsPerSample >= 8;
+        }
+        else if (memcmp(chunkHeader, "data", 4) == 0)
+        {
+            if (!hasFormat)
+            {
+                return false;
+            }
+
+            chunk.offset = body;
+            chunk.declaredSize = chunkSize;
+            chunk.size = (chunkSize > fileSize - body) ? (fileSize - body) : chunkSize;
+            chunk.size -= chunk.size % chunk.format.BytesPerFrame();
+            return true;
+        }
+
+        // Chunks are padded to an even size.
+        offset = body + chunkSize + (chunkSize & 1);
+    }
+
+    return false;
+}
+
+WavReader::WavReader(const uint8_t* file, size_t fileSize)
+    : m_data(nullptr)
+    , m_chunk()
+    , m_frameCount(0)
+    , m_position(0)
+{
+    if (!ReadWavHeader(file, fileSize, m_chunk)
+        || (m_chunk.format.sampleType == SampleType::Float && m_chunk.format.bitsPerSample != 32)
+        || m_chunk.format.bitsPerSample > 32
+        || m_chunk.format.bitsPerSample % 8 != 0)
+    {
+        throw std::runtime_error("Not a PCM or float WAV file");
+    }
+
+    m_data = file + m_chunk.offset;
+    m_frameCount = m_chunk.size / m_chunk.format.BytesPerFrame();
+}
+
+const AudioFormat& WavReader::Format() const
+{
+    return m_chunk.format;
+}
+
+size_t WavReader::FrameCount() const
+{
+    return m_frameCount;
+}
+
+size_t WavReader::Position() const
+{
+    return m_position;
+}
+
+void WavReader::Seek(size_t frame)
+{
+    m_position = (frame < m_frameCount) ? frame : m_frameCount;
+}
+
+size_t WavReader::Read(float* samples, size_t frameCount)
+{
+    size_t frames = (m_frameCount - m_position < frameCount) ? (m_frameCount - m_position) : frameCount;
+    size_t count = frames * m_chunk.format.channelCount;
+    const uint8_t* input = m_data + m_position * m_chunk.format.BytesPerFrame();
+    if (m_chunk.format.sampleType == SampleType::Float)
+    {
+        memcpy(samples, input, count * sizeof(float));
+    }
+    else
+    {
+        AudioFrameConverter::ConvertToFloat(input, count, m_chunk.format.bitsPerSample, samples);
+    }
+
+    m_position += frames;
+    return frames;
+}
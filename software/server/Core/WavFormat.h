@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------------
+// <copyright file="WavFormat.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "AudioFormat.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// The size of a canonical RIFF/WAVE header.
+    ///
+    const size_t WavHeaderSize = 44;
+
+    ///
+    /// Where the samples of a WAV file are.
+    ///
+    struct WavDataChunk
+    {
+        AudioFormat format;
+        size_t offset;
+        size_t size;
+
+        // The size in the header, which may run past what was read; a stream which doesn't know its
+        // length gives 0 or 0xFFFFFFFF.
+        uint32_t declaredSize;
+    };
+
+    ///
+    /// Write a canonical 44-byte PCM header for the given format and size of samples.
+    ///
+    void WriteWavHeader(const AudioFormat& format, uint32_t dataSize, uint8_t* header);
+
+    ///
+    /// Create a WAV file holding a copy of the samples.
+    ///
+    std::vector<uint8_t> CreateWavFile(const AudioFormat& format, const uint8_t* data, size_t dataSize);
+
+    ///
+    /// Make a WAV file of a buffer whose samples follow WavHeaderSize bytes kept free for the header,
+    /// by writing the header there, so the samples aren't copied. Throws std::invalid_argument if the
+    /// buffer is shorter than a header or the samples don't fit a WAV file.
+    ///
+    void FrameWavFile(const AudioFormat& format, uint8_t* file, size_t fileSize);
+
+    ///
+    /// Find the format and the samples of a WAV file, skipping chunks other than "fmt " and "data".
+    /// Returns false if it isn't a PCM or float WAV file. A data chunk which runs past the end, as
+    /// it does while a file is still being written, is cut to what is there.
+    ///
+    bool ReadWavHeader(const uint8_t* file, size_t fileSize, WavDataChunk& chunk);
+
+    ///
+    /// Reads the samples of a WAV file in memory, such as a MappedFile, as floats a block at a time, so
+    /// only the pages being read are touched and a long rip is never converted whole.
+    ///
+    class WavReader
+    {
+    public:
+        ///
+        /// Read a file, which must outlive the reader. Throws std::runtime_error if it isn't a PCM or
+        /// 32-bit float WAV file.
+        ///
+        WavReader(const uint8_t* file, size_t fileSize);
+
+        const AudioFormat& Format() const;
+
+        ///
+        /// Get the frames in the file, and the next to be read.
+        ///
+        size_t FrameCount() const;
+        size_t Position() const;
+
+        ///
+        /// Move to a frame; past the end is the end.
+        ///
+        void Seek(size_t frame);
+
+        ///
+        /// Read up to frameCount frames of interleaved samples, -1 to 1, into samples, which must hold
+        /// frameCount frames. Returns the frames read; 0 at the end.
+        ///
+        size_t Read(float* samples, size_t frameCount);
+
+    private:
+        ///
+        /// The samples in the file, and their format.
+        ///
+        const uint8_t* m_data;
+        WavDataChunk m_chunk;
+
+        size_t m_frameCount;
+        size_t m_position;
+    };
+} }
@@ -0,0 +1,137 @@
+//-----------------------------------------------------------------------
+// <copyright file="WavReplay.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "WavReplay.h"
+#include <chrono>
+#include <stdexcept>
+
+using namespace CrazyGiraffe::Core;
+
+WavReplay::WavReplay(double speed, uint32_t blockMilliseconds)
+    : m_speed(speed)
+    , m_blockMilliseconds(blockMilliseconds)
+    , m_sources()
+    , m_lock()
+    , m_stopped()
+    , m_stopping(false)
+{
+    if (!(speed >= 0))
+    {
+        throw std::invalid_argument("speed");
+    }
+
+    if (blockMilliseconds == 0)
+    {
+        throw std::invalid_argument("blockMilliseconds");
+    }
+}
+
+size_t WavReplay::AddFile(const std::string& path)
+{
+    Source source = {};
+    source.file = std::make_unique<MappedFile>(path);
+    if (!ReadWavHeader(source.file->Data(), source.file->Size(), source.chunk) || source.chunk.format.sampleRate == 0)
+    {
+        throw std::runtime_error("not a WAV file: " + path);
+    }
+
+    // Whole frames, at least one.
+    uint64_t frames = static_cast<uint64_t>(source.chunk.format.sampleRate) * m_blockMilliseconds / 1000;
+    source.blockSize = static_cast<size_t>(frames > 0 ? frames : 1) * source.chunk.format.BytesPerFrame();
+    m_sources.push_back(std::move(source));
+    return m_sources.size() - 1;
+}
+
+void WavReplay::RemoveLastFile()
+{
+    if (!m_sources.empty())
+    {
+        m_sources.pop_back();
+    }
+}
+
+size_t WavReplay::FileCount() const
+{
+    return m_sources.size();
+}
+
+const AudioFormat& WavReplay::Format(size_t file) const
+{
+    return m_sources.at(file).chunk.format;
+}
+
+void WavReplay::Run(const BlockHandler& handler)
+{
+    for (Source& source : m_sources)
+    {
+        source.position = 0;
+        source.stopped = false;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (true)
+    {
+        // The block which starts first, in the time of the audio; a tie goes to the file added first.
+        // The frames are compared across rates as whole numbers, so the order is always the same.
+        size_t next = m_sources.size();
+        for (size_t index = 0; index < m_sources.size(); index++)
+        {
+            const Source& source = m_sources[index];
+            if (source.stopped || source.position * source.chunk.format.BytesPerFrame() >= source.chunk.size)
+            {
+                continue;
+            }
+
+            if (next == m_sources.size()
+                || static_cast<uint64_t>(source.position) * m_sources[next].chunk.format.sampleRate
+                    < static_cast<uint64_t>(m_sources[next].position) * source.chunk.format.sampleRate)
+            {
+                next = index;
+            }
+        }
+
+        if (next == m_sources.size())
+        {
+            break;
+        }
+
+        Source& source = m_sources[next];
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            if (m_speed > 0)
+            {
+                double seconds = static_cast<double>(source.position) / source.chunk.format.sampleRate / m_speed;
+                std::chrono::steady_clock::time_point due =
+                    start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+                m_stopped.wait_until(lock, due, [this] { return m_stopping; });
+            }
+
+            if (m_stopping)
+            {
+                break;
+            }
+        }
+
+        uint32_t frameSize = source.chunk.format.BytesPerFrame();
+        size_t offset = source.position * frameSize;
+        size_t size = (source.chunk.size - offset < source.blockSize) ? (source.chunk.size - offset) : source.blockSize;
+        source.stopped = !handler(next, source.file->Data() + source.chunk.offset + offset, size);
+        source.position += size / frameSize;
+    }
+}
+
+void WavReplay::Stop()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_stopping = true;
+    m_stopped.notify_all();
+}
+
+void WavReplay::Reset()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_stopping = false;
+}
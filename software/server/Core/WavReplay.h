@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------
+// <copyright file="WavReplay.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include "MappedFile.h"
+#include "WavFormat.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// Plays WAV files back as if they were being captured, for replaying sessions. Each file is
+    /// mapped and its samples handed out in blocks as they are, with the files interleaved by the time
+    /// of each block. The blocks are paced at a speed: 1 for real time, 100 for a hundred times as
+    /// fast, or 0 for as fast as they are taken. The blocks and their order don't depend on the speed,
+    /// so a fast run replays what a run in real time would.
+    ///
+    class WavReplay
+    {
+    public:
+        ///
+        /// The audio in each block, by default: 10ms, as a capture device delivers it.
+        ///
+        static const uint32_t DefaultBlockMilliseconds = 10;
+
+        ///
+        /// Takes a block of a file's samples, by the index of the file; the block is only valid for
+        /// the call. Returns false to stop replaying that file.
+        ///
+        using BlockHandler = std::function<bool(size_t file, const uint8_t* data, size_t size)>;
+
+        ///
+        /// Create a replay. Throws std::invalid_argument if the speed is negative or the blocks are empty.
+        ///
+        explicit WavReplay(double speed, uint32_t blockMilliseconds = DefaultBlockMilliseconds);
+
+        ///
+        /// Add a file to replay, by its UTF-8 path, and return its index. Throws std::runtime_error if
+        /// it can't be opened or isn't a WAV file.
+        ///
+        size_t AddFile(const std::string& path);
+
+        ///
+        /// Remove the file added last, such as one the caller can't take.
+        ///
+        void RemoveLastFile();
+
+        size_t FileCount() const;
+
+        ///
+        /// Get the format of a file.
+        ///
+        const AudioFormat& Format(size_t file) const;
+
+        ///
+        /// Replay the files from the start until they all end or are stopped, handing the blocks out
+        /// on the calling thread.
+        ///
+        void Run(const BlockHandler& handler);
+
+        ///
+        /// Stop the run in progress, or the next one if none is, from any thread, including the
+        /// handler's. A stopped replay runs again only once reset.
+        ///
+        void Stop();
+
+        ///
+        /// Allow another run after a stop.
+        ///
+        void Reset();
+
+    private:
+        ///
+        /// A file being replayed: its samples, the bytes of its blocks, and the frames handed out.
+        ///
+        struct Source
+        {
+            std::unique_ptr<MappedFile> file;
+            WavDataChunk chunk;
+            size_t blockSize;
+            size_t position;
+            bool stopped;
+        };
+
+        WavReplay(const WavReplay&) = delete;
+        WavReplay& operator=(const WavReplay&) = delete;
+
+    private:
+        double m_speed;
+        uint32_t m_blockMilliseconds;
+
+        std::vector<Source> m_sources;
+
+        ///
+        /// Wakes a paced run to stop.
+        ///
+        std::mutex m_lock;
+        std::condition_variable m_stopped;
+        bool m_stopping;
+    };
+} }
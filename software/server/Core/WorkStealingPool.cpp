@@ -0,0 +1,148 @@
+//-----------------------------------------------------------------------
+// <copyright file="WorkStealingPool.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "WorkStealingPool.h"
+#include "Logger.h"
+#include <exception>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    // The pool and worker of the calling thread, if it is a worker.
+    thread_local const WorkStealingPool* t_pool = nullptr;
+    thread_local size_t t_workerIndex = 0;
+}
+
+WorkStealingPool::WorkStealingPool(size_t workerCount)
+    : m_workers()
+    , m_nextWorker(0)
+    , m_pendingLock()
+    , m_pendingChanged()
+    , m_pending(0)
+    , m_stopping(false)
+{
+    if (workerCount == 0)
+    {
+        workerCount = std::thread::hardware_concurrency();
+        workerCount = (workerCount > 0) ? workerCount : 1;
+    }
+
+    // Every queue exists before any worker looks for work to steal.
+    for (size_t index = 0; index < workerCount; index++)
+    {
+        m_workers.emplace_back(new Worker());
+    }
+
+    for (size_t index = 0; index < workerCount; index++)
+    {
+        m_workers[index]->thread = std::thread(&WorkStealingPool::RunWorker, this, index);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_pendingLock);
+        m_stopping = true;
+    }
+
+    m_pendingChanged.notify_all();
+    for (std::unique_ptr<Worker>& worker : m_workers)
+    {
+        worker->thread.join();
+    }
+}
+
+size_t WorkStealingPool::WorkerCount() const
+{
+    return m_workers.size();
+}
+
+void WorkStealingPool::Post(Work work)
+{
+    size_t index = (t_pool == this) ? t_workerIndex : (m_nextWorker++ % m_workers.size());
+    {
+        std::lock_guard<std::mutex> lock(m_workers[index]->lock);
+        m_workers[index]->queue.push_back(std::move(work));
+    }
+
+    // Counted after it is queued, so a worker which claims it will find it.
+    {
+        std::lock_guard<std::mutex> lock(m_pendingLock);
+        m_pending++;
+    }
+
+    m_pendingChanged.notify_one();
+}
+
+void WorkStealingPool::RunWorker(size_t index)
+{
+    t_pool = this;
+    t_workerIndex = index;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_pendingLock);
+            m_pendingChanged.wait(lock, [this] { return m_pending > 0 || m_stopping; });
+            if (m_pending == 0)
+            {
+                return;
+            }
+
+            m_pending--;
+        }
+
+        // One piece of work is ours; it may take a moment to find if another worker is posting.
+        Work work;
+        while (!TryTake(index, work))
+        {
+            std::this_thread::yield();
+        }
+
+        try
+        {
+            work();
+        }
+        catch (const std::exception& ex)
+        {
+            LOG_WARNING("WorkStealingPool: work failed: %s", ex.what());
+        }
+        catch (...)
+        {
+            LOG_WARNING("WorkStealingPool: work failed");
+        }
+    }
+}
+
+bool WorkStealingPool::TryTake(size_t index, Work& work)
+{
+    {
+        Worker& own = *m_workers[index];
+        std::lock_guard<std::mutex> lock(own.lock);
+        if (!own.queue.empty())
+        {
+            work = std::move(own.queue.back());
+            own.queue.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < m_workers.size(); offset++)
+    {
+        Worker& other = *m_workers[(index + offset) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(other.lock);
+        if (!other.queue.empty())
+        {
+            work = std::move(other.queue.front());
+            other.queue.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
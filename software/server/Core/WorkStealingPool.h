@@ -0,0 +1,85 @@
+//-----------------------------------------------------------------------
+// <copyright file="WorkStealingPool.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// A fixed set of worker threads, each with its own queue. Work posted from a worker goes on its
+    /// own queue and is run newest first, while it is still in cache; work posted from elsewhere is
+    /// dealt round the workers. An idle worker steals the oldest work of the others.
+    ///
+    class WorkStealingPool
+    {
+    public:
+        using Work = std::function<void()>;
+
+        ///
+        /// Start the workers; zero means one per core.
+        ///
+        explicit WorkStealingPool(size_t workerCount);
+
+        ///
+        /// Run the work posted, then stop the workers.
+        ///
+        ~WorkStealingPool();
+
+        size_t WorkerCount() const;
+
+        ///
+        /// Queue work to run on a worker. Exceptions it throws are logged and dropped.
+        ///
+        void Post(Work work);
+
+    private:
+        struct Worker
+        {
+            std::mutex lock;
+            std::deque<Work> queue;
+            std::thread thread;
+        };
+
+        void RunWorker(size_t index);
+
+        ///
+        /// Take work from the back of the worker's own queue, or the front of another's.
+        ///
+        bool TryTake(size_t index, Work& work);
+
+    private:
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        ///
+        /// The workers.
+        ///
+        std::vector<std::unique_ptr<Worker>> m_workers;
+
+        ///
+        /// The worker which gets the next work posted from outside the pool.
+        ///
+        std::atomic<size_t> m_nextWorker;
+
+        ///
+        /// Guards the count of work queued and not yet claimed by a worker, and stopping.
+        ///
+        std::mutex m_pendingLock;
+        std::condition_variable m_pendingChanged;
+        size_t m_pending;
+        bool m_stopping;
+    };
+} }
@@ -0,0 +1,302 @@
+//-----------------------------------------------------------------------
+// <copyright file="WowFlutterAnalyzer.cpp" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#include "WowFlutterAnalyzer.h"
+#include <cmath>
+#include <stdexcept>
+
+using namespace CrazyGiraffe::Core;
+
+namespace
+{
+    const double Pi = 3.14159265358979323846;
+    const double Butterworth = 0.70710678118654752;
+
+    // The tone is tracked while it is this loud; its level decays over 50ms.
+    const double MinimumLevel = 0.005;
+    const double EnvelopeSeconds = 0.05;
+
+    // A crossing only counts once the tone has been this far below zero since the last, so noise
+    // near zero doesn't cross twice.
+    const double ArmLevel = 0.25;
+
+    // The first periods of a tone are skipped while the filter rings up to it.
+    const uint32_t SettlePeriods = 32;
+
+    // The tone is lost after this many periods without a crossing.
+    const double LostPeriods = 2.0;
+
+    // A period further off than this is noise, not the tape.
+    const double MaximumDeviation = 0.2;
+
+    // Without a reference, the first second of tone is the reference.
+    const double LearnSeconds = 1.0;
+
+    // Band edges, in Hz, and the time the mean squares are averaged over.
+    const double DriftHz = 0.5;
+    const double WowHz = 6.0;
+    const double FlutterHz = 200.0;
+    const double RmsSeconds = 2.0;
+
+    // Without a reference, only the DC is filtered out.
+    const double DcHz = 20.0;
+    const double ToneQ = 2.0;
+}
+
+/* static */
+WowFlutterAnalyzer::Biquad WowFlutterAnalyzer::Biquad::LowPass(double frequency, double sampleRate, double q)
+{
+    double w0 = 2 * Pi * frequency / sampleRate;
+    double alpha = std::sin(w0) / (2 * q);
+    double c = std::cos(w0);
+    double a0 = 1 + alpha;
+    return { (1 - c) / 2 / a0, (1 - c) / a0, (1 - c) / 2 / a0, -2 * c / a0, (1 - alpha) / a0, 0, 0, 0, 0 };
+}
+
+/* static */
+WowFlutterAnalyzer::Biquad WowFlutterAnalyzer::Biquad::HighPass(double frequency, double sampleRate, double q)
+{
+    double w0 = 2 * Pi * frequency / sampleRate;
+    double alpha = std::sin(w0) / (2 * q);
+    double c = std::cos(w0);
+    double a0 = 1 + alpha;
+    return { (1 + c) / 2 / a0, -(1 + c) / a0, (1 + c) / 2 / a0, -2 * c / a0, (1 - alpha) / a0, 0, 0, 0, 0 };
+}
+
+/* static */
+WowFlutterAnalyzer::Biquad WowFlutterAnalyzer::Biquad::BandPass(double frequency, double sampleRate, double q)
+{
+    double w0 = 2 * Pi * frequency / sampleRate;
+    double alpha = std::sin(w0) / (2 * q);
+    double c = std::cos(w0);
+    double a0 = 1 + alpha;
+    return { alpha / a0, 0, -alpha / a0, -2 * c / a0, (1 - alpha) / a0, 0, 0, 0, 0 };
+}
+
+void WowFlutterAnalyzer::Biquad::Prime(double x, double y)
+{
+    x1 = x;
+    x2 = x;
+    y1 = y;
+    y2 = y;
+}
+
+double WowFlutterAnalyzer::Biquad::Process(double x)
+{
+    double y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = y;
+    return y;
+}
+
+WowFlutterAnalyzer::WowFlutterAnalyzer(uint32_t sampleRate, uint16_t channelCount, double referenceFrequency)
+    : m_sampleRate(sampleRate)
+    , m_channelCount(channelCount)
+    , m_referenceFrequency(referenceFrequency)
+    , m_frameSum(0)
+    , m_frameChannel(0)
+    , m_toneFilter()
+    , m_envelope(0)
+    , m_envelopeDecay(std::exp(-1.0 / (EnvelopeSeconds * sampleRate)))
+    , m_previous(0)
+    , m_armed(false)
+    , m_hasCrossing(false)
+    , m_sinceCrossing(0)
+    , m_settlePeriods(0)
+    , m_deviationSum(0)
+    , m_deviationCount(0)
+    , m_deviation(0)
+    , m_controlPhase(0)
+    , m_reportPhase(0)
+    , m_primed(false)
+    , m_learnCount(0)
+    , m_learnSamples(0)
+    , m_driftFilter(Biquad::LowPass(DriftHz, ControlRate, Butterworth))
+    , m_wowHighPass(Biquad::HighPass(DriftHz, ControlRate, Butterworth))
+    , m_wowLowPass(Biquad::LowPass(WowHz, ControlRate, Butterworth))
+    , m_flutterHighPass(Biquad::HighPass(WowHz, ControlRate, Butterworth))
+    , m_flutterLowPass(Biquad::LowPass(FlutterHz, ControlRate, Butterworth))
+    , m_correctionFilter(Biquad::LowPass(WowHz, ControlRate, Butterworth))
+    , m_wowSquare(0)
+    , m_flutterSquare(0)
+    , m_current()
+{
+    if (sampleRate == 0)
+    {
+        throw std::invalid_argument("sampleRate");
+    }
+
+    if (channelCount == 0)
+    {
+        throw std::invalid_argument("channelCount");
+    }
+
+    if (!(referenceFrequency >= 0 && referenceFrequency < sampleRate / 4.0))
+    {
+        throw std::invalid_argument("referenceFrequency");
+    }
+
+    m_toneFilter = (referenceFrequency > 0)
+        ? Biquad::BandPass(referenceFrequency, sampleRate, ToneQ)
+        : Biquad::HighPass(DcHz, sampleRate, Butterworth);
+    m_current.frequency = referenceFrequency;
+    m_current.correction = 1.0;
+}
+
+double WowFlutterAnalyzer::ReferenceFrequency() const
+{
+    return m_referenceFrequency;
+}
+
+const WowFlutter& WowFlutterAnalyzer::Current() const
+{
+    return m_current;
+}
+
+void WowFlutterAnalyzer::ProcessSamples(const float* samples, size_t count, const MeasuredHandler& measured)
+{
+    if (samples == nullptr)
+    {
+        return;
+    }
+
+    for (size_t index = 0; index < count; index++)
+    {
+        m_frameSum += samples[index];
+        if (++m_frameChannel < m_channelCount)
+        {
+            continue;
+        }
+
+        ProcessSample(m_frameSum / m_channelCount);
+        m_frameSum = 0;
+        m_frameChannel = 0;
+
+        m_controlPhase += ControlRate;
+        if (m_controlPhase < m_sampleRate)
+        {
+            continue;
+        }
+
+        m_controlPhase -= m_sampleRate;
+        ControlTick();
+
+        if (++m_reportPhase == ControlRate / ReportRate)
+        {
+            m_reportPhase = 0;
+            if (measured)
+            {
+                measured(m_current);
+            }
+        }
+    }
+}
+
+void WowFlutterAnalyzer::ProcessSample(double sample)
+{
+    double tone = m_toneFilter.Process(sample);
+    double level = std::abs(tone);
+    m_envelope = (level > m_envelope) ? level : m_envelope * m_envelopeDecay;
+    m_sinceCrossing += 1;
+
+    // The tone is lost if it fades, or stops crossing.
+    bool overdue = m_referenceFrequency > 0 && m_sinceCrossing > LostPeriods * m_sampleRate / m_referenceFrequency;
+    if (m_envelope < MinimumLevel || overdue)
+    {
+        // The tone is lost; the next crossing starts again.
+        m_hasCrossing = false;
+        m_armed = false;
+        m_settlePeriods = 0;
+    }
+    else if (tone < -ArmLevel * m_envelope)
+    {
+        m_armed = true;
+    }
+    else if (m_armed && m_previous < 0 && tone >= 0)
+    {
+        // Where between the last sample and this one the tone crossed zero.
+        double fraction = m_previous / (m_previous - tone);
+        double sinceCrossing = 1 - fraction;
+        if (m_hasCrossing && ++m_settlePeriods > SettlePeriods)
+        {
+            AddPeriod(m_sinceCrossing - sinceCrossing);
+        }
+
+        m_sinceCrossing = sinceCrossing;
+        m_hasCrossing = true;
+        m_armed = false;
+    }
+
+    m_previous = tone;
+}
+
+void WowFlutterAnalyzer::AddPeriod(double period)
+{
+    if (m_referenceFrequency == 0)
+    {
+        m_learnCount++;
+        m_learnSamples += period;
+        if (m_learnSamples >= LearnSeconds * m_sampleRate)
+        {
+            m_referenceFrequency = m_learnCount * m_sampleRate / m_learnSamples;
+        }
+
+        return;
+    }
+
+    double deviation = m_sampleRate / period / m_referenceFrequency - 1;
+    if (std::abs(deviation) <= MaximumDeviation)
+    {
+        m_deviationSum += deviation;
+        m_deviationCount++;
+    }
+}
+
+void WowFlutterAnalyzer::ControlTick()
+{
+    m_current.locked = m_hasCrossing && m_settlePeriods > SettlePeriods && m_referenceFrequency > 0;
+    if (m_deviationCount == 0)
+    {
+        // Held while the tone is lost, or too low to cross every control period.
+        if (!m_current.locked || !m_primed)
+        {
+            return;
+        }
+    }
+    else
+    {
+        m_deviation = m_deviationSum / m_deviationCount;
+        m_deviationSum = 0;
+        m_deviationCount = 0;
+    }
+
+    // Start the bands from the first speed, so they don't ring from a step up from nothing.
+    if (!m_primed)
+    {
+        m_driftFilter.Prime(m_deviation, m_deviation);
+        m_wowHighPass.Prime(m_deviation, 0);
+        m_flutterHighPass.Prime(m_deviation, 0);
+        m_correctionFilter.Prime(m_deviation, m_deviation);
+        m_primed = true;
+    }
+
+    double drift = m_driftFilter.Process(m_deviation);
+    double wow = m_wowLowPass.Process(m_wowHighPass.Process(m_deviation));
+    double flutter = m_flutterLowPass.Process(m_flutterHighPass.Process(m_deviation));
+    double slow = m_correctionFilter.Process(m_deviation);
+
+    double rate = 1 - std::exp(-1.0 / (RmsSeconds * ControlRate));
+    m_wowSquare += (wow * wow - m_wowSquare) * rate;
+    m_flutterSquare += (flutter * flutter - m_flutterSquare) * rate;
+
+    m_current.frequency = m_referenceFrequency * (1 + drift);
+    m_current.drift = drift;
+    m_current.wow = std::sqrt(m_wowSquare);
+    m_current.flutter = std::sqrt(m_flutterSquare);
+    m_current.correction = 1 / (1 + slow);
+}
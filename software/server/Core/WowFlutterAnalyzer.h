@@ -0,0 +1,200 @@
+//-----------------------------------------------------------------------
+// <copyright file="WowFlutterAnalyzer.h" company="CrazyGiraffeSoftware.net">
+// Copyright (c) CrazyGiraffeSoftware.net. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+// </copyright>
+//-----------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace CrazyGiraffe { namespace Core
+{
+    ///
+    /// The speed of the tape, as heard from a steady tone. The deviations are relative to the
+    /// reference frequency: 0.01 is 1% fast.
+    ///
+    struct WowFlutter
+    {
+        ///
+        /// Whether a tone is being tracked; the rest hold their last values while it isn't.
+        ///
+        bool locked;
+
+        ///
+        /// The frequency of the tone, in Hz, without the wow and flutter.
+        ///
+        double frequency;
+
+        ///
+        /// The steady speed error, below 0.5Hz.
+        ///
+        double drift;
+
+        ///
+        /// The RMS of the speed variation from 0.5Hz to 6Hz, and from 6Hz to 200Hz.
+        ///
+        double wow;
+        double flutter;
+
+        ///
+        /// What to scale the motor speed by to play at speed: the inverse of the speed below 6Hz,
+        /// which a motor can follow.
+        ///
+        double correction;
+    };
+
+    ///
+    /// Measures wow, flutter and drift from the zero crossings of a steady tone, such as a 3150Hz
+    /// test tape. Each period between crossings gives the speed at that moment; the speeds are
+    /// averaged at a control rate and split into bands. Cheap enough to run on every audio frame.
+    ///
+    class WowFlutterAnalyzer
+    {
+    public:
+        ///
+        /// The rate the speed is measured and reported at.
+        ///
+        static const uint32_t ControlRate = 1000;
+        static const uint32_t ReportRate = 100;
+
+        ///
+        /// Called at the report rate with the speed so far.
+        ///
+        using MeasuredHandler = std::function<void(const WowFlutter&)>;
+
+        ///
+        /// Create an analyzer of a tone at a reference frequency, which is filtered out of the audio
+        /// first; zero takes the average over the first second of tone as the reference, so drift
+        /// is the change of speed since then. Throws std::invalid_argument if the format is empty or
+        /// the reference isn't below a quarter of the rate.
+        ///
+        WowFlutterAnalyzer(uint32_t sampleRate, uint16_t channelCount, double referenceFrequency);
+
+        double ReferenceFrequency() const;
+
+        ///
+        /// Get the speed so far.
+        ///
+        const WowFlutter& Current() const;
+
+        ///
+        /// Process interleaved samples, -1 to 1, reporting at the report rate.
+        ///
+        void ProcessSamples(const float* samples, size_t count, const MeasuredHandler& measured);
+
+    private:
+        ///
+        /// A second-order section, as in the RBJ cookbook.
+        ///
+        struct Biquad
+        {
+            double b0, b1, b2, a1, a2;
+            double x1, x2, y1, y2;
+
+            static Biquad LowPass(double frequency, double sampleRate, double q);
+            static Biquad HighPass(double frequency, double sampleRate, double q);
+            static Biquad BandPass(double frequency, double sampleRate, double q);
+
+            ///
+            /// Start from a steady input, giving a steady output, rather than from silence.
+            ///
+            void Prime(double x, double y);
+
+            double Process(double x);
+        };
+
+        void ProcessSample(double sample);
+
+        ///
+        /// Add the speed of a period between crossings.
+        ///
+        void AddPeriod(double period);
+
+        ///
+        /// Filter the speed averaged over a control period into its bands.
+        ///
+        void ControlTick();
+
+    private:
+        ///
+        /// The input format and the tone.
+        ///
+        uint32_t m_sampleRate;
+        uint16_t m_channelCount;
+        double m_referenceFrequency;
+
+        ///
+        /// The channels of the frame being mixed down.
+        ///
+        double m_frameSum;
+        uint16_t m_frameChannel;
+
+        ///
+        /// Isolates the tone: a band-pass at the reference, or a high-pass to remove DC without one.
+        ///
+        Biquad m_toneFilter;
+
+        ///
+        /// The level of the tone, and how much it decays each sample.
+        ///
+        double m_envelope;
+        double m_envelopeDecay;
+
+        ///
+        /// The zero crossing detector: the last sample, whether it has been far enough below zero to
+        /// cross again, whether there has been a crossing since the tone was found, and the samples since it.
+        ///
+        double m_previous;
+        bool m_armed;
+        bool m_hasCrossing;
+        double m_sinceCrossing;
+
+        ///
+        /// The periods since the tone was found, while the filter settles.
+        ///
+        uint32_t m_settlePeriods;
+
+        ///
+        /// The speeds since the last control tick, the last average, and the phases of the control
+        /// and report rates.
+        ///
+        double m_deviationSum;
+        uint32_t m_deviationCount;
+        double m_deviation;
+        uint32_t m_controlPhase;
+        uint32_t m_reportPhase;
+
+        ///
+        /// Whether the bands have been started from a speed yet.
+        ///
+        bool m_primed;
+
+        ///
+        /// Learning the reference, when it isn't given: the periods measured, and the samples they span.
+        ///
+        uint32_t m_learnCount;
+        double m_learnSamples;
+
+        ///
+        /// The bands: drift below 0.5Hz, wow from 0.5Hz to 6Hz and flutter from 6Hz to 200Hz, and
+        /// the speed below 6Hz for the correction.
+        ///
+        Biquad m_driftFilter;
+        Biquad m_wowHighPass;
+        Biquad m_wowLowPass;
+        Biquad m_flutterHighPass;
+        Biquad m_flutterLowPass;
+        Biquad m_correctionFilter;
+
+        ///
+        /// The rolling mean squares of wow and flutter.
+        ///
+        double m_wowSquare;
+        double m_flutterSquare;
+
+        WowFlutter m_current;
+    };
+} }